@@ -42,6 +42,7 @@
 #include <bgp/route.h>
 #include <bgp/route_map.h>
 #include <cli/common.h>
+#include <cli/plan.h>
 #include <net/igp_domain.h>
 #include <net/netflow.h>
 #include <net/network.h>
@@ -50,6 +51,7 @@
 #include <sim/simulator.h>
 #include <ui/help.h>
 #include <ui/rl.h>
+#include <util/slab.h>
 
 #define COPYRIGHT_MSG				\
   "  Copyright (C) 2002-2012 Bruno Quoitin\n"		\
@@ -382,6 +384,32 @@ int libcbgp_exec_file(const char * filename)
   return 0;
 }
 
+// -----[ libcbgp_exec_plan ]----------------------------------------
+/**
+ * Execute a script file as a compiled plan. The plan is cached in
+ * the file with the ".plan" extension (see cli_plan_get).
+ */
+CBGP_EXP_DECL
+int libcbgp_exec_plan(const char * filename)
+{
+  cli_plan_t * plan;
+  int result;
+
+  if (cli_plan_get(filename, &plan) != 0) {
+    stream_printf(gdserr, "Error: Unable to open script file \"%s\"\n",
+		  filename);
+    return -1;
+  }
+
+  result= cli_plan_exec(cli_get(), plan);
+  cli_plan_destroy(&plan);
+  if (result < CLI_SUCCESS) {
+    cli_dump_error(gdserr, cli_get());
+    return -1;
+  }
+  return 0;
+}
+
 // -----[ libcbgp_exec_stream ]--------------------------------------
 /**
  *
@@ -497,6 +525,7 @@ void libcbgp_done2()
   _path_destroy();
   _path_segment_destroy();
   _comm_destroy();
+  _slab_destroy();
 
   assoc_array_destroy(&_main_params);
 }
@@ -143,6 +143,8 @@ extern "C" {
   CBGP_EXP_DECL int libcbgp_exec_cmd(const char * cmd);
   // -----[ libcbgp_exec_file ]--------------------------------------
   CBGP_EXP_DECL int libcbgp_exec_file(const char * file_name);
+  // -----[ libcbgp_exec_plan ]--------------------------------------
+  CBGP_EXP_DECL int libcbgp_exec_plan(const char * file_name);
   // -----[ libcbgp_exec_stream ]------------------------------------
   CBGP_EXP_DECL int libcbgp_exec_stream(FILE * stream);
   // -----[ libcbgp_interactive ]------------------------------------
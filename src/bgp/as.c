@@ -46,17 +46,21 @@
 #include <bgp/peer-list.h>
 #include <bgp/qos.h>
 #include <bgp/rib.h>
+#include <bgp/rib_cursor.h>
 #include <bgp/route.h>
 #include <bgp/routes_list.h>
 #include <bgp/route-input.h>
 #include <bgp/tie_breaks.h>
+#include <bgp/urib.h>
 #include <bgp/walton.h>
 #include <net/network.h>
 #include <net/link.h>
 #include <net/link-list.h>
 #include <net/node.h>
 #include <net/protocol.h>
+#include <sim/tracer.h>
 #include <ui/output.h>
+#include <util/cycles.h>
 #include <util/str_format.h>
 
 
@@ -185,6 +189,31 @@ static void _bgp_proto_dump_msg(gds_stream_t * stream, net_msg_t * msg)
   bgp_msg_dump(stream, NULL, (bgp_msg_t *) msg->payload);
 }
 
+// -----[ _bgp_proto_shard_key ]-------------------------------------
+/**
+ * UPDATE and WITHDRAW messages are keyed by their prefix. This
+ * allows the messages related to different prefixes to be handled
+ * independently (see sim/shard.h).
+ */
+static int _bgp_proto_shard_key(net_msg_t * msg, uint32_t * key)
+{
+  bgp_msg_t * bgp_msg= (bgp_msg_t *) msg->payload;
+  ip_pfx_t prefix;
+
+  switch (bgp_msg->type) {
+  case BGP_MSG_TYPE_UPDATE:
+    prefix= ((bgp_msg_update_t *) bgp_msg)->route->prefix;
+    break;
+  case BGP_MSG_TYPE_WITHDRAW:
+    prefix= ((bgp_msg_withdraw_t *) bgp_msg)->prefix;
+    break;
+  default:
+    return -1;
+  }
+  *key= prefix.network ^ prefix.mask;
+  return 0;
+}
+
 const net_protocol_def_t PROTOCOL_BGP= {
   .name= "bgp",
   .ops= {
@@ -193,6 +222,7 @@ const net_protocol_def_t PROTOCOL_BGP= {
     .dump_msg    = _bgp_proto_dump_msg,
     .destroy_msg = NULL,
     .copy_payload= NULL,
+    .shard_key   = _bgp_proto_shard_key,
   }
 };
 
@@ -284,9 +314,20 @@ int bgp_router_create(asn_t asn, net_node_t * node,
   router->rid= rid;
   router->peers= bgp_peers_create();
   router->loc_rib= rib_create(0);
+  // The unified RIB layout is not supported with Walton (several
+  // routes per peer and per prefix).
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  router->urib= NULL;
+#else
+  if (bgp_options_flag_isset(BGP_OPT_UNIFIED_RIB))
+    router->urib= urib_create();
+  else
+    router->urib= NULL;
+#endif
   router->local_nets= routes_list_create(ROUTES_LIST_OPTION_REF);
   router->cluster_id= router->rid;
   router->reflector= 0;
+  memset(&router->stats, 0, sizeof(router->stats));
 
   // Reference to the node running this BGP router
   router->node= node;
@@ -312,6 +353,8 @@ void bgp_router_destroy(bgp_router_t ** router_ref)
 
   if (*router_ref != NULL) {
     bgp_peers_destroy(&(*router_ref)->peers);
+    if ((*router_ref)->urib != NULL)
+      urib_destroy(&(*router_ref)->urib);
     rib_destroy(&(*router_ref)->loc_rib);
     for (index= 0; index < bgp_routes_size((*router_ref)->local_nets);
 	index++) {
@@ -394,6 +437,65 @@ int bgp_router_peer_set_filter(bgp_router_t * router, net_addr_t addr,
   return EBGP_PEER_UNKNOWN;
 }
 
+// -----[ _bgp_router_loc_rib_find ]---------------------------------
+/**
+ * Return the best route towards the given prefix (from the
+ * Loc-RIB). With a unified RIB, the reference stored in the
+ * prefix's node is used.
+ */
+static inline bgp_route_t * _bgp_router_loc_rib_find(bgp_router_t * router,
+						     ip_pfx_t prefix)
+{
+  if (router->urib != NULL)
+    return urib_get_best(router->urib, prefix);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  return rib_find_one_exact(router->loc_rib, prefix, NULL);
+#else
+  return rib_find_exact(router->loc_rib, prefix);
+#endif
+}
+
+// -----[ bgp_router_find_best ]-------------------------------------
+/**
+ * Return the best route towards the given prefix (exact match) or
+ * NULL if there is none. The route belongs to the Loc-RIB.
+ */
+bgp_route_t * bgp_router_find_best(bgp_router_t * router, ip_pfx_t prefix)
+{
+  return _bgp_router_loc_rib_find(router, prefix);
+}
+
+// -----[ _bgp_router_loc_rib_add ]----------------------------------
+/**
+ * Insert a route in the Loc-RIB. With a unified RIB, the reference
+ * to the best route is also updated.
+ */
+static inline int _bgp_router_loc_rib_add(bgp_router_t * router,
+					  bgp_route_t * route)
+{
+  if (router->urib != NULL)
+    urib_set_best(router->urib, route->prefix, route);
+  return rib_add_route(router->loc_rib, route);
+}
+
+// -----[ _bgp_router_loc_rib_remove ]-------------------------------
+/**
+ * Remove (and destroy) the route towards the given prefix from the
+ * Loc-RIB. With a unified RIB, the reference to the best route is
+ * also cleared.
+ */
+static inline void _bgp_router_loc_rib_remove(bgp_router_t * router,
+					      ip_pfx_t prefix)
+{
+  if (router->urib != NULL)
+    urib_set_best(router->urib, prefix, NULL);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  rib_remove_route(router->loc_rib, prefix, NULL);
+#else
+  rib_remove_route(router->loc_rib, prefix);
+#endif
+}
+
 // -----[ _bgp_router_add_route ]------------------------------------
 /**
  * Add a route in the Loc-RIB
@@ -402,7 +504,7 @@ static inline int _bgp_router_add_route(bgp_router_t * router,
 					bgp_route_t * route)
 {
   routes_list_append(router->local_nets, route);
-  rib_add_route(router->loc_rib, route_copy(route));
+  _bgp_router_loc_rib_add(router, route_copy(route));
   bgp_router_decision_process_disseminate(router, route->prefix, route);
   return ESUCCESS;
 }
@@ -476,12 +578,7 @@ int bgp_router_del_network(bgp_router_t * router, ip_pfx_t prefix)
     /// *****
 
     // Remove the route from the Loc-RIB
-
-#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
-    rib_remove_route(router->loc_rib, prefix, NULL);
-#else
-    rib_remove_route(router->loc_rib, prefix);
-#endif
+    _bgp_router_loc_rib_remove(router, prefix);
 
     // Remove the route from the list of local networks.
     routes_list_remove_at(router->local_nets, index);
@@ -759,6 +856,8 @@ static inline int _bgp_router_advertise_to_peer(bgp_router_t * router,
     route_med_clear(new_route);
   
   // Apply policy filters (output)
+  if (dst_peer->filter[FILTER_OUT] != NULL)
+    router->stats.filter_evals++;
   if (!filter_apply(dst_peer->filter[FILTER_OUT], router, new_route)) {
     STREAM_DEBUG(STREAM_LEVEL_DEBUG, "out-filtered (policy)\n");
     route_destroy(&new_route);
@@ -937,6 +1036,8 @@ int bgp_router_peer_rib_out_remove(bgp_router_t * router,
     }
   }
 #else /* __EXPERIMENTAL__ && __EXPERIMENTAL_WALTON__ */
+  if (peer->rib_out_marks != NULL)
+    return bgp_peer_rib_out_unmark(peer, prefix);
   if (rib_find_exact(peer->adj_rib[RIB_OUT], prefix) != NULL) {
     rib_remove_route(peer->adj_rib[RIB_OUT], prefix);
     iWithdrawRequired= 1;
@@ -996,12 +1097,19 @@ unsigned int _bgp_router_decision_process_run(bgp_router_t * router,
 
 // -----[ bgp_router_peer_rib_out_replace ]--------------------------
 /**
- *
+ * Record the route advertised to a peer in its Adj-RIB-Out. If the
+ * peer's Adj-RIB-Out is elided, only a fingerprint of the route is
+ * kept and the route is destroyed.
  */
 void bgp_router_peer_rib_out_replace(bgp_router_t * router,
 				     bgp_peer_t * peer,
 				     bgp_route_t * new_route)
 {
+  if (peer->rib_out_marks != NULL) {
+    bgp_peer_rib_out_mark(peer, new_route);
+    route_destroy(&new_route);
+    return;
+  }
   rib_replace_route(peer->adj_rib[RIB_OUT], new_route);
 }
 
@@ -1058,6 +1166,7 @@ void bgp_router_decision_process_disseminate_to_peer(bgp_router_t * router,
     } else {
 
       new_route= route_copy(route);
+      router->stats.route_copies++;
       if (_bgp_router_advertise_to_peer(router, peer, new_route) == 0) {
 	STREAM_DEBUG(STREAM_LEVEL_DEBUG, "\treplaced\n");
 	bgp_router_peer_rib_out_replace(router, peer, new_route);
@@ -1159,8 +1268,8 @@ void bgp_router_best_flag_off(bgp_route_t * old_route)
     adj_route= rib_find_one_exact(old_route->peer->adj_rib[RIB_IN],
 				  old_route->prefix, &next_hop);
 #else
-    adj_route= rib_find_exact(old_route->peer->adj_rib[RIB_IN],
-			      old_route->prefix);
+    adj_route= bgp_peer_rib_find_exact(old_route->peer, RIB_IN,
+				       old_route->prefix);
 #endif
 
     /* It is possible that the route does not exist in the Adj-RIB-In
@@ -1174,6 +1283,36 @@ void bgp_router_best_flag_off(bgp_route_t * old_route)
   }
 }
 
+// -----[ bgp_router_install_best ]----------------------------------
+/**
+ * Install a route as the best route of the router without running
+ * the decision process and without propagating it to the peers. The
+ * route is stored in the Adj-RIB-In of its peer (if any), in the
+ * Loc-RIB and in the node's routing table. This is used to load the
+ * outcome of a route computation performed outside of the
+ * simulation (see bgp/aslevel/solver.c).
+ *
+ * The Loc-RIB becomes the owner of the route.
+ */
+int bgp_router_install_best(bgp_router_t * router, bgp_route_t * route)
+{
+  bgp_route_t * old_route= _bgp_router_loc_rib_find(router, route->prefix);
+
+  if (old_route != NULL)
+    bgp_router_best_flag_off(old_route);
+
+  route_flag_set(route, ROUTE_FLAG_FEASIBLE, 1);
+  route_flag_set(route, ROUTE_FLAG_ELIGIBLE, 1);
+  route_flag_set(route, ROUTE_FLAG_BEST, 1);
+  if (route->peer != NULL)
+    bgp_peer_rib_replace_route(route->peer, RIB_IN, route_copy(route));
+
+  if (_bgp_router_loc_rib_add(router, route) != 0)
+    return EUNEXPECTED;
+  bgp_router_rt_add_route(router, route);
+  return ESUCCESS;
+}
+
 // ----- bgp_router_feasible_route ----------------------------------
 /**
  * This function updates the ROUTE_FLAG_FEASIBLE flag of the given
@@ -1243,6 +1382,7 @@ int bgp_router_feasible_route(bgp_router_t * router, bgp_route_t * route)
   bgp_peer_t * peer;
   bgp_route_t * route;
   unsigned int index;
+  bgp_urib_node_t * node;
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   bgp_routes_t * routesSeek;
   uint16_t uIndex;
@@ -1250,6 +1390,28 @@ int bgp_router_feasible_route(bgp_router_t * router, bgp_route_t * route)
 
   routes= routes_list_create(ROUTES_LIST_OPTION_REF);
 
+  // With a unified RIB, all the candidate routes are found in a
+  // single node. No per-peer lookup is needed.
+  if (router->urib != NULL) {
+    node= urib_find_node(router->urib, prefix);
+    if (node == NULL)
+      return routes;
+    for (index= 0; index < node->size; index++) {
+      route= node->entries[index].route;
+      peer= route->peer;
+      if (peer->session_state != SESSION_STATE_ESTABLISHED)
+	continue;
+#ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
+      if ((peer->asn == router->asn) && (uOnlyEBGP != 0))
+	continue;
+#endif
+      if (route_flag_get(route, ROUTE_FLAG_ELIGIBLE) &&
+	  bgp_router_feasible_route(router, route))
+	routes_list_append(routes, route);
+    }
+    return routes;
+  }
+
   // Get from the Adj-RIB-ins the list of available routes.
   for (index= 0; index < bgp_peers_size(router->peers); index++) {
     peer= bgp_peers_at(router->peers, index);
@@ -1412,11 +1574,7 @@ void bgp_router_decision_process_no_best_route(bgp_router_t * router,
     // THE LOC-RIB (AND DESTROYED) !!!
     bgp_router_best_flag_off(old_route);
 
-#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
-    rib_remove_route(router->loc_rib, prefix, NULL);
-#else
-    rib_remove_route(router->loc_rib, prefix);
-#endif
+    _bgp_router_loc_rib_remove(router, prefix);
 
 /*
   stream_printf(gdserr, "OLD-ROUTE[%p]: ", pOldRoute);
@@ -1550,7 +1708,7 @@ void bgp_router_decision_process_update_best_route(bgp_router_t * router,
 #endif
 
   /* Insert in Loc-RIB */
-  assert(rib_add_route(router->loc_rib, route) == 0);
+  assert(_bgp_router_loc_rib_add(router, route) == 0);
 
   /* Insert in the node's routing table */
   bgp_router_rt_add_route(router, route);
@@ -1571,7 +1729,7 @@ void bgp_router_decision_process_update_best_route(bgp_router_t * router,
 #endif
 }
 
-// ----- bgp_router_decision_process --------------------------------
+// ----- _bgp_router_decision_process -------------------------------
 /**
  * Phase I - Calculate degree of preference (LOCAL_PREF) for each
  *           single route. Operate on separate Adj-RIB-Ins.
@@ -1592,9 +1750,9 @@ void bgp_router_decision_process_update_best_route(bgp_router_t * router,
  * - an update has been received. The complete decision process has to
  * be run.
  */
-int bgp_router_decision_process(bgp_router_t * router,
-				bgp_peer_t * pOriginPeer,
-	 			ip_pfx_t prefix)
+static inline int _bgp_router_decision_process(bgp_router_t * router,
+					       bgp_peer_t * pOriginPeer,
+					       ip_pfx_t prefix)
 {
   bgp_routes_t * routes;
   int iIndex;
@@ -1607,11 +1765,7 @@ int bgp_router_decision_process(bgp_router_t * router,
   int iRankEBGP, iEBGPRoutesCount;
 #endif
 
-#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
-  pOldRoute= rib_find_one_exact(router->loc_rib, prefix, NULL);
-#else
-  pOldRoute= rib_find_exact(router->loc_rib, prefix);
-#endif
+  pOldRoute= _bgp_router_loc_rib_find(router, prefix);
 
   STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
     stream_printf(gdsdebug,
@@ -1696,6 +1850,7 @@ int bgp_router_decision_process(bgp_router_t * router,
   // If one best-route has been selected
   if (bgp_routes_size(routes) > 0) {
     route= route_copy(bgp_routes_at(routes, 0));
+    router->stats.route_copies++;
 
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
     if (bgp_options_flag_isset(BGP_OPT_EXT_BEST)) {
@@ -1776,6 +1931,32 @@ int bgp_router_decision_process(bgp_router_t * router,
   return 0;
 }
 
+// -----[ bgp_router_decision_process ]------------------------------
+/**
+ * Run the decision process (see _bgp_router_decision_process) and
+ * update the router's counters. The time spent is only measured if
+ * the BGP_OPT_DP_TIMING option is set.
+ */
+int bgp_router_decision_process(bgp_router_t * router,
+				bgp_peer_t * pOriginPeer,
+				ip_pfx_t prefix)
+{
+  uint64_t start, trace_start;
+  int result;
+
+  router->stats.dp_runs++;
+  trace_start= sim_trace_scope_begin();
+  if (!bgp_options_flag_isset(BGP_OPT_DP_TIMING)) {
+    result= _bgp_router_decision_process(router, pOriginPeer, prefix);
+  } else {
+    start= cycles_now();
+    result= _bgp_router_decision_process(router, pOriginPeer, prefix);
+    router->stats.dp_cycles+= cycles_now() - start;
+  }
+  sim_trace_scope_end(SIM_TRACE_BGP_DP, trace_start, router->rid);
+  return result;
+}
+
 // ----- bgp_router_handle_message ----------------------------------
 /**
  * Handle a BGP message received from the lower layer (network layer
@@ -1795,7 +1976,7 @@ int bgp_router_handle_message(simulator_t * sim,
   net_error_t error;
 
   if ((peer= bgp_router_find_peer(router, msg->src_addr)) != NULL) {
-    error= bgp_peer_handle_message(peer, bgp_msg);
+    error= bgp_peer_handle_message2(peer, bgp_msg, sim);
     if (error != ESUCCESS)
       return error;
     _bgp_router_msg_listener(msg);
@@ -1954,7 +2135,7 @@ int bgp_router_scan_rib_for_each(uint32_t key, uint8_t key_len,
 	  for (uIndexRoute = 0; uIndexRoute < bgp_routes_size(routes); uIndexRoute++) {
 	    pAdjRoute = bgp_routes_at(routes, uIndexRoute);
 #else
-	pAdjRoute= rib_find_exact(peer->adj_rib[RIB_IN], route->prefix);
+	pAdjRoute= bgp_peer_rib_find_exact(peer, RIB_IN, route->prefix);
 #endif
 		
 	if (pAdjRoute != NULL) {
@@ -2018,18 +2199,35 @@ int bgp_router_clear_rib(bgp_router_t * router)
   router->loc_rib= rib_create(0);
   //--------------------------------------------
 
+  if (router->urib != NULL) {
+    urib_destroy(&router->urib);
+    router->urib= urib_create();
+  }
+
   for (index= 0; index < bgp_peers_size(router->peers); index++) {
     peer= bgp_peers_at(router->peers, index);
-    rib_destroy(&peer->adj_rib[RIB_IN]);
-    rib_destroy(&peer->adj_rib[RIB_OUT]);
-    //----------Edited by Pradeep Bangera ---------------------------
-    peer->adj_rib[RIB_OUT]= rib_create(0);
-    peer->adj_rib[RIB_IN]= rib_create(0);
-    //---------------------------------------------------------------
+    bgp_peer_rib_out_clear(peer);
+    if (router->urib == NULL) {
+      //----------Edited by Pradeep Bangera -------------------------
+      rib_destroy(&peer->adj_rib[RIB_IN]);
+      peer->adj_rib[RIB_IN]= rib_create(0);
+      //-------------------------------------------------------------
+    }
   }
   return 0;
 }
 
+// -----[ _bgp_router_urib_set_best ]--------------------------------
+static int _bgp_router_urib_set_best(uint32_t key, uint8_t key_len,
+				     void * item, void * ctx)
+{
+  bgp_router_t * router= (bgp_router_t *) ctx;
+  bgp_route_t * route= (bgp_route_t *) item;
+
+  urib_set_best(router->urib, route->prefix, route);
+  return 0;
+}
+
 // -----[ bgp_router_clear_adj_rib ]----------------------------------
 /**
  * This function only clears the Adj-RIBs of a router.
@@ -2039,14 +2237,23 @@ int bgp_router_clear_adj_rib(bgp_router_t * router)
   unsigned int index;
   bgp_peer_t * peer;
 
+  // With a unified RIB, the references to the Loc-RIB routes must
+  // be restored after the Adj-RIB-Ins have been cleared.
+  if (router->urib != NULL) {
+    urib_destroy(&router->urib);
+    router->urib= urib_create();
+    rib_for_each(router->loc_rib, _bgp_router_urib_set_best, router);
+  }
+
   for (index= 0; index < bgp_peers_size(router->peers); index++) {
     peer= bgp_peers_at(router->peers, index);
-    rib_destroy(&peer->adj_rib[RIB_IN]);
-    rib_destroy(&peer->adj_rib[RIB_OUT]);
-    //----------Edited by Pradeep Bangera ---------------------------
-    peer->adj_rib[RIB_OUT]= rib_create(0);
-    peer->adj_rib[RIB_IN]= rib_create(0);
-    //---------------------------------------------------------------
+    bgp_peer_rib_out_clear(peer);
+    if (router->urib == NULL) {
+      //----------Edited by Pradeep Bangera -------------------------
+      rib_destroy(&peer->adj_rib[RIB_IN]);
+      peer->adj_rib[RIB_IN]= rib_create(0);
+      //-------------------------------------------------------------
+    }
   }
   return 0;
 }
@@ -2059,10 +2266,20 @@ static int _bgp_router_prefixes_for_each(uint32_t key, uint8_t key_len,
 					 void * pItem, void * pContext)
 {
   gds_radix_tree_t * pPrefixes= (gds_radix_tree_t *) pContext;
-  bgp_route_t * route= (bgp_route_t *) pItem;
 
-  radix_tree_add(pPrefixes, route->prefix.network,
-		 route->prefix.mask, (void *) 1);
+  radix_tree_add(pPrefixes, key, key_len, (void *) 1);
+  return 0;
+}
+
+// -----[ _bgp_router_urib_prefixes_for_each ]-----------------------
+static int _bgp_router_urib_prefixes_for_each(ip_pfx_t prefix,
+					      bgp_urib_node_t * node,
+					      void * ctx)
+{
+  gds_radix_tree_t * prefixes= (gds_radix_tree_t *) ctx;
+
+  if (node->size > 0)
+    radix_tree_add(prefixes, prefix.network, prefix.mask, (void *) 1);
   return 0;
 }
 
@@ -2103,9 +2320,13 @@ static inline int _bgp_router_get_peer_prefixes(bgp_router_t * router,
   _bgp_router_alloc_prefixes(ppPrefixes);
 
   if (peer != NULL) {
-    iResult= rib_for_each(peer->adj_rib[RIB_IN],
-			  _bgp_router_prefixes_for_each,
-			  *ppPrefixes);
+    iResult= bgp_peer_rib_for_each(peer, RIB_IN,
+				   _bgp_router_prefixes_for_each,
+				   *ppPrefixes);
+  } else if (router->urib != NULL) {
+    iResult= urib_for_each(router->urib,
+			   _bgp_router_urib_prefixes_for_each,
+			   *ppPrefixes);
   } else {
     for (index= 0; index < bgp_peers_size(router->peers); index++) {
       peer= bgp_peers_at(router->peers, index);
@@ -2162,6 +2383,15 @@ static inline void _bgp_router_refresh_sessions(bgp_router_t * router)
     bgp_peer_session_refresh(bgp_peers_at(router->peers, index));
 }
 
+// -----[ _bgp_router_scan_urib_for_each ]---------------------------
+static int _bgp_router_scan_urib_for_each(ip_pfx_t prefix,
+					  bgp_urib_node_t * node,
+					  void * ctx)
+{
+  return bgp_router_scan_rib_for_each(prefix.network, prefix.mask,
+				      node, ctx);
+}
+
 // ----- bgp_router_scan_rib ----------------------------------------
 /**
  * This function scans the RIB of the BGP router in order to find
@@ -2183,14 +2413,22 @@ int bgp_router_scan_rib(bgp_router_t * router)
   sCtx.router= router;
   sCtx.pPrefixes= _array_create(sizeof(ip_pfx_t), 0, 0, NULL, NULL, NULL);
 
-  /* Build a list of all available prefixes in this router */
-  pPrefixes= _bgp_router_prefixes(router);
-
   /* Traverses the whole Loc-RIB in order to find prefixes that depend
-     on the IGP (links up/down and metric changes) */
-  iResult= radix_tree_for_each(pPrefixes,
-			       bgp_router_scan_rib_for_each,
-			       &sCtx);
+     on the IGP (links up/down and metric changes). With a unified
+     RIB, each node already corresponds to a prefix known in this
+     router (Adj-RIB-Ins and Loc-RIB), so that a single traversal is
+     needed. */
+  if (router->urib != NULL) {
+    pPrefixes= NULL;
+    iResult= urib_for_each(router->urib, _bgp_router_scan_urib_for_each,
+			   &sCtx);
+  } else {
+    /* Build a list of all available prefixes in this router */
+    pPrefixes= _bgp_router_prefixes(router);
+    iResult= radix_tree_for_each(pPrefixes,
+				 bgp_router_scan_rib_for_each,
+				 &sCtx);
+  }
 
   /* For each route in the list, run the BGP decision process */
   if (iResult == 0)
@@ -2356,31 +2594,27 @@ typedef struct {
   char * cDump;
 } bgp_route_dump_ctx_t;
 
-// ----- _bgp_router_dump_route -------------------------------------
+// ----- bgp_router_dump_rib ----------------------------------------
 /**
- *
+ * Dump the content of the Loc-RIB on the provided output stream.
  */
-static int _bgp_router_dump_route(uint32_t key, uint8_t key_len,
-				  void * item, void * context)
+ void bgp_router_dump_rib(gds_stream_t * stream, bgp_router_t * router)
 {
-  bgp_route_dump_ctx_t * ctx= (bgp_route_dump_ctx_t *) context;
+  bgp_rib_cursor_t cursor;
 
-  route_dump(ctx->stream, (bgp_route_t *) item);
-  stream_printf(ctx->stream, "\n");
-  stream_flush(ctx->stream);
-  return 0;
+  rib_cursor_init(&cursor, router, 0, NULL);
+  rib_cursor_dump_rib(stream, router->loc_rib, &cursor);
 }
 
-// ----- bgp_router_dump_rib ----------------------------------------
+// -----[ bgp_router_dump_rib_cursor ]-------------------------------
 /**
- * Dump the content of the Loc-RIB on the provided output stream.
+ * Dump the next page of routes of the Loc-RIB (see
+ * bgp/rib_cursor.h).
  */
- void bgp_router_dump_rib(gds_stream_t * stream, bgp_router_t * router)
+int bgp_router_dump_rib_cursor(gds_stream_t * stream, bgp_router_t * router,
+			       bgp_rib_cursor_t * cursor)
 {
-  bgp_route_dump_ctx_t ctx= { .router= router, .stream= stream };
-
-  rib_for_each(router->loc_rib, _bgp_router_dump_route, &ctx);
-  stream_flush(stream);
+  return rib_cursor_dump_rib(stream, router->loc_rib, cursor);
 }
 
 // ----- bgp_router_dump_adjrib -------------------------------------
@@ -2676,13 +2910,13 @@ static int _bgp_router_load_rib_handler(int status,
   route_flag_set(route, ROUTE_FLAG_FEASIBLE, 1);
   if (route->peer == NULL) {
     route_flag_set(route, ROUTE_FLAG_INTERNAL, 1);
-    rib_add_route(router->loc_rib, route);
+    _bgp_router_loc_rib_add(router, route);
   } else {
     route_flag_set(route, ROUTE_FLAG_ELIGIBLE,
 		   bgp_peer_route_eligible(route->peer, route));
     route_flag_set(route, ROUTE_FLAG_BEST,
 		   bgp_peer_route_feasible(route->peer, route));
-    rib_replace_route(route->peer->adj_rib[RIB_IN], route);
+    bgp_peer_rib_replace_route(route->peer, RIB_IN, route);
   }
 
   // TODO: shouldn't we take into account the soft-restart flag ?
@@ -2750,6 +2984,28 @@ int bgp_router_load_rib(bgp_router_t * router, const char * filename,
   return 0;
   }*/
 
+typedef struct {
+  unsigned int   num_prefixes;
+  unsigned int   num_best;
+  int          * num_per_rule;
+} _stats_ctx_t;
+
+// -----[ _bgp_router_stats_for_each ]-------------------------------
+static int _bgp_router_stats_for_each(uint32_t key, uint8_t key_len,
+				      void * item, void * ctx)
+{
+  _stats_ctx_t * stats_ctx= (_stats_ctx_t *) ctx;
+  bgp_route_t * route= (bgp_route_t *) item;
+
+  stats_ctx->num_prefixes++;
+  if (route_flag_get(route, ROUTE_FLAG_BEST)) {
+    stats_ctx->num_best++;
+    if (route->rank <= DP_NUM_RULES)
+      stats_ctx->num_per_rule[route->rank]++;
+  }
+  return 0;
+}
+
 // -----[ bgp_router_show_stats ]------------------------------------
 /**
  * Show statistics about the BGP router:
@@ -2770,9 +3026,10 @@ void bgp_router_show_stats(gds_stream_t * stream, bgp_router_t * router)
   bgp_peer_t * peer;
   gds_enum_t * routes;
   bgp_route_t * route;
-  unsigned int num_prefixes, num_best;
+  unsigned int num_best;
   int aiNumPerRule[DP_NUM_RULES+1];
   int rule;
+  _stats_ctx_t stats_ctx= { .num_per_rule= aiNumPerRule };
 
   memset(&aiNumPerRule, 0, sizeof(aiNumPerRule));
   stream_printf(stream, "num-peers: %d\n",
@@ -2805,21 +3062,96 @@ void bgp_router_show_stats(gds_stream_t * stream, bgp_router_t * router)
   stream_printf(stream, "num-prefixes/peer:\n");
   for (index= 0; index < bgp_peers_size(router->peers); index++) {
     peer= bgp_peers_at(router->peers, index);
-    num_prefixes= 0;
-    num_best= 0;
-    routes= trie_get_enum(peer->adj_rib[RIB_IN]);
-    while (enum_has_next(routes)) {
-      route= *((bgp_route_t **) enum_get_next(routes));
-      num_prefixes++;
-      if (route_flag_get(route, ROUTE_FLAG_BEST)) {
-	num_best++;
-	if (route->rank <= DP_NUM_RULES)
-	  aiNumPerRule[route->rank]++;
-      }
-    }
-    enum_destroy(&routes);
+    stats_ctx.num_prefixes= 0;
+    stats_ctx.num_best= 0;
+    bgp_peer_rib_for_each(peer, RIB_IN, _bgp_router_stats_for_each,
+			  &stats_ctx);
+    bgp_peer_dump_id(stream, peer);
+    stream_printf(stream, ": %d / %d\n",  stats_ctx.num_best,
+		  stats_ctx.num_prefixes);
+  }
+}
+
+// -----[ bgp_router_show_counters ]---------------------------------
+/**
+ * Show the hot-path counters of the BGP router:
+ * - dp-runs: number of runs of the decision process.
+ *
+ * - dp-time: time spent in the decision process, in nanoseconds
+ *   (only measured with the dp-timing option, see util/cycles.h).
+ *
+ * - filter-evals: number of evaluations of input/output filters.
+ *
+ * - route-copies: number of routes copied to be advertised or
+ *   installed in the Loc-RIB.
+ *
+ * - msgs/peer: for each peer, a line with the number of updates
+ *   sent, updates received, withdraws sent and withdraws received.
+ */
+void bgp_router_show_counters(gds_stream_t * stream, bgp_router_t * router)
+{
+  unsigned int index;
+  bgp_peer_t * peer;
+
+  stream_printf(stream, "dp-runs: %lu\n", router->stats.dp_runs);
+  stream_printf(stream, "dp-time: %llu\n",
+		(unsigned long long) cycles_to_ns(router->stats.dp_cycles));
+  stream_printf(stream, "filter-evals: %lu\n", router->stats.filter_evals);
+  stream_printf(stream, "route-copies: %lu\n", router->stats.route_copies);
+  stream_printf(stream, "msgs/peer:\n");
+  for (index= 0; index < bgp_peers_size(router->peers); index++) {
+    peer= bgp_peers_at(router->peers, index);
+    bgp_peer_dump_id(stream, peer);
+    stream_printf(stream, ": %lu %lu %lu %lu\n",
+		  peer->stats.updates_sent, peer->stats.updates_rcvd,
+		  peer->stats.withdraws_sent, peer->stats.withdraws_rcvd);
+  }
+}
+
+// -----[ _bgp_router_mem_for_each ]---------------------------------
+static int _bgp_router_mem_for_each(uint32_t key, uint8_t key_len,
+				    void * item, void * ctx)
+{
+  (*((unsigned long *) ctx))++;
+  return 0;
+}
+
+// -----[ bgp_router_show_mem ]--------------------------------------
+/**
+ * Show the memory used by the routes stored in the RIBs of a BGP
+ * router. A first line gives the number of routes in the Loc-RIB
+ * and their size (in bytes). Then, for each peer, a line gives the
+ * number and size of the routes in the Adj-RIB-In and Adj-RIB-Out.
+ *
+ * Note: the attributes are not included as they are shared between
+ * routes (see 'info memory').
+ */
+void bgp_router_show_mem(gds_stream_t * stream, bgp_router_t * router)
+{
+  unsigned int index;
+  bgp_peer_t * peer;
+  unsigned long num_routes[RIB_MAX];
+  unsigned long num_loc= 0;
+
+  rib_for_each(router->loc_rib, _bgp_router_mem_for_each, &num_loc);
+  bgp_router_dump_id(stream, router);
+  stream_printf(stream, "\tloc-rib\t%lu\t%lu\n", num_loc,
+		num_loc * sizeof(bgp_route_t));
+  for (index= 0; index < bgp_peers_size(router->peers); index++) {
+    peer= bgp_peers_at(router->peers, index);
+    num_routes[RIB_IN]= 0;
+    num_routes[RIB_OUT]= 0;
+    bgp_peer_rib_for_each(peer, RIB_IN, _bgp_router_mem_for_each,
+			  &num_routes[RIB_IN]);
+    bgp_peer_rib_for_each(peer, RIB_OUT, _bgp_router_mem_for_each,
+			  &num_routes[RIB_OUT]);
+    bgp_router_dump_id(stream, router);
+    stream_printf(stream, "\t");
     bgp_peer_dump_id(stream, peer);
-    stream_printf(stream, ": %d / %d\n",  num_best, num_prefixes);
+    stream_printf(stream, "\t%lu\t%lu\t%lu\t%lu\n",
+		  num_routes[RIB_IN], num_routes[RIB_IN] * sizeof(bgp_route_t),
+		  num_routes[RIB_OUT],
+		  num_routes[RIB_OUT] * sizeof(bgp_route_t));
   }
 }
 
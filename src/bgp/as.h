@@ -16,6 +16,7 @@
 #include <libgds/types.h>
 #include <libgds/list.h>
 
+#include <bgp/rib_cursor.h>
 #include <bgp/route-input.h>
 #include <bgp/types.h>
 #include <net/network.h>
@@ -26,6 +27,8 @@
 #define BGP_OPT_VRIB_OUT            0x04
 #define BGP_OPT_EXT_BEST            0x08
 #define BGP_OPT_WALTON_CONV_ON_BEST 0x10
+#define BGP_OPT_UNIFIED_RIB         0x20
+#define BGP_OPT_DP_TIMING           0x40
 
 // ----- BGP Router Load RIB Options -----
 #define BGP_ROUTER_LOAD_OPTIONS_SUMMARY  0x01  /* Display a summary (stderr) */
@@ -121,6 +124,11 @@ extern "C" {
   void bgp_router_decision_process_disseminate(bgp_router_t * router,
 					       ip_pfx_t prefix,
 					       bgp_route_t * route);
+  // -----[ bgp_router_find_best ]----------------------------------
+  bgp_route_t * bgp_router_find_best(bgp_router_t * router,
+				     ip_pfx_t prefix);
+  // -----[ bgp_router_install_best ]--------------------------------
+  int bgp_router_install_best(bgp_router_t * router, bgp_route_t * route);
   // ----- bgp_router_get_best_routes -------------------------------
   bgp_routes_t * bgp_router_get_best_routes(bgp_router_t * router,
 					    ip_pfx_t prefix);
@@ -185,6 +193,10 @@ extern "C" {
 #endif
   // ----- bgp_router_dump_rib --------------------------------------
   void bgp_router_dump_rib(gds_stream_t * stream, bgp_router_t * router);
+  // -----[ bgp_router_dump_rib_cursor ]-----------------------------
+  int bgp_router_dump_rib_cursor(gds_stream_t * stream,
+				 bgp_router_t * router,
+				 bgp_rib_cursor_t * cursor);
   // ----- bgp_router_dump_rib_address ------------------------------
   void bgp_router_dump_rib_address(gds_stream_t * stream,
 				   bgp_router_t * router,
@@ -213,6 +225,11 @@ extern "C" {
 
   // -----[ bgp_router_show_stats ]----------------------------------
   void bgp_router_show_stats(gds_stream_t * stream, bgp_router_t * router);
+  // -----[ bgp_router_show_counters ]-------------------------------
+  void bgp_router_show_counters(gds_stream_t * stream,
+				bgp_router_t * router);
+  // -----[ bgp_router_show_mem ]------------------------------------
+  void bgp_router_show_mem(gds_stream_t * stream, bgp_router_t * router);
   // -----[ bgp_router_show_routes_info ]----------------------------
   void bgp_router_show_routes_info(gds_stream_t * stream,
 				   bgp_router_t * router,
@@ -16,14 +16,17 @@
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include <libgds/memory.h>
-#include <libgds/stack.h>
 
 #include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/filter.h>
+#include <bgp/aslevel/graph.h>
+#include <bgp/aslevel/loader.h>
 #include <bgp/aslevel/types.h>
 #include <bgp/aslevel/util.h>
 #include <bgp/aslevel/caida.h>
@@ -38,10 +41,8 @@
 // ----- Load AS-level topology -----
 static as_level_topo_t * _the_topo= NULL;
 
-// ----- Tagging/filtering communities -----
-/** communities used to enforce the valley-free property */
-#define COMM_PROV 1
-#define COMM_PEER 10
+// ----- Topologies version (see aslevel_topo_get_graph) -----
+static unsigned int _aslevel_version= 0;
 
 #define ASLEVEL_TOPO_FOREACH_DOMAIN(T,I,D)		\
   for (I= 0; I < ptr_array_length(T->domains) && (D= (as_level_domain_t*) T->domains->data[I]); I++)
@@ -215,6 +216,8 @@ char * aslevel_strerror(int error)
     return "topology is already running";
   case ASLEVEL_ERROR_NOT_IMPLEMENTED:
     return "not implemented";
+  case ASLEVEL_ERROR_NO_ORIGIN:
+    return "no origin for prefix";
   }
   return NULL;
 }
@@ -290,6 +293,7 @@ as_level_topo_t * aslevel_topo_create(uint8_t addr_scheme)
     abort();
   }
   topo->state= ASLEVEL_STATE_LOADED;
+  topo->graph= NULL;
   _aslevel_topo_cache_init(topo);
   return topo;
 }
@@ -300,6 +304,7 @@ void aslevel_topo_destroy(as_level_topo_t ** topo_ref)
   if (*topo_ref != NULL) {
     if ((*topo_ref)->domains != NULL)
       ptr_array_destroy(&(*topo_ref)->domains);
+    aslevel_graph_destroy(&(*topo_ref)->graph);
     FREE(*topo_ref);
     *topo_ref= NULL;
   }
@@ -324,6 +329,39 @@ unsigned int aslevel_topo_num_edges(as_level_topo_t * topo)
   return num_edges/2;
 }
 
+// -----[ aslevel_topo_get_graph ]----------------------------------
+/**
+ * Return the compact snapshot of the topology. The snapshot is
+ * (re)built if the topology was changed since it was taken. As links
+ * are added without reference to their topology, any change to a
+ * link invalidates the snapshots of all topologies.
+ *
+ * Return NULL if the topology is not consistent.
+ */
+as_level_graph_t * aslevel_topo_get_graph(as_level_topo_t * topo)
+{
+  if ((topo->graph != NULL) && (topo->graph->version != _aslevel_version))
+    aslevel_graph_destroy(&topo->graph);
+  if (topo->graph == NULL) {
+    topo->graph= aslevel_graph_create(topo);
+    if (topo->graph != NULL)
+      topo->graph->version= _aslevel_version;
+  }
+  return topo->graph;
+}
+
+// -----[ aslevel_topo_invalidate_graph ]----------------------------
+/**
+ * Must be called when domains or links of the topology are changed
+ * directly (e.g. by filters). The domains cache is cleared as well.
+ */
+void aslevel_topo_invalidate_graph(as_level_topo_t * topo)
+{
+  _aslevel_topo_cache_invalidate(topo);
+  _aslevel_version++;
+  aslevel_graph_destroy(&topo->graph);
+}
+
 // -----[ aslevel_topo_add_as ]------------------------------------
 as_level_domain_t * aslevel_topo_add_as(as_level_topo_t * topo, asn_t asn)
 {
@@ -332,6 +370,7 @@ as_level_domain_t * aslevel_topo_add_as(as_level_topo_t * topo, asn_t asn)
     _aslevel_as_destroy(&domain);
     return NULL;
   }
+  aslevel_topo_invalidate_graph(topo);
 
   _aslevel_topo_cache_update_as(topo, domain);
   return domain;
@@ -351,6 +390,7 @@ int aslevel_topo_remove_as(as_level_topo_t * topo, asn_t asn)
   if (ptr_array_sorted_find_index(topo->domains, &domain, &index) == 0) {
     domain= (as_level_domain_t *) topo->domains->data[index];
     _aslevel_topo_cache_invalidate(topo);
+    aslevel_topo_invalidate_graph(topo);
 
     // Remove links from neighbor domains to this domain
     for (index2= 0; index2 < ptr_array_length(domain->neighbors); index2++) {
@@ -453,6 +493,7 @@ int aslevel_as_add_link(as_level_domain_t * domain1,
     _aslevel_link_destroy(&link);
     return ASLEVEL_ERROR_DUPLICATE_LINK;
   }
+  _aslevel_version++;
 
   if (link_ref != NULL)
     *link_ref= link;
@@ -512,266 +553,33 @@ ptr_array_t * aslevel_topo_get_top(as_level_topo_t * topo)
   return array;
 }
 
-typedef struct {
-  as_level_domain_t * domain;
-  unsigned int index;
-} SGTCtx;
-
-// -----[ _ctx_create ]----------------------------------------------
-static inline SGTCtx * _ctx_create(as_level_domain_t * domain)
-{
-  SGTCtx * pCtx= MALLOC(sizeof(SGTCtx));
-  pCtx->domain= domain;
-  pCtx->index= 0;
-  return pCtx;
-}
-
-// -----[ _ctx_destroy ]---------------------------------------------
-static inline void _ctx_destroy(SGTCtx ** ppCtx)
-{
-  if (*ppCtx != NULL) {
-    FREE(*ppCtx);
-    *ppCtx= NULL;
-  }
-}
-
 // -----[ aslevel_topo_check_connectedness ]-------------------------
 /**
- * Start from one node and check that all other nodes are reachable
- * (regardless of the business relationships). This is a depth first
- * traversal since the depth of the topology is expected to be lower
- * than its width.
+ * Check that all domains are reachable from one of them (regardless
+ * of the business relationships).
  */
 int aslevel_topo_check_connectedness(as_level_topo_t * topo)
 {
-#ifdef ASN_SIZE_32
-  return ASLEVEL_ERROR_NOT_IMPLEMENTED;
-#else
-#define MAX_QUEUE_SIZE MAX_AS
-  as_level_domain_t * domain;
-  as_level_link_t * link;
-  gds_stack_t * stack;
-  SGTCtx * ctx;
-  unsigned int index;
-  AS_SET_DEFINE(uASVisited);
-
-  // No nodes => connected
-  if (aslevel_topo_num_nodes(topo) == 0)
-    return ASLEVEL_SUCCESS;
-  
-  // Initialize array of visited ASes
-  AS_SET_INIT(uASVisited);
-
-  stack= stack_create(MAX_QUEUE_SIZE);
-
-  // Start with first node
-  domain= (as_level_domain_t *) topo->domains->data[0];
-  stack_push(stack, _ctx_create(domain));
-  AS_SET_PUT(uASVisited, domain->asn);
-
-  // Depth-first traversal of the graph (regardless of policies).
-  // Mark each AS as it is reached.
-  while (!stack_is_empty(stack)) {
-    ctx= (SGTCtx *) stack_top(stack);
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
 
-    if (ctx->index < ptr_array_length(ctx->domain->neighbors)) {
-
-      link= (as_level_link_t *) ctx->domain->neighbors->data[ctx->index];
-      if (!IS_IN_AS_SET(uASVisited, link->neighbor->asn)) {
-	AS_SET_PUT(uASVisited, link->neighbor->asn);
-	assert(stack_push(stack, _ctx_create(link->neighbor)) == 0);
-      }
-      ctx->index++;
-
-    } else {
-      ctx= stack_pop(stack);
-      _ctx_destroy(&ctx);
-    }
-
-  }
-
-  stack_destroy(&stack);
-
-  // Check that every domain was reached
-  for (index= 0; index < aslevel_topo_num_nodes(topo); index++) {
-    domain= (as_level_domain_t *) topo->domains->data[index];
-    if (!IS_IN_AS_SET(uASVisited, domain->asn))
-      return ASLEVEL_ERROR_DISCONNECTED;
-  }
-
-  return ASLEVEL_SUCCESS;
-#undef MAX_QUEUE_SIZE
-#endif /* ASN_SIZE_32 */
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+  return aslevel_graph_check_connectedness(graph);
 }
 
 // -----[ aslevel_topo_check_cycle ]---------------------------------
 /**
- * Start from top nodes (those that have no provider) and go down the
- * hierarchy strictly following provider->customer edges. Check that
- * no cycle is found.
+ * Check that there is no cycle of provider-to-customer links. In
+ * verbose mode, the cycles found are reported on the standard
+ * output.
  */
 int aslevel_topo_check_cycle(as_level_topo_t * topo, int verbose)
 {
-#ifdef ASN_SIZE_32
-  return ASLEVEL_ERROR_NOT_IMPLEMENTED;
-#else
-#define MAX_QUEUE_SIZE 100
-  ptr_array_t * top_domains;
-  as_level_domain_t * domain, * cycle_domain;
-  as_level_link_t * link;
-  gds_stack_t * stack;
-  SGTCtx * ctx;
-  unsigned int uIndx, index, index2;
-  int cycle;
-  int num_cycles= 0;
-  AS_SET_DEFINE(uASInCycle);
-  unsigned int num_paths;
-  unsigned int max_path_length;
-  unsigned int num_reached;
-  AS_SET_DEFINE(uASReached);
-  AS_SET_DEFINE(uASVisited);
-
-  // No nodes => no cycle
-  if (aslevel_topo_num_nodes(topo) == 0)
-    return ASLEVEL_SUCCESS;
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
 
-  // Identify top domains, i.e. domains without a provider:
-  //   the search will start from those providers and go down
-  //   the topology along P2C relationships.
-  top_domains= aslevel_topo_get_top(topo);
-
-  if (verbose)
-    stream_printf(gdsout, "number of top domains: %d\n",
-		  ptr_array_length(top_domains));
-
-  // No top domain => cycle of provider-customer relationships
-  // Note: * if there is a single node, it is a top-domain.
-  //       * if there is more than one node and no top-domain, there
-  //         must be a cycle of P2C relationships
-  if (ptr_array_length(top_domains) == 0) {
-    if (verbose)
-      stream_printf(gdsout, "(> 1 node) & (no top-domain) => cycle\n");
-    return ASLEVEL_ERROR_CYCLE_DETECTED;
-  }
-
-  // Initialize array of visited ASes
-  AS_SET_INIT(uASInCycle);
-
-  // Starting from each top AS, traverse all the p2c edges
-  cycle= 0;
-  for (uIndx= 0; (uIndx < ptr_array_length(top_domains)) && !cycle; uIndx++) {
-    stack= stack_create(MAX_QUEUE_SIZE);
-
-    domain= (as_level_domain_t *) top_domains->data[uIndx];
-    assert(stack_push(stack, _ctx_create(domain)) == 0);
-
-    if (verbose)
-      stream_printf(gdsout, "-> from AS%d", domain->asn);
-
-    AS_SET_INIT(uASReached);
-    AS_SET_PUT(uASReached, domain->asn);
-    num_paths= 0;
-    max_path_length= 0;
-
-    AS_SET_INIT(uASVisited);
-    AS_SET_PUT(uASVisited, domain->asn);
-
-    cycle= 0;
-    while (!stack_is_empty(stack) && !cycle) {
-      ctx= (SGTCtx *) stack_top(stack);
-
-      AS_SET_PUT(uASReached, ctx->domain->asn);
-      if (ctx->domain == domain) {
-	//fprintf(stderr, "\r-> from AS%d            ", pDomain->asn);
-	if (ctx->index < ptr_array_length(ctx->domain->neighbors)) {
-	  link= (as_level_link_t *) ctx->domain->neighbors->data[ctx->index];
-	  if (verbose)
-	    stream_printf(gdsout, "\r-> from AS%d (%d:AS%d)",
-			  domain->asn, ctx->index, link->neighbor->asn);
-	} else
-	  if (verbose)
-	    stream_printf(gdsout, "\r-> from AS%d (completed)", domain->asn);
-      }
-
-      if (ctx->index < ptr_array_length(ctx->domain->neighbors)) {
-	
-	link= (as_level_link_t *) ctx->domain->neighbors->data[ctx->index];
-	if (!IS_IN_AS_SET(uASInCycle, link->neighbor->asn) &&
-	    (link->peer_type == ASLEVEL_PEER_TYPE_CUSTOMER)) {
-	  cycle= 0;
-
-	  if (IS_IN_AS_SET(uASVisited, link->neighbor->asn)) {
-
-	    for (index= 0; index < stack_depth(stack); index++)
-	      if (((SGTCtx *) stack_get_at(stack, index))->domain == link->neighbor) {
-		if (verbose)
-		  stream_printf(gdsout, "\rcycle detected:");
-		// Mark all ASes in the cycle
-		for (index2= index; index2 < stack_depth(stack); index2++) {
-		  cycle_domain= ((SGTCtx *) stack_get_at(stack, index2))->domain;
-		  if (verbose)
-		    stream_printf(gdsout, " %u", cycle_domain->asn);
-		  AS_SET_PUT(uASInCycle, cycle_domain->asn);
-		}
-		if (verbose)
-		  stream_printf(gdsout, " %u\n", link->neighbor->asn);
-		
-		cycle= 1;
-		num_cycles++;
-		break;
-	      }
-	  }
-
-	  if (cycle == 0) {
-	    assert(stack_push(stack, _ctx_create(link->neighbor)) == 0);
-	    AS_SET_PUT(uASVisited, link->neighbor->asn);
-	    if (stack_depth(stack) > max_path_length)
-	      max_path_length= stack_depth(stack);
-	  }
-	  cycle= 0;
-	}
-
-	ctx->index++;
-	
-      } else {
-	ctx= stack_pop(stack);
-	AS_SET_CLEAR(uASVisited, ctx->domain->asn);
-	_ctx_destroy(&ctx);
-      }
-
-    }
-
-    if (verbose) {
-      stream_printf(gdsout, "\n");
-
-      num_reached= 0;
-      for (index2= 0; index2 < MAX_AS; index2++) {
-	if (IS_IN_AS_SET(uASReached, index2))
-	  num_reached++;
-      }
-      stream_printf(gdsout, "\tnumber of paths traversed : %d\n", num_paths);
-      stream_printf(gdsout, "\tmax path length           : %d\n", max_path_length);
-      stream_printf(gdsout, "\tnumber of domains reached : %d\n", num_reached);
-      stream_printf(gdsout, "\tnumber of direct customers: %d\n",
-	      aslevel_as_num_customers(domain));
-    }
-      
-  }
-
-  // Clear stack (if not empty)
-  while (!stack_is_empty(stack)) {
-    ctx= stack_top(stack);
-    _ctx_destroy(&ctx);
-  }
-  stack_destroy(&stack);
-
-  ptr_array_destroy(&top_domains);
-
-  if (num_cycles > 0)
-    return ASLEVEL_ERROR_CYCLE_DETECTED;
-
-  return ASLEVEL_SUCCESS;
-#endif /* ASN_SIZE_32 */
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+  return aslevel_graph_check_cycle(graph, verbose?gdsout:NULL);
 }
 
 // -----[ aslevel_topo_check_consistency ]---------------------------
@@ -992,13 +800,138 @@ int aslevel_topo_setup_policies(as_level_topo_t * topo)
   return ASLEVEL_SUCCESS;
 }
 
+// -----[ _aslevel_compare_edges ]----------------------------------
+static int _aslevel_compare_edges(const void * item1, const void * item2)
+{
+  const aslevel_edge_t * edge1= (const aslevel_edge_t *) item1;
+  const aslevel_edge_t * edge2= (const aslevel_edge_t *) item2;
+
+  if (edge1->asn1 != edge2->asn1)
+    return (edge1->asn1 < edge2->asn1)?-1:1;
+  if (edge1->asn2 != edge2->asn2)
+    return (edge1->asn2 < edge2->asn2)?-1:1;
+  if (edge1->line_number != edge2->line_number)
+    return (edge1->line_number < edge2->line_number)?-1:1;
+  return 0;
+}
+
+// -----[ _aslevel_compare_asns ]-----------------------------------
+static int _aslevel_compare_asns(const void * item1, const void * item2)
+{
+  asn_t asn1= *((const asn_t *) item1);
+  asn_t asn2= *((const asn_t *) item2);
+
+  if (asn1 < asn2)
+    return -1;
+  else if (asn1 > asn2)
+    return 1;
+  return 0;
+}
+
+// -----[ aslevel_topo_add_edges ]-----------------------------------
+/**
+ * Create the domains and links of an empty topology from a buffer
+ * of edges. The edges are sorted once, then the domains and the
+ * links of each domain are appended in order. This avoids the
+ * insertion into sorted arrays of aslevel_topo_add_as() and
+ * aslevel_as_add_link().
+ *
+ * The buffer is sorted as a side effect. In case of duplicate link,
+ * the line number of the first duplicate in the file is returned.
+ */
+int aslevel_topo_add_edges(as_level_topo_t * topo, aslevel_edges_t * edges,
+			   int * line_number)
+{
+  aslevel_edge_t * edge;
+  as_level_domain_t * domain;
+  as_level_link_t * link;
+  asn_t * asns;
+  unsigned int num_asns, index, index2;
+  int duplicate_line= -1;
+
+  if (ptr_array_length(topo->domains) > 0)
+    return ASLEVEL_ERROR_TOPOLOGY_LOADED;
+
+  qsort(edges->edges, edges->num_edges, sizeof(aslevel_edge_t),
+	_aslevel_compare_edges);
+
+  // Check for duplicate links
+  for (index= 1; index < edges->num_edges; index++) {
+    edge= &edges->edges[index];
+    if ((edge->asn1 == edge[-1].asn1) && (edge->asn2 == edge[-1].asn2) &&
+	((duplicate_line < 0) || (edge->line_number < duplicate_line)))
+      duplicate_line= edge->line_number;
+  }
+  if (duplicate_line >= 0) {
+    if (line_number != NULL)
+      *line_number= duplicate_line;
+    return ASLEVEL_ERROR_DUPLICATE_LINK;
+  }
+
+  // Collect the ASNs (both ends, as some domains may only appear as
+  // second end)
+  asns= (asn_t *) MALLOC((2*edges->num_edges+1) * sizeof(asn_t));
+  for (index= 0; index < edges->num_edges; index++) {
+    asns[2*index]= edges->edges[index].asn1;
+    asns[2*index+1]= edges->edges[index].asn2;
+  }
+  qsort(asns, 2*edges->num_edges, sizeof(asn_t), _aslevel_compare_asns);
+  num_asns= 0;
+  for (index= 0; index < 2*edges->num_edges; index++)
+    if ((num_asns == 0) || (asns[index] != asns[num_asns-1]))
+      asns[num_asns++]= asns[index];
+
+  // Create the domains in order
+  for (index= 0; index < num_asns; index++) {
+    domain= _aslevel_as_create(asns[index]);
+    ptr_array_append(topo->domains, domain);
+  }
+
+  // Create the links of each domain in order. The edges of a domain
+  // are consecutive and sorted by neighbor.
+  index2= 0;
+  for (index= 0; index < edges->num_edges; index++) {
+    edge= &edges->edges[index];
+    while (asns[index2] != edge->asn1)
+      index2++;
+    domain= (as_level_domain_t *) topo->domains->data[index2];
+    link= _aslevel_link_create(aslevel_topo_get_as(topo, edge->asn2),
+			       edge->peer_type);
+    ptr_array_append(domain->neighbors, link);
+  }
+
+  FREE(asns);
+  aslevel_topo_invalidate_graph(topo);
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ _aslevel_time ]--------------------------------------------
+static inline double _aslevel_time()
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
 // -----[ aslevel_topo_load ]----------------------------------------
+/**
+ * Load an AS-level topology. The file is read in a single pass that
+ * only collects the relationships. The domains and links are then
+ * created in bulk. Files compressed with gzip are supported if
+ * C-BGP was built with zlib.
+ *
+ * If stats is not NULL, it is filled with load statistics.
+ */
 int aslevel_topo_load(const char * filename, uint8_t format,
-		      uint8_t addr_scheme, int * line_number)
+		      uint8_t addr_scheme, int * line_number,
+		      aslevel_load_stats_t * stats)
 {
-  FILE * file;
+  aslevel_file_t file;
+  aslevel_edges_t * edges;
   int result;
   int line_num= -1;
+  double start_time, parse_time;
 
   if (line_number != NULL)
     *line_number= line_num;
@@ -1006,36 +939,60 @@ int aslevel_topo_load(const char * filename, uint8_t format,
   if (_the_topo != NULL)
     return ASLEVEL_ERROR_TOPOLOGY_LOADED;
 
-  if ((file= fopen(filename, "r")) == NULL)
+  if ((file= ASLEVEL_FILE_OPEN(filename)) == NULL)
     return ASLEVEL_ERROR_OPEN;
 
-  _the_topo= aslevel_topo_create(addr_scheme);
+  start_time= _aslevel_time();
+  edges= aslevel_edges_create();
 
   // Parse input file
   switch (format) {
   case ASLEVEL_FORMAT_REXFORD:
-    result= rexford_parser(file, _the_topo, &line_num);
+    result= rexford_parser(file, edges, &line_num);
     break;
   case ASLEVEL_FORMAT_CAIDA:
-    result= caida_parser(file, _the_topo, &line_num);
+    result= caida_parser(file, edges, &line_num);
     break;
   case ASLEVEL_FORMAT_MEULLE:
-    result= meulle_parser(file, _the_topo, &line_num);
+    result= meulle_parser(file, edges, &line_num);
     break;
   default:
     result= ASLEVEL_ERROR_UNKNOWN_FORMAT;
   }
+  ASLEVEL_FILE_CLOSE(file);
+  parse_time= _aslevel_time();
+
+  // Build topology
+  _the_topo= aslevel_topo_create(addr_scheme);
+  if (result == ASLEVEL_SUCCESS)
+    result= aslevel_topo_add_edges(_the_topo, edges, &line_num);
 
   if (line_number != NULL)
     *line_number= line_num;
 
-  if (result != 0) {
+  if (stats != NULL) {
+    stats->num_lines= (line_num > 0)?line_num:0;
+    stats->num_edges= edges->num_edges;
+    stats->num_domains= aslevel_topo_num_nodes(_the_topo);
+    stats->num_links= aslevel_topo_num_edges(_the_topo);
+    stats->parse_time= parse_time-start_time;
+    stats->build_time= _aslevel_time()-parse_time;
+  }
+  aslevel_edges_destroy(&edges);
+
+  if (result != ASLEVEL_SUCCESS) {
     aslevel_topo_destroy(&_the_topo);
     return result;
   }
 
-  fclose(file);
-  return aslevel_topo_check_consistency(_the_topo);
+  result= aslevel_topo_check_consistency(_the_topo);
+  if (result != ASLEVEL_SUCCESS)
+    return result;
+
+  // Take the compact snapshot used by the analytics
+  if (aslevel_topo_get_graph(_the_topo) == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+  return ASLEVEL_SUCCESS;
 }
 
 // -----[ aslevel_topo_install ]-------------------------------------
@@ -45,6 +45,11 @@
 #define ASLEVEL_PREF_PEER 80
 #define ASLEVEL_PREF_CUST 100
 
+// ----- Tagging/filtering communities -----
+/** communities used to enforce the valley-free property */
+#define COMM_PROV 1
+#define COMM_PEER 10
+
 // ----- Error codes -----
 #define ASLEVEL_SUCCESS                 0
 #define ASLEVEL_ERROR_UNEXPECTED        -1
@@ -69,6 +74,7 @@
 #define ASLEVEL_ERROR_ALREADY_INSTALLED -20
 #define ASLEVEL_ERROR_ALREADY_RUNNING   -21
 #define ASLEVEL_ERROR_NOT_IMPLEMENTED   -22
+#define ASLEVEL_ERROR_NO_ORIGIN         -23
 
 // ----- Business relationships -----
 #define ASLEVEL_PEER_TYPE_CUSTOMER 0
@@ -142,6 +148,10 @@ extern "C" {
   int aslevel_topo_info(gds_stream_t * stream);
   // -----[ aslevel_topo_num_nodes ]---------------------------------
   unsigned int aslevel_topo_num_nodes(as_level_topo_t * topo);
+  // -----[ aslevel_topo_get_graph ]--------------------------------
+  as_level_graph_t * aslevel_topo_get_graph(as_level_topo_t * topo);
+  // -----[ aslevel_topo_invalidate_graph ]--------------------------
+  void aslevel_topo_invalidate_graph(as_level_topo_t * topo);
   // -----[ aslevel_as_num_customers ]-------------------------------
   unsigned int aslevel_as_num_customers(as_level_domain_t * fomain);
   // -----[ aslevel_as_num_providers ]-------------------------------
@@ -161,7 +171,8 @@ extern "C" {
 
   // -----[ aslevel_topo_load ]--------------------------------------
   int aslevel_topo_load(const char * filename, uint8_t format,
-			uint8_t addr_scheme, int * line_number);
+			uint8_t addr_scheme, int * line_number,
+			aslevel_load_stats_t * stats);
   // -----[ aslevel_topo_check ]-------------------------------------
   int aslevel_topo_check(int verbose);
   // -----[ aslevel_topo_dump ]--------------------------------------
@@ -13,19 +13,12 @@
 #include <assert.h>
 #include <string.h>
 
-#include <libgds/stream.h>
-#include <libgds/tokenizer.h>
+#include <libgds/str_util.h>
 
-#include <net/network.h>
-#include <net/node.h>
-#include <net/protocol.h>
 #include <net/util.h>
 
-#include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/caida.h>
-#include <bgp/filter/filter.h>
-#include <bgp/peer.h>
 
 // -----[ _caida_relation_to_peer_type ]-----------------------------
 static inline int _caida_relation_to_peer_type(int iRelation,
@@ -61,80 +54,51 @@ static inline int _caida_relation_to_peer_type(int iRelation,
  *   2 for a sibling relationship
  * A relationship among two ASes is described in both directions.
  */
-int caida_parser(FILE * file, as_level_topo_t * topo,
+int caida_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		 int * line_number)
 {
-  char line[80];
+  char line[ASLEVEL_MAX_LINE_LEN];
+  char * fields[3];
   asn_t asn1, asn2;
   int relation;
-  int error= 0;
-  gds_tokenizer_t * tokenizer;
-  const gds_tokens_t * tokens;
-  as_level_domain_t * domain1, * domain2;
+  int error= ASLEVEL_SUCCESS;
   peer_type_t peer_type;
 
-  // Parse input file
-  tokenizer= tokenizer_create(" \t", NULL, NULL);
   *line_number= 0;
 
-  while ((!feof(file)) && (!error)) {
-    if (fgets(line, sizeof(line), file) == NULL)
-      break;
+  // Parse input file
+  while (ASLEVEL_FILE_GETS(file, line, sizeof(line)) != NULL) {
     (*line_number)++;
 
     // Skip comments starting with '#'
     if (line[0] == '#')
       continue;
     
-    // Parse a single line
-    if (tokenizer_run(tokenizer, line) != TOKENIZER_SUCCESS) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    tokens= tokenizer_get_tokens(tokenizer);
-    
     // Get and check mandatory parameters
-    if (tokens_get_num(tokens) != 3) {
+    if (aslevel_loader_split(line, " \t", fields, 3) != 3) {
       error= ASLEVEL_ERROR_NUM_PARAMS;
       break;
     }
     
     // Get AS1 and AS2
-    if (str2asn(tokens_get_string_at(tokens, 0), &asn1) ||
-	str2asn(tokens_get_string_at(tokens, 1), &asn2)) {
+    if (str2asn(fields[0], &asn1) || str2asn(fields[1], &asn2)) {
       error= ASLEVEL_ERROR_INVALID_ASNUM;
       break;
     }
     
     // Get relationship
-    if ((tokens_get_int_at(tokens, 2, &relation) != 0) ||
+    if ((str_as_int(fields[2], &relation) != 0) ||
 	(_caida_relation_to_peer_type(relation, &peer_type) != 0)) {
       error= ASLEVEL_ERROR_INVALID_RELATION;
       break;
     }
     
-    // Add/get domain 1
-    if (!(domain1= aslevel_topo_get_as(topo, asn1)) &&
-	!(domain1= aslevel_topo_add_as(topo, asn1))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    // Add/get domain 2
-    if (!(domain2= aslevel_topo_get_as(topo, asn2)) &&
-	!(domain2= aslevel_topo_add_as(topo, asn2))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
     // Add link in one direction
-    error= aslevel_as_add_link(domain1, domain2, peer_type, NULL);
+    error= aslevel_edges_add(edges, asn1, asn2, peer_type, *line_number);
     if (error != ASLEVEL_SUCCESS)
       break;
     
   }
-  tokenizer_destroy(&tokenizer);
 
   return error;
 }
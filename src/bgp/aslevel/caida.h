@@ -15,6 +15,7 @@
 
 #include <net/network.h>
 #include <net/prefix.h>
+#include <bgp/aslevel/loader.h>
 #include <bgp/aslevel/types.h>
 
 // ----- AS relationships and policies -----
@@ -28,7 +29,7 @@ extern "C" {
 #endif
 
   // ----- caida_load ---------------------------------------------
-  int caida_parser(FILE * file, as_level_topo_t * topo,
+  int caida_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		   int * line_number);
 
 #ifdef __cplusplus
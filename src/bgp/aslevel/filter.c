@@ -19,10 +19,12 @@
 
 #include <string.h>
 
+#include <libgds/memory.h>
+
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/filter.h>
+#include <bgp/aslevel/graph.h>
 #include <bgp/aslevel/types.h>
-#include <bgp/aslevel/util.h>
 
 // -----[ aslevel_filter_str2filter ]--------------------------------
 /**
@@ -49,92 +51,93 @@ int aslevel_filter_str2filter(const char * str,
 
 // -----[ aslevel_filter_topo ]--------------------------------------
 /**
- * Filter the given topology with 
+ * Filter the given topology with the given filter. The domains and
+ * links to be removed are identified on the compact snapshot of the
+ * topology.
  */
 int aslevel_filter_topo(as_level_topo_t * topo, aslevel_filter_t filter)
 {
-#ifdef ASN_SIZE_32
-  return ASLEVEL_ERROR_NOT_IMPLEMENTED;
-#else
-  unsigned int index, index2;
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  unsigned int index, index2, pos, neighbor;
   as_level_domain_t * domain;
   as_level_link_t * link;
-  unsigned int num_customers, num_providers;
-  AS_SET_DEFINE(auSet);
-  unsigned int num_nodes_removed= 0, num_edges_removed= 0;
+  unsigned int num_domains;
+  uint8_t * removed;
+
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
 
-  AS_SET_INIT(auSet);
+  num_domains= graph->num_domains;
+  removed= (uint8_t *) MALLOC((num_domains+1) * sizeof(uint8_t));
+  memset(removed, 0, (num_domains+1) * sizeof(uint8_t));
 
   // Identify domains to be removed
-  for (index= 0; index < aslevel_topo_num_nodes(topo); index++) {
+  for (index= 0; index < num_domains; index++) {
     domain= (as_level_domain_t *) topo->domains->data[index];
-    num_customers= aslevel_as_num_customers(domain);
 
     switch (filter) {
 
     case ASLEVEL_FILTER_STUBS:
-      // Remove the domain if it has no customers and at least one
-      // provider (to avoid removing top domains)
-      if (num_customers == 0) {
-	/*uNumProviders= aslevel_as_num_providers(pDomain);
-	  if (uNumProviders > 0)*/
-	  AS_SET_PUT(auSet, domain->asn);
-      }
+      // Remove the domain if it has no customers
+      if (aslevel_graph_num_links(graph, index,
+				  ASLEVEL_PEER_TYPE_CUSTOMER) == 0)
+	removed[index]= 1;
       break;
 
     case ASLEVEL_FILTER_SHSTUBS:
       // Remove the domain if it has no customers and exactly one single
       // provider
-      if (num_customers == 0) {
-	num_providers= aslevel_as_num_providers(domain);
-	if (num_providers == 1)
-	  AS_SET_PUT(auSet, domain->asn);
-      }
+      if ((aslevel_graph_num_links(graph, index,
+				   ASLEVEL_PEER_TYPE_CUSTOMER) == 0) &&
+	  (aslevel_graph_num_links(graph, index,
+				   ASLEVEL_PEER_TYPE_PROVIDER) == 1))
+	removed[index]= 1;
       break;
 
     case ASLEVEL_FILTER_P2P:
-      // Remove peer-to-peer links 
-      num_providers= aslevel_as_num_providers(domain);
-      if (num_providers == 0)
+      // Remove peer-to-peer links. The links of the snapshot and of
+      // the domain are in the same order.
+      if (aslevel_graph_num_links(graph, index,
+				  ASLEVEL_PEER_TYPE_PROVIDER) == 0)
 	break;
       index2= 0;
-      while (index2 < ptr_array_length(domain->neighbors)) {
-	link= (as_level_link_t *) domain->neighbors->data[index2];
-	num_providers= aslevel_as_num_providers(link->neighbor);
-	if (num_providers == 0)
+      ASLEVEL_GRAPH_FOREACH_LINK(graph, index, pos) {
+	if (aslevel_graph_num_links(graph, graph->neighbors[pos],
+				    ASLEVEL_PEER_TYPE_PROVIDER) == 0)
 	  break;
-	if (link->peer_type == ASLEVEL_PEER_TYPE_PEER) {
+	if (graph->types[pos] == ASLEVEL_PEER_TYPE_PEER) {
 	  ptr_array_remove_at(domain->neighbors, index2);
 	  continue;
 	}
 	index2++;
       }
       if (ptr_array_length(domain->neighbors) == 0)
-	AS_SET_PUT(auSet, domain->asn);
+	removed[index]= 1;
       break;
 
     case ASLEVEL_FILTER_KEEP_TOP:
       // Remove the domain if it has providers
-      num_providers= aslevel_as_num_providers(domain);
-      if (num_providers > 0)
-	AS_SET_PUT(auSet, domain->asn);
+      if (aslevel_graph_num_links(graph, index,
+				  ASLEVEL_PEER_TYPE_PROVIDER) > 0)
+	removed[index]= 1;
       break;
 
     default:
+      FREE(removed);
       return ASLEVEL_ERROR_UNKNOWN_FILTER;
 
     }
   }
 
   // Remove links to/from identified domains
-  for (index= 0; index < aslevel_topo_num_nodes(topo); index++) {
+  for (index= 0; index < num_domains; index++) {
     domain= (as_level_domain_t *) topo->domains->data[index];
     index2= 0;
     while (index2 < ptr_array_length(domain->neighbors)) {
       link= (as_level_link_t *) domain->neighbors->data[index2];
-      if (IS_IN_AS_SET(auSet, link->neighbor->asn)) {
+      if ((aslevel_graph_find(graph, link->neighbor->asn,
+			      &neighbor) == 0) && removed[neighbor]) {
 	ptr_array_remove_at(domain->neighbors, index2);
-	num_edges_removed++;
 	continue;
       }
       index2++;
@@ -142,20 +145,15 @@ int aslevel_filter_topo(as_level_topo_t * topo, aslevel_filter_t filter)
   }
 
   // Remove identified domains
-  index= 0;
-  while (index < aslevel_topo_num_nodes(topo)) {
-    domain= (as_level_domain_t *) topo->domains->data[index];
-    if (IS_IN_AS_SET(auSet, domain->asn)) {
-      ptr_array_remove_at(topo->domains, index);
-      num_nodes_removed++;
-      continue;
-    }
-    index++;
+  index2= 0;
+  for (index= 0; index < num_domains; index++) {
+    if (removed[index])
+      ptr_array_remove_at(topo->domains, index2);
+    else
+      index2++;
   }
 
-  //stream_printf(gdserr, "\tnumber of nodes removed: %d\n", num_nodes_removed);
-  //stream_printf(gdserr, "\tnumber of edges removed: %d\n", num_edges_removed);
-
+  FREE(removed);
+  aslevel_topo_invalidate_graph(topo);
   return ASLEVEL_SUCCESS;
-#endif /* ASN_SIZE_32 */
 }
@@ -0,0 +1,429 @@
+// ==================================================================
+// @(#)graph.c
+//
+// Compact snapshot of an AS-level topology and bulk graph queries.
+//
+// The snapshot is built once from the domains and links of the
+// topology. Queries then work on arrays indexed by domain position
+// instead of following the domain and link pointers, and do not
+// depend on the size of the ASN space.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/graph.h>
+#include <bgp/aslevel/types.h>
+
+// ----- DFS colors -----
+#define _GRAPH_WHITE 0
+#define _GRAPH_GREY  1
+#define _GRAPH_BLACK 2
+
+// ----- Valley-free states -----
+#define _GRAPH_VF_UP   0x01
+#define _GRAPH_VF_DOWN 0x02
+
+// -----[ aslevel_graph_create ]-------------------------------------
+/**
+ * Build the snapshot of a topology. Return NULL if a link refers to
+ * a domain that is not in the topology.
+ */
+as_level_graph_t * aslevel_graph_create(as_level_topo_t * topo)
+{
+  as_level_graph_t * graph;
+  as_level_domain_t * domain;
+  as_level_link_t * link;
+  unsigned int index, index2, pos;
+
+  graph= (as_level_graph_t *) MALLOC(sizeof(as_level_graph_t));
+  graph->num_domains= aslevel_topo_num_nodes(topo);
+  graph->num_links= 0;
+  graph->version= 0;
+  graph->asns= (asn_t *) MALLOC((graph->num_domains+1) * sizeof(asn_t));
+  graph->offsets= (unsigned int *)
+    MALLOC((graph->num_domains+1) * sizeof(unsigned int));
+  for (index= 0; index < graph->num_domains; index++) {
+    domain= (as_level_domain_t *) topo->domains->data[index];
+    graph->asns[index]= domain->asn;
+    graph->num_links+= ptr_array_length(domain->neighbors);
+  }
+  graph->neighbors= (unsigned int *)
+    MALLOC((graph->num_links+1) * sizeof(unsigned int));
+  graph->types= (peer_type_t *)
+    MALLOC((graph->num_links+1) * sizeof(peer_type_t));
+
+  pos= 0;
+  for (index= 0; index < graph->num_domains; index++) {
+    domain= (as_level_domain_t *) topo->domains->data[index];
+    graph->offsets[index]= pos;
+    for (index2= 0; index2 < ptr_array_length(domain->neighbors);
+	 index2++) {
+      link= (as_level_link_t *) domain->neighbors->data[index2];
+      if (aslevel_graph_find(graph, link->neighbor->asn,
+			     &graph->neighbors[pos]) != 0) {
+	graph->offsets[graph->num_domains]= pos;
+	aslevel_graph_destroy(&graph);
+	return NULL;
+      }
+      graph->types[pos]= link->peer_type;
+      pos++;
+    }
+  }
+  graph->offsets[graph->num_domains]= pos;
+  return graph;
+}
+
+// -----[ aslevel_graph_destroy ]------------------------------------
+void aslevel_graph_destroy(as_level_graph_t ** graph_ref)
+{
+  as_level_graph_t * graph= *graph_ref;
+
+  if (graph != NULL) {
+    FREE(graph->asns);
+    FREE(graph->offsets);
+    FREE(graph->neighbors);
+    FREE(graph->types);
+    FREE(graph);
+    *graph_ref= NULL;
+  }
+}
+
+// -----[ aslevel_graph_find ]---------------------------------------
+/**
+ * Find the position of a domain (binary search).
+ *
+ * Return 0 if the domain was found, -1 otherwise.
+ */
+int aslevel_graph_find(as_level_graph_t * graph, asn_t asn,
+		       unsigned int * index)
+{
+  unsigned int low= 0, high= graph->num_domains, middle;
+
+  while (low < high) {
+    middle= low + (high-low)/2;
+    if (graph->asns[middle] == asn) {
+      *index= middle;
+      return 0;
+    }
+    if (graph->asns[middle] < asn)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  return -1;
+}
+
+// -----[ aslevel_graph_num_links ]----------------------------------
+/**
+ * Count the links of a domain with the given relationship.
+ */
+unsigned int aslevel_graph_num_links(as_level_graph_t * graph,
+				     unsigned int index,
+				     peer_type_t peer_type)
+{
+  unsigned int num_links= 0;
+  unsigned int pos;
+
+  ASLEVEL_GRAPH_FOREACH_LINK(graph, index, pos) {
+    if (graph->types[pos] == peer_type)
+      num_links++;
+  }
+  return num_links;
+}
+
+// -----[ aslevel_graph_check_connectedness ]------------------------
+/**
+ * Check that all the domains are reachable from the first one,
+ * regardless of the business relationships (breadth-first
+ * traversal).
+ */
+int aslevel_graph_check_connectedness(as_level_graph_t * graph)
+{
+  unsigned int * queue;
+  uint8_t * visited;
+  unsigned int head= 0, tail= 0;
+  unsigned int pos, neighbor;
+
+  // No nodes => connected
+  if (graph->num_domains == 0)
+    return ASLEVEL_SUCCESS;
+
+  queue= (unsigned int *) MALLOC(graph->num_domains * sizeof(unsigned int));
+  visited= (uint8_t *) MALLOC(graph->num_domains * sizeof(uint8_t));
+  memset(visited, 0, graph->num_domains * sizeof(uint8_t));
+
+  visited[0]= 1;
+  queue[tail++]= 0;
+  while (head < tail) {
+    ASLEVEL_GRAPH_FOREACH_LINK(graph, queue[head], pos) {
+      neighbor= graph->neighbors[pos];
+      if (!visited[neighbor]) {
+	visited[neighbor]= 1;
+	queue[tail++]= neighbor;
+      }
+    }
+    head++;
+  }
+
+  FREE(queue);
+  FREE(visited);
+
+  if (tail < graph->num_domains)
+    return ASLEVEL_ERROR_DISCONNECTED;
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ _graph_dfs_customers ]-------------------------------------
+/**
+ * Depth-first traversal along provider-to-customer links, starting
+ * from the given domain. Each link that leads to a domain on the
+ * current path closes a cycle. Return the number of such links.
+ */
+static inline unsigned int _graph_dfs_customers(as_level_graph_t * graph,
+						unsigned int root,
+						uint8_t * colors,
+						unsigned int * nodes,
+						unsigned int * positions,
+						gds_stream_t * stream)
+{
+  unsigned int depth= 1;
+  unsigned int num_cycles= 0;
+  unsigned int node, pos, neighbor, index;
+
+  nodes[0]= root;
+  positions[0]= graph->offsets[root];
+  colors[root]= _GRAPH_GREY;
+
+  while (depth > 0) {
+    node= nodes[depth-1];
+    pos= positions[depth-1];
+    if (pos >= graph->offsets[node+1]) {
+      colors[node]= _GRAPH_BLACK;
+      depth--;
+      continue;
+    }
+    positions[depth-1]++;
+
+    if (graph->types[pos] != ASLEVEL_PEER_TYPE_CUSTOMER)
+      continue;
+    neighbor= graph->neighbors[pos];
+
+    if (colors[neighbor] == _GRAPH_WHITE) {
+      colors[neighbor]= _GRAPH_GREY;
+      nodes[depth]= neighbor;
+      positions[depth]= graph->offsets[neighbor];
+      depth++;
+    } else if (colors[neighbor] == _GRAPH_GREY) {
+      num_cycles++;
+      if (stream != NULL) {
+	for (index= depth; index > 0; index--)
+	  if (nodes[index-1] == neighbor)
+	    break;
+	stream_printf(stream, "cycle detected:");
+	for (index= index-1; index < depth; index++)
+	  stream_printf(stream, " %u", graph->asns[nodes[index]]);
+	stream_printf(stream, " %u\n", graph->asns[neighbor]);
+      }
+    }
+  }
+  return num_cycles;
+}
+
+// -----[ aslevel_graph_check_cycle ]--------------------------------
+/**
+ * Check that there is no cycle of provider-to-customer links. The
+ * traversal starts from the top domains (those that have no
+ * provider), then from the domains that were not reached (they can
+ * only be reached through a cycle).
+ *
+ * If a stream is given, the cycles are reported on it.
+ */
+int aslevel_graph_check_cycle(as_level_graph_t * graph,
+			      gds_stream_t * stream)
+{
+  unsigned int num_domains= graph->num_domains;
+  uint8_t * colors;
+  unsigned int * nodes, * positions;
+  unsigned int num_top= 0, num_cycles= 0;
+  unsigned int index, pass;
+  int top;
+
+  // No nodes => no cycle
+  if (num_domains == 0)
+    return ASLEVEL_SUCCESS;
+
+  colors= (uint8_t *) MALLOC(num_domains * sizeof(uint8_t));
+  memset(colors, _GRAPH_WHITE, num_domains * sizeof(uint8_t));
+  nodes= (unsigned int *) MALLOC(num_domains * sizeof(unsigned int));
+  positions= (unsigned int *) MALLOC(num_domains * sizeof(unsigned int));
+
+  for (pass= 0; pass < 2; pass++) {
+    for (index= 0; index < num_domains; index++) {
+      if (colors[index] != _GRAPH_WHITE)
+	continue;
+      top= (aslevel_graph_num_links(graph, index,
+				    ASLEVEL_PEER_TYPE_PROVIDER) == 0);
+      if ((pass == 0) && !top)
+	continue;
+      if (top)
+	num_top++;
+      num_cycles+= _graph_dfs_customers(graph, index, colors, nodes,
+					 positions, stream);
+    }
+    if ((pass == 0) && (stream != NULL))
+      stream_printf(stream, "number of top domains: %u\n", num_top);
+  }
+
+  FREE(colors);
+  FREE(nodes);
+  FREE(positions);
+
+  if (num_cycles > 0)
+    return ASLEVEL_ERROR_CYCLE_DETECTED;
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_graph_customer_cones ]-----------------------------
+/**
+ * Compute the size of the customer cone of each domain, i.e. the
+ * number of domains reachable along provider-to-customer links,
+ * including the domain itself. Sibling links are not followed.
+ *
+ * The sizes are stored in an array indexed by domain position.
+ */
+void aslevel_graph_customer_cones(as_level_graph_t * graph,
+				  unsigned int * sizes)
+{
+  unsigned int num_domains= graph->num_domains;
+  unsigned int * queue, * marks;
+  unsigned int head, tail;
+  unsigned int index, pos, neighbor;
+
+  queue= (unsigned int *) MALLOC((num_domains+1) * sizeof(unsigned int));
+  marks= (unsigned int *) MALLOC((num_domains+1) * sizeof(unsigned int));
+  memset(marks, 0, (num_domains+1) * sizeof(unsigned int));
+
+  // The marks are stamped with the position of the traversal's root
+  // (plus one) so that they need not be cleared between traversals.
+  for (index= 0; index < num_domains; index++) {
+    if (aslevel_graph_num_links(graph, index,
+				ASLEVEL_PEER_TYPE_CUSTOMER) == 0) {
+      sizes[index]= 1;
+      continue;
+    }
+    head= 0;
+    tail= 0;
+    marks[index]= index+1;
+    queue[tail++]= index;
+    while (head < tail) {
+      ASLEVEL_GRAPH_FOREACH_LINK(graph, queue[head], pos) {
+	if (graph->types[pos] != ASLEVEL_PEER_TYPE_CUSTOMER)
+	  continue;
+	neighbor= graph->neighbors[pos];
+	if (marks[neighbor] != index+1) {
+	  marks[neighbor]= index+1;
+	  queue[tail++]= neighbor;
+	}
+      }
+      head++;
+    }
+    sizes[index]= tail;
+  }
+
+  FREE(queue);
+  FREE(marks);
+}
+
+// -----[ _graph_vf_visit ]------------------------------------------
+static inline void _graph_vf_visit(uint8_t * visited, unsigned int * queue,
+				   unsigned int * tail, unsigned int node,
+				   uint8_t state)
+{
+  // A domain reached while going up can also go down: no need to
+  // visit it again in the down state.
+  if ((visited[node] & state) ||
+      ((state == _GRAPH_VF_DOWN) && (visited[node] & _GRAPH_VF_UP)))
+    return;
+  visited[node]|= state;
+  queue[(*tail)++]= (node << 1) | (state == _GRAPH_VF_DOWN);
+}
+
+// -----[ aslevel_graph_valley_free ]--------------------------------
+/**
+ * Compute the domains that can be reached from the source domain
+ * along a valley-free path, i.e. zero or more customer-to-provider
+ * links, followed by at most one peer-to-peer link, followed by zero
+ * or more provider-to-customer links. Sibling links can be used
+ * anywhere along the path.
+ *
+ * If an array is given, it is indexed by domain position and set to
+ * 1 for each reached domain. Return the number of reached domains
+ * (including the source).
+ */
+unsigned int aslevel_graph_valley_free(as_level_graph_t * graph,
+				       unsigned int source,
+				       uint8_t * reached)
+{
+  unsigned int num_domains= graph->num_domains;
+  unsigned int * queue;
+  uint8_t * visited;
+  unsigned int head= 0, tail= 0;
+  unsigned int num_reached= 0;
+  unsigned int index, node, pos;
+  uint8_t state;
+
+  queue= (unsigned int *) MALLOC((2*num_domains+1) * sizeof(unsigned int));
+  visited= (uint8_t *) MALLOC((num_domains+1) * sizeof(uint8_t));
+  memset(visited, 0, (num_domains+1) * sizeof(uint8_t));
+
+  _graph_vf_visit(visited, queue, &tail, source, _GRAPH_VF_UP);
+  while (head < tail) {
+    node= queue[head] >> 1;
+    state= (queue[head] & 1)?_GRAPH_VF_DOWN:_GRAPH_VF_UP;
+    head++;
+    ASLEVEL_GRAPH_FOREACH_LINK(graph, node, pos) {
+      switch (graph->types[pos]) {
+      case ASLEVEL_PEER_TYPE_PROVIDER:
+	if (state == _GRAPH_VF_UP)
+	  _graph_vf_visit(visited, queue, &tail, graph->neighbors[pos],
+			  _GRAPH_VF_UP);
+	break;
+      case ASLEVEL_PEER_TYPE_PEER:
+	if (state == _GRAPH_VF_UP)
+	  _graph_vf_visit(visited, queue, &tail, graph->neighbors[pos],
+			  _GRAPH_VF_DOWN);
+	break;
+      case ASLEVEL_PEER_TYPE_CUSTOMER:
+	_graph_vf_visit(visited, queue, &tail, graph->neighbors[pos],
+			_GRAPH_VF_DOWN);
+	break;
+      case ASLEVEL_PEER_TYPE_SIBLING:
+	_graph_vf_visit(visited, queue, &tail, graph->neighbors[pos],
+			state);
+	break;
+      }
+    }
+  }
+
+  for (index= 0; index < num_domains; index++) {
+    if (reached != NULL)
+      reached[index]= (visited[index] != 0);
+    if (visited[index])
+      num_reached++;
+  }
+
+  FREE(queue);
+  FREE(visited);
+  return num_reached;
+}
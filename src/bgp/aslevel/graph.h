@@ -0,0 +1,57 @@
+// ==================================================================
+// @(#)graph.h
+//
+// Compact snapshot of an AS-level topology and bulk graph queries
+// (connectedness, provider-customer cycles, customer cones,
+// valley-free reachability).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_ASLEVEL_GRAPH_H__
+#define __BGP_ASLEVEL_GRAPH_H__
+
+#include <libgds/stream.h>
+
+#include <bgp/aslevel/types.h>
+
+// -----[ ASLEVEL_GRAPH_FOREACH_LINK ]-------------------------------
+#define ASLEVEL_GRAPH_FOREACH_LINK(G,I,P)				\
+  for (P= (G)->offsets[I]; P < (G)->offsets[(I)+1]; P++)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ aslevel_graph_create ]-----------------------------------
+  as_level_graph_t * aslevel_graph_create(as_level_topo_t * topo);
+  // -----[ aslevel_graph_destroy ]----------------------------------
+  void aslevel_graph_destroy(as_level_graph_t ** graph_ref);
+  // -----[ aslevel_graph_find ]-------------------------------------
+  int aslevel_graph_find(as_level_graph_t * graph, asn_t asn,
+			 unsigned int * index);
+  // -----[ aslevel_graph_num_links ]--------------------------------
+  unsigned int aslevel_graph_num_links(as_level_graph_t * graph,
+				       unsigned int index,
+				       peer_type_t peer_type);
+
+  // -----[ aslevel_graph_check_connectedness ]----------------------
+  int aslevel_graph_check_connectedness(as_level_graph_t * graph);
+  // -----[ aslevel_graph_check_cycle ]------------------------------
+  int aslevel_graph_check_cycle(as_level_graph_t * graph,
+				gds_stream_t * stream);
+  // -----[ aslevel_graph_customer_cones ]---------------------------
+  void aslevel_graph_customer_cones(as_level_graph_t * graph,
+				    unsigned int * sizes);
+  // -----[ aslevel_graph_valley_free ]------------------------------
+  unsigned int aslevel_graph_valley_free(as_level_graph_t * graph,
+					 unsigned int source,
+					 uint8_t * reached);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_ASLEVEL_GRAPH_H__ */
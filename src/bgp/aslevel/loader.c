@@ -0,0 +1,105 @@
+// ==================================================================
+// @(#)loader.c
+//
+// Support for loading large AS-level topologies.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/loader.h>
+
+#define ASLEVEL_EDGES_INITIAL_SIZE 1024
+
+// -----[ aslevel_edges_create ]-------------------------------------
+aslevel_edges_t * aslevel_edges_create()
+{
+  aslevel_edges_t * edges= (aslevel_edges_t *)
+    MALLOC(sizeof(aslevel_edges_t));
+  edges->edges= NULL;
+  edges->num_edges= 0;
+  edges->size= 0;
+  return edges;
+}
+
+// -----[ aslevel_edges_destroy ]------------------------------------
+void aslevel_edges_destroy(aslevel_edges_t ** edges_ref)
+{
+  aslevel_edges_t * edges= *edges_ref;
+
+  if (edges != NULL) {
+    if (edges->edges != NULL)
+      FREE(edges->edges);
+    FREE(edges);
+    *edges_ref= NULL;
+  }
+}
+
+// -----[ aslevel_edges_add ]----------------------------------------
+/**
+ * Append an edge to the buffer. The buffer grows geometrically.
+ *
+ * Return value:
+ *   ASLEVEL_SUCCESS          on success
+ *   ASLEVEL_ERROR_LOOP_LINK  if both ends are the same domain
+ */
+int aslevel_edges_add(aslevel_edges_t * edges, asn_t asn1, asn_t asn2,
+		      peer_type_t peer_type, unsigned int line_number)
+{
+  aslevel_edge_t * edge;
+
+  if (asn1 == asn2)
+    return ASLEVEL_ERROR_LOOP_LINK;
+
+  if (edges->num_edges >= edges->size) {
+    edges->size= ((edges->size == 0)?
+		  ASLEVEL_EDGES_INITIAL_SIZE:2*edges->size);
+    edges->edges= (aslevel_edge_t *)
+      REALLOC(edges->edges, edges->size * sizeof(aslevel_edge_t));
+  }
+  edge= &edges->edges[edges->num_edges++];
+  edge->asn1= asn1;
+  edge->asn2= asn2;
+  edge->peer_type= peer_type;
+  edge->line_number= line_number;
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_loader_split ]-------------------------------------
+/**
+ * Split a line into fields, in place. The end-of-line is removed. At
+ * most max_fields fields are stored. Return the total number of
+ * fields in the line.
+ */
+unsigned int aslevel_loader_split(char * line, const char * delimiters,
+				  char ** fields, unsigned int max_fields)
+{
+  unsigned int num_fields= 0;
+  char * end;
+
+  line[strcspn(line, "\r\n")]= '\0';
+  while (1) {
+    line+= strspn(line, delimiters);
+    if (*line == '\0')
+      break;
+    end= line + strcspn(line, delimiters);
+    if (num_fields < max_fields)
+      fields[num_fields]= line;
+    num_fields++;
+    if (*end == '\0')
+      break;
+    *end= '\0';
+    line= end+1;
+  }
+  return num_fields;
+}
@@ -0,0 +1,80 @@
+// ==================================================================
+// @(#)loader.h
+//
+// Support for loading large AS-level topologies. The parsers only
+// collect the relationships into a flat buffer of edges. The domains
+// and links are then created in bulk, once the edges are sorted
+// (see aslevel_topo_add_edges).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_ASLEVEL_LOADER_H__
+#define __BGP_ASLEVEL_LOADER_H__
+
+#include <stdio.h>
+
+#include <bgp/aslevel/types.h>
+
+// ----- Topology files (compressed files are supported with zlib) -----
+#ifdef HAVE_LIBZ
+# include <zlib.h>
+typedef gzFile aslevel_file_t;
+# define ASLEVEL_FILE_OPEN(N) gzopen(N, "r")
+# define ASLEVEL_FILE_CLOSE(F) gzclose(F)
+# define ASLEVEL_FILE_GETS(F,B,L) gzgets(F, B, L)
+#else
+typedef FILE * aslevel_file_t;
+# define ASLEVEL_FILE_OPEN(N) fopen(N, "r")
+# define ASLEVEL_FILE_CLOSE(F) fclose(F)
+# define ASLEVEL_FILE_GETS(F,B,L) fgets(B, L, F)
+#endif
+
+/** Maximum length of a line in a topology file. */
+#define ASLEVEL_MAX_LINE_LEN 256
+
+// -----[ aslevel_edge_t ]-------------------------------------------
+/** Directed relationship read from a topology file. */
+typedef struct {
+  asn_t        asn1;
+  asn_t        asn2;
+  peer_type_t  peer_type;
+  unsigned int line_number;
+} aslevel_edge_t;
+
+// -----[ aslevel_edges_t ]------------------------------------------
+typedef struct {
+  aslevel_edge_t * edges;
+  unsigned int     num_edges;
+  unsigned int     size;
+} aslevel_edges_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ aslevel_edges_create ]-----------------------------------
+  aslevel_edges_t * aslevel_edges_create();
+  // -----[ aslevel_edges_destroy ]----------------------------------
+  void aslevel_edges_destroy(aslevel_edges_t ** edges_ref);
+  // -----[ aslevel_edges_add ]--------------------------------------
+  int aslevel_edges_add(aslevel_edges_t * edges, asn_t asn1, asn_t asn2,
+			peer_type_t peer_type, unsigned int line_number);
+
+  // -----[ aslevel_loader_split ]-----------------------------------
+  unsigned int aslevel_loader_split(char * line, const char * delimiters,
+				    char ** fields,
+				    unsigned int max_fields);
+
+  // -----[ aslevel_topo_add_edges ]---------------------------------
+  int aslevel_topo_add_edges(as_level_topo_t * topo,
+			     aslevel_edges_t * edges,
+			     int * line_number);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_ASLEVEL_LOADER_H__ */
@@ -13,18 +13,8 @@
 #include <assert.h>
 #include <string.h>
 
-#include <libgds/stream.h>
-#include <libgds/str_util.h>
-#include <libgds/tokenizer.h>
-
-#include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/meulle.h>
-#include <bgp/aslevel/rexford.h>
-#include <bgp/peer.h>
-#include <net/network.h>
-#include <net/node.h>
-#include <net/protocol.h>
 #include <net/util.h>
 
 // -----[ meulle_parser ]-------------------------------------------
@@ -39,61 +29,41 @@
  *   C2P  for a customer (ASi) to provider (ASj) relationship
  * A relationship among two ASes is described in one direction only.
  */
-int meulle_parser(FILE * file, as_level_topo_t * topo,
+int meulle_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		  int * line_number)
 {
-  char line[80];
-  const char * asn1_str, * asn2_str, * relation;
+  char line[ASLEVEL_MAX_LINE_LEN];
+  char * fields[3];
+  const char * relation;
   asn_t asn1, asn2;
-  int error= 0;
-  gds_tokenizer_t * tokenizer;
-  const gds_tokens_t * tokens;
-  as_level_domain_t * domain1, * domain2;
+  int error= ASLEVEL_SUCCESS;
   peer_type_t peer_type;
 
   *line_number= 0;
 
   // Parse input file
-  tokenizer= tokenizer_create(" \t", NULL, NULL);
-  
-  while ((!feof(file)) && (!error)) {
-    if (fgets(line, sizeof(line), file) == NULL)
-      break;
+  while (ASLEVEL_FILE_GETS(file, line, sizeof(line)) != NULL) {
     (*line_number)++;
     
     // Skip comments starting with '#'
     if (line[0] == '#')
       continue;
     
-    if (tokenizer_run(tokenizer, line) != TOKENIZER_SUCCESS) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    tokens= tokenizer_get_tokens(tokenizer);
-    
     // Get and check mandatory parameters
-    if (tokens_get_num(tokens) != 3) {
+    if (aslevel_loader_split(line, " \t", fields, 3) != 3) {
       error= ASLEVEL_ERROR_NUM_PARAMS;
       break;
     }
 
     // Get and check ASNs
-    asn1_str= tokens_get_string_at(tokens, 0);
-    if (strncmp(asn1_str, "AS", 2) ||
-	str2asn(asn1_str+2, &asn1)) {
-      error= ASLEVEL_ERROR_INVALID_ASNUM;
-      break;
-    }
-    asn2_str= tokens_get_string_at(tokens, 1);
-    if (strncmp(asn2_str, "AS", 2) ||
-	str2asn(asn2_str+2, &asn2)) {
+    if (strncmp(fields[0], "AS", 2) || str2asn(fields[0]+2, &asn1) ||
+	strncmp(fields[1], "AS", 2) || str2asn(fields[1]+2, &asn2)) {
       error= ASLEVEL_ERROR_INVALID_ASNUM;
       break;
     }
 
     // Get and check business relationship
-    relation= tokens_get_string_at(tokens, 2);
+    relation= fields[2];
     if (!strcmp(relation, "PEER")) {
       peer_type= ASLEVEL_PEER_TYPE_PEER;
     } else if (!strcmp(relation, "P2C")) {
@@ -105,27 +75,12 @@ int meulle_parser(FILE * file, as_level_topo_t * topo,
       break;
     }
   
-    // Add/get domain 1
-    if (!(domain1= aslevel_topo_get_as(topo, asn1)) &&
-	!(domain1= aslevel_topo_add_as(topo, asn1))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    // Add/get domain 2
-    if (!(domain2= aslevel_topo_get_as(topo, asn2)) &&
-	!(domain2= aslevel_topo_add_as(topo, asn2))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
     // Add link
-    error= aslevel_as_add_link(domain1, domain2, peer_type, NULL);
-    if (error	!= ASLEVEL_SUCCESS)
+    error= aslevel_edges_add(edges, asn1, asn2, peer_type, *line_number);
+    if (error != ASLEVEL_SUCCESS)
       break;
     
   }
 
-  tokenizer_destroy(&tokenizer);
   return error;
 }
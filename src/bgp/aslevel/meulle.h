@@ -16,6 +16,7 @@
 #include <net/prefix.h>
 #include <net/network.h>
 
+#include <bgp/aslevel/loader.h>
 #include <bgp/aslevel/types.h>
 
 #ifdef __cplusplus
@@ -23,7 +24,7 @@ extern "C" {
 #endif
 
   // -----[ meulle_parser ]-----------------------------------------
-  int meulle_parser(FILE * file, as_level_topo_t * topo,
+  int meulle_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		    int * line_number);
 
 #ifdef __cplusplus
@@ -14,17 +14,12 @@
 #include <string.h>
 
 #include <libgds/stream.h>
-#include <libgds/tokenizer.h>
+#include <libgds/str_util.h>
 
-#include <net/network.h>
-#include <net/node.h>
-#include <net/protocol.h>
 #include <net/util.h>
 
-#include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/rexford.h>
-#include <bgp/peer.h>
 
 // -----[ _rexford_relation_to_peer_type ]-----------------------------
 static inline int _rexford_relation_to_peer_type(int iRelation,
@@ -52,73 +47,62 @@ static inline int _rexford_relation_to_peer_type(int iRelation,
  *   1 for a provider (AS1) to customer (AS2) relationship
  * A relationship among two ASes is described in one direction only.
  */
-int rexford_parser(FILE * file, as_level_topo_t * topo,
+int rexford_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		   int * line_number)
 {
-  char line[80];
+  char line[ASLEVEL_MAX_LINE_LEN];
+  char * fields[4];
+  unsigned int num_fields;
   asn_t asn1, asn2;
   unsigned int relation;
-  int error= 0;
+  int error= ASLEVEL_SUCCESS;
   net_link_delay_t delay;
-  gds_tokenizer_t * tokenizer;
-  const gds_tokens_t * tokens;
-  as_level_domain_t * domain1, * domain2;
   peer_type_t peer_type;
 
   *line_number= 0;
 
   // Parse input file
-  tokenizer= tokenizer_create(" \t", NULL, NULL);
-  
-  while ((!feof(file)) && (!error)) {
-    if (fgets(line, sizeof(line), file) == NULL)
-      break;
+  while (ASLEVEL_FILE_GETS(file, line, sizeof(line)) != NULL) {
     (*line_number)++;
     
     // Skip comments starting with '#'
     if (line[0] == '#')
       continue;
     
-    if (tokenizer_run(tokenizer, line) != TOKENIZER_SUCCESS) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    tokens= tokenizer_get_tokens(tokenizer);
-    
+    num_fields= aslevel_loader_split(line, " \t", fields, 4);
+
     // Set default value for optional parameters
     delay= 0;
     
     // Get and check mandatory parameters
-    if (tokens_get_num(tokens) < 3) {
+    if (num_fields < 3) {
       error= ASLEVEL_ERROR_NUM_PARAMS;
       break;
     }
 
     // Get and check ASNs
-    if (str2asn(tokens_get_string_at(tokens, 0), &asn1) ||
-	str2asn(tokens_get_string_at(tokens, 1), &asn2)) {
+    if (str2asn(fields[0], &asn1) || str2asn(fields[1], &asn2)) {
       error= ASLEVEL_ERROR_INVALID_ASNUM;
       break;
     }
     
     // Get and check business relationship
-    if ((tokens_get_uint_at(tokens, 2, &relation) != 0) ||
+    if ((str_as_uint(fields[2], &relation) != 0) ||
 	(_rexford_relation_to_peer_type(relation, &peer_type) != 0)) {
       error= ASLEVEL_ERROR_INVALID_RELATION;
       break;
     }
     
     // Get optional parameters
-    if (tokens_get_num(tokens) > 3) {
-      if (str2delay(tokens_get_string_at(tokens, 3), &delay)) {
+    if (num_fields > 3) {
+      if (str2delay(fields[3], &delay)) {
 	error= ASLEVEL_ERROR_INVALID_DELAY;
 	break;
       }
     }
     
     // Limit number of parameters
-    if (tokens_get_num(tokens) > 4) {
+    if (num_fields > 4) {
       STREAM_ERR(STREAM_LEVEL_SEVERE,
 	      "Error: too many arguments in topology, line %u\n",
 	      *line_number);
@@ -126,31 +110,16 @@ int rexford_parser(FILE * file, as_level_topo_t * topo,
       break;
     }
     
-    // Add/get domain 1
-    if (!(domain1= aslevel_topo_get_as(topo, asn1)) &&
-	!(domain1= aslevel_topo_add_as(topo, asn1))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
-    // Add/get domain 2
-    if (!(domain2= aslevel_topo_get_as(topo, asn2)) &&
-	!(domain2= aslevel_topo_add_as(topo, asn2))) {
-      error= ASLEVEL_ERROR_UNEXPECTED;
-      break;
-    }
-    
     // Add link in both directions
-    error= aslevel_as_add_link(domain1, domain2, peer_type, NULL);
+    error= aslevel_edges_add(edges, asn1, asn2, peer_type, *line_number);
     if (error != ASLEVEL_SUCCESS)
       break;
     peer_type= aslevel_reverse_relation(peer_type);
-    error= aslevel_as_add_link(domain2, domain1, peer_type, NULL);
+    error= aslevel_edges_add(edges, asn2, asn1, peer_type, *line_number);
     if (error != ASLEVEL_SUCCESS)
       break;
     
   }
 
-  tokenizer_destroy(&tokenizer);
   return error;
 }
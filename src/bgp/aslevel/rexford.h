@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 
+#include <bgp/aslevel/loader.h>
 #include <bgp/aslevel/types.h>
 
 // ----- AS relationships and policies -----
@@ -22,7 +23,7 @@ extern "C" {
 #endif
 
   // -----[ rexford_parser ]-----------------------------------------
-  int rexford_parser(FILE * file, as_level_topo_t * topo,
+  int rexford_parser(aslevel_file_t file, aslevel_edges_t * edges,
 		     int * line_number);
 
 #ifdef __cplusplus
@@ -0,0 +1,533 @@
+// ==================================================================
+// @(#)solver.c
+//
+// Compute the outcome of BGP in an AS-level topology with
+// valley-free (Gao-Rexford) policies, without simulating the
+// exchange of BGP messages.
+//
+// With the policies installed by aslevel_topo_setup_policies(), a
+// domain prefers routes learned from customers over routes learned
+// from peers over routes learned from providers. Routes learned from
+// peers and providers are only propagated to customers. Among the
+// routes of the same class, the shortest AS-Path is preferred, then
+// the lowest router-ID of the neighbor. The stable state can then be
+// computed with three breadth-first traversals:
+//   1). customer routes: from the origins, upwards along
+//       customer-to-provider edges,
+//   2). peer routes: one peer-to-peer edge from a domain that has a
+//       customer (or local) route,
+//   3). provider routes: downwards along provider-to-customer edges,
+//       in order of increasing AS-Path length.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+
+#include <libgds/memory.h>
+
+#include <bgp/as.h>
+#include <bgp/attr/path.h>
+#include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/graph.h>
+#include <bgp/aslevel/solver.h>
+#include <bgp/aslevel/types.h>
+#include <bgp/route.h>
+#include <bgp/routes_list.h>
+#include <net/prefix.h>
+
+// -----[ _solver_domain_at ]---------------------------------------
+static inline as_level_domain_t * _solver_domain_at(as_level_topo_t * topo,
+						    unsigned int index)
+{
+  return (as_level_domain_t *) topo->domains->data[index];
+}
+
+// -----[ _solver_rids ]---------------------------------------------
+/**
+ * Compute the router-ID of each domain (used to break ties). Return
+ * NULL if the topology has siblings (they do not follow the
+ * valley-free rules).
+ */
+static inline net_addr_t * _solver_rids(as_level_topo_t * topo,
+					as_level_graph_t * graph)
+{
+  net_addr_t * rids;
+  unsigned int index;
+
+  for (index= 0; index < graph->num_links; index++)
+    if (graph->types[index] == ASLEVEL_PEER_TYPE_SIBLING)
+      return NULL;
+
+  rids= (net_addr_t *) MALLOC((graph->num_domains+1) * sizeof(net_addr_t));
+  for (index= 0; index < graph->num_domains; index++)
+    rids[index]= topo->addr_mapper(graph->asns[index]);
+  return rids;
+}
+
+// -----[ _solver_propagate ]----------------------------------------
+/**
+ * Propagate the routes of the domains that already have one along
+ * the links of the given type, in order of increasing AS-Path
+ * length. The domains that have no route yet receive a route of the
+ * given class.
+ */
+static inline void _solver_propagate(as_level_graph_t * graph,
+				     net_addr_t * rids,
+				     aslevel_solution_t * solution,
+				     peer_type_t link_type, uint8_t class)
+{
+  unsigned int num_domains= graph->num_domains;
+  int * heads= (int *) MALLOC((num_domains+1) * sizeof(int));
+  int * next= (int *) MALLOC((num_domains+1) * sizeof(int));
+  unsigned int max_length= 0;
+  unsigned int length, pos;
+  int index, neighbor;
+
+  for (length= 0; length <= num_domains; length++)
+    heads[length]= -1;
+
+  // Bucket the domains that already have a route by AS-Path length
+  for (index= 0; index < (int) num_domains; index++) {
+    if (solution->classes[index] == ASLEVEL_ROUTE_NONE)
+      continue;
+    length= solution->lengths[index];
+    next[index]= heads[length];
+    heads[length]= index;
+    if (length > max_length)
+      max_length= length;
+  }
+
+  for (length= 0; (length <= max_length) && (length < num_domains);
+       length++) {
+    for (index= heads[length]; index >= 0; index= next[index]) {
+      for (pos= graph->offsets[index]; pos < graph->offsets[index+1];
+	   pos++) {
+	if (graph->types[pos] != link_type)
+	  continue;
+	neighbor= graph->neighbors[pos];
+
+	if (solution->classes[neighbor] == ASLEVEL_ROUTE_NONE) {
+	  solution->classes[neighbor]= class;
+	  solution->lengths[neighbor]= length+1;
+	  solution->next_hops[neighbor]= index;
+	  next[neighbor]= heads[length+1];
+	  heads[length+1]= neighbor;
+	  if (length+1 > max_length)
+	    max_length= length+1;
+	} else if ((solution->classes[neighbor] == class) &&
+		   (solution->lengths[neighbor] == length+1) &&
+		   (rids[index] <
+		    rids[solution->next_hops[neighbor]])) {
+	  // Tie-break: lowest router-ID
+	  solution->next_hops[neighbor]= index;
+	}
+      }
+    }
+  }
+
+  FREE(heads);
+  FREE(next);
+}
+
+// -----[ _solver_peer_routes ]--------------------------------------
+/**
+ * Select a route learned over a peer-to-peer link for the domains
+ * that have no customer route. A peer only advertises its customer
+ * (or local) routes.
+ */
+static inline void _solver_peer_routes(as_level_graph_t * graph,
+				       net_addr_t * rids,
+				       aslevel_solution_t * solution)
+{
+  unsigned int index, pos, neighbor;
+  int best;
+
+  for (index= 0; index < graph->num_domains; index++) {
+    if (solution->classes[index] != ASLEVEL_ROUTE_NONE)
+      continue;
+    best= -1;
+    for (pos= graph->offsets[index]; pos < graph->offsets[index+1]; pos++) {
+      if (graph->types[pos] != ASLEVEL_PEER_TYPE_PEER)
+	continue;
+      neighbor= graph->neighbors[pos];
+      if ((solution->classes[neighbor] != ASLEVEL_ROUTE_ORIGIN) &&
+	  (solution->classes[neighbor] != ASLEVEL_ROUTE_CUSTOMER))
+	continue;
+      if ((best < 0) ||
+	  (solution->lengths[neighbor] < solution->lengths[best]) ||
+	  ((solution->lengths[neighbor] == solution->lengths[best]) &&
+	   (rids[neighbor] < rids[best])))
+	best= neighbor;
+    }
+    if (best >= 0) {
+      solution->classes[index]= ASLEVEL_ROUTE_PEER;
+      solution->lengths[index]= solution->lengths[best]+1;
+      solution->next_hops[index]= best;
+    }
+  }
+}
+
+// -----[ aslevel_solve ]--------------------------------------------
+/**
+ * Compute the best route of each domain towards the given prefix,
+ * originated by the given domains.
+ *
+ * Return value:
+ *   ASLEVEL_SUCCESS                on success
+ *   ASLEVEL_ERROR_INVALID_ASNUM    if an origin does not exist
+ *   ASLEVEL_ERROR_NOT_IMPLEMENTED  if the topology has siblings
+ */
+int aslevel_solve(as_level_topo_t * topo, ip_pfx_t prefix,
+		  asn_t * origins, unsigned int num_origins,
+		  aslevel_solution_t ** solution_ref)
+{
+  aslevel_solution_t * solution;
+  as_level_graph_t * graph;
+  net_addr_t * rids;
+  unsigned int index, pos;
+
+  graph= aslevel_topo_get_graph(topo);
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+  rids= _solver_rids(topo, graph);
+  if (rids == NULL)
+    return ASLEVEL_ERROR_NOT_IMPLEMENTED;
+
+  solution= (aslevel_solution_t *) MALLOC(sizeof(aslevel_solution_t));
+  solution->topo= topo;
+  solution->prefix= prefix;
+  solution->num_domains= graph->num_domains;
+  solution->classes= (uint8_t *) MALLOC((graph->num_domains+1) *
+					sizeof(uint8_t));
+  solution->lengths= (unsigned int *) MALLOC((graph->num_domains+1) *
+					     sizeof(unsigned int));
+  solution->next_hops= (int *) MALLOC((graph->num_domains+1) *
+				      sizeof(int));
+  for (index= 0; index < graph->num_domains; index++) {
+    solution->classes[index]= ASLEVEL_ROUTE_NONE;
+    solution->lengths[index]= 0;
+    solution->next_hops[index]= -1;
+  }
+
+  // Locally originated routes
+  for (index= 0; index < num_origins; index++) {
+    if (aslevel_graph_find(graph, origins[index], &pos) != 0) {
+      aslevel_solution_destroy(&solution);
+      FREE(rids);
+      return ASLEVEL_ERROR_INVALID_ASNUM;
+    }
+    solution->classes[pos]= ASLEVEL_ROUTE_ORIGIN;
+  }
+
+  // 1). Customer routes (upwards)
+  _solver_propagate(graph, rids, solution, ASLEVEL_PEER_TYPE_PROVIDER,
+		    ASLEVEL_ROUTE_CUSTOMER);
+  // 2). Peer routes (one peer-to-peer link)
+  _solver_peer_routes(graph, rids, solution);
+  // 3). Provider routes (downwards)
+  _solver_propagate(graph, rids, solution, ASLEVEL_PEER_TYPE_CUSTOMER,
+		    ASLEVEL_ROUTE_PROVIDER);
+
+  FREE(rids);
+  *solution_ref= solution;
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_solution_destroy ]---------------------------------
+void aslevel_solution_destroy(aslevel_solution_t ** solution_ref)
+{
+  aslevel_solution_t * solution= *solution_ref;
+
+  if (solution != NULL) {
+    FREE(solution->classes);
+    FREE(solution->lengths);
+    FREE(solution->next_hops);
+    FREE(solution);
+    *solution_ref= NULL;
+  }
+}
+
+// -----[ _solver_class2str ]----------------------------------------
+static inline const char * _solver_class2str(uint8_t class)
+{
+  switch (class) {
+  case ASLEVEL_ROUTE_ORIGIN:
+    return "origin";
+  case ASLEVEL_ROUTE_CUSTOMER:
+    return "customer";
+  case ASLEVEL_ROUTE_PEER:
+    return "peer";
+  case ASLEVEL_ROUTE_PROVIDER:
+    return "provider";
+  default:
+    return "none";
+  }
+}
+
+// -----[ _solver_build_path ]---------------------------------------
+/**
+ * Build the AS-Path of the best route of a domain by following the
+ * chain of next-hop domains up to the origin.
+ */
+static inline bgp_path_t * _solver_build_path(aslevel_solution_t * solution,
+					      unsigned int index)
+{
+  bgp_path_t * path= path_create();
+  int hop= solution->next_hops[index];
+
+  while (hop >= 0) {
+    path_append(&path, _solver_domain_at(solution->topo, hop)->asn);
+    hop= solution->next_hops[hop];
+  }
+  return path;
+}
+
+// -----[ aslevel_solution_dump ]------------------------------------
+/**
+ * Dump the best route of each domain. Output format:
+ *   <asn> <class> <as-path>
+ */
+void aslevel_solution_dump(gds_stream_t * stream,
+			   aslevel_solution_t * solution)
+{
+  unsigned int index;
+  int hop;
+
+  for (index= 0; index < solution->num_domains; index++) {
+    stream_printf(stream, "%u\t%s\t",
+		  _solver_domain_at(solution->topo, index)->asn,
+		  _solver_class2str(solution->classes[index]));
+    hop= solution->next_hops[index];
+    while (hop >= 0) {
+      stream_printf(stream, "%u",
+		    _solver_domain_at(solution->topo, hop)->asn);
+      hop= solution->next_hops[hop];
+      if (hop >= 0)
+	stream_printf(stream, " ");
+    }
+    stream_printf(stream, "\n");
+  }
+}
+
+// -----[ aslevel_solution_install ]---------------------------------
+/**
+ * Install the computed best routes in the Loc-RIB of the routers.
+ * The routes carry the local-preference and communities that the
+ * valley-free policies would have assigned. The routes are not
+ * propagated: the Adj-RIB-Outs are left unchanged.
+ *
+ * PRE: the topology is installed.
+ */
+int aslevel_solution_install(aslevel_solution_t * solution)
+{
+  as_level_topo_t * topo= solution->topo;
+  as_level_domain_t * domain, * neighbor;
+  as_level_link_t * link;
+  bgp_route_t * route;
+  unsigned int index;
+
+  if (topo->state < ASLEVEL_STATE_INSTALLED)
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+
+  for (index= 0; index < solution->num_domains; index++) {
+    if ((solution->classes[index] == ASLEVEL_ROUTE_NONE) ||
+	(solution->classes[index] == ASLEVEL_ROUTE_ORIGIN))
+      continue;
+    domain= _solver_domain_at(topo, index);
+    neighbor= _solver_domain_at(topo, solution->next_hops[index]);
+    link= aslevel_as_get_link(domain, neighbor);
+    if ((link == NULL) || (link->peer == NULL))
+      return ASLEVEL_ERROR_UNEXPECTED;
+
+    route= route_create(solution->prefix, link->peer,
+			topo->addr_mapper(neighbor->asn), BGP_ORIGIN_IGP);
+    route_set_path(route, _solver_build_path(solution, index));
+    switch (solution->classes[index]) {
+    case ASLEVEL_ROUTE_CUSTOMER:
+      route_localpref_set(route, ASLEVEL_PREF_CUST);
+      break;
+    case ASLEVEL_ROUTE_PEER:
+      route_comm_append(route, COMM_PEER);
+      route_localpref_set(route, ASLEVEL_PREF_PEER);
+      break;
+    case ASLEVEL_ROUTE_PROVIDER:
+      route_comm_append(route, COMM_PROV);
+      route_localpref_set(route, ASLEVEL_PREF_PROV);
+      break;
+    }
+
+    if (bgp_router_install_best(domain->router, route) != ESUCCESS)
+      return ASLEVEL_ERROR_UNEXPECTED;
+  }
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_solution_verify ]----------------------------------
+/**
+ * Compare the computed best routes with the best routes found in
+ * the Loc-RIB of the routers (e.g. after a simulation). Each
+ * mismatch is reported on the given stream. A route matches if it
+ * has the same next-hop and the same AS-Path length.
+ *
+ * PRE: the topology is installed.
+ */
+int aslevel_solution_verify(gds_stream_t * stream,
+			    aslevel_solution_t * solution,
+			    unsigned int * num_mismatches)
+{
+  as_level_topo_t * topo= solution->topo;
+  as_level_domain_t * domain, * neighbor;
+  bgp_route_t * route;
+  unsigned int index;
+  uint8_t class;
+  net_addr_t next_hop= NET_ADDR_ANY;
+  int match;
+
+  if (topo->state < ASLEVEL_STATE_INSTALLED)
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+
+  *num_mismatches= 0;
+  for (index= 0; index < solution->num_domains; index++) {
+    domain= _solver_domain_at(topo, index);
+    route= bgp_router_find_best(domain->router, solution->prefix);
+    class= solution->classes[index];
+    if (solution->next_hops[index] >= 0) {
+      neighbor= _solver_domain_at(topo, solution->next_hops[index]);
+      next_hop= topo->addr_mapper(neighbor->asn);
+    }
+
+    switch (class) {
+    case ASLEVEL_ROUTE_NONE:
+      match= (route == NULL);
+      break;
+    case ASLEVEL_ROUTE_ORIGIN:
+      match= ((route != NULL) && (route->peer == NULL));
+      break;
+    default:
+      match= ((route != NULL) && (route->peer != NULL) &&
+	      (route->attr->next_hop == next_hop) &&
+	      (route_path_length(route) == solution->lengths[index]));
+    }
+    if (match)
+      continue;
+
+    (*num_mismatches)++;
+    stream_printf(stream, "mismatch AS%u: expected %s",
+		  domain->asn, _solver_class2str(class));
+    if ((class != ASLEVEL_ROUTE_NONE) && (class != ASLEVEL_ROUTE_ORIGIN)) {
+      stream_printf(stream, " (next-hop ");
+      ip_address_dump(stream, next_hop);
+      stream_printf(stream, ", length %u)", solution->lengths[index]);
+    }
+    stream_printf(stream, ", found ");
+    if (route == NULL)
+      stream_printf(stream, "no route");
+    else if (route->peer == NULL)
+      stream_printf(stream, "local route");
+    else {
+      stream_printf(stream, "next-hop ");
+      ip_address_dump(stream, route->attr->next_hop);
+      stream_printf(stream, ", length %d", route_path_length(route));
+    }
+    stream_printf(stream, "\n");
+  }
+  stream_printf(stream, "verified %u domains, %u mismatch(es)\n",
+		solution->num_domains, *num_mismatches);
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ _solver_find_origins ]-------------------------------------
+/**
+ * Find the domains whose router locally originates the prefix.
+ */
+static inline unsigned int _solver_find_origins(as_level_topo_t * topo,
+						ip_pfx_t prefix,
+						asn_t * origins)
+{
+  unsigned int num_origins= 0;
+  unsigned int index, index2;
+  as_level_domain_t * domain;
+  bgp_route_t * route;
+
+  for (index= 0; index < aslevel_topo_num_nodes(topo); index++) {
+    domain= _solver_domain_at(topo, index);
+    if (domain->router == NULL)
+      continue;
+    for (index2= 0; index2 < bgp_routes_size(domain->router->local_nets);
+	 index2++) {
+      route= bgp_routes_at(domain->router->local_nets, index2);
+      if (!ip_prefix_cmp(&route->prefix, &prefix)) {
+	origins[num_origins++]= domain->asn;
+	break;
+      }
+    }
+  }
+  return num_origins;
+}
+
+// -----[ aslevel_topo_solve ]---------------------------------------
+/**
+ * Compute the best routes towards a prefix in the loaded topology.
+ * If no origin is specified, the origins are the routers that
+ * locally originate the prefix (the topology must be installed).
+ *
+ * Options:
+ *   ASLEVEL_SOLVE_OPT_INSTALL  install the routes in the Loc-RIBs
+ *   ASLEVEL_SOLVE_OPT_VERIFY   compare with the Loc-RIBs
+ * If both options are given, the routes are compared with the
+ * Loc-RIBs before they are installed. If no option is given, the
+ * routes are dumped on the stream.
+ */
+int aslevel_topo_solve(gds_stream_t * stream, ip_pfx_t prefix,
+		       asn_t * origin, uint8_t options,
+		       unsigned int * num_mismatches)
+{
+  as_level_topo_t * topo= aslevel_get_topo();
+  aslevel_solution_t * solution;
+  asn_t * origins;
+  unsigned int num_origins;
+  int result;
+
+  *num_mismatches= 0;
+
+  if (topo == NULL)
+    return ASLEVEL_ERROR_NO_TOPOLOGY;
+  if ((options != 0) && (topo->state < ASLEVEL_STATE_INSTALLED))
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+
+  origins= (asn_t *) MALLOC((aslevel_topo_num_nodes(topo)+1) *
+			    sizeof(asn_t));
+  if (origin != NULL) {
+    origins[0]= *origin;
+    num_origins= 1;
+  } else
+    num_origins= _solver_find_origins(topo, prefix, origins);
+  if (num_origins == 0) {
+    FREE(origins);
+    return ASLEVEL_ERROR_NO_ORIGIN;
+  }
+
+  result= aslevel_solve(topo, prefix, origins, num_origins, &solution);
+  FREE(origins);
+  if (result != ASLEVEL_SUCCESS)
+    return result;
+
+  // Verify first, otherwise the installed routes would be compared
+  // with themselves
+  if (options & ASLEVEL_SOLVE_OPT_VERIFY)
+    result= aslevel_solution_verify(stream, solution, num_mismatches);
+  if ((result == ASLEVEL_SUCCESS) && (options & ASLEVEL_SOLVE_OPT_INSTALL))
+    result= aslevel_solution_install(solution);
+  if (options == 0)
+    aslevel_solution_dump(stream, solution);
+
+  aslevel_solution_destroy(&solution);
+  return result;
+}
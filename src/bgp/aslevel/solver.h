@@ -0,0 +1,77 @@
+// ==================================================================
+// @(#)solver.h
+//
+// Compute the outcome of BGP in an AS-level topology with
+// valley-free (Gao-Rexford) policies, without simulating the
+// exchange of BGP messages.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_ASLEVEL_SOLVER_H__
+#define __BGP_ASLEVEL_SOLVER_H__
+
+#include <libgds/stream.h>
+
+#include <bgp/aslevel/as-level.h>
+
+// ----- Route classes -----
+#define ASLEVEL_ROUTE_NONE     0
+#define ASLEVEL_ROUTE_ORIGIN   1
+#define ASLEVEL_ROUTE_CUSTOMER 2
+#define ASLEVEL_ROUTE_PEER     3
+#define ASLEVEL_ROUTE_PROVIDER 4
+
+// ----- Solver options -----
+#define ASLEVEL_SOLVE_OPT_INSTALL 0x01
+#define ASLEVEL_SOLVE_OPT_VERIFY  0x02
+
+// -----[ aslevel_solution_t ]---------------------------------------
+/**
+ * Best route of each domain towards a prefix. The arrays are indexed
+ * by the position of the domains in the topology.
+ */
+typedef struct {
+  as_level_topo_t * topo;
+  ip_pfx_t          prefix;
+  unsigned int      num_domains;
+  /** Class of the best route (ASLEVEL_ROUTE_xxx). */
+  uint8_t         * classes;
+  /** AS-Path length of the best route. */
+  unsigned int    * lengths;
+  /** Index of the next-hop domain (-1 if none). */
+  int             * next_hops;
+} aslevel_solution_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ aslevel_solve ]------------------------------------------
+  int aslevel_solve(as_level_topo_t * topo, ip_pfx_t prefix,
+		    asn_t * origins, unsigned int num_origins,
+		    aslevel_solution_t ** solution_ref);
+  // -----[ aslevel_solution_destroy ]-------------------------------
+  void aslevel_solution_destroy(aslevel_solution_t ** solution_ref);
+  // -----[ aslevel_solution_dump ]----------------------------------
+  void aslevel_solution_dump(gds_stream_t * stream,
+			     aslevel_solution_t * solution);
+  // -----[ aslevel_solution_install ]-------------------------------
+  int aslevel_solution_install(aslevel_solution_t * solution);
+  // -----[ aslevel_solution_verify ]--------------------------------
+  int aslevel_solution_verify(gds_stream_t * stream,
+			      aslevel_solution_t * solution,
+			      unsigned int * num_mismatches);
+
+  // -----[ aslevel_topo_solve ]-------------------------------------
+  int aslevel_topo_solve(gds_stream_t * stream, ip_pfx_t prefix,
+			 asn_t * origin, uint8_t options,
+			 unsigned int * num_mismatches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_ASLEVEL_SOLVER_H__ */
@@ -16,39 +16,45 @@
 #include <assert.h>
 #include <string.h>
 
+#include <libgds/memory.h>
+
 #include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/graph.h>
+#include <bgp/aslevel/stat.h>
 #include <bgp/aslevel/types.h>
 
-#define MAX_DEGREE MAX_AS
-
 // -----[ aslevel_stat_degree ]--------------------------------------
-void aslevel_stat_degree(gds_stream_t * stream, as_level_topo_t * topo,
-			 int cumulated, int normalized, int inverse)
+int aslevel_stat_degree(gds_stream_t * stream, as_level_topo_t * topo,
+			int cumulated, int normalized, int inverse)
 {
-  unsigned int auDegreeFrequency[MAX_DEGREE];
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  unsigned int * degree_frequency;
   unsigned int index;
   unsigned int degree, max_degree= 0;
   double value, value2;
-  as_level_domain_t * domain;
   unsigned int num_values;
 
-  memset(auDegreeFrequency, 0, sizeof(auDegreeFrequency));
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+
+  // The degree of a domain is lower than the number of domains
+  num_values= graph->num_domains;
+  degree_frequency= (unsigned int *)
+    MALLOC((num_values+1) * sizeof(unsigned int));
+  memset(degree_frequency, 0, (num_values+1) * sizeof(unsigned int));
   
-  num_values= 0;
-  for (index= 0; index < aslevel_topo_num_nodes(topo); index++) {
-    domain= (as_level_domain_t *) topo->domains->data[index];
-    degree= ptr_array_length(domain->neighbors);
+  for (index= 0; index < num_values; index++) {
+    degree= graph->offsets[index+1]-graph->offsets[index];
     if (degree > max_degree)
       max_degree= degree;
-    assert(degree < MAX_DEGREE);
-    auDegreeFrequency[degree]++;
-    num_values++;
+    assert(degree <= num_values);
+    degree_frequency[degree]++;
   }
 
   value= 0;
   for (index= 0; index < max_degree; index++) {
-    value2= auDegreeFrequency[index];
+    value2= degree_frequency[index];
     if (normalized)
       value2= value2/(1.0*num_values);
     if (cumulated)
@@ -60,4 +66,104 @@ void aslevel_stat_degree(gds_stream_t * stream, as_level_topo_t * topo,
     else
       stream_printf(stream, "%d\t%f\n", index, value);
   }
+
+  FREE(degree_frequency);
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_stat_customer_cones ]------------------------------
+/**
+ * Report the size of the customer cone of each domain
+ * (see aslevel_graph_customer_cones).
+ *
+ * Output format:
+ *   <asn> <num-customers> <cone-size>
+ */
+int aslevel_stat_customer_cones(gds_stream_t * stream,
+				as_level_topo_t * topo)
+{
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  unsigned int * sizes;
+  unsigned int index;
+
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+
+  sizes= (unsigned int *)
+    MALLOC((graph->num_domains+1) * sizeof(unsigned int));
+  aslevel_graph_customer_cones(graph, sizes);
+  for (index= 0; index < graph->num_domains; index++)
+    stream_printf(stream, "%u\t%u\t%u\n", graph->asns[index],
+		  aslevel_graph_num_links(graph, index,
+					  ASLEVEL_PEER_TYPE_CUSTOMER),
+		  sizes[index]);
+  FREE(sizes);
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_stat_provider_free ]-------------------------------
+/**
+ * Report the domains that have no provider.
+ *
+ * Output format:
+ *   <asn> <num-customers> <num-peers>
+ */
+int aslevel_stat_provider_free(gds_stream_t * stream,
+			       as_level_topo_t * topo)
+{
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  unsigned int index;
+
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+
+  for (index= 0; index < graph->num_domains; index++) {
+    if (aslevel_graph_num_links(graph, index,
+				ASLEVEL_PEER_TYPE_PROVIDER) > 0)
+      continue;
+    stream_printf(stream, "%u\t%u\t%u\n", graph->asns[index],
+		  aslevel_graph_num_links(graph, index,
+					  ASLEVEL_PEER_TYPE_CUSTOMER),
+		  aslevel_graph_num_links(graph, index,
+					  ASLEVEL_PEER_TYPE_PEER));
+  }
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_stat_valley_free ]---------------------------------
+/**
+ * Report the domains that can be reached from the given domain along
+ * valley-free paths (see aslevel_graph_valley_free). The reached
+ * domains are only listed in verbose mode.
+ *
+ * Output format:
+ *   <asn> <num-reached> <num-domains>
+ *   [<reached-asn>]*
+ */
+int aslevel_stat_valley_free(gds_stream_t * stream,
+			     as_level_topo_t * topo, asn_t asn,
+			     int verbose)
+{
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  unsigned int source, index;
+  unsigned int num_reached;
+  uint8_t * reached= NULL;
+
+  if (graph == NULL)
+    return ASLEVEL_ERROR_INCONSISTENT;
+  if (aslevel_graph_find(graph, asn, &source) != 0)
+    return ASLEVEL_ERROR_INVALID_ASNUM;
+
+  if (verbose)
+    reached= (uint8_t *) MALLOC((graph->num_domains+1) * sizeof(uint8_t));
+  num_reached= aslevel_graph_valley_free(graph, source, reached);
+  stream_printf(stream, "%u\t%u\t%u\n", asn, num_reached,
+		graph->num_domains);
+  if (verbose) {
+    for (index= 0; index < graph->num_domains; index++)
+      if (reached[index])
+	stream_printf(stream, "%u\n", graph->asns[index]);
+    FREE(reached);
+  }
+  return ASLEVEL_SUCCESS;
 }
@@ -21,9 +21,19 @@ extern "C" {
 #endif
 
   // -----[ aslevel_stat_degree ]------------------------------------
-  void aslevel_stat_degree(gds_stream_t * stream, as_level_topo_t * topo,
-			   int cumulated, int normalized,
-			   int inverse);
+  int aslevel_stat_degree(gds_stream_t * stream, as_level_topo_t * topo,
+			  int cumulated, int normalized,
+			  int inverse);
+  // -----[ aslevel_stat_customer_cones ]----------------------------
+  int aslevel_stat_customer_cones(gds_stream_t * stream,
+				  as_level_topo_t * topo);
+  // -----[ aslevel_stat_provider_free ]-----------------------------
+  int aslevel_stat_provider_free(gds_stream_t * stream,
+				 as_level_topo_t * topo);
+  // -----[ aslevel_stat_valley_free ]-------------------------------
+  int aslevel_stat_valley_free(gds_stream_t * stream,
+			       as_level_topo_t * topo, asn_t asn,
+			       int verbose);
 
 #ifdef __cplusplus
 }
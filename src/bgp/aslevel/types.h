@@ -41,6 +41,26 @@ typedef struct as_level_link {
   peer_type_t         peer_type;
 } as_level_link_t;
 
+// -----[ as_level_graph_t ]-----------------------------------------
+/**
+ * Compact snapshot of an AS-level topology (compressed sparse row
+ * adjacency). Domains are identified by their position in the
+ * topology, i.e. in increasing ASN order. The links of the domain at
+ * position i are stored in [offsets[i], offsets[i+1]), sorted by
+ * neighbor position. The relationship of a link is given from the
+ * point of view of the domain (types[pos] == CUSTOMER means that
+ * neighbors[pos] is a customer).
+ */
+typedef struct as_level_graph_t {
+  unsigned int   num_domains;
+  unsigned int   num_links;
+  unsigned int   version;
+  asn_t        * asns;
+  unsigned int * offsets;
+  unsigned int * neighbors;
+  peer_type_t  * types;
+} as_level_graph_t;
+
 /** Domains cache depth. */
 #define ASLEVEL_TOPO_AS_CACHE_SIZE 2
 
@@ -51,6 +71,20 @@ typedef struct as_level_topo_t {
   as_level_domain_t      * cached_domains[ASLEVEL_TOPO_AS_CACHE_SIZE];
   as_level_addr_mapper_f   addr_mapper;
   uint8_t                  state;
+  as_level_graph_t       * graph;
 } as_level_topo_t;
 
+// -----[ aslevel_load_stats_t ]-------------------------------------
+/** Statistics of a topology load. */
+typedef struct {
+  unsigned int num_lines;
+  unsigned int num_edges;
+  unsigned int num_domains;
+  unsigned int num_links;
+  /** Time spent reading the file (in seconds). */
+  double       parse_time;
+  /** Time spent creating the domains and links (in seconds). */
+  double       build_time;
+} aslevel_load_stats_t;
+
 #endif /* __BGP_ASLEVEL_TYPES_H__ */
@@ -16,6 +16,7 @@
 #include <bgp/attr.h>
 #include <bgp/attr/comm_hash.h>
 #include <bgp/attr/path_hash.h>
+#include <util/slab.h>
 
 // -----[ Forward prototypes declaration ]---------------------------
 /* Note: functions starting with underscore (_) are intended to be
@@ -26,6 +27,8 @@ static inline void _bgp_attr_path_destroy(bgp_attr_t * attr);
 static inline void _bgp_attr_comm_destroy(bgp_attr_t ** pattr);
 static inline void _bgp_attr_ecomm_destroy(bgp_attr_t * attr);
 
+SLAB_CACHE(_attr_cache, "bgp-attr", bgp_attr_t, MEM_ACCT_BGP_ATTRS);
+
 // -----[ bgp_attr_set_nexthop ]-------------------------------------
 /**
  *
@@ -121,8 +124,8 @@ void bgp_attr_set_path(bgp_attr_t ** attr_ref, bgp_path_t * path)
 
 // -----[ bgp_attr_path_prepend ]------------------------------------
 /*
- * Copy the given AS-Path and update the references into the global
- * path repository.
+ * Build a prepended copy of the AS-Path and update the references
+ * into the global path repository.
  */
 int bgp_attr_path_prepend(bgp_attr_t ** attr_ref,
 			  asn_t asn, uint8_t amount)
@@ -131,17 +134,10 @@ int bgp_attr_path_prepend(bgp_attr_t ** attr_ref,
 
   /*log_printf(pLogErr, "-->PATH_PREPEND [%p]\n", (*pattr)->pASPathRef);*/
 
-  // Create extern AS-Path copy
-  if ((*attr_ref)->path_ref == NULL)
-    path= path_create();
-  else
-    path= path_copy((*attr_ref)->path_ref);
-
-  // Prepend
-  while (amount-- > 0) {
-    if (path_append(&path, asn) < 0)
-      return -1;
-  }
+  // Create extern prepended AS-Path (single copy)
+  path= path_prepend((*attr_ref)->path_ref, asn, amount);
+  if (path == NULL)
+    return -1;
 
   // Intern path
   bgp_attr_set_path(attr_ref, path);
@@ -410,7 +406,7 @@ bgp_attr_t * bgp_attr_create(net_addr_t next_hop,
 			     uint32_t local_pref,
 			     uint32_t med)
 {
-  bgp_attr_t * attr= (bgp_attr_t *) MALLOC(sizeof(bgp_attr_t));
+  bgp_attr_t * attr= (bgp_attr_t *) slab_alloc(&_attr_cache);
   attr->next_hop= next_hop;
   attr->origin= origin;
   attr->local_pref= local_pref;
@@ -449,7 +445,7 @@ void bgp_attr_destroy(bgp_attr_t ** attr_ref)
     cluster_list_destroy(&(*attr_ref)->router_list);
 #endif
 
-    FREE(*attr_ref);
+    slab_free(&_attr_cache, *attr_ref);
   }
 }
 
@@ -20,6 +20,7 @@
 #include <libgds/tokenizer.h>
 
 #include <bgp/attr/comm.h>
+#include <util/mem_acct.h>
 
 /**
  * Note: as we case 'uint32_t' variables to 'unsigned int' for
@@ -32,11 +33,14 @@
 
 static gds_tokenizer_t * pCommTokenizer= NULL;
 
+#define _comms_mem_size(N) (sizeof(bgp_comms_t)+(N)*sizeof(bgp_comm_t))
+
 // -----[ comms_create ]---------------------------------------------
 bgp_comms_t * comms_create()
 {
   bgp_comms_t * comms= (bgp_comms_t *) MALLOC(sizeof(bgp_comms_t));
   comms->num= 0;
+  mem_acct_charge(MEM_ACCT_BGP_COMMS, _comms_mem_size(0));
   return comms;
 }
 
@@ -46,6 +50,7 @@ void comms_destroy(bgp_comms_t ** comms_ref)
   bgp_comms_t * comms= *comms_ref;
   if (comms == NULL)
     return;
+  mem_acct_release(MEM_ACCT_BGP_COMMS, _comms_mem_size(comms->num));
   FREE(comms);
   *comms_ref= NULL;
 }
@@ -58,6 +63,7 @@ bgp_comms_t * comms_dup(const bgp_comms_t * comms)
 			     sizeof(bgp_comm_t)*comms->num);
   memcpy(new_comms, comms, sizeof(bgp_comms_t)+
 	 sizeof(bgp_comm_t)*comms->num);
+  mem_acct_charge(MEM_ACCT_BGP_COMMS, _comms_mem_size(comms->num));
   return new_comms;
 }
 
@@ -72,6 +78,7 @@ bgp_comms_t * comms_dup(const bgp_comms_t * comms)
 int comms_add(bgp_comms_t ** comms_ref, bgp_comm_t comm)
 {
   assert((*comms_ref)->num < 255);
+  mem_acct_charge(MEM_ACCT_BGP_COMMS, sizeof(bgp_comm_t));
   (*comms_ref)->num++;
   (*comms_ref)=
     (bgp_comms_t *) REALLOC(*comms_ref, sizeof(bgp_comms_t)+
@@ -110,8 +117,11 @@ void comms_remove(bgp_comms_t ** comms_ref, bgp_comm_t comm)
   if (comms->num == last_index)
     return;
 
+  mem_acct_release(MEM_ACCT_BGP_COMMS,
+		   _comms_mem_size(comms->num)-_comms_mem_size(last_index));
   comms->num= last_index;
   if (comms->num == 0) {
+    mem_acct_release(MEM_ACCT_BGP_COMMS, _comms_mem_size(0));
     FREE(*comms_ref);
     *comms_ref= NULL;
   } else {
@@ -24,9 +24,13 @@
 
 #include <bgp/attr/comm.h>
 #include <bgp/attr/comm_hash.h>
+#include <util/thread.h>
 
 static uint32_t _comm_hash_item_compute(const void * item,
 					unsigned int hash_size);
+// ---| Lock on the repository (parallel mode) |---
+static thread_mutex_t _comm_hash_lock= THREAD_MUTEX_INITIALIZER;
+
 // ---| Private parameters |---
 static struct {
   gds_hash_set_t    * hash;
@@ -103,9 +107,13 @@ void _comm_hash_item_destroy(void * item)
  */
 void * comm_hash_add(bgp_comms_t * comms)
 {
-  _comm_hash_init();
+  void * result;
   assert(comms != NULL);
-  return hash_set_add(_global_ref.hash, comms);
+  thread_mutex_lock(&_comm_hash_lock);
+  _comm_hash_init();
+  result= hash_set_add(_global_ref.hash, comms);
+  thread_mutex_unlock(&_comm_hash_lock);
+  return result;
 }
 
 // -----[ comm_hash_get ]--------------------------------------------
@@ -114,8 +122,12 @@ void * comm_hash_add(bgp_comms_t * comms)
  */
 bgp_comms_t * comm_hash_get(bgp_comms_t * comms)
 {
+  bgp_comms_t * result;
+  thread_mutex_lock(&_comm_hash_lock);
   _comm_hash_init();
-  return (bgp_comms_t *) hash_set_search(_global_ref.hash, comms);
+  result= (bgp_comms_t *) hash_set_search(_global_ref.hash, comms);
+  thread_mutex_unlock(&_comm_hash_lock);
+  return result;
 }
 
 // -----[ comm_hash_remove ]-----------------------------------------
@@ -124,8 +136,12 @@ bgp_comms_t * comm_hash_get(bgp_comms_t * comms)
  */
 int comm_hash_remove(bgp_comms_t * comms)
 {
+  int result;
+  thread_mutex_lock(&_comm_hash_lock);
   _comm_hash_init();
-  return hash_set_remove(_global_ref.hash, comms);
+  result= hash_set_remove(_global_ref.hash, comms);
+  thread_mutex_unlock(&_comm_hash_lock);
+  return result;
 }
 
 // -----[ comm_hash_refcnt ]-----------------------------------------
@@ -22,18 +22,100 @@
 #include <bgp/attr/path_hash.h>
 #include <bgp/attr/path_segment.h>
 #include <bgp/filter/filter.h>
+#include <util/mem_acct.h>
+#include <util/thread.h>
 
 static gds_tokenizer_t * path_tokenizer= NULL;
+static thread_mutex_t _path_match_lock= THREAD_MUTEX_INITIALIZER;
+
+#define _path_num_segments(P) ((P) == NULL?0:(P)->num_segs)
+#define _path_seg_size(L) (sizeof(bgp_path_seg_t)+((L) * sizeof(asn_t)))
+#define _path_first_seg(P) ((bgp_path_seg_t *) (P)->segs)
+#define _path_last_seg(P) \
+  ((bgp_path_seg_t *) ((P)->segs+(P)->last_offset))
+#define _path_next_seg(S) \
+  ((bgp_path_seg_t *) (((uint8_t *) (S))+_path_seg_size((S)->length)))
+#define _path_asn_bit(A) (1U << ((A) & 31))
+#define _path_fits(P, N) ((P)->size+(N) <= MAX_UINT16_T)
+
+// -----[ _path_resize ]---------------------------------------------
+/**
+ * Change the size of the packed segments area. The path's location
+ * in memory can change.
+ */
+static inline bgp_path_t * _path_resize(bgp_path_t * path, size_t size)
+{
+  mem_acct_charge(MEM_ACCT_BGP_PATHS, size);
+  mem_acct_release(MEM_ACCT_BGP_PATHS, path->size);
+  return (bgp_path_t *) REALLOC(path, sizeof(bgp_path_t)+size);
+}
 
-#define _path_num_segments(P) ((P) == NULL?0:ptr_array_length(P))
-#define _path_segment_at(P, I) (bgp_path_seg_t *) (P)->data[(I)]
-#define _path_segment_ref_at(P, I) (bgp_path_seg_t **) &((P)->data[(I)])
-#define _path_segment_set(P, I, V) (P)->data[(I)]= (V)
+// -----[ _path_new_seg ]--------------------------------------------
+/**
+ * Append an uninitialized segment of the given type and length at
+ * the end of the path. The path must have been resized beforehand.
+ */
+static inline bgp_path_seg_t * _path_new_seg(bgp_path_t * path,
+					     uint8_t type, uint8_t length)
+{
+  bgp_path_seg_t * seg= (bgp_path_seg_t *) (path->segs+path->size);
+
+  // Clear header padding
+  memset(seg, 0, sizeof(bgp_path_seg_t));
+  seg->type= type;
+  seg->length= length;
+  path->last_offset= path->size;
+  path->size+= _path_seg_size(length);
+  path->num_segs++;
+  path->hash+= type;
+  return seg;
+}
 
-// ----- _path_destroy_segment --------------------------------------
-static void _path_destroy_segment(void * item, const void * ctx)
+// -----[ _path_cache_add ]------------------------------------------
+/**
+ * Update the cached information when an ASN is added at the end of
+ * an AS-SEQUENCE segment.
+ */
+static inline void _path_cache_add(bgp_path_t * path, asn_t asn)
 {
-  path_segment_destroy((bgp_path_seg_t **) item);
+  if (path->length == 0)
+    path->first_asn= asn;
+  path->length++;
+  path->last_asn= asn;
+  path->hash+= (asn & 255) + (asn >> 8);
+  path->asn_mask|= _path_asn_bit(asn);
+}
+
+// -----[ _path_cache_update ]---------------------------------------
+/**
+ * Recompute all the cached information from the packed segments.
+ */
+static void _path_cache_update(bgp_path_t * path)
+{
+  bgp_path_seg_t * seg= _path_first_seg(path);
+  unsigned int index, seg_index;
+
+  path->length= 0;
+  path->hash= 0;
+  path->asn_mask= 0;
+  path->first_asn= 0;
+  path->last_asn= 0;
+  path->last_offset= 0;
+  for (index= 0; index < path->num_segs; index++) {
+    path->last_offset= ((uint8_t *) seg) - path->segs;
+    path->hash+= seg->type;
+    path->length+= (seg->type == AS_PATH_SEGMENT_SET)?1:seg->length;
+    for (seg_index= 0; seg_index < seg->length; seg_index++) {
+      path->hash+= (seg->asns[seg_index] & 255) +
+	(seg->asns[seg_index] >> 8);
+      path->asn_mask|= _path_asn_bit(seg->asns[seg_index]);
+    }
+    if ((index == 0) && (seg->length > 0))
+      path->first_asn= seg->asns[0];
+    if (seg->length > 0)
+      path->last_asn= seg->asns[seg->length-1];
+    seg= _path_next_seg(seg);
+  }
 }
 
 // ----- path_create ------------------------------------------------
@@ -42,8 +124,10 @@ static void _path_destroy_segment(void * item, const void * ctx)
  */
 bgp_path_t * path_create()
 {
-  return (bgp_path_t *) ptr_array_create(0, NULL,
-					 _path_destroy_segment, NULL);
+  bgp_path_t * path= (bgp_path_t *) MALLOC(sizeof(bgp_path_t));
+  memset(path, 0, sizeof(bgp_path_t));
+  mem_acct_charge(MEM_ACCT_BGP_PATHS, sizeof(bgp_path_t));
+  return path;
 }
 
 // ----- path_destroy -----------------------------------------------
@@ -52,7 +136,11 @@ bgp_path_t * path_create()
  */
 void path_destroy(bgp_path_t ** ppath)
 {
-  ptr_array_destroy(ppath);
+  if (*ppath != NULL) {
+    mem_acct_release(MEM_ACCT_BGP_PATHS, path_size(*ppath));
+    FREE(*ppath);
+    *ppath= NULL;
+  }
 }
 
 // ----- path_max_value ---------------------------------------------
@@ -74,19 +162,18 @@ bgp_path_t * path_max_value()
 
 // ----- path_copy --------------------------------------------------
 /**
- * Duplicate an existing AS-Path.
+ * Duplicate an existing AS-Path. This is a single memory copy.
  */
 bgp_path_t * path_copy(bgp_path_t * path)
 {
-  bgp_path_t * new_path= NULL;
-  unsigned int i;
+  bgp_path_t * new_path;
 
   if (path == NULL)
     return NULL;
 
-  new_path= path_create();
-  for (i= 0; i < _path_num_segments(path); i++)
-    path_add_segment(new_path, path_segment_copy(_path_segment_at(path, i)));
+  new_path= (bgp_path_t *) MALLOC(sizeof(bgp_path_t)+path->size);
+  memcpy(new_path, path, sizeof(bgp_path_t)+path->size);
+  mem_acct_charge(MEM_ACCT_BGP_PATHS, sizeof(bgp_path_t)+path->size);
   return new_path;
 }
 
@@ -101,12 +188,97 @@ int path_num_segments(const bgp_path_t * path)
 
 
 // ----- path_segment_at ------------------------------------------
+/**
+ * Return the segment at the given index. The returned segment lies
+ * in the AS-Path memory block: it must not be modified nor freed and
+ * it is invalidated by any change to the AS-Path.
+ */
 bgp_path_seg_t * path_segment_at(bgp_path_t * path, int index)
 {
+  bgp_path_seg_t * seg;
+
   assert(index >= 0);
-  if (index > _path_num_segments(path))
+  if (index >= _path_num_segments(path))
+    return NULL;
+  seg= _path_first_seg(path);
+  while (index-- > 0)
+    seg= _path_next_seg(seg);
+  return seg;
+}
+
+// -----[ path_segment_next ]----------------------------------------
+/**
+ * Iterate over the segments: return the first segment if seg is
+ * NULL, the segment that follows seg otherwise, and NULL after the
+ * last segment. Use this function instead of path_segment_at to
+ * walk through all the segments.
+ */
+bgp_path_seg_t * path_segment_next(const bgp_path_t * path,
+				   const bgp_path_seg_t * seg)
+{
+  if (_path_num_segments(path) == 0)
+    return NULL;
+  if (seg == NULL)
+    return _path_first_seg(path);
+  if (((const uint8_t *) seg) - path->segs >= path->last_offset)
+    return NULL;
+  return _path_next_seg(seg);
+}
+
+// -----[ _path_segments ]-------------------------------------------
+/**
+ * Fill an array with the segments of the path (used to walk the
+ * segments in reverse order). The array is allocated if the
+ * provided one is too small and must then be freed by the caller.
+ */
+#define _PATH_SEGS_STACK 16
+static bgp_path_seg_t ** _path_segments(const bgp_path_t * path,
+					bgp_path_seg_t ** segs)
+{
+  bgp_path_seg_t * seg= NULL;
+  unsigned int index= 0;
+
+  if (_path_num_segments(path) > _PATH_SEGS_STACK)
+    segs= (bgp_path_seg_t **) MALLOC(_path_num_segments(path)*
+				     sizeof(bgp_path_seg_t *));
+  while ((seg= path_segment_next(path, seg)) != NULL)
+    segs[index++]= seg;
+  return segs;
+}
+
+// -----[ path_size ]------------------------------------------------
+/**
+ * Return the memory used by the AS-Path (in bytes, allocator
+ * overhead excluded).
+ */
+size_t path_size(const bgp_path_t * path)
+{
+  if (path == NULL)
+    return 0;
+  return sizeof(bgp_path_t)+path->size;
+}
+
+// -----[ path_segmented_size ]--------------------------------------
+/**
+ * Return the memory that the AS-Path would use if stored as an array
+ * of separately allocated segments: array descriptor, array of
+ * segment pointers and segments (allocator overhead excluded).
+ */
+size_t path_segmented_size(const bgp_path_t * path)
+{
+  size_t size= sizeof(ptr_array_t);
+  unsigned int index;
+  bgp_path_seg_t * seg;
+
+  if (path == NULL)
     return 0;
-  return _path_segment_at(path, index);
+  size+= path->num_segs * sizeof(void *);
+  seg= _path_first_seg(path);
+  for (index= 0; index < path->num_segs; index++) {
+    size+= _path_seg_size(seg->length);
+    seg= _path_next_seg(seg);
+  }
+  return size;
 }
 
 // ----- path_length ------------------------------------------------
@@ -114,43 +286,43 @@ bgp_path_seg_t * path_segment_at(bgp_path_t * path, int index)
  * Return the number of AS hops in the given AS-Path. The length of an
  * AS-SEQUENCE segment is equal to the number of ASs which compose
  * it. The length of an AS-SET is equal to 1.
+ *
+ * The length is cached in the AS-Path header.
  */
 int path_length(bgp_path_t * path)
 {
-  int length= 0;
-  unsigned int index;
-  bgp_path_seg_t * seg;
-
   if (path == NULL)
     return 0;
-
-  for (index= 0; index < _path_num_segments(path); index++) {
-    seg= _path_segment_at(path, index);
-    switch (seg->type) {
-    case AS_PATH_SEGMENT_SEQUENCE:
-      length+= seg->length;
-      break;
-    case AS_PATH_SEGMENT_SET:
-      length++;
-      break;
-    default:
-      abort();
-    }
-  }
-  return length;
+  return path->length;
 }
 
 // ----- path_add_segment -------------------------------------------
 /**
- * Add the given segment to the given path.
+ * Add the given segment at the end of the given path. The segment is
+ * copied into the path and then destroyed. Since the size of the
+ * path changes, its location in memory can change.
  *
  * Return value:
  *   >= 0   in case of success
  *   -1     in case of failure
  */
-int path_add_segment(bgp_path_t * path, bgp_path_seg_t * seg)
+int path_add_segment(bgp_path_t ** path_ref, bgp_path_seg_t * seg)
 {
-  return ptr_array_append(path, seg);
+  bgp_path_t * path= *path_ref;
+  bgp_path_seg_t * new_seg;
+
+  if (!_path_fits(path, _path_seg_size(seg->length))) {
+    path_segment_destroy(&seg);
+    return -1;
+  }
+
+  path= _path_resize(path, path->size+_path_seg_size(seg->length));
+  new_seg= _path_new_seg(path, seg->type, seg->length);
+  memcpy(new_seg->asns, seg->asns, seg->length * sizeof(asn_t));
+  path_segment_destroy(&seg);
+  _path_cache_update(path);
+  *path_ref= path;
+  return path->num_segs-1;
 }
 
 // ----- path_append ------------------------------------------------
@@ -162,46 +334,111 @@ int path_add_segment(bgp_path_t * path, bgp_path_seg_t * seg)
  * of the AS-Path.
  *
  * Return value:
- *   length(new AS-Path)   in case of success
- *   -1                    in case of error
+ *   number of segments   in case of success
+ *   -1                   in case of error
  */
 int path_append(bgp_path_t ** ppath, asn_t asn)
 {
-  int length= path_num_segments(*ppath);
-
+  bgp_path_t * path= *ppath;
   bgp_path_seg_t * seg;
 
-  if (length <= 0) {
-    seg= path_segment_create(AS_PATH_SEGMENT_SEQUENCE, 1);
-    seg->asns[0]= asn;
-    path_add_segment(*ppath, seg);
-  } else {
-
-    // Find last segment.
-    // - if it is a SEQUENCE, append.
-    // - if it is a SET, create new segment.
-    seg= _path_segment_at(*ppath, length-1);
+  if (path->num_segs > 0) {
+    seg= _path_last_seg(path);
     switch (seg->type) {
     case AS_PATH_SEGMENT_SEQUENCE:
-      if (path_segment_add(_path_segment_ref_at(*ppath, length-1), asn))
+      if ((seg->length >= MAX_PATH_SEQUENCE_LENGTH) ||
+	  !_path_fits(path, sizeof(asn_t)))
 	return -1;
-      break;
+      path= _path_resize(path, path->size+sizeof(asn_t));
+      seg= _path_last_seg(path);
+      seg->asns[seg->length++]= asn;
+      path->size+= sizeof(asn_t);
+      _path_cache_add(path, asn);
+      *ppath= path;
+      return path->num_segs;
     case AS_PATH_SEGMENT_SET:
-      seg= path_segment_create(AS_PATH_SEGMENT_SEQUENCE, 1);
-      seg->asns[0]= asn;
-      path_add_segment(*ppath, seg);
-      length++;
       break;
     default:
       abort();
     }
   }
-  return length;
+
+  if (!_path_fits(path, _path_seg_size(1)))
+    return -1;
+  path= _path_resize(path, path->size+_path_seg_size(1));
+  seg= _path_new_seg(path, AS_PATH_SEGMENT_SEQUENCE, 1);
+  seg->asns[0]= asn;
+  _path_cache_add(path, asn);
+  *ppath= path;
+  return path->num_segs;
+}
+
+// -----[ path_prepend ]---------------------------------------------
+/**
+ * Build a new AS-Path made of the given AS-Path with the given ASN
+ * prepended 'amount' times (the ASNs are stored at the end of the
+ * last AS-SEQUENCE, see path_append). The new AS-Path is built with
+ * a single allocation and a copy of the original memory block. The
+ * original AS-Path is left unchanged. A NULL AS-Path is handled as
+ * an empty AS-Path.
+ *
+ * Return value:
+ *   new AS-Path   in case of success
+ *   NULL          if the last AS-SEQUENCE (or the AS-Path) can not
+ *                 hold the new ASNs
+ */
+bgp_path_t * path_prepend(const bgp_path_t * path, asn_t asn,
+			  uint8_t amount)
+{
+  bgp_path_t * new_path;
+  bgp_path_seg_t * seg= NULL;
+  size_t size;
+
+  if ((path != NULL) && (path->num_segs > 0)) {
+    seg= _path_last_seg(path);
+    if (seg->type != AS_PATH_SEGMENT_SEQUENCE)
+      seg= NULL;
+    else if (seg->length+amount > MAX_PATH_SEQUENCE_LENGTH)
+      return NULL;
+  }
+
+  size= (path == NULL)?0:path->size;
+  if (seg != NULL)
+    size+= amount * sizeof(asn_t);
+  else
+    size+= _path_seg_size(amount);
+  if (size > MAX_UINT16_T)
+    return NULL;
+
+  new_path= (bgp_path_t *) MALLOC(sizeof(bgp_path_t)+size);
+  mem_acct_charge(MEM_ACCT_BGP_PATHS, sizeof(bgp_path_t)+size);
+  if (path == NULL)
+    memset(new_path, 0, sizeof(bgp_path_t));
+  else
+    memcpy(new_path, path, sizeof(bgp_path_t)+path->size);
+
+  if (amount == 0)
+    return new_path;
+
+  if (seg != NULL) {
+    seg= _path_last_seg(new_path);
+    new_path->size+= amount * sizeof(asn_t);
+  } else {
+    seg= _path_new_seg(new_path, AS_PATH_SEGMENT_SEQUENCE, 0);
+    new_path->size= size;
+  }
+  while (amount-- > 0) {
+    seg->asns[seg->length++]= asn;
+    _path_cache_add(new_path, asn);
+  }
+  return new_path;
 }
 
 // ----- path_contains ----------------------------------------------
 /**
- * Test if the given AS-Path contains the given AS number.
+ * Test if the given AS-Path contains the given AS number. The cached
+ * ASN bitmask allows most negative answers to be given without
+ * scanning the segments.
  *
  * Return value:
  *   1  if the path contains the ASN
@@ -209,14 +446,22 @@ int path_append(bgp_path_t ** ppath, asn_t asn)
  */
 int path_contains(bgp_path_t * path, asn_t asn)
 {
-  unsigned int i;
+  unsigned int index;
+  bgp_path_seg_t * seg;
 
   if (path == NULL)
     return 0;
 
-  for (i= 0; i < _path_num_segments(path); i++) {
-    if (path_segment_contains(_path_segment_at(path, i), asn) != 0)
+  if (!(path->asn_mask & _path_asn_bit(asn)))
+    return 0;
+  if ((path->last_asn == asn) || (path->first_asn == asn))
+    return 1;
+
+  seg= _path_first_seg(path);
+  for (index= 0; index < path->num_segs; index++) {
+    if (path_segment_contains(seg, asn) != 0)
       return 1;
+    seg= _path_next_seg(seg);
   }
   return 0;
 }
@@ -228,33 +473,33 @@ int path_contains(bgp_path_t * path, asn_t asn)
  */
 static int _path_at(bgp_path_t * path, int pos, asn_t * asn_ref)
 {
-  unsigned int index, seg_index;
+  unsigned int index;
   bgp_path_seg_t * seg;
 
-  for (index= 0; (pos > 0) && 
-	 (index < _path_num_segments(path));
-       index++) {
-    seg= _path_segment_at(path, index);
+  if (path == NULL)
+    return -1;
+
+  seg= _path_first_seg(path);
+  for (index= 0; index < path->num_segs; index++) {
     switch (seg->type) {
     case AS_PATH_SEGMENT_SEQUENCE:
-      for (seg_index= 0; seg_index ; seg_index++) {
-	if (pos == 0) {
-	  *asn_ref= seg->asns[seg_index];
-	  return 0;
-	}
-	pos++;
+      if (pos < seg->length) {
+	*asn_ref= seg->asns[pos];
+	return 0;
       }
+      pos-= seg->length;
       break;
     case AS_PATH_SEGMENT_SET:
       if (pos == 0) {
 	*asn_ref= seg->asns[0];
 	return 0;
       }
-      pos++;
+      pos--;
       break;
     default:
       abort();
     }
+    seg= _path_next_seg(seg);
   }
   return -1;
 }
@@ -268,19 +513,13 @@ static int _path_at(bgp_path_t * path, int pos, asn_t * asn_ref)
  * AS-numbers in this case.
  */
 int path_last_as(bgp_path_t * path, asn_t * asn_ref) {
-  bgp_path_seg_t * seg;
-
   if (path_length(path) <= 0)
     return -1;
 
-  seg= _path_segment_at(path, _path_num_segments(path)-1);
-  
   // Check that the segment is of type AS_SEQUENCE 
-  assert(seg->type == AS_PATH_SEGMENT_SEQUENCE);
-  // Check that segment's size is larger than 0
-  assert(seg->length > 0);
+  assert(_path_last_seg(path)->type == AS_PATH_SEGMENT_SEQUENCE);
 
-  *asn_ref= seg->asns[seg->length-1];
+  *asn_ref= path->last_asn;
   return 0;
 }
 
@@ -294,19 +533,13 @@ int path_last_as(bgp_path_t * path, asn_t * asn_ref) {
  * AS-numbers in this case.
  */
 int path_first_as(bgp_path_t * path, asn_t * asn_ref) {
-  bgp_path_seg_t * seg;
-
   if (path_length(path) <= 0)
     return -1;
 
-  seg= _path_segment_at(path, 0);
-
   // Check that the segment is of type AS_SEQUENCE 
-  assert(seg->type == AS_PATH_SEGMENT_SEQUENCE);
-  // Check that segment's size is larger than 0
-  assert(seg->length > 0);
+  assert(_path_first_seg(path)->type == AS_PATH_SEGMENT_SEQUENCE);
 
-  *asn_ref= seg->asns[0];
+  *asn_ref= path->first_asn;
   return 0;
 }
 
@@ -332,6 +565,9 @@ int path_to_string(bgp_path_t * path, int reverse,
   unsigned int index;
   int iWritten= 0;
   unsigned int num_segs;
+  bgp_path_seg_t * stack_segs[_PATH_SEGS_STACK];
+  bgp_path_seg_t ** segs;
+  bgp_path_seg_t * seg;
 
   if ((path == NULL) || (_path_num_segments(path) == 0)) {
     if (dst_size < 1)
@@ -342,27 +578,33 @@ int path_to_string(bgp_path_t * path, int reverse,
 
   if (reverse) {
     num_segs= _path_num_segments(path);
+    segs= _path_segments(path, stack_segs);
     for (index= num_segs; index > 0; index--) {
       // Write space (if required)
       if (index < num_segs) {
 	iWritten= snprintf(dst, dst_size, " ");
 	if (iWritten >= dst_size)
-	  return -1;
+	  break;
 	dst+= iWritten;
 	dst_size-= iWritten;
       }
 
       // Write AS-Path segment
-      iWritten= path_segment_to_string(_path_segment_at(path, index-1),
+      iWritten= path_segment_to_string(segs[index-1],
 				       reverse, dst, dst_size);
       if (iWritten >= dst_size)
-	return -1;
+	break;
       dst+= iWritten;
       dst_size-= iWritten;
     }
+    if (segs != stack_segs)
+      FREE(segs);
+    if (index > 0)
+      return -1;
 
   } else {
-    for (index= 0; index < _path_num_segments(path);
+    seg= NULL;
+    for (index= 0; (seg= path_segment_next(path, seg)) != NULL;
 	 index++) {
       // Write space (if required)
       if (index > 0) {
@@ -373,8 +615,7 @@ int path_to_string(bgp_path_t * path, int reverse,
 	dst_size-= iWritten;
       }
       // Write AS-Path segment
-      iWritten= path_segment_to_string(_path_segment_at(path, index),
-				       reverse, dst, dst_size);
+      iWritten= path_segment_to_string(seg, reverse, dst, dst_size);
       if (iWritten >= dst_size)
 	return -1;
       dst+= iWritten;
@@ -429,7 +670,7 @@ bgp_path_t * path_from_string(const char * path_str)
 	path_destroy(&path);
 	break;
       }
-      path_add_segment(path, seg);
+      path_add_segment(&path, seg);
     }
   }
 
@@ -438,7 +679,8 @@ bgp_path_t * path_from_string(const char * path_str)
 
 // ----- path_match --------------------------------------------------------
 /**
- *
+ * The regular expressions keep the state of the last search, so the
+ * matching is serialized in parallel mode.
  */
 int path_match(bgp_path_t * path, SRegEx * pRegEx)
 {
@@ -450,9 +692,11 @@ int path_match(bgp_path_t * path, SRegEx * pRegEx)
 
   if (pRegEx != NULL) {
     if (strcmp(acBuffer, "null") != 0) {
+      thread_mutex_lock(&_path_match_lock);
       if (regex_search(pRegEx, acBuffer) > 0)
         iRet = 1;
       regex_reinit(pRegEx);
+      thread_mutex_unlock(&_path_match_lock);
     }
   }
 
@@ -466,6 +710,9 @@ int path_match(bgp_path_t * path, SRegEx * pRegEx)
 void path_dump(gds_stream_t * stream, const bgp_path_t * path,
 	       int reverse)
 {
+  bgp_path_seg_t * stack_segs[_PATH_SEGS_STACK];
+  bgp_path_seg_t ** segs;
+  bgp_path_seg_t * seg;
   int index;
 
   if ((path == NULL) || (_path_num_segments(path) == 0)) {
@@ -474,16 +721,20 @@ void path_dump(gds_stream_t * stream, const bgp_path_t * path,
   }
 
   if (reverse) {
+    segs= _path_segments(path, stack_segs);
     for (index= _path_num_segments(path); index > 0; index--) {
-      path_segment_dump(stream, _path_segment_at(path, index-1), reverse);
+      path_segment_dump(stream, segs[index-1], reverse);
       if (index > 1)
 	stream_printf(stream, " ");
     }
+    if (segs != stack_segs)
+      FREE(segs);
   } else {
-    for (index= 0; index < _path_num_segments(path); index++) {
+    seg= NULL;
+    for (index= 0; (seg= path_segment_next(path, seg)) != NULL; index++) {
       if (index > 0)
 	stream_printf(stream, " ");
-      path_segment_dump(stream, _path_segment_at(path, index), reverse);
+      path_segment_dump(stream, seg, reverse);
     }
   }
 }
@@ -503,12 +754,13 @@ uint32_t path_hash(const bgp_path_t * path)
     return 0;
 
   hash= 0;
+  seg= _path_first_seg(path);
   for (i= 0; i < _path_num_segments(path); i++) {
-    seg= _path_segment_at(path, i);
     for (seg_index= 0; seg_index < seg->length; seg_index++) {
       hash= (a * hash+seg->asns[seg_index]) % M;
       a= a * b % (M-1);
     }
+    seg= _path_next_seg(seg);
   }
   return hash;
 }
@@ -517,26 +769,16 @@ uint32_t path_hash(const bgp_path_t * path)
 /**
  * This is a helper function that computes the hash key of an
  * AS-Path. The function is based on Zebra's AS-Path hashing
- * function.
+ * function. The hash key is maintained in the AS-Path header each
+ * time the AS-Path is modified (see _path_cache_update).
  */
 uint32_t path_hash_zebra(const void * item, unsigned int hash_size)
 {
-  bgp_path_t * path= (bgp_path_t *) item;
-  unsigned int hash= 0;
-  uint32_t i, index2;
-  bgp_path_seg_t * seg;
+  const bgp_path_t * path= (const bgp_path_t *) item;
 
-  for (i= 0; i < _path_num_segments(path); i++) {
-    seg= _path_segment_at(path, i);
-    // Note: segment type IDs are equal to those of Zebra
-    //(1 AS_SET, 2 AS_SEQUENCE)
-    hash+= seg->type;
-    for (index2= 0; index2 < seg->length; index2++) {
-      hash+= seg->asns[index2] & 255;
-      hash+= seg->asns[index2] >> 8;
-    }
-  }
-  return hash;
+  if (path == NULL)
+    return 0;
+  return path->hash;
 }
 
 // -----[ path_hash_OAT ]--------------------------------------------
@@ -550,8 +792,11 @@ uint32_t path_hash_OAT(const void * item, unsigned int hash_size)
   uint32_t i, index2;
   bgp_path_seg_t * seg;
 
+  if (path == NULL)
+    return 0;
+
+  seg= _path_first_seg(path);
   for (i= 0; i < _path_num_segments(path); i++) {
-    seg= _path_segment_at(path, i);
     // Note: segment type IDs are equal to those of Zebra
     //(1 AS_SET, 2 AS_SEQUENCE)
 
@@ -567,6 +812,7 @@ uint32_t path_hash_OAT(const void * item, unsigned int hash_size)
       hash+= (hash << 10);
       hash^= (hash >> 6);
     }
+    seg= _path_next_seg(seg);
   }
   hash+= (hash << 3);
   hash^= (hash >> 11);
@@ -618,17 +864,27 @@ int path_comparison(bgp_path_t * path1, bgp_path_t * path2)
 int path_equals(const bgp_path_t * path1, const bgp_path_t * path2)
 {
   unsigned int i;
+  bgp_path_seg_t * seg1, * seg2;
 
   if (path1 == path2)
     return 1;
 
   if (_path_num_segments(path1) != _path_num_segments(path2))
     return 0;
+  if (_path_num_segments(path1) == 0)
+    return 1;
+
+  // Quick check based on cached information
+  if ((path1->length != path2->length) || (path1->size != path2->size))
+    return 0;
 
+  seg1= _path_first_seg(path1);
+  seg2= _path_first_seg(path2);
   for (i= 0; i < _path_num_segments(path1); i++) {
-    if (!path_segment_equals(_path_segment_at(path1, i),
-			     _path_segment_at(path2, i)))
+    if (!path_segment_equals(seg1, seg2))
       return 0;
+    seg1= _path_next_seg(seg1);
+    seg2= _path_next_seg(seg2);
   }
   return 1;
 }
@@ -647,6 +903,7 @@ int path_cmp(const bgp_path_t * path1, const bgp_path_t * path2)
 {
   unsigned int i;
   int cmp;
+  bgp_path_seg_t * seg1, * seg2;
 
   // Null paths are equal
   if (path1 == path2)
@@ -669,11 +926,14 @@ int path_cmp(const bgp_path_t * path1, const bgp_path_t * path2)
     return 1;
 
   // Equal size paths, inspect individual segments
+  seg1= _path_first_seg(path1);
+  seg2= _path_first_seg(path2);
   for (i= 0; i < _path_num_segments(path1); i++) {
-    cmp= path_segment_cmp(_path_segment_at(path1, i),
-			   _path_segment_at(path2, i));
+    cmp= path_segment_cmp(seg1, seg2);
     if (cmp != 0)
       return cmp;
+    seg1= _path_next_seg(seg1);
+    seg2= _path_next_seg(seg2);
   }
 
   return 0;
@@ -697,26 +957,55 @@ int path_str_cmp(bgp_path_t * path1, bgp_path_t * path2)
 }
 
 // -----[ path_remove_private ]--------------------------------------
+/**
+ * Remove private ASNs from the AS-Path (see
+ * path_segment_remove_private). Since the AS-Path can only shrink,
+ * the segments are compacted in place.
+ */
 void path_remove_private(bgp_path_t * path)
 {
-  unsigned int i;
-  bgp_path_seg_t * seg;
-  bgp_path_seg_t * new_seg;
+  unsigned int index, seg_index;
+  bgp_path_seg_t * seg, * next_seg, * new_seg;
+  uint8_t * dst;
+  unsigned int num_segs;
+  uint8_t length;
+  asn_t asn;
 
-  i= 0;
-  while (i < _path_num_segments(path)) {
-    seg= _path_segment_at(path, i);
-    new_seg= path_segment_remove_private(seg);
-    if (seg != new_seg) {
-      if (new_seg == NULL) {
-	ptr_array_remove_at(path, i);
+  if (path == NULL)
+    return;
+
+  dst= path->segs;
+  num_segs= 0;
+  next_seg= _path_first_seg(path);
+  for (index= 0; index < path->num_segs; index++) {
+    // The destination can overlap the current segment
+    seg= next_seg;
+    next_seg= _path_next_seg(seg);
+    length= seg->length;
+    new_seg= (bgp_path_seg_t *) dst;
+    new_seg->type= seg->type;
+    new_seg->length= 0;
+    for (seg_index= 0; seg_index < length; seg_index++) {
+      asn= seg->asns[seg_index];
+#ifndef ASN_SIZE_32
+      if (asn >= 64512)
+#else
+      if ((asn >= 64512) && (asn <= 65535))
+#endif /* ASN_SIZE_32 */
 	continue;
-      } else {
-	_path_segment_set(path, i, new_seg);
-      }
+      new_seg->asns[new_seg->length++]= asn;
+    }
+    if (new_seg->length > 0) {
+      dst+= _path_seg_size(new_seg->length);
+      num_segs++;
     }
-    i++;
   }
+  path->num_segs= num_segs;
+  // The unused tail is not given back to the allocator, only to
+  // the accounting
+  mem_acct_release(MEM_ACCT_BGP_PATHS, path->size-(dst-path->segs));
+  path->size= dst-path->segs;
+  _path_cache_update(path);
 }
 
 // -----[ _path_destroy ]--------------------------------------------
@@ -36,11 +36,21 @@ extern "C" {
   // ----- path_num_segments ----------------------------------------
   int path_num_segments(const bgp_path_t * path);
   // ----- path_add_segment -----------------------------------------
-  int path_add_segment(bgp_path_t * path, bgp_path_seg_t * segment);
+  int path_add_segment(bgp_path_t ** path_ref, bgp_path_seg_t * segment);
   // ----- path_segment_at ------------------------------------------
   bgp_path_seg_t * path_segment_at(bgp_path_t * path, int index);
+  // -----[ path_segment_next ]--------------------------------------
+  bgp_path_seg_t * path_segment_next(const bgp_path_t * path,
+				     const bgp_path_seg_t * seg);
   // ----- path_append ----------------------------------------------
   int path_append(bgp_path_t ** path, asn_t asn);
+  // -----[ path_prepend ]-------------------------------------------
+  bgp_path_t * path_prepend(const bgp_path_t * path, asn_t asn,
+			    uint8_t amount);
+  // -----[ path_size ]----------------------------------------------
+  size_t path_size(const bgp_path_t * path);
+  // -----[ path_segmented_size ]------------------------------------
+  size_t path_segmented_size(const bgp_path_t * path);
   // ----- path_length ----------------------------------------------
   int path_length(bgp_path_t * path);
   // ----- path_contains --------------------------------------------
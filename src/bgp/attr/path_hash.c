@@ -23,11 +23,15 @@
 
 #include <bgp/attr/path.h>
 #include <bgp/attr/path_hash.h>
+#include <util/thread.h>
 
 // ---| Function prototypes |---
 static uint32_t _path_hash_item_compute(const void * item,
 					unsigned int hash_size);
 
+// ---| Lock on the repository (parallel mode) |---
+static thread_mutex_t _path_hash_lock= THREAD_MUTEX_INITIALIZER;
+
 // ---| Private parameters |---
 static struct {
   gds_hash_set_t     * hash;
@@ -77,8 +81,12 @@ static void _path_hash_item_destroy(void * item)
  */
 void * path_hash_add(bgp_path_t * path)
 {
+  void * result;
+  thread_mutex_lock(&_path_hash_lock);
   _path_hash_init();
-  return hash_set_add(_global_ref.hash, path);
+  result= hash_set_add(_global_ref.hash, path);
+  thread_mutex_unlock(&_path_hash_lock);
+  return result;
 }
 
 // -----[ path_hash_get ]--------------------------------------------
@@ -87,8 +95,12 @@ void * path_hash_add(bgp_path_t * path)
  */
 bgp_path_t * path_hash_get(bgp_path_t * path)
 {
+  bgp_path_t * result;
+  thread_mutex_lock(&_path_hash_lock);
   _path_hash_init();
-  return (bgp_path_t *) hash_set_search(_global_ref.hash, path);
+  result= (bgp_path_t *) hash_set_search(_global_ref.hash, path);
+  thread_mutex_unlock(&_path_hash_lock);
+  return result;
 }
 
 // -----[ path_hash_remove ]-----------------------------------------
@@ -98,9 +110,11 @@ bgp_path_t * path_hash_get(bgp_path_t * path)
 int path_hash_remove(bgp_path_t * path)
 {
   int result;
+  thread_mutex_lock(&_path_hash_lock);
   _path_hash_init();
-  assert((result= hash_set_remove(_global_ref.hash, path))
-	 != HASH_ERROR_NO_MATCH);
+  result= hash_set_remove(_global_ref.hash, path);
+  thread_mutex_unlock(&_path_hash_lock);
+  assert(result != HASH_ERROR_NO_MATCH);
   return result;
 }
 
@@ -209,18 +223,59 @@ int _path_hash_statistics_for_each(void * item, void * ctx)
   return 0;
 }
 
+// -----[ _path_hash_mem_ctx_t ]-------------------------------------
+typedef struct {
+  unsigned int num_paths;
+  unsigned int num_segs;
+  size_t       flat_size;
+  size_t       segmented_size;
+} _path_hash_mem_ctx_t;
+
+// -----[ _path_hash_mem_for_each ]----------------------------------
+static int _path_hash_mem_for_each(void * item, void * ctx)
+{
+  _path_hash_mem_ctx_t * mem_ctx= (_path_hash_mem_ctx_t *) ctx;
+  bgp_path_t * path= (bgp_path_t *) item;
+
+  mem_ctx->num_paths++;
+  mem_ctx->num_segs+= path_num_segments(path);
+  mem_ctx->flat_size+= path_size(path);
+  mem_ctx->segmented_size+= path_segmented_size(path);
+  return 0;
+}
+
 // -----[ path_hash_statistics ]-------------------------------------
 /**
- *
+ * Dump the AS-Path repository statistics. The memory used by the
+ * interned AS-Paths is compared to the memory that the same AS-Paths
+ * would require if their segments were separately allocated. The
+ * number of allocations saved is also reported (the segmented
+ * representation requires an array descriptor, an array of pointers
+ * and one block per segment, i.e. 2+#segments allocations per path,
+ * while the flat representation requires a single allocation).
  */
 void path_hash_statistics(gds_stream_t * stream)
 {
   time_t now= time(NULL);
+  _path_hash_mem_ctx_t mem_ctx= { .num_paths= 0, .num_segs= 0,
+				  .flat_size= 0, .segmented_size= 0 };
 
   _path_hash_init();
+  assert(!hash_set_for_each(_global_ref.hash,
+			    _path_hash_mem_for_each,
+			    &mem_ctx));
   stream_printf(stream, "# C-BGP Global AS-Path repository statistics\n");
   stream_printf(stream, "# generated on %s", ctime(&now));
   stream_printf(stream, "# hash-size is %u\n", _global_ref.size);
+  stream_printf(stream, "# paths: %u (segments: %u)\n",
+		mem_ctx.num_paths, mem_ctx.num_segs);
+  stream_printf(stream, "# memory (flat): %lu bytes\n",
+		(unsigned long) mem_ctx.flat_size);
+  stream_printf(stream, "# memory (segmented): %lu bytes\n",
+		(unsigned long) mem_ctx.segmented_size);
+  stream_printf(stream, "# memory saved: %ld bytes, %u allocations\n",
+		(long) mem_ctx.segmented_size - (long) mem_ctx.flat_size,
+		mem_ctx.num_paths + mem_ctx.num_segs);
   assert(!hash_set_for_each_key(_global_ref.hash,
 				_path_hash_statistics_for_each,
 				stream));
@@ -72,16 +72,36 @@ typedef struct {
 /** 
  * Definition of an AS-Path.
  *
- * There are two types of AS-Paths supported so far. The first one is
- * the simplest and contains the list of segments composing the
- * path. The second type can be used to reduce the memory consumption
- * and is composed of a segment and a previous AS-Path (called the
- * "tail") of the path.
+ * An AS-Path is stored in a single memory block. A header caching
+ * frequently used information (length, hash, first/last ASNs) is
+ * followed by the packed segments. Each segment is stored as a
+ * bgp_path_seg_t immediately followed by its ASNs.
  */
-typedef ptr_array_t bgp_path_t;
-/*typedef struct {
-  ptr_array_t * segments;
-  } bgp_path_t;*/
+typedef struct {
+  /** Number of segments. */
+  uint16_t num_segs;
+  /** Number of AS hops (an AS-SET counts as a single hop). */
+  uint16_t length;
+  /** Size of the packed segments (in bytes). */
+  uint16_t size;
+  /** Offset of the last segment (in bytes). */
+  uint16_t last_offset;
+  /** Zebra-like hash of the AS-Path (see path_hash_zebra). */
+  uint32_t hash;
+  /** Bitmask of (ASN mod 32) used to speed-up path_contains. */
+  uint32_t asn_mask;
+#ifndef ASN_SIZE_32
+  /** First ASN of the first segment (origin AS). */
+  uint16_t first_asn;
+  /** Last ASN of the last segment (neighbor AS). */
+  uint16_t last_asn;
+#else
+  uint32_t first_asn;
+  uint32_t last_asn;
+#endif
+  /** Packed segments. */
+  uint8_t  segs[0];
+} bgp_path_t;
 
 
 /////////////////////////////////////////////////////////////////////
@@ -21,7 +21,7 @@
 #include <bgp/bgp_assert.h>
 #include <bgp/attr/path.h>
 #include <bgp/peer.h>
-#include <bgp/record-route.h>
+#include <bgp/reachability.h>
 #include <bgp/rib.h>
 #include <bgp/route.h>
 #include <bgp/routes_list.h>
@@ -54,55 +54,14 @@ static ptr_array_t * build_router_list()
 // ----- bgp_assert_reachability ------------------------------------
 /**
  * This function checks that all the advertised networks are reachable
- * from all the BGP routers.
+ * from all the BGP routers. The paths are resolved for all the
+ * routers at once, for each network (see bgp/reachability.h).
  */
-int bgp_assert_reachability()
+int bgp_assert_reachability(unsigned int num_threads)
 {
-  ptr_array_t * rl;
-  int iIndexSrc, iIndexDst, iIndexNet;
-  bgp_router_t * routerSrc, * routerDst;
-  bgp_path_t * path;
-  bgp_route_t * route;
-  int result= 0;
-
-  rl= build_router_list();
-
-  // All routers as source...
-  for (iIndexSrc= 0; iIndexSrc < ptr_array_length(rl); iIndexSrc++) {
-    routerSrc= (bgp_router_t *) rl->data[iIndexSrc];
-
-    // All routers as destination...
-    for (iIndexDst= 0; iIndexDst < ptr_array_length(rl); iIndexDst++) {
-      routerDst= (bgp_router_t *) rl->data[iIndexDst];
-      
-      if (routerSrc != routerDst) {
-
-	// For all advertised networks in the destination router
-	for (iIndexNet= 0;
-	     iIndexNet < ptr_array_length(routerDst->local_nets);
-	     iIndexNet++) {
-	  route= (bgp_route_t *) routerDst->local_nets->data[iIndexNet];
-
-	  // Check BGP reachability
-	  if (bgp_record_route(routerSrc, route->prefix, &path, 0)) {
-	    stream_printf(gdsout, "Assert: ");
-	    bgp_router_dump_id(gdsout, routerSrc);
-	    stream_printf(gdsout, " can not reach ");
-	    ip_prefix_dump(gdsout, route->prefix);
-	    stream_printf(gdsout, "\n");
-	    result= -1;
-	  }
-	  path_destroy(&path);
-
-	}
-	
-      }
-    }
-  }
-
-  ptr_array_destroy(&rl);
-
-  return result;
+  if (bgp_reach_check(gdsout, network_get_default(), num_threads) > 0)
+    return -1;
+  return 0;
 }
 
 // ----- bgp_assert_peerings ----------------------------------------
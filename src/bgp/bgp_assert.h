@@ -17,7 +17,7 @@ extern "C" {
 #endif
 
   // -----[ bgp_assert_reachability ]--------------------------------
-  int bgp_assert_reachability();
+  int bgp_assert_reachability(unsigned int num_threads);
   // -----[ bgp_assert_peerings ]------------------------------------
   int bgp_assert_peerings();
   // -----[ bgp_router_assert_best ]---------------------------------
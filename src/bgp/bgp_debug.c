@@ -85,7 +85,7 @@ void bgp_debug_dp(gds_stream_t * stream, bgp_router_t * router,
       for (uIndex = 0; uIndex < routes_list_get_num(routesRIBIn); uIndex++) {
 	route = routes_list_get_at(routesRIBIn, uIndex);
 #else
-    route= rib_find_exact(peer->adj_rib[RIB_IN], prefix);
+    route= bgp_peer_rib_find_exact(peer, RIB_IN, prefix);
 #endif
     if ((route != NULL) &&
 	(route_flag_get(route, ROUTE_FLAG_FEASIBLE)))
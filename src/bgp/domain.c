@@ -11,6 +11,8 @@
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
+
 #include <libgds/array.h>
 #include <libgds/memory.h>
 #include <libgds/radix-tree.h>
@@ -18,8 +20,11 @@
 #include <bgp/as.h>
 #include <bgp/domain.h>
 #include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <bgp/rib.h>
 #include <net/icmp.h>
 #include <net/network.h>
+#include <net/node.h>
 
 #define BGP_DOMAINS_MAX 65536
 #ifndef ASN_SIZE_32
@@ -258,6 +263,20 @@ int bgp_domain_record_route(gds_stream_t * stream,
 				     &ctx);
 }
 
+// -----[ _bgp_domain_routers_compare ]------------------------------
+static int _bgp_domain_routers_compare(const void * item1,
+				       const void * item2)
+{
+  bgp_router_t * router1= *((bgp_router_t **) item1);
+  bgp_router_t * router2= *((bgp_router_t **) item2);
+
+  if (router1->node->rid < router2->node->rid)
+    return -1;
+  else if (router1->node->rid > router2->node->rid)
+    return 1;
+  return 0;
+}
+
 // -----[ _build_router_list ]---------------------------------------
 static int _build_router_list(uint32_t key, uint8_t key_len,
 			      void * item, void * ctx)
@@ -275,27 +294,27 @@ static inline ptr_array_t * _bgp_domain_routers_list(bgp_domain_t * domain)
 {
   ptr_array_t * list= ptr_array_create_ref(0);
 
-  // Build list of BGP routers
+  // Build list of BGP routers, sorted by router-ID
   radix_tree_for_each(domain->routers, _build_router_list, list);
+  qsort(list->data, ptr_array_length(list), sizeof(bgp_router_t *),
+	_bgp_domain_routers_compare);
 
   return list;
 }
 
-// ----- bgp_domain_full_mesh ---------------------------------------
+// -----[ _bgp_domain_full_mesh_accurate ]---------------------------
 /**
- * Generate a full-mesh of iBGP sessions in the domain.
+ * Build the full-mesh one session at a time and start the routers.
+ * Each session is opened with an OPEN message exchange.
  */
-int bgp_domain_full_mesh(bgp_domain_t * domain)
+static int _bgp_domain_full_mesh_accurate(bgp_domain_t * domain,
+					  ptr_array_t * routers)
 {
   unsigned int index1, index2;
-  ptr_array_t * routers;
   bgp_router_t * router1, * router2;
   bgp_peer_t * peer;
   int result;
 
-  /* Get the list of routers */
-  routers= _bgp_domain_routers_list(domain);
-
   // Build the full-mesh of sessions
   for (index1= 0; index1 < ptr_array_length(routers); index1++) {
     router1= routers->data[index1];
@@ -325,10 +344,274 @@ int bgp_domain_full_mesh(bgp_domain_t * domain)
       return result;
 
   }
-  ptr_array_destroy(&routers);
+  return ESUCCESS;
+}
+
+// -----[ _bgp_domain_mesh_ctx_t ]-----------------------------------
+typedef struct {
+  bgp_router_t * router;
+  ptr_array_t  * peers;
+} _bgp_domain_mesh_ctx_t;
+
+// -----[ _bgp_domain_mesh_disseminate ]-----------------------------
+static int _bgp_domain_mesh_disseminate(uint32_t key, uint8_t key_len,
+					void * item, void * ctx)
+{
+  _bgp_domain_mesh_ctx_t * mesh_ctx= (_bgp_domain_mesh_ctx_t *) ctx;
+  bgp_route_t * route= (bgp_route_t *) item;
+  bgp_peer_t * peer;
+  unsigned int index;
+
+  for (index= 0; index < ptr_array_length(mesh_ctx->peers); index++) {
+    peer= (bgp_peer_t *) mesh_ctx->peers->data[index];
+    if (bgp_peer_send_enabled(peer))
+      bgp_router_decision_process_disseminate_to_peer(mesh_ctx->router,
+						      route->prefix,
+						      route, peer);
+  }
   return 0;
 }
 
+// -----[ _bgp_domain_start_bulk ]-----------------------------------
+/**
+ * Start the sessions of the routers in bulk. The sessions between
+ * routers of the domain that are mutually reachable are directly
+ * ESTABLISHED, without OPEN message exchange. The Loc-RIB of each
+ * router is then disseminated to its new sessions in a single pass.
+ *
+ * The other sessions of the routers (including the sessions whose
+ * ends are not reachable) are opened as with bgp_router_start.
+ */
+static int _bgp_domain_start_bulk(bgp_domain_t * domain,
+				  ptr_array_t * routers)
+{
+  unsigned int index1, index2;
+  bgp_router_t * router1, * router2;
+  bgp_peer_t * peer, * peer2;
+  _bgp_domain_mesh_ctx_t ctx;
+  int result= ESUCCESS;
+
+  ctx.peers= ptr_array_create_ref(0);
+  for (index1= 0; index1 < ptr_array_length(routers); index1++) {
+    router1= routers->data[index1];
+    ctx.router= router1;
+
+    // Establish the sessions with the other routers of the domain
+    for (index2= 0; index2 < bgp_peers_size(router1->peers); index2++) {
+      peer= bgp_peers_at(router1->peers, index2);
+      if ((peer->asn != domain->asn) ||
+	  ((peer->session_state != SESSION_STATE_IDLE) &&
+	   (peer->session_state != SESSION_STATE_ACTIVE)))
+	continue;
+      router2= (bgp_router_t *)
+	radix_tree_get_exact(domain->routers, peer->addr, 32);
+      if (router2 == NULL)
+	continue;
+      peer2= bgp_peers_find(router2->peers, router1->node->rid);
+      if ((peer2 != NULL) &&
+	  bgp_peer_session_ok(peer) && bgp_peer_session_ok(peer2) &&
+	  (bgp_peer_establish_session(peer, router2->rid) == ESUCCESS))
+	ptr_array_append(ctx.peers, peer);
+    }
+
+    // Open the other sessions
+    for (index2= 0; index2 < bgp_peers_size(router1->peers); index2++) {
+      peer= bgp_peers_at(router1->peers, index2);
+      if ((peer->session_state == SESSION_STATE_IDLE) ||
+	  (peer->session_state == SESSION_STATE_ACTIVE)) {
+	result= bgp_peer_open_session(peer);
+	if (result != ESUCCESS)
+	  break;
+      }
+    }
+    if (result != ESUCCESS)
+      break;
+
+    rib_for_each(router1->loc_rib, _bgp_domain_mesh_disseminate, &ctx);
+    ptr_array_set_length(ctx.peers, 0);
+  }
+  ptr_array_destroy(&ctx.peers);
+  return result;
+}
+
+// -----[ _bgp_domain_full_mesh_bulk ]-------------------------------
+/**
+ * Build the full-mesh in bulk. The peers of each router are created
+ * in address order and added at once. The sessions are then started
+ * with _bgp_domain_start_bulk.
+ */
+static int _bgp_domain_full_mesh_bulk(bgp_domain_t * domain,
+				      ptr_array_t * routers)
+{
+  unsigned int num_routers= ptr_array_length(routers);
+  unsigned int index1, index2, num_peers;
+  bgp_router_t * router1, * router2;
+  bgp_peer_t ** new_peers, * peer;
+  int result= ESUCCESS;
+
+  // Create the peers of each router, in address order
+  new_peers= (bgp_peer_t **) MALLOC(num_routers * sizeof(bgp_peer_t *));
+  for (index1= 0; index1 < num_routers; index1++) {
+    router1= routers->data[index1];
+    num_peers= 0;
+    for (index2= 0; index2 < num_routers; index2++) {
+      if (index1 == index2)
+	continue;
+      router2= routers->data[index2];
+      if (node_has_address(router1->node, router2->node->rid)) {
+	result= EBGP_PEER_INVALID_ADDR;
+	break;
+      }
+      peer= bgp_peer_create(domain->asn, router2->node->rid, router1);
+      bgp_peer_set_source(peer, router1->node->rid);
+      new_peers[num_peers++]= peer;
+    }
+    if (result != ESUCCESS) {
+      for (index2= 0; index2 < num_peers; index2++)
+	bgp_peer_destroy(&new_peers[index2]);
+      break;
+    }
+    result= bgp_peers_add_bulk(router1->peers, new_peers, num_peers);
+    if (result != ESUCCESS)
+      break;
+  }
+  FREE(new_peers);
+  if (result != ESUCCESS)
+    return result;
+
+  return _bgp_domain_start_bulk(domain, routers);
+}
+
+// ----- bgp_domain_full_mesh ---------------------------------------
+/**
+ * Generate a full-mesh of iBGP sessions in the domain.
+ *
+ * By default, the mesh is built in bulk (see
+ * _bgp_domain_full_mesh_bulk). With the BGP_DOMAIN_MESH_ACCURATE
+ * option, each session is opened with an OPEN message exchange.
+ */
+int bgp_domain_full_mesh(bgp_domain_t * domain, uint8_t options)
+{
+  ptr_array_t * routers;
+  int result;
+
+  /* Get the list of routers */
+  routers= _bgp_domain_routers_list(domain);
+
+  if (options & BGP_DOMAIN_MESH_ACCURATE)
+    result= _bgp_domain_full_mesh_accurate(domain, routers);
+  else
+    result= _bgp_domain_full_mesh_bulk(domain, routers);
+
+  ptr_array_destroy(&routers);
+  return result;
+}
+
+// -----[ _bgp_domain_add_rr_peer ]----------------------------------
+static inline int _bgp_domain_add_rr_peer(bgp_domain_t * domain,
+					  bgp_router_t * router1,
+					  bgp_router_t * router2,
+					  int rr_client)
+{
+  bgp_peer_t * peer;
+  int result;
+
+  result= bgp_router_add_peer(router1, domain->asn, router2->node->rid,
+			      &peer);
+  if (result != ESUCCESS)
+    return result;
+  bgp_peer_set_source(peer, router1->node->rid);
+  if (rr_client) {
+    router1->reflector= 1;
+    bgp_peer_flag_set(peer, PEER_FLAG_RR_CLIENT, 1);
+  }
+  return ESUCCESS;
+}
+
+// -----[ bgp_domain_build_rr_hierarchy ]----------------------------
+/**
+ * Generate a hierarchy of route-reflectors in the domain. The routers
+ * are split in clusters of num_rrs route-reflectors and num_clients
+ * clients. The route-reflectors are the routers with the lowest
+ * router-IDs. The route-reflectors of a cluster are redundant: they
+ * share the same cluster-id (the router-ID of the first one) and
+ * all serve the clients of the cluster.
+ *
+ * The route-reflectors form a full-mesh of (non-client)
+ * sessions. Each client has a session with each route-reflector of
+ * its cluster.
+ *
+ * The routers are started in bulk (see _bgp_domain_start_bulk),
+ * unless the BGP_DOMAIN_MESH_ACCURATE option is set.
+ */
+int bgp_domain_build_rr_hierarchy(bgp_domain_t * domain,
+				  unsigned int num_clients,
+				  unsigned int num_rrs,
+				  uint8_t options)
+{
+  ptr_array_t * routers;
+  unsigned int num_routers, num_clusters, num_reflectors;
+  unsigned int index1, index2, cluster;
+  bgp_router_t * router1, * router2;
+  int result= ESUCCESS;
+
+  if ((num_clients < 1) || (num_rrs < 1))
+    return EUNEXPECTED;
+
+  routers= _bgp_domain_routers_list(domain);
+  num_routers= ptr_array_length(routers);
+  num_clusters= (num_routers + num_rrs + num_clients - 1) /
+    (num_rrs + num_clients);
+  num_reflectors= num_clusters * num_rrs;
+  if (num_reflectors > num_routers)
+    num_reflectors= num_routers;
+
+  // Set the cluster-ids and build the full-mesh of route-reflectors
+  for (index1= 0; index1 < num_reflectors; index1++) {
+    router1= routers->data[index1];
+    router1->cluster_id=
+      ((bgp_router_t *) routers->data[index1 - (index1 % num_rrs)])->rid;
+    router1->reflector= 1;
+    for (index2= 0; index2 < num_reflectors; index2++) {
+      if (index1 == index2)
+	continue;
+      result= _bgp_domain_add_rr_peer(domain, router1,
+				      routers->data[index2], 0);
+      if (result != ESUCCESS)
+	goto exit;
+    }
+  }
+
+  // Attach each client to the route-reflectors of its cluster
+  for (index1= num_reflectors; index1 < num_routers; index1++) {
+    router1= routers->data[index1];
+    cluster= (index1 - num_reflectors) / num_clients;
+    for (index2= cluster * num_rrs; index2 < (cluster+1) * num_rrs;
+	 index2++) {
+      router2= routers->data[index2];
+      result= _bgp_domain_add_rr_peer(domain, router2, router1, 1);
+      if (result == ESUCCESS)
+	result= _bgp_domain_add_rr_peer(domain, router1, router2, 0);
+      if (result != ESUCCESS)
+	goto exit;
+    }
+  }
+
+  // Start the routers
+  if (options & BGP_DOMAIN_MESH_ACCURATE) {
+    for (index1= 0; index1 < num_routers; index1++) {
+      result= bgp_router_start(routers->data[index1]);
+      if (result != ESUCCESS)
+	break;
+    }
+  } else
+    result= _bgp_domain_start_bulk(domain, routers);
+
+ exit:
+  ptr_array_destroy(&routers);
+  return result;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // INITIALIZATION AND FINALIZATION SECTION
@@ -15,6 +15,9 @@
 #include <bgp/types.h>
 #include <net/icmp.h>
 
+/** Open the generated sessions with OPEN message exchanges. */
+#define BGP_DOMAIN_MESH_ACCURATE 0x01
+
 // -----[ FBGPDomainsForEach ]---------------------------------------
 typedef int (*FBGPDomainsForEach)(bgp_domain_t * domain, void * ctx);
 
@@ -46,7 +49,12 @@ extern "C" {
   int bgp_domain_record_route(gds_stream_t * stream, bgp_domain_t * domain, 
 			      ip_dest_t dest, ip_opt_t * opts);
   // ----- bgp_domain_full_mesh -------------------------------------
-  int bgp_domain_full_mesh(bgp_domain_t * domain);
+  int bgp_domain_full_mesh(bgp_domain_t * domain, uint8_t options);
+  // -----[ bgp_domain_build_rr_hierarchy ]--------------------------
+  int bgp_domain_build_rr_hierarchy(bgp_domain_t * domain,
+				    unsigned int num_clients,
+				    unsigned int num_rrs,
+				    uint8_t options);
   
 
   ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,319 @@
+// ==================================================================
+// @(#)generator.c
+//
+// Synthetic BGP configuration and RIB generator (see
+// bgp/generator.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <bgp/as.h>
+#include <bgp/attr/path.h>
+#include <bgp/domain.h>
+#include <bgp/generator.h>
+#include <bgp/message.h>
+#include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <bgp/route.h>
+#include <net/error.h>
+#include <net/link.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <util/rng.h>
+
+/** Metric of the static routes towards the eBGP neighbors. */
+#define BGP_GEN_STATIC_METRIC 5
+/** Largest transit or origin ASN (the private ASNs are not used). */
+#define BGP_GEN_MAX_ASN 64511
+
+static char * IBGP_NAMES[BGP_GEN_IBGP_MAX]= {
+  "none",
+  "full-mesh",
+  "rr",
+};
+
+// -----[ Prefix length distribution ]-------------------------------
+// Share (per thousand) of the prefixes of length 8 to 24 in an
+// Internet routing table. Most prefixes are /24, then /22 and /23.
+static unsigned int PFX_LENGTHS[]= {
+  /*  8 */   1,   1,   1,   2,   4,   6,  10,  15,
+  /* 16 */  35,  20,  35,  55,  70,  70, 110,  90,
+  /* 24 */ 475,
+};
+#define PFX_LENGTH_MIN 8
+#define PFX_LENGTHS_NUM sizeof(PFX_LENGTHS)/sizeof(PFX_LENGTHS[0])
+
+// -----[ AS-Path length distribution ]------------------------------
+// Share (per thousand) of the AS-Paths of length 1 to 9. The mean
+// length is close to 4 AS hops.
+static unsigned int PATH_LENGTHS[]= {
+  20, 150, 320, 270, 140, 60, 25, 10, 5,
+};
+#define PATH_LENGTHS_NUM sizeof(PATH_LENGTHS)/sizeof(PATH_LENGTHS[0])
+
+// -----[ Number of announcing neighbors ]---------------------------
+// Share (per thousand) of the prefixes announced by 1, 2 or 3 of
+// the eBGP neighbors (multi-homing).
+static unsigned int ANNOUNCERS[]= {
+  600, 250, 150,
+};
+#define ANNOUNCERS_NUM sizeof(ANNOUNCERS)/sizeof(ANNOUNCERS[0])
+
+// -----[ _ebgp_neighbor_t ]-----------------------------------------
+typedef struct {
+  bgp_peer_t * peer;
+  asn_t        asn;
+} _ebgp_neighbor_t;
+
+// -----[ bgp_gen_params_init ]--------------------------------------
+void bgp_gen_params_init(bgp_gen_params_t * params)
+{
+  memset(params, 0, sizeof(bgp_gen_params_t));
+  params->asn= 1;
+  params->ibgp= BGP_GEN_IBGP_FULL_MESH;
+  params->num_rrs= 2;
+  params->num_clients= 20;
+  params->ebgp_base= IPV4(100,64,0,0);
+  params->seed= 1;
+}
+
+// -----[ bgp_gen_str2ibgp ]-----------------------------------------
+int bgp_gen_str2ibgp(const char * str, bgp_gen_ibgp_t * ibgp)
+{
+  bgp_gen_ibgp_t index;
+  for (index= 0; index < BGP_GEN_IBGP_MAX; index++)
+    if (!strcmp(str, IBGP_NAMES[index])) {
+      *ibgp= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ _gen_pick ]------------------------------------------------
+/** Pick an index according to a distribution (per thousand). */
+static inline unsigned int _gen_pick(rng_t * rng, unsigned int * dist,
+				     unsigned int num)
+{
+  unsigned int value= rng_range(rng, 1000);
+  unsigned int index;
+  for (index= 0; index < num-1; index++) {
+    if (value < dist[index])
+      break;
+    value-= dist[index];
+  }
+  return index;
+}
+
+// -----[ _gen_random_asn ]------------------------------------------
+/**
+ * Pick an ASN in 1..BGP_GEN_MAX_ASN, out of the block of num_used
+ * ASNs that starts at used (the domain and its neighbors).
+ */
+static inline asn_t _gen_random_asn(rng_t * rng, unsigned int used,
+				    unsigned int num_used)
+{
+  unsigned int asn= 1 + rng_range(rng, BGP_GEN_MAX_ASN - num_used);
+  if (asn >= used)
+    asn+= num_used;
+  return (asn_t) asn;
+}
+
+// -----[ _gen_ebgp_neighbor ]---------------------------------------
+/**
+ * Create an eBGP neighbor: a node linked to the border router, the
+ * static routes between them and a virtual peer on the router.
+ */
+static int _gen_ebgp_neighbor(network_t * network, bgp_router_t * router,
+			      net_addr_t addr, asn_t asn,
+			      bgp_peer_t ** peer_ref)
+{
+  net_node_t * node;
+  net_iface_t * iface;
+  int error;
+
+  error= node_create(addr, &node, NODE_OPTIONS_LOOPBACK);
+  if (error != ESUCCESS)
+    return error;
+  error= network_add_node(network, node);
+  if (error != ESUCCESS) {
+    node_destroy(&node);
+    return error;
+  }
+  error= net_link_create_rtr(router->node, node, BIDIR, &iface);
+  if (error != ESUCCESS)
+    return error;
+  error= node_rt_add_route(router->node, net_prefix(addr, 32),
+			   net_iface_id_addr(addr), IP_ADDR_ANY,
+			   BGP_GEN_STATIC_METRIC, NET_ROUTE_STATIC);
+  if (error != ESUCCESS)
+    return error;
+  error= node_rt_add_route(node, net_prefix(router->node->rid, 32),
+			   net_iface_id_addr(router->node->rid), IP_ADDR_ANY,
+			   BGP_GEN_STATIC_METRIC, NET_ROUTE_STATIC);
+  if (error != ESUCCESS)
+    return error;
+  error= bgp_router_add_peer(router, asn, addr, peer_ref);
+  if (error != ESUCCESS)
+    return error;
+  bgp_peer_flag_set(*peer_ref, PEER_FLAG_VIRTUAL, 1);
+  return ESUCCESS;
+}
+
+// -----[ _gen_rib ]-------------------------------------------------
+/**
+ * Announce the synthetic RIB. Each prefix has an origin AS and is
+ * announced by 1 to 3 distinct neighbors, each with its own AS-Path
+ * (neighbor, transit ASes, origin). The transit and origin ASes are
+ * not in the block of num_used ASNs that starts at used.
+ */
+static int _gen_rib(rng_t * rng, _ebgp_neighbor_t * neighbors,
+		    unsigned int num_neighbors, unsigned int num_prefixes,
+		    unsigned int used, unsigned int num_used)
+{
+  unsigned int index, index2, index3, num_announcers, length, first;
+  _ebgp_neighbor_t * neighbor;
+  bgp_route_t * route;
+  bgp_path_t * path;
+  bgp_msg_t * msg;
+  ip_pfx_t prefix;
+  asn_t origin;
+  int error;
+
+  for (index= 0; index < num_prefixes; index++) {
+    prefix.mask= PFX_LENGTH_MIN +
+      _gen_pick(rng, PFX_LENGTHS, PFX_LENGTHS_NUM);
+    prefix.network= rng_next(rng) & ~((1 << (32-prefix.mask))-1);
+    origin= _gen_random_asn(rng, used, num_used);
+
+    num_announcers= 1 + _gen_pick(rng, ANNOUNCERS, ANNOUNCERS_NUM);
+    if (num_announcers > num_neighbors)
+      num_announcers= num_neighbors;
+    first= rng_range(rng, num_neighbors);
+
+    for (index2= 0; index2 < num_announcers; index2++) {
+      neighbor= &neighbors[(first + index2) % num_neighbors];
+      length= 1 + _gen_pick(rng, PATH_LENGTHS, PATH_LENGTHS_NUM);
+      path= path_create();
+      path_append(&path, neighbor->asn);
+      for (index3= 2; index3 < length; index3++)
+	path_append(&path, _gen_random_asn(rng, used, num_used));
+      if (length > 1)
+	path_append(&path, origin);
+
+      route= route_create(prefix, NULL, neighbor->peer->addr,
+			  BGP_ORIGIN_IGP);
+      route_set_path(route, path);
+      msg= bgp_msg_update_create(neighbor->asn, route);
+      error= bgp_peer_handle_message(neighbor->peer, msg);
+      if (error != ESUCCESS)
+	return error;
+    }
+  }
+  return ESUCCESS;
+}
+
+// -----[ bgp_gen_build ]--------------------------------------------
+int bgp_gen_build(network_t * network, net_gen_topo_t * topo,
+		  const bgp_gen_params_t * params)
+{
+  bgp_router_t ** routers;
+  unsigned int * borders;
+  unsigned int num_borders= 0;
+  _ebgp_neighbor_t * neighbors= NULL;
+  bgp_domain_t * domain;
+  bgp_peer_t * peer;
+  unsigned int index, index2, used, last_used, num_used;
+  rng_t rng;
+  int error= ESUCCESS;
+
+  // The ASNs of the domain and of its neighbors must not wrap around
+  if ((topo->num_nodes < 1) || (params->ibgp >= BGP_GEN_IBGP_MAX) ||
+      (params->num_ebgp > MAX_AS - 1 - params->asn))
+    return EUNEXPECTED;
+
+  // Part of these ASNs within the range of the random ASNs
+  used= (params->asn < 1)?1:params->asn;
+  last_used= params->asn + params->num_ebgp;
+  if (last_used > BGP_GEN_MAX_ASN)
+    last_used= BGP_GEN_MAX_ASN;
+  num_used= (last_used >= used)?last_used - used + 1:0;
+  if (num_used >= BGP_GEN_MAX_ASN)
+    return EUNEXPECTED;
+  rng_init(&rng, params->seed, "bgp");
+
+  routers= (bgp_router_t **) MALLOC(sizeof(bgp_router_t *)*topo->num_nodes);
+  borders= (unsigned int *) MALLOC(sizeof(unsigned int)*topo->num_nodes);
+  for (index= 0; index < topo->num_nodes; index++) {
+    error= bgp_add_router(params->asn, topo->nodes[index], &routers[index]);
+    if (error != ESUCCESS)
+      goto exit;
+    if (topo->levels[index] == topo->max_level)
+      borders[num_borders++]= index;
+  }
+
+  // eBGP neighbors, attached to random border routers
+  if (params->num_ebgp > 0) {
+    neighbors= (_ebgp_neighbor_t *)
+      MALLOC(sizeof(_ebgp_neighbor_t)*params->num_ebgp);
+    for (index= 0; index < params->num_ebgp; index++) {
+      neighbors[index].asn= params->asn + 1 + index;
+      error= _gen_ebgp_neighbor(network,
+				routers[borders[rng_range(&rng, num_borders)]],
+				params->ebgp_base + index + 1,
+				neighbors[index].asn, &neighbors[index].peer);
+      if (error != ESUCCESS)
+	goto exit;
+    }
+  }
+
+  // iBGP sessions (the routers are started)
+  domain= get_bgp_domain(params->asn);
+  switch (params->ibgp) {
+  case BGP_GEN_IBGP_FULL_MESH:
+    error= bgp_domain_full_mesh(domain, 0);
+    break;
+  case BGP_GEN_IBGP_RR:
+    error= bgp_domain_build_rr_hierarchy(domain, params->num_clients,
+					 params->num_rrs, 0);
+    break;
+  default:
+    break;
+  }
+  if (error != ESUCCESS)
+    goto exit;
+
+  // The border routers advertise the eBGP routes with next-hop-self
+  for (index= 0; index < params->num_ebgp; index++) {
+    peer= neighbors[index].peer;
+    for (index2= 0; index2 < bgp_peers_size(peer->router->peers); index2++)
+      if (bgp_peers_at(peer->router->peers, index2)->asn == params->asn)
+	bgp_peer_flag_set(bgp_peers_at(peer->router->peers, index2),
+			  PEER_FLAG_NEXT_HOP_SELF, 1);
+    if (peer->session_state != SESSION_STATE_ESTABLISHED) {
+      error= bgp_peer_open_session(peer);
+      if (error != ESUCCESS)
+	goto exit;
+    }
+  }
+
+  if (params->num_ebgp > 0)
+    error= _gen_rib(&rng, neighbors, params->num_ebgp, params->num_prefixes,
+		    used, num_used);
+
+ exit:
+  if (neighbors != NULL)
+    FREE(neighbors);
+  FREE(borders);
+  FREE(routers);
+  return error;
+}
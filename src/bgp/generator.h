@@ -0,0 +1,92 @@
+// ==================================================================
+// @(#)generator.h
+//
+// Synthetic BGP configuration and RIB generator.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide functions to configure BGP on a topology built with the
+ * topology generator (see net/generator.h).
+ *
+ * A BGP router is added on each node of the topology. The iBGP
+ * sessions form a full-mesh or a hierarchy of route-reflectors (the
+ * reflectors are the first routers, i.e. the closest to the core).
+ * The eBGP neighbors are virtual peers attached to border routers
+ * (the routers of the highest level). Each neighbor is an extra node
+ * linked to its border router, with static routes in both
+ * directions. The border routers use next-hop-self on their iBGP
+ * sessions.
+ *
+ * The synthetic RIB is announced by the eBGP neighbors. The prefix
+ * lengths and the AS-Path lengths follow distributions observed in
+ * Internet routing tables and a prefix can be announced by several
+ * neighbors.
+ *
+ * The IGP routes of the topology must have been computed before the
+ * BGP configuration is generated.
+ */
+
+#ifndef __BGP_GENERATOR_H__
+#define __BGP_GENERATOR_H__
+
+#include <bgp/types.h>
+#include <net/generator.h>
+
+// -----[ bgp_gen_ibgp_t ]-------------------------------------------
+typedef enum {
+  BGP_GEN_IBGP_NONE,
+  BGP_GEN_IBGP_FULL_MESH,
+  BGP_GEN_IBGP_RR,
+  BGP_GEN_IBGP_MAX
+} bgp_gen_ibgp_t;
+
+// -----[ bgp_gen_params_t ]-----------------------------------------
+typedef struct {
+  asn_t          asn;
+  bgp_gen_ibgp_t ibgp;
+  /** Number of route-reflectors per cluster. */
+  unsigned int   num_rrs;
+  /** Number of clients per cluster. */
+  unsigned int   num_clients;
+  /** Number of eBGP neighbors. */
+  unsigned int   num_ebgp;
+  /** Address of eBGP neighbor i is ebgp_base+i+1. */
+  net_addr_t     ebgp_base;
+  /** Number of prefixes announced by the eBGP neighbors. */
+  unsigned int   num_prefixes;
+  unsigned long  seed;
+} bgp_gen_params_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bgp_gen_params_init ]------------------------------------
+  /** Set the default parameters. */
+  void bgp_gen_params_init(bgp_gen_params_t * params);
+  // -----[ bgp_gen_str2ibgp ]---------------------------------------
+  int bgp_gen_str2ibgp(const char * str, bgp_gen_ibgp_t * ibgp);
+  // -----[ bgp_gen_build ]------------------------------------------
+  /**
+   * Configure BGP on a generated topology and announce the
+   * synthetic RIB. The updates sent by the routers are scheduled and
+   * the simulation must be run to propagate them.
+   *
+   * \param network is the network of the topology.
+   * \param topo    is the generated topology.
+   * \param params  are the generation parameters.
+   * \retval an error code.
+   */
+  int bgp_gen_build(network_t * network, net_gen_topo_t * topo,
+		    const bgp_gen_params_t * params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_GENERATOR_H__ */
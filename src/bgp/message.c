@@ -29,6 +29,7 @@
 #include <bgp/route.h>
 
 #include <sim/simulator.h>
+#include <util/slab.h>
 
 typedef struct {
   uint16_t    uRemoteAS;
@@ -44,6 +45,15 @@ static char * bgp_msg_names[BGP_MSG_TYPE_MAX]= {
 
 static gds_stream_t * pMonitor= NULL;
 
+SLAB_CACHE(_msg_update_cache, "bgp-msg-update", bgp_msg_update_t,
+	   MEM_ACCT_MSGS);
+SLAB_CACHE(_msg_withdraw_cache, "bgp-msg-withdraw", bgp_msg_withdraw_t,
+	   MEM_ACCT_MSGS);
+SLAB_CACHE(_msg_close_cache, "bgp-msg-close", bgp_msg_close_t,
+	   MEM_ACCT_MSGS);
+SLAB_CACHE(_msg_open_cache, "bgp-msg-open", bgp_msg_open_t,
+	   MEM_ACCT_MSGS);
+
 // ----- bgp_msg_update_create --------------------------------------
 /**
  *
@@ -52,7 +62,7 @@ bgp_msg_t * bgp_msg_update_create(uint16_t peer_asn,
 				  bgp_route_t * route)
 {
   bgp_msg_update_t * msg=
-    (bgp_msg_update_t *) MALLOC(sizeof(bgp_msg_update_t));
+    (bgp_msg_update_t *) slab_alloc(&_msg_update_cache);
   msg->header.type= BGP_MSG_TYPE_UPDATE;
   msg->header.peer_asn= peer_asn;
   msg->route= route;
@@ -73,7 +83,7 @@ bgp_msg_t * bgp_msg_withdraw_create(uint16_t peer_asn,
 #endif
 {
   bgp_msg_withdraw_t * msg=
-    (bgp_msg_withdraw_t *) MALLOC(sizeof(bgp_msg_withdraw_t));
+    (bgp_msg_withdraw_t *) slab_alloc(&_msg_withdraw_cache);
   msg->header.type= BGP_MSG_TYPE_WITHDRAW;
   msg->header.peer_asn= peer_asn;
   memcpy(&(msg->prefix), &prefix, sizeof(ip_pfx_t));
@@ -97,7 +107,7 @@ bgp_msg_t * bgp_msg_withdraw_create(uint16_t peer_asn,
 bgp_msg_t * bgp_msg_close_create(uint16_t peer_asn)
 {
   bgp_msg_close_t * msg=
-    (bgp_msg_close_t *) MALLOC(sizeof(bgp_msg_close_t));
+    (bgp_msg_close_t *) slab_alloc(&_msg_close_cache);
   msg->header.type= BGP_MSG_TYPE_CLOSE;
   msg->header.peer_asn= peer_asn;
   return (bgp_msg_t *) msg;
@@ -107,7 +117,7 @@ bgp_msg_t * bgp_msg_close_create(uint16_t peer_asn)
 bgp_msg_t * bgp_msg_open_create(uint16_t peer_asn, net_addr_t router_id)
 {
   bgp_msg_open_t * msg=
-    (bgp_msg_open_t *) MALLOC(sizeof(bgp_msg_open_t));
+    (bgp_msg_open_t *) slab_alloc(&_msg_open_cache);
   msg->header.type= BGP_MSG_TYPE_OPEN;
   msg->header.peer_asn= peer_asn;
   msg->router_id= router_id;
@@ -126,7 +136,18 @@ void bgp_msg_destroy(bgp_msg_t ** msg_ref)
 	((bgp_msg_withdraw_t *)(*msg_ref))->next_hop != NULL)
       FREE( ((SBGPMsgWithdraw *)(*msg_ref))->next_hop );
 #endif
-    FREE(*msg_ref);
+    switch ((*msg_ref)->type) {
+    case BGP_MSG_TYPE_UPDATE:
+      slab_free(&_msg_update_cache, *msg_ref); break;
+    case BGP_MSG_TYPE_WITHDRAW:
+      slab_free(&_msg_withdraw_cache, *msg_ref); break;
+    case BGP_MSG_TYPE_CLOSE:
+      slab_free(&_msg_close_cache, *msg_ref); break;
+    case BGP_MSG_TYPE_OPEN:
+      slab_free(&_msg_open_cache, *msg_ref); break;
+    default:
+      abort();
+    }
     *msg_ref= NULL;
   }
 }
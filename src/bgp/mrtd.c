@@ -19,6 +19,7 @@
 
 #define _GNU_SOURCE
 
+#include <arpa/inet.h>
 #include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -43,6 +44,7 @@
 #include <bgp/mrtd.h>
 #include <bgp/route.h>
 #include <bgp/routes_list.h>
+#include <util/thread.h>
 
 //#define DEBUG
 #include <libgds/debug.h>
@@ -70,7 +72,8 @@ typedef FILE * FILE_TYPE;
 #define MRT_WITHDRAW_MIN_FIELDS 5
 
 // ----- Local tokenizers -----
-static gds_tokenizer_t * line_tokenizer= NULL;
+/** One per thread, so that lines can be parsed in parallel. */
+static THREAD_LOCAL gds_tokenizer_t * line_tokenizer= NULL;
 
 
 
@@ -110,7 +113,7 @@ const char * mrtd_strerror(int error)
   return NULL;
 }
 
-static char * _user_error= NULL;
+static THREAD_LOCAL char * _user_error= NULL;
 static unsigned int _line_number;
 static inline void _set_user_error(const char * format, ...)
 {
@@ -570,6 +573,203 @@ int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
   return error;
 }
 
+// -----[ mrtd_ascii_for_each_line ]---------------------------------
+/**
+ * Call a function for each line of an MRT ASCII file, without
+ * parsing it. This is used to spread the parsing of the lines (see
+ * mrtd_route_from_line) over several threads.
+ */
+int mrtd_ascii_for_each_line(const char * filename,
+			     mrtd_line_handler_f handler, void * ctx)
+{
+  FILE_TYPE file;
+  char line[MRT_MAX_LINE_LEN];
+  int error= BGP_INPUT_SUCCESS;
+
+  if ((filename == NULL) || !strcmp(filename, "-")) {
+    file= FILE_DOPEN(0, "r");
+  } else {
+    file= FILE_OPEN(filename, "r");
+  }
+  if (file == NULL)
+    return BGP_INPUT_ERROR_FILE_OPEN;
+
+  while (!FILE_EOF(file)) {
+    if (FILE_GETS(file, line, sizeof(line)) == NULL)
+      break;
+    if (handler(line, ctx) != 0) {
+      error= BGP_INPUT_ERROR_UNEXPECTED;
+      break;
+    }
+  }
+
+  FILE_CLOSE(file);
+  return error;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// TABLE_DUMP_V2 MRT OUTPUT (RFC6396)
+//
+/////////////////////////////////////////////////////////////////////
+
+#define MRT_TABLE_DUMP_V2          13
+#define MRT_PEER_INDEX_TABLE       1
+#define MRT_RIB_IPV4_UNICAST       2
+#define MRT_HEADER_SIZE            12
+#define MRT_PEER_TYPE_AS4          0x02
+#define MRT_ATTR_FLAG_OPTIONAL     0x80
+#define MRT_ATTR_FLAG_TRANSITIVE   0x40
+#define MRT_ATTR_FLAG_EXT_LEN      0x10
+#define MRT_ATTR_ORIGIN            1
+#define MRT_ATTR_ASPATH            2
+#define MRT_ATTR_NEXTHOP           3
+#define MRT_ATTR_MED               4
+#define MRT_ATTR_LOCALPREF         5
+#define MRT_ATTR_COMMUNITIES       8
+
+// -----[ _mrtd_put8 / _mrtd_put16 / _mrtd_put32 ]------------------
+static inline uint8_t * _mrtd_put8(uint8_t * buf, uint8_t value)
+{
+  *buf= value;
+  return buf+1;
+}
+static inline uint8_t * _mrtd_put16(uint8_t * buf, uint16_t value)
+{
+  value= htons(value);
+  memcpy(buf, &value, sizeof(value));
+  return buf+sizeof(value);
+}
+static inline uint8_t * _mrtd_put32(uint8_t * buf, uint32_t value)
+{
+  value= htonl(value);
+  memcpy(buf, &value, sizeof(value));
+  return buf+sizeof(value);
+}
+
+// -----[ _mrtd_put_header ]-----------------------------------------
+static inline uint8_t * _mrtd_put_header(uint8_t * buf, uint32_t timestamp,
+					 uint16_t subtype, uint32_t length)
+{
+  buf= _mrtd_put32(buf, timestamp);
+  buf= _mrtd_put16(buf, MRT_TABLE_DUMP_V2);
+  buf= _mrtd_put16(buf, subtype);
+  return _mrtd_put32(buf, length);
+}
+
+// -----[ _mrtd_put_attr ]-------------------------------------------
+/** Write the header of a path attribute. */
+static inline uint8_t * _mrtd_put_attr(uint8_t * buf, uint8_t flags,
+				       uint8_t type, size_t length)
+{
+  if (length > 255)
+    flags|= MRT_ATTR_FLAG_EXT_LEN;
+  buf= _mrtd_put8(buf, flags);
+  buf= _mrtd_put8(buf, type);
+  if (length > 255)
+    return _mrtd_put16(buf, length);
+  return _mrtd_put8(buf, length);
+}
+
+// -----[ _mrtd_attr_size ]------------------------------------------
+static inline size_t _mrtd_attr_size(size_t length)
+{
+  return ((length > 255)?4:3) + length;
+}
+
+// -----[ mrtd_v2_encode_peer_table ]--------------------------------
+int mrtd_v2_encode_peer_table(uint32_t timestamp, net_addr_t collector,
+			      const mrtd_peer_t * peers,
+			      unsigned int num_peers,
+			      uint8_t * buf, size_t size)
+{
+  size_t length= 8 + num_peers*13;
+  unsigned int index;
+  uint8_t * ptr;
+
+  if ((num_peers > MAX_UINT16_T) || (MRT_HEADER_SIZE+length > size))
+    return -1;
+  ptr= _mrtd_put_header(buf, timestamp, MRT_PEER_INDEX_TABLE, length);
+  ptr= _mrtd_put32(ptr, collector);
+  ptr= _mrtd_put16(ptr, 0); // No view name
+  ptr= _mrtd_put16(ptr, num_peers);
+  for (index= 0; index < num_peers; index++) {
+    ptr= _mrtd_put8(ptr, MRT_PEER_TYPE_AS4);
+    ptr= _mrtd_put32(ptr, peers[index].addr);
+    ptr= _mrtd_put32(ptr, peers[index].addr);
+    ptr= _mrtd_put32(ptr, peers[index].asn);
+  }
+  return MRT_HEADER_SIZE+length;
+}
+
+// -----[ mrtd_v2_encode_rib ]---------------------------------------
+/**
+ * Encode a route as a RIB_IPV4_UNICAST record with a single entry.
+ * As required for TABLE_DUMP_V2, the ASNs of the AS-Path are encoded
+ * on 4 bytes.
+ */
+int mrtd_v2_encode_rib(uint32_t timestamp, uint32_t seq_num,
+		       bgp_route_t * route, uint16_t peer_index,
+		       uint8_t * buf, size_t size)
+{
+  bgp_attr_t * attr= route->attr;
+  unsigned int num_comms= (attr->comms != NULL)?attr->comms->num:0;
+  unsigned int pfx_len= (route->prefix.mask+7)/8;
+  size_t path_len= 0, attr_len, length;
+  bgp_path_seg_t * seg= NULL;
+  unsigned int index, index2;
+  uint8_t * ptr;
+
+  while ((seg= path_segment_next(attr->path_ref, seg)) != NULL)
+    path_len+= 2 + seg->length*4;
+  attr_len= _mrtd_attr_size(1) + _mrtd_attr_size(path_len) +
+    _mrtd_attr_size(4) + _mrtd_attr_size(4);
+  if (attr->med != ROUTE_MED_MISSING)
+    attr_len+= _mrtd_attr_size(4);
+  if (num_comms > 0)
+    attr_len+= _mrtd_attr_size(num_comms*4);
+  length= 4 + 1 + pfx_len + 2 + 8 + attr_len;
+  if ((attr_len > MAX_UINT16_T) || (MRT_HEADER_SIZE+length > size))
+    return -1;
+
+  ptr= _mrtd_put_header(buf, timestamp, MRT_RIB_IPV4_UNICAST, length);
+  ptr= _mrtd_put32(ptr, seq_num);
+  ptr= _mrtd_put8(ptr, route->prefix.mask);
+  for (index= 0; index < pfx_len; index++)
+    ptr= _mrtd_put8(ptr, (route->prefix.network >> (24-8*index)) & 255);
+  ptr= _mrtd_put16(ptr, 1);
+  ptr= _mrtd_put16(ptr, peer_index);
+  ptr= _mrtd_put32(ptr, timestamp);
+  ptr= _mrtd_put16(ptr, attr_len);
+
+  ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_TRANSITIVE, MRT_ATTR_ORIGIN, 1);
+  ptr= _mrtd_put8(ptr, attr->origin);
+  ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_TRANSITIVE, MRT_ATTR_ASPATH,
+		      path_len);
+  while ((seg= path_segment_next(attr->path_ref, seg)) != NULL) {
+    ptr= _mrtd_put8(ptr, seg->type);
+    ptr= _mrtd_put8(ptr, seg->length);
+    for (index2= 0; index2 < seg->length; index2++)
+      ptr= _mrtd_put32(ptr, seg->asns[index2]);
+  }
+  ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_TRANSITIVE, MRT_ATTR_NEXTHOP, 4);
+  ptr= _mrtd_put32(ptr, attr->next_hop);
+  if (attr->med != ROUTE_MED_MISSING) {
+    ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_OPTIONAL, MRT_ATTR_MED, 4);
+    ptr= _mrtd_put32(ptr, attr->med);
+  }
+  ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_TRANSITIVE, MRT_ATTR_LOCALPREF, 4);
+  ptr= _mrtd_put32(ptr, attr->local_pref);
+  if (num_comms > 0) {
+    ptr= _mrtd_put_attr(ptr, MRT_ATTR_FLAG_OPTIONAL|MRT_ATTR_FLAG_TRANSITIVE,
+			MRT_ATTR_COMMUNITIES, num_comms*4);
+    for (index= 0; index < num_comms; index++)
+      ptr= _mrtd_put32(ptr, attr->comms->values[index]);
+  }
+  return MRT_HEADER_SIZE+length;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -677,7 +877,7 @@ bgp_path_t * mrtd_process_aspath(const struct aspath * path)
     /* Add the segment to the AS-path */
     if (cbgp_path == NULL)
       cbgp_path= path_create();
-    path_add_segment(cbgp_path, seg);
+    path_add_segment(&cbgp_path, seg);
 
     /* Go to next segment... */
     pnt+= (assegment->length * path->asn_len) + AS_HEADER_SIZE;
@@ -947,6 +1147,21 @@ int mrtd_binary_load(const char * filename, bgp_route_handler_f handler,
 //
 /////////////////////////////////////////////////////////////////////
 
+// -----[ mrtd_thread_exit ]-----------------------------------------
+/**
+ * Release the parser state of the calling thread. This must be
+ * called by the threads that parsed MRT lines before they exit.
+ */
+void mrtd_thread_exit()
+{
+  if (line_tokenizer != NULL)
+    tokenizer_destroy(&line_tokenizer);
+  if (_user_error != NULL) {
+    free(_user_error);
+    _user_error= NULL;
+  }
+}
+
 // -----[ _mrtd_destroy ]--------------------------------------------
 void _mrtd_destroy()
 {
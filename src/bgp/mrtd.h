@@ -30,6 +30,16 @@ typedef uint8_t mrtd_input_t;
 #define MRT_FORMAT_ASCII  0
 #define MRT_FORMAT_BINARY 1
 
+// -----[ mrtd_peer_t ]---------------------------------------------
+/** Entry of a TABLE_DUMP_V2 peer index table. */
+typedef struct {
+  net_addr_t addr;
+  asn_t      asn;
+} mrtd_peer_t;
+
+// -----[ mrtd_line_handler_f ]--------------------------------------
+typedef int (*mrtd_line_handler_f)(const char * line, void * ctx);
+
 // -----[ mrtd_error_code_t ]----------------------------------------
 typedef enum {
   MRTD_SUCCESS            = LRP_SUCCESS,
@@ -70,12 +80,43 @@ extern "C" {
   // ----- mrtd_ascii_load_routes -----------------------------------
   int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
 		      void * ctx);
+  // -----[ mrtd_ascii_for_each_line ]------------------------------
+  int mrtd_ascii_for_each_line(const char * filename,
+			       mrtd_line_handler_f handler, void * ctx);
   // -----[ mrtd_strerror ]------------------------------------------
   const char * mrtd_strerror(int result);
   // -----[ mrtd_perror ]--------------------------------------------
   void mrtd_perror(gds_stream_t * stream, int result);
 
 
+  ///////////////////////////////////////////////////////////////////
+  // TABLE_DUMP_V2 MRT OUTPUT
+  ///////////////////////////////////////////////////////////////////
+
+  // -----[ mrtd_v2_encode_peer_table ]------------------------------
+  /**
+   * Encode a PEER_INDEX_TABLE record.
+   *
+   * \retval the number of bytes written, or -1 if the record does not
+   *   fit in the buffer.
+   */
+  int mrtd_v2_encode_peer_table(uint32_t timestamp, net_addr_t collector,
+				const mrtd_peer_t * peers,
+				unsigned int num_peers,
+				uint8_t * buf, size_t size);
+  // -----[ mrtd_v2_encode_rib ]-------------------------------------
+  /**
+   * Encode a RIB_IPV4_UNICAST record. The peer index refers to the
+   * last PEER_INDEX_TABLE record.
+   *
+   * \retval the number of bytes written, or -1 if the record does not
+   *   fit in the buffer.
+   */
+  int mrtd_v2_encode_rib(uint32_t timestamp, uint32_t seq_num,
+			 bgp_route_t * route, uint16_t peer_index,
+			 uint8_t * buf, size_t size);
+
+
   ///////////////////////////////////////////////////////////////////
   // BINARY MRT FUNCTIONS
   ///////////////////////////////////////////////////////////////////
@@ -91,6 +132,8 @@ extern "C" {
   // INITIALIZATION & FINALIZATION
   ///////////////////////////////////////////////////////////////////
 
+  // -----[ mrtd_thread_exit ]--------------------------------------
+  void mrtd_thread_exit();
   // ----- _mrtd_destroy --------------------------------------------
   void _mrtd_destroy();
 
@@ -10,6 +10,9 @@
 # include <config.h>
 #endif
 
+#include <assert.h>
+#include <string.h>
+
 #include <net/error.h>
 
 #include <bgp/peer.h>
@@ -55,13 +58,54 @@ void bgp_peers_destroy(bgp_peers_t ** peers_ref)
 }
 
 // -----[ bgp_peers_add ]--------------------------------------------
+/**
+ * Add a peer to the list. The peer's index in the router's unified
+ * RIB is the number of peers added before it (peers are never
+ * removed from a router).
+ */
 net_error_t bgp_peers_add(bgp_peers_t * peers, bgp_peer_t * peer)
 {
+  peer->rib_index= ptr_array_length(peers);
   if (ptr_array_add(peers, &peer) < 0)
     return EBGP_PEER_DUPLICATE;
   return ESUCCESS;
 }
 
+// -----[ bgp_peers_add_bulk ]---------------------------------------
+/**
+ * Add several peers at once. The new peers must be sorted by
+ * address. If the list is empty, it is allocated once and filled in
+ * order. Otherwise, the peers are inserted one at a time.
+ *
+ * In case of error, the peers that could not be added are destroyed.
+ */
+net_error_t bgp_peers_add_bulk(bgp_peers_t * peers, bgp_peer_t ** new_peers,
+			       unsigned int num_peers)
+{
+  unsigned int index;
+  net_error_t error;
+
+  if (ptr_array_length(peers) == 0) {
+    for (index= 1; index < num_peers; index++)
+      assert(new_peers[index-1]->addr < new_peers[index]->addr);
+    for (index= 0; index < num_peers; index++)
+      new_peers[index]->rib_index= index;
+    ptr_array_set_length(peers, num_peers);
+    memcpy(peers->data, new_peers, num_peers * sizeof(bgp_peer_t *));
+    return ESUCCESS;
+  }
+
+  for (index= 0; index < num_peers; index++) {
+    error= bgp_peers_add(peers, new_peers[index]);
+    if (error != ESUCCESS) {
+      for (; index < num_peers; index++)
+	bgp_peer_destroy(&new_peers[index]);
+      return error;
+    }
+  }
+  return ESUCCESS;
+}
+
 // -----[ bgp_peers_find ]-------------------------------------------
 bgp_peer_t * bgp_peers_find(bgp_peers_t * peers, net_addr_t addr)
 {
@@ -24,6 +24,10 @@ extern "C" {
   void bgp_peers_destroy(bgp_peers_t ** peers);
   // -----[ bgp_peers_add ]------------------------------------------
   net_error_t bgp_peers_add(bgp_peers_t * peers, bgp_peer_t * peer);
+  // -----[ bgp_peers_add_bulk ]-------------------------------------
+  net_error_t bgp_peers_add_bulk(bgp_peers_t * peers,
+				 bgp_peer_t ** new_peers,
+				 unsigned int num_peers);
   // -----[ bgp_peers_find ]-----------------------------------------
   bgp_peer_t * bgp_peers_find(bgp_peers_t * peers, net_addr_t addr);
   // -----[ bgp_peers_for_each ]-------------------------------------
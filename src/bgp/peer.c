@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <libgds/stream.h>
 #include <libgds/memory.h>
@@ -22,6 +23,7 @@
 #include <net/icmp.h>
 #include <net/network.h>
 #include <net/node.h>
+#include <sim/shard.h>
 
 #include <bgp/as.h>
 #include <bgp/attr/comm.h>
@@ -29,9 +31,12 @@
 #include <bgp/filter/filter.h>
 #include <bgp/message.h>
 #include <bgp/peer.h>
+#include <bgp/peer-list.h>
 #include <bgp/qos.h>
 #include <bgp/rib.h>
+#include <bgp/rib_cursor.h>
 #include <bgp/route.h>
+#include <bgp/urib.h>
 
 char * SESSION_STATES[SESSION_STATE_MAX]= {
   "IDLE",
@@ -56,6 +61,10 @@ static inline int _bgp_peer_send(bgp_peer_t * peer, bgp_msg_t * msg);
  * structures:
  *   - default input/output filters (accept everything)
  *   - input/output adjacent RIBs
+ *
+ * If the router uses a unified RIB, the peer has no separate
+ * Adj-RIB-In. Its routes are stored in the router's unified RIB,
+ * under the peer's index.
  */
 bgp_peer_t * bgp_peer_create(asn_t asn, net_addr_t addr,
 			     bgp_router_t * router)
@@ -67,10 +76,18 @@ bgp_peer_t * bgp_peer_create(asn_t asn, net_addr_t addr,
   peer->router_id= NET_ADDR_ANY;
   peer->filter[FILTER_IN]= NULL; // Default = ACCEPT ANY
   peer->filter[FILTER_OUT]= NULL; // Default = ACCEPT ANY
-  peer->adj_rib[RIB_IN]= rib_create(0);
+  peer->rib_index= 0; // Set when the peer is added (see bgp_peers_add)
+  if ((router != NULL) && (router->urib != NULL))
+    peer->adj_rib[RIB_IN]= NULL;
+  else
+    peer->adj_rib[RIB_IN]= rib_create(0);
   peer->adj_rib[RIB_OUT]= rib_create(0);
+  peer->rib_out_marks= NULL;
+  peer->session_ok_epoch= 0;
+  peer->session_ok= 0;
   peer->session_state= SESSION_STATE_IDLE;
   peer->flags= 0;
+  memset(&peer->stats, 0, sizeof(peer->stats));
 
   // Options
   peer->next_hop= NET_ADDR_ANY;
@@ -102,6 +119,8 @@ void bgp_peer_destroy(bgp_peer_t ** ppeer)
     /* Free input and output adjacent RIBs */
     rib_destroy(&(*ppeer)->adj_rib[RIB_IN]);
     rib_destroy(&(*ppeer)->adj_rib[RIB_OUT]);
+    if ((*ppeer)->rib_out_marks != NULL)
+      trie_destroy(&(*ppeer)->rib_out_marks);
 
     FREE(*ppeer);
     *ppeer= NULL;
@@ -119,6 +138,8 @@ void bgp_peer_flag_set(bgp_peer_t * peer, uint8_t flag, int state)
     peer->flags|= flag;
   else
     peer->flags&= ~flag;
+  /* The reachability check depends on the flags (virtual peer) */
+  peer->session_ok_epoch= 0;
 }
 
 // ----- bgp_peer_flag_get ------------------------------------------
@@ -192,6 +213,11 @@ static int _bgp_peer_prefix_disseminate(uint32_t uKey, uint8_t uKeyLen,
  * function checks if there is a route towards the peer router. Then,
  * the function checks if the resulting link is up. If both conditions
  * are met, the BGP session is considered OK.
+ *
+ * The check requires a private simulation (ping or trace). Its
+ * verdict only depends on the topology and on the forwarding tables,
+ * hence it is cached until the topology epoch changes (see
+ * network_get_epoch).
  */
 int bgp_peer_session_ok(bgp_peer_t * peer)
 {
@@ -199,6 +225,10 @@ int bgp_peer_session_ok(bgp_peer_t * peer)
   //ip_dest_t dest;
   ip_trace_t * trace= NULL;
   array_t * traces;
+  unsigned long epoch= network_get_epoch();
+
+  if (peer->session_ok_epoch == epoch)
+    return peer->session_ok;
 
   if (bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL)) {
     //dest.type= NET_DEST_ADDRESS;
@@ -218,6 +248,8 @@ int bgp_peer_session_ok(bgp_peer_t * peer)
 				 0, peer->addr, 0);
     result= (result == ESUCCESS);
   }
+  peer->session_ok= result;
+  peer->session_ok_epoch= epoch;
   return result;
 }
 
@@ -340,6 +372,43 @@ int bgp_peer_open_session(bgp_peer_t * peer)
   return ESUCCESS;
 }
 
+// -----[ bgp_peer_establish_session ]-------------------------------
+/**
+ * Bring the session directly to ESTABLISHED state, without any OPEN
+ * message exchange. This is used to build large meshes of sessions
+ * in bulk, once the caller has checked that both ends are mutually
+ * reachable. The content of the Loc-RIB is not disseminated to the
+ * peer: this is left to the caller.
+ *
+ * Precondition:
+ * - the session must be in IDLE or ACTIVE state or an error will be
+ *   issued.
+ */
+int bgp_peer_establish_session(bgp_peer_t * peer, net_addr_t router_id)
+{
+  const rt_entries_t * rtentries;
+
+  if ((peer->session_state != SESSION_STATE_IDLE) &&
+      (peer->session_state != SESSION_STATE_ACTIVE))
+    return EBGP_PEER_INVALID_STATE;
+
+  if (!bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL) &&
+      !bgp_peer_flag_get(peer, PEER_FLAG_NEXT_HOP_OV)) {
+    rtentries= node_rt_lookup(peer->router->node, peer->addr);
+    if (rtentries == NULL)
+      return EBGP_PEER_UNREACHABLE;
+    peer->next_hop=
+      net_iface_src_address(rt_entries_get_at(rtentries, 0)->oif);
+  }
+
+  peer->session_state= SESSION_STATE_ESTABLISHED;
+  peer->router_id= router_id;
+  peer->send_seq_num= 0;
+  peer->recv_seq_num= 0;
+  peer->last_error= ESUCCESS;
+  return ESUCCESS;
+}
+
 // ----- bgp_peer_close_session -------------------------------------
 /**
  * Close the BGP session with the peer. Closing the BGP session
@@ -594,6 +663,14 @@ static int _bgp_peer_enable_adjribin(uint32_t uKey, uint8_t uKeyLen,
  */
 static void _bgp_peer_adjrib_clear(bgp_peer_t * peer, bgp_rib_dir_t dir)
 {
+  if ((dir == RIB_IN) && (peer->router->urib != NULL)) {
+    urib_clear_peer(peer->router->urib, peer->rib_index);
+    return;
+  }
+  if (dir == RIB_OUT) {
+    bgp_peer_rib_out_clear(peer);
+    return;
+  }
   rib_destroy(&peer->adj_rib[dir]);
   peer->adj_rib[dir]= rib_create(0);
 }
@@ -606,15 +683,15 @@ static inline void _bgp_peer_rescan_adjribin(bgp_peer_t * peer, int iClear)
 {
   if (peer->session_state == SESSION_STATE_ESTABLISHED) {
 
-    rib_for_each(peer->adj_rib[RIB_IN], _bgp_peer_enable_adjribin,
-		 peer);
+    bgp_peer_rib_for_each(peer, RIB_IN, _bgp_peer_enable_adjribin,
+			  peer);
 
   } else {
 
     // For each route in Adj-RIB-In, mark as unfeasible
     // and run decision process for each route marked as best
-    rib_for_each(peer->adj_rib[RIB_IN], _bgp_peer_disable_adjribin,
-		 peer);
+    bgp_peer_rib_for_each(peer, RIB_IN, _bgp_peer_disable_adjribin,
+			  peer);
     
     // Clear Adj-RIB-In ?
     if (iClear)
@@ -815,6 +892,8 @@ int bgp_peer_route_eligible(bgp_peer_t * peer, bgp_route_t * route)
   }
   
   // Apply the input filters.
+  if (peer->filter[FILTER_IN] != NULL)
+    peer->router->stats.filter_evals++;
   if (!filter_apply(peer->filter[FILTER_IN], peer->router, route)) {
     STREAM_DEBUG(STREAM_LEVEL_DEBUG, "in-filtered(filter)\n");
     return 0;
@@ -841,6 +920,325 @@ int bgp_peer_route_feasible(bgp_peer_t * self, bgp_route_t * route)
   return (rtentries != NULL);
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// ADJ-RIB ACCESS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bgp_peer_urib ]-------------------------------------------
+/**
+ * Return the unified RIB that holds the routes of the given Adj-RIB
+ * or NULL if this Adj-RIB is a separate RIB. Only the Adj-RIB-In can
+ * be part of a unified RIB.
+ */
+static inline bgp_urib_t * _bgp_peer_urib(bgp_peer_t * peer,
+					  bgp_rib_dir_t dir)
+{
+  if ((dir != RIB_IN) || (peer->router == NULL))
+    return NULL;
+  return peer->router->urib;
+}
+
+// -----[ _bgp_peer_rib_out_fingerprint ]----------------------------
+/**
+ * Compute a fingerprint of a route advertised to a peer. AS-Paths
+ * and Communities are intern (shared through the global hash
+ * tables), hence their references can be used.
+ *
+ * The fingerprint is stored as a trie item and must not be NULL.
+ */
+static inline void * _bgp_peer_rib_out_fingerprint(bgp_route_t * route)
+{
+  bgp_attr_t * attr= route->attr;
+  uintptr_t fp;
+
+  fp= (uintptr_t) route->peer;
+  fp= fp * 31 + attr->next_hop;
+  fp= fp * 31 + attr->origin;
+  fp= fp * 31 + attr->local_pref;
+  fp= fp * 31 + attr->med;
+  fp= fp * 31 + (uintptr_t) attr->path_ref;
+  fp= fp * 31 + (uintptr_t) attr->comms;
+  if (attr->originator != NULL)
+    fp= fp * 31 + *attr->originator;
+  return (void *) (fp | 1);
+}
+
+// -----[ _bgp_peer_rib_out_derive ]---------------------------------
+/**
+ * Derive the Adj-RIB-Out route towards the given prefix when the
+ * Adj-RIB-Out is elided. The route is the router's current best
+ * route, provided that it matches the fingerprint of the route that
+ * was advertised. The returned route belongs to the Loc-RIB.
+ */
+static inline bgp_route_t * _bgp_peer_rib_out_derive(bgp_peer_t * peer,
+						     ip_pfx_t prefix,
+						     void * mark)
+{
+  bgp_route_t * route;
+
+  if (mark == NULL)
+    return NULL;
+  route= bgp_router_find_best(peer->router, prefix);
+  if ((route == NULL) || (_bgp_peer_rib_out_fingerprint(route) != mark))
+    return NULL;
+  return route;
+}
+
+// -----[ _bgp_peer_rib_out_find_exact ]-----------------------------
+static inline bgp_route_t * _bgp_peer_rib_out_find_exact(bgp_peer_t * peer,
+							 ip_pfx_t prefix)
+{
+  return _bgp_peer_rib_out_derive(peer, prefix,
+				  trie_find_exact(peer->rib_out_marks,
+						  prefix.network,
+						  prefix.mask));
+}
+
+// -----[ _bgp_peer_rib_out_find_best ]------------------------------
+static inline bgp_route_t * _bgp_peer_rib_out_find_best(bgp_peer_t * peer,
+							ip_pfx_t prefix)
+{
+  bgp_route_t * route;
+  int mask;
+
+  for (mask= prefix.mask; mask >= 0; mask--) {
+    prefix.mask= mask;
+    ip_prefix_mask(&prefix);
+    route= _bgp_peer_rib_out_find_exact(peer, prefix);
+    if (route != NULL)
+      return route;
+  }
+  return NULL;
+}
+
+typedef struct {
+  bgp_peer_t        * peer;
+  FRadixTreeForEach   for_each;
+  void              * ctx;
+} _rib_out_for_each_ctx_t;
+
+// -----[ _bgp_peer_rib_out_for_each ]-------------------------------
+static int _bgp_peer_rib_out_for_each(uint32_t key, uint8_t key_len,
+				      void * item, void * context)
+{
+  _rib_out_for_each_ctx_t * ctx= (_rib_out_for_each_ctx_t *) context;
+  ip_pfx_t prefix= { .network= key, .mask= key_len };
+  bgp_route_t * route= _bgp_peer_rib_out_derive(ctx->peer, prefix, item);
+
+  if (route == NULL)
+    return 0;
+  return ctx->for_each(key, key_len, route, ctx->ctx);
+}
+
+// -----[ bgp_peer_rib_find_exact ]----------------------------------
+/**
+ * Return the route towards exactly the given prefix in one of the
+ * Adj-RIBs of this peer.
+ */
+bgp_route_t * bgp_peer_rib_find_exact(bgp_peer_t * peer,
+				      bgp_rib_dir_t dir,
+				      ip_pfx_t prefix)
+{
+  bgp_urib_t * urib= _bgp_peer_urib(peer, dir);
+
+  if (urib != NULL)
+    return urib_find_route(urib, prefix, peer->rib_index);
+  if ((dir == RIB_OUT) && (peer->rib_out_marks != NULL))
+    return _bgp_peer_rib_out_find_exact(peer, prefix);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  return rib_find_one_exact(peer->adj_rib[dir], prefix, NULL);
+#else
+  return rib_find_exact(peer->adj_rib[dir], prefix);
+#endif
+}
+
+// -----[ bgp_peer_rib_find_best ]-----------------------------------
+/**
+ * Return the route with the longest prefix matching the given
+ * prefix in one of the Adj-RIBs of this peer.
+ */
+bgp_route_t * bgp_peer_rib_find_best(bgp_peer_t * peer,
+				     bgp_rib_dir_t dir,
+				     ip_pfx_t prefix)
+{
+  bgp_urib_t * urib= _bgp_peer_urib(peer, dir);
+
+  if (urib != NULL)
+    return urib_find_best_route(urib, prefix, peer->rib_index);
+  if ((dir == RIB_OUT) && (peer->rib_out_marks != NULL))
+    return _bgp_peer_rib_out_find_best(peer, prefix);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  return rib_find_one_best(peer->adj_rib[dir], prefix);
+#else
+  return rib_find_best(peer->adj_rib[dir], prefix);
+#endif
+}
+
+// -----[ bgp_peer_rib_for_each ]------------------------------------
+/**
+ * Call the given function for each route in one of the Adj-RIBs of
+ * this peer.
+ */
+int bgp_peer_rib_for_each(bgp_peer_t * peer, bgp_rib_dir_t dir,
+			  FRadixTreeForEach for_each, void * ctx)
+{
+  bgp_urib_t * urib= _bgp_peer_urib(peer, dir);
+  _rib_out_for_each_ctx_t out_ctx;
+
+  if (urib != NULL)
+    return urib_for_each_route(urib, peer->rib_index, for_each, ctx);
+  if ((dir == RIB_OUT) && (peer->rib_out_marks != NULL)) {
+    out_ctx.peer= peer;
+    out_ctx.for_each= for_each;
+    out_ctx.ctx= ctx;
+    return trie_for_each(peer->rib_out_marks, _bgp_peer_rib_out_for_each,
+			 &out_ctx);
+  }
+  return rib_for_each(peer->adj_rib[dir], for_each, ctx);
+}
+
+// -----[ bgp_peer_rib_replace_route ]------------------------------
+/**
+ * Store a route in one of the Adj-RIBs of this peer. The previous
+ * route towards the same prefix (if any) is destroyed.
+ */
+int bgp_peer_rib_replace_route(bgp_peer_t * peer, bgp_rib_dir_t dir,
+			       bgp_route_t * route)
+{
+  bgp_urib_t * urib= _bgp_peer_urib(peer, dir);
+
+  if (urib != NULL)
+    return urib_replace_route(urib, peer->rib_index, route);
+  return rib_replace_route(peer->adj_rib[dir], route);
+}
+
+// -----[ bgp_peer_rib_remove_route ]-------------------------------
+/**
+ * Remove (and destroy) the route towards the given prefix from one
+ * of the Adj-RIBs of this peer.
+ */
+int bgp_peer_rib_remove_route(bgp_peer_t * peer, bgp_rib_dir_t dir,
+			      ip_pfx_t prefix)
+{
+  bgp_urib_t * urib= _bgp_peer_urib(peer, dir);
+
+  if (urib != NULL)
+    return urib_remove_route(urib, prefix, peer->rib_index);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  return rib_remove_route(peer->adj_rib[dir], prefix, NULL);
+#else
+  return rib_remove_route(peer->adj_rib[dir], prefix);
+#endif
+}
+
+// -----[ bgp_peer_rib_out_mark ]------------------------------------
+/**
+ * Record that the given route was advertised to this peer. This is
+ * only used when the Adj-RIB-Out is elided.
+ */
+void bgp_peer_rib_out_mark(bgp_peer_t * peer, bgp_route_t * route)
+{
+  assert(peer->rib_out_marks != NULL);
+  trie_insert(peer->rib_out_marks, route->prefix.network,
+	      route->prefix.mask, _bgp_peer_rib_out_fingerprint(route),
+	      TRIE_INSERT_OR_REPLACE);
+}
+
+// -----[ bgp_peer_rib_out_unmark ]----------------------------------
+/**
+ * Forget that a route towards the given prefix was advertised to
+ * this peer. This is only used when the Adj-RIB-Out is elided.
+ *
+ * Return value:
+ *   1 if a route had been advertised
+ *   0 otherwise
+ */
+int bgp_peer_rib_out_unmark(bgp_peer_t * peer, ip_pfx_t prefix)
+{
+  assert(peer->rib_out_marks != NULL);
+  if (trie_find_exact(peer->rib_out_marks, prefix.network,
+		      prefix.mask) == NULL)
+    return 0;
+  trie_remove(peer->rib_out_marks, prefix.network, prefix.mask);
+  return 1;
+}
+
+// -----[ bgp_peer_rib_out_clear ]-----------------------------------
+/**
+ * Clear the Adj-RIB-Out of this peer (stored or elided).
+ */
+void bgp_peer_rib_out_clear(bgp_peer_t * peer)
+{
+  rib_destroy(&peer->adj_rib[RIB_OUT]);
+  peer->adj_rib[RIB_OUT]= rib_create(0);
+  if (peer->rib_out_marks != NULL) {
+    trie_destroy(&peer->rib_out_marks);
+    peer->rib_out_marks= trie_create(NULL);
+  }
+}
+
+// -----[ _bgp_peer_rib_out_elide_for_each ]-------------------------
+static int _bgp_peer_rib_out_elide_for_each(uint32_t key, uint8_t key_len,
+					    void * item, void * ctx)
+{
+  bgp_peer_rib_out_mark((bgp_peer_t *) ctx, (bgp_route_t *) item);
+  return 0;
+}
+
+// -----[ _bgp_peer_rib_out_store_for_each ]-------------------------
+static int _bgp_peer_rib_out_store_for_each(uint32_t key, uint8_t key_len,
+					    void * item, void * ctx)
+{
+  bgp_peer_t * peer= (bgp_peer_t *) ctx;
+  return rib_add_route(peer->adj_rib[RIB_OUT],
+		       route_copy((bgp_route_t *) item));
+}
+
+// -----[ bgp_peer_set_rib_out_elide ]-------------------------------
+/**
+ * Select how the Adj-RIB-Out of this peer is maintained.
+ *
+ * When the Adj-RIB-Out is stored (default), a copy of each route
+ * advertised to the peer is kept. When it is elided, only a small
+ * fingerprint of the advertised route is kept for each prefix. This
+ * is sufficient to decide if a withdraw must be sent. When the
+ * Adj-RIB-Out needs to be read (e.g. 'show adj-rib out'), the
+ * routes are derived from the Loc-RIB. This trades CPU for memory
+ * and is mostly useful on route-reflectors with many clients.
+ *
+ * Switching mode converts the current Adj-RIB-Out.
+ *
+ * Return value:
+ *   ESUCCESS              on success
+ *   EUNSUPPORTED          if not supported (Walton)
+ */
+int bgp_peer_set_rib_out_elide(bgp_peer_t * peer, int state)
+{
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  return EUNSUPPORTED;
+#else
+  if (state) {
+    if (peer->rib_out_marks != NULL)
+      return ESUCCESS;
+    peer->rib_out_marks= trie_create(NULL);
+    rib_for_each(peer->adj_rib[RIB_OUT], _bgp_peer_rib_out_elide_for_each,
+		 peer);
+    rib_destroy(&peer->adj_rib[RIB_OUT]);
+    peer->adj_rib[RIB_OUT]= rib_create(0);
+  } else {
+    if (peer->rib_out_marks == NULL)
+      return ESUCCESS;
+    bgp_peer_rib_for_each(peer, RIB_OUT, _bgp_peer_rib_out_store_for_each,
+			  peer);
+    trie_destroy(&peer->rib_out_marks);
+  }
+  bgp_peer_flag_set(peer, PEER_FLAG_RIB_OUT_ELIDE, state);
+  return ESUCCESS;
+#endif
+}
+
 // -----[ _bgp_peer_process_update ]----------------------------------
 /**
  * Process a BGP UPDATE message.
@@ -897,7 +1295,7 @@ static inline void _bgp_peer_process_update(bgp_peer_t * peer,
   // - the old route was the best
   // - the new route is eligible
   need_DP_run= 0;
-  pOldRoute= rib_find_exact(peer->adj_rib[RIB_IN], route->prefix);
+  pOldRoute= bgp_peer_rib_find_exact(peer, RIB_IN, route->prefix);
   if (((pOldRoute != NULL) &&
        route_flag_get(pOldRoute, ROUTE_FLAG_BEST)) ||
       route_flag_get(route, ROUTE_FLAG_ELIGIBLE)) 
@@ -907,10 +1305,10 @@ static inline void _bgp_peer_process_update(bgp_peer_t * peer,
   
   // Replace former route in Adj-RIB-In
   if (route_flag_get(route, ROUTE_FLAG_ELIGIBLE)) {
-    assert(rib_replace_route(peer->adj_rib[RIB_IN], route) == 0);
+    assert(bgp_peer_rib_replace_route(peer, RIB_IN, route) == 0);
   } else {
     if (pOldRoute != NULL)
-      assert(rib_remove_route(peer->adj_rib[RIB_IN], route->prefix) == 0);
+      assert(bgp_peer_rib_remove_route(peer, RIB_IN, route->prefix) == 0);
     route_destroy(&route);
   }
   
@@ -935,7 +1333,7 @@ static inline void _bgp_peer_process_withdraw(bgp_peer_t * peer,
   bgp_route_t * route;
   
   // Identifiy route to be removed based on destination prefix
-  route= rib_find_exact(peer->adj_rib[RIB_IN], msg->prefix);
+  route= bgp_peer_rib_find_exact(peer, RIB_IN, msg->prefix);
   
   // If there was no previous route, do nothing
   // Note: we should probably trigger an error/warning message in this case
@@ -956,7 +1354,7 @@ static inline void _bgp_peer_process_withdraw(bgp_peer_t * peer,
     stream_printf(gdsdebug, "\n");
   }
   
-  assert(rib_remove_route(peer->adj_rib[RIB_IN], msg->prefix) == 0);
+  assert(bgp_peer_rib_remove_route(peer, RIB_IN, msg->prefix) == 0);
 }
 
 
@@ -970,13 +1368,25 @@ static inline void _bgp_peer_process_withdraw(bgp_peer_t * peer,
  * There are two exceptions:
  *   - this check is not performed for messages received from a
  *     virtual peering
- *   
+ *   - in a sharded run, the messages of a session are spread over
+ *     the shards: the sequence number is checked against the value
+ *     expected by the shard (see sim_shard_seq_check)
  */
 static inline int _bgp_peer_seqnum_check(bgp_peer_t * peer,
-					  bgp_msg_t * msg)
+					  bgp_msg_t * msg,
+					  simulator_t * sim)
 {
-  if ((bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL) == 0) &&
-      (peer->recv_seq_num != msg->seq_num)) {
+  unsigned int expected= peer->recv_seq_num;
+  int in_order;
+
+  if (bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL) != 0)
+    return 0;
+  if ((sim != NULL) && sim->sharded)
+    in_order= (sim_shard_seq_check(sim, peer, msg->seq_num,
+				   &expected) == 0);
+  else
+    in_order= (peer->recv_seq_num == msg->seq_num);
+  if (!in_order) {
     if (msg->type != BGP_MSG_TYPE_CLOSE) {
       stream_printf(gdserr, "BGP session sequence number check failed\n");
       stream_printf(gdserr, "  router       = ");
@@ -986,7 +1396,7 @@ static inline int _bgp_peer_seqnum_check(bgp_peer_t * peer,
       bgp_peer_dump_id(gdserr, peer);
       stream_printf(gdserr, "\n");
       stream_printf(gdserr, "  rcvd seq-num = %d\n", msg->seq_num);
-      stream_printf(gdserr, "  exp. seq-num = %d\n", peer->recv_seq_num);
+      stream_printf(gdserr, "  exp. seq-num = %d\n", expected);
       stream_printf(gdserr, "  state        = %s\n",
 		    SESSION_STATES[peer->session_state]);
       stream_printf(gdserr, "  message      = \n    ");
@@ -1012,6 +1422,17 @@ static inline int _bgp_peer_seqnum_check(bgp_peer_t * peer,
  * it here !!!
  */
 int bgp_peer_handle_message(bgp_peer_t * peer, bgp_msg_t * msg)
+{
+  return bgp_peer_handle_message2(peer, msg, NULL);
+}
+
+// ----- bgp_peer_handle_message2 -----------------------------------
+/**
+ * Same as bgp_peer_handle_message, for a message delivered by the
+ * given simulator (which may only handle a shard of the events).
+ */
+int bgp_peer_handle_message2(bgp_peer_t * peer, bgp_msg_t * msg,
+			     simulator_t * sim)
 {
   STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
     stream_printf(gdsdebug, "HANDLE_MESSAGE from ");
@@ -1021,16 +1442,18 @@ int bgp_peer_handle_message(bgp_peer_t * peer, bgp_msg_t * msg)
     stream_printf(gdsdebug, "\n");
   }
 
-  if (_bgp_peer_seqnum_check(peer, msg) < 0)
+  if (_bgp_peer_seqnum_check(peer, msg, sim) < 0)
     return EBGP_PEER_OUT_OF_SEQ;
   peer->recv_seq_num++;
 
   switch (msg->type) {
   case BGP_MSG_TYPE_UPDATE:
+    peer->stats.updates_rcvd++;
     _bgp_peer_session_update_rcvd(peer, (bgp_msg_update_t *) msg);
     break;
 
   case BGP_MSG_TYPE_WITHDRAW:
+    peer->stats.withdraws_rcvd++;
     _bgp_peer_session_withdraw_rcvd(peer, (bgp_msg_withdraw_t *) msg);
     break;
 
@@ -1061,6 +1484,10 @@ int bgp_peer_handle_message(bgp_peer_t * peer, bgp_msg_t * msg)
 static inline int _bgp_peer_send(bgp_peer_t * peer, bgp_msg_t * msg)
 {
   msg->seq_num= peer->send_seq_num++;
+  if (msg->type == BGP_MSG_TYPE_UPDATE)
+    peer->stats.updates_sent++;
+  else if (msg->type == BGP_MSG_TYPE_WITHDRAW)
+    peer->stats.withdraws_sent++;
   
   // Record BGP messages (optional)
   if (peer->pRecordStream != NULL) {
@@ -1175,6 +1602,8 @@ void bgp_peer_show_info(gds_stream_t * stream, bgp_peer_t * peer)
     stream_printf(stream, "flag       : soft-restart\n");
   if (peer->flags & PEER_FLAG_VIRTUAL)
     stream_printf(stream, "flag       : virtual\n");
+  if (peer->flags & PEER_FLAG_RIB_OUT_ELIDE)
+    stream_printf(stream, "flag       : rib-out-elide\n");
   stream_printf(stream, "snd-seq    : %u\n", peer->send_seq_num);
   stream_printf(stream, "rcv-seq    : %u\n", peer->recv_seq_num);
   if (peer->next_hop != NET_ADDR_ANY) {
@@ -1193,19 +1622,29 @@ void bgp_peer_show_info(gds_stream_t * stream, bgp_peer_t * peer)
 }
 
 typedef struct {
-  bgp_peer_t * peer;
-  gds_stream_t * stream;
-} bgp_route_dump_ctx_t;
+  bgp_peer_t    * peer;
+  bgp_rib_dir_t   dir;
+} _bgp_peer_rib_source_t;
 
-// ----- bgp_peer_dump_route ----------------------------------------
-static int bgp_peer_dump_route(uint32_t key, uint8_t key_len,
-			       void * item, void * context)
+// -----[ _bgp_peer_rib_walk ]---------------------------------------
+static int _bgp_peer_rib_walk(void * source, FRadixTreeForEach for_each,
+			      void * ctx)
 {
-  bgp_route_dump_ctx_t * ctx= (bgp_route_dump_ctx_t *) context;
+  _bgp_peer_rib_source_t * rib_source= (_bgp_peer_rib_source_t *) source;
+  return bgp_peer_rib_for_each(rib_source->peer, rib_source->dir,
+			       for_each, ctx);
+}
 
-  route_dump(ctx->stream, (bgp_route_t *) item);
-  stream_printf(ctx->stream, "\n");
-  return 0;
+// -----[ bgp_peer_dump_adjrib_cursor ]------------------------------
+/**
+ * Dump the next page of routes of the Adj-RIB-In/Out (see
+ * bgp/rib_cursor.h).
+ */
+int bgp_peer_dump_adjrib_cursor(gds_stream_t * stream, bgp_peer_t * peer,
+				bgp_rib_dir_t dir, bgp_rib_cursor_t * cursor)
+{
+  _bgp_peer_rib_source_t source= { .peer= peer, .dir= dir };
+  return rib_cursor_dump(stream, cursor, _bgp_peer_rib_walk, &source);
 }
 
 // ----- bgp_peer_dump_adjrib ---------------------------------------
@@ -1221,7 +1660,7 @@ static int bgp_peer_dump_route(uint32_t key, uint8_t key_len,
 void bgp_peer_dump_adjrib(gds_stream_t * stream, bgp_peer_t * peer,
 			  ip_pfx_t prefix, bgp_rib_dir_t dir)
 {
-  bgp_route_dump_ctx_t ctx= { .stream=stream, .peer=peer };
+  bgp_rib_cursor_t cursor;
   bgp_route_t * route;
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   bgp_route_ts * routes;
@@ -1230,7 +1669,8 @@ void bgp_peer_dump_adjrib(gds_stream_t * stream, bgp_peer_t * peer,
 
   // All prefixes
   if (prefix.mask == 0) {
-    rib_for_each(peer->adj_rib[dir], bgp_peer_dump_route, &ctx);
+    rib_cursor_init(&cursor, peer->router, 0, NULL);
+    bgp_peer_dump_adjrib_cursor(stream, peer, dir, &cursor);
     return;
   }
 
@@ -1251,9 +1691,9 @@ void bgp_peer_dump_adjrib(gds_stream_t * stream, bgp_peer_t * peer,
   }
 #else
   if (prefix.mask >= 32) // Single address (best match)
-    route= rib_find_best(peer->adj_rib[dir], prefix);
+    route= bgp_peer_rib_find_best(peer, dir, prefix);
   else // single prefix (exact match)
-    route= rib_find_exact(peer->adj_rib[dir], prefix);
+    route= bgp_peer_rib_find_exact(peer, dir, prefix);
   if (route != NULL) {
     route_dump(stream, route);
     stream_printf(stream, "\n");
@@ -11,9 +11,12 @@
 #ifndef __PEER_H__
 #define __PEER_H__
 
+#include <libgds/radix-tree.h>
 #include <libgds/stream.h>
 
+#include <bgp/rib_cursor.h>
 #include <bgp/types.h>
+#include <sim/simulator.h>
 
 extern char * SESSION_STATES[SESSION_STATE_MAX];
 
@@ -43,6 +46,11 @@ extern char * SESSION_STATES[SESSION_STATE_MAX];
    is initialized to a predefined value (stored in peer->next_hop). */
 #define PEER_FLAG_NEXT_HOP_OV   0x20
 
+/* The Adj-RIB-Out of this peer is elided: only a fingerprint of the
+   routes advertised to the peer is kept
+   (see bgp_peer_set_rib_out_elide). */
+#define PEER_FLAG_RIB_OUT_ELIDE 0x40
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -84,6 +92,8 @@ extern "C" {
   void bgp_peer_session_refresh(bgp_peer_t * peer);
   // ----- peer_open_session ----------------------------------------
   int bgp_peer_open_session(bgp_peer_t * peer);
+  // -----[ bgp_peer_establish_session ]-----------------------------
+  int bgp_peer_establish_session(bgp_peer_t * peer, net_addr_t router_id);
   // ----- peer_close_session ---------------------------------------
   int bgp_peer_close_session(bgp_peer_t * peer);
   // ----- peer_rescan_adjribin -------------------------------------
@@ -99,6 +109,9 @@ extern "C" {
   void bgp_peer_withdraw_prefix(bgp_peer_t * peer, ip_pfx_t prefix);
   // ----- bgp_peer_handle_message ----------------------------------
   int bgp_peer_handle_message(bgp_peer_t * peer, bgp_msg_t * msg);
+  // ----- bgp_peer_handle_message2 ---------------------------------
+  int bgp_peer_handle_message2(bgp_peer_t * peer, bgp_msg_t * msg,
+			       simulator_t * sim);
   
   // ----- bgp_peer_route_eligible ----------------------------------
   int bgp_peer_route_eligible(bgp_peer_t * peer, bgp_route_t * route);
@@ -106,6 +119,37 @@ extern "C" {
   int bgp_peer_route_feasible(bgp_peer_t * peer, bgp_route_t * route);
 
 
+  ///////////////////////////////////////////////////////////////////
+  // ADJ-RIB ACCESS
+  ///////////////////////////////////////////////////////////////////
+
+  // -----[ bgp_peer_rib_find_exact ]--------------------------------
+  bgp_route_t * bgp_peer_rib_find_exact(bgp_peer_t * peer,
+					bgp_rib_dir_t dir,
+					ip_pfx_t prefix);
+  // -----[ bgp_peer_rib_find_best ]---------------------------------
+  bgp_route_t * bgp_peer_rib_find_best(bgp_peer_t * peer,
+				       bgp_rib_dir_t dir,
+				       ip_pfx_t prefix);
+  // -----[ bgp_peer_rib_for_each ]----------------------------------
+  int bgp_peer_rib_for_each(bgp_peer_t * peer, bgp_rib_dir_t dir,
+			    FRadixTreeForEach for_each, void * ctx);
+  // -----[ bgp_peer_rib_replace_route ]-----------------------------
+  int bgp_peer_rib_replace_route(bgp_peer_t * peer, bgp_rib_dir_t dir,
+				 bgp_route_t * route);
+  // -----[ bgp_peer_rib_remove_route ]------------------------------
+  int bgp_peer_rib_remove_route(bgp_peer_t * peer, bgp_rib_dir_t dir,
+				ip_pfx_t prefix);
+  // -----[ bgp_peer_rib_out_mark ]----------------------------------
+  void bgp_peer_rib_out_mark(bgp_peer_t * peer, bgp_route_t * route);
+  // -----[ bgp_peer_rib_out_unmark ]--------------------------------
+  int bgp_peer_rib_out_unmark(bgp_peer_t * peer, ip_pfx_t prefix);
+  // -----[ bgp_peer_rib_out_clear ]---------------------------------
+  void bgp_peer_rib_out_clear(bgp_peer_t * peer);
+  // -----[ bgp_peer_set_rib_out_elide ]-----------------------------
+  int bgp_peer_set_rib_out_elide(bgp_peer_t * peer, int state);
+
+
   ///////////////////////////////////////////////////////////////////
   // INFORMATION RETRIEVAL
   ///////////////////////////////////////////////////////////////////
@@ -119,6 +163,10 @@ extern "C" {
   // ----- bgp_peer_dump_adjrib -------------------------------------
   void bgp_peer_dump_adjrib(gds_stream_t * stream, bgp_peer_t * peer,
 				   ip_pfx_t prefix, bgp_rib_dir_t dir);
+  // -----[ bgp_peer_dump_adjrib_cursor ]----------------------------
+  int bgp_peer_dump_adjrib_cursor(gds_stream_t * stream, bgp_peer_t * peer,
+				  bgp_rib_dir_t dir,
+				  bgp_rib_cursor_t * cursor);
   // ----- bgp_peer_dump_filters ---------------------------------
   void bgp_peer_dump_filters(gds_stream_t * stream, bgp_peer_t * peer,
 			     bgp_filter_dir_t dir);
@@ -0,0 +1,440 @@
+// ==================================================================
+// @(#)reachability.c
+//
+// Network-wide BGP reachability check (see bgp/reachability.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include <libgds/memory.h>
+#include <libgds/trie.h>
+
+#include <net/network.h>
+#include <net/node.h>
+#include <net/protocol.h>
+#include <bgp/as.h>
+#include <bgp/reachability.h>
+#include <bgp/rib.h>
+#include <bgp/route.h>
+#include <bgp/routes_list.h>
+#include <util/slab.h>
+#include <util/thread.h>
+
+// -----[ _reach_ws_t ]----------------------------------------------
+/** Per-thread workspace, sized for the number of routers. */
+typedef struct {
+  int          * next;
+  uint8_t      * states;
+  unsigned int * first;
+  unsigned int * children;
+  unsigned int * queue;
+} _reach_ws_t;
+
+// -----[ _reach_result_t ]------------------------------------------
+/** Sources that can not reach a prefix. */
+typedef struct {
+  unsigned int   num_failed;
+  unsigned int   num_loops;
+  unsigned int * sources;
+} _reach_result_t;
+
+// -----[ _reach_ctx_t ]---------------------------------------------
+typedef struct {
+  network_t        * network;
+  /** BGP routers, sorted by node identifier. */
+  bgp_router_t    ** routers;
+  unsigned int       num_routers;
+  ip_pfx_t         * prefixes;
+  unsigned int       num_prefixes;
+  _reach_result_t  * results;
+  /** Index of the next prefix to check (shared by the threads). */
+  unsigned int       next_prefix;
+} _reach_ctx_t;
+
+#ifdef HAVE_PTHREAD
+typedef struct {
+  _reach_ctx_t * ctx;
+  pthread_t      thread;
+  int            threaded;
+} _reach_thread_t;
+#endif /* HAVE_PTHREAD */
+
+// -----[ _reach_visit ]---------------------------------------------
+/**
+ * Assign a state to the routers whose path leads to one of the
+ * routers already in the queue. The children of a router are the
+ * routers whose next router it is.
+ */
+static inline void _reach_visit(_reach_ws_t * ws, unsigned int head,
+				unsigned int tail, uint8_t state)
+{
+  unsigned int index, child;
+
+  for (; head < tail; head++)
+    for (index= ws->first[ws->queue[head]];
+	 index < ws->first[ws->queue[head]+1]; index++) {
+      child= ws->children[index];
+      ws->states[child]= state;
+      ws->queue[tail++]= child;
+    }
+}
+
+// -----[ _reach_resolve ]-------------------------------------------
+static void _reach_resolve(_reach_ws_t * ws, unsigned int num_routers)
+{
+  unsigned int index, tail;
+
+  // Reverse the next-hop graph (children stored contiguously)
+  for (index= 0; index <= num_routers; index++)
+    ws->first[index]= 0;
+  for (index= 0; index < num_routers; index++)
+    if (ws->next[index] >= 0)
+      ws->first[ws->next[index]+1]++;
+  for (index= 0; index < num_routers; index++)
+    ws->first[index+1]+= ws->first[index];
+  for (index= 0; index < num_routers; index++)
+    if (ws->next[index] >= 0)
+      ws->children[ws->first[ws->next[index]]++]= index;
+  for (index= num_routers; index > 0; index--)
+    ws->first[index]= ws->first[index-1];
+  ws->first[0]= 0;
+
+  // Routers whose path ends at a router that has the next-hop, then
+  // routers whose path ends at a dead end. The remaining routers
+  // lead into a cycle.
+  for (index= 0; index < num_routers; index++)
+    ws->states[index]= BGP_REACH_LOOP;
+  tail= 0;
+  for (index= 0; index < num_routers; index++)
+    if (ws->next[index] == BGP_REACH_NEXT_SELF) {
+      ws->states[index]= BGP_REACH_OK;
+      ws->queue[tail++]= index;
+    }
+  _reach_visit(ws, 0, tail, BGP_REACH_OK);
+  tail= 0;
+  for (index= 0; index < num_routers; index++)
+    if (ws->next[index] == BGP_REACH_NEXT_NONE) {
+      ws->states[index]= BGP_REACH_UNREACH;
+      ws->queue[tail++]= index;
+    }
+  _reach_visit(ws, 0, tail, BGP_REACH_UNREACH);
+}
+
+// -----[ _reach_ws_create ]-----------------------------------------
+static _reach_ws_t * _reach_ws_create(unsigned int num_routers)
+{
+  _reach_ws_t * ws= (_reach_ws_t *) MALLOC(sizeof(_reach_ws_t));
+  ws->next= (int *) MALLOC(num_routers * sizeof(int));
+  ws->states= (uint8_t *) MALLOC(num_routers * sizeof(uint8_t));
+  ws->first= (unsigned int *)
+    MALLOC((num_routers+1) * sizeof(unsigned int));
+  ws->children= (unsigned int *) MALLOC(num_routers * sizeof(unsigned int));
+  ws->queue= (unsigned int *) MALLOC(num_routers * sizeof(unsigned int));
+  return ws;
+}
+
+// -----[ _reach_ws_destroy ]----------------------------------------
+static void _reach_ws_destroy(_reach_ws_t ** ws_ref)
+{
+  _reach_ws_t * ws= *ws_ref;
+  FREE(ws->next);
+  FREE(ws->states);
+  FREE(ws->first);
+  FREE(ws->children);
+  FREE(ws->queue);
+  FREE(ws);
+  *ws_ref= NULL;
+}
+
+// -----[ bgp_reach_resolve ]----------------------------------------
+void bgp_reach_resolve(const int * next, unsigned int num_routers,
+		       uint8_t * states)
+{
+  _reach_ws_t * ws= _reach_ws_create(num_routers);
+  unsigned int index;
+
+  for (index= 0; index < num_routers; index++)
+    ws->next[index]= next[index];
+  _reach_resolve(ws, num_routers);
+  for (index= 0; index < num_routers; index++)
+    states[index]= ws->states[index];
+  _reach_ws_destroy(&ws);
+}
+
+// -----[ _reach_find_router ]---------------------------------------
+/** Return the index of the BGP router with the given identifier. */
+static inline int _reach_find_router(_reach_ctx_t * ctx, net_addr_t addr)
+{
+  unsigned int low= 0, high= ctx->num_routers, middle;
+  net_addr_t rid;
+
+  while (low < high) {
+    middle= (low+high)/2;
+    rid= ctx->routers[middle]->node->rid;
+    if (rid == addr)
+      return middle;
+    if (rid < addr)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  return BGP_REACH_NEXT_NONE;
+}
+
+// -----[ _reach_next ]----------------------------------------------
+/** Index of the next router on the path (see bgp_record_route). */
+static inline int _reach_next(_reach_ctx_t * ctx, bgp_router_t * router,
+			      ip_pfx_t prefix)
+{
+  bgp_route_t * route;
+
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  route= rib_find_one_best(router->loc_rib, prefix);
+#else
+  route= rib_find_best(router->loc_rib, prefix);
+#endif
+  if (route == NULL)
+    return BGP_REACH_NEXT_NONE;
+  if (node_has_address(router->node, route->attr->next_hop))
+    return BGP_REACH_NEXT_SELF;
+  return _reach_find_router(ctx, route->attr->next_hop);
+}
+
+// -----[ _reach_check_prefix ]--------------------------------------
+static void _reach_check_prefix(_reach_ctx_t * ctx, _reach_ws_t * ws,
+				unsigned int prefix_index)
+{
+  _reach_result_t * result= &ctx->results[prefix_index];
+  unsigned int index, num_failed= 0;
+
+  for (index= 0; index < ctx->num_routers; index++)
+    ws->next[index]= _reach_next(ctx, ctx->routers[index],
+				 ctx->prefixes[prefix_index]);
+  _reach_resolve(ws, ctx->num_routers);
+
+  for (index= 0; index < ctx->num_routers; index++)
+    if (ws->states[index] != BGP_REACH_OK)
+      num_failed++;
+  result->num_failed= num_failed;
+  result->num_loops= 0;
+  result->sources= NULL;
+  if (num_failed == 0)
+    return;
+  result->sources= (unsigned int *) MALLOC(num_failed * sizeof(unsigned int));
+  num_failed= 0;
+  for (index= 0; index < ctx->num_routers; index++)
+    if (ws->states[index] != BGP_REACH_OK) {
+      result->sources[num_failed++]= index;
+      if (ws->states[index] == BGP_REACH_LOOP)
+	result->num_loops++;
+    }
+}
+
+// -----[ _reach_run ]-----------------------------------------------
+/** Check prefixes until none is left. */
+static void _reach_run(_reach_ctx_t * ctx)
+{
+  _reach_ws_t * ws= _reach_ws_create(ctx->num_routers);
+  unsigned int index;
+
+  while ((index= THREAD_ADD(ctx->next_prefix, 1) - 1) < ctx->num_prefixes)
+    _reach_check_prefix(ctx, ws, index);
+  _reach_ws_destroy(&ws);
+}
+
+#ifdef HAVE_PTHREAD
+// -----[ _reach_thread ]--------------------------------------------
+static void * _reach_thread(void * arg)
+{
+  _reach_run(((_reach_thread_t *) arg)->ctx);
+  slab_thread_exit();
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+// -----[ _reach_run_all ]-------------------------------------------
+/**
+ * Check all the prefixes. The calling thread takes part in the work.
+ * The routes are only read, so that the threads share the RIBs.
+ */
+static void _reach_run_all(_reach_ctx_t * ctx, unsigned int num_threads)
+{
+#ifdef HAVE_PTHREAD
+  _reach_thread_t * threads;
+  unsigned int index;
+
+  if (num_threads > ctx->num_prefixes)
+    num_threads= ctx->num_prefixes;
+  if (num_threads <= 1) {
+    _reach_run(ctx);
+    return;
+  }
+  threads= (_reach_thread_t *) MALLOC(num_threads * sizeof(_reach_thread_t));
+  thread_set_parallel(1);
+  for (index= 1; index < num_threads; index++) {
+    threads[index].ctx= ctx;
+    threads[index].threaded=
+      (pthread_create(&threads[index].thread, NULL,
+		      _reach_thread, &threads[index]) == 0);
+  }
+  _reach_run(ctx);
+  for (index= 1; index < num_threads; index++)
+    if (threads[index].threaded)
+      pthread_join(threads[index].thread, NULL);
+  thread_set_parallel(0);
+  FREE(threads);
+#else
+  _reach_run(ctx);
+#endif /* HAVE_PTHREAD */
+}
+
+// -----[ _reach_routers_cmp ]---------------------------------------
+static int _reach_routers_cmp(const void * item1, const void * item2)
+{
+  net_addr_t rid1= (*((bgp_router_t **) item1))->node->rid;
+  net_addr_t rid2= (*((bgp_router_t **) item2))->node->rid;
+  return (rid1 < rid2)?-1:((rid1 > rid2)?1:0);
+}
+
+// -----[ _reach_prefixes_cmp ]--------------------------------------
+static int _reach_prefixes_cmp(const void * item1, const void * item2)
+{
+  const ip_pfx_t * prefix1= (const ip_pfx_t *) item1;
+  const ip_pfx_t * prefix2= (const ip_pfx_t *) item2;
+  if (prefix1->network != prefix2->network)
+    return (prefix1->network < prefix2->network)?-1:1;
+  if (prefix1->mask != prefix2->mask)
+    return (prefix1->mask < prefix2->mask)?-1:1;
+  return 0;
+}
+
+// -----[ _reach_count_routers ]-------------------------------------
+static int _reach_count_routers(uint32_t key, uint8_t key_len,
+				void * item, void * context)
+{
+  _reach_ctx_t * ctx= (_reach_ctx_t *) context;
+  net_node_t * node= (net_node_t *) item;
+  net_protocol_t * protocol= protocols_get(node->protocols,
+					   NET_PROTOCOL_BGP);
+  bgp_router_t * router;
+
+  if (protocol == NULL)
+    return 0;
+  router= (bgp_router_t *) protocol->handler;
+  if (ctx->routers != NULL)
+    ctx->routers[ctx->num_routers]= router;
+  ctx->num_prefixes+= bgp_routes_size(router->local_nets);
+  ctx->num_routers++;
+  return 0;
+}
+
+// -----[ _reach_ctx_init ]------------------------------------------
+/**
+ * Collect the BGP routers and the prefixes they originate. A prefix
+ * originated by several routers is only checked once.
+ *
+ * \retval 0 if there is no prefix to check (nothing is allocated).
+ */
+static int _reach_ctx_init(_reach_ctx_t * ctx, network_t * network)
+{
+  unsigned int index, index2, num_prefixes;
+  bgp_routes_t * local_nets;
+
+  ctx->network= network;
+  ctx->routers= NULL;
+  ctx->num_routers= 0;
+  ctx->num_prefixes= 0;
+  ctx->next_prefix= 0;
+  trie_for_each(network->nodes, _reach_count_routers, ctx);
+  if (ctx->num_prefixes == 0)
+    return 0;
+  ctx->routers= (bgp_router_t **)
+    MALLOC(ctx->num_routers * sizeof(bgp_router_t *));
+  ctx->num_routers= 0;
+  ctx->num_prefixes= 0;
+  trie_for_each(network->nodes, _reach_count_routers, ctx);
+  qsort(ctx->routers, ctx->num_routers, sizeof(bgp_router_t *),
+	_reach_routers_cmp);
+
+  ctx->prefixes= (ip_pfx_t *) MALLOC(ctx->num_prefixes * sizeof(ip_pfx_t));
+  num_prefixes= 0;
+  for (index= 0; index < ctx->num_routers; index++) {
+    local_nets= ctx->routers[index]->local_nets;
+    for (index2= 0; index2 < bgp_routes_size(local_nets); index2++)
+      ctx->prefixes[num_prefixes++]= bgp_routes_at(local_nets,
+						   index2)->prefix;
+  }
+  qsort(ctx->prefixes, num_prefixes, sizeof(ip_pfx_t), _reach_prefixes_cmp);
+  ctx->num_prefixes= 0;
+  for (index= 0; index < num_prefixes; index++)
+    if ((ctx->num_prefixes == 0) ||
+	_reach_prefixes_cmp(&ctx->prefixes[ctx->num_prefixes-1],
+			    &ctx->prefixes[index]))
+      ctx->prefixes[ctx->num_prefixes++]= ctx->prefixes[index];
+
+  ctx->results= (_reach_result_t *)
+    MALLOC(ctx->num_prefixes * sizeof(_reach_result_t));
+  return 1;
+}
+
+// -----[ _reach_ctx_destroy ]---------------------------------------
+static void _reach_ctx_destroy(_reach_ctx_t * ctx)
+{
+  unsigned int index;
+
+  for (index= 0; index < ctx->num_prefixes; index++)
+    if (ctx->results[index].sources != NULL)
+      FREE(ctx->results[index].sources);
+  FREE(ctx->results);
+  FREE(ctx->prefixes);
+  FREE(ctx->routers);
+}
+
+// -----[ _reach_report ]--------------------------------------------
+static unsigned long _reach_report(gds_stream_t * stream,
+				   _reach_ctx_t * ctx)
+{
+  unsigned int index, index2;
+  _reach_result_t * result;
+  unsigned long num_failed= 0;
+
+  for (index= 0; index < ctx->num_prefixes; index++) {
+    result= &ctx->results[index];
+    if (result->num_failed == 0)
+      continue;
+    num_failed+= result->num_failed;
+    stream_printf(stream, "Assert: ");
+    ip_prefix_dump(stream, ctx->prefixes[index]);
+    stream_printf(stream, " can not be reached from %u router(s)"
+		  " (%u in a loop)\n", result->num_failed, result->num_loops);
+    for (index2= 0; index2 < result->num_failed; index2++) {
+      stream_printf(stream, "\t");
+      bgp_router_dump_id(stream, ctx->routers[result->sources[index2]]);
+      stream_printf(stream, "\n");
+    }
+  }
+  return num_failed;
+}
+
+// -----[ bgp_reach_check ]------------------------------------------
+unsigned long bgp_reach_check(gds_stream_t * stream, network_t * network,
+			      unsigned int num_threads)
+{
+  _reach_ctx_t ctx;
+  unsigned long num_failed;
+
+  if (!_reach_ctx_init(&ctx, network))
+    return 0;
+  _reach_run_all(&ctx, num_threads);
+  num_failed= _reach_report(stream, &ctx);
+  _reach_ctx_destroy(&ctx);
+  return num_failed;
+}
@@ -0,0 +1,72 @@
+// ==================================================================
+// @(#)reachability.h
+//
+// Network-wide BGP reachability check. For each prefix originated by
+// a BGP router, the next-hop graph of the best routes is built once
+// across all the routers. As each router has at most one best route,
+// every router points to at most one next router. The state of all
+// the sources (reachable, unreachable or caught in a loop) is then
+// resolved in a single traversal of the reversed graph, instead of
+// following the path from each source (see bgp/record-route.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_REACHABILITY_H__
+#define __BGP_REACHABILITY_H__
+
+#include <stdint.h>
+
+#include <libgds/stream.h>
+
+#include <net/net_types.h>
+
+// -----[ bgp_reach_state_t ]----------------------------------------
+typedef enum {
+  BGP_REACH_OK,
+  /** The path ends in a router without route or with an unknown
+      next-hop. */
+  BGP_REACH_UNREACH,
+  /** The path enters a forwarding loop. */
+  BGP_REACH_LOOP,
+} bgp_reach_state_t;
+
+/** The router has the next-hop of its best route (end of path). */
+#define BGP_REACH_NEXT_SELF -1
+/** The router has no route or its next-hop is not a BGP router. */
+#define BGP_REACH_NEXT_NONE -2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bgp_reach_resolve ]--------------------------------------
+  /**
+   * Resolve the state of each router given the index of its next
+   * router (or BGP_REACH_NEXT_SELF / BGP_REACH_NEXT_NONE). This runs
+   * in linear time in the number of routers.
+   */
+  void bgp_reach_resolve(const int * next, unsigned int num_routers,
+			 uint8_t * states);
+  // -----[ bgp_reach_check ]----------------------------------------
+  /**
+   * Check that all the prefixes originated by the BGP routers of a
+   * network are reachable from all the BGP routers. The sources
+   * that can not reach a prefix are reported in bulk for each
+   * prefix.
+   *
+   * \param num_threads is the number of threads the prefixes are
+   *   spread onto. Without thread support, the prefixes are checked
+   *   in the calling thread.
+   * \retval the number of (source, prefix) pairs that failed.
+   */
+  unsigned long bgp_reach_check(gds_stream_t * stream, network_t * network,
+				unsigned int num_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_REACHABILITY_H__ */
@@ -0,0 +1,306 @@
+// ==================================================================
+// @(#)rib_cursor.c
+//
+// Cursors over the routes of a RIB (see bgp/rib_cursor.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include <libgds/memory.h>
+
+#include <bgp/filter/filter.h>
+#include <bgp/rib.h>
+#include <bgp/rib_cursor.h>
+#include <bgp/route.h>
+
+#define RIB_DUMP_BUF_SIZE 16384
+
+typedef struct {
+  bgp_rib_cursor_t  * cursor;
+  /** Max-heap of the selected routes (largest prefix at the root). */
+  bgp_route_t      ** routes;
+  unsigned int        num_routes;
+  FRadixTreeForEach   for_each;
+  void              * ctx;
+} _rib_cursor_ctx_t;
+
+typedef struct {
+  gds_stream_t * stream;
+  size_t         len;
+  char           data[RIB_DUMP_BUF_SIZE];
+} _rib_dump_buf_t;
+
+// -----[ _rib_cursor_cmp ]------------------------------------------
+/** Prefix order: by network, then by prefix length. */
+static inline int _rib_cursor_cmp(const ip_pfx_t * prefix1,
+				  const ip_pfx_t * prefix2)
+{
+  if (prefix1->network < prefix2->network)
+    return -1;
+  if (prefix1->network > prefix2->network)
+    return 1;
+  if (prefix1->mask < prefix2->mask)
+    return -1;
+  if (prefix1->mask > prefix2->mask)
+    return 1;
+  return 0;
+}
+
+// -----[ _rib_cursor_routes_cmp ]-----------------------------------
+static int _rib_cursor_routes_cmp(const void * item1, const void * item2)
+{
+  return _rib_cursor_cmp(&(*((bgp_route_t **) item1))->prefix,
+			 &(*((bgp_route_t **) item2))->prefix);
+}
+
+// -----[ _rib_cursor_match ]----------------------------------------
+static inline int _rib_cursor_match(bgp_rib_cursor_t * cursor,
+				    bgp_route_t * route)
+{
+  if (cursor->has_after &&
+      (_rib_cursor_cmp(&route->prefix, &cursor->after) <= 0))
+    return 0;
+  if ((cursor->matcher != NULL) &&
+      !filter_matcher_apply(cursor->matcher, cursor->router, route))
+    return 0;
+  return 1;
+}
+
+// -----[ _rib_cursor_sift_down ]------------------------------------
+static inline void _rib_cursor_sift_down(_rib_cursor_ctx_t * ctx)
+{
+  unsigned int index= 0, child;
+  bgp_route_t * route;
+
+  while ((child= 2*index+1) < ctx->num_routes) {
+    if ((child+1 < ctx->num_routes) &&
+	(_rib_cursor_cmp(&ctx->routes[child+1]->prefix,
+			 &ctx->routes[child]->prefix) > 0))
+      child++;
+    if (_rib_cursor_cmp(&ctx->routes[child]->prefix,
+			&ctx->routes[index]->prefix) <= 0)
+      break;
+    route= ctx->routes[index];
+    ctx->routes[index]= ctx->routes[child];
+    ctx->routes[child]= route;
+    index= child;
+  }
+}
+
+// -----[ _rib_cursor_sift_up ]--------------------------------------
+static inline void _rib_cursor_sift_up(_rib_cursor_ctx_t * ctx)
+{
+  unsigned int index= ctx->num_routes-1, parent;
+  bgp_route_t * route;
+
+  while (index > 0) {
+    parent= (index-1)/2;
+    if (_rib_cursor_cmp(&ctx->routes[parent]->prefix,
+			&ctx->routes[index]->prefix) >= 0)
+      break;
+    route= ctx->routes[index];
+    ctx->routes[index]= ctx->routes[parent];
+    ctx->routes[parent]= route;
+    index= parent;
+  }
+}
+
+// -----[ _rib_cursor_stream ]---------------------------------------
+/** Without limit, the matching routes are passed on directly. */
+static int _rib_cursor_stream(uint32_t key, uint8_t key_len,
+			      void * item, void * context)
+{
+  _rib_cursor_ctx_t * ctx= (_rib_cursor_ctx_t *) context;
+
+  if (!_rib_cursor_match(ctx->cursor, (bgp_route_t *) item))
+    return 0;
+  return ctx->for_each(key, key_len, item, ctx->ctx);
+}
+
+// -----[ _rib_cursor_select ]---------------------------------------
+/** Keep the 'limit' smallest matching routes. */
+static int _rib_cursor_select(uint32_t key, uint8_t key_len,
+			      void * item, void * context)
+{
+  _rib_cursor_ctx_t * ctx= (_rib_cursor_ctx_t *) context;
+  bgp_route_t * route= (bgp_route_t *) item;
+
+  if (!_rib_cursor_match(ctx->cursor, route))
+    return 0;
+
+  if (ctx->num_routes < ctx->cursor->limit) {
+    ctx->routes[ctx->num_routes++]= route;
+    _rib_cursor_sift_up(ctx);
+    return 0;
+  }
+
+  ctx->cursor->more= 1;
+  if (_rib_cursor_cmp(&route->prefix, &ctx->routes[0]->prefix) < 0) {
+    ctx->routes[0]= route;
+    _rib_cursor_sift_down(ctx);
+  }
+  return 0;
+}
+
+// -----[ rib_cursor_init ]------------------------------------------
+/**
+ * Initialize a cursor positioned before the first route.
+ *
+ * \param limit is the maximum number of routes per page (0 means
+ *   no limit).
+ * \param matcher is an optional predicate. It is evaluated in the
+ *   context of the router (can be NULL).
+ */
+void rib_cursor_init(bgp_rib_cursor_t * cursor, bgp_router_t * router,
+		     unsigned int limit, bgp_ft_matcher_t * matcher)
+{
+  cursor->has_after= 0;
+  cursor->limit= limit;
+  cursor->matcher= matcher;
+  cursor->router= router;
+  cursor->more= 0;
+}
+
+// -----[ rib_cursor_walk ]------------------------------------------
+/**
+ * Call a function for each route of the next page. The routes are
+ * enumerated by the 'walk' function (e.g. rib_for_each). With a
+ * limit, the routes are passed on in prefix order and the cursor is
+ * moved after the last one. Without limit, the routes are passed on
+ * in the order of the walk.
+ *
+ * The routes must not be changed between two pages.
+ */
+int rib_cursor_walk(bgp_rib_cursor_t * cursor, rib_cursor_walk_f walk,
+		    void * source, FRadixTreeForEach for_each, void * ctx)
+{
+  _rib_cursor_ctx_t cursor_ctx= {
+    .cursor    = cursor,
+    .routes    = NULL,
+    .num_routes= 0,
+    .for_each  = for_each,
+    .ctx       = ctx,
+  };
+  unsigned int index;
+  bgp_route_t * route;
+  int result= 0;
+
+  cursor->more= 0;
+  if (cursor->limit == 0)
+    return walk(source, _rib_cursor_stream, &cursor_ctx);
+
+  cursor_ctx.routes= (bgp_route_t **)
+    MALLOC(cursor->limit * sizeof(bgp_route_t *));
+  result= walk(source, _rib_cursor_select, &cursor_ctx);
+  if (result == 0) {
+    qsort(cursor_ctx.routes, cursor_ctx.num_routes, sizeof(bgp_route_t *),
+	  _rib_cursor_routes_cmp);
+    for (index= 0; index < cursor_ctx.num_routes; index++) {
+      route= cursor_ctx.routes[index];
+      result= for_each(route->prefix.network, route->prefix.mask,
+		       route, ctx);
+      if (result != 0)
+	break;
+    }
+    if (cursor_ctx.num_routes > 0) {
+      cursor->after= cursor_ctx.routes[cursor_ctx.num_routes-1]->prefix;
+      cursor->has_after= 1;
+    }
+  }
+  FREE(cursor_ctx.routes);
+  return result;
+}
+
+// -----[ _rib_cursor_rib_walk ]-------------------------------------
+static int _rib_cursor_rib_walk(void * source, FRadixTreeForEach for_each,
+				void * ctx)
+{
+  return rib_for_each((bgp_rib_t *) source, for_each, ctx);
+}
+
+// -----[ rib_cursor_for_each ]--------------------------------------
+/**
+ * Call a function for each route of the next page of a RIB (see
+ * rib_cursor_walk).
+ */
+int rib_cursor_for_each(bgp_rib_t * rib, bgp_rib_cursor_t * cursor,
+			FRadixTreeForEach for_each, void * ctx)
+{
+  return rib_cursor_walk(cursor, _rib_cursor_rib_walk, rib, for_each, ctx);
+}
+
+// -----[ _rib_dump_buf_flush ]--------------------------------------
+static inline void _rib_dump_buf_flush(_rib_dump_buf_t * buf)
+{
+  if (buf->len == 0)
+    return;
+  buf->data[buf->len]= '\0';
+  stream_printf(buf->stream, "%s", buf->data);
+  buf->len= 0;
+}
+
+// -----[ _rib_dump_route ]------------------------------------------
+/**
+ * Format a route in the buffer. The routes that can not be written
+ * to a string (see route_to_string) are dumped directly.
+ */
+static int _rib_dump_route(uint32_t key, uint8_t key_len,
+			   void * item, void * ctx)
+{
+  _rib_dump_buf_t * buf= (_rib_dump_buf_t *) ctx;
+  bgp_route_t * route= (bgp_route_t *) item;
+  int written;
+
+  // Keep room for the end-of-line and the terminating '\0'
+  written= route_to_string(route, buf->data+buf->len,
+			   RIB_DUMP_BUF_SIZE-buf->len-1);
+  if ((written < 0) && (buf->len > 0)) {
+    _rib_dump_buf_flush(buf);
+    written= route_to_string(route, buf->data, RIB_DUMP_BUF_SIZE-1);
+  }
+  if (written < 0) {
+    route_dump(buf->stream, route);
+    stream_printf(buf->stream, "\n");
+    return 0;
+  }
+  buf->len+= written;
+  buf->data[buf->len++]= '\n';
+  return 0;
+}
+
+// -----[ rib_cursor_dump ]------------------------------------------
+/**
+ * Dump the routes of the next page (see rib_cursor_walk). The
+ * routes are formatted in a buffer which is written to the stream
+ * when it is full.
+ */
+int rib_cursor_dump(gds_stream_t * stream, bgp_rib_cursor_t * cursor,
+		    rib_cursor_walk_f walk, void * source)
+{
+  _rib_dump_buf_t * buf=
+    (_rib_dump_buf_t *) MALLOC(sizeof(_rib_dump_buf_t));
+  int result;
+
+  buf->stream= stream;
+  buf->len= 0;
+  result= rib_cursor_walk(cursor, walk, source, _rib_dump_route, buf);
+  _rib_dump_buf_flush(buf);
+  FREE(buf);
+  stream_flush(stream);
+  return result;
+}
+
+// -----[ rib_cursor_dump_rib ]--------------------------------------
+int rib_cursor_dump_rib(gds_stream_t * stream, bgp_rib_t * rib,
+			bgp_rib_cursor_t * cursor)
+{
+  return rib_cursor_dump(stream, cursor, _rib_cursor_rib_walk, rib);
+}
@@ -0,0 +1,70 @@
+// ==================================================================
+// @(#)rib_cursor.h
+//
+// Cursors over the routes of a RIB. A cursor returns the routes in
+// prefix order, after a given prefix, by pages of limited size and
+// optionally filtered by a predicate (see
+// bgp/filter/predicate_parser.h). The next page is obtained by
+// calling the function again with the same cursor.
+//
+// No copy of the RIB is built: each page only requires one walk
+// through the RIB and keeps at most 'limit' routes.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_RIB_CURSOR_H__
+#define __BGP_RIB_CURSOR_H__
+
+#include <libgds/stream.h>
+
+#include <bgp/filter/types.h>
+#include <bgp/types.h>
+#include <net/prefix.h>
+
+// -----[ bgp_rib_cursor_t ]-----------------------------------------
+typedef struct {
+  /** Only routes towards prefixes after 'after' are returned. */
+  ip_pfx_t           after;
+  int                has_after;
+  /** Maximum number of routes per page (0 means no limit). */
+  unsigned int       limit;
+  /** Optional predicate (not owned by the cursor). */
+  bgp_ft_matcher_t * matcher;
+  bgp_router_t     * router;
+  /** Set when routes remain after the current page. */
+  int                more;
+} bgp_rib_cursor_t;
+
+// -----[ rib_cursor_walk_f ]----------------------------------------
+/** Function that enumerates routes (e.g. rib_for_each). */
+typedef int (*rib_cursor_walk_f)(void * source, FRadixTreeForEach for_each,
+				 void * ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ rib_cursor_init ]----------------------------------------
+  void rib_cursor_init(bgp_rib_cursor_t * cursor, bgp_router_t * router,
+		       unsigned int limit, bgp_ft_matcher_t * matcher);
+  // -----[ rib_cursor_walk ]----------------------------------------
+  int rib_cursor_walk(bgp_rib_cursor_t * cursor, rib_cursor_walk_f walk,
+		      void * source, FRadixTreeForEach for_each, void * ctx);
+  // -----[ rib_cursor_for_each ]------------------------------------
+  int rib_cursor_for_each(bgp_rib_t * rib, bgp_rib_cursor_t * cursor,
+			  FRadixTreeForEach for_each, void * ctx);
+  // -----[ rib_cursor_dump ]----------------------------------------
+  int rib_cursor_dump(gds_stream_t * stream, bgp_rib_cursor_t * cursor,
+		      rib_cursor_walk_f walk, void * source);
+  // -----[ rib_cursor_dump_rib ]------------------------------------
+  int rib_cursor_dump_rib(gds_stream_t * stream, bgp_rib_t * rib,
+			  bgp_rib_cursor_t * cursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_RIB_CURSOR_H__ */
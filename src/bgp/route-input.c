@@ -17,6 +17,7 @@
 #include <bgp/cisco.h>
 #include <bgp/mrtd.h>
 #include <bgp/route-input.h>
+#include <bgp/route_stream.h>
 #include <bgp/routes_list.h>
 
 static char * INPUT_TYPE_STR[BGP_ROUTES_INPUT_MAX]=
@@ -25,7 +26,8 @@ static char * INPUT_TYPE_STR[BGP_ROUTES_INPUT_MAX]=
 #ifdef HAVE_LIBBGPDUMP
   "mrt-binary",
 #endif /* HAVE_LIBBGPDUMP */
-  "cisco"
+  "cisco",
+  "binary",
 };
 
 // -----[ bgp_routes_str2format ]------------------------------------
@@ -57,6 +59,8 @@ int bgp_routes_load(const char * filename, bgp_input_type_t format,
   case BGP_ROUTES_INPUT_CISCO:
     cbgp_fatal("cisco input format is not supported");
     return -1;//cisco_load(filename, handler, ctx);
+  case BGP_ROUTES_INPUT_BINARY:
+    return route_stream_load(filename, handler, ctx);
   default:
     cbgp_fatal("invalid input format");
   }
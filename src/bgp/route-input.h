@@ -19,6 +19,7 @@ typedef enum {
   BGP_ROUTES_INPUT_MRT_BIN,
 #endif /* HAVE_LIBBGPDUMP */
   BGP_ROUTES_INPUT_CISCO,
+  BGP_ROUTES_INPUT_BINARY,
   BGP_ROUTES_INPUT_MAX
 } bgp_input_type_t;
 
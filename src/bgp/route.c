@@ -11,6 +11,7 @@
 #endif
 
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <libgds/array.h>
@@ -23,6 +24,7 @@
 #include <bgp/attr/origin.h>
 #include <bgp/qos.h>
 #include <bgp/route.h>
+#include <util/slab.h>
 #include <util/str_format.h>
 
 typedef struct _options_t {
@@ -34,6 +36,8 @@ static _options_t _default_options= {
   .show_format= NULL,
 };
 
+SLAB_CACHE(_route_cache, "bgp-route", bgp_route_t, MEM_ACCT_BGP_ROUTES);
+
 // -----[ Forward prototypes declaration ]---------------------------
 /* Note: functions starting with underscore (_) are intended to be
  * used inside this file only (private). These functions should be
@@ -67,7 +71,7 @@ bgp_route_t * route_create(ip_pfx_t prefix, bgp_peer_t * peer,
 static inline bgp_route_t *
 _route_create2(ip_pfx_t prefix, bgp_peer_t * peer, bgp_attr_t * attr)
 {
-  bgp_route_t * route= (bgp_route_t *) MALLOC(sizeof(bgp_route_t));
+  bgp_route_t * route= (bgp_route_t *) slab_alloc(&_route_cache);
   route->prefix= prefix;
   route->peer= peer;
   route->attr= attr;
@@ -134,7 +138,7 @@ void route_destroy(bgp_route_t ** route_ref)
 
     bgp_attr_destroy(&(*route_ref)->attr);
 
-    FREE(*route_ref);
+    slab_free(&_route_cache, *route_ref);
     *route_ref= NULL;
   }
 }
@@ -685,61 +689,98 @@ void route_dump(gds_stream_t * stream, bgp_route_t * route)
   }
 }
 
-// ----- route_dump_cisco -------------------------------------------
+// -----[ _route_to_string_cisco ]-----------------------------------
 /**
- * CISCO-like dump of routes.
+ * CISCO-like formatting of a route in a string (without the router
+ * list). Return the number of characters written, or -1 if the
+ * string is too short.
  */
-void route_dump_cisco(gds_stream_t * stream, bgp_route_t * route)
+static int _route_to_string_cisco(bgp_route_t * route,
+				  char * str, size_t size)
 {
-  if (route != NULL) {
-
-    // Status code:
-    // '*' - valid (feasible)
-    // 'i' - internal (learned through 'add network')
-    if (route_flag_get(route, ROUTE_FLAG_INTERNAL))
-      stream_printf(stream, "i");
-    else if (route_flag_get(route, ROUTE_FLAG_FEASIBLE))
-      stream_printf(stream, "*");
-    else
-      stream_printf(stream, " ");
+  size_t initial_size= size;
+  int written;
+  char status, best, origin;
+
+  // Status code:
+  // '*' - valid (feasible)
+  // 'i' - internal (learned through 'add network')
+  if (route_flag_get(route, ROUTE_FLAG_INTERNAL))
+    status= 'i';
+  else if (route_flag_get(route, ROUTE_FLAG_FEASIBLE))
+    status= '*';
+  else
+    status= ' ';
+  best= (route_flag_get(route, ROUTE_FLAG_BEST)?'>':' ');
+  switch (route->attr->origin) {
+  case BGP_ORIGIN_IGP: origin= 'i'; break;
+  case BGP_ORIGIN_EGP: origin= 'e'; break;
+  case BGP_ORIGIN_INCOMPLETE: origin= '?'; break;
+  default:
+    cbgp_fatal("invalid BGP origin attribute (%d)", route->attr->origin);
+  }
 
-    // Best ?
-    if (route_flag_get(route, ROUTE_FLAG_BEST))
-      stream_printf(stream, ">");
-    else
-      stream_printf(stream, " ");
+  // Status, prefix, next-hop, local-pref and MED
+  written= snprintf(str, size, "%c%c %u.%u.%u.%u/%u\t%u.%u.%u.%u\t%u\t%u\t",
+		    status, best,
+		    route->prefix.network >> 24,
+		    (route->prefix.network >> 16) & 255,
+		    (route->prefix.network >> 8) & 255,
+		    route->prefix.network & 255,
+		    route->prefix.mask,
+		    route->attr->next_hop >> 24,
+		    (route->attr->next_hop >> 16) & 255,
+		    (route->attr->next_hop >> 8) & 255,
+		    route->attr->next_hop & 255,
+		    route->attr->local_pref, route->attr->med);
+  if ((written < 0) || (written >= size))
+    return -1;
+  str+= written;
+  size-= written;
 
-    stream_printf(stream, " ");
+  // AS-Path
+  if (route->attr->path_ref != NULL)
+    written= path_to_string(route->attr->path_ref, 1, str, size);
+  else
+    written= snprintf(str, size, "null");
+  if ((written < 0) || (written >= size))
+    return -1;
+  str+= written;
+  size-= written;
 
-    // Prefix
-    ip_prefix_dump(stream, route->prefix);
+  // Origin
+  written= snprintf(str, size, "\t%c", origin);
+  if ((written < 0) || (written >= size))
+    return -1;
+  size-= written;
+  return initial_size - size;
+}
 
-    // Next-Hop
-    stream_printf(stream, "\t");
-    ip_address_dump(stream, route->attr->next_hop);
+// ----- route_dump_cisco -------------------------------------------
+/**
+ * CISCO-like dump of routes (see _route_to_string_cisco).
+ */
+void route_dump_cisco(gds_stream_t * stream, bgp_route_t * route)
+{
+  char buf[256], * str= buf;
+  size_t size= sizeof(buf);
 
-    // Local-Pref & Multi-Exit-Distriminator
-    stream_printf(stream, "\t%u\t%u\t", route->attr->local_pref,
-	       route->attr->med);
+  if (route == NULL) {
+    stream_printf(stream, "(null)");
+    return;
+  }
 
-    // AS-Path
-    if (route->attr->path_ref != NULL)
-      path_dump(stream, route->attr->path_ref, 1);
+  // Enlarge the string until the route fits (long AS-Paths)
+  while (_route_to_string_cisco(route, str, size) < 0) {
+    size*= 2;
+    if (str == buf)
+      str= (char *) MALLOC(size);
     else
-      stream_printf(stream, "null");
-
-    // Origin
-    stream_printf(stream, "\t");
-    switch (route->attr->origin) {
-    case BGP_ORIGIN_IGP: stream_printf(stream, "i"); break;
-    case BGP_ORIGIN_EGP: stream_printf(stream, "e"); break;
-    case BGP_ORIGIN_INCOMPLETE: stream_printf(stream, "?"); break;
-    default:
-      cbgp_fatal("invalid BGP origin attribute (%d)", route->attr->origin);
-    }
-
-  } else
-    stream_printf(stream, "(null)");
+      str= (char *) REALLOC(str, size);
+  }
+  stream_printf(stream, "%s", str);
+  if (str != buf)
+    FREE(str);
 
 #ifdef __ROUTER_LIST_ENABLE__
   if (route->attr->router_list != NULL) {
@@ -750,6 +791,28 @@ void route_dump_cisco(gds_stream_t * stream, bgp_route_t * route)
 #endif
 }
 
+// -----[ route_to_string ]------------------------------------------
+/**
+ * Write a route to a string, in the same way as route_dump. This is
+ * used to dump large RIBs with few calls to the output stream. Only
+ * the CISCO-like output mode is supported.
+ *
+ * Return value:
+ *   the number of characters written, or
+ *   -1 if the string is too short or the output mode is not
+ *   supported (route_dump must then be used).
+ */
+int route_to_string(bgp_route_t * route, char * str, size_t size)
+{
+#ifdef __ROUTER_LIST_ENABLE__
+  return -1;
+#endif
+  if ((_default_options.show_mode != BGP_ROUTES_OUTPUT_CISCO) ||
+      (route == NULL))
+    return -1;
+  return _route_to_string_cisco(route, str, size);
+}
+
 // ----- route_dump_mrt --------------------------------------------
 /**
  * Dump a route in MRTD format. The output has thus the following
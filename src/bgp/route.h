@@ -187,6 +187,8 @@ extern "C" {
   // ----- route_dump_custom ----------------------------------------
   void route_dump_custom(gds_stream_t * stream, bgp_route_t * route,
 			 const char * format);
+  // -----[ route_to_string ]----------------------------------------
+  int route_to_string(bgp_route_t * route, char * str, size_t size);
 
 
   ///////////////////////////////////////////////////////////////////
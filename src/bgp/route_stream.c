@@ -0,0 +1,206 @@
+// ==================================================================
+// @(#)route_stream.c
+//
+// Compact binary stream of BGP routes (see bgp/route_stream.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libgds/types.h>
+
+#include <bgp/attr/comm.h>
+#include <bgp/attr/path.h>
+#include <bgp/attr/path_segment.h>
+#include <bgp/route.h>
+#include <bgp/route_stream.h>
+
+// -----[ _put8 / _put16 / _put32 ]----------------------------------
+static inline uint8_t * _put8(uint8_t * buf, uint8_t value)
+{
+  *buf= value;
+  return buf+1;
+}
+static inline uint8_t * _put16(uint8_t * buf, uint16_t value)
+{
+  value= htons(value);
+  memcpy(buf, &value, sizeof(value));
+  return buf+sizeof(value);
+}
+static inline uint8_t * _put32(uint8_t * buf, uint32_t value)
+{
+  value= htonl(value);
+  memcpy(buf, &value, sizeof(value));
+  return buf+sizeof(value);
+}
+
+// -----[ _get16 / _get32 ]------------------------------------------
+static inline uint16_t _get16(const uint8_t * buf)
+{
+  uint16_t value;
+  memcpy(&value, buf, sizeof(value));
+  return ntohs(value);
+}
+static inline uint32_t _get32(const uint8_t * buf)
+{
+  uint32_t value;
+  memcpy(&value, buf, sizeof(value));
+  return ntohl(value);
+}
+
+// -----[ route_stream_encode ]--------------------------------------
+int route_stream_encode(bgp_route_t * route, net_addr_t peer_addr,
+			asn_t peer_asn, uint8_t * buf, size_t size)
+{
+  bgp_path_t * path= route->attr->path_ref;
+  bgp_comms_t * comms= route->attr->comms;
+  unsigned int num_segs= (path != NULL)?path_num_segments(path):0;
+  unsigned int num_comms= (comms != NULL)?comms->num:0;
+  bgp_path_seg_t * seg= NULL;
+  unsigned int index, index2;
+  size_t len= 30 + num_comms*4;
+  uint8_t * ptr;
+
+  while ((seg= path_segment_next(path, seg)) != NULL)
+    len+= 2 + seg->length*4;
+  if ((len > size) || (len-2 > MAX_UINT16_T) || (num_segs > 255))
+    return -1;
+
+  ptr= _put16(buf, len-2);
+  ptr= _put32(ptr, peer_addr);
+  ptr= _put32(ptr, peer_asn);
+  ptr= _put32(ptr, route->prefix.network);
+  ptr= _put8(ptr, route->prefix.mask);
+  ptr= _put8(ptr, route->attr->origin);
+  ptr= _put32(ptr, route->attr->next_hop);
+  ptr= _put32(ptr, route->attr->local_pref);
+  ptr= _put32(ptr, route->attr->med);
+  ptr= _put8(ptr, num_segs);
+  while ((seg= path_segment_next(path, seg)) != NULL) {
+    ptr= _put8(ptr, seg->type);
+    ptr= _put8(ptr, seg->length);
+    for (index2= 0; index2 < seg->length; index2++)
+      ptr= _put32(ptr, seg->asns[index2]);
+  }
+  ptr= _put8(ptr, num_comms);
+  for (index= 0; index < num_comms; index++)
+    ptr= _put32(ptr, comms->values[index]);
+  return len;
+}
+
+// -----[ route_stream_decode ]--------------------------------------
+int route_stream_decode(const uint8_t * buf, size_t size,
+			net_addr_t * peer_addr, asn_t * peer_asn,
+			bgp_route_t ** route_ref)
+{
+  const uint8_t * end= buf+size;
+  bgp_path_t * path;
+  bgp_path_seg_t * seg;
+  bgp_comms_t * comms= NULL;
+  ip_pfx_t prefix;
+  bgp_route_t * route;
+  unsigned int num_segs, num_comms, index, index2;
+
+  if (size < 28)
+    return -1;
+  *peer_addr= _get32(buf);
+  *peer_asn= _get32(buf+4);
+  prefix.network= _get32(buf+8);
+  prefix.mask= buf[12];
+  if ((prefix.mask > 32) || (buf[13] >= BGP_ORIGIN_MAX))
+    return -1;
+  route= route_create(prefix, NULL, _get32(buf+14), buf[13]);
+  route_localpref_set(route, _get32(buf+18));
+  route_med_set(route, _get32(buf+22));
+  num_segs= buf[26];
+  buf+= 27;
+
+  // Unknown segment types are rejected
+  path= path_create();
+  for (index= 0; index < num_segs; index++) {
+    if ((buf+2 > end) || (buf+2+buf[1]*4 > end) ||
+	(buf[0] < AS_PATH_SEGMENT_SET) ||
+	(buf[0] > AS_PATH_SEGMENT_CONFED_SEQUENCE))
+      break;
+    seg= path_segment_create(buf[0], buf[1]);
+    for (index2= 0; index2 < seg->length; index2++)
+      seg->asns[index2]= _get32(buf+2+index2*4);
+    buf+= 2+seg->length*4;
+    path_add_segment(&path, seg);
+  }
+  route_set_path(route, path);
+  if ((index < num_segs) || (buf+1 > end) || (buf+1+buf[0]*4 > end)) {
+    route_destroy(&route);
+    return -1;
+  }
+
+  num_comms= buf[0];
+  buf++;
+  if (num_comms > 0) {
+    comms= comms_create();
+    for (index= 0; index < num_comms; index++)
+      comms_add(&comms, _get32(buf+index*4));
+  }
+  route_set_comm(route, comms);
+
+  route_flag_set(route, ROUTE_FLAG_BEST, 1);
+  route_flag_set(route, ROUTE_FLAG_ELIGIBLE, 1);
+  route_flag_set(route, ROUTE_FLAG_FEASIBLE, 1);
+  *route_ref= route;
+  return 0;
+}
+
+// -----[ route_stream_load ]----------------------------------------
+int route_stream_load(const char * filename, bgp_route_handler_f handler,
+		      void * ctx)
+{
+  FILE * file;
+  uint8_t buf[ROUTE_STREAM_MAX_RECORD];
+  unsigned long num_records= 0;
+  bgp_route_t * route;
+  net_addr_t peer_addr;
+  asn_t peer_asn;
+  int error= BGP_INPUT_SUCCESS;
+  uint16_t len;
+
+  if ((filename == NULL) || !strcmp(filename, "-"))
+    file= stdin;
+  else
+    file= fopen(filename, "rb");
+  if (file == NULL)
+    return BGP_INPUT_ERROR_FILE_OPEN;
+
+  if ((fread(buf, ROUTE_STREAM_MAGIC_SIZE, 1, file) != 1) ||
+      memcmp(buf, ROUTE_STREAM_MAGIC, ROUTE_STREAM_MAGIC_SIZE)) {
+    bgp_input_set_user_error("not a binary route stream");
+    error= BGP_INPUT_ERROR_USER;
+  }
+
+  while (error == BGP_INPUT_SUCCESS) {
+    if (fread(buf, 2, 1, file) != 1)
+      break;
+    len= _get16(buf);
+    num_records++;
+    if ((fread(buf, len, 1, file) != 1) ||
+	(route_stream_decode(buf, len, &peer_addr, &peer_asn, &route) < 0)) {
+      bgp_input_set_user_error("malformed record %lu", num_records);
+      error= BGP_INPUT_ERROR_USER;
+      break;
+    }
+    if (handler(BGP_INPUT_STATUS_OK, route, peer_addr, peer_asn, ctx) != 0)
+      error= BGP_INPUT_ERROR_UNEXPECTED;
+  }
+
+  if (file != stdin)
+    fclose(file);
+  return error;
+}
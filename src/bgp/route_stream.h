@@ -0,0 +1,66 @@
+// ==================================================================
+// @(#)route_stream.h
+//
+// Compact binary stream of BGP routes. The stream starts with an
+// 8-bytes magic header and is followed by one record per route. Each
+// record is prefixed by its length, which makes it possible to skip
+// records quickly. All the fields are in network byte order.
+//
+//   record := length(2) peer-addr(4) peer-asn(4) prefix(4) mask(1)
+//             origin(1) next-hop(4) local-pref(4) med(4)
+//             num-segs(1) { type(1) length(1) asn(4)* }*
+//             num-comms(1) comm(4)*
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_ROUTE_STREAM_H__
+#define __BGP_ROUTE_STREAM_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <bgp/route-input.h>
+#include <bgp/types.h>
+
+#define ROUTE_STREAM_MAGIC      "CBGPRS\0\1"
+#define ROUTE_STREAM_MAGIC_SIZE 8
+/** Maximum size of a record (including its length). */
+#define ROUTE_STREAM_MAX_RECORD 65537
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ route_stream_encode ]------------------------------------
+  /**
+   * Encode a route as a record.
+   *
+   * \retval the number of bytes written, or -1 if the record does not
+   *   fit in the buffer.
+   */
+  int route_stream_encode(bgp_route_t * route, net_addr_t peer_addr,
+			  asn_t peer_asn, uint8_t * buf, size_t size);
+  // -----[ route_stream_decode ]------------------------------------
+  /**
+   * Decode a record (without its length prefix).
+   *
+   * \retval 0 on success, or -1 if the record is malformed.
+   */
+  int route_stream_decode(const uint8_t * buf, size_t size,
+			  net_addr_t * peer_addr, asn_t * peer_asn,
+			  bgp_route_t ** route_ref);
+  // -----[ route_stream_load ]--------------------------------------
+  /**
+   * Load the routes of a binary route stream (see bgp_routes_load).
+   */
+  int route_stream_load(const char * filename, bgp_route_handler_f handler,
+			void * ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_ROUTE_STREAM_H__ */
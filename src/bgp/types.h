@@ -67,6 +67,11 @@ typedef enum {
 typedef gds_trie_t bgp_rib_t;
 
 
+// -----[ bgp_urib_t ]-----------------------------------------------
+/** Definition of a unified (prefix-centric) RIB, see bgp/urib.h. */
+typedef gds_trie_t bgp_urib_t;
+
+
 // -----[ BGP attribute reference counter ]--------------------------
 typedef uint32_t bgp_attr_refcnt_t;
 
@@ -83,6 +88,22 @@ typedef struct bgp_domain_t {
 } bgp_domain_t;
 
 
+// -----[ bgp_router_stats_t ]---------------------------------------
+/** Hot-path counters of a BGP router (see bgp_router_show_stats). */
+typedef struct {
+  /** Number of runs of the decision process. */
+  unsigned long dp_runs;
+  /** Time spent in the decision process, in cycles_now() units
+   *  (only measured if the BGP_OPT_DP_TIMING option is set, see
+   *  cycles_to_ns in util/cycles.h). */
+  uint64_t      dp_cycles;
+  /** Number of evaluations of input and output filters. */
+  unsigned long filter_evals;
+  /** Number of routes copied to be advertised or installed. */
+  unsigned long route_copies;
+} bgp_router_stats_t;
+
+
 // -----[ bgp_router_t ]---------------------------------------------
 /** Definition of a BGP router. */
 typedef struct bgp_router_t {
@@ -94,6 +115,9 @@ typedef struct bgp_router_t {
   bgp_peers_t         * peers;
   /** Local Routing Information Base (Loc-RIB). */
   bgp_rib_t           * loc_rib;
+  /** Unified RIB holding the routes received from all the peers
+   *  (NULL if each peer has a separate Adj-RIB-In). */
+  bgp_urib_t          * urib;
   /** List of originated prefixes. */
   bgp_routes_t        * local_nets;
   /** Cluster-ID. */
@@ -104,6 +128,8 @@ typedef struct bgp_router_t {
   net_node_t          * node;
   /** Reference to BGP domain (AS). */
   struct bgp_domain_t * domain;
+  /** Hot-path counters. */
+  bgp_router_stats_t    stats;
 
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   /** This is a list of neighbors sorted on the walton limit number
@@ -114,6 +140,16 @@ typedef struct bgp_router_t {
 } bgp_router_t;
 
 
+// -----[ bgp_peer_stats_t ]-----------------------------------------
+/** Message counters of a BGP session. */
+typedef struct {
+  unsigned long updates_sent;
+  unsigned long withdraws_sent;
+  unsigned long updates_rcvd;
+  unsigned long withdraws_rcvd;
+} bgp_peer_stats_t;
+
+
 // -----[ bgp_peer_state_t ]-----------------------------------------
 /** BGP session states. */
 typedef enum {
@@ -147,8 +183,14 @@ typedef struct bgp_peer_t {
   net_addr_t            router_id;
   /** Input and output filters. */
   struct bgp_filter_t * filter[FILTER_MAX];
-  /** Input and output Adjacent Routing Information Bases (Adj-RIBs). */
+  /** Input and output Adjacent Routing Information Bases (Adj-RIBs).
+   *  The Adj-RIB-In is NULL if the router uses a unified RIB. */
   bgp_rib_t           * adj_rib[RIB_MAX];    
+  /** Fingerprints of the routes advertised to the neighbor when
+   *  the Adj-RIB-Out is elided (NULL otherwise). */
+  gds_trie_t          * rib_out_marks;
+  /** Index of the neighbor in the router's unified RIB. */
+  unsigned int          rib_index;
   /** Session state (handled by the FSM). */
   bgp_peer_state_t      session_state;
   /** Next-hop to advertise to this peer.
@@ -163,8 +205,15 @@ typedef struct bgp_peer_t {
   unsigned int          recv_seq_num;
   /** Last error of the session. */
   int                   last_error;
+  /** Topology epoch of the cached reachability verdict
+   *  (0 if no verdict is cached, see bgp_peer_session_ok). */
+  unsigned long         session_ok_epoch;
+  /** Cached reachability verdict. */
+  int                   session_ok;
   /** Optionnal stream for recording sent/received BGP messages. */
   gds_stream_t        * pRecordStream;
+  /** Message counters. */
+  bgp_peer_stats_t      stats;
 
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   uint16_t uWaltonLimit;
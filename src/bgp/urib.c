@@ -0,0 +1,398 @@
+// ==================================================================
+// @(#)urib.c
+//
+// Unified (prefix-centric) Routing Information Base.
+//
+// In the default layout, each peer owns a separate Adj-RIB-In and
+// the decision process must perform one lookup per peer in order to
+// collect the candidate routes towards a prefix. With the unified
+// layout, a single trie is maintained per router. Each node of this
+// trie contains a compact vector of (peer index, route) pairs and a
+// reference to the best route. The decision process thus only needs
+// a single lookup per prefix.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <libgds/array.h>
+#include <libgds/memory.h>
+#include <libgds/trie.h>
+
+#include <bgp/route.h>
+#include <bgp/urib.h>
+
+#define URIB_NODE_INITIAL_SIZE 2
+
+// -----[ _urib_node_create ]----------------------------------------
+static inline bgp_urib_node_t * _urib_node_create()
+{
+  bgp_urib_node_t * node=
+    (bgp_urib_node_t *) MALLOC(sizeof(bgp_urib_node_t));
+  node->best= NULL;
+  node->size= 0;
+  node->max_size= 0;
+  node->entries= NULL;
+  return node;
+}
+
+// -----[ _urib_node_destroy ]---------------------------------------
+/**
+ * Destroy a node of the unified RIB. The candidate routes are owned
+ * by the node and are destroyed as well. The best route is a
+ * reference to the Loc-RIB and is left untouched.
+ */
+static void _urib_node_destroy(void ** item_ref)
+{
+  bgp_urib_node_t * node= *((bgp_urib_node_t **) item_ref);
+  unsigned int index;
+
+  if (node == NULL)
+    return;
+
+  for (index= 0; index < node->size; index++)
+    route_destroy(&node->entries[index].route);
+  if (node->entries != NULL)
+    FREE(node->entries);
+  FREE(node);
+  *item_ref= NULL;
+}
+
+// -----[ _urib_node_find_index ]------------------------------------
+/**
+ * Locate the candidate route received from the given peer. The
+ * candidates are sorted on the peer index, so that the search stops
+ * as soon as a larger index is met.
+ *
+ * Returns 0 if the peer has a candidate route (its position is
+ * stored in index_ref). Otherwise, returns -1 and the position where
+ * the candidate should be inserted is stored in index_ref.
+ */
+static inline int _urib_node_find_index(bgp_urib_node_t * node,
+					unsigned int peer_index,
+					unsigned int * index_ref)
+{
+  unsigned int index;
+
+  for (index= 0; index < node->size; index++) {
+    if (node->entries[index].peer_index == peer_index) {
+      *index_ref= index;
+      return 0;
+    }
+    if (node->entries[index].peer_index > peer_index)
+      break;
+  }
+  *index_ref= index;
+  return -1;
+}
+
+// -----[ _urib_node_insert_at ]-------------------------------------
+static inline void _urib_node_insert_at(bgp_urib_node_t * node,
+					unsigned int index,
+					unsigned int peer_index,
+					bgp_route_t * route)
+{
+  if (node->size >= node->max_size) {
+    if (node->max_size == 0)
+      node->max_size= URIB_NODE_INITIAL_SIZE;
+    else
+      node->max_size*= 2;
+    node->entries= (bgp_urib_entry_t *)
+      REALLOC(node->entries, node->max_size*sizeof(bgp_urib_entry_t));
+  }
+  if (index < node->size)
+    memmove(&node->entries[index+1], &node->entries[index],
+	    (node->size-index)*sizeof(bgp_urib_entry_t));
+  node->entries[index].peer_index= peer_index;
+  node->entries[index].route= route;
+  node->size++;
+}
+
+// -----[ _urib_node_remove_at ]-------------------------------------
+static inline void _urib_node_remove_at(bgp_urib_node_t * node,
+					unsigned int index)
+{
+  route_destroy(&node->entries[index].route);
+  node->size--;
+  if (index < node->size)
+    memmove(&node->entries[index], &node->entries[index+1],
+	    (node->size-index)*sizeof(bgp_urib_entry_t));
+}
+
+// -----[ _urib_node_release ]---------------------------------------
+/**
+ * Remove the node from the trie if it holds neither a candidate
+ * route nor a best route.
+ */
+static inline void _urib_node_release(bgp_urib_t * urib,
+				      bgp_urib_node_t * node,
+				      ip_pfx_t prefix)
+{
+  if ((node->size == 0) && (node->best == NULL))
+    trie_remove(urib, prefix.network, prefix.mask);
+}
+
+// -----[ _urib_get_node ]-------------------------------------------
+/**
+ * Return the node for the given prefix. The node is created if it
+ * does not exist yet.
+ */
+static inline bgp_urib_node_t * _urib_get_node(bgp_urib_t * urib,
+					       ip_pfx_t prefix)
+{
+  bgp_urib_node_t * node= urib_find_node(urib, prefix);
+
+  if (node == NULL) {
+    node= _urib_node_create();
+    trie_insert(urib, prefix.network, prefix.mask, node, 0);
+  }
+  return node;
+}
+
+// -----[ urib_create ]----------------------------------------------
+bgp_urib_t * urib_create()
+{
+  return (bgp_urib_t *) trie_create(_urib_node_destroy);
+}
+
+// -----[ urib_destroy ]---------------------------------------------
+void urib_destroy(bgp_urib_t ** urib_ref)
+{
+  trie_destroy(urib_ref);
+}
+
+// -----[ urib_find_node ]-------------------------------------------
+bgp_urib_node_t * urib_find_node(bgp_urib_t * urib, ip_pfx_t prefix)
+{
+  return (bgp_urib_node_t *) trie_find_exact(urib, prefix.network,
+					     prefix.mask);
+}
+
+// -----[ urib_node_get_route ]--------------------------------------
+bgp_route_t * urib_node_get_route(bgp_urib_node_t * node,
+				  unsigned int peer_index)
+{
+  unsigned int index;
+
+  if (_urib_node_find_index(node, peer_index, &index) < 0)
+    return NULL;
+  return node->entries[index].route;
+}
+
+// -----[ urib_find_route ]------------------------------------------
+/**
+ * Return the route received from the given peer towards exactly
+ * the given prefix.
+ */
+bgp_route_t * urib_find_route(bgp_urib_t * urib, ip_pfx_t prefix,
+			      unsigned int peer_index)
+{
+  bgp_urib_node_t * node= urib_find_node(urib, prefix);
+
+  if (node == NULL)
+    return NULL;
+  return urib_node_get_route(node, peer_index);
+}
+
+// -----[ urib_find_best_route ]-------------------------------------
+/**
+ * Return the route received from the given peer whose prefix is the
+ * longest match for the given prefix. Since the nodes are shared by
+ * all the peers, the longest matching node does not necessarily
+ * contain a route from this peer. Less specific prefixes are thus
+ * tried in turn.
+ */
+bgp_route_t * urib_find_best_route(bgp_urib_t * urib, ip_pfx_t prefix,
+				   unsigned int peer_index)
+{
+  bgp_route_t * route;
+  ip_pfx_t current= prefix;
+
+  if (current.mask > 32)
+    current.mask= 32;
+  while (1) {
+    ip_prefix_mask(&current);
+    route= urib_find_route(urib, current, peer_index);
+    if ((route != NULL) || (current.mask == 0))
+      return route;
+    current.mask--;
+  }
+}
+
+// -----[ urib_replace_route ]---------------------------------------
+/**
+ * Store the route received from the given peer. A previous route
+ * received from the same peer towards the same prefix is destroyed.
+ */
+int urib_replace_route(bgp_urib_t * urib, unsigned int peer_index,
+		       bgp_route_t * route)
+{
+  bgp_urib_node_t * node= _urib_get_node(urib, route->prefix);
+  unsigned int index;
+
+  if (_urib_node_find_index(node, peer_index, &index) == 0) {
+    if (node->entries[index].route != route)
+      route_destroy(&node->entries[index].route);
+    node->entries[index].route= route;
+  } else {
+    _urib_node_insert_at(node, index, peer_index, route);
+  }
+  return 0;
+}
+
+// -----[ urib_remove_route ]----------------------------------------
+/**
+ * Remove (and destroy) the route received from the given peer.
+ *
+ * Returns 0 on success and -1 if there is no such route.
+ */
+int urib_remove_route(bgp_urib_t * urib, ip_pfx_t prefix,
+		      unsigned int peer_index)
+{
+  bgp_urib_node_t * node= urib_find_node(urib, prefix);
+  unsigned int index;
+
+  if ((node == NULL) ||
+      (_urib_node_find_index(node, peer_index, &index) < 0))
+    return -1;
+
+  _urib_node_remove_at(node, index);
+  _urib_node_release(urib, node, prefix);
+  return 0;
+}
+
+// -----[ urib_set_best ]--------------------------------------------
+/**
+ * Change the reference to the best route (Loc-RIB) of a prefix. A
+ * NULL route clears the reference.
+ */
+void urib_set_best(bgp_urib_t * urib, ip_pfx_t prefix,
+		   bgp_route_t * route)
+{
+  bgp_urib_node_t * node;
+
+  if (route == NULL) {
+    node= urib_find_node(urib, prefix);
+    if (node != NULL) {
+      node->best= NULL;
+      _urib_node_release(urib, node, prefix);
+    }
+    return;
+  }
+  node= _urib_get_node(urib, prefix);
+  node->best= route;
+}
+
+// -----[ urib_get_best ]--------------------------------------------
+bgp_route_t * urib_get_best(bgp_urib_t * urib, ip_pfx_t prefix)
+{
+  bgp_urib_node_t * node= urib_find_node(urib, prefix);
+
+  if (node == NULL)
+    return NULL;
+  return node->best;
+}
+
+typedef struct {
+  urib_for_each_f     for_each;
+  FRadixTreeForEach   route_for_each;
+  unsigned int        peer_index;
+  void              * ctx;
+} _urib_ctx_t;
+
+// -----[ _urib_for_each ]-------------------------------------------
+static int _urib_for_each(trie_key_t key, trie_key_len_t key_len,
+			  void * item, void * ctx)
+{
+  _urib_ctx_t * urib_ctx= (_urib_ctx_t *) ctx;
+  ip_pfx_t prefix= { .network= key, .mask= key_len };
+
+  return urib_ctx->for_each(prefix, (bgp_urib_node_t *) item,
+			    urib_ctx->ctx);
+}
+
+// -----[ urib_for_each ]--------------------------------------------
+/**
+ * Call the given function for each prefix (node) of the RIB. The
+ * RIB must not be modified by the callback function.
+ */
+int urib_for_each(bgp_urib_t * urib, urib_for_each_f for_each,
+		  void * ctx)
+{
+  _urib_ctx_t urib_ctx= {
+    .for_each= for_each,
+    .ctx     = ctx,
+  };
+  return trie_for_each(urib, _urib_for_each, &urib_ctx);
+}
+
+// -----[ _urib_for_each_route ]-------------------------------------
+static int _urib_for_each_route(trie_key_t key, trie_key_len_t key_len,
+				void * item, void * ctx)
+{
+  _urib_ctx_t * urib_ctx= (_urib_ctx_t *) ctx;
+  bgp_route_t * route;
+
+  route= urib_node_get_route((bgp_urib_node_t *) item,
+			     urib_ctx->peer_index);
+  if (route == NULL)
+    return 0;
+  return urib_ctx->route_for_each(key, key_len, route, urib_ctx->ctx);
+}
+
+// -----[ urib_for_each_route ]--------------------------------------
+/**
+ * Call the given function for each route received from the given
+ * peer. This is the unified equivalent of 'rib_for_each' applied to
+ * the Adj-RIB-In of that peer.
+ */
+int urib_for_each_route(bgp_urib_t * urib, unsigned int peer_index,
+			FRadixTreeForEach for_each, void * ctx)
+{
+  _urib_ctx_t urib_ctx= {
+    .route_for_each= for_each,
+    .peer_index    = peer_index,
+    .ctx           = ctx,
+  };
+  return trie_for_each(urib, _urib_for_each_route, &urib_ctx);
+}
+
+// -----[ _urib_collect_prefixes ]-----------------------------------
+static int _urib_collect_prefixes(uint32_t key, uint8_t key_len,
+				  void * item, void * ctx)
+{
+  array_t * prefixes= (array_t *) ctx;
+  ip_pfx_t prefix= { .network= key, .mask= key_len };
+
+  _array_append(prefixes, &prefix);
+  return 0;
+}
+
+// -----[ urib_clear_peer ]------------------------------------------
+/**
+ * Remove all the routes received from the given peer. The prefixes
+ * are collected first since the trie can not be modified during a
+ * traversal.
+ */
+void urib_clear_peer(bgp_urib_t * urib, unsigned int peer_index)
+{
+  array_t * prefixes;
+  unsigned int index;
+  ip_pfx_t prefix;
+
+  prefixes= _array_create(sizeof(ip_pfx_t), 0, 0, NULL, NULL, NULL);
+  urib_for_each_route(urib, peer_index, _urib_collect_prefixes, prefixes);
+  for (index= 0; index < _array_length(prefixes); index++) {
+    _array_get_at(prefixes, index, &prefix);
+    urib_remove_route(urib, prefix, peer_index);
+  }
+  _array_destroy(&prefixes);
+}
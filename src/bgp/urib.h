@@ -0,0 +1,94 @@
+// ==================================================================
+// @(#)urib.h
+//
+// Unified (prefix-centric) Routing Information Base. A single trie
+// node per prefix holds the routes received from all the peers of a
+// router (Adj-RIB-Ins) as well as a reference to the best route
+// (Loc-RIB).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __BGP_URIB_H__
+#define __BGP_URIB_H__
+
+#include <libgds/radix-tree.h>
+
+#include <net/prefix.h>
+#include <bgp/types.h>
+
+// -----[ bgp_urib_entry_t ]-----------------------------------------
+/** Candidate route received from a peer. */
+typedef struct {
+  /** Index of the peer in the router (see bgp_peer_t::rib_index). */
+  unsigned int   peer_index;
+  /** Route received from that peer (owned by the RIB). */
+  bgp_route_t  * route;
+} bgp_urib_entry_t;
+
+// -----[ bgp_urib_node_t ]------------------------------------------
+/**
+ * Content of the unified RIB for a single prefix. The candidate
+ * routes are kept sorted on the peer index.
+ */
+typedef struct {
+  /** Best route (reference to the Loc-RIB route, not owned). */
+  bgp_route_t      * best;
+  /** Number of candidate routes. */
+  unsigned int       size;
+  /** Number of allocated candidate slots. */
+  unsigned int       max_size;
+  /** Candidate routes. */
+  bgp_urib_entry_t * entries;
+} bgp_urib_node_t;
+
+// -----[ urib_for_each_f ]------------------------------------------
+typedef int (*urib_for_each_f)(ip_pfx_t prefix, bgp_urib_node_t * node,
+			       void * ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ urib_create ]--------------------------------------------
+  bgp_urib_t * urib_create();
+  // -----[ urib_destroy ]-------------------------------------------
+  void urib_destroy(bgp_urib_t ** urib_ref);
+  // -----[ urib_find_node ]-----------------------------------------
+  bgp_urib_node_t * urib_find_node(bgp_urib_t * urib, ip_pfx_t prefix);
+  // -----[ urib_node_get_route ]------------------------------------
+  bgp_route_t * urib_node_get_route(bgp_urib_node_t * node,
+				    unsigned int peer_index);
+  // -----[ urib_find_route ]----------------------------------------
+  bgp_route_t * urib_find_route(bgp_urib_t * urib, ip_pfx_t prefix,
+				unsigned int peer_index);
+  // -----[ urib_find_best_route ]-----------------------------------
+  bgp_route_t * urib_find_best_route(bgp_urib_t * urib, ip_pfx_t prefix,
+				     unsigned int peer_index);
+  // -----[ urib_replace_route ]-------------------------------------
+  int urib_replace_route(bgp_urib_t * urib, unsigned int peer_index,
+			 bgp_route_t * route);
+  // -----[ urib_remove_route ]--------------------------------------
+  int urib_remove_route(bgp_urib_t * urib, ip_pfx_t prefix,
+			unsigned int peer_index);
+  // -----[ urib_set_best ]------------------------------------------
+  void urib_set_best(bgp_urib_t * urib, ip_pfx_t prefix,
+		     bgp_route_t * route);
+  // -----[ urib_get_best ]------------------------------------------
+  bgp_route_t * urib_get_best(bgp_urib_t * urib, ip_pfx_t prefix);
+  // -----[ urib_for_each ]------------------------------------------
+  int urib_for_each(bgp_urib_t * urib, urib_for_each_f for_each,
+		    void * ctx);
+  // -----[ urib_for_each_route ]------------------------------------
+  int urib_for_each_route(bgp_urib_t * urib, unsigned int peer_index,
+			  FRadixTreeForEach for_each, void * ctx);
+  // -----[ urib_clear_peer ]----------------------------------------
+  void urib_clear_peer(bgp_urib_t * urib, unsigned int peer_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_URIB_H__ */
@@ -28,6 +28,7 @@
 #include <bgp/peer-list.h>
 #include <bgp/qos.h>
 #include <bgp/record-route.h>
+#include <bgp/rib_cursor.h>
 #include <bgp/route.h>
 #include <bgp/route_map.h>
 #include <bgp/tie_breaks.h>
@@ -113,12 +114,22 @@ int cli_bgp_assert_peerings(cli_ctx_t * ctx, cli_cmd_t * cmd)
  *
  * context: {}
  * tokens: {}
+ * options: {--threads=<num>}
  */
 int cli_bgp_assert_reachability(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
+  const char * opt= cli_get_opt_value(cmd, "threads");
+  unsigned int num_threads= 1;
+
+  if ((opt != NULL) &&
+      (str_as_uint(opt, &num_threads) || (num_threads < 1))) {
+    cli_set_user_error(cli_get(), "invalid number of threads \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
   // Test the reachability of all advertised networks from all BGP
   // instances
-  if (bgp_assert_reachability()) {
+  if (bgp_assert_reachability(num_threads)) {
     cli_set_user_error(cli_get(), "reachability assertion failed.");
     return CLI_ERROR_COMMAND_FAILED;
   }
@@ -163,16 +174,72 @@ void cli_ctx_destroy_bgp_domain(void ** item)
 // ----- cli_bgp_domain_full_mesh -----------------------------------
 /**
  * Generate a full-mesh of iBGP sessions between the routers of the
- * domain.
+ * domain. With the --accurate option, the sessions are opened with
+ * OPEN message exchanges instead of being established in bulk.
  *
  * context: {as}
  * tokens: {}
+ * options: {--accurate}
  */
 int cli_bgp_domain_full_mesh(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   bgp_domain_t * domain= _domain_from_context(ctx);
+  uint8_t options= 0;
+  int result;
+
+  if (cli_opts_has_value(cmd->opts, "accurate"))
+    options|= BGP_DOMAIN_MESH_ACCURATE;
+
   // Generate the full-mesh of iBGP sessions
-  bgp_domain_full_mesh(domain);
+  result= bgp_domain_full_mesh(domain, options);
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not build full-mesh (%s)",
+		       network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_bgp_domain_build_rr_hierarchy ]------------------------
+/**
+ * Generate a hierarchy of route-reflectors in the domain. Each
+ * cluster has <clients> clients and --redundancy route-reflectors
+ * (1 by default). The route-reflectors form a full-mesh.
+ *
+ * context: {as}
+ * tokens: {clients}
+ * options: {--redundancy=<rrs>, --accurate}
+ */
+static int cli_bgp_domain_build_rr_hierarchy(cli_ctx_t * ctx,
+					     cli_cmd_t * cmd)
+{
+  bgp_domain_t * domain= _domain_from_context(ctx);
+  const char * arg= cli_get_arg_value(cmd, 0);
+  unsigned int num_clients, num_rrs= 1;
+  uint8_t options= 0;
+  int result;
+
+  if (str_as_uint(arg, &num_clients) || (num_clients < 1)) {
+    cli_set_user_error(cli_get(), "invalid number of clients \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (cli_has_opt_value(cmd, "redundancy")) {
+    arg= cli_get_opt_value(cmd, "redundancy");
+    if (str_as_uint(arg, &num_rrs) || (num_rrs < 1)) {
+      cli_set_user_error(cli_get(), "invalid redundancy \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+  if (cli_opts_has_value(cmd->opts, "accurate"))
+    options|= BGP_DOMAIN_MESH_ACCURATE;
+
+  result= bgp_domain_build_rr_hierarchy(domain, num_clients, num_rrs,
+					options);
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not build RR hierarchy (%s)",
+		       network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
   return CLI_SUCCESS;
 }
 
@@ -342,6 +409,62 @@ int cli_bgp_options_autocreate(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_bgp_options_dptiming ]---------------------------------
+/**
+ * Measure the time spent in the decision process of each router
+ * (see "bgp router X show stats --detailed").
+ *
+ * context: {}
+ * tokens: {on/off}
+ */
+int cli_bgp_options_dptiming(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg;
+
+  arg= cli_get_arg_value(cmd, 0);
+  if (!strcmp(arg, "on"))
+    bgp_options_flag_set(BGP_OPT_DP_TIMING);
+  else if (!strcmp(arg, "off"))
+    bgp_options_flag_reset(BGP_OPT_DP_TIMING);
+  else {
+    cli_set_user_error(cli_get(), "invalid value \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_bgp_options_riblayout ]--------------------------------
+/**
+ * Select the layout of the Adj-RIB-Ins of the routers created
+ * afterwards:
+ *   - "per-peer": each peer has a separate Adj-RIB-In (default)
+ *   - "unified" : a single prefix-centric RIB per router holds the
+ *                 routes received from all the peers
+ *
+ * context: {}
+ * tokens: {per-peer/unified}
+ */
+int cli_bgp_options_riblayout(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg;
+
+  arg= cli_get_arg_value(cmd, 0);
+  if (!strcmp(arg, "unified")) {
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+    cli_set_user_error(cli_get(), "unified RIB not supported with walton");
+    return CLI_ERROR_COMMAND_FAILED;
+#else
+    bgp_options_flag_set(BGP_OPT_UNIFIED_RIB);
+#endif
+  } else if (!strcmp(arg, "per-peer"))
+    bgp_options_flag_reset(BGP_OPT_UNIFIED_RIB);
+  else {
+    cli_set_user_error(cli_get(), "invalid value \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // -----[ cli_bgp_options_showmode ]---------------------------------
 /**
  * Change the BGP route "show" mode.
@@ -687,6 +810,87 @@ static inline void _opt_output_release(gds_stream_t ** stream_ref) {
   }
 }
 
+// -----[ _opt_cursor_init ]-----------------------------------------
+/**
+ * Initialize a RIB cursor from the --after, --limit and --filter
+ * options. The predicate must be released with _opt_cursor_release.
+ */
+static inline int _opt_cursor_init(const cli_cmd_t * cmd,
+				   bgp_router_t * router,
+				   bgp_rib_cursor_t * cursor)
+{
+  const char * opt;
+  unsigned int limit= 0;
+  bgp_ft_matcher_t * matcher= NULL;
+  int result;
+
+  opt= cli_get_opt_value(cmd, "limit");
+  if ((opt != NULL) && (str_as_uint(opt, &limit) || (limit < 1))) {
+    cli_set_user_error(cli_get(), "invalid limit \"%s\"", opt);
+    return -1;
+  }
+
+  opt= cli_get_opt_value(cmd, "filter");
+  if (opt != NULL) {
+    result= predicate_parser(opt, &matcher);
+    if (result != PREDICATE_PARSER_SUCCESS) {
+      cli_set_user_error(cli_get(), "invalid predicate \"%s\" (%s)",
+			 opt, predicate_parser_strerror(result));
+      return -1;
+    }
+  }
+
+  rib_cursor_init(cursor, router, limit, matcher);
+
+  opt= cli_get_opt_value(cmd, "after");
+  if (opt != NULL) {
+    if (str2prefix(opt, &cursor->after)) {
+      cli_set_user_error(cli_get(), "invalid prefix \"%s\"", opt);
+      if (matcher != NULL)
+	filter_matcher_destroy(&matcher);
+      return -1;
+    }
+    cursor->has_after= 1;
+  }
+  return 0;
+}
+
+// -----[ _opt_cursor_check ]----------------------------------------
+/**
+ * Check that the --after, --limit and --filter options are only
+ * used when all the routes are selected ('*').
+ */
+static inline int _opt_cursor_check(const cli_cmd_t * cmd, const char * arg)
+{
+  if (!strcmp(arg, "*"))
+    return 0;
+  if ((cli_get_opt_value(cmd, "after") != NULL) ||
+      (cli_get_opt_value(cmd, "limit") != NULL) ||
+      (cli_get_opt_value(cmd, "filter") != NULL)) {
+    cli_set_user_error(cli_get(), "--after, --limit and --filter can only"
+		       " be used with \"*\"");
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _opt_cursor_release ]--------------------------------------
+/**
+ * Release the predicate of a RIB cursor. If the page was truncated,
+ * tell how to get the next page.
+ */
+static inline void _opt_cursor_release(gds_stream_t * stream,
+				       bgp_rib_cursor_t * cursor)
+{
+  if (cursor->more) {
+    stream_printf(stream, "# next: --after=");
+    ip_prefix_dump(stream, cursor->after);
+    stream_printf(stream, "\n");
+  }
+  if (cursor->matcher != NULL)
+    filter_matcher_destroy(&cursor->matcher);
+}
+
 // ----- cli_bgp_router_show_rib ------------------------------------
 /**
  * This function shows the list of routes in the given BGP instance's
@@ -697,9 +901,14 @@ static inline void _opt_output_release(gds_stream_t ** stream_ref) {
  *   - a prefix, meaning show only the route towards this exact prefix
  *   - an asterisk ('*'), meaning show everything
  *
+ * With an asterisk, the routes can be shown by pages of at most
+ * <limit> routes (--limit), starting after a given prefix (--after)
+ * and filtered with a predicate (--filter).
+ *
  * context: {router}
  * tokens: {prefix|address|*}
- * options: {--output=filename}
+ * options: {--output=filename, --after=prefix, --limit=num,
+ *           --filter=predicate}
  */
 int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -707,13 +916,21 @@ int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   const char * arg= cli_get_arg_value(cmd, 0);
   ip_pfx_t prefix;
   gds_stream_t * stream;
+  bgp_rib_cursor_t cursor;
   
+  if (_opt_cursor_check(cmd, arg))
+    return CLI_ERROR_COMMAND_FAILED;
   if (_opt_output_init(cmd, &stream))
     return CLI_ERROR_COMMAND_FAILED;
 
   // Get the prefix/address/*
   if (!strcmp(arg, "*")) {
-    bgp_router_dump_rib(stream, router);
+    if (_opt_cursor_init(cmd, router, &cursor)) {
+      _opt_output_release(&stream);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    bgp_router_dump_rib_cursor(stream, router, &cursor);
+    _opt_cursor_release(stream, &cursor);
   } else if (!str2prefix(arg, &prefix)) {
     bgp_router_dump_rib_prefix(stream, router, prefix);
   } else if (!str2address(arg, &prefix.network)) {
@@ -744,9 +961,16 @@ int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
  *   - a prefix, meaning show only the route towards this exact prefix
  *   - an asterisk ('*'), meaning show everything
  *
+ * With an asterisk, the --after, --limit and --filter options select
+ * a page of routes (see 'show rib'). With all peers, the page is
+ * selected independently in each Adj-RIB and the next page starts
+ * after the smallest last prefix of the truncated Adj-RIBs (routes
+ * of the other Adj-RIBs can thus be shown again).
+ *
  * context: {router}
  * tokens: {in|out, addr, prefix|address|*}
- * options: {--output=filename}
+ * options: {--output=filename, --after=prefix, --limit=num,
+ *           --filter=predicate}
  */
 static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -757,6 +981,10 @@ static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   ip_pfx_t prefix;
   bgp_rib_dir_t dir;
   gds_stream_t * stream;
+  bgp_rib_cursor_t cursor;
+  ip_pfx_t after, next;
+  int has_after, more;
+  unsigned int index;
 
   // Get the adjrib direction: in|out
   arg= cli_get_arg_value(cmd, 0);
@@ -795,11 +1023,44 @@ static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
     cli_set_user_error(cli_get(), "invalid prefix|address|* \"%s\"", arg);
     return CLI_ERROR_COMMAND_FAILED;
   }
+  if (_opt_cursor_check(cmd, arg))
+    return CLI_ERROR_COMMAND_FAILED;
 
-    if (_opt_output_init(cmd, &stream))
+  if (_opt_output_init(cmd, &stream))
     return CLI_ERROR_COMMAND_FAILED;
-  
-  bgp_router_dump_adjrib(stream, router, peer, prefix, dir);
+
+  if (prefix.mask == 0) {
+    if (_opt_cursor_init(cmd, router, &cursor)) {
+      _opt_output_release(&stream);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    if (peer != NULL) {
+      bgp_peer_dump_adjrib_cursor(stream, peer, dir, &cursor);
+    } else {
+      // Each Adj-RIB has its own next page
+      after= cursor.after;
+      has_after= cursor.has_after;
+      next= after;
+      more= 0;
+      for (index= 0; index < bgp_peers_size(router->peers); index++) {
+	cursor.after= after;
+	cursor.has_after= has_after;
+	bgp_peer_dump_adjrib_cursor(stream, bgp_peers_at(router->peers, index),
+				    dir, &cursor);
+	if (cursor.more &&
+	    (!more || (cursor.after.network < next.network) ||
+	     ((cursor.after.network == next.network) &&
+	      (cursor.after.mask < next.mask)))) {
+	  next= cursor.after;
+	  more= 1;
+	}
+      }
+      cursor.after= next;
+      cursor.more= more;
+    }
+    _opt_cursor_release(stream, &cursor);
+  } else
+    bgp_router_dump_adjrib(stream, router, peer, prefix, dir);
 
   _opt_output_release(&stream);
 
@@ -842,8 +1103,12 @@ static int cli_bgp_router_show_routeinfo(cli_ctx_t * ctx, cli_cmd_t * cmd)
 
 // ----- cli_bgp_router_show_stats ----------------------------------
 /**
+ * With the --detailed option, the hot-path counters of the router
+ * are also shown (see bgp_router_show_counters).
+ *
  * context: {router}
  * tokens: {}
+ * options: {--detailed}
  */
 int cli_bgp_router_show_stats(cli_ctx_t * ctx,
 			      cli_cmd_t * cmd)
@@ -851,6 +1116,8 @@ int cli_bgp_router_show_stats(cli_ctx_t * ctx,
   bgp_router_t * router= _router_from_context(ctx);
 
   bgp_router_show_stats(gdsout, router);
+  if (cli_opts_has_value(cmd->opts, "detailed"))
+    bgp_router_show_counters(gdsout, router);
 
   return CLI_SUCCESS;
 }
@@ -1412,11 +1679,13 @@ static void _register_bgp_add(cli_cmd_t * parent)
 // ----- _register_bgp_assert ------------------------------------
 static void _register_bgp_assert(cli_cmd_t * parent)
 {
-  cli_cmd_t * group;
+  cli_cmd_t * group, * cmd;
 
   group= cli_add_cmd(parent, cli_cmd_group("assert"));
   cli_add_cmd(group, cli_cmd("peerings-ok", cli_bgp_assert_peerings));
-  cli_add_cmd(group, cli_cmd("reachability-ok", cli_bgp_assert_reachability));
+  cmd= cli_add_cmd(group, cli_cmd("reachability-ok",
+				  cli_bgp_assert_reachability));
+  cli_add_opt(cmd, cli_opt("threads=", NULL));
 }
 
 // ----- _register_bgp_domain ------------------------------------
@@ -1429,6 +1698,12 @@ static void _register_bgp_domain(cli_cmd_t * parent)
 					 cli_ctx_destroy_bgp_domain));
   cli_add_arg(group, cli_arg("as-number", NULL));
   cmd= cli_add_cmd(group, cli_cmd("full-mesh", cli_bgp_domain_full_mesh));
+  cli_add_opt(cmd, cli_opt("accurate", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("build-rr-hierarchy",
+				   cli_bgp_domain_build_rr_hierarchy));
+  cli_add_arg(cmd, cli_arg("clients", NULL));
+  cli_add_opt(cmd, cli_opt("redundancy=", NULL));
+  cli_add_opt(cmd, cli_opt("accurate", NULL));
   cmd= cli_add_cmd(group, cli_cmd("rescan", cli_bgp_domain_rescan));
   cmd= cli_add_cmd(group, cli_cmd("record-route", cli_bgp_domain_recordroute));
   cli_add_arg(cmd, cli_arg("address|prefix", NULL));
@@ -1515,6 +1790,8 @@ static void _register_bgp_options(cli_cmd_t * parent)
   group= cli_add_cmd(parent, cli_cmd_group("options"));
   cmd= cli_add_cmd(group, cli_cmd("auto-create", cli_bgp_options_autocreate));
   cli_add_arg(cmd, cli_arg("on-off", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("dp-timing", cli_bgp_options_dptiming));
+  cli_add_arg(cmd, cli_arg("on-off", NULL));
   cmd= cli_add_cmd(group, cli_cmd("med", cli_bgp_options_med));
   cli_add_arg(cmd, cli_arg("med-type", NULL));
   cmd= cli_add_cmd(group, cli_cmd("local-pref", cli_bgp_options_localpref));
@@ -1523,6 +1800,8 @@ static void _register_bgp_options(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("output-file", NULL));
   cmd= cli_add_cmd(group, cli_cmd("show-mode", cli_bgp_options_showmode));
   cli_add_arg(cmd, cli_arg("cisco|mrt|custom", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("rib-layout", cli_bgp_options_riblayout));
+  cli_add_arg(cmd, cli_arg("per-peer|unified", NULL));
 
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
   cmd= cli_add_cmd(group, cli_cmd("advertise-external-best",
@@ -1574,15 +1853,22 @@ static void _register_bgp_router_show(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("in|out", NULL));
   cli_add_arg(cmd, cli_arg2("peer", NULL, cli_enum_bgp_peers_addr));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("after=", NULL));
+  cli_add_opt(cmd, cli_opt("filter=", NULL));
+  cli_add_opt(cmd, cli_opt("limit=", NULL));
   cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_router_show_rib));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("after=", NULL));
+  cli_add_opt(cmd, cli_opt("filter=", NULL));
+  cli_add_opt(cmd, cli_opt("limit=", NULL));
   cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("route-info",
 				  cli_bgp_router_show_routeinfo));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
   cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("stats", cli_bgp_router_show_stats));
+  cli_add_opt(cmd, cli_opt("detailed", NULL));
 }
 
 // ----- _register_bgp_router ------------------------------------
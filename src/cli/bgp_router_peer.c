@@ -289,6 +289,36 @@ static int cli_peer_update_source(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_peer_rib_out_elide ]-----------------------------------
+/**
+ * Elide the Adj-RIB-Out of this peer: only a fingerprint of the
+ * advertised routes is kept (see bgp_peer_set_rib_out_elide).
+ *
+ * context: {router, peer}
+ * tokens: {on/off}
+ */
+static int cli_peer_rib_out_elide(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  bgp_peer_t * peer= _peer_from_context(ctx);
+  const char * arg= cli_get_arg_value(cmd, 0);
+  int state;
+
+  if (!strcmp(arg, "on"))
+    state= 1;
+  else if (!strcmp(arg, "off"))
+    state= 0;
+  else {
+    cli_set_user_error(cli_get(), "invalid value \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (bgp_peer_set_rib_out_elide(peer, state) != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not change Adj-RIB-Out mode");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // -----[ cli_peer_softrestart ]-------------------------------------
 /**
  * context: {router, peer}
@@ -466,6 +496,8 @@ void cli_register_bgp_router_peer(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("recv", cli_peer_recv));
   cli_add_arg(cmd, cli_arg("mrt-record", NULL));
   cmd= cli_add_cmd(group, cli_cmd("reset", cli_peer_reset));
+  cmd= cli_add_cmd(group, cli_cmd("rib-out-elide", cli_peer_rib_out_elide));
+  cli_add_arg(cmd, cli_arg_on_off(NULL));
   cmd= cli_add_cmd(group, cli_cmd("rr-client", cli_peer_rrclient));
   cmd= cli_add_cmd(group, cli_cmd("soft-restart", cli_peer_softrestart));
   cmd= cli_add_cmd(group, cli_cmd("up", cli_peer_up));
@@ -19,6 +19,7 @@
 #include <bgp/record-route.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/filter.h>
+#include <bgp/aslevel/solver.h>
 #include <bgp/aslevel/stat.h>
 #include <cli/common.h>
 #include <net/util.h>
@@ -30,6 +31,7 @@
  * options:
  *   --addr-sch=default|local
  *   --format=default|caida
+ *   --verbose
  */
 static int cli_bgp_topology_load(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -38,6 +40,8 @@ static int cli_bgp_topology_load(cli_ctx_t * ctx, cli_cmd_t * cmd)
   uint8_t format= ASLEVEL_FORMAT_DEFAULT;
   int line_number;
   int result;
+  aslevel_load_stats_t stats;
+  double time;
 
   // Optional addressing scheme specified ?
   arg= cli_opts_get_value(cmd->opts, "addr-sch");
@@ -59,7 +63,8 @@ static int cli_bgp_topology_load(cli_ctx_t * ctx, cli_cmd_t * cmd)
 
   // Load AS-level topology
   arg= cli_get_arg_value(cmd, 0);
-  result= aslevel_topo_load(arg, format, addr_scheme, &line_number);
+  result= aslevel_topo_load(arg, format, addr_scheme, &line_number,
+			    &stats);
   if (result != ASLEVEL_SUCCESS) {
     if (line_number > 0)
       cli_set_user_error(cli_get(), "could not load topology \"%s\" "
@@ -71,6 +76,19 @@ static int cli_bgp_topology_load(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  // Report load throughput
+  if (cli_has_opt_value(cmd, "verbose")) {
+    time= stats.parse_time+stats.build_time;
+    stream_printf(gdsout, "lines  : %u\n", stats.num_lines);
+    stream_printf(gdsout, "domains: %u\n", stats.num_domains);
+    stream_printf(gdsout, "links  : %u\n", stats.num_links);
+    stream_printf(gdsout, "time   : %.3f s (parse: %.3f s, build: %.3f s)\n",
+		  time, stats.parse_time, stats.build_time);
+    if (time > 0)
+      stream_printf(gdsout, "rate   : %.0f lines/s\n",
+		    stats.num_lines/time);
+  }
+
   return CLI_SUCCESS;
 }
 
@@ -336,17 +354,88 @@ static int cli_bgp_topology_dump(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
-// -----[ cli_bgp_topology_stat ]------------------------------------
+// -----[ cli_bgp_topology_solve ]-----------------------------------
 /**
  * context: {}
- * tokens : {}
- * options: {--output=FILE}
+ * tokens : {prefix}
+ * options: {--origin=ASN, --install, --verify, --output=FILE}
  */
-static int cli_bgp_topology_stat(cli_ctx_t * ctx, cli_cmd_t * cmd)
+static int cli_bgp_topology_solve(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  ip_pfx_t prefix;
+  gds_stream_t * stream= gdsout;
+  const char * arg= cli_get_arg_value(cmd, 0);
+  asn_t origin;
+  asn_t * origin_ref= NULL;
+  uint8_t options= 0;
+  unsigned int num_mismatches;
+  int result;
+
+  // Destination prefix
+  if (str2prefix(arg, &prefix) < 0) {
+    cli_set_user_error(cli_get(), "invalid prefix \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  // Optional origin ?
+  arg= cli_get_opt_value(cmd, "origin");
+  if (arg != NULL) {
+    if (str2asn(arg, &origin)) {
+      cli_set_user_error(cli_get(), "invalid ASN (%s)", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    origin_ref= &origin;
+  }
+
+  if (cli_has_opt_value(cmd, "install"))
+    options|= ASLEVEL_SOLVE_OPT_INSTALL;
+  if (cli_has_opt_value(cmd, "verify"))
+    options|= ASLEVEL_SOLVE_OPT_VERIFY;
+
+  // Optional output file ?
+  arg= cli_get_opt_value(cmd, "output");
+  if (arg != NULL) {
+    stream= stream_create_file(arg);
+    if (stream == NULL) {
+      cli_set_user_error(cli_get(), "unable to create \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  result= aslevel_topo_solve(stream, prefix, origin_ref, options,
+			     &num_mismatches);
+
+  if (stream != gdsout)
+    stream_destroy(&stream);
+
+  if (result != ASLEVEL_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not solve topology (%s)",
+		       aslevel_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (num_mismatches > 0) {
+    cli_set_user_error(cli_get(), "verification failed (%u mismatch(es))",
+		       num_mismatches);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _cli_bgp_topology_stat ]-----------------------------------
+/**
+ * Common part of the statistics commands: check that a topology is
+ * loaded, open the optional output file and report errors.
+ */
+#define _STAT_DEGREE      0
+#define _STAT_CONES       1
+#define _STAT_PROV_FREE   2
+#define _STAT_VALLEY_FREE 3
+static int _cli_bgp_topology_stat(cli_cmd_t * cmd, int what, asn_t asn)
 {
   gds_stream_t * stream= gdsout;
   as_level_topo_t * topo= aslevel_get_topo();
   const char * arg;
+  int result;
 
   if (topo == NULL) {
     cli_set_user_error(cli_get(), "no topology loaded");
@@ -362,14 +451,84 @@ static int cli_bgp_topology_stat(cli_ctx_t * ctx, cli_cmd_t * cmd)
     }
   }
 
-  aslevel_stat_degree(stream, topo, 1, 1, 1);
+  switch (what) {
+  case _STAT_DEGREE:
+    result= aslevel_stat_degree(stream, topo, 1, 1, 1);
+    break;
+  case _STAT_CONES:
+    result= aslevel_stat_customer_cones(stream, topo);
+    break;
+  case _STAT_PROV_FREE:
+    result= aslevel_stat_provider_free(stream, topo);
+    break;
+  default:
+    result= aslevel_stat_valley_free(stream, topo, asn,
+				     cli_has_opt_value(cmd, "verbose"));
+  }
   
   if (stream != gdsout)
     stream_destroy(&stream);
 
+  if (result != ASLEVEL_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not compute statistics (%s)",
+		       aslevel_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
   return CLI_SUCCESS;
 }
 
+// -----[ cli_bgp_topology_stat ]------------------------------------
+/**
+ * context: {}
+ * tokens : {}
+ * options: {--output=FILE}
+ */
+static int cli_bgp_topology_stat(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  return _cli_bgp_topology_stat(cmd, _STAT_DEGREE, 0);
+}
+
+// -----[ cli_bgp_topology_stat_cones ]------------------------------
+/**
+ * context: {}
+ * tokens : {}
+ * options: {--output=FILE}
+ */
+static int cli_bgp_topology_stat_cones(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  return _cli_bgp_topology_stat(cmd, _STAT_CONES, 0);
+}
+
+// -----[ cli_bgp_topology_stat_provider_free ]----------------------
+/**
+ * context: {}
+ * tokens : {}
+ * options: {--output=FILE}
+ */
+static int cli_bgp_topology_stat_provider_free(cli_ctx_t * ctx,
+					       cli_cmd_t * cmd)
+{
+  return _cli_bgp_topology_stat(cmd, _STAT_PROV_FREE, 0);
+}
+
+// -----[ cli_bgp_topology_valley_free ]-----------------------------
+/**
+ * context: {}
+ * tokens : {asn}
+ * options: {--output=FILE, --verbose}
+ */
+static int cli_bgp_topology_valley_free(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  asn_t asn;
+
+  if (str2asn(arg, &asn)) {
+    cli_set_user_error(cli_get(), "invalid ASN (%s)", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return _cli_bgp_topology_stat(cmd, _STAT_VALLEY_FREE, asn);
+}
+
 // -----[ cli_register_bgp_topology_filter ]-------------------------
 static void _cli_register_bgp_topology_filter(cli_cmd_t * parent)
 {
@@ -392,6 +551,7 @@ void cli_register_bgp_topology(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg_file("file", NULL));
   cli_add_opt(cmd, cli_opt("addr-sch=", NULL));
   cli_add_opt(cmd, cli_opt("format=", NULL));
+  cli_add_opt(cmd, cli_opt("verbose", NULL));
   cmd= cli_add_cmd(group, cli_cmd("check", cli_bgp_topology_check));
   cli_add_opt(cmd, cli_opt("verbose", NULL));
   cmd= cli_add_cmd(group, cli_cmd("dump", cli_bgp_topology_dump));
@@ -402,8 +562,13 @@ void cli_register_bgp_topology(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("info", cli_bgp_topology_info));
   cmd= cli_add_cmd(group, cli_cmd("install", cli_bgp_topology_install));
   cmd= cli_add_cmd(group, cli_cmd("policies", cli_bgp_topology_policies));
+  cmd= cli_add_cmd(group, cli_cmd("stat-cones", cli_bgp_topology_stat_cones));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("stat-degree", cli_bgp_topology_stat));
   cli_add_opt(cmd, cli_opt("output=", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("stat-provider-free",
+				  cli_bgp_topology_stat_provider_free));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("record-route",
 				  cli_bgp_topology_recordroute));
   cli_add_arg(cmd, cli_arg("prefix", NULL));
@@ -418,4 +583,15 @@ void cli_register_bgp_topology(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("<output>", NULL));
   */
   cmd= cli_add_cmd(group, cli_cmd("run", cli_bgp_topology_run));
+  cmd= cli_add_cmd(group, cli_cmd("solve", cli_bgp_topology_solve));
+  cli_add_arg(cmd, cli_arg("prefix", NULL));
+  cli_add_opt(cmd, cli_opt("origin=", NULL));
+  cli_add_opt(cmd, cli_opt("install", NULL));
+  cli_add_opt(cmd, cli_opt("verify", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("valley-free",
+				  cli_bgp_topology_valley_free));
+  cli_add_arg(cmd, cli_arg("asn", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+  cli_add_opt(cmd, cli_opt("verbose", NULL));
 }
@@ -30,6 +30,7 @@
 #include <net/prefix.h>
 #include <net/util.h>
 
+#include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/attr/comm_hash.h>
 #include <bgp/attr/path_hash.h>
@@ -38,10 +39,13 @@
 #include <bgp/routes_list.h>
 #include <cli/bgp.h>
 #include <cli/common.h>
+#include <cli/enum.h>
 #include <cli/net.h>
 #include <cli/sim.h>
 #include <ui/output.h>
 #include <ui/rl.h>
+#include <util/mem_acct.h>
+#include <util/slab.h>
 
 #if defined(HAVE_SETRLIMIT) || defined(HAVE_GETRLIMIT)
 # include <sys/resource.h>
@@ -494,6 +498,17 @@ int cli_show_mrt(cli_ctx_t * ctx, cli_cmd_t * cmd)
 #endif
 }
 
+// -----[ cli_show_mem ]---------------------------------------------
+/**
+ * context: {}
+ * tokens: {}
+ */
+int cli_show_mem(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  slab_dump(gdsout);
+  return CLI_SUCCESS;
+}
+
 // ----- cli_show_mem_limit -----------------------------------------
 int cli_show_mem_limit(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -571,6 +586,40 @@ int cli_set_mem_limit(cli_ctx_t * ctx, cli_cmd_t * cmd)
 #endif
 }
 
+// -----[ cli_set_mem_soft_limit ]-----------------------------------
+/**
+ * Set a soft limit on the memory charged to a subsystem (see 'info
+ * memory'). When the limit is exceeded, the simulation is aborted
+ * with a breakdown of the memory usage.
+ *
+ * context: {}
+ * tokens: {subsystem|total, bytes|unlimited}
+ */
+int cli_set_mem_soft_limit(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg_acct= cli_get_arg_value(cmd, 0);
+  const char * arg_limit= cli_get_arg_value(cmd, 1);
+  unsigned long limit;
+  mem_acct_t acct;
+
+  if (!strcmp(arg_limit, "unlimited")) {
+    limit= 0;
+  } else if (str_as_ulong(arg_limit, &limit) || (limit == 0)) {
+    cli_set_user_error(cli_get(), "invalid soft limit \"%s\"", arg_limit);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (!strcmp(arg_acct, "total")) {
+    mem_acct_set_total_limit(limit);
+  } else if (!mem_acct_from_str(arg_acct, &acct)) {
+    mem_acct_set_limit(acct, limit);
+  } else {
+    cli_set_user_error(cli_get(), "unknown subsystem \"%s\"", arg_acct);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // ----- cli_set_path_hash_size -------------------------------------
 int cli_set_path_hash_size(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -799,6 +848,9 @@ static void _register_set(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg_on_off(NULL));
   cmd= cli_add_cmd(group, cli_cmd("mem-limit", cli_set_mem_limit));
   cli_add_arg(cmd, cli_arg("value", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("mem-soft-limit", cli_set_mem_soft_limit));
+  cli_add_arg(cmd, cli_arg("subsystem|total", NULL));
+  cli_add_arg(cmd, cli_arg("bytes|unlimited", NULL));
   cmd= cli_add_cmd(group, cli_cmd("path-hash-size", cli_set_path_hash_size));
   cli_add_arg(cmd, cli_arg("size", NULL));
 //  cmd= cli_add_cmd(group, cli_cmd("time-limit", cli_set_time_limit));
@@ -821,6 +873,7 @@ static void _register_show(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("mrt", cli_show_mrt));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
   cli_add_arg(cmd, cli_arg("predicate", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("mem", cli_show_mem));
   cmd= cli_add_cmd(group, cli_cmd("mem-limit", cli_show_mem_limit));
   cmd= cli_add_cmd(group, cli_cmd("path-hash-content",
 				  cli_show_path_hash_content));
@@ -831,6 +884,41 @@ static void _register_show(cli_cmd_t * parent)
   cli_add_cmd(group, cli_cmd("version", cli_show_version));
 }
 
+// -----[ cli_info_memory ]------------------------------------------
+/**
+ * Show the memory charged to each subsystem. With the --routers
+ * option, the size of the RIBs of each BGP router and peer is also
+ * shown.
+ *
+ * context: {}
+ * tokens: {}
+ * options: {--routers}
+ */
+static int cli_info_memory(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  bgp_router_t * router;
+  int state= 0;
+
+  mem_acct_dump(gdsout);
+  if (cli_has_opt_value(cmd, "routers")) {
+    stream_printf(gdsout, "# router\tpeer\t"
+		  "rib-in\trib-in-bytes\trib-out\trib-out-bytes\n");
+    while ((router= cli_enum_bgp_routers(NULL, state++)) != NULL)
+      bgp_router_show_mem(gdsout, router);
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _register_info ]-------------------------------------------
+static void _register_info(cli_cmd_t * parent)
+{
+  cli_cmd_t * group, * cmd;
+
+  group= cli_add_cmd(parent, cli_cmd_group("info"));
+  cmd= cli_add_cmd(group, cli_cmd("memory", cli_info_memory));
+  cli_add_opt(cmd, cli_opt("routers", NULL));
+}
+
 // -----[ _register_define ]-----------------------------------------
 static void _register_define(cli_cmd_t * parent)
 {
@@ -921,6 +1009,7 @@ cli_t * cli_get()
     // Miscelaneous commands
     _register_define(root);
     _register_include(root);
+    _register_info(root);
     _register_pause(root);
     _register_print(root);
     _register_require(root);
@@ -33,6 +33,10 @@ extern "C" {
   cli_arg_t * cli_arg_file(const char * name, cli_arg_check_f check);
   // -----[ cli_opt_file ]---------------------------------------------
   cli_arg_t * cli_opt_file(const char * name, cli_arg_check_f check);
+  // -----[ cli_arg_on_off ]----------------------------------------
+  cli_arg_t * cli_arg_on_off(const char * name);
+  // -----[ cli_opt_on_off ]----------------------------------------
+  cli_arg_t * cli_opt_on_off(const char * name);
 
   // ----- cli_get --------------------------------------------------
   cli_t * cli_get();
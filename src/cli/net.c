@@ -16,6 +16,7 @@
 
 #include <libgds/cli_ctx.h>
 #include <libgds/cli_params.h>
+#include <libgds/memory.h>
 #include <libgds/stream.h>
 #include <libgds/str_util.h>
 
@@ -28,6 +29,8 @@
 #include <cli/net_ospf.h>
 #include <net/error.h>
 #include <net/export.h>
+#include <net/export_bin.h>
+#include <net/generator.h>
 #include <net/netflow.h>
 #include <net/node.h>
 #include <net/ntf.h>
@@ -41,9 +44,11 @@
 #include <net/tm.h>
 #include <net/util.h>
 #include <ui/rl.h>
+#include <util/lrp.h>
 
 #include <bgp/aslevel/types.h>
 #include <bgp/aslevel/as-level.h>
+#include <bgp/generator.h>
 
 
 /////////////////////////////////////////////////////////////////////
@@ -404,6 +409,10 @@ int cli_net_export(cli_ctx_t * ctx, cli_cmd_t * cmd)
       return CLI_ERROR_COMMAND_FAILED;
     }
   } else {
+    if (format == NET_EXPORT_FORMAT_BIN) {
+      cli_set_user_error(cli_get(), "binary export requires an output file");
+      return CLI_ERROR_COMMAND_FAILED;
+    }
     result= net_export_stream(gdsout, network_get_default(), format);
     if (result != ESUCCESS) {
       cli_set_user_error(cli_get(), "could not export");
@@ -415,6 +424,25 @@ int cli_net_export(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_net_import ]-------------------------------------------
+/**
+ * Context: {}
+ * tokens: {file}
+ */
+int cli_net_import(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  net_error_t result;
+
+  result= net_import_bin_file(arg, network_get_default());
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not import \"%s\" (%s)",
+		       arg, network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // ----- cli_net_ntf_load -------------------------------------------
 /**
  * context: {}
@@ -604,6 +632,155 @@ int cli_net_subnet_show_links(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ _generate_opt_uint ]---------------------------------------
+/**
+ * Parse an optional unsigned integer option. Returns -1 if the
+ * option is present but is not valid.
+ */
+static int _generate_opt_uint(cli_cmd_t * cmd, const char * name,
+			      unsigned int * value)
+{
+  const char * opt= cli_get_opt_value(cmd, name);
+  if ((opt != NULL) && str_as_uint(opt, value)) {
+    cli_set_user_error(cli_get(), "invalid value for %s (%s)", name, opt);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _generate_opt_double ]-------------------------------------
+static int _generate_opt_double(cli_cmd_t * cmd, const char * name,
+				double * value)
+{
+  const char * opt= cli_get_opt_value(cmd, name);
+  if ((opt != NULL) && str_as_double(opt, value)) {
+    cli_set_user_error(cli_get(), "invalid value for %s (%s)", name, opt);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ cli_net_generate ]-----------------------------------------
+/**
+ * Generate a synthetic topology and, optionally, its BGP
+ * configuration and RIB.
+ *
+ * context: {}
+ * tokens : {model, num-nodes}
+ * options: {--seed=, --k=, --radius=, --alpha=, --beta=, --weights=,
+ *           --capacity=, --base=, --domain=, --bgp=, --ibgp=,
+ *           --rrs=, --clients=, --ebgp=, --prefixes=}
+ */
+int cli_net_generate(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg_model= cli_get_arg_value(cmd, 0);
+  const char * arg_nodes= cli_get_arg_value(cmd, 1);
+  network_t * network= network_get_default();
+  net_gen_params_t params;
+  bgp_gen_params_t bgp_params;
+  net_gen_topo_t * topo;
+  unsigned int value;
+  const char * opt;
+  int with_bgp= 0;
+  int error;
+
+  net_gen_params_init(&params);
+  bgp_gen_params_init(&bgp_params);
+
+  if (net_gen_str2model(arg_model, &params.model)) {
+    cli_set_user_error(cli_get(), "invalid model \"%s\"", arg_model);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (str_as_uint(arg_nodes, &params.num_nodes)) {
+    cli_set_user_error(cli_get(), "invalid number of nodes (%s)", arg_nodes);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  // Topology options
+  opt= cli_get_opt_value(cmd, "seed");
+  if ((opt != NULL) && str_as_ulong(opt, &params.seed)) {
+    cli_set_user_error(cli_get(), "invalid seed (%s)", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  bgp_params.seed= params.seed;
+  if (_generate_opt_uint(cmd, "k", &params.k) ||
+      _generate_opt_double(cmd, "radius", &params.radius) ||
+      _generate_opt_double(cmd, "alpha", &params.alpha) ||
+      _generate_opt_double(cmd, "beta", &params.beta))
+    return CLI_ERROR_COMMAND_FAILED;
+  opt= cli_get_opt_value(cmd, "weights");
+  if ((opt != NULL) && net_gen_str2weight(opt, &params.weight)) {
+    cli_set_user_error(cli_get(), "invalid weights \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  opt= cli_get_opt_value(cmd, "capacity");
+  if ((opt != NULL) && str2capacity(opt, &params.capacity)) {
+    cli_set_user_error(cli_get(), "invalid capacity (%s)", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  opt= cli_get_opt_value(cmd, "base");
+  if ((opt != NULL) && str2address(opt, &params.base)) {
+    cli_set_user_error(cli_get(), "invalid base address (%s)", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  opt= cli_get_opt_value(cmd, "domain");
+  if (opt != NULL) {
+    if (str2domain_id(opt, &value)) {
+      cli_set_user_error(cli_get(), "invalid domain id (%s)", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    params.domain= value;
+  }
+
+  // BGP options
+  opt= cli_get_opt_value(cmd, "bgp");
+  if (opt != NULL) {
+    if (str2asn(opt, &bgp_params.asn)) {
+      cli_set_user_error(cli_get(), "invalid AS number (%s)", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    with_bgp= 1;
+    // The BGP sessions require IGP routes
+    if (params.domain == 0)
+      params.domain= 1;
+  }
+  opt= cli_get_opt_value(cmd, "ibgp");
+  if ((opt != NULL) && bgp_gen_str2ibgp(opt, &bgp_params.ibgp)) {
+    cli_set_user_error(cli_get(), "invalid iBGP mode \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (_generate_opt_uint(cmd, "rrs", &bgp_params.num_rrs) ||
+      _generate_opt_uint(cmd, "clients", &bgp_params.num_clients) ||
+      _generate_opt_uint(cmd, "ebgp", &bgp_params.num_ebgp) ||
+      _generate_opt_uint(cmd, "prefixes", &bgp_params.num_prefixes))
+    return CLI_ERROR_COMMAND_FAILED;
+
+  error= net_gen_build(network, &params, &topo);
+  if (error != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not generate topology (%s)",
+		       network_strerror(error));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (with_bgp) {
+    error= igp_domain_compute(network_find_igp_domain(network, params.domain),
+			      0);
+    if (error == ESUCCESS)
+      error= bgp_gen_build(network, topo, &bgp_params);
+    if (error != ESUCCESS) {
+      net_gen_topo_destroy(&topo);
+      cli_set_user_error(cli_get(), "could not generate BGP config (%s)",
+			 network_strerror(error));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  stream_printf(gdsout, "generated %u nodes, %u links\n",
+		topo->num_nodes, topo->num_links);
+  net_gen_topo_destroy(&topo);
+  return CLI_SUCCESS;
+}
+
 // ----- cli_net_show_nodes -----------------------------------------
 /**
  * Display all nodes matching the given criterion, which is a prefix
@@ -776,6 +953,122 @@ int cli_net_traffic_save(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ _traffic_load_vectors ]------------------------------------
+/**
+ * Load flow vectors. Each line is made of a source node, a
+ * destination address and one volume per scenario. All the lines
+ * must have the same number of scenarios.
+ */
+static int _traffic_load_vectors(lrp_t * parser, flow_stats_t * stats)
+{
+  unsigned int num_fields, num_loads= 0, index;
+  net_link_vload_t * loads= NULL;
+  const char * field;
+  net_node_t * node;
+  net_addr_t dst_addr;
+  int result= 0;
+
+  while (lrp_get_next_line(parser)) {
+    if (lrp_get_num_fields(parser, &num_fields) < 0) {
+      result= -1;
+      break;
+    }
+    if ((num_fields < 3) ||
+	((num_loads > 0) && (num_fields - 2 != num_loads))) {
+      lrp_set_user_error(parser, "incorrect number of fields");
+      result= -1;
+      break;
+    }
+    if (num_loads == 0) {
+      num_loads= num_fields - 2;
+      loads= (net_link_vload_t *) MALLOC(num_loads * sizeof(net_link_vload_t));
+    }
+    field= lrp_get_field(parser, 0);
+    if (str2node(field, &node)) {
+      lrp_set_user_error(parser, "unknown source \"%s\"", field);
+      result= -1;
+      break;
+    }
+    field= lrp_get_field(parser, 1);
+    if (str2address(field, &dst_addr)) {
+      lrp_set_user_error(parser, "invalid destination \"%s\"", field);
+      result= -1;
+      break;
+    }
+    for (index= 0; index < num_loads; index++) {
+      field= lrp_get_field(parser, index + 2);
+      if (str2vload(field, &loads[index])) {
+	lrp_set_user_error(parser, "invalid load \"%s\"", field);
+	result= -1;
+	break;
+      }
+    }
+    if (result != 0)
+      break;
+    if (node_load_flow_vector(node, NET_ADDR_ANY, dst_addr, loads,
+			      num_loads, stats) < 0) {
+      lrp_set_user_error(parser, "could not load flow to \"%s\"",
+			 lrp_get_field(parser, 1));
+      result= -1;
+      break;
+    }
+  }
+  if (loads != NULL)
+    FREE(loads);
+  return result;
+}
+
+// ----- cli_net_traffic_load_vectors -------------------------------
+/**
+ * context: {}
+ * tokens : {file}
+ * options: {--summary}
+ */
+int cli_net_traffic_load_vectors(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  lrp_t * parser= lrp_create(4096, " \t");
+  flow_stats_t stats;
+  int result;
+
+  flow_stats_init(&stats);
+  result= lrp_open(parser, arg);
+  if (result == 0)
+    result= _traffic_load_vectors(parser, &stats);
+  if (result != 0)
+    cli_set_user_error(cli_get(), "could not load traffic vectors \"%s\" "
+		       "(%s%s)", arg, lrp_strerror(parser),
+		       lrp_strerrorloc(parser));
+  lrp_close(parser);
+  lrp_destroy(&parser);
+  if (result != 0)
+    return CLI_ERROR_COMMAND_FAILED;
+
+  if (cli_has_opt_value(cmd, "summary"))
+    flow_stats_dump(gdsout, &stats);
+  return CLI_SUCCESS;
+}
+
+// ----- cli_net_traffic_save_vectors -------------------------------
+/**
+ * context: {}
+ * tokens : {file}
+ */
+int cli_net_traffic_save_vectors(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  gds_stream_t * stream;
+
+  stream= stream_create_file(arg);
+  if (stream == NULL) {
+    cli_set_user_error(cli_get(), "could not create \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  network_links_save_vectors(stream, network_get_default());
+  stream_destroy(&stream);
+  return CLI_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -823,6 +1116,36 @@ static void _register_net_export(cli_cmd_t * parent)
   cli_add_opt(cmd, cli_opt("output=", NULL));
 }
 
+// -----[ _register_net_generate ]-----------------------------------
+static void _register_net_generate(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd= cli_add_cmd(parent, cli_cmd("generate", cli_net_generate));
+  cli_add_arg(cmd, cli_arg("model", NULL));
+  cli_add_arg(cmd, cli_arg("num-nodes", NULL));
+  cli_add_opt(cmd, cli_opt("seed=", NULL));
+  cli_add_opt(cmd, cli_opt("k=", NULL));
+  cli_add_opt(cmd, cli_opt("radius=", NULL));
+  cli_add_opt(cmd, cli_opt("alpha=", NULL));
+  cli_add_opt(cmd, cli_opt("beta=", NULL));
+  cli_add_opt(cmd, cli_opt("weights=", NULL));
+  cli_add_opt(cmd, cli_opt("capacity=", NULL));
+  cli_add_opt(cmd, cli_opt("base=", NULL));
+  cli_add_opt(cmd, cli_opt("domain=", NULL));
+  cli_add_opt(cmd, cli_opt("bgp=", NULL));
+  cli_add_opt(cmd, cli_opt("ibgp=", NULL));
+  cli_add_opt(cmd, cli_opt("rrs=", NULL));
+  cli_add_opt(cmd, cli_opt("clients=", NULL));
+  cli_add_opt(cmd, cli_opt("ebgp=", NULL));
+  cli_add_opt(cmd, cli_opt("prefixes=", NULL));
+}
+
+// -----[ _register_net_import ]-------------------------------------
+static void _register_net_import(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd= cli_add_cmd(parent, cli_cmd("import", cli_net_import));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+}
+
 // -----[ _register_net_link_show ]----------------------------------
 static void cli_register_net_link_show(cli_cmd_t * parent)
 {
@@ -911,6 +1234,13 @@ static void _register_net_traffic(cli_cmd_t * parent)
   cli_add_opt(cmd, cli_opt("summary", NULL));
   cmd= cli_add_cmd(group, cli_cmd("save", cli_net_traffic_save));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("load-vectors",
+				  cli_net_traffic_load_vectors));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("summary", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("save-vectors",
+				  cli_net_traffic_save_vectors));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
 }
 
 // -----[ cli_register_net ]-----------------------------------------
@@ -920,6 +1250,8 @@ void cli_register_net(cli_cmd_t * parent)
   _register_net_add(group);
   cli_register_net_domain(group);
   _register_net_export(group);
+  _register_net_generate(group);
+  _register_net_import(group);
   _register_net_link(group);
   _register_net_links(group);
   _register_net_ntf(group);
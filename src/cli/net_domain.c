@@ -17,13 +17,21 @@
 #include <libgds/cli.h>
 #include <libgds/cli_ctx.h>
 #include <libgds/cli_params.h>
+#include <libgds/memory.h>
 #include <libgds/stream.h>
+#include <libgds/str_util.h>
 
 #include <cli/common.h>
 #include <cli/context.h>
+#include <net/error.h>
 #include <net/igp_domain.h>
+#include <net/igp_matrix.h>
+#include <net/igp_opt.h>
+#include <net/iface.h>
+#include <net/node.h>
 #include <net/ospf_deflection.h>
 #include <net/util.h>
+#include <util/lrp.h>
 
 // -----[ cli_net_add_domain ]---------------------------------------
 /**
@@ -48,12 +56,7 @@ int cli_net_add_domain(cli_ctx_t * ctx, cli_cmd_t * cmd)
   if (!strcmp(arg_type, "igp")) {
     type= IGP_DOMAIN_IGP;
   } else if (!strcmp(arg_type, "ospf")) {
-#ifdef OSPF_SUPPORT 
     type= IGP_DOMAIN_OSPF;
-#else 
-    cli_set_user_error(cli_get(), "not compiled with OSPF support");
-    return CLI_ERROR_COMMAND_FAILED;
-#endif    
   } else {
     cli_set_user_error(cli_get(), "unknown domain type %s", arg_type);
     return CLI_ERROR_COMMAND_FAILED;
@@ -146,18 +149,284 @@ static int cli_net_domain_show_nodes(cli_ctx_t * ctx, cli_cmd_t * cmd)
 /**
  * context: {domain}
  * tokens: {}
+ * options: {--keep-spt, --threads=<num>}
  */
 static int cli_net_domain_compute(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   igp_domain_t * domain= _igp_domain_from_context(ctx);
   int keep_spt= cli_has_opt_value(cmd, "keep-spt");
-  if (igp_domain_compute(domain, keep_spt) != CLI_SUCCESS) {
+  const char * opt= cli_get_opt_value(cmd, "threads");
+  unsigned int num_threads= 1;
+
+  if ((opt != NULL) &&
+      (str_as_uint(opt, &num_threads) || (num_threads < 1))) {
+    cli_set_user_error(cli_get(), "invalid number of threads \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (igp_domain_compute_parallel(domain, keep_spt, num_threads)
+      != CLI_SUCCESS) {
     cli_set_user_error(cli_get(), "IGP routes computation failed.\n");
     return CLI_ERROR_COMMAND_FAILED;
   }
   return CLI_SUCCESS;
 }
 
+// -----[ _check_weights_load ]--------------------------------------
+/**
+ * Load candidate weight changes from a file. Each line is made of
+ * a node address, an interface identifier and a weight.
+ */
+static int _check_weights_load(lrp_t * parser, igp_weight_change_t ** changes,
+			       unsigned int * num_changes)
+{
+  unsigned int num_fields, size= 0;
+  const char * field;
+  net_node_t * node;
+  net_iface_id_t iface_id;
+  net_iface_t * iface;
+  igp_weight_t weight;
+
+  while (lrp_get_next_line(parser)) {
+    if (lrp_get_num_fields(parser, &num_fields) < 0)
+      return -1;
+    if (num_fields != 3) {
+      lrp_set_user_error(parser, "incorrect number of fields (3 expected)");
+      return -1;
+    }
+    field= lrp_get_field(parser, 0);
+    if (str2node(field, &node)) {
+      lrp_set_user_error(parser, "unknown node \"%s\"", field);
+      return -1;
+    }
+    field= lrp_get_field(parser, 1);
+    if ((net_iface_str2id(field, &iface_id) != ESUCCESS) ||
+	((iface= node_find_iface(node, iface_id)) == NULL)) {
+      lrp_set_user_error(parser, "unknown interface \"%s\"", field);
+      return -1;
+    }
+    field= lrp_get_field(parser, 2);
+    if (str2weight(field, &weight) || (weight == 0)) {
+      lrp_set_user_error(parser, "invalid weight \"%s\"", field);
+      return -1;
+    }
+    if (*num_changes >= size) {
+      size= (size == 0)?16:2*size;
+      *changes= (igp_weight_change_t *)
+	REALLOC(*changes, size * sizeof(igp_weight_change_t));
+    }
+    (*changes)[*num_changes].iface= iface;
+    (*changes)[(*num_changes)++].weight= weight;
+  }
+  return 0;
+}
+
+// -----[ cli_net_domain_check_weights ]-----------------------------
+/**
+ * Evaluate candidate weight changes against the distance matrix of
+ * the domain. For each change, print the number of (source,
+ * destination) pairs whose distance changes, whose traffic is
+ * deflected and that become unreachable, and the number of
+ * destinations exposed to a transient forwarding loop.
+ *
+ * context: {domain}
+ * tokens: {file}
+ * options: {--threads=<num>}
+ */
+static int cli_net_domain_check_weights(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  igp_domain_t * domain= _igp_domain_from_context(ctx);
+  const char * filename= cli_get_arg_value(cmd, 0);
+  const char * opt= cli_get_opt_value(cmd, "threads");
+  unsigned int num_threads= 1, num_changes= 0, index;
+  igp_weight_change_t * changes= NULL;
+  igp_change_report_t * reports;
+  lrp_t * parser;
+  int result;
+
+  if ((opt != NULL) &&
+      (str_as_uint(opt, &num_threads) || (num_threads < 1))) {
+    cli_set_user_error(cli_get(), "invalid number of threads \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  parser= lrp_create(1024, " \t");
+  result= lrp_open(parser, filename);
+  if (result == 0)
+    result= _check_weights_load(parser, &changes, &num_changes);
+  if (result != 0) {
+    cli_set_user_error(cli_get(), "could not load \"%s\" (%s%s)", filename,
+		       lrp_strerror(parser), lrp_strerrorloc(parser));
+    lrp_close(parser);
+    lrp_destroy(&parser);
+    if (changes != NULL)
+      FREE(changes);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  lrp_close(parser);
+  lrp_destroy(&parser);
+
+  reports= (igp_change_report_t *)
+    MALLOC((num_changes + 1) * sizeof(igp_change_report_t));
+  result= igp_matrix_eval(igp_matrix_get(domain), changes, num_changes,
+			  reports, num_threads);
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "interface not in domain %d", domain->id);
+  } else {
+    for (index= 0; index < num_changes; index++) {
+      node_dump_id(gdsout, changes[index].iface->owner);
+      stream_printf(gdsout, "\t");
+      net_iface_dump_id(gdsout, changes[index].iface);
+      stream_printf(gdsout, "\t%u\tchanged:%u\tdeflected:%u"
+		    "\tunreachable:%u\tloops:%u\n",
+		    changes[index].weight, reports[index].num_changed,
+		    reports[index].num_deflected,
+		    reports[index].num_unreachable, reports[index].num_loops);
+    }
+  }
+  FREE(reports);
+  if (changes != NULL)
+    FREE(changes);
+  return (result == ESUCCESS)?CLI_SUCCESS:CLI_ERROR_COMMAND_FAILED;
+}
+
+// -----[ _optimize_load_demands ]-----------------------------------
+/**
+ * Load a traffic matrix in the format of "net traffic load" (source,
+ * source interface, destination, volume). The source and the
+ * destination must be routers of the domain.
+ */
+static int _optimize_load_demands(lrp_t * parser, igp_opt_t * opt)
+{
+  unsigned int num_fields;
+  const char * field;
+  net_node_t * src, * dst;
+  net_link_vload_t load;
+
+  while (lrp_get_next_line(parser)) {
+    if (lrp_get_num_fields(parser, &num_fields) < 0)
+      return -1;
+    if (num_fields != 4) {
+      lrp_set_user_error(parser, "incorrect number of fields (4 expected)");
+      return -1;
+    }
+    field= lrp_get_field(parser, 0);
+    if (str2node(field, &src)) {
+      lrp_set_user_error(parser, "unknown source \"%s\"", field);
+      return -1;
+    }
+    field= lrp_get_field(parser, 2);
+    if (str2node(field, &dst)) {
+      lrp_set_user_error(parser, "unknown destination \"%s\"", field);
+      return -1;
+    }
+    field= lrp_get_field(parser, 3);
+    if (str2vload(field, &load)) {
+      lrp_set_user_error(parser, "invalid load \"%s\"", field);
+      return -1;
+    }
+    if (igp_opt_add_demand(opt, src, dst, load) != ESUCCESS) {
+      lrp_set_user_error(parser, "flow not in domain");
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// -----[ _optimize_opt_uint ]---------------------------------------
+static int _optimize_opt_uint(cli_cmd_t * cmd, const char * name,
+			      unsigned int * value)
+{
+  const char * opt= cli_get_opt_value(cmd, name);
+  if ((opt != NULL) && str_as_uint(opt, value)) {
+    cli_set_user_error(cli_get(), "invalid %s \"%s\"", name, opt);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ cli_net_domain_optimize_weights ]--------------------------
+/**
+ * Search the IGP weights that minimize the objective for a traffic
+ * matrix. The search trace is printed, followed by the weights that
+ * differ from the current ones. The weights are only set on the
+ * interfaces if --apply is given.
+ *
+ * context: {domain}
+ * tokens: {file}
+ * options: {--objective=max-util, --iterations=<num>,
+ *           --max-weight=<num>, --candidates=<num>, --seed=<num>,
+ *           --threads=<num>, --apply}
+ */
+static int cli_net_domain_optimize_weights(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  igp_domain_t * domain= _igp_domain_from_context(ctx);
+  const char * filename= cli_get_arg_value(cmd, 0);
+  igp_opt_params_t params= {
+    .objective= IGP_OPT_MAX_UTIL,
+    .max_iterations= 100,
+    .max_weight= 20,
+    .num_candidates= 0,
+    .seed= 0,
+    .num_threads= 1,
+  };
+  unsigned int max_weight= params.max_weight;
+  unsigned long seed;
+  const char * opt;
+  lrp_t * parser;
+  igp_opt_t * igp_opt;
+  int result;
+
+  opt= cli_get_opt_value(cmd, "objective");
+  if ((opt != NULL) && strcmp(opt, "max-util")) {
+    cli_set_user_error(cli_get(), "unknown objective \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (_optimize_opt_uint(cmd, "iterations", &params.max_iterations) ||
+      _optimize_opt_uint(cmd, "max-weight", &max_weight) ||
+      _optimize_opt_uint(cmd, "candidates", &params.num_candidates) ||
+      _optimize_opt_uint(cmd, "threads", &params.num_threads))
+    return CLI_ERROR_COMMAND_FAILED;
+  params.max_weight= max_weight;
+  opt= cli_get_opt_value(cmd, "seed");
+  if (opt != NULL) {
+    if (str_as_ulong(opt, &seed)) {
+      cli_set_user_error(cli_get(), "invalid seed \"%s\"", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    params.seed= seed;
+  }
+
+  igp_opt= igp_opt_create(domain);
+  parser= lrp_create(1024, " \t");
+  result= lrp_open(parser, filename);
+  if (result == 0)
+    result= _optimize_load_demands(parser, igp_opt);
+  if (result != 0) {
+    cli_set_user_error(cli_get(), "could not load \"%s\" (%s%s)", filename,
+		       lrp_strerror(parser), lrp_strerrorloc(parser));
+    lrp_close(parser);
+    lrp_destroy(&parser);
+    igp_opt_destroy(&igp_opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  lrp_close(parser);
+  lrp_destroy(&parser);
+
+  result= igp_opt_search(igp_opt, &params, gdsout);
+  if (result == EUNSUPPORTED) {
+    cli_set_user_error(cli_get(), "too many candidates (at most %u, "
+		       "use --candidates)", IGP_OPT_MAX_CANDIDATES);
+  } else if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "invalid search parameters");
+  } else {
+    igp_opt_dump_weights(gdsout, igp_opt);
+    if (cli_has_opt_value(cmd, "apply"))
+      result= igp_opt_apply(igp_opt);
+  }
+  igp_opt_destroy(&igp_opt);
+  return (result == ESUCCESS)?CLI_SUCCESS:CLI_ERROR_COMMAND_FAILED;
+}
+
 // -----[ cli_net_domain_links_igp_weight ]--------------------------
 /**
  * context: {domain}
@@ -210,6 +479,21 @@ void cli_register_net_domain(cli_cmd_t * parent)
   cli_add_arg(group, cli_arg("id", NULL));
   cmd= cli_cmd("compute", cli_net_domain_compute);
   cli_add_opt(cmd, cli_opt("keep-spt", NULL));
+  cli_add_opt(cmd, cli_opt("threads=", NULL));
+  cli_add_cmd(group, cmd);
+  cmd= cli_cmd("check-weights", cli_net_domain_check_weights);
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("threads=", NULL));
+  cli_add_cmd(group, cmd);
+  cmd= cli_cmd("optimize-weights", cli_net_domain_optimize_weights);
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("objective=", NULL));
+  cli_add_opt(cmd, cli_opt("iterations=", NULL));
+  cli_add_opt(cmd, cli_opt("max-weight=", NULL));
+  cli_add_opt(cmd, cli_opt("candidates=", NULL));
+  cli_add_opt(cmd, cli_opt("seed=", NULL));
+  cli_add_opt(cmd, cli_opt("threads=", NULL));
+  cli_add_opt(cmd, cli_opt("apply", NULL));
   cli_add_cmd(group, cmd);
   /*cli_add_cmd(group, cli_cmd("links-igp-weight",
     cli_net_domain_links_igp_weight));*/
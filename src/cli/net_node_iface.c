@@ -94,6 +94,25 @@ static int cli_iface_igpweight(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_iface_area ]-------------------------------------------
+/**
+ * context: {iface}
+ * tokens: {area}
+ */
+static int cli_iface_area(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  net_iface_t * iface= _iface_from_context(ctx);
+  const char * arg= cli_get_arg_value(cmd, 0);
+  unsigned int area;
+
+  if (str_as_uint(arg, &area)) {
+    cli_set_user_error(cli_get(), "invalid area \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  iface->area= area;
+  return CLI_SUCCESS;
+}
+
 // -----[ cli_iface_down ]-------------------------------------------
 /**
  * context: {iface}
@@ -245,6 +264,8 @@ void cli_register_net_node_iface(cli_cmd_t * parent)
   cli_add_arg(group, cli_arg("address|prefix", NULL));
   cmd= cli_add_cmd(group, cli_cmd("igp-weight", cli_iface_igpweight));
   cli_add_arg(cmd, cli_arg("weight", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("area", cli_iface_area));
+  cli_add_arg(cmd, cli_arg("area", NULL));
   cmd= cli_add_cmd(group, cli_cmd("down", cli_iface_down));
   cmd= cli_add_cmd(group, cli_cmd("up", cli_iface_up));
   _register_net_node_iface_load(group);
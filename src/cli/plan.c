@@ -0,0 +1,937 @@
+// ==================================================================
+// @(#)plan.c
+//
+// Compiled CLI scripts (command plans).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdarg.h>
+#include <string.h>
+
+#include <libgds/cli_ctx.h>
+#include <libgds/memory.h>
+#include <libgds/stream.h>
+
+#include <bgp/as.h>
+#include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <cli/plan.h>
+#include <net/error.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/prefix.h>
+#include <net/protocol.h>
+#include <net/util.h>
+
+#define PLAN_MAGIC      "CBGPPL\0\2"
+#define PLAN_MAGIC_SIZE 8
+#define PLAN_MAX_TOKENS 12
+#define PLAN_MAX_LINE   1024
+
+// -----[ cli_plan_t ]-----------------------------------------------
+struct cli_plan_t {
+  unsigned int    num_ops;
+  unsigned int    size_ops;
+  cli_plan_op_t * ops;
+  /** Address of each node handle. */
+  unsigned int    num_handles;
+  unsigned int    size_handles;
+  net_addr_t    * addrs;
+  /** Text of the raw lines (NUL-terminated). */
+  size_t          text_len;
+  size_t          text_size;
+  char          * text;
+  /** Address -> handle+1 (compilation only). */
+  uint32_t      * index;
+  unsigned int    index_size;
+  /** Resolved nodes (execution only). A node is valid if its epoch
+      is the current epoch, which changes each time a raw line is
+      executed. */
+  net_node_t   ** nodes;
+  uint32_t      * epochs;
+  uint32_t        epoch;
+};
+
+// -----[ _plan_header_t ]-------------------------------------------
+typedef struct {
+  char     magic[PLAN_MAGIC_SIZE];
+  uint32_t op_size;
+  uint32_t num_ops;
+  uint32_t num_handles;
+  uint32_t reserved;
+  uint64_t text_len;
+  uint64_t src_size;
+  uint64_t src_hash;
+} _plan_header_t;
+
+// -----[ _plan_create ]---------------------------------------------
+static cli_plan_t * _plan_create()
+{
+  cli_plan_t * plan= (cli_plan_t *) MALLOC(sizeof(cli_plan_t));
+  memset(plan, 0, sizeof(cli_plan_t));
+  return plan;
+}
+
+// -----[ cli_plan_destroy ]-----------------------------------------
+void cli_plan_destroy(cli_plan_t ** plan_ref)
+{
+  cli_plan_t * plan= *plan_ref;
+
+  if (plan == NULL)
+    return;
+  if (plan->ops != NULL)
+    FREE(plan->ops);
+  if (plan->addrs != NULL)
+    FREE(plan->addrs);
+  if (plan->text != NULL)
+    FREE(plan->text);
+  if (plan->index != NULL)
+    FREE(plan->index);
+  if (plan->nodes != NULL) {
+    FREE(plan->nodes);
+    FREE(plan->epochs);
+  }
+  FREE(plan);
+  *plan_ref= NULL;
+}
+
+// -----[ cli_plan_num_ops ]-----------------------------------------
+unsigned int cli_plan_num_ops(cli_plan_t * plan)
+{
+  return plan->num_ops;
+}
+
+// -----[ cli_plan_num_compiled ]------------------------------------
+unsigned int cli_plan_num_compiled(cli_plan_t * plan)
+{
+  unsigned int index, count= 0;
+  for (index= 0; index < plan->num_ops; index++)
+    if (plan->ops[index].type != CLI_PLAN_RAW)
+      count++;
+  return count;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// COMPILATION
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _plan_add_op ]---------------------------------------------
+static cli_plan_op_t * _plan_add_op(cli_plan_t * plan, uint8_t type,
+				    unsigned int line)
+{
+  cli_plan_op_t * op;
+
+  if (plan->num_ops == plan->size_ops) {
+    plan->size_ops= (plan->size_ops == 0)?1024:2*plan->size_ops;
+    plan->ops= (cli_plan_op_t *)
+      REALLOC(plan->ops, plan->size_ops*sizeof(cli_plan_op_t));
+  }
+  op= &plan->ops[plan->num_ops++];
+  memset(op, 0, sizeof(cli_plan_op_t));
+  op->type= type;
+  op->line= line;
+  return op;
+}
+
+// -----[ _plan_add_text ]-------------------------------------------
+static uint32_t _plan_add_text(cli_plan_t * plan, const char * text)
+{
+  size_t len= strlen(text)+1;
+  uint32_t offset= plan->text_len;
+
+  if (plan->text_len + len > plan->text_size) {
+    if (plan->text_size == 0)
+      plan->text_size= 4096;
+    while (plan->text_len + len > plan->text_size)
+      plan->text_size*= 2;
+    plan->text= (char *) REALLOC(plan->text, plan->text_size);
+  }
+  memcpy(plan->text+plan->text_len, text, len);
+  plan->text_len+= len;
+  return offset;
+}
+
+// -----[ _plan_hash ]-----------------------------------------------
+static inline unsigned int _plan_hash(net_addr_t addr, unsigned int size)
+{
+  return (addr * 2654435761U) & (size-1);
+}
+
+// -----[ _plan_handle ]---------------------------------------------
+/** Intern a node address. */
+static uint32_t _plan_handle(cli_plan_t * plan, net_addr_t addr)
+{
+  unsigned int index, pos;
+
+  // Keep the load of the index below 1/2
+  if (2*(plan->num_handles+1) > plan->index_size) {
+    if (plan->index != NULL)
+      FREE(plan->index);
+    plan->index_size= (plan->index_size == 0)?1024:2*plan->index_size;
+    plan->index= (uint32_t *) MALLOC(plan->index_size*sizeof(uint32_t));
+    memset(plan->index, 0, plan->index_size*sizeof(uint32_t));
+    for (index= 0; index < plan->num_handles; index++) {
+      pos= _plan_hash(plan->addrs[index], plan->index_size);
+      while (plan->index[pos] != 0)
+	pos= (pos+1) & (plan->index_size-1);
+      plan->index[pos]= index+1;
+    }
+  }
+
+  pos= _plan_hash(addr, plan->index_size);
+  while (plan->index[pos] != 0) {
+    if (plan->addrs[plan->index[pos]-1] == addr)
+      return plan->index[pos]-1;
+    pos= (pos+1) & (plan->index_size-1);
+  }
+
+  if (plan->num_handles == plan->size_handles) {
+    plan->size_handles= (plan->size_handles == 0)?1024:2*plan->size_handles;
+    plan->addrs= (net_addr_t *)
+      REALLOC(plan->addrs, plan->size_handles*sizeof(net_addr_t));
+  }
+  plan->addrs[plan->num_handles]= addr;
+  plan->index[pos]= ++plan->num_handles;
+  return plan->num_handles-1;
+}
+
+// -----[ _plan_node ]-----------------------------------------------
+static int _plan_node(cli_plan_t * plan, const char * str, uint32_t * handle)
+{
+  net_addr_t addr;
+  if (str2address(str, &addr))
+    return -1;
+  *handle= _plan_handle(plan, addr);
+  return 0;
+}
+
+// -----[ _plan_compile_words ]--------------------------------------
+/**
+ * Compile a tokenized line. Returns -1 if the line must be kept as a
+ * raw line.
+ */
+static int _plan_compile_words(cli_plan_t * plan, unsigned int line,
+			       char ** words, unsigned int num_words,
+			       char ** opts, unsigned int num_opts)
+{
+  cli_plan_op_t op;
+  unsigned int index;
+  unsigned int domain;
+  asn_t asn;
+
+  memset(&op, 0, sizeof(op));
+
+  if (!strcmp(words[0], "net")) {
+
+    if ((num_words == 4) && !strcmp(words[1], "add") &&
+	!strcmp(words[2], "node")) {
+      for (index= 0; index < num_opts; index++)
+	if (!strcmp(opts[index], "--no-loopback"))
+	  op.flags|= CLI_PLAN_FLAG_NO_LOOPBACK;
+	else
+	  return -1;
+      if (_plan_node(plan, words[3], &op.node))
+	return -1;
+      op.type= CLI_PLAN_NET_ADD_NODE;
+
+    } else if ((num_words == 5) && !strcmp(words[1], "add") &&
+	       !strcmp(words[2], "link")) {
+      for (index= 0; index < num_opts; index++)
+	if (!strncmp(opts[index], "--bw=", 5)) {
+	  if (str2capacity(opts[index]+5, &op.capacity))
+	    return -1;
+	} else if (!strncmp(opts[index], "--delay=", 8)) {
+	  if (str2delay(opts[index]+8, &op.delay))
+	    return -1;
+	} else
+	  return -1;
+      if (_plan_node(plan, words[3], &op.node) ||
+	  _plan_node(plan, words[4], &op.arg))
+	return -1;
+      op.type= CLI_PLAN_NET_ADD_LINK;
+
+    } else if ((num_words == 5) && (num_opts == 0) &&
+	       !strcmp(words[1], "node") && !strcmp(words[3], "domain")) {
+      if (str2domain_id(words[4], &domain) ||
+	  _plan_node(plan, words[2], &op.node))
+	return -1;
+      op.arg= domain;
+      op.type= CLI_PLAN_NET_NODE_DOMAIN;
+
+    } else
+      return -1;
+
+  } else if (!strcmp(words[0], "bgp") && (num_opts == 0)) {
+
+    if ((num_words == 5) && !strcmp(words[1], "add") &&
+	!strcmp(words[2], "router")) {
+      if (str2asn(words[3], &asn) ||
+	  _plan_node(plan, words[4], &op.node))
+	return -1;
+      op.arg= asn;
+      op.type= CLI_PLAN_BGP_ADD_ROUTER;
+
+    } else if ((num_words == 7) && !strcmp(words[1], "router") &&
+	       !strcmp(words[3], "add") && !strcmp(words[4], "peer")) {
+      if (str2asn(words[5], &asn) || str2address(words[6], &op.addr) ||
+	  _plan_node(plan, words[2], &op.node))
+	return -1;
+      op.arg= asn;
+      op.type= CLI_PLAN_BGP_ADD_PEER;
+
+    } else if ((num_words == 6) && !strcmp(words[1], "router") &&
+	       !strcmp(words[3], "peer") && !strcmp(words[5], "up")) {
+      if (str2address(words[4], &op.addr) ||
+	  _plan_node(plan, words[2], &op.node))
+	return -1;
+      op.type= CLI_PLAN_BGP_PEER_UP;
+
+    } else
+      return -1;
+
+  } else
+    return -1;
+
+  op.line= line;
+  *_plan_add_op(plan, op.type, line)= op;
+  return 0;
+}
+
+// -----[ _plan_compile_line ]---------------------------------------
+static void _plan_compile_line(cli_plan_t * plan, unsigned int line,
+			       const char * text)
+{
+  char buf[PLAN_MAX_LINE];
+  char * words[PLAN_MAX_TOKENS];
+  char * opts[PLAN_MAX_TOKENS];
+  unsigned int num_words= 0, num_opts= 0;
+  char * token;
+
+  // Skip blank lines and comments
+  text+= strspn(text, " \t");
+  if ((*text == '\0') || (*text == '#'))
+    return;
+
+  // Parameters, quotes and long lines are left to the CLI
+  if ((strpbrk(text, "$\"'\\") == NULL) && (strlen(text) < PLAN_MAX_LINE)) {
+    strcpy(buf, text);
+    for (token= strtok(buf, " \t"); token != NULL;
+	 token= strtok(NULL, " \t")) {
+      if (num_words + num_opts == PLAN_MAX_TOKENS) {
+	num_words= 0;
+	break;
+      }
+      if (!strncmp(token, "--", 2))
+	opts[num_opts++]= token;
+      else
+	words[num_words++]= token;
+    }
+    if ((num_words > 0) &&
+	!_plan_compile_words(plan, line, words, num_words, opts, num_opts))
+      return;
+  }
+
+  _plan_add_op(plan, CLI_PLAN_RAW, line)->node= _plan_add_text(plan, text);
+}
+
+// -----[ _plan_read_line ]------------------------------------------
+/**
+ * Read a line (without its end of line). The buffer is enlarged if
+ * needed.
+ */
+static int _plan_read_line(FILE * stream, char ** buf_ref, size_t * size_ref)
+{
+  size_t len= 0;
+
+  if (*buf_ref == NULL) {
+    *size_ref= PLAN_MAX_LINE;
+    *buf_ref= (char *) MALLOC(*size_ref);
+  }
+
+  while (fgets(*buf_ref+len, *size_ref-len, stream) != NULL) {
+    len+= strlen(*buf_ref+len);
+    if ((len > 0) && ((*buf_ref)[len-1] == '\n')) {
+      (*buf_ref)[--len]= '\0';
+      if ((len > 0) && ((*buf_ref)[len-1] == '\r'))
+	(*buf_ref)[--len]= '\0';
+      return 0;
+    }
+    *size_ref*= 2;
+    *buf_ref= (char *) REALLOC(*buf_ref, *size_ref);
+  }
+  return (len > 0)?0:-1;
+}
+
+// -----[ cli_plan_compile ]-----------------------------------------
+cli_plan_t * cli_plan_compile(FILE * stream)
+{
+  cli_plan_t * plan= _plan_create();
+  unsigned int line= 0;
+  size_t size= 0;
+  char * buf= NULL;
+
+  while (_plan_read_line(stream, &buf, &size) == 0)
+    _plan_compile_line(plan, ++line, buf);
+  if (buf != NULL)
+    FREE(buf);
+  if (plan->index != NULL) {
+    FREE(plan->index);
+    plan->index= NULL;
+    plan->index_size= 0;
+  }
+  return plan;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// EXECUTION
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _plan_error ]----------------------------------------------
+static int _plan_error(cli_t * cli, const cli_plan_op_t * op,
+		       const char * format, ...)
+{
+  char msg[256];
+  va_list ap;
+
+  va_start(ap, format);
+  vsnprintf(msg, sizeof(msg), format, ap);
+  va_end(ap);
+  cli_set_user_error(cli, "%s", msg);
+  cli->error.line_number= op->line;
+  return CLI_ERROR_COMMAND_FAILED;
+}
+
+// -----[ _plan_addr ]-----------------------------------------------
+/** Format a node address (for error messages). */
+static const char * _plan_addr(net_addr_t addr, char * buf, size_t size)
+{
+  ip_address_to_string(addr, buf, size);
+  return buf;
+}
+
+// -----[ _plan_resolve ]--------------------------------------------
+static inline net_node_t * _plan_resolve(cli_plan_t * plan, uint32_t handle)
+{
+  if (plan->epochs[handle] != plan->epoch) {
+    plan->nodes[handle]= network_find_node(network_get_default(),
+					   plan->addrs[handle]);
+    if (plan->nodes[handle] == NULL)
+      return NULL;
+    plan->epochs[handle]= plan->epoch;
+  }
+  return plan->nodes[handle];
+}
+
+// -----[ _plan_resolve_router ]-------------------------------------
+static inline bgp_router_t * _plan_resolve_router(cli_plan_t * plan,
+						  uint32_t handle)
+{
+  net_node_t * node= _plan_resolve(plan, handle);
+  net_protocol_t * protocol;
+
+  if (node == NULL)
+    return NULL;
+  protocol= protocols_get(node->protocols, NET_PROTOCOL_BGP);
+  if (protocol == NULL)
+    return NULL;
+  return (bgp_router_t *) protocol->handler;
+}
+
+// -----[ _plan_op_to_str ]------------------------------------------
+/** Rebuild the text of a compiled operation. */
+static void _plan_op_to_str(cli_plan_t * plan, const cli_plan_op_t * op,
+			    char * buf, size_t size)
+{
+  char node[16], addr[16];
+
+  _plan_addr(plan->addrs[op->node], node, sizeof(node));
+  switch (op->type) {
+  case CLI_PLAN_NET_ADD_NODE:
+    snprintf(buf, size, "net add node %s%s", node,
+	     (op->flags & CLI_PLAN_FLAG_NO_LOOPBACK)?" --no-loopback":"");
+    break;
+  case CLI_PLAN_NET_ADD_LINK:
+    snprintf(buf, size, "net add link %s %s --bw=%u --delay=%u", node,
+	     _plan_addr(plan->addrs[op->arg], addr, sizeof(addr)),
+	     op->capacity, op->delay);
+    break;
+  case CLI_PLAN_NET_NODE_DOMAIN:
+    snprintf(buf, size, "net node %s domain %u", node, op->arg);
+    break;
+  case CLI_PLAN_BGP_ADD_ROUTER:
+    snprintf(buf, size, "bgp add router %u %s", op->arg, node);
+    break;
+  case CLI_PLAN_BGP_ADD_PEER:
+    snprintf(buf, size, "bgp router %s add peer %u %s", node, op->arg,
+	     _plan_addr(op->addr, addr, sizeof(addr)));
+    break;
+  case CLI_PLAN_BGP_PEER_UP:
+    snprintf(buf, size, "bgp router %s peer %s up", node,
+	     _plan_addr(op->addr, addr, sizeof(addr)));
+    break;
+  default:
+    buf[0]= '\0';
+  }
+}
+
+// -----[ _plan_exec_line ]------------------------------------------
+/** Execute a line through the CLI. The cached nodes are flushed. */
+static int _plan_exec_line(cli_t * cli, cli_plan_t * plan,
+			   const cli_plan_op_t * op, const char * text)
+{
+  int result= cli_execute_line(cli, text);
+  plan->epoch++;
+  if (result < 0)
+    cli->error.line_number= op->line;
+  return result;
+}
+
+// -----[ _plan_exec_add_node ]--------------------------------------
+static int _plan_exec_add_node(cli_t * cli, cli_plan_t * plan,
+			       const cli_plan_op_t * ops, unsigned int num)
+{
+  network_t * network= network_get_default();
+  net_node_t * node;
+  unsigned int index;
+  int error;
+
+  for (index= 0; index < num; index++) {
+    error= node_create(plan->addrs[ops[index].node], &node,
+		       (ops[index].flags & CLI_PLAN_FLAG_NO_LOOPBACK)?
+		       0:NODE_OPTIONS_LOOPBACK);
+    if (error != ESUCCESS)
+      return _plan_error(cli, &ops[index], "could not add node (%s)",
+			 network_strerror(error));
+    error= network_add_node(network, node);
+    if (error != ESUCCESS) {
+      node_destroy(&node);
+      return _plan_error(cli, &ops[index], "could not add node (%s)",
+			 network_strerror(error));
+    }
+    plan->nodes[ops[index].node]= node;
+    plan->epochs[ops[index].node]= plan->epoch;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _plan_exec_add_link ]--------------------------------------
+static int _plan_exec_add_link(cli_t * cli, cli_plan_t * plan,
+			       const cli_plan_op_t * ops, unsigned int num)
+{
+  net_node_t * src_node, * dst_node;
+  net_iface_t * iface;
+  unsigned int index;
+  char src[16], dst[16];
+  int error;
+
+  for (index= 0; index < num; index++) {
+    src_node= _plan_resolve(plan, ops[index].node);
+    if (src_node == NULL)
+      return _plan_error(cli, &ops[index], "could not find node \"%s\"",
+			 _plan_addr(plan->addrs[ops[index].node],
+				    src, sizeof(src)));
+    dst_node= _plan_resolve(plan, ops[index].arg);
+    if (dst_node == NULL)
+      return _plan_error(cli, &ops[index], "tail-end \"%s\" does not exist.",
+			 _plan_addr(plan->addrs[ops[index].arg],
+				    dst, sizeof(dst)));
+    error= net_link_create_rtr(src_node, dst_node, BIDIR, &iface);
+    if (error == ESUCCESS)
+      error= net_link_set_phys_attr(iface, ops[index].delay,
+				    ops[index].capacity, BIDIR);
+    if (error != ESUCCESS)
+      return _plan_error(cli, &ops[index], "could not add link %s -> %s (%s)",
+			 _plan_addr(src_node->rid, src, sizeof(src)),
+			 _plan_addr(dst_node->rid, dst, sizeof(dst)),
+			 network_strerror(error));
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _plan_exec_node_domain ]-----------------------------------
+static int _plan_exec_node_domain(cli_t * cli, cli_plan_t * plan,
+				  const cli_plan_op_t * ops, unsigned int num)
+{
+  igp_domain_t * domain= NULL;
+  net_node_t * node;
+  unsigned int index;
+  char buf[16];
+
+  for (index= 0; index < num; index++) {
+    node= _plan_resolve(plan, ops[index].node);
+    if (node == NULL)
+      return _plan_error(cli, &ops[index], "unable to find node \"%s\"",
+			 _plan_addr(plan->addrs[ops[index].node],
+				    buf, sizeof(buf)));
+    if ((domain == NULL) || (domain->id != ops[index].arg)) {
+      domain= network_find_igp_domain(network_get_default(), ops[index].arg);
+      if (domain == NULL)
+	return _plan_error(cli, &ops[index], "unknown domain \"%d\"",
+			   ops[index].arg);
+    }
+    if (igp_domain_contains_router(domain, node))
+      return _plan_error(cli, &ops[index], "could not add to domain \"%d\"",
+			 ops[index].arg);
+    igp_domain_add_router(domain, node);
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _plan_exec_add_router ]------------------------------------
+static int _plan_exec_add_router(cli_t * cli, cli_plan_t * plan,
+				 const cli_plan_op_t * ops, unsigned int num)
+{
+  net_node_t * node;
+  unsigned int index;
+  char buf[16];
+  int error;
+
+  for (index= 0; index < num; index++) {
+    node= _plan_resolve(plan, ops[index].node);
+    if (node == NULL)
+      return _plan_error(cli, &ops[index], "invalid node address \"%s\"",
+			 _plan_addr(plan->addrs[ops[index].node],
+				    buf, sizeof(buf)));
+    error= bgp_add_router(ops[index].arg, node, NULL);
+    if (error != ESUCCESS)
+      return _plan_error(cli, &ops[index], "could not add BGP router (%s)",
+			 network_strerror(error));
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _plan_peers_cmp ]------------------------------------------
+static int _plan_peers_cmp(const void * item1, const void * item2)
+{
+  const cli_plan_op_t * op1= *((const cli_plan_op_t **) item1);
+  const cli_plan_op_t * op2= *((const cli_plan_op_t **) item2);
+  if (op1->addr < op2->addr)
+    return -1;
+  return (op1->addr > op2->addr)?1:0;
+}
+
+// -----[ _plan_add_peers_bulk ]-------------------------------------
+/**
+ * Add the peers of a router that has no peer in a single insertion
+ * (see bgp_peers_add_bulk). Returns -1 (and changes nothing) if the
+ * peers can not be added in bulk, because of a duplicate or of an
+ * invalid address.
+ */
+static int _plan_add_peers_bulk(bgp_router_t * router,
+				const cli_plan_op_t * ops, unsigned int num)
+{
+  const cli_plan_op_t ** sorted;
+  bgp_peer_t ** new_peers;
+  unsigned int index;
+  int result= 0;
+
+  sorted= (const cli_plan_op_t **) MALLOC(num*sizeof(cli_plan_op_t *));
+  for (index= 0; index < num; index++)
+    sorted[index]= &ops[index];
+  qsort(sorted, num, sizeof(cli_plan_op_t *), _plan_peers_cmp);
+  for (index= 0; index < num; index++)
+    if (((index > 0) && (sorted[index-1]->addr == sorted[index]->addr)) ||
+	node_has_address(router->node, sorted[index]->addr)) {
+      result= -1;
+      break;
+    }
+
+  if (result == 0) {
+    new_peers= (bgp_peer_t **) MALLOC(num*sizeof(bgp_peer_t *));
+    for (index= 0; index < num; index++)
+      new_peers[index]= bgp_peer_create(sorted[index]->arg,
+					sorted[index]->addr, router);
+    if (bgp_peers_add_bulk(router->peers, new_peers, num) != ESUCCESS)
+      result= -1;
+    FREE(new_peers);
+  }
+  FREE(sorted);
+  return result;
+}
+
+// -----[ _plan_exec_add_peer ]--------------------------------------
+/**
+ * The consecutive peers of the same router are added together. */
+static int _plan_exec_add_peer(cli_t * cli, cli_plan_t * plan,
+			       const cli_plan_op_t * ops, unsigned int num)
+{
+  bgp_router_t * router;
+  unsigned int index, last;
+  char buf[16];
+
+  for (index= 0; index < num; index= last) {
+    router= _plan_resolve_router(plan, ops[index].node);
+    if (router == NULL)
+      return _plan_error(cli, &ops[index], "invalid node id \"%s\"",
+			 _plan_addr(plan->addrs[ops[index].node],
+				    buf, sizeof(buf)));
+    for (last= index+1;
+	 (last < num) && (ops[last].node == ops[index].node); last++);
+
+    if ((last-index > 1) && (bgp_peers_size(router->peers) == 0) &&
+	(_plan_add_peers_bulk(router, &ops[index], last-index) == 0))
+      continue;
+
+    for (; index < last; index++)
+      if (bgp_router_add_peer(router, ops[index].arg, ops[index].addr,
+			      NULL) != ESUCCESS)
+	return _plan_error(cli, &ops[index], "peer already exists");
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _plan_exec_peer_up ]---------------------------------------
+static int _plan_exec_peer_up(cli_t * cli, cli_plan_t * plan,
+			      const cli_plan_op_t * ops, unsigned int num)
+{
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  unsigned int index;
+  char buf[16];
+
+  for (index= 0; index < num; index++) {
+    router= _plan_resolve_router(plan, ops[index].node);
+    if (router == NULL)
+      return _plan_error(cli, &ops[index], "invalid node id \"%s\"",
+			 _plan_addr(plan->addrs[ops[index].node],
+				    buf, sizeof(buf)));
+    peer= bgp_router_find_peer(router, ops[index].addr);
+    if (peer == NULL)
+      return _plan_error(cli, &ops[index], "unknown peer");
+    if (bgp_peer_open_session(peer))
+      return _plan_error(cli, &ops[index], "could not open session");
+  }
+  return CLI_SUCCESS;
+}
+
+typedef int (*_plan_exec_f)(cli_t * cli, cli_plan_t * plan,
+			    const cli_plan_op_t * ops, unsigned int num);
+
+static _plan_exec_f EXEC_OPS[CLI_PLAN_OP_MAX]= {
+  NULL,
+  _plan_exec_add_node,
+  _plan_exec_add_link,
+  _plan_exec_node_domain,
+  _plan_exec_add_router,
+  _plan_exec_add_peer,
+  _plan_exec_peer_up,
+};
+
+// -----[ _plan_at_top_level ]---------------------------------------
+static inline int _plan_at_top_level(cli_t * cli)
+{
+  cli_cmd_t * cmd;
+  cli_get_cmd_context(cli, &cmd, NULL);
+  return (cmd == cli_get_root_cmd(cli));
+}
+
+// -----[ cli_plan_exec ]--------------------------------------------
+int cli_plan_exec(cli_t * cli, cli_plan_t * plan)
+{
+  const cli_plan_op_t * op;
+  unsigned int index, last;
+  char buf[128];
+  int result= CLI_SUCCESS;
+
+  if (plan->nodes == NULL) {
+    plan->nodes= (net_node_t **)
+      MALLOC((plan->num_handles+1)*sizeof(net_node_t *));
+    plan->epochs= (uint32_t *) MALLOC((plan->num_handles+1)*sizeof(uint32_t));
+  }
+  memset(plan->epochs, 0, (plan->num_handles+1)*sizeof(uint32_t));
+  plan->epoch= 1;
+
+  for (index= 0; index < plan->num_ops; index= last) {
+    op= &plan->ops[index];
+
+    if (op->type == CLI_PLAN_RAW) {
+      last= index+1;
+      result= _plan_exec_line(cli, plan, op, plan->text+op->node);
+
+    } else if (!_plan_at_top_level(cli)) {
+      // Let the CLI handle the command in the current context
+      last= index+1;
+      _plan_op_to_str(plan, op, buf, sizeof(buf));
+      result= _plan_exec_line(cli, plan, op, buf);
+
+    } else {
+      // Batch of operations of the same type
+      for (last= index+1;
+	   (last < plan->num_ops) && (plan->ops[last].type == op->type);
+	   last++);
+      result= EXEC_OPS[op->type](cli, plan, op, last-index);
+    }
+
+    if (result != CLI_SUCCESS)
+      break;
+  }
+  return result;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// CACHE
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ cli_plan_save ]--------------------------------------------
+int cli_plan_save(cli_plan_t * plan, const char * filename,
+		  uint64_t src_size, uint64_t src_hash)
+{
+  _plan_header_t header;
+  FILE * file;
+  int result= 0;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PLAN_MAGIC, PLAN_MAGIC_SIZE);
+  header.op_size= sizeof(cli_plan_op_t);
+  header.num_ops= plan->num_ops;
+  header.num_handles= plan->num_handles;
+  header.text_len= plan->text_len;
+  header.src_size= src_size;
+  header.src_hash= src_hash;
+
+  file= fopen(filename, "wb");
+  if (file == NULL)
+    return -1;
+  if ((fwrite(&header, sizeof(header), 1, file) != 1) ||
+      (fwrite(plan->ops, sizeof(cli_plan_op_t), plan->num_ops, file)
+       != plan->num_ops) ||
+      (fwrite(plan->addrs, sizeof(net_addr_t), plan->num_handles, file)
+       != plan->num_handles) ||
+      (fwrite(plan->text, 1, plan->text_len, file) != plan->text_len))
+    result= -1;
+  if (fclose(file) != 0)
+    result= -1;
+  if (result != 0)
+    remove(filename);
+  return result;
+}
+
+// -----[ cli_plan_load ]--------------------------------------------
+int cli_plan_load(const char * filename, uint64_t src_size,
+		  uint64_t src_hash, cli_plan_t ** plan_ref)
+{
+  _plan_header_t header;
+  cli_plan_t * plan;
+  unsigned int index;
+  FILE * file;
+
+  file= fopen(filename, "rb");
+  if (file == NULL)
+    return -1;
+  if ((fread(&header, sizeof(header), 1, file) != 1) ||
+      memcmp(header.magic, PLAN_MAGIC, PLAN_MAGIC_SIZE) ||
+      (header.op_size != sizeof(cli_plan_op_t)) ||
+      (header.src_size != src_size) || (header.src_hash != src_hash)) {
+    fclose(file);
+    return -1;
+  }
+
+  plan= _plan_create();
+  plan->num_ops= plan->size_ops= header.num_ops;
+  plan->num_handles= plan->size_handles= header.num_handles;
+  plan->text_len= plan->text_size= header.text_len;
+  plan->ops= (cli_plan_op_t *) MALLOC((plan->num_ops+1)*sizeof(cli_plan_op_t));
+  plan->addrs= (net_addr_t *) MALLOC((plan->num_handles+1)*sizeof(net_addr_t));
+  plan->text= (char *) MALLOC(plan->text_len+1);
+  if ((fread(plan->ops, sizeof(cli_plan_op_t), plan->num_ops, file)
+       != plan->num_ops) ||
+      (fread(plan->addrs, sizeof(net_addr_t), plan->num_handles, file)
+       != plan->num_handles) ||
+      (fread(plan->text, 1, plan->text_len, file) != plan->text_len)) {
+    fclose(file);
+    cli_plan_destroy(&plan);
+    return -1;
+  }
+  fclose(file);
+
+  // Check the operations (a corrupted plan must not be executed)
+  for (index= 0; index < plan->num_ops; index++)
+    if ((plan->ops[index].type >= CLI_PLAN_OP_MAX) ||
+	((plan->ops[index].type == CLI_PLAN_RAW)?
+	 (plan->ops[index].node >= plan->text_len):
+	 (plan->ops[index].node >= plan->num_handles)) ||
+	((plan->ops[index].type == CLI_PLAN_NET_ADD_LINK) &&
+	 (plan->ops[index].arg >= plan->num_handles))) {
+      cli_plan_destroy(&plan);
+      return -1;
+    }
+  plan->text[plan->text_len]= '\0';
+
+  *plan_ref= plan;
+  return 0;
+}
+
+// -----[ cli_plan_digest ]-----------------------------------------
+/**
+ * Compute the size and the FNV-1a hash of the content of a stream,
+ * from its current position to its end.
+ */
+int cli_plan_digest(FILE * stream, uint64_t * size_ref, uint64_t * hash_ref)
+{
+  unsigned char buf[4096];
+  uint64_t hash= 14695981039346656037ULL;
+  uint64_t size= 0;
+  size_t len, index;
+
+  while ((len= fread(buf, 1, sizeof(buf), stream)) > 0) {
+    for (index= 0; index < len; index++) {
+      hash^= buf[index];
+      hash*= 1099511628211ULL;
+    }
+    size+= len;
+  }
+  if (ferror(stream))
+    return -1;
+  *size_ref= size;
+  *hash_ref= hash;
+  return 0;
+}
+
+// -----[ cli_plan_get ]---------------------------------------------
+int cli_plan_get(const char * filename, cli_plan_t ** plan_ref)
+{
+  uint64_t size, hash;
+  char * cache;
+  FILE * file;
+
+  file= fopen(filename, "r");
+  if (file == NULL)
+    return -1;
+  if (cli_plan_digest(file, &size, &hash) != 0) {
+    fclose(file);
+    return -1;
+  }
+
+  cache= (char *) MALLOC(strlen(filename)+6);
+  strcpy(cache, filename);
+  strcat(cache, ".plan");
+
+  if (cli_plan_load(cache, size, hash, plan_ref) != 0) {
+    rewind(file);
+    *plan_ref= cli_plan_compile(file);
+    if (cli_plan_save(*plan_ref, cache, size, hash) != 0)
+      STREAM_DEBUG(STREAM_LEVEL_WARNING, "could not save plan \"%s\"\n",
+		   cache);
+  }
+  fclose(file);
+  FREE(cache);
+  return 0;
+}
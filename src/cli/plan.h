@@ -0,0 +1,158 @@
+// ==================================================================
+// @(#)plan.h
+//
+// Compiled CLI scripts (command plans).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * A command plan is a CLI script parsed once into a sequence of
+ * operations. The most frequent configuration commands are compiled
+ * into operations with pre-parsed arguments:
+ *
+ * \li net add node ADDR [--no-loopback]
+ * \li net add link ADDR ADDR [--bw=] [--delay=]
+ * \li net node ADDR domain ID
+ * \li bgp add router ASN ADDR
+ * \li bgp router ADDR add peer ASN ADDR
+ * \li bgp router ADDR peer ADDR up
+ *
+ * Any other line (or a line that can not be fully parsed, that uses
+ * parameters or quotes) is kept as is and executed through the CLI.
+ *
+ * The node addresses are interned: each operation refers to a node
+ * handle that is resolved once and cached while no CLI line is
+ * executed. Consecutive operations of the same type are executed as
+ * a batch (peers added to a router without peer are inserted in
+ * bulk).
+ *
+ * A compiled operation only applies at the top-level of the CLI. If
+ * a context is open when it is executed, its text is rebuilt and
+ * passed to the CLI.
+ *
+ * A plan can be saved along with the size and the hash of the
+ * content of its script (see cli_plan_get). The plan file is in host byte order
+ * and is only meant to be used as a local cache.
+ */
+
+#ifndef __CLI_PLAN_H__
+#define __CLI_PLAN_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <libgds/cli_ctx.h>
+
+// -----[ cli_plan_op_type_t ]---------------------------------------
+typedef enum {
+  CLI_PLAN_RAW,
+  CLI_PLAN_NET_ADD_NODE,
+  CLI_PLAN_NET_ADD_LINK,
+  CLI_PLAN_NET_NODE_DOMAIN,
+  CLI_PLAN_BGP_ADD_ROUTER,
+  CLI_PLAN_BGP_ADD_PEER,
+  CLI_PLAN_BGP_PEER_UP,
+  CLI_PLAN_OP_MAX
+} cli_plan_op_type_t;
+
+// -----[ cli_plan_op_t ]--------------------------------------------
+/**
+ * A plan operation. The meaning of the arguments depends on the
+ * type of operation:
+ *
+ *   RAW             node=offset of the text
+ *   NET_ADD_NODE    node
+ *   NET_ADD_LINK    node, arg=dst node, delay, capacity
+ *   NET_NODE_DOMAIN node, arg=domain id
+ *   BGP_ADD_ROUTER  node, arg=asn
+ *   BGP_ADD_PEER    node, arg=asn, addr=peer address
+ *   BGP_PEER_UP     node, addr=peer address
+ */
+typedef struct {
+  uint32_t line;
+  uint8_t  type;
+  uint8_t  flags;
+  uint16_t reserved;
+  uint32_t node;
+  uint32_t arg;
+  uint32_t addr;
+  uint32_t delay;
+  uint32_t capacity;
+} cli_plan_op_t;
+
+/** The node is created without loopback (NET_ADD_NODE). */
+#define CLI_PLAN_FLAG_NO_LOOPBACK 0x01
+
+struct cli_plan_t;
+typedef struct cli_plan_t cli_plan_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ cli_plan_compile ]---------------------------------------
+  /** Compile the script read from a stream. */
+  cli_plan_t * cli_plan_compile(FILE * stream);
+  // -----[ cli_plan_destroy ]---------------------------------------
+  void cli_plan_destroy(cli_plan_t ** plan_ref);
+  // -----[ cli_plan_exec ]------------------------------------------
+  /**
+   * Execute a plan. The execution stops at the first error, which is
+   * reported with its line number.
+   *
+   * \retval CLI_SUCCESS, CLI_SUCCESS_TERMINATE or an error code.
+   */
+  int cli_plan_exec(cli_t * cli, cli_plan_t * plan);
+  // -----[ cli_plan_save ]------------------------------------------
+  /**
+   * Save a plan. The size and hash of the script (see
+   * cli_plan_digest) are stored with the plan.
+   *
+   * \retval 0 on success, -1 otherwise.
+   */
+  int cli_plan_save(cli_plan_t * plan, const char * filename,
+		    uint64_t src_size, uint64_t src_hash);
+  // -----[ cli_plan_load ]------------------------------------------
+  /**
+   * Load a plan. The plan is rejected if it was saved for another
+   * version of the script.
+   *
+   * \retval 0 on success, -1 otherwise.
+   */
+  int cli_plan_load(const char * filename, uint64_t src_size,
+		    uint64_t src_hash, cli_plan_t ** plan_ref);
+  // -----[ cli_plan_digest ]----------------------------------------
+  /**
+   * Compute the size and the hash of a script, read from the current
+   * position of the stream to its end.
+   *
+   * \retval 0 on success, -1 if the stream can not be read.
+   */
+  int cli_plan_digest(FILE * stream, uint64_t * size_ref,
+		      uint64_t * hash_ref);
+  // -----[ cli_plan_get ]-------------------------------------------
+  /**
+   * Get the plan of a script. The plan is loaded from the cache
+   * (script name + ".plan") if it was saved for the same content
+   * (the modification time of the script is not trusted).
+   * Otherwise, the script is compiled and the cache is refreshed (a
+   * cache that can not be written is not an error).
+   *
+   * \retval 0 on success, -1 if the script can not be read.
+   */
+  int cli_plan_get(const char * filename, cli_plan_t ** plan_ref);
+  // -----[ cli_plan_num_ops ]---------------------------------------
+  unsigned int cli_plan_num_ops(cli_plan_t * plan);
+  // -----[ cli_plan_num_compiled ]----------------------------------
+  /** Number of operations that are not raw CLI lines. */
+  unsigned int cli_plan_num_compiled(cli_plan_t * plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLI_PLAN_H__ */
@@ -19,7 +19,9 @@
 #include <cli/common.h>
 #include <cli/sim.h>
 #include <net/network.h>
+#include <sim/shard.h>
 #include <sim/simulator.h>
+#include <sim/tracer.h>
 
 // -----[ cli_sim_clear ]--------------------------------------------
 /**
@@ -76,6 +78,7 @@ static sim_event_ops_t _sim_event_ops= {
   .callback= _cli_sim_event_callback,
   .destroy = _cli_sim_event_destroy,
   .dump    = _cli_sim_event_dump,
+  .name    = "cli-event",
 };
 
 // ----- cli_sim_event ----------------------------------------------
@@ -178,10 +181,33 @@ int cli_sim_queue_show(cli_ctx_t * ctx, cli_cmd_t * cmd)
 
 
 // ----- cli_sim_run ------------------------------------------------
+/**
+ * context: {}
+ * tokens : {}
+ * options: {--shard-by-prefix, --threads=<num>}
+ */
 int cli_sim_run(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   simulator_t * sim= network_get_simulator(network_get_default());
-  int error= sim_run(sim);
+  const char * opt= cli_get_opt_value(cmd, "threads");
+  unsigned int num_threads= 1;
+  int error;
+
+  if (opt != NULL) {
+    if (!cli_has_opt_value(cmd, "shard-by-prefix")) {
+      cli_set_user_error(cli_get(), "--threads requires --shard-by-prefix");
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    if (str_as_uint(opt, &num_threads) || (num_threads < 1)) {
+      cli_set_user_error(cli_get(), "invalid number of threads \"%s\"", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  if (cli_has_opt_value(cmd, "shard-by-prefix"))
+    error= sim_run_sharded(sim, num_threads);
+  else
+    error= sim_run(sim);
   if (error) {
     if (error == ESIM_TIME_LIMIT) {
       cbgp_warn("simulation stopped @ %2.2f.\n", sim_get_time(sim));
@@ -194,6 +220,26 @@ int cli_sim_run(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_sim_stats ]--------------------------------------------
+/**
+ * Show the counters of the simulator and the number of messages
+ * delivered per protocol. With the --reset option, the counters are
+ * cleared afterwards.
+ *
+ * context: {}
+ * tokens : {}
+ * options: {--reset}
+ */
+int cli_sim_stats(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  network_show_stats(gdsout, network_get_default());
+  if (cli_has_opt_value(cmd, "reset")) {
+    sim_reset_stats(network_get_simulator(network_get_default()));
+    network_reset_stats();
+  }
+  return CLI_SUCCESS;
+}
+
 // ----- cli_sim_step -----------------------------------------------
 /**
  * context: {}
@@ -242,6 +288,96 @@ int cli_sim_stop(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_sim_trace_enable ]-------------------------------------
+/**
+ * Enable the event tracer. The ring buffer keeps the last <size>
+ * records (default: 65536) and one event out of <n> is recorded
+ * (default: 1).
+ *
+ * context: {}
+ * tokens : {}
+ * options: {--size=<size>, --sampling=<n>}
+ */
+int cli_sim_trace_enable(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * opt;
+  unsigned int size= 65536;
+  unsigned int sampling= 1;
+
+  opt= cli_get_opt_value(cmd, "size");
+  if ((opt != NULL) && (str_as_uint(opt, &size) || (size < 1))) {
+    cli_set_user_error(cli_get(), "invalid size \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  opt= cli_get_opt_value(cmd, "sampling");
+  if ((opt != NULL) && (str_as_uint(opt, &sampling) || (sampling < 1))) {
+    cli_set_user_error(cli_get(), "invalid sampling \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  sim_trace_enable(size, sampling);
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_sim_trace_disable ]------------------------------------
+int cli_sim_trace_disable(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  sim_trace_disable();
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_sim_trace_export ]-------------------------------------
+/**
+ * Export the records of the tracer in the Chrome trace format
+ * (default) or as CSV.
+ *
+ * context: {}
+ * tokens : {file}
+ * options: {--format=chrome|csv}
+ */
+int cli_sim_trace_export(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  const char * opt= cli_get_opt_value(cmd, "format");
+  sim_trace_format_t format= SIM_TRACE_FORMAT_CHROME;
+  gds_stream_t * stream;
+  int result;
+
+  if ((opt != NULL) && sim_trace_str2format(opt, &format)) {
+    cli_set_user_error(cli_get(), "invalid trace format \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (_sim_tracer == NULL) {
+    cli_set_user_error(cli_get(), "tracer is not enabled");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  stream= stream_create_file(arg);
+  if (stream == NULL) {
+    cli_set_user_error(cli_get(), "could not create \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  result= sim_trace_export(stream, format);
+  stream_destroy(&stream);
+  if (result != 0)
+    return CLI_ERROR_COMMAND_FAILED;
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_sim_trace_scopes ]-------------------------------------
+/**
+ * Show the number of runs and the time (in microseconds) spent in
+ * the timing scopes (events, BGP decision process, IGP computation
+ * and IP forwarding).
+ */
+int cli_sim_trace_scopes(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  if (_sim_tracer == NULL) {
+    cli_set_user_error(cli_get(), "tracer is not enabled");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  sim_trace_show_scopes(gdsout);
+  return CLI_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -295,7 +431,16 @@ static void _register_sim_queue(cli_cmd_t * parent)
 // -----[ _register_sim_run ]----------------------------------------
 static void _register_sim_run(cli_cmd_t * parent)
 {
-  cli_add_cmd(parent, cli_cmd("run", cli_sim_run));
+  cli_cmd_t * cmd= cli_add_cmd(parent, cli_cmd("run", cli_sim_run));
+  cli_add_opt(cmd, cli_opt("shard-by-prefix", NULL));
+  cli_add_opt(cmd, cli_opt("threads=", NULL));
+}
+
+// -----[ _register_sim_stats ]--------------------------------------
+static void _register_sim_stats(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd= cli_add_cmd(parent, cli_cmd("stats", cli_sim_stats));
+  cli_add_opt(cmd, cli_opt("reset", NULL));
 }
 
 // -----[ _register_sim_step ]---------------------------------------
@@ -312,6 +457,21 @@ static void _register_sim_stop(cli_cmd_t * parent)
   cli_add_opt(cmd, cli_opt("at=", NULL));
 }
 
+// -----[ _register_sim_trace ]--------------------------------------
+static void _register_sim_trace(cli_cmd_t * parent)
+{
+  cli_cmd_t * group, * cmd;
+  group= cli_add_cmd(parent, cli_cmd_group("trace"));
+  cmd= cli_add_cmd(group, cli_cmd("disable", cli_sim_trace_disable));
+  cmd= cli_add_cmd(group, cli_cmd("enable", cli_sim_trace_enable));
+  cli_add_opt(cmd, cli_opt("sampling=", NULL));
+  cli_add_opt(cmd, cli_opt("size=", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("export", cli_sim_trace_export));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("scopes", cli_sim_trace_scopes));
+}
+
 // ----- cli_register_sim -------------------------------------------
 void cli_register_sim(cli_cmd_t * parent)
 {
@@ -322,6 +482,8 @@ void cli_register_sim(cli_cmd_t * parent)
   _register_sim_options(group);
   _register_sim_queue(group);
   _register_sim_run(group);
+  _register_sim_stats(group);
   _register_sim_step(group);
   _register_sim_stop(group);
+  _register_sim_trace(group);
 }
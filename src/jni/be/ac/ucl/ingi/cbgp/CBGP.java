@@ -240,6 +240,13 @@ public class CBGP {
      */
     public native long simGetEventCount();
 
+    // -----[ simGetStats ]------------------------------------------
+    /**
+     * Returns the simulator counters: the number of events
+     * processed and the peak number of queued events.
+     */
+    public native long [] simGetStats();
+
     // -----[ simGetEvent ]------------------------------------------
     /**
      * Returns the event at position i.
@@ -350,6 +357,18 @@ public class CBGP {
      */
     public static native synchronized String getErrorMsg(int error);
 
+    // -----[ getMemoryUsage ]--------------------------------------
+    /**
+     * Returns the memory charged to a subsystem (in bytes). The
+     * subsystems are the same as in the 'info memory' command. The
+     * special name "total" returns the sum of all subsystems.
+     *
+     * @param subsystem the name of the subsystem
+     * @return the number of bytes charged to the subsystem
+     */
+    public static native synchronized long getMemoryUsage(String subsystem)
+	throws CBGPException;
+
 
 
     /////////////////////////////////////////////////////////////////
@@ -174,6 +174,14 @@ public class Peer extends ProxyObject
     public native Filter getOutputFilter()
     	throws CBGPException;
 
+    // -----[ getStats ]---------------------------------------------
+    /**
+     * Returns the message counters of this session: updates sent,
+     * updates received, withdraws sent and withdraws received.
+     */
+    public native long [] getStats()
+    	throws CBGPException;
+
     // -----[ toString ]---------------------------------------------
     /**
      * Converts this BGP peer to a String.
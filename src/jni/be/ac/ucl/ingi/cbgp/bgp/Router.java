@@ -127,6 +127,17 @@ public class Router extends ProxyObject {
     public native Vector<Route> getRIB(String prefix)
 		throws CBGPException, InvalidDestinationException;
 
+    // -----[ getRIBPage ]------------------------------------------
+    /**
+     * Returns at most limit routes of the RIB, in prefix order,
+     * starting after the given prefix (if not null) and matching
+     * the given predicate (if not null). The next page is obtained
+     * by passing the prefix of the last route returned.
+     */
+    public native Vector<Route> getRIBPage(String after, int limit,
+		String predicate)
+		throws CBGPException;
+
     // -----[ getAdjRIB ]-------------------------------------------
     public native Vector<Route> getAdjRIB(String peer, String prefix,
 		boolean in)
@@ -140,6 +151,14 @@ public class Router extends ProxyObject {
     public native void rescan()
 		throws CBGPException;
 
+    // -----[ getStats ]---------------------------------------------
+    /**
+     * Returns the hot-path counters of this router: decision process
+     * runs, decision process time (in nanoseconds), filter
+     * evaluations and route copies.
+     */
+    public native long [] getStats()
+		throws CBGPException;
 
     // -----[ toString ]---------------------------------------------
     /**
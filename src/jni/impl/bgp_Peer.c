@@ -524,3 +524,34 @@ JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Peer_getOutputFilter
 
   return_jni_unlock(jEnv, joFilter);
 }
+
+// -----[ getStats ]-------------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_bgp_Peer
+ * Method:    getStats
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Peer_getStats
+  (JNIEnv * jEnv, jobject joPeer)
+{
+  bgp_peer_t * peer;
+  jlongArray jlaStats;
+  jlong stats[4];
+
+  jni_lock(jEnv);
+
+  peer= (bgp_peer_t *) jni_proxy_lookup(jEnv, joPeer);
+  if (peer == NULL)
+    return_jni_unlock(jEnv, NULL);
+
+  stats[0]= (jlong) peer->stats.updates_sent;
+  stats[1]= (jlong) peer->stats.updates_rcvd;
+  stats[2]= (jlong) peer->stats.withdraws_sent;
+  stats[3]= (jlong) peer->stats.withdraws_rcvd;
+
+  jlaStats= (*jEnv)->NewLongArray(jEnv, 4);
+  if (jlaStats != NULL)
+    (*jEnv)->SetLongArrayRegion(jEnv, jlaStats, 0, 4, stats);
+
+  return_jni_unlock(jEnv, jlaStats);
+}
@@ -21,9 +21,14 @@
 #include <jni/impl/net_Node.h>
 
 #include <bgp/as.h>
+#include <bgp/filter/filter.h>
+#include <bgp/filter/predicate_parser.h>
+#include <bgp/peer.h>
 #include <bgp/rib.h>
+#include <bgp/rib_cursor.h>
 #include <bgp/route.h>
 #include <bgp/route-input.h>
+#include <util/cycles.h>
 
 #define CLASS_BGPRouter "be/ac/ucl/ingi/cbgp/bgp/Router"
 #define CONSTR_BGPRouter "(Lbe/ac/ucl/ingi/cbgp/CBGP;" \
@@ -333,6 +338,78 @@ JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getRIB
   return_jni_unlock(jEnv, joVector);
 }
 
+// -----[ getRIBPage ]-----------------------------------------------
+/**
+ * Class    : bgp.Router
+ * Method   : getRIBPage
+ * Signature: (Ljava/lang/String;ILjava/lang/String;)Ljava/util/Vector;
+ *
+ * This function returns at most 'limit' routes of the router's RIB,
+ * in prefix order, starting after the given prefix (if not null)
+ * and matching the given predicate (if not null). The next page is
+ * obtained by passing the prefix of the last route returned.
+ */
+JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getRIBPage
+  (JNIEnv * jEnv, jobject joRouter, jstring jsAfter, jint jiLimit,
+   jstring jsPredicate)
+{
+  bgp_router_t * router;
+  jobject joVector;
+  jni_ctx_t sCtx;
+  bgp_rib_cursor_t cursor;
+  bgp_ft_matcher_t * matcher= NULL;
+  const char * predicate;
+  int result;
+
+  jni_lock(jEnv);
+
+  /* Get the router instance */
+  router= (bgp_router_t *) jni_proxy_lookup(jEnv, joRouter);
+  if (router == NULL)
+    return_jni_unlock(jEnv, NULL);
+
+  if (jiLimit < 0) {
+    throw_CBGPException(jEnv, "invalid limit (%d)", jiLimit);
+    return_jni_unlock(jEnv, NULL);
+  }
+
+  /* Parse the predicate */
+  if (jsPredicate != NULL) {
+    predicate= (*jEnv)->GetStringUTFChars(jEnv, jsPredicate, NULL);
+    result= predicate_parser(predicate, &matcher);
+    if (result != PREDICATE_PARSER_SUCCESS)
+      throw_CBGPException(jEnv, "invalid predicate \"%s\" (%s)",
+			  predicate, predicate_parser_strerror(result));
+    (*jEnv)->ReleaseStringUTFChars(jEnv, jsPredicate, predicate);
+    if (result != PREDICATE_PARSER_SUCCESS)
+      return_jni_unlock(jEnv, NULL);
+  }
+
+  rib_cursor_init(&cursor, router, jiLimit, matcher);
+  if (jsAfter != NULL) {
+    if (ip_jstring_to_prefix(jEnv, jsAfter, &cursor.after) != 0) {
+      if (matcher != NULL)
+	filter_matcher_destroy(&matcher);
+      return_jni_unlock(jEnv, NULL);
+    }
+    cursor.has_after= 1;
+  }
+
+  joVector= cbgp_jni_new_Vector(jEnv);
+  if (joVector != NULL) {
+    sCtx.router= router;
+    sCtx.joVector= joVector;
+    sCtx.jEnv= jEnv;
+    if (rib_cursor_for_each(router->loc_rib, &cursor,
+			    _cbgp_jni_get_rib_route, &sCtx) != 0)
+      joVector= NULL;
+  }
+
+  if (matcher != NULL)
+    filter_matcher_destroy(&matcher);
+  return_jni_unlock(jEnv, joVector);
+}
+
 // -----[ _cbgp_jni_get_adj_rib_routes ]-----------------------------
 static int _cbgp_jni_get_adj_rib_routes(bgp_peer_t * peer, ip_dest_t * dest,
 					int iIn, jni_ctx_t * pCtx)
@@ -342,21 +419,21 @@ static int _cbgp_jni_get_adj_rib_routes(bgp_peer_t * peer, ip_dest_t * dest,
 
   switch (dest->type) {
   case NET_DEST_ANY:
-    return rib_for_each(peer->adj_rib[dir],
-			_cbgp_jni_get_rib_route, pCtx);
+    return bgp_peer_rib_for_each(peer, dir,
+				 _cbgp_jni_get_rib_route, pCtx);
 
   case NET_DEST_ADDRESS:
     dest->prefix.network= dest->addr;
     dest->prefix.mask= 32;
 
-    route= rib_find_best(peer->adj_rib[dir], dest->prefix);
+    route= bgp_peer_rib_find_best(peer, dir, dest->prefix);
     if (route != NULL)
       return _cbgp_jni_get_rib_route(dest->prefix.network,
 				     32, route, pCtx);
     break;
     
   case NET_DEST_PREFIX:
-    route= rib_find_exact(peer->adj_rib[dir], dest->prefix);
+    route= bgp_peer_rib_find_exact(peer, dir, dest->prefix);
     if (route != NULL)
       return _cbgp_jni_get_rib_route(dest->prefix.network,
 				     dest->prefix.mask,
@@ -557,3 +634,35 @@ JNIEXPORT void JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_rescan
 
   jni_unlock(jEnv);
 }
+
+// -----[ getStats ]-------------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_bgp_Router
+ * Method:    getStats
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getStats
+  (JNIEnv * jEnv, jobject joRouter)
+{
+  bgp_router_t * router;
+  jlongArray jlaStats;
+  jlong stats[4];
+
+  jni_lock(jEnv);
+
+  /* Get the router instance */
+  router= (bgp_router_t *) jni_proxy_lookup(jEnv, joRouter);
+  if (router == NULL)
+    return_jni_unlock(jEnv, NULL);
+
+  stats[0]= (jlong) router->stats.dp_runs;
+  stats[1]= (jlong) cycles_to_ns(router->stats.dp_cycles);
+  stats[2]= (jlong) router->stats.filter_evals;
+  stats[3]= (jlong) router->stats.route_copies;
+
+  jlaStats= (*jEnv)->NewLongArray(jEnv, 4);
+  if (jlaStats != NULL)
+    (*jEnv)->SetLongArrayRegion(jEnv, jlaStats, 0, 4, stats);
+
+  return_jni_unlock(jEnv, jlaStats);
+}
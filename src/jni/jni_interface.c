@@ -65,6 +65,7 @@
 #include <bgp/route_map.h>
 
 #include <sim/simulator.h>
+#include <util/mem_acct.h>
 
 #include <cli/common.h>
 #include <api.h>
@@ -822,6 +823,35 @@ JNIEXPORT jlong JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_simGetEventCount
   return jlResult;
 }
 
+// -----[ simGetStats ]----------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_CBGP
+ * Method:    simGetStats
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_simGetStats
+  (JNIEnv * jEnv, jobject joCBGP)
+{
+  simulator_t * sim;
+  jlongArray jlaStats;
+  jlong stats[2];
+
+  if (jni_check_null(jEnv, joCBGP))
+    return NULL;
+
+  jni_lock(jEnv);
+
+  sim= network_get_simulator(network_get_default());
+  stats[0]= (jlong) sim->stats.num_events;
+  stats[1]= (jlong) sim->stats.peak_depth;
+
+  jlaStats= (*jEnv)->NewLongArray(jEnv, 2);
+  if (jlaStats != NULL)
+    (*jEnv)->SetLongArrayRegion(jEnv, jlaStats, 0, 2, stats);
+
+  return_jni_unlock(jEnv, jlaStats);
+}
+
 // -----[ simGetEvent ]----------------------------------------------
 /*
  * Class:     be_ac_ucl_ingi_cbgp_CBGP
@@ -1172,6 +1202,35 @@ JNIEXPORT jstring JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_getErrorMsg
   return cbgp_jni_net_error_str(env, error);
 }
 
+// -----[ getMemoryUsage ]-------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_CBGP
+ * Method:    getMemoryUsage
+ * Signature: (Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_getMemoryUsage
+  (JNIEnv * env, jclass cls, jstring jsSubsystem)
+{
+  const char * subsystem;
+  mem_acct_t acct;
+  jlong result= -1;
+
+  if (jsSubsystem == NULL) {
+    throw_CBGPException(env, "subsystem is null");
+    return -1;
+  }
+
+  subsystem= (*env)->GetStringUTFChars(env, jsSubsystem, NULL);
+  if (!strcmp(subsystem, "total"))
+    result= (jlong) mem_acct_get_total();
+  else if (!mem_acct_from_str(subsystem, &acct))
+    result= (jlong) mem_acct_get(acct);
+  else
+    throw_CBGPException(env, "unknown subsystem \"%s\"", subsystem);
+  (*env)->ReleaseStringUTFChars(env, jsSubsystem, subsystem);
+  return result;
+}
+
 // -----[ rankToString ]---------------------------------------------
 /*
  * Class:     be_ac_ucl_ingi_cbgp_bgp_Route
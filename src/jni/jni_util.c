@@ -126,16 +126,14 @@ int cbgp_jni_Communities_append(JNIEnv * env, jobject joCommunities,
 jobject cbgp_jni_new_ASPath(JNIEnv * env, bgp_path_t * path)
 {
   jobject joASPath;
-  unsigned int index;
-  bgp_path_seg_t* seg;
+  bgp_path_seg_t* seg= NULL;
 
   /* Build new ASPath object */
   if ((joASPath= cbgp_jni_new(env, CLASS_ASPath, CONSTR_ASPath)) == NULL)
     return NULL;
 
   /* Append all AS-Path segments */
-  for (index= 0; index < path_num_segments(path); index++) {
-    seg= (bgp_path_seg_t*) path->data[index];
+  while ((seg= path_segment_next(path, seg)) != NULL) {
     if (cbgp_jni_ASPath_append(env, joASPath, seg) != 0)
       return NULL;
   }
@@ -3,6 +3,13 @@
 //
 // Main source file for cbgp-dump application.
 //
+// The routes are processed by a pipeline. The input is split into
+// batches of routes (or of MRT ASCII lines) by the main thread. The
+// batches are decoded, filtered and formatted by worker threads and
+// written in their original order by a writer thread. The number of
+// batches in the pipeline is bounded, so that the memory used does
+// not depend on the size of the input.
+//
 // @author Bruno Quoitin (bruno.quoitin@uclouvain.be)
 // @date 21/05/2007
 // $Id: main-dump.c,v 1.7 2009-04-02 19:10:55 bqu Exp $
@@ -16,22 +23,40 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <libgds/stream.h>
+#include <libgds/str_util.h>
 #include <api.h>
 #include <bgp/as.h>
 #include <bgp/filter/filter.h>
 #include <bgp/filter/predicate_parser.h>
+#include <bgp/mrtd.h>
 #include <bgp/peer.h>
 #include <bgp/route.h>
 #include <bgp/route-input.h>
+#include <bgp/route_stream.h>
+#include <net/prefix.h>
+#include <util/slab.h>
+#include <util/thread.h>
+
+#if defined HAVE_PTHREAD && defined HAVE_TLS
+# define DUMP_PARALLEL_DECODE
+#endif
+
+/** Number of routes (or lines) per batch. */
+#define DUMP_BATCH_SIZE 4096
+/** Size of the buffer used to encode a binary record. */
+#define DUMP_RECORD_SIZE (2*ROUTE_STREAM_MAX_RECORD)
 
 enum {
   OPTION_HELP,
   OPTION_IN_FORMAT,
   OPTION_OUT_FORMAT,
   OPTION_OUT_SPEC,
-  OPTION_FILTER
+  OPTION_FILTER,
+  OPTION_THREADS,
 } options_t;
 
 static struct option longopts[]= {
@@ -40,14 +65,92 @@ static struct option longopts[]= {
   {"in-fmt", required_argument, NULL, OPTION_IN_FORMAT},
   {"out-fmt", required_argument, NULL, OPTION_OUT_FORMAT},
   {"out-spec", required_argument, NULL, OPTION_OUT_SPEC},
+  {"threads", required_argument, NULL, OPTION_THREADS},
+  {NULL, 0, NULL, 0},
 };
 
+// ----- Output formats (besides the route show modes) -----
+typedef enum {
+  DUMP_OUT_TEXT,
+  DUMP_OUT_BINARY,
+  DUMP_OUT_MRT_V2,
+} dump_out_t;
+
+// -----[ _dump_item_t ]---------------------------------------------
 typedef struct {
-  unsigned int       num_routes_ok;
-  unsigned int       num_routes_ignored;
-  unsigned int       num_routes_filtered;
+  bgp_route_t * route;
+  net_addr_t    peer_addr;
+  asn_t         peer_asn;
+} _dump_item_t;
+
+// -----[ _dump_batch_t ]--------------------------------------------
+typedef struct _dump_batch_t {
+  unsigned long          seq_num;
+  /** Undecoded MRT ASCII lines, '\0' separated. */
+  char                 * lines;
+  size_t                 lines_len;
+  size_t                 lines_size;
+  unsigned int           num_lines;
+  /** File and line (in this file) of the first line. */
+  const char           * filename;
+  unsigned long          first_line;
+  /** Decoded routes. */
+  _dump_item_t         * items;
+  unsigned int           num_items;
+  /** Formatted output. */
+  char                 * out;
+  size_t                 out_len;
+  size_t                 out_size;
+  unsigned int           num_ok;
+  unsigned int           num_ignored;
+  unsigned int           num_filtered;
+  unsigned long          error_line;
+  int                    error;
+  struct _dump_batch_t * next;
+} _dump_batch_t;
+
+typedef struct {
+  unsigned long      num_routes_ok;
+  unsigned long      num_routes_ignored;
+  unsigned long      num_routes_filtered;
   char             * out_spec;
   bgp_ft_matcher_t * matcher;
+  bgp_input_type_t   in_format;
+  dump_out_t         out_format;
+  unsigned int       num_threads;
+  /** Batch being filled by the reader. */
+  _dump_batch_t    * batch;
+  unsigned long      num_batches;
+  /** File being read and number of lines read from this file. */
+  const char       * filename;
+  unsigned long      num_lines;
+  /** First error. The line is 0 if a record could not be encoded. */
+  int                error;
+  const char       * error_file;
+  unsigned long      error_line;
+  /** TABLE_DUMP_V2 state (writer only). */
+  mrtd_peer_t      * peers;
+  unsigned int       num_peers;
+  unsigned int       size_peers;
+  /** Open-addressing index of the peers (index+1, 0 if empty). */
+  uint32_t         * peers_index;
+  unsigned int       peers_index_size;
+  uint32_t           mrt_seq_num;
+  uint32_t           mrt_time;
+  uint8_t          * record;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t    lock;
+  pthread_cond_t     cond;
+  /** Batches waiting for a worker (FIFO). */
+  _dump_batch_t    * todo_head;
+  _dump_batch_t    * todo_tail;
+  /** Processed batches, indexed by sequence number. */
+  _dump_batch_t   ** done;
+  unsigned int       max_batches;
+  unsigned int       num_in_flight;
+  unsigned long      next_write;
+  int                reading_done;
+#endif /* HAVE_PTHREAD */
 } dump_ctx_t;
 static dump_ctx_t dump_ctx= {
   .num_routes_ok= 0,
@@ -72,7 +175,8 @@ void usage()
 	 "format\n"
 	 "                      MRT ASCII. Available file formats are:\n"
 	 "                        (cisco)      CISCO's show ip bgp format\n"
-	 "                        (mrt-ascii)  MRT ASCII format\n");
+	 "                        (mrt-ascii)  MRT ASCII format\n"
+	 "                        (binary)     C-BGP binary route stream\n");
 #ifdef HAVE_LIBBGPDUMP
   printf("                        (mrt-binary) MRT binary\n");
 #endif
@@ -84,56 +188,559 @@ void usage()
 	 "                        (mrt-ascii)  MRT ASCII format\n"
 	 "                        (custom)     custom format (see "
 	 "--out-spec)\n"
+	 "                        (binary)     C-BGP binary route stream\n"
+	 "                        (mrt-v2)     MRT TABLE_DUMP_V2 (binary)\n"
 	 "  --out-spec=SPEC     specifies the format string for the custom "
 	 "output format.\n"
+	 "  --threads=NUM       specifies the number of worker threads. The "
+	 "default is\n"
+	 "                      the number of processors.\n"
 	 "\n");
 }
 
-// -----[ _handler ]-------------------------------------------------
-static int _handler(int status, bgp_route_t * route,
-		    net_addr_t peer_addr, asn_t peer_asn,
-		    void * handler_ctx)
+/////////////////////////////////////////////////////////////////////
+//
+// BATCHES
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _dump_batch_create ]---------------------------------------
+static _dump_batch_t * _dump_batch_create(dump_ctx_t * ctx)
 {
-  dump_ctx_t * ctx= (dump_ctx_t *) handler_ctx;
+  _dump_batch_t * batch= (_dump_batch_t *) malloc(sizeof(_dump_batch_t));
+  memset(batch, 0, sizeof(_dump_batch_t));
+  batch->seq_num= ctx->num_batches++;
+  batch->filename= ctx->filename;
+  batch->first_line= ctx->num_lines+1;
+  batch->items= (_dump_item_t *)
+    malloc(DUMP_BATCH_SIZE * sizeof(_dump_item_t));
+  return batch;
+}
+
+// -----[ _dump_batch_destroy ]--------------------------------------
+static void _dump_batch_destroy(_dump_batch_t ** batch_ref)
+{
+  _dump_batch_t * batch= *batch_ref;
+  unsigned int index;
+
+  for (index= 0; index < batch->num_items; index++)
+    route_destroy(&batch->items[index].route);
+  free(batch->lines);
+  free(batch->items);
+  free(batch->out);
+  free(batch);
+  *batch_ref= NULL;
+}
+
+// -----[ _dump_batch_write ]----------------------------------------
+static inline void _dump_batch_write(_dump_batch_t * batch,
+				     const void * data, size_t len)
+{
+  if (batch->out_len+len > batch->out_size) {
+    batch->out_size= 2*(batch->out_len+len);
+    batch->out= (char *) realloc(batch->out, batch->out_size);
+  }
+  memcpy(batch->out+batch->out_len, data, len);
+  batch->out_len+= len;
+}
+
+// -----[ _dump_batch_stream_cb ]------------------------------------
+/** Callback of the stream used to format routes in a batch. */
+static int _dump_batch_stream_cb(void * ctx, char * buffer)
+{
+  size_t len= strlen(buffer);
+  _dump_batch_write(*((_dump_batch_t **) ctx), buffer, len);
+  return len;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// WORKERS: DECODE, FILTER AND FORMAT
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _dump_decode_lines ]---------------------------------------
+static void _dump_decode_lines(_dump_batch_t * batch)
+{
+  const char * line= batch->lines;
+  _dump_item_t * item;
+  unsigned int index;
+  int result;
+
+  for (index= 0; index < batch->num_lines; index++) {
+    item= &batch->items[batch->num_items];
+    result= mrtd_route_from_line(line, &item->peer_addr, &item->peer_asn,
+				 &item->route);
+    if (result < 0) {
+      batch->error= result;
+      batch->error_line= batch->first_line+index;
+      break;
+    }
+    if (item->route == NULL)
+      batch->num_ignored++;
+    else
+      batch->num_items++;
+    line+= strlen(line)+1;
+  }
+  batch->num_lines= 0;
+}
+
+// -----[ _dump_batch_process ]--------------------------------------
+/**
+ * Decode, filter and format the routes of a batch. Only the routes
+ * that are not formatted here (TABLE_DUMP_V2) are kept in the batch.
+ */
+static void _dump_batch_process(dump_ctx_t * ctx, _dump_batch_t * batch,
+				gds_stream_t * stream, uint8_t * record)
+{
+  unsigned int index, num_kept= 0;
+  _dump_item_t * item;
   bgp_peer_t peer;
+  int len;
 
-  // Maintain statistics for discarded routes
-  if (status != BGP_INPUT_STATUS_OK) {
-    switch (status) {
-    case BGP_INPUT_STATUS_IGNORED:
-      ctx->num_routes_ignored++;
+  if (batch->num_lines > 0)
+    _dump_decode_lines(batch);
+
+  for (index= 0; index < batch->num_items; index++) {
+    item= &batch->items[index];
+    if ((ctx->matcher != NULL) &&
+	(filter_matcher_apply(ctx->matcher, NULL, item->route) != 1)) {
+      batch->num_filtered++;
+      route_destroy(&item->route);
+      continue;
+    }
+    batch->num_ok++;
+
+    switch (ctx->out_format) {
+    case DUMP_OUT_TEXT:
+      // Fake BGP peer
+      peer.addr= item->peer_addr;
+      peer.asn= item->peer_asn;
+      item->route->peer= &peer;
+      route_dump(stream, item->route);
+      stream_printf(stream, "\n");
+      route_destroy(&item->route);
+      break;
+    case DUMP_OUT_BINARY:
+      len= route_stream_encode(item->route, item->peer_addr, item->peer_asn,
+			       record, DUMP_RECORD_SIZE);
+      if (len > 0)
+	_dump_batch_write(batch, record, len);
+      route_destroy(&item->route);
       break;
-    case BGP_INPUT_STATUS_FILTERED:
-      ctx->num_routes_filtered++;
+    case DUMP_OUT_MRT_V2:
+      batch->items[num_kept++]= *item;
       break;
     }
-    return BGP_INPUT_SUCCESS;
   }
+  batch->num_items= num_kept;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// WRITER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _dump_mrt_peer_hash ]-------------------------------------
+static inline unsigned int _dump_mrt_peer_hash(net_addr_t addr, asn_t asn,
+					       unsigned int size)
+{
+  return ((addr ^ (asn * 40503U)) * 2654435761U) & (size-1);
+}
+
+// -----[ _dump_mrt_peer_index ]-------------------------------------
+/**
+ * Return the index of a peer in the TABLE_DUMP_V2 peer index table.
+ * When a new peer is found, an updated table is written. The peer is
+ * only added if the table could be encoded. The indices of the known
+ * peers do not change.
+ *
+ * etval the index of the peer, or -1 if the table can not be
+ *   encoded.
+ */
+static int _dump_mrt_peer_index(dump_ctx_t * ctx, net_addr_t addr,
+				asn_t asn)
+{
+  unsigned int index, pos;
+  int len;
+
+  // Keep the load of the index below 1/2
+  if (2*(ctx->num_peers+1) > ctx->peers_index_size) {
+    free(ctx->peers_index);
+    ctx->peers_index_size= (ctx->peers_index_size == 0)?
+      64:2*ctx->peers_index_size;
+    ctx->peers_index= (uint32_t *)
+      calloc(ctx->peers_index_size, sizeof(uint32_t));
+    for (index= 0; index < ctx->num_peers; index++) {
+      pos= _dump_mrt_peer_hash(ctx->peers[index].addr, ctx->peers[index].asn,
+			       ctx->peers_index_size);
+      while (ctx->peers_index[pos] != 0)
+	pos= (pos+1) & (ctx->peers_index_size-1);
+      ctx->peers_index[pos]= index+1;
+    }
+  }
+
+  pos= _dump_mrt_peer_hash(addr, asn, ctx->peers_index_size);
+  while (ctx->peers_index[pos] != 0) {
+    index= ctx->peers_index[pos]-1;
+    if ((ctx->peers[index].addr == addr) && (ctx->peers[index].asn == asn))
+      return index;
+    pos= (pos+1) & (ctx->peers_index_size-1);
+  }
+
+  // Encode the table with the new peer before committing it
+  if (ctx->num_peers == ctx->size_peers) {
+    ctx->size_peers= (ctx->size_peers == 0)?64:2*ctx->size_peers;
+    ctx->peers= (mrtd_peer_t *)
+      realloc(ctx->peers, ctx->size_peers * sizeof(mrtd_peer_t));
+  }
+  ctx->peers[ctx->num_peers].addr= addr;
+  ctx->peers[ctx->num_peers].asn= asn;
+  len= mrtd_v2_encode_peer_table(ctx->mrt_time, 0, ctx->peers,
+				 ctx->num_peers+1, ctx->record,
+				 DUMP_RECORD_SIZE);
+  if (len < 0)
+    return -1;
+  fwrite(ctx->record, len, 1, stdout);
+  ctx->peers_index[pos]= ++ctx->num_peers;
+  return ctx->num_peers-1;
+}
+
+// -----[ _dump_mrt_encode_error ]-----------------------------------
+static void _dump_mrt_encode_error(dump_ctx_t * ctx, _dump_item_t * item,
+				   const char * what)
+{
+  stream_printf(gdserr, "Error: could not encode %s for route ", what);
+  ip_prefix_dump(gdserr, item->route->prefix);
+  stream_printf(gdserr, " from peer ");
+  ip_address_dump(gdserr, item->peer_addr);
+  stream_printf(gdserr, " (AS%u)\n", item->peer_asn);
+  ctx->error= MRTD_ERROR;
+  ctx->error_file= NULL;
+  ctx->error_line= 0;
+}
+
+// -----[ _dump_batch_output ]---------------------------------------
+/**
+ * Write a processed batch (in sequence order) and destroy it. The
+ * batches that follow a batch with an error are discarded.
+ */
+static void _dump_batch_output(dump_ctx_t * ctx, _dump_batch_t * batch)
+{
+  _dump_item_t * item;
+  unsigned int index;
+  int peer_index, len;
+
+  if (ctx->error != 0) {
+    _dump_batch_destroy(&batch);
+    return;
+  }
+  if (batch->out_len > 0)
+    fwrite(batch->out, batch->out_len, 1, stdout);
+  for (index= 0; index < batch->num_items; index++) {
+    item= &batch->items[index];
+    peer_index= _dump_mrt_peer_index(ctx, item->peer_addr, item->peer_asn);
+    if (peer_index < 0) {
+      _dump_mrt_encode_error(ctx, item, "peer index table");
+      _dump_batch_destroy(&batch);
+      return;
+    }
+    len= mrtd_v2_encode_rib(ctx->mrt_time, ctx->mrt_seq_num, item->route,
+			    peer_index, ctx->record, DUMP_RECORD_SIZE);
+    if (len < 0) {
+      _dump_mrt_encode_error(ctx, item, "RIB entry");
+      _dump_batch_destroy(&batch);
+      return;
+    }
+    ctx->mrt_seq_num++;
+    fwrite(ctx->record, len, 1, stdout);
+  }
+
+  ctx->num_routes_ok+= batch->num_ok;
+  ctx->num_routes_ignored+= batch->num_ignored;
+  ctx->num_routes_filtered+= batch->num_filtered;
+  if ((batch->error != 0) && (ctx->error == 0)) {
+    ctx->error= batch->error;
+    ctx->error_file= batch->filename;
+    ctx->error_line= batch->error_line;
+  }
+  _dump_batch_destroy(&batch);
+}
 
-  // Filter route (if filter specified)
-  if (ctx->matcher != NULL) {
-    if (filter_matcher_apply(ctx->matcher, NULL, route) != 1) {
-      ctx->num_routes_filtered++;
-      route_destroy(&route);
-      return BGP_INPUT_SUCCESS;
+/////////////////////////////////////////////////////////////////////
+//
+// PIPELINE
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_PTHREAD
+// -----[ _dump_worker ]---------------------------------------------
+static void * _dump_worker(void * arg)
+{
+  dump_ctx_t * ctx= (dump_ctx_t *) arg;
+  _dump_batch_t * batch= NULL;
+  gds_stream_t * stream= stream_create_callback(_dump_batch_stream_cb,
+						&batch);
+  uint8_t * record= (uint8_t *) malloc(DUMP_RECORD_SIZE);
+
+  while (1) {
+    pthread_mutex_lock(&ctx->lock);
+    while ((ctx->todo_head == NULL) && !ctx->reading_done)
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    batch= ctx->todo_head;
+    if (batch != NULL) {
+      ctx->todo_head= batch->next;
+      if (ctx->todo_head == NULL)
+	ctx->todo_tail= NULL;
     }
+    pthread_mutex_unlock(&ctx->lock);
+    if (batch == NULL)
+      break;
+
+    _dump_batch_process(ctx, batch, stream, record);
+    stream_flush(stream);
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->done[batch->seq_num % ctx->max_batches]= batch;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
   }
 
-  // Create fake BGP peer
-  peer.addr= peer_addr;
-  peer.asn= peer_asn;
-  route->peer= &peer;
+  free(record);
+  stream_destroy(&stream);
+  mrtd_thread_exit();
+  slab_thread_exit();
+  return NULL;
+}
+
+// -----[ _dump_writer ]---------------------------------------------
+static void * _dump_writer(void * arg)
+{
+  dump_ctx_t * ctx= (dump_ctx_t *) arg;
+  _dump_batch_t * batch;
+  unsigned int slot;
+
+  while (1) {
+    pthread_mutex_lock(&ctx->lock);
+    slot= ctx->next_write % ctx->max_batches;
+    while ((ctx->done[slot] == NULL) &&
+	   !(ctx->reading_done && (ctx->next_write == ctx->num_batches)))
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    batch= ctx->done[slot];
+    ctx->done[slot]= NULL;
+    pthread_mutex_unlock(&ctx->lock);
+    if (batch == NULL)
+      break;
+
+    _dump_batch_output(ctx, batch);
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->next_write++;
+    ctx->num_in_flight--;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+  }
+  slab_thread_exit();
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+// -----[ _dump_submit ]---------------------------------------------
+/**
+ * Hand the current batch over to the workers. Without threads, the
+ * batch is processed and written immediately.
+ */
+static void _dump_submit(dump_ctx_t * ctx)
+{
+  _dump_batch_t * batch= ctx->batch;
+  static gds_stream_t * stream= NULL;
+  static _dump_batch_t * stream_batch= NULL;
 
-  // Display route
-  //log_printf(gdsout, "TABLE_DUMP|0|");
-  route_dump(gdsout, route);
-  stream_flush(gdsout);
-  stream_printf(gdsout, "\n");
-  ctx->num_routes_ok++;
-  route_destroy(&route);
+  if (batch == NULL)
+    return;
+  ctx->batch= NULL;
+
+#ifdef HAVE_PTHREAD
+  if (ctx->num_threads > 1) {
+#ifndef DUMP_PARALLEL_DECODE
+    // The MRT line parser can only be used by one thread
+    if (batch->num_lines > 0)
+      _dump_decode_lines(batch);
+#endif
+    pthread_mutex_lock(&ctx->lock);
+    while (ctx->num_in_flight >= ctx->max_batches)
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    ctx->num_in_flight++;
+    batch->next= NULL;
+    if (ctx->todo_tail != NULL)
+      ctx->todo_tail->next= batch;
+    else
+      ctx->todo_head= batch;
+    ctx->todo_tail= batch;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+    return;
+  }
+#endif /* HAVE_PTHREAD */
+
+  if (stream == NULL) {
+    stream= stream_create_callback(_dump_batch_stream_cb, &stream_batch);
+    ctx->record= (uint8_t *) malloc(DUMP_RECORD_SIZE);
+  }
+  stream_batch= batch;
+  _dump_batch_process(ctx, batch, stream, ctx->record);
+  stream_flush(stream);
+  _dump_batch_output(ctx, batch);
+}
+
+// -----[ _dump_line_handler ]---------------------------------------
+static int _dump_line_handler(const char * line, void * handler_ctx)
+{
+  dump_ctx_t * ctx= (dump_ctx_t *) handler_ctx;
+  _dump_batch_t * batch;
+  size_t len= strlen(line)+1;
+
+  if (ctx->error != 0)
+    return -1;
+  if (ctx->batch == NULL)
+    ctx->batch= _dump_batch_create(ctx);
+  batch= ctx->batch;
+  if (batch->lines_len+len > batch->lines_size) {
+    batch->lines_size= 2*(batch->lines_len+len);
+    batch->lines= (char *) realloc(batch->lines, batch->lines_size);
+  }
+  memcpy(batch->lines+batch->lines_len, line, len);
+  batch->lines_len+= len;
+  batch->num_lines++;
+  ctx->num_lines++;
+  if (batch->num_lines >= DUMP_BATCH_SIZE)
+    _dump_submit(ctx);
+  return 0;
+}
+
+// -----[ _dump_route_handler ]--------------------------------------
+static int _dump_route_handler(int status, bgp_route_t * route,
+			       net_addr_t peer_addr, asn_t peer_asn,
+			       void * handler_ctx)
+{
+  dump_ctx_t * ctx= (dump_ctx_t *) handler_ctx;
+  _dump_item_t * item;
+
+  if (ctx->error != 0)
+    return -1;
+  if (ctx->batch == NULL)
+    ctx->batch= _dump_batch_create(ctx);
+
+  // Maintain statistics for discarded routes
+  if ((status != BGP_INPUT_STATUS_OK) || (route == NULL)) {
+    if (status == BGP_INPUT_STATUS_FILTERED)
+      ctx->batch->num_filtered++;
+    else
+      ctx->batch->num_ignored++;
+    route_destroy(&route);
+    return BGP_INPUT_SUCCESS;
+  }
+
+  item= &ctx->batch->items[ctx->batch->num_items++];
+  item->route= route;
+  item->peer_addr= peer_addr;
+  item->peer_asn= peer_asn;
+  if (ctx->batch->num_items >= DUMP_BATCH_SIZE)
+    _dump_submit(ctx);
   return BGP_INPUT_SUCCESS;
 }
 
+// -----[ _dump_load ]-----------------------------------------------
+static int _dump_load(dump_ctx_t * ctx, const char * filename)
+{
+  int result;
+
+  // Batches never span files (see below)
+  ctx->filename= filename;
+  ctx->num_lines= 0;
+  if (ctx->in_format == BGP_ROUTES_INPUT_MRT_ASC)
+    result= mrtd_ascii_for_each_line(filename, _dump_line_handler, ctx);
+  else
+    result= bgp_routes_load(filename, ctx->in_format,
+			    _dump_route_handler, ctx);
+  _dump_submit(ctx);
+  return result;
+}
+
+// -----[ _dump_run ]------------------------------------------------
+/**
+ * Process the input files. The main thread reads the files while
+ * the workers and the writer process the batches.
+ */
+static int _dump_run(dump_ctx_t * ctx, int argc, char * argv[])
+{
+  int result= 0;
+#ifdef HAVE_PTHREAD
+  pthread_t * workers= NULL;
+  pthread_t writer;
+  unsigned int index;
+
+  if (ctx->num_threads > 1) {
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+    ctx->max_batches= 2*ctx->num_threads;
+    ctx->done= (_dump_batch_t **)
+      calloc(ctx->max_batches, sizeof(_dump_batch_t *));
+    ctx->record= (uint8_t *) malloc(DUMP_RECORD_SIZE);
+    thread_set_parallel(1);
+    workers= (pthread_t *) malloc(ctx->num_threads * sizeof(pthread_t));
+    for (index= 0; index < ctx->num_threads; index++)
+      pthread_create(&workers[index], NULL, _dump_worker, ctx);
+    pthread_create(&writer, NULL, _dump_writer, ctx);
+  }
+#endif /* HAVE_PTHREAD */
+
+  for (; (optind < argc) && (result == 0); optind++) {
+    stream_printf(gdserr, "Reading from \"%s\"...\n", argv[optind]);
+    result= _dump_load(ctx, argv[optind]);
+    if ((result != 0) && (ctx->error == 0))
+      stream_printf(gdserr, "Error: an error (%d) occured while "
+		    "reading \"%s\"\n", result, argv[optind]);
+  }
+
+#ifdef HAVE_PTHREAD
+  if (ctx->num_threads > 1) {
+    pthread_mutex_lock(&ctx->lock);
+    ctx->reading_done= 1;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+    for (index= 0; index < ctx->num_threads; index++)
+      pthread_join(workers[index], NULL);
+    pthread_join(writer, NULL);
+    thread_set_parallel(0);
+    free(workers);
+    free(ctx->done);
+    pthread_cond_destroy(&ctx->cond);
+    pthread_mutex_destroy(&ctx->lock);
+  }
+#endif /* HAVE_PTHREAD */
+
+  fflush(stdout);
+  if (ctx->error != 0) {
+    // Encoding errors are reported by the writer
+    if (ctx->error_line > 0)
+      stream_printf(gdserr, "Error: syntax error in \"%s\" at line %lu "
+		    "(%s)\n", ctx->error_file, ctx->error_line,
+		    mrtd_strerror(ctx->error));
+    return -1;
+  }
+  return result;
+}
+
+// -----[ _dump_now ]------------------------------------------------
+static inline double _dump_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 // -----[ _main_done ]-----------------------------------------------
 static void _main_done() __attribute((destructor));
 static void _main_done()
@@ -142,6 +749,12 @@ static void _main_done()
     free(dump_ctx.out_spec);
   if (dump_ctx.matcher != NULL)
     filter_matcher_destroy(&dump_ctx.matcher);
+  if (dump_ctx.peers != NULL)
+    free(dump_ctx.peers);
+  if (dump_ctx.peers_index != NULL)
+    free(dump_ctx.peers_index);
+  if (dump_ctx.record != NULL)
+    free(dump_ctx.record);
 
   libcbgp_done();
 }
@@ -149,23 +762,30 @@ static void _main_done()
 // -----[ main ]-----------------------------------------------------
 int main(int argc, char * argv[])
 {
-  bgp_input_type_t in_format= BGP_ROUTES_INPUT_MRT_ASC;
   uint8_t out_format= BGP_ROUTES_OUTPUT_CISCO;
+  unsigned long num_routes;
+  unsigned int num_threads;
+  double start, duration;
   int option, result;
-  char * filter;
+  long num_cpus;
 
   libcbgp_init(argc, argv);
 
+  dump_ctx.in_format= BGP_ROUTES_INPUT_MRT_ASC;
+  dump_ctx.out_format= DUMP_OUT_TEXT;
+  num_cpus= sysconf(_SC_NPROCESSORS_ONLN);
+  dump_ctx.num_threads= (num_cpus > 0)?num_cpus:1;
+  dump_ctx.mrt_time= time(NULL);
+
   // Parse options
   while ((option= getopt_long(argc, argv, "", longopts, NULL)) != -1) {
     switch (option) {
     case OPTION_FILTER:
-      filter= strdup(optarg);
       if (dump_ctx.matcher != NULL) {
 	stream_printf(gdserr, "Error: route filter already specified.\n");
 	return EXIT_FAILURE;
       }
-      result= predicate_parser(filter, &dump_ctx.matcher);
+      result= predicate_parser(optarg, &dump_ctx.matcher);
       if (result != PREDICATE_PARSER_SUCCESS) {
 	stream_printf(gdserr, "Error: invalid route filter \"%s\" [", optarg);
 	predicate_parser_perror(gdserr, result);
@@ -177,13 +797,17 @@ int main(int argc, char * argv[])
       usage();
       return EXIT_SUCCESS;
     case OPTION_IN_FORMAT:
-      if (bgp_routes_str2format(optarg, &in_format) != 0) {
+      if (bgp_routes_str2format(optarg, &dump_ctx.in_format) != 0) {
 	stream_printf(gdserr, "Error: invalid input format \"%s\".\n", optarg);
 	return EXIT_FAILURE;
       }
       break;
     case OPTION_OUT_FORMAT:
-      if (route_str2mode(optarg, &out_format) != 0) {
+      if (!strcmp(optarg, "binary"))
+	dump_ctx.out_format= DUMP_OUT_BINARY;
+      else if (!strcmp(optarg, "mrt-v2"))
+	dump_ctx.out_format= DUMP_OUT_MRT_V2;
+      else if (route_str2mode(optarg, &out_format) != 0) {
 	stream_printf(gdserr, "Error: invalid output format \"%s\".\n",
 		      optarg);
 	return EXIT_FAILURE;
@@ -196,6 +820,14 @@ int main(int argc, char * argv[])
       }
       dump_ctx.out_spec= strdup(optarg);
       break;
+    case OPTION_THREADS:
+      if (str_as_uint(optarg, &num_threads) || (num_threads < 1)) {
+	stream_printf(gdserr, "Error: invalid number of threads \"%s\".\n",
+		      optarg);
+	return EXIT_FAILURE;
+      }
+      dump_ctx.num_threads= num_threads;
+      break;
     default:
       usage();
       return EXIT_FAILURE;
@@ -208,31 +840,32 @@ int main(int argc, char * argv[])
   }
 
   route_set_show_mode(out_format, dump_ctx.out_spec);
+  if (dump_ctx.out_format == DUMP_OUT_BINARY)
+    fwrite(ROUTE_STREAM_MAGIC, ROUTE_STREAM_MAGIC_SIZE, 1, stdout);
 
   // Parse input file(s)
-  while (optind < argc) {
-
-    stream_printf(gdserr, "Reading from \"%s\"...\n", argv[optind]);
-
-    result= bgp_routes_load(argv[optind], in_format, _handler, &dump_ctx);
-    if (result != 0) {
-      stream_printf(gdserr, "Error: an error (%d) occured while "
-		    "reading \"%s\"", result, argv[optind]);
-      libcbgp_done();
-      return EXIT_SUCCESS;
-    }
-    optind++;
-  }
+  start= _dump_now();
+  result= _dump_run(&dump_ctx, argc, argv);
+  duration= _dump_now() - start;
+  if (result != 0)
+    return EXIT_FAILURE;
 
   // Print statistics
+  num_routes= (dump_ctx.num_routes_ok + dump_ctx.num_routes_ignored +
+	       dump_ctx.num_routes_filtered);
   stream_printf(gdserr, "\n");
   stream_printf(gdserr, "Summary:\n");
-  stream_printf(gdserr, "  routes dumped  : %d\n",
+  stream_printf(gdserr, "  routes dumped  : %lu\n",
 		dump_ctx.num_routes_ok);
-  stream_printf(gdserr, "  routes ignored : %d\n",
+  stream_printf(gdserr, "  routes ignored : %lu\n",
 		dump_ctx.num_routes_ignored);
-  stream_printf(gdserr, "  routes filtered: %d\n",
+  stream_printf(gdserr, "  routes filtered: %lu\n",
 		dump_ctx.num_routes_filtered);
+  stream_printf(gdserr, "  threads        : %u\n", dump_ctx.num_threads);
+  stream_printf(gdserr, "  time (s)       : %.3f\n", duration);
+  if (duration > 0)
+    stream_printf(gdserr, "  routes/s       : %.0f\n",
+		  num_routes / duration);
 
   return EXIT_SUCCESS;
 }
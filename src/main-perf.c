@@ -1,7 +1,12 @@
 // ==================================================================
-// @(#)main-test.c
+// @(#)main-perf.c
 //
-// Main source file for cbgp-test application.
+// Main source file for cbgp-perf application.
+//
+// cbgp-perf runs a set of named benchmarks on the hot paths of the
+// simulator. The workloads are synthetic and generated from a seed,
+// so that two runs with the same options measure exactly the same
+// work. Results can be printed as JSON for regression tracking.
 //
 // @author Bruno Quoitin (bruno.quoitin@uclouvain.be)
 // @date 02/10/07
@@ -13,16 +18,39 @@
 #endif
 
 #include <assert.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include <libgds/hash_utils.h>
+#include <libgds/memory.h>
 #include <libgds/str_util.h>
 
 #include <api.h>
+#include <bgp/as.h>
 #include <bgp/attr/comm.h>
+#include <bgp/attr/origin.h>
 #include <bgp/attr/path.h>
+#include <bgp/domain.h>
+#include <bgp/dp_rules.h>
+#include <bgp/filter/filter.h>
+#include <bgp/filter/predicate_parser.h>
 #include <bgp/mrtd.h>
+#include <bgp/peer.h>
 #include <bgp/route.h>
+#include <bgp/routes_list.h>
+#include <net/ez_topo.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/routing.h>
+#include <net/tm.h>
+#include <sim/simulator.h>
+#include <util/rng.h>
 
 // -----[ test_rib_perf ]--------------------------------------------
 /**
@@ -115,12 +143,11 @@ static int _array_comm_compare(const void * item1,
 static inline size_t path_to_buf(bgp_path_t * path, uint8_t * buf,
 				 size_t size)
 {
-  unsigned int index, index2;
-  bgp_path_seg_t * seg;
+  unsigned int index2;
+  bgp_path_seg_t * seg= NULL;
   uint8_t * buf_start= buf;
 
-  for (index= 0; index < path_num_segments(path); index++) {
-    seg= (bgp_path_seg_t *) path->data[index];
+  while ((seg= path_segment_next(path, seg)) != NULL) {
     *(buf++)= seg->type;
     for (index2= 0; index2 < seg->length; index2++) {
       *(buf++)= seg->asns[index2] & 255;
@@ -303,9 +330,9 @@ typedef uint32_t (*FHashFunction)(const void * pItem, unsigned int);
 typedef struct {
   FHashFunction fHashFunc;
   char *        name;
-} hash_method_t;
+} perf_hash_method_t;
 
-hash_method_t PATH_HASH_METHODS[]= {
+perf_hash_method_t PATH_HASH_METHODS[]= {
   {path_strhash, "Path-String"},
   {path_hash_zebra, "Path-Zebra"},
   {path_hash_OAT, "Path-OAT"},
@@ -313,7 +340,7 @@ hash_method_t PATH_HASH_METHODS[]= {
 };
 #define PATH_HASH_METHODS_NUM sizeof(PATH_HASH_METHODS)/sizeof(PATH_HASH_METHODS[0])
 
-hash_method_t COMM_HASH_METHODS[]= {
+perf_hash_method_t COMM_HASH_METHODS[]= {
   {comm_strhash, "Comm-String"},
   {comm_hash_zebra, "Comm-Zebra"},
   /*{comm_hash_OAT, "Comm-OAT"},*/
@@ -322,7 +349,7 @@ hash_method_t COMM_HASH_METHODS[]= {
 #define COMM_HASH_METHODS_NUM sizeof(COMM_HASH_METHODS)/sizeof(COMM_HASH_METHODS[0])
 
 typedef struct {
-  hash_method_t * methods;
+  perf_hash_method_t * methods;
   uint8_t         num_methods;
   char *          name;
   ptr_array_t   * array;
@@ -428,7 +455,7 @@ int test_path_hash_perf(int argc, char * argv[])
 
   for (attr_index= 0; attr_index < ATTR_INFOS_NUM; attr_index++) {
 
-    hash_method_t * methods= ATTR_INFOS[attr_index].methods;
+    perf_hash_method_t * methods= ATTR_INFOS[attr_index].methods;
     uint8_t num_methods= ATTR_INFOS[attr_index].num_methods;
     ptr_array_t * array= ATTR_INFOS[attr_index].array;
 
@@ -499,20 +526,806 @@ int test_path_hash_perf(int argc, char * argv[])
   return 0;
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// BENCHMARKS
+//
+/////////////////////////////////////////////////////////////////////
+
+// ASN and IGP domain identifiers reserved for the benchmarks. Each
+// benchmark that creates BGP routers uses its own ASN so that the
+// BGP domains do not mix when several benchmarks run in sequence.
+#define PERF_ASN_DECISION  64512
+#define PERF_ASN_FULL_MESH 64513
+#define PERF_TM_DOMAIN     64514
+
+/** Number of distinct sets of candidates in the decision benchmark. */
+#define PERF_DECISION_SETS 64
+
+#define PERF_LINE_SIZE     1024
+
+// -----[ _perf_ctx_t ]----------------------------------------------
+typedef struct {
+  unsigned long  seed;
+  unsigned int   scale;
+  unsigned int   iterations;
+  unsigned int   num_nodes;
+  unsigned int   num_routers;
+  unsigned int   num_candidates;
+  const char   * mrt_file;
+} _perf_ctx_t;
+
+// -----[ _perf_result_t ]-------------------------------------------
+/**
+ * Result of a benchmark. The check value summarizes the outcome of
+ * the measured work (number of matches, sum of metrics, ...). It
+ * must only depend on the workload, which makes it possible to
+ * detect when two runs did not measure the same thing.
+ */
+typedef struct {
+  unsigned long ops;
+  double        seconds;
+  unsigned long check;
+} _perf_result_t;
+
+typedef int (*_perf_bench_f)(_perf_ctx_t * ctx, rng_t * rng,
+			     _perf_result_t * result);
+
+// -----[ _perf_bench_t ]--------------------------------------------
+typedef struct {
+  const char    * name;
+  const char    * descr;
+  _perf_bench_f   run;
+} _perf_bench_t;
+
+// -----[ _perf_now ]------------------------------------------------
+static inline double _perf_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -----[ _perf_prefix ]---------------------------------------------
+/** Generate a random prefix with a length between 8 and 24. */
+static inline ip_pfx_t _perf_prefix(rng_t * rng)
+{
+  ip_pfx_t prefix;
+  prefix.mask= 8 + rng_range(rng, 17);
+  prefix.network= rng_next(rng) & ~((1 << (32-prefix.mask))-1);
+  return prefix;
+}
+
+// -----[ _perf_route ]----------------------------------------------
+/**
+ * Generate a random route. The AS-Path contains 1 to 6 ASNs and the
+ * route carries up to 3 communities.
+ */
+static bgp_route_t * _perf_route(rng_t * rng, bgp_peer_t * peer,
+				 net_addr_t next_hop)
+{
+  bgp_route_t * route;
+  bgp_path_t * path= path_create();
+  bgp_comms_t * comms= NULL;
+  unsigned int index, length;
+
+  route= route_create(_perf_prefix(rng), peer, next_hop,
+		      rng_range(rng, 3));
+  length= 1 + rng_range(rng, 6);
+  for (index= 0; index < length; index++)
+    path_append(&path, 1 + rng_range(rng, 65535));
+  route_set_path(route, path);
+  length= rng_range(rng, 4);
+  if (length > 0) {
+    comms= comms_create();
+    for (index= 0; index < length; index++)
+      comms_add(&comms, rng_next(rng));
+  }
+  route_set_comm(route, comms);
+  route_localpref_set(route, 80 + 20 * rng_range(rng, 3));
+  route_med_set(route, rng_range(rng, 10));
+  return route;
+}
+
+// -----[ _perf_mrt_line ]-------------------------------------------
+/** Format a route as an MRT ASCII record (TABLE_DUMP). */
+static int _perf_mrt_line(bgp_route_t * route, net_addr_t peer_addr,
+			  asn_t peer_asn, char * buf, size_t size)
+{
+  char peer_str[16], prefix_str[20], nh_str[16];
+  char path_str[PERF_LINE_SIZE], comms_str[PERF_LINE_SIZE];
+
+  ip_address_to_string(peer_addr, peer_str, sizeof(peer_str));
+  ip_prefix_to_string(&route->prefix, prefix_str, sizeof(prefix_str));
+  ip_address_to_string(route->attr->next_hop, nh_str, sizeof(nh_str));
+  path_to_string(route->attr->path_ref, 1, path_str, sizeof(path_str));
+  comm_to_string(route->attr->comms, comms_str, sizeof(comms_str));
+  return snprintf(buf, size, "TABLE_DUMP|0|B|%s|%u|%s|%s|%s|%s|%u|%u|%s"
+		  "|NAG||", peer_str, peer_asn, prefix_str, path_str,
+		  bgp_origin_to_str(route->attr->origin), nh_str,
+		  route->attr->local_pref, route->attr->med, comms_str);
+}
+
+// -----[ _perf_topo ]-----------------------------------------------
+/**
+ * Generate a random connected topology. Each node is attached to a
+ * random predecessor (which yields a spanning tree) and, possibly,
+ * to a second one through a chord. IGP weights are between 1 and
+ * 100.
+ */
+static ez_topo_t * _perf_topo(rng_t * rng, unsigned int num_nodes)
+{
+  ez_node_t * nodes= (ez_node_t *) MALLOC(sizeof(ez_node_t)*num_nodes);
+  ez_edge_t * edges= (ez_edge_t *) MALLOC(sizeof(ez_edge_t)*2*num_nodes);
+  unsigned int num_edges= 0;
+  unsigned int index, parent, chord;
+  ez_topo_t * topo;
+
+  for (index= 0; index < num_nodes; index++) {
+    nodes[index]= (ez_node_t) { .type=NODE, .domain=1 };
+    if (index == 0)
+      continue;
+    parent= rng_range(rng, index);
+    edges[num_edges++]= (ez_edge_t) { .src=index, .dst=parent,
+				      .weight=1+rng_range(rng, 100) };
+    chord= rng_range(rng, index);
+    if (chord != parent)
+      edges[num_edges++]= (ez_edge_t) { .src=index, .dst=chord,
+					.weight=1+rng_range(rng, 100) };
+  }
+  topo= ez_topo_builder(num_nodes, nodes, num_edges, edges);
+  FREE(nodes);
+  FREE(edges);
+  return topo;
+}
+
+// -----[ _perf_mrt_load ]-------------------------------------------
+/**
+ * Parse MRT ASCII records. The records are either read from the
+ * file given with --mrt or generated. They are kept in memory so
+ * that only the parsing is measured.
+ */
+static int _perf_mrt_load(_perf_ctx_t * ctx, rng_t * rng,
+			  _perf_result_t * result)
+{
+  char ** lines;
+  unsigned int num_lines= 0, index, iter;
+  char buf[PERF_LINE_SIZE];
+  bgp_route_t * route;
+  net_addr_t peer_addr;
+  asn_t peer_asn;
+  FILE * file;
+  double start;
+
+  lines= (char **) MALLOC(sizeof(char *)*ctx->scale);
+  if (ctx->mrt_file != NULL) {
+    file= fopen(ctx->mrt_file, "r");
+    if (file == NULL) {
+      stream_printf(gdserr, "Error: could not open \"%s\"\n", ctx->mrt_file);
+      FREE(lines);
+      return -1;
+    }
+    while ((num_lines < ctx->scale) &&
+	   (fgets(buf, sizeof(buf), file) != NULL)) {
+      buf[strcspn(buf, "\r\n")]= '\0';
+      lines[num_lines++]= str_create(buf);
+    }
+    fclose(file);
+  } else {
+    for (; num_lines < ctx->scale; num_lines++) {
+      peer_addr= IPV4(10,0,0,1) + rng_range(rng, 16);
+      route= _perf_route(rng, NULL, peer_addr);
+      _perf_mrt_line(route, peer_addr, 1 + rng_range(rng, 64),
+		     buf, sizeof(buf));
+      route_destroy(&route);
+      lines[num_lines]= str_create(buf);
+    }
+  }
+
+  start= _perf_now();
+  for (iter= 0; iter < ctx->iterations; iter++)
+    for (index= 0; index < num_lines; index++) {
+      route= NULL;
+      if ((mrtd_route_from_line(lines[index], &peer_addr, &peer_asn,
+				&route) >= 0) && (route != NULL)) {
+	result->check++;
+	route_destroy(&route);
+      }
+    }
+  result->seconds= _perf_now() - start;
+  result->ops= num_lines * ctx->iterations;
+
+  for (index= 0; index < num_lines; index++)
+    str_destroy(&lines[index]);
+  FREE(lines);
+  return 0;
+}
+
+// -----[ _perf_decision ]-------------------------------------------
+/**
+ * Run the decision process rules over K candidate routes for the
+ * same prefix. The candidates are learned from a mix of iBGP and
+ * eBGP peers and share the same (reachable) BGP next-hop, so that
+ * ties can propagate down to the last rules.
+ */
+static int _perf_decision(_perf_ctx_t * ctx, rng_t * rng,
+			  _perf_result_t * result)
+{
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+  };
+  ez_topo_t * topo= ez_topo_builder(2, nodes, 1, edges);
+  unsigned int num_routes= PERF_DECISION_SETS * ctx->num_candidates;
+  bgp_route_t ** candidates;
+  bgp_routes_t * routes;
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  net_addr_t next_hop;
+  unsigned int index, rule, run, num_runs;
+  double start;
+
+  ez_topo_igp_compute(topo, 1);
+  next_hop= ez_topo_get_node(topo, 1)->rid;
+  bgp_add_router(PERF_ASN_DECISION, ez_topo_get_node(topo, 0), &router);
+
+  candidates= (bgp_route_t **) MALLOC(sizeof(bgp_route_t *)*num_routes);
+  for (index= 0; index < ctx->num_candidates; index++) {
+    bgp_router_add_peer(router,
+			(index % 2)?PERF_ASN_DECISION:1+index,
+			IPV4(192,168,index >> 8,index & 255), &peer);
+    for (run= 0; run < PERF_DECISION_SETS; run++) {
+      candidates[run*ctx->num_candidates+index]=
+	_perf_route(rng, peer, next_hop);
+      candidates[run*ctx->num_candidates+index]->prefix=
+	IPV4PFX(10,0,0,0,8);
+    }
+  }
+
+  num_runs= ctx->scale * ctx->iterations;
+  start= _perf_now();
+  for (run= 0; run < num_runs; run++) {
+    routes= routes_list_create(ROUTES_LIST_OPTION_REF);
+    for (index= 0; index < ctx->num_candidates; index++)
+      routes_list_append(routes,
+			 candidates[(run % PERF_DECISION_SETS)*
+				    ctx->num_candidates+index]);
+    for (rule= 0; rule < DP_NUM_RULES; rule++) {
+      if (bgp_routes_size(routes) <= 1)
+	break;
+      DP_RULES[rule].rule(router, routes);
+    }
+    result->check+= rule;
+    routes_list_destroy(&routes);
+  }
+  result->seconds= _perf_now() - start;
+  result->ops= num_runs;
+
+  for (index= 0; index < num_routes; index++)
+    route_destroy(&candidates[index]);
+  FREE(candidates);
+  ez_topo_destroy(&topo);
+  return 0;
+}
+
+// -----[ _perf_filter ]---------------------------------------------
+/** Evaluate a filter predicate on random routes. */
+static int _perf_filter(_perf_ctx_t * ctx, rng_t * rng,
+			_perf_result_t * result)
+{
+  const char * expr= "(prefix in 10/8 & next-hop in 10/8) | "
+    "community is 1 | path \"^(1_)\"";
+  bgp_ft_matcher_t * matcher;
+  bgp_route_t ** routes;
+  unsigned int index, iter;
+  double start;
+
+  if (predicate_parser(expr, &matcher) != PREDICATE_PARSER_SUCCESS) {
+    stream_printf(gdserr, "Error: could not parse \"%s\"\n", expr);
+    return -1;
+  }
+
+  routes= (bgp_route_t **) MALLOC(sizeof(bgp_route_t *)*ctx->scale);
+  for (index= 0; index < ctx->scale; index++)
+    routes[index]= _perf_route(rng, NULL, rng_next(rng));
+
+  start= _perf_now();
+  for (iter= 0; iter < ctx->iterations; iter++)
+    for (index= 0; index < ctx->scale; index++)
+      if (filter_matcher_apply(matcher, NULL, routes[index]))
+	result->check++;
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->scale * ctx->iterations;
+
+  for (index= 0; index < ctx->scale; index++)
+    route_destroy(&routes[index]);
+  FREE(routes);
+  filter_matcher_destroy(&matcher);
+  return 0;
+}
+
+// -----[ _perf_spt ]------------------------------------------------
+/**
+ * Compute the IGP routes of a random topology. Each computation
+ * builds one shortest-path tree per node.
+ */
+static int _perf_spt(_perf_ctx_t * ctx, rng_t * rng,
+		     _perf_result_t * result)
+{
+  ez_topo_t * topo= _perf_topo(rng, ctx->num_nodes);
+  net_node_t * node= ez_topo_get_node(topo, 0);
+  rt_info_t * rtinfo;
+  unsigned int index;
+  double start;
+
+  start= _perf_now();
+  for (index= 0; index < ctx->iterations; index++)
+    if (ez_topo_igp_compute(topo, 1) != ESUCCESS) {
+      ez_topo_destroy(&topo);
+      return -1;
+    }
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->num_nodes * ctx->iterations;
+
+  for (index= 1; index < ctx->num_nodes; index++) {
+    rtinfo= rt_find_best(node->rt, ez_topo_get_node(topo, index)->rid,
+			 NET_ROUTE_ANY);
+    if (rtinfo != NULL)
+      result->check+= rtinfo->metric;
+  }
+  ez_topo_destroy(&topo);
+  return 0;
+}
+
+// -----[ _perf_fib ]------------------------------------------------
+/** Longest-match lookups of random addresses in a random FIB. */
+static int _perf_fib(_perf_ctx_t * ctx, rng_t * rng,
+		     _perf_result_t * result)
+{
+  net_rt_t * rt= rt_create();
+  rt_info_t * rtinfo;
+  ip_pfx_t prefix;
+  net_addr_t * addrs;
+  unsigned int index, iter;
+  double start;
+
+  for (index= 0; index < ctx->scale; index++) {
+    prefix= _perf_prefix(rng);
+    rtinfo= rt_info_create(prefix, rng_range(rng, 100),
+			   NET_ROUTE_STATIC);
+    if (rt_add_route(rt, prefix, rtinfo) != ESUCCESS)
+      rt_info_destroy(&rtinfo);
+  }
+  addrs= (net_addr_t *) MALLOC(sizeof(net_addr_t)*ctx->scale);
+  for (index= 0; index < ctx->scale; index++)
+    addrs[index]= rng_next(rng);
+
+  start= _perf_now();
+  for (iter= 0; iter < ctx->iterations; iter++)
+    for (index= 0; index < ctx->scale; index++)
+      if (rt_find_best(rt, addrs[index], NET_ROUTE_ANY) != NULL)
+	result->check++;
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->scale * ctx->iterations;
+
+  FREE(addrs);
+  rt_destroy(&rt);
+  return 0;
+}
+
+// -----[ _perf_sched_event ]----------------------------------------
+static int _perf_sched_event(simulator_t * sim, void * ctx)
+{
+  (*((unsigned long *) ctx))++;
+  return 0;
+}
+
+static sim_event_ops_t _perf_sched_ops= {
+  .callback= _perf_sched_event,
+  .name    = "perf",
+};
+
+// -----[ _perf_sched ]----------------------------------------------
+/**
+ * Post events at random times, then run the simulator until all of
+ * them have been popped.
+ */
+static int _perf_sched(_perf_ctx_t * ctx, rng_t * rng,
+		       _perf_result_t * result, sched_type_t type)
+{
+  simulator_t * sim= sim_create(type);
+  double * times= (double *) MALLOC(sizeof(double)*ctx->scale);
+  unsigned int index, iter;
+  double start;
+
+  for (index= 0; index < ctx->scale; index++)
+    times[index]= rng_range(rng, 1000000) / 1000.0;
+
+  start= _perf_now();
+  for (iter= 0; iter < ctx->iterations; iter++) {
+    for (index= 0; index < ctx->scale; index++)
+      sim_post_event(sim, &_perf_sched_ops, &result->check, times[index],
+		     SIM_TIME_REL);
+    sim_run(sim);
+  }
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->scale * ctx->iterations;
+
+  FREE(times);
+  sim_destroy(&sim);
+  return 0;
+}
+
+// -----[ _perf_sched_static ]---------------------------------------
+static int _perf_sched_static(_perf_ctx_t * ctx, rng_t * rng,
+			      _perf_result_t * result)
+{
+  return _perf_sched(ctx, rng, result, SCHEDULER_STATIC);
+}
+
+// -----[ _perf_sched_dynamic ]--------------------------------------
+static int _perf_sched_dynamic(_perf_ctx_t * ctx, rng_t * rng,
+			       _perf_result_t * result)
+{
+  return _perf_sched(ctx, rng, result, SCHEDULER_DYNAMIC);
+}
+
+// -----[ _perf_full_mesh ]------------------------------------------
+/**
+ * Converge a full-mesh of iBGP routers on a random topology. The
+ * routers originate random /24 prefixes. The measured time includes
+ * the establishment of the sessions. This benchmark is run once,
+ * whatever the number of iterations.
+ */
+static int _perf_full_mesh(_perf_ctx_t * ctx, rng_t * rng,
+			   _perf_result_t * result)
+{
+  ez_topo_t * topo= _perf_topo(rng, ctx->num_routers);
+  bgp_router_t ** routers;
+  ip_pfx_t * prefixes;
+  unsigned int index;
+  double start;
+
+  ez_topo_igp_compute(topo, 1);
+  routers= (bgp_router_t **) MALLOC(sizeof(bgp_router_t *)*
+				    ctx->num_routers);
+  for (index= 0; index < ctx->num_routers; index++)
+    bgp_add_router(PERF_ASN_FULL_MESH, ez_topo_get_node(topo, index),
+		   &routers[index]);
+  prefixes= (ip_pfx_t *) MALLOC(sizeof(ip_pfx_t)*ctx->scale);
+  for (index= 0; index < ctx->scale; index++) {
+    prefixes[index]= net_prefix(rng_next(rng), 24);
+    bgp_router_add_network(routers[rng_range(rng, ctx->num_routers)],
+			   prefixes[index]);
+  }
+
+  start= _perf_now();
+  if (bgp_domain_full_mesh(get_bgp_domain(PERF_ASN_FULL_MESH), 0)
+      != ESUCCESS) {
+    FREE(prefixes);
+    FREE(routers);
+    ez_topo_destroy(&topo);
+    return -1;
+  }
+  ez_topo_sim_run(topo);
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->scale;
+
+  for (index= 0; index < ctx->scale; index++)
+    if (bgp_router_find_best(routers[0], prefixes[index]) != NULL)
+      result->check++;
+  FREE(prefixes);
+  FREE(routers);
+  ez_topo_destroy(&topo);
+  return 0;
+}
+
+// -----[ _perf_tm ]-------------------------------------------------
+/**
+ * Load a random traffic matrix. The traffic matrix loader works on
+ * the default network, where a random topology is built.
+ */
+static int _perf_tm(_perf_ctx_t * ctx, rng_t * rng,
+		    _perf_result_t * result)
+{
+  network_t * network= network_get_default();
+  igp_domain_t * domain= igp_domain_create(PERF_TM_DOMAIN, IGP_DOMAIN_IGP);
+  net_node_t ** nodes;
+  net_iface_t * iface;
+  char src_str[16], dst_str[16];
+  unsigned int index, iter, peer;
+  FILE * file;
+  double start;
+  int error= 0;
+
+  network_add_igp_domain(network, domain);
+  nodes= (net_node_t **) MALLOC(sizeof(net_node_t *)*ctx->num_nodes);
+  for (index= 0; index < ctx->num_nodes; index++) {
+    node_create(IPV4(172,16,0,1) + index, &nodes[index],
+		NODE_OPTIONS_LOOPBACK);
+    network_add_node(network, nodes[index]);
+    igp_domain_add_router(domain, nodes[index]);
+    if (index == 0)
+      continue;
+    peer= rng_range(rng, index);
+    if (net_link_create_rtr(nodes[index], nodes[peer], BIDIR,
+			    &iface) == ESUCCESS)
+      net_iface_set_metric(iface, 0, 1 + rng_range(rng, 100), BIDIR);
+  }
+  igp_domain_compute(domain, 0);
+
+  file= tmpfile();
+  if (file == NULL) {
+    FREE(nodes);
+    return -1;
+  }
+  for (index= 0; index < ctx->scale; index++) {
+    ip_address_to_string(nodes[rng_range(rng, ctx->num_nodes)]->rid,
+			 src_str, sizeof(src_str));
+    ip_address_to_string(nodes[rng_range(rng, ctx->num_nodes)]->rid,
+			 dst_str, sizeof(dst_str));
+    fprintf(file, "%s %s %s %u\n", src_str, src_str, dst_str,
+	    1 + rng_range(rng, 1000));
+  }
+
+  start= _perf_now();
+  for (iter= 0; (iter < ctx->iterations) && (error == 0); iter++) {
+    rewind(file);
+    error= net_tm_parser(file);
+  }
+  result->seconds= _perf_now() - start;
+  result->ops= ctx->scale * ctx->iterations;
+  result->check= iter;
+
+  fclose(file);
+  FREE(nodes);
+  if (error != 0) {
+    stream_printf(gdserr, "Error: could not load traffic matrix (");
+    net_tm_perror(gdserr, error);
+    stream_printf(gdserr, ")\n");
+    return -1;
+  }
+  return 0;
+}
+
+static _perf_bench_t BENCHMARKS[]= {
+  { "mrt-load", "parse MRT ASCII records", _perf_mrt_load },
+  { "decision", "decision process over K candidates", _perf_decision },
+  { "filter", "filter predicate evaluation", _perf_filter },
+  { "spt", "IGP computation on a random topology", _perf_spt },
+  { "fib", "longest-match FIB lookup", _perf_fib },
+  { "sched-static", "post/pop events (static scheduler)",
+    _perf_sched_static },
+  { "sched-dynamic", "post/pop events (dynamic scheduler)",
+    _perf_sched_dynamic },
+  { "full-mesh", "iBGP full-mesh convergence", _perf_full_mesh },
+  { "tm", "traffic matrix loading", _perf_tm },
+};
+#define NUM_BENCHMARKS sizeof(BENCHMARKS)/sizeof(BENCHMARKS[0])
+
+// -----[ _perf_find ]-----------------------------------------------
+static _perf_bench_t * _perf_find(const char * name)
+{
+  unsigned int index;
+  for (index= 0; index < NUM_BENCHMARKS; index++)
+    if (!strcmp(BENCHMARKS[index].name, name))
+      return &BENCHMARKS[index];
+  return NULL;
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // MAIN PART
 //
 /////////////////////////////////////////////////////////////////////
 
+enum {
+  OPTION_CANDIDATES,
+  OPTION_HELP,
+  OPTION_ITERATIONS,
+  OPTION_JSON,
+  OPTION_LIST,
+  OPTION_MRT,
+  OPTION_NODES,
+  OPTION_ROUTERS,
+  OPTION_SCALE,
+  OPTION_SEED,
+} options_t;
+
+static struct option longopts[]= {
+  {"candidates", required_argument, NULL, OPTION_CANDIDATES},
+  {"help", no_argument, NULL, OPTION_HELP},
+  {"iterations", required_argument, NULL, OPTION_ITERATIONS},
+  {"json", no_argument, NULL, OPTION_JSON},
+  {"list", no_argument, NULL, OPTION_LIST},
+  {"mrt", required_argument, NULL, OPTION_MRT},
+  {"nodes", required_argument, NULL, OPTION_NODES},
+  {"routers", required_argument, NULL, OPTION_ROUTERS},
+  {"scale", required_argument, NULL, OPTION_SCALE},
+  {"seed", required_argument, NULL, OPTION_SEED},
+  {NULL, 0, NULL, 0},
+};
+
+// -----[ usage ]----------------------------------------------------
+static void usage()
+{
+  printf("C-BGP Benchmarks\n");
+  printf("Copyright (C) 2026, Bruno Quoitin\n");
+  printf("\n");
+  printf("Usage: cbgp-perf [OPTIONS] [BENCHMARK...]\n");
+  printf("       cbgp-perf path-hash HASH-SIZE FILE...\n");
+  printf("\n");
+  printf("  --seed=N        seed of the workloads (default: 1)\n");
+  printf("  --scale=N       size of the workloads (default: 10000)\n");
+  printf("  --iterations=N  repetitions of the measured work (default: 1)\n");
+  printf("  --nodes=N       number of nodes (spt, tm; default: 200)\n");
+  printf("  --routers=N     number of routers (full-mesh; default: 8)\n");
+  printf("  --candidates=N  candidate routes (decision; default: 16)\n");
+  printf("  --mrt=FILE      MRT ASCII records for mrt-load\n");
+  printf("  --json          print the results in JSON\n");
+  printf("  --list          list the benchmarks\n");
+  printf("\n");
+  printf("All the benchmarks are run if none is specified.\n");
+  printf("\n");
+}
+
+// -----[ _main_parse_uint ]-----------------------------------------
+static int _main_parse_uint(const char * name, const char * arg,
+			    unsigned int * value_ref)
+{
+  if (str_as_uint(arg, value_ref) || (*value_ref < 1)) {
+    stream_printf(gdserr, "Error: invalid %s \"%s\".\n", name, arg);
+    return -1;
+  }
+  return 0;
+}
+
 // -----[ main ]-----------------------------------------------------
 int main(int argc, char * argv[])
 {
+  _perf_ctx_t ctx= {
+    .seed          = 1,
+    .scale         = 10000,
+    .iterations    = 1,
+    .num_nodes     = 200,
+    .num_routers   = 8,
+    .num_candidates= 16,
+    .mrt_file      = NULL,
+  };
+  _perf_bench_t * selected[NUM_BENCHMARKS];
+  unsigned int num_selected= 0;
+  _perf_bench_t * bench;
+  _perf_result_t result;
+  rng_t rng;
+  unsigned int index, index2, num_printed= 0;
+  int option, json= 0, error= 0;
+
   libcbgp_init(argc, argv);
-  libcbgp_banner();
 
-  test_path_hash_perf(argc, argv);
+  // Parse options
+  while ((option= getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+    switch (option) {
+    case OPTION_CANDIDATES:
+      if (_main_parse_uint("number of candidates", optarg,
+			   &ctx.num_candidates) < 0)
+	return EXIT_FAILURE;
+      break;
+    case OPTION_HELP:
+      usage();
+      return EXIT_SUCCESS;
+    case OPTION_ITERATIONS:
+      if (_main_parse_uint("number of iterations", optarg,
+			   &ctx.iterations) < 0)
+	return EXIT_FAILURE;
+      break;
+    case OPTION_JSON:
+      json= 1;
+      break;
+    case OPTION_LIST:
+      for (index= 0; index < NUM_BENCHMARKS; index++)
+	stream_printf(gdsout, "%-15s %s\n", BENCHMARKS[index].name,
+		      BENCHMARKS[index].descr);
+      return EXIT_SUCCESS;
+    case OPTION_MRT:
+      ctx.mrt_file= optarg;
+      break;
+    case OPTION_NODES:
+      if (_main_parse_uint("number of nodes", optarg, &ctx.num_nodes) < 0)
+	return EXIT_FAILURE;
+      break;
+    case OPTION_ROUTERS:
+      if (_main_parse_uint("number of routers", optarg,
+			   &ctx.num_routers) < 0)
+	return EXIT_FAILURE;
+      break;
+    case OPTION_SCALE:
+      if (_main_parse_uint("scale", optarg, &ctx.scale) < 0)
+	return EXIT_FAILURE;
+      break;
+    case OPTION_SEED:
+      if (str_as_ulong(optarg, &ctx.seed)) {
+	stream_printf(gdserr, "Error: invalid seed \"%s\".\n", optarg);
+	return EXIT_FAILURE;
+      }
+      break;
+    default:
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Hash functions evaluation (on real routing tables)
+  if ((optind < argc) && !strcmp(argv[optind], "path-hash")) {
+    error= test_path_hash_perf(argc-optind, argv+optind);
+    libcbgp_done();
+    return (error == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+  }
+
+  // Select benchmarks
+  for (; optind < argc; optind++) {
+    bench= _perf_find(argv[optind]);
+    if (bench == NULL) {
+      stream_printf(gdserr, "Error: unknown benchmark \"%s\".\n",
+		    argv[optind]);
+      return EXIT_FAILURE;
+    }
+    for (index2= 0; index2 < num_selected; index2++)
+      if (selected[index2] == bench)
+	break;
+    if (index2 < num_selected) {
+      stream_printf(gdserr, "Error: benchmark \"%s\" selected twice.\n",
+		    argv[optind]);
+      return EXIT_FAILURE;
+    }
+    selected[num_selected++]= bench;
+  }
+  if (num_selected == 0)
+    for (; num_selected < NUM_BENCHMARKS; num_selected++)
+      selected[num_selected]= &BENCHMARKS[num_selected];
+
+  if (json)
+    stream_printf(gdsout, "{\"seed\": %lu, \"scale\": %u, "
+		  "\"iterations\": %u, \"benchmarks\": [",
+		  ctx.seed, ctx.scale, ctx.iterations);
+  else {
+    libcbgp_banner();
+    stream_printf(gdsout, "\n%-15s %12s %10s %14s %12s\n", "benchmark",
+		  "ops", "time (s)", "ops/s", "check");
+  }
+
+  // Run benchmarks
+  for (index= 0; index < num_selected; index++) {
+    bench= selected[index];
+    rng_init(&rng, ctx.seed, bench->name);
+    memset(&result, 0, sizeof(result));
+    if (bench->run(&ctx, &rng, &result) < 0) {
+      stream_printf(gdserr, "Error: benchmark \"%s\" failed.\n",
+		    bench->name);
+      error= 1;
+      continue;
+    }
+    if (json)
+      stream_printf(gdsout, "%s\n  {\"name\": \"%s\", \"ops\": %lu, "
+		    "\"seconds\": %.6f, \"ops_per_sec\": %.1f, "
+		    "\"check\": %lu}", (num_printed > 0)?",":"", bench->name,
+		    result.ops, result.seconds,
+		    (result.seconds > 0)?result.ops/result.seconds:0.0,
+		    result.check);
+    else
+      stream_printf(gdsout, "%-15s %12lu %10.3f %14.0f %12lu\n",
+		    bench->name, result.ops, result.seconds,
+		    (result.seconds > 0)?result.ops/result.seconds:0.0,
+		    result.check);
+    num_printed++;
+    stream_flush(gdsout);
+  }
+  if (json)
+    stream_printf(gdsout, "\n]}\n");
 
   libcbgp_done();
-  return EXIT_SUCCESS;
+  return error?EXIT_FAILURE:EXIT_SUCCESS;
 }
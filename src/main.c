@@ -33,6 +33,7 @@
 #define CBGP_MODE_SCRIPT      2
 #define CBGP_MODE_EXECUTE     3
 #define CBGP_MODE_OSPF        4
+#define CBGP_MODE_PLAN        5
 
 // -----[ global options ]-----
 uint8_t mode   = CBGP_MODE_DEFAULT;
@@ -51,6 +52,8 @@ void simulation_cli_help()
   printf("  -l LOGFILE     output log to LOGFILE instead of stderr.\n");
   printf("  -c SCRIPT      load and execute SCRIPT file.\n");
   printf("                 (without this option, commands are taken from stdin)\n");
+  printf("  -C SCRIPT      compile and execute SCRIPT file (the compiled plan\n");
+  printf("                 is cached in SCRIPT.plan).\n");
   printf("  -e COMMAND     execute the given command\n");
   printf("  -D param=value defines a parameter\n");
 
@@ -109,11 +112,14 @@ int main(int argc, char ** argv) {
   libcbgp_init(argc, argv);
 
   // Process command-line options
-  while ((result= getopt(argc, argv, "mc:D:e:hil:ot:")) != -1) {
+  while ((result= getopt(argc, argv, "mc:C:D:e:hil:ot:")) != -1) {
     switch (result) {
     case 'c':
       simulation_set_mode(CBGP_MODE_SCRIPT, optarg);
       break;
+    case 'C':
+      simulation_set_mode(CBGP_MODE_PLAN, optarg);
+      break;
     case 'D':
       tokenizer= tokenizer_create("=", NULL, NULL);
       assert(tokenizer_run(tokenizer, optarg) == TOKENIZER_SUCCESS);
@@ -161,6 +167,10 @@ int main(int argc, char ** argv) {
     exit_code= (libcbgp_exec_file(arg_mode) == 0)?
       EXIT_SUCCESS:EXIT_FAILURE;
     break;
+  case CBGP_MODE_PLAN:
+    exit_code= (libcbgp_exec_plan(arg_mode) == 0)?
+      EXIT_SUCCESS:EXIT_FAILURE;
+    break;
   case CBGP_MODE_EXECUTE:
     exit_code= (libcbgp_exec_cmd(arg_mode) == 0)?
       EXIT_SUCCESS:EXIT_FAILURE;
@@ -17,6 +17,7 @@
 
 #include <net/error.h>
 #include <net/export.h>
+#include <net/export_bin.h>
 #include <net/export_cli.h>
 #include <net/export_graphviz.h>
 #include <net/export_ntf.h>
@@ -30,10 +31,19 @@ typedef struct {
   _net_export_fct_t   fct;
 } _net_export_format_t;
 
+// -----[ _net_export_bin ]------------------------------------------
+/** The binary format can only be written in a file. */
+static net_error_t _net_export_bin(gds_stream_t * stream,
+				   network_t * network)
+{
+  return EUNEXPECTED;
+}
+
 static _net_export_format_t NET_EXPORT_FORMATS[NET_EXPORT_FORMAT_MAX]= {
   { "cli", net_export_cli },
   { "dot", net_export_dot },
   { "ntf", net_export_ntf },
+  { "bin", _net_export_bin },
 };
 
 // -----[ net_export_format2str ]------------------------------------
@@ -76,9 +86,13 @@ net_error_t net_export_file(const char * filename,
 			    network_t * network,
 			    net_export_format_t format)
 {
-  gds_stream_t * stream= stream_create_file(filename);
+  gds_stream_t * stream;
   int result;
 
+  if (format == NET_EXPORT_FORMAT_BIN)
+    return net_export_bin_file(filename, network);
+
+  stream= stream_create_file(filename);
   if (stream == NULL)
     return -1;
 
@@ -16,6 +16,7 @@ typedef enum {
   NET_EXPORT_FORMAT_CLI,
   NET_EXPORT_FORMAT_DOT,
   NET_EXPORT_FORMAT_NTF,
+  NET_EXPORT_FORMAT_BIN,
   NET_EXPORT_FORMAT_MAX
 } net_export_format_t;
 
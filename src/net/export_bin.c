@@ -0,0 +1,826 @@
+// ==================================================================
+// @(#)export_bin.c
+//
+// Binary topology export/import.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/enumerator.h>
+#include <libgds/memory.h>
+
+#include <net/export_bin.h>
+#include <net/iface.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/link-list.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/prefix.h>
+#include <net/routing.h>
+#include <net/subnet.h>
+
+#define BIN_MAGIC      "CBGPTP\0\1"
+#define BIN_MAGIC_SIZE 8
+#define BIN_NONE       UINT32_MAX
+
+// Size of the header and of the records (number of 32-bit fields)
+#define BIN_HEADER_SIZE (BIN_MAGIC_SIZE+9*4)
+#define BIN_NODE_SIZE   4
+#define BIN_SUBNET_SIZE 3
+#define BIN_IFACE_SIZE  10
+#define BIN_ROUTE_SIZE  6
+#define BIN_DOMAIN_SIZE 3
+
+// -----[ _bin_header_t ]--------------------------------------------
+typedef struct {
+  uint32_t version;
+  uint32_t flags;
+  uint32_t num_nodes;
+  uint32_t num_subnets;
+  uint32_t num_ifaces;
+  uint32_t num_routes;
+  uint32_t num_domains;
+  uint32_t num_members;
+  uint32_t names_len;
+} _bin_header_t;
+
+// -----[ _bin_iface_t ]---------------------------------------------
+typedef struct {
+  uint32_t owner;
+  uint32_t type;
+  uint32_t addr;
+  uint32_t mask;
+  /** Peer interface (RTR, PTP) or subnet (PTMP). */
+  uint32_t dest;
+  uint32_t enabled;
+  uint32_t delay;
+  uint32_t capacity;
+  uint32_t weight;
+  uint32_t area;
+} _bin_iface_t;
+
+// -----[ _bin_route_t ]---------------------------------------------
+typedef struct {
+  uint32_t node;
+  uint32_t network;
+  uint32_t mask;
+  uint32_t gateway;
+  uint32_t oif;
+  uint32_t metric;
+} _bin_route_t;
+
+// -----[ _bin_index_t ]---------------------------------------------
+/** Index of an object in the file (sorted by address). */
+typedef struct {
+  const void * ptr;
+  uint32_t     index;
+} _bin_index_t;
+
+// -----[ _put_u32 ]-------------------------------------------------
+static inline uint8_t * _put_u32(uint8_t * buf, uint32_t value)
+{
+  buf[0]= (uint8_t) (value >> 24);
+  buf[1]= (uint8_t) (value >> 16);
+  buf[2]= (uint8_t) (value >> 8);
+  buf[3]= (uint8_t) value;
+  return buf+4;
+}
+
+// -----[ _get_u32 ]-------------------------------------------------
+static inline uint32_t _get_u32(const uint8_t ** buf_ref)
+{
+  const uint8_t * buf= *buf_ref;
+  *buf_ref+= 4;
+  return (((uint32_t) buf[0]) << 24) | (((uint32_t) buf[1]) << 16) |
+    (((uint32_t) buf[2]) << 8) | buf[3];
+}
+
+// -----[ _float2bits ]----------------------------------------------
+static inline uint32_t _float2bits(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// -----[ _bits2float ]----------------------------------------------
+static inline float _bits2float(uint32_t bits)
+{
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// -----[ _index_cmp ]-----------------------------------------------
+static int _index_cmp(const void * item1, const void * item2)
+{
+  const void * ptr1= ((const _bin_index_t *) item1)->ptr;
+  const void * ptr2= ((const _bin_index_t *) item2)->ptr;
+  if (ptr1 < ptr2)
+    return -1;
+  if (ptr1 > ptr2)
+    return 1;
+  return 0;
+}
+
+// -----[ _index_find ]----------------------------------------------
+static inline uint32_t _index_find(const _bin_index_t * index,
+				   uint32_t size, const void * ptr)
+{
+  _bin_index_t key= { .ptr= ptr };
+  const _bin_index_t * item= bsearch(&key, index, size,
+				     sizeof(_bin_index_t), _index_cmp);
+  if (item == NULL)
+    return BIN_NONE;
+  return item->index;
+}
+
+// -----[ _node_cmp ]------------------------------------------------
+static int _node_cmp(const void * item1, const void * item2)
+{
+  net_addr_t addr1= (*((net_node_t **) item1))->rid;
+  net_addr_t addr2= (*((net_node_t **) item2))->rid;
+  if (addr1 < addr2)
+    return -1;
+  if (addr1 > addr2)
+    return 1;
+  return 0;
+}
+
+// -----[ _route_is_exported ]---------------------------------------
+/** Only the static routes that do not use a tunnel are exported. */
+static inline int _route_is_exported(rt_info_t * rtinfo)
+{
+  unsigned int index;
+  rt_entry_t * rtentry;
+
+  if (rtinfo->type != NET_ROUTE_STATIC)
+    return 0;
+  for (index= 0; index < rt_entries_size(rtinfo->entries); index++) {
+    rtentry= rt_entries_get_at(rtinfo->entries, index);
+    if ((rtentry->oif != NULL) && (rtentry->oif->type == NET_IFACE_VIRTUAL))
+      return 0;
+  }
+  return 1;
+}
+
+// -----[ _export_routes ]-------------------------------------------
+/**
+ * Count the static routes of a node (entries is NULL) or write
+ * them.
+ */
+static uint32_t _export_routes(net_node_t * node, uint32_t node_index,
+			       const _bin_index_t * ifaces,
+			       uint32_t num_ifaces, uint8_t ** entries)
+{
+  gds_enum_t * rt_info_lists, * rt_infos;
+  rt_info_list_t * rt_info_list;
+  rt_info_t * rtinfo;
+  rt_entry_t * rtentry;
+  unsigned int index;
+  uint32_t num_routes= 0;
+  uint8_t * buf;
+
+  rt_info_lists= trie_get_enum(node->rt);
+  while (enum_has_next(rt_info_lists)) {
+    rt_info_list= *((rt_info_list_t **) enum_get_next(rt_info_lists));
+
+    rt_infos= _array_get_enum((array_t *) rt_info_list);
+    while (enum_has_next(rt_infos)) {
+      rtinfo= *((rt_info_t **) enum_get_next(rt_infos));
+      if (!_route_is_exported(rtinfo))
+	continue;
+
+      num_routes+= rt_entries_size(rtinfo->entries);
+      if (entries == NULL)
+	continue;
+
+      for (index= 0; index < rt_entries_size(rtinfo->entries); index++) {
+	rtentry= rt_entries_get_at(rtinfo->entries, index);
+	buf= *entries;
+	buf= _put_u32(buf, node_index);
+	buf= _put_u32(buf, rtinfo->prefix.network);
+	buf= _put_u32(buf, rtinfo->prefix.mask);
+	buf= _put_u32(buf, rtentry->gateway);
+	buf= _put_u32(buf, (rtentry->oif == NULL)?BIN_NONE:
+		      _index_find(ifaces, num_ifaces, rtentry->oif));
+	buf= _put_u32(buf, rtinfo->metric);
+	*entries= buf;
+      }
+    }
+    enum_destroy(&rt_infos);
+
+  }
+  enum_destroy(&rt_info_lists);
+  return num_routes;
+}
+
+// -----[ net_export_bin ]-------------------------------------------
+net_error_t net_export_bin(FILE * file, network_t * network)
+{
+  _bin_header_t header;
+  gds_enum_t * nodes, * routers;
+  net_node_t ** node_array;
+  net_node_t * node;
+  net_iface_t ** iface_array;
+  net_iface_t * iface;
+  net_subnet_t * subnet;
+  igp_domain_t * domain;
+  _bin_index_t * node_index, * iface_index, * subnet_index;
+  unsigned int index, index2;
+  uint8_t * data, * buf, * routes, * names;
+  size_t size, len;
+  net_error_t result= ESUCCESS;
+
+  memset(&header, 0, sizeof(header));
+  header.version= NET_EXPORT_BIN_VERSION;
+  header.num_subnets= ptr_array_length(network->subnets);
+  header.num_domains= ptr_array_length(network->domains);
+
+  // Nodes, sorted by address
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    header.num_nodes++;
+    header.num_ifaces+= net_ifaces_size(node->ifaces);
+    if (node->name != NULL)
+      header.names_len+= strlen(node->name)+1;
+  }
+  enum_destroy(&nodes);
+  node_array= (net_node_t **) MALLOC((header.num_nodes+1)*
+				     sizeof(net_node_t *));
+  index= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes) && (index < header.num_nodes))
+    node_array[index++]= *((net_node_t **) enum_get_next(nodes));
+  enum_destroy(&nodes);
+  qsort(node_array, header.num_nodes, sizeof(net_node_t *), _node_cmp);
+
+  // Interfaces (tunnels are skipped)
+  iface_array= (net_iface_t **) MALLOC((header.num_ifaces+1)*
+				       sizeof(net_iface_t *));
+  header.num_ifaces= 0;
+  for (index= 0; index < header.num_nodes; index++) {
+    node= node_array[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (iface->type != NET_IFACE_VIRTUAL)
+	iface_array[header.num_ifaces++]= iface;
+    }
+  }
+
+  // Indexes used to refer to nodes, interfaces and subnets
+  node_index= (_bin_index_t *) MALLOC((header.num_nodes+1)*
+				      sizeof(_bin_index_t));
+  for (index= 0; index < header.num_nodes; index++) {
+    node_index[index].ptr= node_array[index];
+    node_index[index].index= index;
+  }
+  qsort(node_index, header.num_nodes, sizeof(_bin_index_t), _index_cmp);
+  iface_index= (_bin_index_t *) MALLOC((header.num_ifaces+1)*
+				       sizeof(_bin_index_t));
+  for (index= 0; index < header.num_ifaces; index++) {
+    iface_index[index].ptr= iface_array[index];
+    iface_index[index].index= index;
+  }
+  qsort(iface_index, header.num_ifaces, sizeof(_bin_index_t), _index_cmp);
+  subnet_index= (_bin_index_t *) MALLOC((header.num_subnets+1)*
+					sizeof(_bin_index_t));
+  for (index= 0; index < header.num_subnets; index++) {
+    subnet_index[index].ptr= network->subnets->data[index];
+    subnet_index[index].index= index;
+  }
+  qsort(subnet_index, header.num_subnets, sizeof(_bin_index_t),
+	_index_cmp);
+
+  // Static routes and domain members
+  for (index= 0; index < header.num_nodes; index++)
+    header.num_routes+= _export_routes(node_array[index], index,
+				       iface_index, header.num_ifaces, NULL);
+  for (index= 0; index < header.num_domains; index++) {
+    domain= (igp_domain_t *) network->domains->data[index];
+    routers= trie_get_enum(domain->routers);
+    while (enum_has_next(routers)) {
+      enum_get_next(routers);
+      header.num_members++;
+    }
+    enum_destroy(&routers);
+  }
+
+  size= BIN_HEADER_SIZE +
+    4 * (header.num_nodes * BIN_NODE_SIZE +
+	 header.num_subnets * BIN_SUBNET_SIZE +
+	 header.num_ifaces * BIN_IFACE_SIZE +
+	 header.num_routes * BIN_ROUTE_SIZE +
+	 header.num_domains * BIN_DOMAIN_SIZE +
+	 header.num_members) + header.names_len;
+  data= (uint8_t *) MALLOC(size);
+
+  // Header
+  memcpy(data, BIN_MAGIC, BIN_MAGIC_SIZE);
+  buf= data+BIN_MAGIC_SIZE;
+  buf= _put_u32(buf, header.version);
+  buf= _put_u32(buf, header.flags);
+  buf= _put_u32(buf, header.num_nodes);
+  buf= _put_u32(buf, header.num_subnets);
+  buf= _put_u32(buf, header.num_ifaces);
+  buf= _put_u32(buf, header.num_routes);
+  buf= _put_u32(buf, header.num_domains);
+  buf= _put_u32(buf, header.num_members);
+  buf= _put_u32(buf, header.names_len);
+
+  // Nodes (the names are stored at the end)
+  names= data+size-header.names_len;
+  len= 0;
+  for (index= 0; index < header.num_nodes; index++) {
+    node= node_array[index];
+    buf= _put_u32(buf, node->rid);
+    if (node->name != NULL) {
+      buf= _put_u32(buf, len);
+      strcpy((char *) names+len, node->name);
+      len+= strlen(node->name)+1;
+    } else
+      buf= _put_u32(buf, BIN_NONE);
+    buf= _put_u32(buf, _float2bits(node->coord.latitude));
+    buf= _put_u32(buf, _float2bits(node->coord.longitude));
+  }
+
+  // Subnets
+  for (index= 0; index < header.num_subnets; index++) {
+    subnet= (net_subnet_t *) network->subnets->data[index];
+    buf= _put_u32(buf, subnet->prefix.network);
+    buf= _put_u32(buf, subnet->prefix.mask);
+    buf= _put_u32(buf, subnet->type);
+  }
+
+  // Interfaces
+  for (index= 0; index < header.num_ifaces; index++) {
+    iface= iface_array[index];
+    buf= _put_u32(buf, _index_find(node_index, header.num_nodes,
+				   iface->owner));
+    buf= _put_u32(buf, iface->type);
+    buf= _put_u32(buf, iface->addr);
+    buf= _put_u32(buf, iface->mask);
+    if (!net_iface_is_connected(iface) ||
+	(iface->type == NET_IFACE_LOOPBACK))
+      buf= _put_u32(buf, BIN_NONE);
+    else if (iface->type == NET_IFACE_PTMP)
+      buf= _put_u32(buf, _index_find(subnet_index, header.num_subnets,
+				     iface->dest.subnet));
+    else
+      buf= _put_u32(buf, _index_find(iface_index, header.num_ifaces,
+				     iface->dest.iface));
+    buf= _put_u32(buf, net_iface_is_enabled(iface)?1:0);
+    buf= _put_u32(buf, iface->phys.delay);
+    buf= _put_u32(buf, iface->phys.capacity);
+    buf= _put_u32(buf, net_iface_get_metric(iface, 0));
+    buf= _put_u32(buf, iface->area);
+  }
+
+  // Static routes
+  routes= buf;
+  for (index= 0; index < header.num_nodes; index++)
+    _export_routes(node_array[index], index,
+		   iface_index, header.num_ifaces, &routes);
+  buf= routes;
+
+  // Domains, then their members
+  for (index= 0; index < header.num_domains; index++) {
+    domain= (igp_domain_t *) network->domains->data[index];
+    buf= _put_u32(buf, domain->id);
+    buf= _put_u32(buf, domain->type);
+    len= 0;
+    routers= trie_get_enum(domain->routers);
+    while (enum_has_next(routers)) {
+      enum_get_next(routers);
+      len++;
+    }
+    enum_destroy(&routers);
+    buf= _put_u32(buf, len);
+  }
+  for (index= 0; index < header.num_domains; index++) {
+    domain= (igp_domain_t *) network->domains->data[index];
+    routers= trie_get_enum(domain->routers);
+    while (enum_has_next(routers)) {
+      node= *((net_node_t **) enum_get_next(routers));
+      buf= _put_u32(buf, _index_find(node_index, header.num_nodes, node));
+    }
+    enum_destroy(&routers);
+  }
+  assert(buf == names);
+
+  if (fwrite(data, 1, size, file) != size)
+    result= EUNEXPECTED;
+
+  FREE(data);
+  FREE(subnet_index);
+  FREE(iface_index);
+  FREE(node_index);
+  FREE(iface_array);
+  FREE(node_array);
+  return result;
+}
+
+// -----[ net_export_bin_file ]--------------------------------------
+net_error_t net_export_bin_file(const char * filename,
+				network_t * network)
+{
+  net_error_t result;
+  FILE * file;
+
+  file= fopen(filename, "wb");
+  if (file == NULL)
+    return EUNEXPECTED;
+  result= net_export_bin(file, network);
+  if (fclose(file) != 0)
+    result= EUNEXPECTED;
+  if (result != ESUCCESS)
+    remove(filename);
+  return result;
+}
+
+// -----[ _import_check ]--------------------------------------------
+/**
+ * Check the references between the records, so that the network is
+ * only modified if the whole file is valid.
+ */
+static int _import_check(const _bin_header_t * header,
+			 const uint8_t * data,
+			 const _bin_iface_t * ifaces,
+			 const _bin_route_t * routes,
+			 const uint32_t * members)
+{
+  const _bin_iface_t * iface, * peer;
+  const _bin_route_t * route;
+  unsigned int index;
+
+  if ((header->names_len > 0) && (data[header->names_len-1] != '\0'))
+    return -1;
+
+  for (index= 0; index < header->num_ifaces; index++) {
+    iface= &ifaces[index];
+    if ((iface->owner >= header->num_nodes) ||
+	(iface->type >= NET_IFACE_MAX) ||
+	(iface->type == NET_IFACE_VIRTUAL) ||
+	(iface->mask > 32))
+      return -1;
+    switch (iface->type) {
+    case NET_IFACE_LOOPBACK:
+      if (iface->dest != BIN_NONE)
+	return -1;
+      break;
+    case NET_IFACE_RTR:
+    case NET_IFACE_PTP:
+      if (iface->dest == BIN_NONE)
+	break;
+      if (iface->dest >= header->num_ifaces)
+	return -1;
+      peer= &ifaces[iface->dest];
+      if ((peer->type != iface->type) || (peer->owner == iface->owner))
+	return -1;
+      break;
+    case NET_IFACE_PTMP:
+      if (iface->dest == BIN_NONE)
+	break;
+      if (iface->dest >= header->num_subnets)
+	return -1;
+      break;
+    default:
+      return -1;
+    }
+  }
+
+  for (index= 0; index < header->num_routes; index++) {
+    route= &routes[index];
+    if ((route->node >= header->num_nodes) || (route->mask > 32))
+      return -1;
+    if (route->oif == BIN_NONE) {
+      if (route->gateway == IP_ADDR_ANY)
+	return -1;
+      continue;
+    }
+    if ((route->oif >= header->num_ifaces) ||
+	(ifaces[route->oif].owner != route->node))
+      return -1;
+    // A gateway must be reached through a connected interface
+    if ((route->gateway != IP_ADDR_ANY) &&
+	((ifaces[route->oif].type == NET_IFACE_LOOPBACK) ||
+	 (ifaces[route->oif].dest == BIN_NONE)))
+      return -1;
+  }
+
+  for (index= 0; index < header->num_members; index++)
+    if (members[index] >= header->num_nodes)
+      return -1;
+  return 0;
+}
+
+// -----[ net_import_bin ]-------------------------------------------
+net_error_t net_import_bin(FILE * file, network_t * network)
+{
+  _bin_header_t header;
+  long start, end;
+  size_t size;
+  uint8_t * data= NULL;
+  const uint8_t * buf, * names, * nodes, * subnets, * domains;
+  _bin_iface_t * ifaces= NULL;
+  _bin_route_t * routes= NULL;
+  uint32_t * members= NULL;
+  net_node_t ** node_array= NULL;
+  net_subnet_t ** subnet_array= NULL;
+  net_iface_t ** iface_array= NULL;
+  net_node_t * node;
+  net_subnet_t * subnet;
+  net_iface_t * iface;
+  igp_domain_t * domain;
+  unsigned int index, index2;
+  uint32_t addr, mask, value, type, num_routers;
+  ip_pfx_t prefix;
+  uint64_t expected, total;
+  net_error_t result= EUNEXPECTED;
+
+  // Read the whole file
+  start= ftell(file);
+  if ((start < 0) || (fseek(file, 0, SEEK_END) != 0))
+    return EUNEXPECTED;
+  end= ftell(file);
+  if ((end < start) || (fseek(file, start, SEEK_SET) != 0))
+    return EUNEXPECTED;
+  size= end-start;
+  if (size < BIN_HEADER_SIZE)
+    return EUNEXPECTED;
+  data= (uint8_t *) MALLOC(size);
+  if ((fread(data, 1, size, file) != size) ||
+      memcmp(data, BIN_MAGIC, BIN_MAGIC_SIZE))
+    goto exit;
+
+  // Header
+  buf= data+BIN_MAGIC_SIZE;
+  header.version= _get_u32(&buf);
+  header.flags= _get_u32(&buf);
+  header.num_nodes= _get_u32(&buf);
+  header.num_subnets= _get_u32(&buf);
+  header.num_ifaces= _get_u32(&buf);
+  header.num_routes= _get_u32(&buf);
+  header.num_domains= _get_u32(&buf);
+  header.num_members= _get_u32(&buf);
+  header.names_len= _get_u32(&buf);
+  if (header.version != NET_EXPORT_BIN_VERSION)
+    goto exit;
+  expected= BIN_HEADER_SIZE +
+    4 * ((uint64_t) header.num_nodes * BIN_NODE_SIZE +
+	 (uint64_t) header.num_subnets * BIN_SUBNET_SIZE +
+	 (uint64_t) header.num_ifaces * BIN_IFACE_SIZE +
+	 (uint64_t) header.num_routes * BIN_ROUTE_SIZE +
+	 (uint64_t) header.num_domains * BIN_DOMAIN_SIZE +
+	 (uint64_t) header.num_members) + header.names_len;
+  if (expected != size)
+    goto exit;
+
+  // Decode the records that are referenced by others
+  nodes= buf;
+  subnets= nodes + 4 * BIN_NODE_SIZE * header.num_nodes;
+  buf= subnets + 4 * BIN_SUBNET_SIZE * header.num_subnets;
+  ifaces= (_bin_iface_t *) MALLOC((header.num_ifaces+1)*
+				  sizeof(_bin_iface_t));
+  for (index= 0; index < header.num_ifaces; index++) {
+    ifaces[index].owner= _get_u32(&buf);
+    ifaces[index].type= _get_u32(&buf);
+    ifaces[index].addr= _get_u32(&buf);
+    ifaces[index].mask= _get_u32(&buf);
+    ifaces[index].dest= _get_u32(&buf);
+    ifaces[index].enabled= _get_u32(&buf);
+    ifaces[index].delay= _get_u32(&buf);
+    ifaces[index].capacity= _get_u32(&buf);
+    ifaces[index].weight= _get_u32(&buf);
+    ifaces[index].area= _get_u32(&buf);
+  }
+  routes= (_bin_route_t *) MALLOC((header.num_routes+1)*
+				  sizeof(_bin_route_t));
+  for (index= 0; index < header.num_routes; index++) {
+    routes[index].node= _get_u32(&buf);
+    routes[index].network= _get_u32(&buf);
+    routes[index].mask= _get_u32(&buf);
+    routes[index].gateway= _get_u32(&buf);
+    routes[index].oif= _get_u32(&buf);
+    routes[index].metric= _get_u32(&buf);
+  }
+  domains= buf;
+  buf+= 4 * BIN_DOMAIN_SIZE * header.num_domains;
+  members= (uint32_t *) MALLOC((header.num_members+1)*sizeof(uint32_t));
+  for (index= 0; index < header.num_members; index++)
+    members[index]= _get_u32(&buf);
+  names= buf;
+  if (_import_check(&header, names, ifaces, routes, members) != 0)
+    goto exit;
+
+  // Check the other records
+  buf= nodes;
+  for (index= 0; index < header.num_nodes; index++) {
+    _get_u32(&buf);
+    value= _get_u32(&buf);
+    if ((value != BIN_NONE) && (value >= header.names_len))
+      goto exit;
+    buf+= 8;
+  }
+  buf= subnets;
+  for (index= 0; index < header.num_subnets; index++) {
+    buf+= 4;
+    if ((_get_u32(&buf) >= 32) || (_get_u32(&buf) >= NET_SUBNET_TYPE_MAX))
+      goto exit;
+  }
+  buf= domains;
+  total= 0;
+  for (index= 0; index < header.num_domains; index++) {
+    if ((_get_u32(&buf) > UINT16_MAX) ||
+	(_get_u32(&buf) >= IGP_DOMAIN_MAX))
+      goto exit;
+    total+= _get_u32(&buf);
+  }
+  if (total != header.num_members)
+    goto exit;
+
+  // The nodes, subnets and domains must not exist yet
+  buf= nodes;
+  for (index= 0; index < header.num_nodes; index++) {
+    if (network_find_node(network, _get_u32(&buf)) != NULL) {
+      result= ENET_NODE_DUPLICATE;
+      goto exit;
+    }
+    buf+= 4 * (BIN_NODE_SIZE - 1);
+  }
+  buf= subnets;
+  for (index= 0; index < header.num_subnets; index++) {
+    prefix.network= _get_u32(&buf);
+    prefix.mask= _get_u32(&buf);
+    ip_prefix_mask(&prefix);
+    if (network_find_subnet(network, prefix) != NULL) {
+      result= ENET_SUBNET_DUPLICATE;
+      goto exit;
+    }
+    buf+= 4 * (BIN_SUBNET_SIZE - 2);
+  }
+  buf= domains;
+  for (index= 0; index < header.num_domains; index++) {
+    if (network_find_igp_domain(network, _get_u32(&buf)) != NULL) {
+      result= ENET_IGP_DOMAIN_DUPLICATE;
+      goto exit;
+    }
+    buf+= 4 * (BIN_DOMAIN_SIZE - 1);
+  }
+
+  // Nodes
+  node_array= (net_node_t **) MALLOC((header.num_nodes+1)*
+				     sizeof(net_node_t *));
+  buf= nodes;
+  for (index= 0; index < header.num_nodes; index++) {
+    addr= _get_u32(&buf);
+    result= node_create(addr, &node, 0);
+    if (result != ESUCCESS)
+      goto exit;
+    result= network_add_node(network, node);
+    if (result != ESUCCESS) {
+      node_destroy(&node);
+      goto exit;
+    }
+    node_array[index]= node;
+    value= _get_u32(&buf);
+    if (value != BIN_NONE)
+      node_set_name(node, (const char *) names+value);
+    node->coord.latitude= _bits2float(_get_u32(&buf));
+    node->coord.longitude= _bits2float(_get_u32(&buf));
+  }
+
+  // Subnets
+  subnet_array= (net_subnet_t **) MALLOC((header.num_subnets+1)*
+					 sizeof(net_subnet_t *));
+  buf= subnets;
+  for (index= 0; index < header.num_subnets; index++) {
+    addr= _get_u32(&buf);
+    mask= _get_u32(&buf);
+    type= _get_u32(&buf);
+    subnet= subnet_create(addr, mask, type);
+    result= network_add_subnet(network, subnet);
+    if (result != ESUCCESS) {
+      subnet_destroy(&subnet);
+      goto exit;
+    }
+    subnet_array[index]= subnet;
+  }
+
+  // Interfaces, then the links between them
+  iface_array= (net_iface_t **) MALLOC((header.num_ifaces+1)*
+				       sizeof(net_iface_t *));
+  for (index= 0; index < header.num_ifaces; index++) {
+    node= node_array[ifaces[index].owner];
+    result= net_iface_factory(node, net_iface_id_pfx(ifaces[index].addr,
+						     ifaces[index].mask),
+			      ifaces[index].type, &iface);
+    if (result != ESUCCESS)
+      goto exit;
+    result= node_add_iface2(node, iface);
+    if (result != ESUCCESS)
+      goto exit;
+    iface_array[index]= iface;
+    iface->phys.delay= ifaces[index].delay;
+    iface->phys.capacity= ifaces[index].capacity;
+    if (iface->weights != NULL)
+      iface->weights->data[0]= ifaces[index].weight;
+    iface->area= ifaces[index].area;
+    if (!ifaces[index].enabled)
+      net_iface_set_enabled(iface, 0);
+  }
+  for (index= 0; index < header.num_ifaces; index++) {
+    if (ifaces[index].dest == BIN_NONE)
+      continue;
+    iface= iface_array[index];
+    if (iface->type == NET_IFACE_PTMP) {
+      subnet= subnet_array[ifaces[index].dest];
+      result= net_iface_connect_subnet(iface, subnet);
+      if (result != ESUCCESS)
+	goto exit;
+      result= subnet_add_link(subnet, iface);
+    } else
+      result= net_iface_connect_iface(iface, iface_array[ifaces[index].dest]);
+    if (result != ESUCCESS)
+      goto exit;
+  }
+
+  // Domains
+  buf= domains;
+  index2= 0;
+  for (index= 0; index < header.num_domains; index++) {
+    value= _get_u32(&buf);
+    type= _get_u32(&buf);
+    num_routers= _get_u32(&buf);
+    domain= igp_domain_create(value, type);
+    result= network_add_igp_domain(network, domain);
+    if (result != ESUCCESS) {
+      igp_domain_destroy(&domain);
+      goto exit;
+    }
+    for (; num_routers > 0; num_routers--) {
+      result= igp_domain_add_router(domain, node_array[members[index2++]]);
+      if (result != ESUCCESS)
+	goto exit;
+    }
+  }
+
+  // Static routes
+  for (index= 0; index < header.num_routes; index++) {
+    prefix.network= routes[index].network;
+    prefix.mask= routes[index].mask;
+    result= node_rt_add_route_link(node_array[routes[index].node], prefix,
+				   (routes[index].oif == BIN_NONE)?NULL:
+				   iface_array[routes[index].oif],
+				   routes[index].gateway,
+				   routes[index].metric, NET_ROUTE_STATIC);
+    if (result != ESUCCESS)
+      goto exit;
+  }
+
+  result= ESUCCESS;
+  network_topo_epoch_bump();
+
+ exit:
+  if (iface_array != NULL)
+    FREE(iface_array);
+  if (subnet_array != NULL)
+    FREE(subnet_array);
+  if (node_array != NULL)
+    FREE(node_array);
+  if (members != NULL)
+    FREE(members);
+  if (routes != NULL)
+    FREE(routes);
+  if (ifaces != NULL)
+    FREE(ifaces);
+  FREE(data);
+  return result;
+}
+
+// -----[ net_import_bin_file ]--------------------------------------
+net_error_t net_import_bin_file(const char * filename,
+				network_t * network)
+{
+  net_error_t result;
+  FILE * file;
+
+  file= fopen(filename, "rb");
+  if (file == NULL)
+    return EUNEXPECTED;
+  result= net_import_bin(file, network);
+  fclose(file);
+  return result;
+}
@@ -0,0 +1,86 @@
+// ==================================================================
+// @(#)export_bin.h
+//
+// Binary topology export/import.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a versioned binary format for the topology of a network.
+ * Saving and loading a topology with this format is much faster
+ * than with the CLI or NTF formats as nothing has to be parsed.
+ *
+ * The file contains the nodes (with their name and coordinates),
+ * the subnets, the interfaces and links (with their delay,
+ * capacity, state, IGP weight and OSPF area), the IGP domains and
+ * the static routes. Tunnels and the routes through tunnels are not
+ * supported (as in the CLI export). The IGP routes are not saved:
+ * they must be computed again after the import.
+ *
+ * The file starts with the magic "CBGPTP\0\1", a version and the
+ * number of records of each kind. It is followed by fixed-size
+ * records (nodes, subnets, interfaces, static routes, domains,
+ * domain members) and by the node names. All the integers are
+ * stored on 32 bits in network byte order.
+ *
+ * The whole file is read at once and its records are decoded in
+ * arrays allocated from the header counts. All the records are
+ * checked before the network is modified.
+ */
+
+#ifndef __NET_EXPORT_BIN_H__
+#define __NET_EXPORT_BIN_H__
+
+#include <stdio.h>
+
+#include <net/error.h>
+#include <net/net_types.h>
+
+#define NET_EXPORT_BIN_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ net_export_bin ]-----------------------------------------
+  /**
+   * Write the topology of a network in a binary file.
+   *
+   * \retval ESUCCESS, or EUNEXPECTED if the file can not be written.
+   */
+  net_error_t net_export_bin(FILE * file, network_t * network);
+  // -----[ net_export_bin_file ]------------------------------------
+  net_error_t net_export_bin_file(const char * filename,
+				  network_t * network);
+  // -----[ net_import_bin ]-----------------------------------------
+  /**
+   * Load a binary topology in a network, from the current position
+   * of the file to its end. The nodes, subnets and domains of the
+   * file must not exist in the network.
+   *
+   * The file and the existence of its nodes, subnets and domains
+   * are checked before the network is modified. An element can
+   * still fail to be added afterwards (e.g. when the file holds the
+   * same node twice); in this case, the elements added before are
+   * kept.
+   *
+   * \retval ESUCCESS, EUNEXPECTED if the file can not be read or is
+   *         invalid, ENET_NODE_DUPLICATE, ENET_SUBNET_DUPLICATE or
+   *         ENET_IGP_DOMAIN_DUPLICATE if an element already exists,
+   *         or the error returned when an element can not be added
+   *         to the network.
+   */
+  net_error_t net_import_bin(FILE * file, network_t * network);
+  // -----[ net_import_bin_file ]------------------------------------
+  net_error_t net_import_bin_file(const char * filename,
+				  network_t * network);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_EXPORT_BIN_H__ */
@@ -84,7 +84,7 @@ static inline int _ez_edge_builder(ez_topo_t * eztopo,
   // Both nodes must exist
   if ((ezedge->src >= eztopo->num_nodes) ||
       (ezedge->dst >= eztopo->num_nodes)) {
-    stream_printf(gdserr, "EZ-TOPO: src/dst index is invalid");
+    stream_printf(gdserr, "EZ-TOPO: src/dst index is invalid\n");
     return EUNEXPECTED;
   }
 
@@ -187,7 +187,8 @@ ez_topo_t * ez_topo_builder(unsigned int num_nodes,
       error= _ez_subnet_builder(eztopo, eznode);
       break;
     default:
-      abort();
+      stream_printf(gdserr, "EZ-TOPO: invalid node type\n");
+      error= EUNEXPECTED;
     }
 
     if (error != ESUCCESS)
@@ -207,9 +208,10 @@ ez_topo_t * ez_topo_builder(unsigned int num_nodes,
   return eztopo;
 
  error_msg:
-  abort();
-  ez_topo_destroy(&eztopo);
+  stream_printf(gdserr, "EZ-TOPO: ");
   network_perror(gdserr, error);
+  stream_printf(gdserr, "\n");
+  ez_topo_destroy(&eztopo);
   return NULL;
 }
 
@@ -0,0 +1,539 @@
+// ==================================================================
+// @(#)generator.c
+//
+// Synthetic topology generator (see net/generator.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+#include <libgds/types.h>
+
+#include <net/error.h>
+#include <net/generator.h>
+#include <net/iface.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <util/rng.h>
+
+/** Delay (ms) of a link that crosses the unit square. */
+#define GEN_DELAY_SCALE   50
+/** Capacity ratio between two consecutive levels. */
+#define GEN_CAPACITY_STEP 4
+/** Average degree targeted by the waxman model (if alpha is 0). */
+#define GEN_WAXMAN_DEGREE 4.0
+/** Number of samples used to calibrate the waxman model. */
+#define GEN_WAXMAN_SAMPLES 4096
+
+static char * MODEL_NAMES[NET_GEN_MAX]= {
+  "geometric",
+  "waxman",
+  "fat-tree",
+  "isp",
+};
+
+static char * WEIGHT_NAMES[NET_GEN_WEIGHT_MAX]= {
+  "unit",
+  "delay",
+  "random",
+  "inv-capacity",
+};
+
+// -----[ _gen_ctx_t ]-----------------------------------------------
+typedef struct {
+  const net_gen_params_t * params;
+  network_t              * network;
+  igp_domain_t           * domain;
+  net_gen_topo_t         * topo;
+  /** Coordinates of the nodes (NULL if not meaningful). */
+  double                 * x;
+  double                 * y;
+  /** Union-find of the connected components. */
+  unsigned int           * comp;
+  rng_t                    rng;
+} _gen_ctx_t;
+
+// -----[ net_gen_params_init ]--------------------------------------
+void net_gen_params_init(net_gen_params_t * params)
+{
+  memset(params, 0, sizeof(net_gen_params_t));
+  params->model= NET_GEN_WAXMAN;
+  params->num_nodes= 100;
+  params->beta= 0.2;
+  params->weight= NET_GEN_WEIGHT_UNIT;
+  params->capacity= 1000000;
+  params->base= IPV4(10,0,0,0);
+  params->seed= 1;
+}
+
+// -----[ net_gen_str2model ]----------------------------------------
+int net_gen_str2model(const char * str, net_gen_model_t * model)
+{
+  net_gen_model_t index;
+  for (index= 0; index < NET_GEN_MAX; index++)
+    if (!strcmp(str, MODEL_NAMES[index])) {
+      *model= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ net_gen_str2weight ]---------------------------------------
+int net_gen_str2weight(const char * str, net_gen_weight_t * weight)
+{
+  net_gen_weight_t index;
+  for (index= 0; index < NET_GEN_WEIGHT_MAX; index++)
+    if (!strcmp(str, WEIGHT_NAMES[index])) {
+      *weight= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ _gen_find ]------------------------------------------------
+static inline unsigned int _gen_find(_gen_ctx_t * ctx, unsigned int index)
+{
+  while (ctx->comp[index] != index) {
+    ctx->comp[index]= ctx->comp[ctx->comp[index]];
+    index= ctx->comp[index];
+  }
+  return index;
+}
+
+// -----[ _gen_dist ]------------------------------------------------
+static inline double _gen_dist(_gen_ctx_t * ctx, unsigned int i,
+			       unsigned int j)
+{
+  double dx= ctx->x[i] - ctx->x[j];
+  double dy= ctx->y[i] - ctx->y[j];
+  return sqrt(dx*dx + dy*dy);
+}
+
+// -----[ _gen_nearest ]---------------------------------------------
+/**
+ * Find the node in [from, to[ that is the nearest to node i. The
+ * node i and the node "exclude" are skipped. Returns -1 if there is
+ * no candidate.
+ */
+static int _gen_nearest(_gen_ctx_t * ctx, unsigned int i,
+			unsigned int from, unsigned int to, int exclude)
+{
+  int nearest= -1;
+  double dist, best= 0;
+  unsigned int j;
+
+  for (j= from; j < to; j++) {
+    if ((j == i) || ((int) j == exclude))
+      continue;
+    dist= _gen_dist(ctx, i, j);
+    if ((nearest < 0) || (dist < best)) {
+      nearest= j;
+      best= dist;
+    }
+  }
+  return nearest;
+}
+
+// -----[ _gen_add_nodes ]-------------------------------------------
+/**
+ * Create the nodes. The levels must already be set.
+ */
+static int _gen_add_nodes(_gen_ctx_t * ctx)
+{
+  net_gen_topo_t * topo= ctx->topo;
+  unsigned int index;
+  int error;
+
+  for (index= 0; index < topo->num_nodes; index++) {
+    error= node_create(ctx->params->base + index + 1, &topo->nodes[index],
+		       NODE_OPTIONS_LOOPBACK);
+    if (error != ESUCCESS)
+      return error;
+    error= network_add_node(ctx->network, topo->nodes[index]);
+    if (error != ESUCCESS) {
+      node_destroy(&topo->nodes[index]);
+      return error;
+    }
+    if (ctx->domain != NULL) {
+      error= igp_domain_add_router(ctx->domain, topo->nodes[index]);
+      if (error != ESUCCESS)
+	return error;
+    }
+    if (topo->levels[index] > topo->max_level)
+      topo->max_level= topo->levels[index];
+  }
+  return ESUCCESS;
+}
+
+// -----[ _gen_add_link ]--------------------------------------------
+/**
+ * Link two nodes. The capacity of the link depends on the level of
+ * its highest end (the closer to the core, the larger). The delay
+ * depends on the distance between the nodes.
+ */
+static int _gen_add_link(_gen_ctx_t * ctx, unsigned int i, unsigned int j)
+{
+  const net_gen_params_t * params= ctx->params;
+  net_gen_topo_t * topo= ctx->topo;
+  unsigned int level= topo->levels[i];
+  net_link_load_t capacity= params->capacity;
+  net_link_delay_t delay= 1;
+  igp_weight_t weight= 1;
+  net_iface_t * iface;
+  unsigned int index;
+  double ref;
+  int error;
+
+  if (topo->levels[j] < level)
+    level= topo->levels[j];
+  for (index= level; index < topo->max_level; index++)
+    if (capacity <= MAX_UINT32_T / GEN_CAPACITY_STEP)
+      capacity*= GEN_CAPACITY_STEP;
+  if (ctx->x != NULL)
+    delay+= (net_link_delay_t) (_gen_dist(ctx, i, j) * GEN_DELAY_SCALE);
+
+  switch (params->weight) {
+  case NET_GEN_WEIGHT_DELAY:
+    weight= delay;
+    break;
+  case NET_GEN_WEIGHT_RANDOM:
+    weight= 1 + rng_range(&ctx->rng, 64);
+    break;
+  case NET_GEN_WEIGHT_INV_CAPACITY:
+    ref= params->capacity * pow(GEN_CAPACITY_STEP, topo->max_level);
+    weight= (ref / capacity >= 1)?(igp_weight_t) (ref / capacity):1;
+    break;
+  default:
+    break;
+  }
+
+  error= net_link_create_rtr(topo->nodes[i], topo->nodes[j], BIDIR, &iface);
+  if (error == ENET_IFACE_DUPLICATE)
+    return ESUCCESS;
+  if (error != ESUCCESS)
+    return error;
+  net_iface_set_metric(iface, 0, weight, BIDIR);
+  net_link_set_phys_attr(iface, delay, capacity, BIDIR);
+  topo->num_links++;
+  ctx->comp[_gen_find(ctx, i)]= _gen_find(ctx, j);
+  return ESUCCESS;
+}
+
+// -----[ _gen_place ]-----------------------------------------------
+/** Place the nodes at random in the unit square. */
+static void _gen_place(_gen_ctx_t * ctx)
+{
+  unsigned int index;
+  ctx->x= (double *) MALLOC(sizeof(double)*ctx->topo->num_nodes);
+  ctx->y= (double *) MALLOC(sizeof(double)*ctx->topo->num_nodes);
+  for (index= 0; index < ctx->topo->num_nodes; index++) {
+    ctx->x[index]= rng_uniform(&ctx->rng);
+    ctx->y[index]= rng_uniform(&ctx->rng);
+  }
+}
+
+// -----[ _gen_connect ]---------------------------------------------
+/**
+ * Make the topology connected: each node that is not in the
+ * component of node 0 is linked to its nearest node in that
+ * component.
+ */
+static int _gen_connect(_gen_ctx_t * ctx)
+{
+  unsigned int num_nodes= ctx->topo->num_nodes;
+  unsigned int i, j, nearest;
+  double dist, best;
+  int error;
+
+  for (i= 1; i < num_nodes; i++) {
+    if (_gen_find(ctx, i) == _gen_find(ctx, 0))
+      continue;
+    nearest= 0;
+    best= _gen_dist(ctx, i, 0);
+    for (j= 1; j < num_nodes; j++) {
+      if (_gen_find(ctx, j) != _gen_find(ctx, 0))
+	continue;
+      dist= _gen_dist(ctx, i, j);
+      if (dist < best) {
+	nearest= j;
+	best= dist;
+      }
+    }
+    error= _gen_add_link(ctx, i, nearest);
+    if (error != ESUCCESS)
+      return error;
+  }
+  return ESUCCESS;
+}
+
+// -----[ _gen_geometric ]-------------------------------------------
+static int _gen_geometric(_gen_ctx_t * ctx)
+{
+  unsigned int num_nodes= ctx->topo->num_nodes;
+  double radius= ctx->params->radius;
+  unsigned int i, j;
+  int error;
+
+  // Default radius: the expected degree is about 2.ln(n)
+  if (radius <= 0)
+    radius= sqrt(2 * log(num_nodes + 1) / (M_PI * num_nodes));
+
+  _gen_place(ctx);
+  error= _gen_add_nodes(ctx);
+  for (i= 0; (i < num_nodes) && (error == ESUCCESS); i++)
+    for (j= i+1; (j < num_nodes) && (error == ESUCCESS); j++)
+      if (_gen_dist(ctx, i, j) < radius)
+	error= _gen_add_link(ctx, i, j);
+  if (error != ESUCCESS)
+    return error;
+  return _gen_connect(ctx);
+}
+
+// -----[ _gen_waxman ]----------------------------------------------
+static int _gen_waxman(_gen_ctx_t * ctx)
+{
+  unsigned int num_nodes= ctx->topo->num_nodes;
+  double alpha= ctx->params->alpha;
+  double beta_l= ctx->params->beta * M_SQRT2;
+  double mean;
+  unsigned int i, j;
+  int error;
+
+  _gen_place(ctx);
+
+  // Default alpha: calibrated on random pairs so that the average
+  // degree is about GEN_WAXMAN_DEGREE
+  if ((alpha <= 0) && (num_nodes > 1)) {
+    mean= 0;
+    for (i= 0; i < GEN_WAXMAN_SAMPLES; i++) {
+      j= rng_range(&ctx->rng, num_nodes);
+      mean+= exp(-_gen_dist(ctx, j, rng_range(&ctx->rng, num_nodes)) /
+		 beta_l);
+    }
+    mean/= GEN_WAXMAN_SAMPLES;
+    alpha= GEN_WAXMAN_DEGREE / ((num_nodes - 1) * mean);
+    if (alpha > 1)
+      alpha= 1;
+  }
+
+  error= _gen_add_nodes(ctx);
+  for (i= 0; (i < num_nodes) && (error == ESUCCESS); i++)
+    for (j= i+1; (j < num_nodes) && (error == ESUCCESS); j++)
+      if (rng_uniform(&ctx->rng) < alpha * exp(-_gen_dist(ctx, i, j) / beta_l))
+	error= _gen_add_link(ctx, i, j);
+  if (error != ESUCCESS)
+    return error;
+  return _gen_connect(ctx);
+}
+
+// -----[ _gen_fat_tree ]--------------------------------------------
+/**
+ * k-ary fat-tree. The (k/2)^2 core switches come first, then the
+ * k/2 aggregation switches of each pod and finally the k/2 edge
+ * switches of each pod.
+ */
+static int _gen_fat_tree(_gen_ctx_t * ctx)
+{
+  unsigned int half= ctx->params->k / 2;
+  unsigned int num_core= half * half;
+  unsigned int num_agg= 2 * half * half;
+  unsigned int pod, agg, edge, core, index;
+  int error;
+
+  for (index= 0; index < ctx->topo->num_nodes; index++)
+    ctx->topo->levels[index]= ((index < num_core)?0:
+			       ((index < num_core+num_agg)?1:2));
+  error= _gen_add_nodes(ctx);
+  if (error != ESUCCESS)
+    return error;
+
+  for (pod= 0; pod < 2*half; pod++)
+    for (agg= 0; agg < half; agg++) {
+      for (edge= 0; edge < half; edge++) {
+	error= _gen_add_link(ctx, num_core + pod*half + agg,
+			     num_core + num_agg + pod*half + edge);
+	if (error != ESUCCESS)
+	  return error;
+      }
+      for (core= 0; core < half; core++) {
+	error= _gen_add_link(ctx, agg*half + core,
+			     num_core + pod*half + agg);
+	if (error != ESUCCESS)
+	  return error;
+      }
+    }
+  return ESUCCESS;
+}
+
+// -----[ _gen_isp ]-------------------------------------------------
+/**
+ * ISP-like hierarchy. The backbone routers are linked to their two
+ * nearest predecessors. The points of presence are linked to their
+ * two nearest backbone routers and the access routers to their two
+ * nearest points of presence.
+ */
+static int _gen_isp(_gen_ctx_t * ctx)
+{
+  unsigned int num_nodes= ctx->topo->num_nodes;
+  unsigned int num_core, num_pop, from, to;
+  unsigned int index;
+  int first, second;
+  int error;
+
+  num_core= num_nodes / 40;
+  if (num_core < 2)
+    num_core= 2;
+  if (num_core > num_nodes)
+    num_core= num_nodes;
+  num_pop= (num_nodes - num_core + 4) / 5;
+
+  for (index= 0; index < num_nodes; index++)
+    ctx->topo->levels[index]= ((index < num_core)?0:
+			       ((index < num_core+num_pop)?1:2));
+  _gen_place(ctx);
+  error= _gen_add_nodes(ctx);
+  if (error != ESUCCESS)
+    return error;
+
+  for (index= 1; index < num_nodes; index++) {
+    if (index < num_core) {
+      from= 0;
+      to= index;
+    } else if (index < num_core+num_pop) {
+      from= 0;
+      to= num_core;
+    } else {
+      from= num_core;
+      to= num_core+num_pop;
+    }
+    first= _gen_nearest(ctx, index, from, to, -1);
+    second= _gen_nearest(ctx, index, from, to, first);
+    if (first >= 0)
+      error= _gen_add_link(ctx, index, first);
+    if ((second >= 0) && (error == ESUCCESS))
+      error= _gen_add_link(ctx, index, second);
+    if (error != ESUCCESS)
+      return error;
+  }
+  return ESUCCESS;
+}
+
+// -----[ _gen_topo_create ]-----------------------------------------
+static net_gen_topo_t * _gen_topo_create(unsigned int num_nodes)
+{
+  net_gen_topo_t * topo=
+    (net_gen_topo_t *) MALLOC(sizeof(net_gen_topo_t));
+  topo->num_nodes= num_nodes;
+  topo->nodes= (net_node_t **) MALLOC(sizeof(net_node_t *)*num_nodes);
+  topo->levels= (uint8_t *) MALLOC(sizeof(uint8_t)*num_nodes);
+  memset(topo->levels, 0, sizeof(uint8_t)*num_nodes);
+  topo->max_level= 0;
+  topo->num_links= 0;
+  return topo;
+}
+
+// -----[ net_gen_topo_destroy ]-------------------------------------
+void net_gen_topo_destroy(net_gen_topo_t ** topo_ref)
+{
+  net_gen_topo_t * topo= *topo_ref;
+
+  if (topo != NULL) {
+    FREE(topo->nodes);
+    FREE(topo->levels);
+    FREE(topo);
+    *topo_ref= NULL;
+  }
+}
+
+// -----[ net_gen_build ]--------------------------------------------
+int net_gen_build(network_t * network, const net_gen_params_t * params,
+		  net_gen_topo_t ** topo_ref)
+{
+  net_gen_params_t fat_params;
+  unsigned int num_nodes= params->num_nodes;
+  unsigned int index;
+  _gen_ctx_t ctx;
+  int error;
+
+  // The fat-tree is sized with k. If k is not set, the smallest
+  // fat-tree with at least num_nodes nodes is built.
+  if (params->model == NET_GEN_FAT_TREE) {
+    fat_params= *params;
+    if (fat_params.k == 0)
+      for (fat_params.k= 2; 5*fat_params.k*fat_params.k/4 < num_nodes;
+	   fat_params.k+= 2);
+    if (fat_params.k % 2 != 0)
+      return EUNEXPECTED;
+    num_nodes= 5 * fat_params.k * fat_params.k / 4;
+    params= &fat_params;
+  }
+  if ((num_nodes < 1) || (params->model >= NET_GEN_MAX))
+    return EUNEXPECTED;
+
+  // The nodes can not be removed from the network: check that their
+  // addresses are free before anything is created
+  for (index= 0; index < num_nodes; index++)
+    if (network_find_node(network, params->base + index + 1) != NULL)
+      return ENET_NODE_DUPLICATE;
+
+  ctx.params= params;
+  ctx.network= network;
+  ctx.domain= NULL;
+  ctx.x= NULL;
+  ctx.y= NULL;
+  rng_init(&ctx.rng, params->seed, MODEL_NAMES[params->model]);
+
+  if (params->domain > 0) {
+    ctx.domain= network_find_igp_domain(network, params->domain);
+    if (ctx.domain == NULL) {
+      ctx.domain= igp_domain_create(params->domain, IGP_DOMAIN_IGP);
+      error= network_add_igp_domain(network, ctx.domain);
+      if (error != ESUCCESS)
+	return error;
+    }
+  }
+
+  ctx.topo= _gen_topo_create(num_nodes);
+  ctx.comp= (unsigned int *) MALLOC(sizeof(unsigned int)*num_nodes);
+  for (index= 0; index < num_nodes; index++)
+    ctx.comp[index]= index;
+
+  switch (params->model) {
+  case NET_GEN_GEOMETRIC:
+    error= _gen_geometric(&ctx);
+    break;
+  case NET_GEN_WAXMAN:
+    error= _gen_waxman(&ctx);
+    break;
+  case NET_GEN_FAT_TREE:
+    error= _gen_fat_tree(&ctx);
+    break;
+  case NET_GEN_ISP:
+    error= _gen_isp(&ctx);
+    break;
+  default:
+    error= EUNEXPECTED;
+  }
+
+  if (ctx.x != NULL) {
+    FREE(ctx.x);
+    FREE(ctx.y);
+  }
+  FREE(ctx.comp);
+  if ((error != ESUCCESS) || (topo_ref == NULL))
+    net_gen_topo_destroy(&ctx.topo);
+  else
+    *topo_ref= ctx.topo;
+  return error;
+}
@@ -0,0 +1,136 @@
+// ==================================================================
+// @(#)generator.h
+//
+// Synthetic topology generator.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide functions to generate large synthetic IGP topologies
+ * directly into a network_t. The following models are supported:
+ *
+ * \li geometric: nodes are placed at random in the unit square and
+ *   two nodes are linked if their distance is below a radius.
+ * \li waxman: nodes are placed at random in the unit square and two
+ *   nodes u, v are linked with probability
+ *   alpha * exp(-d(u,v) / (beta * L)), where L is the maximum
+ *   distance.
+ * \li fat-tree: k-ary fat-tree of switches (core, aggregation and
+ *   edge levels), with 5k^2/4 nodes.
+ * \li isp: three-level hierarchy with a meshed backbone, points of
+ *   presence dual-homed to the backbone and access routers
+ *   dual-homed to points of presence.
+ *
+ * The geometric and waxman models are made connected by linking
+ * each isolated component to its nearest node in the main
+ * component. The generation only depends on the parameters (and on
+ * the seed), which makes it reproducible.
+ *
+ * The nodes are numbered from the core to the edge: their level is
+ * available in the generated topology and the node with index i has
+ * the address base+i+1.
+ */
+
+#ifndef __NET_GENERATOR_H__
+#define __NET_GENERATOR_H__
+
+#include <stdint.h>
+
+#include <net/net_types.h>
+
+// -----[ net_gen_model_t ]------------------------------------------
+typedef enum {
+  NET_GEN_GEOMETRIC,
+  NET_GEN_WAXMAN,
+  NET_GEN_FAT_TREE,
+  NET_GEN_ISP,
+  NET_GEN_MAX
+} net_gen_model_t;
+
+// -----[ net_gen_weight_t ]-----------------------------------------
+/** How the IGP weights are assigned. */
+typedef enum {
+  /** All the weights are equal to 1. */
+  NET_GEN_WEIGHT_UNIT,
+  /** The weight of a link equals its delay. */
+  NET_GEN_WEIGHT_DELAY,
+  /** The weights are random, between 1 and 64. */
+  NET_GEN_WEIGHT_RANDOM,
+  /** The weight of a link is inversely proportional to its
+      capacity (reference bandwidth / capacity). */
+  NET_GEN_WEIGHT_INV_CAPACITY,
+  NET_GEN_WEIGHT_MAX
+} net_gen_weight_t;
+
+// -----[ net_gen_params_t ]-----------------------------------------
+typedef struct {
+  net_gen_model_t  model;
+  /** Number of nodes (not used by fat-tree if k is set). */
+  unsigned int     num_nodes;
+  /** Arity of the fat-tree (even). */
+  unsigned int     k;
+  /** Radius of the geometric model. */
+  double           radius;
+  /** Parameters of the waxman model. */
+  double           alpha;
+  double           beta;
+  net_gen_weight_t weight;
+  /** Capacity of the edge links (links closer to the core get a
+      higher capacity). */
+  net_link_load_t  capacity;
+  /** Address of the first node is base+1. */
+  net_addr_t       base;
+  /** IGP domain of the nodes (0 = none). */
+  uint16_t         domain;
+  unsigned long    seed;
+} net_gen_params_t;
+
+// -----[ net_gen_topo_t ]-------------------------------------------
+/** Result of a generation. The nodes belong to the network. */
+typedef struct {
+  unsigned int   num_nodes;
+  net_node_t  ** nodes;
+  /** Level of each node (0 = core). */
+  uint8_t      * levels;
+  uint8_t        max_level;
+  unsigned int   num_links;
+} net_gen_topo_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ net_gen_params_init ]------------------------------------
+  /** Set the default parameters. */
+  void net_gen_params_init(net_gen_params_t * params);
+  // -----[ net_gen_str2model ]--------------------------------------
+  int net_gen_str2model(const char * str, net_gen_model_t * model);
+  // -----[ net_gen_str2weight ]-------------------------------------
+  int net_gen_str2weight(const char * str, net_gen_weight_t * weight);
+  // -----[ net_gen_build ]------------------------------------------
+  /**
+   * Generate a topology into a network.
+   *
+   * \param network  is the target network.
+   * \param params   are the generation parameters.
+   * \param topo_ref is set to the generated topology (optional).
+   * \retval an error code. ENET_NODE_DUPLICATE is returned, and the
+   *   network is left unchanged, if one of the node addresses is
+   *   already used. As nodes can not be removed from a network, the
+   *   nodes and links created before another error are kept.
+   */
+  int net_gen_build(network_t * network, const net_gen_params_t * params,
+		    net_gen_topo_t ** topo_ref);
+  // -----[ net_gen_topo_destroy ]-----------------------------------
+  /** Destroy a generated topology (not its nodes). */
+  void net_gen_topo_destroy(net_gen_topo_t ** topo_ref);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_GENERATOR_H__ */
@@ -539,5 +539,6 @@ const net_protocol_def_t PROTOCOL_ICMP= {
     .dump_msg    = _icmp_proto_dump_msg,
     .destroy_msg = NULL/*icmp_msg_destroy*/,
     .copy_payload= _icmp_proto_copy_payload,
+    .shard_key   = NULL,
   }
 };
@@ -11,6 +11,7 @@
 #endif
 
 #include <assert.h>
+#include <string.h>
 
 #include <net/icmp.h>
 #include <net/icmp_options.h>
@@ -126,8 +127,11 @@ static inline void _info_update_qos(net_msg_t * msg,
     trace->capacity= capacity;
 
   // Load the outgoing link, if requested.
-  if (msg->opts->flags & IP_OPT_LOAD)
+  if (msg->opts->flags & IP_OPT_LOAD) {
     net_iface_add_load(oif, msg->opts->load);
+    if (msg->opts->loads != NULL)
+      net_iface_add_load_vector(oif, msg->opts->loads, msg->opts->num_loads);
+  }
 }
 
 // -----[ _check_loop ]----------------------------------------------
@@ -451,6 +455,8 @@ net_error_t ip_opt_hook_msg_ecmp(net_node_t * node,
   ___ip_opt_debug("ECMP node=%n, msg=%m, opts=%o\n", node, msg, msg->opts);
 
   msg->opts->load/= num_entries;
+  for (index= 0; index < msg->opts->num_loads; index++)
+    msg->opts->loads[index]/= num_entries;
 
   for (index= 1; index < num_entries; index++) {
     // Note: message_copy() is responsible for copying the ip_opt
@@ -497,6 +503,8 @@ void ip_options_init(ip_opt_t * opts)
 {
   opts->flags= 0;
   opts->load= 0;
+  opts->loads= NULL;
+  opts->num_loads= 0;
   opts->ref_cnt= 0x80000001;
   opts->trace= NULL;
   opts->fifo_trace= NULL;
@@ -531,6 +539,11 @@ void ip_options_destroy(ip_opt_t ** opts_ref)
     if ((opts->ref_cnt & 0x7FFFFFFF) > 0)
       return;
 
+    if (opts->loads != NULL) {
+      FREE(opts->loads);
+      opts->loads= NULL;
+    }
+
     if ((opts->ref_cnt & 0x80000000) == 0) {
 #ifdef IP_OPT_DEBUG
       stream_printf(gdsout, "IP_OPT_DBG::  destroy %p (all)\n", *opts_ref);
@@ -551,6 +564,10 @@ ip_opt_t * ip_options_copy(ip_opt_t * opts, int with_trace)
   new_opts->flags= opts->flags;
   new_opts->alt_dest= opts->alt_dest;
   new_opts->load= opts->load;
+  new_opts->loads= NULL;
+  new_opts->num_loads= 0;
+  if (opts->loads != NULL)
+    ip_options_load_vector(new_opts, opts->loads, opts->num_loads);
   new_opts->ref_cnt= 1;
   if (with_trace && (opts->trace != NULL))
     new_opts->trace= ip_trace_copy(opts->trace);
@@ -578,6 +595,22 @@ void ip_options_load(ip_opt_t * opts, net_link_load_t load)
   opts->load= load;
 }
 
+// -----[ ip_options_load_vector ]-----------------------------------
+/**
+ * Load the traversed interfaces with a vector of loads (see
+ * net_iface_add_load_vector). The vector is copied.
+ */
+void ip_options_load_vector(ip_opt_t * opts,
+			    const net_link_vload_t * loads,
+			    unsigned int num_loads)
+{
+  opts->flags|= IP_OPT_LOAD;
+  opts->loads= (net_link_vload_t *)
+    REALLOC(opts->loads, num_loads * sizeof(net_link_vload_t));
+  memcpy(opts->loads, loads, num_loads * sizeof(net_link_vload_t));
+  opts->num_loads= num_loads;
+}
+
 // -----[ ip_options_set ]-------------------------------------------
 void ip_options_set(ip_opt_t * opts, uint16_t flag)
 {
@@ -35,6 +35,8 @@
 typedef struct ip_opt_t {
   uint16_t          flags;
   net_link_load_t   load;      /* Amount of traffic to load accross path */
+  net_link_vload_t * loads;    /* Vector of loads (one per scenario) */
+  unsigned int      num_loads;
   ip_pfx_t          alt_dest;  /* Alternate destination for lookup */
   unsigned int      ref_cnt;
   ip_trace_t      * trace;
@@ -63,6 +65,10 @@ extern "C" {
   void ip_options_set(ip_opt_t * opts, uint16_t flag);
   // -----[ ip_options_load ]----------------------------------------
   void ip_options_load(ip_opt_t * opts, net_link_load_t load);
+  // -----[ ip_options_load_vector ]---------------------------------
+  void ip_options_load_vector(ip_opt_t * opts,
+			      const net_link_vload_t * loads,
+			      unsigned int num_loads);
   // -----[ ip_options_alt_dest ]------------------------------------
   void ip_options_alt_dest(ip_opt_t * opts, ip_pfx_t alt_dest);
   // -----[ ip_options_trace ]---------------------------------------
@@ -21,6 +21,7 @@
 #include <net/iface_ptmp.h>
 #include <net/link.h>
 #include <net/net_types.h>
+#include <net/network.h>
 #include <net/node.h>
 #include <util/str_format.h>
 
@@ -73,12 +74,15 @@ net_iface_t * net_iface_new(net_node_t * node,
   iface->phys.delay= 0;
   iface->phys.capacity= 0;
   iface->phys.load= 0;
+  iface->phys.loads= NULL;
+  iface->phys.num_loads= 0;
 
   // IGP attributes
   if ((type == NET_IFACE_LOOPBACK) ||
       (type == NET_IFACE_VIRTUAL))
     dflt_weight= 0;
   iface->weights= net_igp_weights_create(1, dflt_weight);
+  iface->area= 0;
 
 #ifdef OSPF_SUPPORT
   iface->tArea= OSPF_NO_AREA;
@@ -113,6 +117,8 @@ void net_iface_destroy(net_iface_t ** iface_ref)
   if (*iface_ref != NULL) {
     iface= *iface_ref;
     net_igp_weights_destroy(&iface->weights);
+    if (iface->phys.loads != NULL)
+      FREE(iface->phys.loads);
     if (iface->ops.destroy != NULL)
       iface->ops.destroy(iface->user_data);
     FREE(iface);
@@ -152,6 +158,7 @@ int net_iface_connect_iface(net_iface_t * iface, net_iface_t * dst)
 
   iface->dest.iface= dst;
   iface->connected= 1;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -171,6 +178,7 @@ int net_iface_connect_subnet(net_iface_t * iface, net_subnet_t * dst)
     
   iface->dest.subnet= dst;
   iface->connected= 1;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -178,6 +186,7 @@ int net_iface_connect_subnet(net_iface_t * iface, net_subnet_t * dst)
 int net_iface_disconnect(net_iface_t * iface)
 {
   iface->connected= 0;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -388,6 +397,7 @@ int net_iface_is_enabled(net_iface_t * iface)
 void net_iface_set_enabled(net_iface_t * iface, int enabled)
 {
   _net_iface_set_flag(iface, NET_LINK_FLAG_UP, enabled);
+  network_topo_epoch_bump();
 }
 
 // -----[ net_iface_get_metric ]-------------------------------------
@@ -424,6 +434,7 @@ int net_iface_set_metric(net_iface_t * iface, net_tos_t tos,
   }
 
   iface->weights->data[tos]= weight;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -500,6 +511,47 @@ void net_iface_add_load(net_iface_t * iface, net_link_load_t inc_load)
     iface->phys.load= (net_link_load_t) big_load;
 }
 
+// -----[ net_iface_add_load_vector ]--------------------------------
+void net_iface_add_load_vector(net_iface_t * iface,
+			       const net_link_vload_t * loads,
+			       unsigned int num_loads)
+{
+  net_link_vload_t * vector;
+  net_link_vload_t sum;
+  unsigned int index;
+
+  if (num_loads > iface->phys.num_loads) {
+    iface->phys.loads= (net_link_vload_t *)
+      REALLOC(iface->phys.loads, num_loads * sizeof(net_link_vload_t));
+    memset(iface->phys.loads + iface->phys.num_loads, 0,
+	   (num_loads - iface->phys.num_loads) * sizeof(net_link_vload_t));
+    iface->phys.num_loads= num_loads;
+  }
+
+  // Branch-free saturating addition (can be vectorized)
+  vector= iface->phys.loads;
+  for (index= 0; index < num_loads; index++) {
+    sum= vector[index] + loads[index];
+    vector[index]= sum | -((net_link_vload_t) (sum < loads[index]));
+  }
+}
+
+// -----[ net_iface_get_load_vector ]--------------------------------
+const net_link_vload_t * net_iface_get_load_vector(net_iface_t * iface,
+						   unsigned int * num_loads)
+{
+  *num_loads= iface->phys.num_loads;
+  return iface->phys.loads;
+}
+
+// -----[ net_iface_clear_load_vector ]------------------------------
+void net_iface_clear_load_vector(net_iface_t * iface)
+{
+  if (iface->phys.loads != NULL)
+    memset(iface->phys.loads, 0,
+	   iface->phys.num_loads * sizeof(net_link_vload_t));
+}
+
 
 /////////////////////////////////////////////////////////////////////
 // DUMP
@@ -179,6 +179,31 @@ extern "C" {
    */
   void net_iface_add_load(net_iface_t * iface, net_link_load_t inc_load);
 
+  // -----[ net_iface_add_load_vector ]------------------------------
+  /**
+   * Add a vector of loads (one per traffic scenario) to the load
+   * vector of a network interface. The counters are 64 bits wide
+   * and saturate at NET_LINK_MAX_VLOAD. The load vector of the
+   * interface is extended with zeros if it is shorter.
+   */
+  void net_iface_add_load_vector(net_iface_t * iface,
+				 const net_link_vload_t * loads,
+				 unsigned int num_loads);
+
+  // -----[ net_iface_get_load_vector ]------------------------------
+  /**
+   * Get the load vector of a network interface (NULL if no load
+   * vector was added).
+   */
+  const net_link_vload_t * net_iface_get_load_vector(net_iface_t * iface,
+						     unsigned int * num_loads);
+
+  // -----[ net_iface_clear_load_vector ]----------------------------
+  /**
+   * Reset the load vector of a network interface to zero.
+   */
+  void net_iface_clear_load_vector(net_iface_t * iface);
+
 
   ///////////////////////////////////////////////////////////////////
   // DUMP
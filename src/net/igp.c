@@ -30,6 +30,7 @@
 #include <net/node.h>
 #include <net/routing.h>
 #include <net/subnet.h>
+#include <util/slab.h>
 #include <util/str_format.h>
 
 //#define IGP_DEBUG
@@ -151,6 +152,9 @@ typedef struct {
   spt_vertex_t * vertex;  // vertex in SPT
 } spt_context_t;
 
+SLAB_CACHE(_spt_context_cache, "spt-context", spt_context_t,
+	   MEM_ACCT_SPT);
+
 // -----[ _spt_update_node ]-----------------------------------------
 /**
  * Create/update SPT info for visited node. Three different cases are
@@ -222,7 +226,7 @@ static inline void _push(spt_comp_t * spt_comp,
 
   ___igp_debug("  * push dst:%e\n", &vertex->elem);
 
-  ctx= (spt_context_t *) MALLOC(sizeof(spt_context_t));
+  ctx= (spt_context_t *) slab_alloc(&_spt_context_cache);
   ctx->iif= iif;
   ctx->vertex= vertex;
   assert(fifo_push(spt_comp->fifo, ctx) == 0);
@@ -407,7 +411,7 @@ net_error_t spt_bfs(net_node_t * root, igp_domain_t * domain,
 	_link_traverse(&spt_comp, context, link);
       }
     }
-    FREE(context);
+    slab_free(&_spt_context_cache, context);
   }
   fifo_destroy(&spt_comp.fifo);
 
@@ -422,11 +426,13 @@ typedef struct _fib_comp_t {
   rt_entry_t   * rtentry;
 } _fib_comp_t;
 
+SLAB_CACHE(_fib_comp_cache, "fib-comp", _fib_comp_t, MEM_ACCT_FIB);
+
 static inline void _fib_comp_push(gds_stack_t * stack,
 				  spt_vertex_t * vertex,
 				  rt_entry_t * rtentry)
 {
-  _fib_comp_t * ctx= MALLOC(sizeof(_fib_comp_t));
+  _fib_comp_t * ctx= (_fib_comp_t *) slab_alloc(&_fib_comp_cache);
   ctx->vertex= vertex;
   ctx->rtentry= rtentry;
   assert(stack_push(stack, ctx) >= 0);
@@ -440,7 +446,7 @@ static inline void _fib_comp_pop(gds_stack_t * stack,
   assert(ctx != NULL);
   *vertex= ctx->vertex;
   *rtentry= ctx->rtentry;
-  FREE(ctx);
+  slab_free(&_fib_comp_cache, ctx);
 }
 
 // -----[ _spt_install_fib_entry ]-----------------------------------
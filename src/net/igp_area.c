@@ -0,0 +1,1098 @@
+// ==================================================================
+// @(#)igp_area.c
+//
+// Multi-area link-state routing model (see net/igp_area.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <net/iface.h>
+#include <net/igp_area.h>
+#include <net/igp_graph.h>
+#include <net/link_attr.h>
+#include <net/link-list.h>
+#include <net/node.h>
+#include <net/prefix.h>
+#include <net/routing.h>
+#include <net/spt.h>
+#include <net/subnet.h>
+#include <util/thread.h>
+
+#define _NONE UINT_MAX
+/** Number of routers whose distance vectors are computed together. */
+#define _BATCH_SIZE 256
+
+// -----[ _area_edge_type_t ]----------------------------------------
+typedef enum {
+  _EDGE_RTR,
+  _EDGE_PTP,
+  _EDGE_PTMP,
+  /** Edge from a transit subnet to one of its routers. */
+  _EDGE_SUBNET,
+} _area_edge_type_t;
+
+// -----[ _area_edge_t ]---------------------------------------------
+/**
+ * Edge of an area snapshot. For an edge leaving a router, iface is
+ * the index of the interface in the router's list. For an edge
+ * leaving a subnet, iface is the position of the target router's
+ * interface in the subnet's list.
+ */
+typedef struct {
+  unsigned int target;
+  igp_weight_t weight;
+  unsigned int iface;
+  uint8_t      type;
+} _area_edge_t;
+
+// -----[ _area_dest_t ]---------------------------------------------
+/**
+ * Destination announced in an area. The prefix is attached to a
+ * vertex (router loopback, subnet) with an additional cost, or to
+ * an edge (ptp link).
+ */
+typedef struct {
+  ip_pfx_t     prefix;
+  /** Index of the prefix in the domain's table. */
+  unsigned int index;
+  unsigned int vertex;
+  /** Edge of a ptp link (_NONE for a vertex destination). */
+  unsigned int edge;
+  igp_weight_t offset;
+} _area_dest_t;
+
+// -----[ _area_t ]--------------------------------------------------
+/**
+ * Area snapshot. The routers are the vertices 0 to num_routers-1
+ * and the subnets follow. The edges of vertex v are edges[first[v]]
+ * to edges[first[v+1]-1].
+ */
+typedef struct {
+  ospf_area_t     id;
+  unsigned int    num_routers;
+  /** Index of the routers in the domain. */
+  unsigned int  * routers;
+  unsigned int    num_subnets;
+  net_subnet_t ** subnets;
+  unsigned int    num_vertices;
+  unsigned int  * first;
+  _area_edge_t  * edges;
+  unsigned int    num_edges;
+  _area_dest_t  * dests;
+  unsigned int    num_dests;
+  /** Vertices of the area border routers. */
+  unsigned int  * abrs;
+  unsigned int    num_abrs;
+} _area_t;
+
+// -----[ _area_member_t ]-------------------------------------------
+/**
+ * Membership of a router in an area. The distance vector and the
+ * next-hops (one bitset per vertex) of the router in the area only
+ * exist while its routing table is built.
+ */
+typedef struct {
+  unsigned int   area;
+  unsigned int   vertex;
+  igp_weight_t * dist;
+  uint32_t     * nh;
+} _area_member_t;
+
+// -----[ _area_router_t ]-------------------------------------------
+/**
+ * Router of the domain. The next-hops of the router are numbered:
+ * each interface has a next-hop without gateway and a ptmp
+ * interface has one more next-hop for each interface attached to
+ * its subnet. The next-hops of a route are stored as a bitset.
+ */
+typedef struct {
+  net_node_t     * node;
+  unsigned int     num_fhs;
+  unsigned int     num_words;
+  unsigned int   * fh_base;
+  net_iface_t   ** fh_ifaces;
+  net_addr_t     * fh_gws;
+  _area_member_t * areas;
+  unsigned int     num_areas;
+  int              is_abr;
+  /** ABR: intra-area cost in the non-backbone areas. */
+  igp_weight_t   * summary;
+  /** ABR: cost of all the routes. */
+  igp_weight_t   * total;
+} _area_router_t;
+
+// -----[ _area_ctx_t ]----------------------------------------------
+typedef struct {
+  _area_router_t * routers;
+  unsigned int     num_routers;
+  _area_t        * areas;
+  unsigned int     num_areas;
+  /** Routers whose distance vectors are computed. */
+  unsigned int   * jobs;
+  unsigned int     num_jobs;
+  /** Index of the next job (shared by the threads). */
+  unsigned int     next_job;
+  /** Largest number of edges and subnets of an area. */
+  unsigned int     max_edges;
+  unsigned int     max_subnets;
+  ip_pfx_t       * prefixes;
+  unsigned int     num_prefixes;
+  unsigned int     max_words;
+} _area_ctx_t;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// BITSETS
+//
+/////////////////////////////////////////////////////////////////////
+
+static inline void _bits_set(uint32_t * bits, unsigned int index) {
+  bits[index >> 5]|= (1u << (index & 31));
+}
+static inline void _bits_clear(uint32_t * bits, unsigned int index) {
+  bits[index >> 5]&= ~(1u << (index & 31));
+}
+static inline int _bits_test(const uint32_t * bits, unsigned int index) {
+  return (bits[index >> 5] & (1u << (index & 31))) != 0;
+}
+static inline void _bits_or(uint32_t * dst, const uint32_t * src,
+			    unsigned int num_words) {
+  unsigned int index;
+  for (index= 0; index < num_words; index++)
+    dst[index]|= src[index];
+}
+static inline int _bits_empty(const uint32_t * bits, unsigned int num_words) {
+  unsigned int index;
+  for (index= 0; index < num_words; index++)
+    if (bits[index] != 0)
+      return 0;
+  return 1;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SNAPSHOT
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _iface_is_internal ]---------------------------------------
+static inline int _iface_is_internal(net_iface_t * iface)
+{
+  return ((iface->type == NET_IFACE_LOOPBACK) ||
+	  (iface->type == NET_IFACE_VIRTUAL));
+}
+
+// -----[ _uint32_cmp ]----------------------------------------------
+static int _uint32_cmp(const void * item1, const void * item2)
+{
+  uint32_t value1= *((const uint32_t *) item1);
+  uint32_t value2= *((const uint32_t *) item2);
+  return (value1 < value2)?-1:((value1 > value2)?1:0);
+}
+
+// -----[ _ptr_cmp ]-------------------------------------------------
+static int _ptr_cmp(const void * item1, const void * item2)
+{
+  const void * ptr1= *((const void **) item1);
+  const void * ptr2= *((const void **) item2);
+  return (ptr1 < ptr2)?-1:((ptr1 > ptr2)?1:0);
+}
+
+// -----[ _prefix_cmp ]----------------------------------------------
+static int _prefix_cmp(const void * item1, const void * item2)
+{
+  return ip_prefix_cmp((ip_pfx_t *) item1, (ip_pfx_t *) item2);
+}
+
+// -----[ _router_index ]--------------------------------------------
+static inline unsigned int _router_index(_area_ctx_t * ctx, net_node_t * node)
+{
+  unsigned int low= 0, high= ctx->num_routers, middle;
+
+  while (low < high) {
+    middle= (low + high) / 2;
+    if (ctx->routers[middle].node->rid < node->rid)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  if ((low < ctx->num_routers) && (ctx->routers[low].node == node))
+    return low;
+  return _NONE;
+}
+
+// -----[ _area_index ]----------------------------------------------
+static inline unsigned int _area_index(_area_ctx_t * ctx, ospf_area_t id)
+{
+  unsigned int low= 0, high= ctx->num_areas, middle;
+
+  while (low < high) {
+    middle= (low + high) / 2;
+    if (ctx->areas[middle].id < id)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  return low;
+}
+
+// -----[ _router_vertex ]-------------------------------------------
+/** Vertex of a router in an area (_NONE if not a member). */
+static inline unsigned int _router_vertex(_area_router_t * router,
+					  unsigned int area)
+{
+  unsigned int index;
+  for (index= 0; index < router->num_areas; index++)
+    if (router->areas[index].area == area)
+      return router->areas[index].vertex;
+  return _NONE;
+}
+
+// -----[ _subnet_vertex ]-------------------------------------------
+static inline unsigned int _subnet_vertex(_area_t * area,
+					  net_subnet_t * subnet)
+{
+  net_subnet_t ** item= (net_subnet_t **)
+    bsearch(&subnet, area->subnets, area->num_subnets,
+	    sizeof(net_subnet_t *), _ptr_cmp);
+  if (item == NULL)
+    return _NONE;
+  return area->num_routers + (item - area->subnets);
+}
+
+// -----[ _ctx_load_routers ]----------------------------------------
+/**
+ * Load the routers of the domain, sorted by identifier, and build
+ * their next-hop tables.
+ */
+static void _ctx_load_routers(_area_ctx_t * ctx, igp_domain_t * domain)
+{
+  net_node_t ** routers;
+  _area_router_t * router;
+  net_iface_t * iface;
+  unsigned int index, index2, index3, num_ifaces;
+
+  routers= igp_graph_routers(domain, &ctx->num_routers);
+  ctx->routers= (_area_router_t *)
+    MALLOC(sizeof(_area_router_t) * (ctx->num_routers + 1));
+  memset(ctx->routers, 0, sizeof(_area_router_t) * (ctx->num_routers + 1));
+  for (index= 0; index < ctx->num_routers; index++)
+    ctx->routers[index].node= routers[index];
+  FREE(routers);
+
+  ctx->max_words= 1;
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    num_ifaces= net_ifaces_size(router->node->ifaces);
+    router->fh_base= (unsigned int *)
+      MALLOC(sizeof(unsigned int) * (num_ifaces + 1));
+    router->num_fhs= 0;
+    for (index2= 0; index2 < num_ifaces; index2++) {
+      iface= net_ifaces_at(router->node->ifaces, index2);
+      router->fh_base[index2]= router->num_fhs++;
+      if (iface->type == NET_IFACE_PTMP)
+	router->num_fhs+= net_ifaces_size(iface->dest.subnet->ifaces);
+    }
+    router->fh_ifaces= (net_iface_t **)
+      MALLOC(sizeof(net_iface_t *) * (router->num_fhs + 1));
+    router->fh_gws= (net_addr_t *)
+      MALLOC(sizeof(net_addr_t) * (router->num_fhs + 1));
+    for (index2= 0; index2 < num_ifaces; index2++) {
+      iface= net_ifaces_at(router->node->ifaces, index2);
+      router->fh_ifaces[router->fh_base[index2]]= iface;
+      router->fh_gws[router->fh_base[index2]]= IP_ADDR_ANY;
+      if (iface->type != NET_IFACE_PTMP)
+	continue;
+      for (index3= 0; index3 < net_ifaces_size(iface->dest.subnet->ifaces);
+	   index3++) {
+	router->fh_ifaces[router->fh_base[index2]+1+index3]= iface;
+	router->fh_gws[router->fh_base[index2]+1+index3]=
+	  net_ifaces_at(iface->dest.subnet->ifaces, index3)->addr;
+      }
+    }
+    router->num_words= (router->num_fhs + 31) / 32;
+    if (router->num_words < 1)
+      router->num_words= 1;
+    if (router->num_words > ctx->max_words)
+      ctx->max_words= router->num_words;
+  }
+}
+
+// -----[ _ctx_load_areas ]------------------------------------------
+/**
+ * Find the areas of the domain and the areas of each router. A
+ * router without interface (other than loopbacks) is in the
+ * backbone.
+ */
+static void _ctx_load_areas(_area_ctx_t * ctx)
+{
+  _area_router_t * router;
+  _area_t * area;
+  net_iface_t * iface;
+  uint32_t * ids;
+  unsigned int num_ids= 0, max_ids= 0;
+  unsigned int index, index2, index3, area_index;
+
+  for (index= 0; index < ctx->num_routers; index++)
+    max_ids+= net_ifaces_size(ctx->routers[index].node->ifaces) + 1;
+  ids= (uint32_t *) MALLOC(sizeof(uint32_t) * (max_ids + 1));
+
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    index3= num_ids;
+    for (index2= 0; index2 < net_ifaces_size(router->node->ifaces);
+	 index2++) {
+      iface= net_ifaces_at(router->node->ifaces, index2);
+      if (!_iface_is_internal(iface))
+	ids[num_ids++]= iface->area;
+    }
+    if (num_ids == index3)
+      ids[num_ids++]= IGP_AREA_BACKBONE;
+  }
+  qsort(ids, num_ids, sizeof(uint32_t), _uint32_cmp);
+  ctx->areas= (_area_t *) MALLOC(sizeof(_area_t) * (num_ids + 1));
+  ctx->num_areas= 0;
+  for (index= 0; index < num_ids; index++)
+    if ((index == 0) || (ids[index] != ids[index-1])) {
+      area= &ctx->areas[ctx->num_areas++];
+      memset(area, 0, sizeof(_area_t));
+      area->id= ids[index];
+    }
+  FREE(ids);
+
+  // Membership of the routers, in the order of their identifiers
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    router->areas= (_area_member_t *)
+      MALLOC(sizeof(_area_member_t) *
+	     (net_ifaces_size(router->node->ifaces) + 1));
+    router->num_areas= 0;
+    for (index2= 0; index2 < net_ifaces_size(router->node->ifaces);
+	 index2++) {
+      iface= net_ifaces_at(router->node->ifaces, index2);
+      if (_iface_is_internal(iface))
+	continue;
+      area_index= _area_index(ctx, iface->area);
+      if (_router_vertex(router, area_index) == _NONE) {
+	router->areas[router->num_areas].area= area_index;
+	router->areas[router->num_areas].vertex=
+	  ctx->areas[area_index].num_routers++;
+	router->num_areas++;
+      }
+    }
+    if (router->num_areas == 0) {
+      area_index= _area_index(ctx, IGP_AREA_BACKBONE);
+      router->areas[0].area= area_index;
+      router->areas[0].vertex= ctx->areas[area_index].num_routers++;
+      router->num_areas= 1;
+    }
+    for (index2= 0; index2 < router->num_areas; index2++) {
+      router->areas[index2].dist= NULL;
+      router->areas[index2].nh= NULL;
+    }
+    router->is_abr= 0;
+    if (router->num_areas > 1)
+      for (index2= 0; index2 < router->num_areas; index2++)
+	if (ctx->areas[router->areas[index2].area].id == IGP_AREA_BACKBONE)
+	  router->is_abr= 1;
+  }
+
+  for (index= 0; index < ctx->num_areas; index++) {
+    area= &ctx->areas[index];
+    area->routers= (unsigned int *)
+      MALLOC(sizeof(unsigned int) * (area->num_routers + 1));
+    area->abrs= (unsigned int *)
+      MALLOC(sizeof(unsigned int) * (area->num_routers + 1));
+  }
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    for (index2= 0; index2 < router->num_areas; index2++) {
+      area= &ctx->areas[router->areas[index2].area];
+      area->routers[router->areas[index2].vertex]= index;
+      if (router->is_abr)
+	area->abrs[area->num_abrs++]= router->areas[index2].vertex;
+    }
+  }
+}
+
+// -----[ _area_add_dest ]-------------------------------------------
+static inline void _area_add_dest(_area_t * area, ip_pfx_t prefix,
+				  unsigned int vertex, unsigned int edge,
+				  igp_weight_t offset)
+{
+  _area_dest_t * dest= &area->dests[area->num_dests++];
+  ip_prefix_mask(&prefix);
+  dest->prefix= prefix;
+  dest->vertex= vertex;
+  dest->edge= edge;
+  dest->offset= offset;
+}
+
+// -----[ _area_add_edge ]-------------------------------------------
+static inline void _area_add_edge(_area_t * area, unsigned int target,
+				  igp_weight_t weight, unsigned int iface,
+				  _area_edge_type_t type)
+{
+  _area_edge_t * edge= &area->edges[area->num_edges++];
+  edge->target= target;
+  edge->weight= weight;
+  edge->iface= iface;
+  edge->type= type;
+}
+
+// -----[ _area_build_router ]---------------------------------------
+static void _area_build_router(_area_ctx_t * ctx, unsigned int area_index,
+			       unsigned int vertex)
+{
+  _area_t * area= &ctx->areas[area_index];
+  net_node_t * node= ctx->routers[area->routers[vertex]].node;
+  net_iface_t * iface, * dst;
+  unsigned int index, router, target;
+
+  for (index= 0; index < net_ifaces_size(node->ifaces); index++) {
+    iface= net_ifaces_at(node->ifaces, index);
+    if (_iface_is_internal(iface)) {
+      _area_add_dest(area, net_iface_dst_prefix(iface), vertex, _NONE,
+		     net_iface_get_metric(iface, 0));
+      continue;
+    }
+    if ((iface->area != area->id) || !igp_iface_is_usable(iface))
+      continue;
+
+    switch (iface->type) {
+    case NET_IFACE_RTR:
+    case NET_IFACE_PTP:
+      dst= iface->dest.iface;
+      if (dst->area != area->id)
+	continue;
+      router= _router_index(ctx, dst->owner);
+      if (router == _NONE)
+	continue;
+      target= _router_vertex(&ctx->routers[router], area_index);
+      if (iface->type == NET_IFACE_PTP)
+	_area_add_dest(area, net_iface_dst_prefix(dst), vertex,
+		       area->num_edges, 0);
+      _area_add_edge(area, target, net_iface_get_metric(iface, 0), index,
+		     (iface->type == NET_IFACE_RTR)?_EDGE_RTR:_EDGE_PTP);
+      break;
+    case NET_IFACE_PTMP:
+      target= _subnet_vertex(area, iface->dest.subnet);
+      _area_add_edge(area, target, net_iface_get_metric(iface, 0), index,
+		     _EDGE_PTMP);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// -----[ _area_build_subnet ]---------------------------------------
+static void _area_build_subnet(_area_ctx_t * ctx, unsigned int area_index,
+			       unsigned int vertex)
+{
+  _area_t * area= &ctx->areas[area_index];
+  net_subnet_t * subnet= area->subnets[vertex - area->num_routers];
+  net_iface_t * iface;
+  unsigned int index, router;
+
+  _area_add_dest(area, subnet->prefix, vertex, _NONE, 0);
+  if (!subnet_is_transit(subnet))
+    return;
+  for (index= 0; index < net_ifaces_size(subnet->ifaces); index++) {
+    iface= net_ifaces_at(subnet->ifaces, index);
+    if ((iface->area != area->id) || !igp_iface_is_usable(iface))
+      continue;
+    router= _router_index(ctx, iface->owner);
+    if (router == _NONE)
+      continue;
+    _area_add_edge(area, _router_vertex(&ctx->routers[router], area_index),
+		   0, index, _EDGE_SUBNET);
+  }
+}
+
+// -----[ _area_build ]----------------------------------------------
+/** Build the snapshot of an area. */
+static void _area_build(_area_ctx_t * ctx, unsigned int area_index)
+{
+  _area_t * area= &ctx->areas[area_index];
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index, index2, max_edges= 0, num_subnets= 0;
+
+  // Subnets of the area
+  for (index= 0; index < area->num_routers; index++) {
+    node= ctx->routers[area->routers[index]].node;
+    max_edges+= net_ifaces_size(node->ifaces);
+  }
+  area->subnets= (net_subnet_t **)
+    MALLOC(sizeof(net_subnet_t *) * (max_edges + 1));
+  for (index= 0; index < area->num_routers; index++) {
+    node= ctx->routers[area->routers[index]].node;
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if ((iface->type == NET_IFACE_PTMP) && (iface->area == area->id))
+	area->subnets[num_subnets++]= iface->dest.subnet;
+    }
+  }
+  qsort(area->subnets, num_subnets, sizeof(net_subnet_t *), _ptr_cmp);
+  for (index= 0; index < num_subnets; index++)
+    if ((index == 0) || (area->subnets[index] != area->subnets[index-1])) {
+      area->subnets[area->num_subnets++]= area->subnets[index];
+      max_edges+= net_ifaces_size(area->subnets[index]->ifaces) + 1;
+    }
+
+  // Edges (CSR) and destinations
+  area->num_vertices= area->num_routers + area->num_subnets;
+  area->first= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (area->num_vertices + 1));
+  area->edges= (_area_edge_t *) MALLOC(sizeof(_area_edge_t) * (max_edges + 1));
+  area->dests= (_area_dest_t *) MALLOC(sizeof(_area_dest_t) * (max_edges + 1));
+  for (index= 0; index < area->num_vertices; index++) {
+    area->first[index]= area->num_edges;
+    if (index < area->num_routers)
+      _area_build_router(ctx, area_index, index);
+    else
+      _area_build_subnet(ctx, area_index, index);
+  }
+  area->first[area->num_vertices]= area->num_edges;
+  if (area->num_edges > ctx->max_edges)
+    ctx->max_edges= area->num_edges;
+  if (area->num_subnets > ctx->max_subnets)
+    ctx->max_subnets= area->num_subnets;
+}
+
+// -----[ _ctx_load_prefixes ]---------------------------------------
+/** Build the table of the prefixes announced in the domain. */
+static void _ctx_load_prefixes(_area_ctx_t * ctx)
+{
+  _area_t * area;
+  ip_pfx_t * item;
+  unsigned int index, index2, num_prefixes= 0;
+
+  for (index= 0; index < ctx->num_areas; index++)
+    num_prefixes+= ctx->areas[index].num_dests;
+  ctx->prefixes= (ip_pfx_t *) MALLOC(sizeof(ip_pfx_t) * (num_prefixes + 1));
+  for (index= 0; index < ctx->num_areas; index++) {
+    area= &ctx->areas[index];
+    for (index2= 0; index2 < area->num_dests; index2++)
+      ctx->prefixes[ctx->num_prefixes++]= area->dests[index2].prefix;
+  }
+  qsort(ctx->prefixes, ctx->num_prefixes, sizeof(ip_pfx_t), _prefix_cmp);
+  num_prefixes= 0;
+  for (index= 0; index < ctx->num_prefixes; index++)
+    if ((index == 0) ||
+	(_prefix_cmp(&ctx->prefixes[index], &ctx->prefixes[index-1]) != 0))
+      ctx->prefixes[num_prefixes++]= ctx->prefixes[index];
+  ctx->num_prefixes= num_prefixes;
+
+  for (index= 0; index < ctx->num_areas; index++) {
+    area= &ctx->areas[index];
+    for (index2= 0; index2 < area->num_dests; index2++) {
+      item= (ip_pfx_t *) bsearch(&area->dests[index2].prefix, ctx->prefixes,
+				 ctx->num_prefixes, sizeof(ip_pfx_t),
+				 _prefix_cmp);
+      area->dests[index2].index= item - ctx->prefixes;
+    }
+  }
+}
+
+// -----[ _area_ctx_destroy ]----------------------------------------
+static void _area_ctx_destroy(_area_ctx_t * ctx)
+{
+  _area_router_t * router;
+  _area_t * area;
+  unsigned int index;
+
+  for (index= 0; index < ctx->num_areas; index++) {
+    area= &ctx->areas[index];
+    FREE(area->dests);
+    FREE(area->edges);
+    FREE(area->first);
+    FREE(area->subnets);
+    FREE(area->abrs);
+    FREE(area->routers);
+  }
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    if (router->summary != NULL)
+      FREE(router->summary);
+    if (router->total != NULL)
+      FREE(router->total);
+    FREE(router->areas);
+    FREE(router->fh_gws);
+    FREE(router->fh_ifaces);
+    FREE(router->fh_base);
+  }
+  FREE(ctx->prefixes);
+  FREE(ctx->areas);
+  FREE(ctx->routers);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// BATCHED SHORTEST PATHS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _vertex_key ]----------------------------------------------
+/**
+ * At equal distance, the subnets are visited before the routers.
+ * The edges from a subnet have a null weight and all the equal-cost
+ * next-hops of a router must be known before it is visited.
+ */
+static inline uint64_t _vertex_key(_area_t * area, unsigned int vertex,
+				   igp_weight_t weight)
+{
+  return (((uint64_t) weight) << 1) | (vertex < area->num_routers);
+}
+
+// -----[ _area_spt ]------------------------------------------------
+/**
+ * Compute the distance vector and the next-hops of one router of an
+ * area (Dijkstra with equal-cost multi-paths).
+ */
+static void _area_spt(_area_ctx_t * ctx, _area_t * area, unsigned int root,
+		      igp_weight_t * dist, uint32_t * nh, igp_heap_t * heap,
+		      unsigned int * direct, uint32_t * tmp)
+{
+  _area_router_t * router= &ctx->routers[area->routers[root]];
+  unsigned int num_words= router->num_words;
+  igp_heap_item_t item;
+  _area_edge_t * edge;
+  unsigned int index, vertex, base;
+  igp_weight_t weight;
+
+  for (index= 0; index < area->num_vertices; index++)
+    dist[index]= IGP_MAX_WEIGHT;
+  memset(nh, 0, sizeof(uint32_t) * area->num_vertices * num_words);
+  for (index= 0; index < area->num_subnets; index++)
+    direct[index]= _NONE;
+
+  dist[root]= 0;
+  heap->size= 0;
+  igp_heap_push(heap, _vertex_key(area, root, 0), root);
+  while (heap->size > 0) {
+    item= igp_heap_pop(heap);
+    vertex= item.vertex;
+    if (item.key != _vertex_key(area, vertex, dist[vertex]))
+      continue;
+
+    for (index= area->first[vertex]; index < area->first[vertex+1]; index++) {
+      edge= &area->edges[index];
+      if (edge->target == root)
+	continue;
+      if (edge->type == _EDGE_SUBNET)
+	weight= dist[vertex];
+      else
+	weight= net_igp_add_weights(dist[vertex], edge->weight);
+      if ((weight == IGP_MAX_WEIGHT) || (weight > dist[edge->target]))
+	continue;
+
+      // Next-hops through this edge. The gateway of a route through
+      // a subnet attached to the root is the address of the next
+      // router on the subnet.
+      if (vertex == root) {
+	memset(tmp, 0, sizeof(uint32_t) * num_words);
+	_bits_set(tmp, router->fh_base[edge->iface]);
+	if (edge->type == _EDGE_PTMP)
+	  direct[edge->target - area->num_routers]=
+	    router->fh_base[edge->iface];
+      } else {
+	memcpy(tmp, nh + vertex * num_words, sizeof(uint32_t) * num_words);
+	if (edge->type == _EDGE_SUBNET) {
+	  base= direct[vertex - area->num_routers];
+	  if ((base != _NONE) && _bits_test(tmp, base)) {
+	    _bits_clear(tmp, base);
+	    _bits_set(tmp, base + 1 + edge->iface);
+	  }
+	}
+      }
+
+      if (weight < dist[edge->target]) {
+	dist[edge->target]= weight;
+	memcpy(nh + edge->target * num_words, tmp,
+	       sizeof(uint32_t) * num_words);
+	igp_heap_push(heap, _vertex_key(area, edge->target, weight),
+		      edge->target);
+      } else {
+	_bits_or(nh + edge->target * num_words, tmp, num_words);
+      }
+    }
+  }
+}
+
+// -----[ _router_rows_create ]-------------------------------------
+/** Allocate the distance vectors of a router (one per area). */
+static void _router_rows_create(_area_ctx_t * ctx, _area_router_t * router)
+{
+  _area_member_t * member;
+  _area_t * area;
+  unsigned int index;
+
+  for (index= 0; index < router->num_areas; index++) {
+    member= &router->areas[index];
+    area= &ctx->areas[member->area];
+    member->dist= (igp_weight_t *)
+      MALLOC(sizeof(igp_weight_t) * (area->num_vertices + 1));
+    member->nh= (uint32_t *)
+      MALLOC(sizeof(uint32_t) * (area->num_vertices * router->num_words + 1));
+  }
+}
+
+// -----[ _router_rows_destroy ]-------------------------------------
+static void _router_rows_destroy(_area_router_t * router)
+{
+  unsigned int index;
+
+  for (index= 0; index < router->num_areas; index++) {
+    if (router->areas[index].dist != NULL)
+      FREE(router->areas[index].dist);
+    if (router->areas[index].nh != NULL)
+      FREE(router->areas[index].nh);
+    router->areas[index].dist= NULL;
+    router->areas[index].nh= NULL;
+  }
+}
+
+// -----[ _spt_run ]-------------------------------------------------
+/**
+ * Compute the distance vectors of routers until no job is left. The
+ * snapshots are only read and each router has its own distance
+ * vectors.
+ */
+static void _spt_run(void * arg)
+{
+  _area_ctx_t * ctx= (_area_ctx_t *) arg;
+  _area_router_t * router;
+  _area_member_t * member;
+  igp_heap_t heap;
+  unsigned int * direct;
+  uint32_t * tmp;
+  unsigned int index, job;
+
+  heap.items= (igp_heap_item_t *)
+    MALLOC(sizeof(igp_heap_item_t) * (ctx->max_edges + 1));
+  direct= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (ctx->max_subnets + 1));
+  tmp= (uint32_t *) MALLOC(sizeof(uint32_t) * ctx->max_words);
+  while ((job= THREAD_ADD(ctx->next_job, 1) - 1) < ctx->num_jobs) {
+    router= &ctx->routers[ctx->jobs[job]];
+    for (index= 0; index < router->num_areas; index++) {
+      member= &router->areas[index];
+      _area_spt(ctx, &ctx->areas[member->area], member->vertex,
+		member->dist, member->nh, &heap, direct, tmp);
+    }
+  }
+  FREE(tmp);
+  FREE(direct);
+  FREE(heap.items);
+}
+
+// -----[ _ctx_compute_spts ]----------------------------------------
+/**
+ * Compute the distance vectors of a list of routers. Their rows must
+ * be allocated (see _router_rows_create).
+ */
+static void _ctx_compute_spts(_area_ctx_t * ctx, unsigned int * jobs,
+			      unsigned int num_jobs, unsigned int num_threads)
+{
+  if (num_jobs == 0)
+    return;
+  ctx->jobs= jobs;
+  ctx->num_jobs= num_jobs;
+  ctx->next_job= 0;
+  if (num_threads > num_jobs)
+    num_threads= num_jobs;
+  igp_graph_run_workers(_spt_run, ctx, num_threads);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// ROUTING TABLES
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _table_merge ]---------------------------------------------
+static inline void _table_merge(igp_weight_t * cost, uint32_t * nh,
+				unsigned int num_words, unsigned int index,
+				igp_weight_t weight, const uint32_t * bits)
+{
+  if (weight < cost[index]) {
+    cost[index]= weight;
+    if (nh != NULL)
+      memcpy(nh + index * num_words, bits, sizeof(uint32_t) * num_words);
+  } else if ((weight == cost[index]) && (nh != NULL)) {
+    _bits_or(nh + index * num_words, bits, num_words);
+  }
+}
+
+// -----[ _table_intra ]---------------------------------------------
+/**
+ * Intra-area routes of a router, derived from its distance vectors.
+ * If nh is NULL, only the costs are computed.
+ */
+static void _table_intra(_area_ctx_t * ctx, _area_router_t * router,
+			 igp_weight_t * cost, uint32_t * nh, uint32_t * tmp,
+			 int skip_backbone)
+{
+  unsigned int num_words= router->num_words;
+  _area_t * area;
+  _area_dest_t * dest;
+  _area_edge_t * edge;
+  igp_weight_t * dist, weight;
+  uint32_t * vnh;
+  const uint32_t * bits;
+  unsigned int index, index2, root;
+
+  for (index= 0; index < router->num_areas; index++) {
+    area= &ctx->areas[router->areas[index].area];
+    if (skip_backbone && (area->id == IGP_AREA_BACKBONE))
+      continue;
+    root= router->areas[index].vertex;
+    dist= router->areas[index].dist;
+    vnh= router->areas[index].nh;
+    for (index2= 0; index2 < area->num_dests; index2++) {
+      dest= &area->dests[index2];
+      if (dist[dest->vertex] == IGP_MAX_WEIGHT)
+	continue;
+      if (dest->edge != _NONE) {
+	edge= &area->edges[dest->edge];
+	weight= net_igp_add_weights(dist[dest->vertex], edge->weight);
+	if (dest->vertex == root) {
+	  memset(tmp, 0, sizeof(uint32_t) * num_words);
+	  _bits_set(tmp, router->fh_base[edge->iface]);
+	  bits= tmp;
+	} else
+	  bits= vnh + dest->vertex * num_words;
+      } else {
+	if (dest->vertex == root)
+	  continue;
+	weight= net_igp_add_weights(dist[dest->vertex], dest->offset);
+	bits= vnh + dest->vertex * num_words;
+      }
+      if (weight == IGP_MAX_WEIGHT)
+	continue;
+      _table_merge(cost, nh, num_words, dest->index, weight, bits);
+    }
+  }
+}
+
+// -----[ _table_inter ]---------------------------------------------
+/**
+ * Inter-area routes of a router. The cost of a route through an ABR
+ * is the distance to the ABR plus the cost advertised by the ABR.
+ * An ABR only considers the summaries of the backbone.
+ */
+static void _table_inter(_area_ctx_t * ctx, _area_router_t * router,
+			 igp_weight_t * cost, uint32_t * nh, uint8_t * intra)
+{
+  unsigned int num_words= router->num_words;
+  _area_router_t * abr;
+  _area_t * area;
+  igp_weight_t * dist, * summary, weight;
+  unsigned int index, index2, index3, root, vertex;
+
+  for (index= 0; index < ctx->num_prefixes; index++)
+    intra[index]= (cost[index] != IGP_MAX_WEIGHT);
+
+  for (index= 0; index < router->num_areas; index++) {
+    area= &ctx->areas[router->areas[index].area];
+    if (router->is_abr && (area->id != IGP_AREA_BACKBONE))
+      continue;
+    root= router->areas[index].vertex;
+    dist= router->areas[index].dist;
+    for (index2= 0; index2 < area->num_abrs; index2++) {
+      vertex= area->abrs[index2];
+      if ((vertex == root) || (dist[vertex] == IGP_MAX_WEIGHT))
+	continue;
+      abr= &ctx->routers[area->routers[vertex]];
+      summary= (area->id == IGP_AREA_BACKBONE)?abr->summary:abr->total;
+      for (index3= 0; index3 < ctx->num_prefixes; index3++) {
+	if (intra[index3] || (summary[index3] == IGP_MAX_WEIGHT))
+	  continue;
+	weight= net_igp_add_weights(dist[vertex], summary[index3]);
+	if (weight == IGP_MAX_WEIGHT)
+	  continue;
+	_table_merge(cost, nh, num_words, index3, weight,
+		     router->areas[index].nh + vertex * num_words);
+      }
+    }
+  }
+}
+
+// -----[ _table_install ]-------------------------------------------
+static int _table_install(_area_ctx_t * ctx, _area_router_t * router,
+			  igp_weight_t * cost, uint32_t * nh)
+{
+  unsigned int num_words= router->num_words;
+  rt_info_t * rtinfo;
+  rt_entry_t * rtentry;
+  unsigned int index, index2;
+  int result;
+
+  node_rt_del_route(router->node, NULL, NULL, NULL, NET_ROUTE_IGP);
+  for (index= 0; index < ctx->num_prefixes; index++) {
+    if ((cost[index] == IGP_MAX_WEIGHT) ||
+	_bits_empty(nh + index * num_words, num_words))
+      continue;
+    rtinfo= rt_info_create(ctx->prefixes[index], cost[index], NET_ROUTE_IGP);
+    for (index2= 0; index2 < router->num_fhs; index2++) {
+      if (!_bits_test(nh + index * num_words, index2))
+	continue;
+      rtentry= rt_entry_create(router->fh_ifaces[index2],
+			       router->fh_gws[index2]);
+      if (rt_entries_add(rtinfo->entries, rtentry) < 0)
+	rt_entry_destroy(&rtentry);
+    }
+    result= rt_add_route(router->node->rt, ctx->prefixes[index], rtinfo);
+    if (result != ESUCCESS) {
+      rt_info_destroy(&rtinfo);
+      return result;
+    }
+  }
+  return ESUCCESS;
+}
+
+// -----[ _router_table ]-------------------------------------------
+/**
+ * Build and install the routing table of a router from its distance
+ * vectors. The table of an ABR is kept as the cost of the routes it
+ * advertises in its other areas.
+ */
+static int _router_table(_area_ctx_t * ctx, _area_router_t * router,
+			 igp_weight_t * cost, uint32_t * nh, uint8_t * intra,
+			 uint32_t * tmp)
+{
+  unsigned int index;
+
+  for (index= 0; index < ctx->num_prefixes; index++)
+    cost[index]= IGP_MAX_WEIGHT;
+  memset(nh, 0, sizeof(uint32_t) * router->num_words * ctx->num_prefixes);
+  _table_intra(ctx, router, cost, nh, tmp, 0);
+  _table_inter(ctx, router, cost, nh, intra);
+  if (router->is_abr) {
+    router->total= (igp_weight_t *)
+      MALLOC(sizeof(igp_weight_t) * (ctx->num_prefixes + 1));
+    memcpy(router->total, cost, sizeof(igp_weight_t) * ctx->num_prefixes);
+  }
+  return _table_install(ctx, router, cost, nh);
+}
+
+// -----[ _ctx_build_tables ]----------------------------------------
+/**
+ * Compute the distance vectors and build the routing tables. The
+ * ABRs are handled first since the other routers rely on the costs
+ * they advertise: their distance vectors are kept until all their
+ * summaries and tables are built. The other routers are handled by
+ * batches and their distance vectors are released as soon as their
+ * table is installed.
+ */
+static int _ctx_build_tables(_area_ctx_t * ctx, unsigned int num_threads)
+{
+  _area_router_t * router;
+  igp_weight_t * cost;
+  uint32_t * nh, * tmp;
+  uint8_t * intra;
+  unsigned int * jobs;
+  unsigned int index, index2, num_jobs;
+  int result= ESUCCESS;
+
+  cost= (igp_weight_t *)
+    MALLOC(sizeof(igp_weight_t) * (ctx->num_prefixes + 1));
+  nh= (uint32_t *)
+    MALLOC(sizeof(uint32_t) * ctx->max_words * (ctx->num_prefixes + 1));
+  intra= (uint8_t *) MALLOC(sizeof(uint8_t) * (ctx->num_prefixes + 1));
+  tmp= (uint32_t *) MALLOC(sizeof(uint32_t) * ctx->max_words);
+  jobs= (unsigned int *) MALLOC(sizeof(unsigned int) * (ctx->num_routers + 1));
+
+  // Summaries advertised by the ABRs in the backbone, then their
+  // routing tables
+  num_jobs= 0;
+  for (index= 0; index < ctx->num_routers; index++) {
+    router= &ctx->routers[index];
+    if (!router->is_abr)
+      continue;
+    _router_rows_create(ctx, router);
+    jobs[num_jobs++]= index;
+  }
+  _ctx_compute_spts(ctx, jobs, num_jobs, num_threads);
+  for (index= 0; index < num_jobs; index++) {
+    router= &ctx->routers[jobs[index]];
+    router->summary= (igp_weight_t *)
+      MALLOC(sizeof(igp_weight_t) * (ctx->num_prefixes + 1));
+    for (index2= 0; index2 < ctx->num_prefixes; index2++)
+      router->summary[index2]= IGP_MAX_WEIGHT;
+    _table_intra(ctx, router, router->summary, NULL, tmp, 1);
+  }
+  for (index= 0; (index < num_jobs) && (result == ESUCCESS); index++)
+    result= _router_table(ctx, &ctx->routers[jobs[index]], cost, nh, intra,
+			  tmp);
+  for (index= 0; index < num_jobs; index++)
+    _router_rows_destroy(&ctx->routers[jobs[index]]);
+
+  // Other routers
+  index= 0;
+  while ((result == ESUCCESS) && (index < ctx->num_routers)) {
+    num_jobs= 0;
+    for (; (index < ctx->num_routers) && (num_jobs < _BATCH_SIZE); index++) {
+      router= &ctx->routers[index];
+      if (router->is_abr)
+	continue;
+      _router_rows_create(ctx, router);
+      jobs[num_jobs++]= index;
+    }
+    _ctx_compute_spts(ctx, jobs, num_jobs, num_threads);
+    for (index2= 0; index2 < num_jobs; index2++) {
+      router= &ctx->routers[jobs[index2]];
+      if (result == ESUCCESS)
+	result= _router_table(ctx, router, cost, nh, intra, tmp);
+      _router_rows_destroy(router);
+    }
+  }
+
+  FREE(jobs);
+  FREE(tmp);
+  FREE(intra);
+  FREE(nh);
+  FREE(cost);
+  return result;
+}
+
+// -----[ igp_area_compute_domain ]----------------------------------
+int igp_area_compute_domain(igp_domain_t * domain, unsigned int num_threads)
+{
+  _area_ctx_t ctx;
+  unsigned int index;
+  int result;
+
+  memset(&ctx, 0, sizeof(ctx));
+  _ctx_load_routers(&ctx, domain);
+  _ctx_load_areas(&ctx);
+  for (index= 0; index < ctx.num_areas; index++)
+    _area_build(&ctx, index);
+  _ctx_load_prefixes(&ctx);
+
+  // The SPTs of the IGP model become stale
+  for (index= 0; index < ctx.num_routers; index++)
+    if (ctx.routers[index].node->spt != NULL)
+      spt_destroy(&ctx.routers[index].node->spt);
+
+  result= _ctx_build_tables(&ctx, num_threads);
+  _area_ctx_destroy(&ctx);
+  return result;
+}
@@ -0,0 +1,64 @@
+// ==================================================================
+// @(#)igp_area.h
+//
+// Multi-area link-state routing model (per-area batched SPTs).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide the route computation of OSPF domains. The domain is split
+ * in areas according to the area of each interface (see
+ * net_iface_t::area). Area 0 is the backbone. A router that has
+ * interfaces in the backbone and in another area is an area border
+ * router (ABR).
+ *
+ * For each area, a compact snapshot of the topology is built once
+ * and shared by all the routers of the area. The shortest paths of
+ * the routers are computed in parallel, by batches of routers.
+ *
+ * The distance vectors of a router are kept until its routing table
+ * is built, so that the inter-area routes are derived from them
+ * instead of computing the paths again. Only the distance vectors of
+ * the ABRs are kept until all of their tables are built, those of
+ * the other routers are released batch by batch:
+ * - intra-area routes are preferred ;
+ * - the ABRs advertise in the backbone the intra-area routes of
+ *   their other areas ;
+ * - the ABRs advertise in their other areas all their routes.
+ */
+
+#ifndef __NET_IGP_AREA_H__
+#define __NET_IGP_AREA_H__
+
+#include <net/net_types.h>
+
+/** Identifier of the backbone area. */
+#define IGP_AREA_BACKBONE 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ igp_area_compute_domain ]--------------------------------
+  /**
+   * Compute the routing tables of the routers of a domain, area by
+   * area.
+   *
+   * \param domain      is the target IGP domain.
+   * \param num_threads is the number of threads used to compute the
+   *                    shortest paths (at least 1).
+   * \retval ESUCCESS in case of success, a negative error code
+   *         otherwise.
+   */
+  int igp_area_compute_domain(igp_domain_t * domain,
+			      unsigned int num_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_IGP_AREA_H__ */
@@ -16,10 +16,13 @@
 #include <libgds/memory.h>
 #include <libgds/radix-tree.h>
 #include <net/igp.h>
+#include <net/igp_area.h>
 #include <net/igp_domain.h>
+#include <net/igp_matrix.h>
 #include <net/network.h>
 #include <net/node.h>
 #include <net/ospf.h>
+#include <sim/tracer.h>
 
 // -----[ igp_domain_create ]----------------------------------------
 igp_domain_t * igp_domain_create(uint16_t id, igp_domain_type_t type)
@@ -28,6 +31,7 @@ igp_domain_t * igp_domain_create(uint16_t id, igp_domain_type_t type)
   domain->id= id;
   domain->name= NULL;
   domain->type= type;
+  domain->matrix= NULL;
 
   /* Radix-tree with all routers. Destroy function is NULL. */
   domain->routers= trie_create(NULL);
@@ -40,6 +44,7 @@ void igp_domain_destroy(igp_domain_t ** domain_ref)
 {
   if (*domain_ref != NULL) {
     trie_destroy(&((*domain_ref)->routers));
+    igp_matrix_destroy(&((*domain_ref)->matrix));
     FREE(*domain_ref);
     *domain_ref= NULL;
   }
@@ -49,6 +54,7 @@ void igp_domain_destroy(igp_domain_t ** domain_ref)
 int igp_domain_add_router(igp_domain_t * domain, net_node_t * node)
 {
   trie_insert(domain->routers, node->rid, 32, node, 0);
+  igp_matrix_destroy(&domain->matrix);
   return node_igp_domain_add(node, domain->id);
 }
 
@@ -116,18 +122,17 @@ void igp_domain_info(gds_stream_t * stream, igp_domain_t * domain)
   stream_printf(stream, "\n");
 }
 
-// -----[ igp_domain_compute ]---------------------------------------
-int igp_domain_compute(igp_domain_t * domain, int keep_spt)
+// -----[ _igp_domain_compute ]--------------------------------------
+static inline int _igp_domain_compute(igp_domain_t * domain, int keep_spt,
+				      unsigned int num_threads)
 {
   switch (domain->type) {
   case IGP_DOMAIN_IGP:
     return igp_compute_domain(domain, keep_spt);
     break;
   case IGP_DOMAIN_OSPF:
-#ifdef OSPF_SUPPORT
-    if (ospf_domain_build_route(domain->id) >= 0)
+    if (igp_area_compute_domain(domain, num_threads) == ESUCCESS)
       return 0;
-#endif
     return -1;
   default:
     cbgp_fatal("invalid IGP domain type (%d)", domain->type);
@@ -135,6 +140,22 @@ int igp_domain_compute(igp_domain_t * domain, int keep_spt)
   }
 }
 
+// -----[ igp_domain_compute ]---------------------------------------
+int igp_domain_compute(igp_domain_t * domain, int keep_spt)
+{
+  return igp_domain_compute_parallel(domain, keep_spt, 1);
+}
+
+// -----[ igp_domain_compute_parallel ]------------------------------
+int igp_domain_compute_parallel(igp_domain_t * domain, int keep_spt,
+				unsigned int num_threads)
+{
+  uint64_t start= sim_trace_scope_begin();
+  int result= _igp_domain_compute(domain, keep_spt, num_threads);
+  sim_trace_scope_end(SIM_TRACE_IGP, start, 0);
+  return result;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -109,6 +109,17 @@ extern "C" {
    * \retval 0 on success, -1 on error.
    */
   int igp_domain_compute(igp_domain_t * domain, int keep_spt);
+  // -----[ igp_domain_compute_parallel ]---------------------------
+  /**
+   * Compute the routing tables of all the routers within an IGP
+   * domain, using several threads where the model allows it (the
+   * areas of an OSPF domain are computed in parallel).
+   *
+   * The routes of an OSPF domain are computed area by area (see
+   * net/igp_area.h) and no SPT is kept.
+   */
+  int igp_domain_compute_parallel(igp_domain_t * domain, int keep_spt,
+				  unsigned int num_threads);
 
   
   ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,135 @@
+// ==================================================================
+// @(#)igp_graph.c
+//
+// Building blocks of the IGP snapshots (see net/igp_graph.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+#include <libgds/trie.h>
+
+#include <net/igp_domain.h>
+#include <net/igp_graph.h>
+#include <util/slab.h>
+#include <util/thread.h>
+
+#ifdef HAVE_PTHREAD
+typedef struct {
+  igp_worker_f   worker;
+  void         * ctx;
+  pthread_t      thread;
+  int            threaded;
+} _igp_thread_t;
+#endif /* HAVE_PTHREAD */
+
+// -----[ _nodes_cmp ]-----------------------------------------------
+static int _nodes_cmp(const void * item1, const void * item2)
+{
+  net_addr_t rid1= (*((net_node_t **) item1))->rid;
+  net_addr_t rid2= (*((net_node_t **) item2))->rid;
+  return (rid1 < rid2)?-1:((rid1 > rid2)?1:0);
+}
+
+// -----[ igp_graph_routers ]----------------------------------------
+net_node_t ** igp_graph_routers(igp_domain_t * domain,
+				unsigned int * num_routers)
+{
+  net_node_t ** routers;
+  gds_enum_t * enu;
+  unsigned int index= 0;
+
+  enu= trie_get_enum(domain->routers);
+  while (enum_has_next(enu)) {
+    enum_get_next(enu);
+    index++;
+  }
+  enum_destroy(&enu);
+  *num_routers= index;
+  routers= (net_node_t **) MALLOC(sizeof(net_node_t *) * (index + 1));
+  index= 0;
+  enu= trie_get_enum(domain->routers);
+  while (enum_has_next(enu))
+    routers[index++]= *((net_node_t **) enum_get_next(enu));
+  enum_destroy(&enu);
+  qsort(routers, *num_routers, sizeof(net_node_t *), _nodes_cmp);
+  return routers;
+}
+
+// -----[ igp_graph_reverse ]----------------------------------------
+void igp_graph_reverse(const unsigned int * targets, size_t stride,
+		       unsigned int num_edges, unsigned int num_vertices,
+		       unsigned int ** rfirst_ref, unsigned int ** redges_ref)
+{
+  const uint8_t * base= (const uint8_t *) targets;
+  unsigned int * rfirst, * redges;
+  unsigned int index;
+
+#define _TARGET(I) (*((const unsigned int *) (base + (I) * stride)))
+  rfirst= (unsigned int *) MALLOC(sizeof(unsigned int) * (num_vertices + 1));
+  redges= (unsigned int *) MALLOC(sizeof(unsigned int) * (num_edges + 1));
+  memset(rfirst, 0, sizeof(unsigned int) * (num_vertices + 1));
+  for (index= 0; index < num_edges; index++)
+    rfirst[_TARGET(index) + 1]++;
+  for (index= 0; index < num_vertices; index++)
+    rfirst[index + 1]+= rfirst[index];
+  for (index= 0; index < num_edges; index++)
+    redges[rfirst[_TARGET(index)]++]= index;
+  for (index= num_vertices; index > 0; index--)
+    rfirst[index]= rfirst[index - 1];
+  rfirst[0]= 0;
+#undef _TARGET
+  *rfirst_ref= rfirst;
+  *redges_ref= redges;
+}
+
+#ifdef HAVE_PTHREAD
+// -----[ _igp_graph_thread ]----------------------------------------
+static void * _igp_graph_thread(void * arg)
+{
+  _igp_thread_t * thread= (_igp_thread_t *) arg;
+  thread->worker(thread->ctx);
+  slab_thread_exit();
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+// -----[ igp_graph_run_workers ]------------------------------------
+void igp_graph_run_workers(igp_worker_f worker, void * ctx,
+			   unsigned int num_threads)
+{
+#ifdef HAVE_PTHREAD
+  _igp_thread_t * threads;
+  unsigned int index;
+
+  if (num_threads <= 1) {
+    worker(ctx);
+    return;
+  }
+  threads= (_igp_thread_t *) MALLOC(num_threads * sizeof(_igp_thread_t));
+  thread_set_parallel(1);
+  for (index= 1; index < num_threads; index++) {
+    threads[index].worker= worker;
+    threads[index].ctx= ctx;
+    threads[index].threaded=
+      (pthread_create(&threads[index].thread, NULL,
+		      _igp_graph_thread, &threads[index]) == 0);
+  }
+  worker(ctx);
+  for (index= 1; index < num_threads; index++)
+    if (threads[index].threaded)
+      pthread_join(threads[index].thread, NULL);
+  thread_set_parallel(0);
+  FREE(threads);
+#else
+  worker(ctx);
+#endif /* HAVE_PTHREAD */
+}
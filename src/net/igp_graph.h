@@ -0,0 +1,156 @@
+// ==================================================================
+// @(#)igp_graph.h
+//
+// Building blocks of the IGP snapshots (distance matrix, weight
+// optimization and OSPF areas).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide the helpers shared by the modules that compute shortest
+ * paths on a snapshot of an IGP domain (see net/igp_matrix.h,
+ * net/igp_opt.h and net/igp_area.h):
+ * - the filter of the interfaces used by the IGP ;
+ * - the routers of a domain, sorted by identifier, and the lookup
+ *   of their index ;
+ * - a binary heap for Dijkstra ;
+ * - the incoming edges of a graph stored in CSR form ;
+ * - a pool of workers that share a list of jobs.
+ */
+
+#ifndef __NET_IGP_GRAPH_H__
+#define __NET_IGP_GRAPH_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <net/iface.h>
+#include <net/net_types.h>
+
+// -----[ igp_heap_t ]-----------------------------------------------
+/** Binary min-heap of vertices. Stale items are not removed. */
+typedef struct {
+  uint64_t     key;
+  unsigned int vertex;
+} igp_heap_item_t;
+
+typedef struct {
+  igp_heap_item_t * items;
+  unsigned int      size;
+} igp_heap_t;
+
+// -----[ igp_worker_f ]---------------------------------------------
+/** Process jobs until none is left. */
+typedef void (*igp_worker_f)(void * ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ igp_iface_is_usable ]------------------------------------
+  /** Same filter as the IGP model (see _link_traverse in igp.c). */
+  static inline int igp_iface_is_usable(net_iface_t * iface)
+  {
+    igp_weight_t weight;
+
+    if (!net_iface_is_enabled(iface) || !net_iface_is_connected(iface))
+      return 0;
+    weight= net_iface_get_metric(iface, 0);
+    return ((weight != 0) && (weight != IGP_MAX_WEIGHT));
+  }
+
+  // -----[ igp_heap_push ]------------------------------------------
+  static inline void igp_heap_push(igp_heap_t * heap, uint64_t key,
+				   unsigned int vertex)
+  {
+    unsigned int index= heap->size++, parent;
+    igp_heap_item_t item= { .key= key, .vertex= vertex };
+
+    while (index > 0) {
+      parent= (index - 1) / 2;
+      if (heap->items[parent].key <= key)
+	break;
+      heap->items[index]= heap->items[parent];
+      index= parent;
+    }
+    heap->items[index]= item;
+  }
+
+  // -----[ igp_heap_pop ]-------------------------------------------
+  static inline igp_heap_item_t igp_heap_pop(igp_heap_t * heap)
+  {
+    igp_heap_item_t top= heap->items[0];
+    igp_heap_item_t last= heap->items[--heap->size];
+    unsigned int index= 0, child;
+
+    while ((child= 2 * index + 1) < heap->size) {
+      if ((child + 1 < heap->size) &&
+	  (heap->items[child+1].key < heap->items[child].key))
+	child++;
+      if (last.key <= heap->items[child].key)
+	break;
+      heap->items[index]= heap->items[child];
+      index= child;
+    }
+    heap->items[index]= last;
+    return top;
+  }
+
+  // -----[ igp_graph_routers ]--------------------------------------
+  /**
+   * Return the routers of a domain, sorted by identifier. The array
+   * has one extra (unused) entry and must be freed by the caller.
+   */
+  net_node_t ** igp_graph_routers(igp_domain_t * domain,
+				  unsigned int * num_routers);
+  // -----[ igp_graph_index ]----------------------------------------
+  /**
+   * Return the index of a router in a sorted array of routers, or
+   * num_routers if the router is not in the array.
+   */
+  static inline unsigned int igp_graph_index(net_node_t ** routers,
+					     unsigned int num_routers,
+					     net_node_t * node)
+  {
+    unsigned int low= 0, high= num_routers, middle;
+
+    while (low < high) {
+      middle= (low + high) / 2;
+      if (routers[middle]->rid < node->rid)
+	low= middle+1;
+      else
+	high= middle;
+    }
+    if ((low < num_routers) && (routers[low] == node))
+      return low;
+    return num_routers;
+  }
+  // -----[ igp_graph_reverse ]--------------------------------------
+  /**
+   * Build the incoming edges of a graph (counting sort on the
+   * target). The target of edge i is read at offset i*stride from
+   * targets. The incoming edges of vertex v are the edges
+   * redges[rfirst[v]] to redges[rfirst[v+1]-1].
+   */
+  void igp_graph_reverse(const unsigned int * targets, size_t stride,
+			 unsigned int num_edges, unsigned int num_vertices,
+			 unsigned int ** rfirst_ref,
+			 unsigned int ** redges_ref);
+  // -----[ igp_graph_run_workers ]----------------------------------
+  /**
+   * Run a worker in num_threads threads (the calling thread is one
+   * of them) and wait for all of them. The number of threads should
+   * be bounded by the number of jobs.
+   */
+  void igp_graph_run_workers(igp_worker_f worker, void * ctx,
+			     unsigned int num_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_IGP_GRAPH_H__ */
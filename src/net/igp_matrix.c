@@ -0,0 +1,607 @@
+// ==================================================================
+// @(#)igp_matrix.c
+//
+// Distance matrix of an IGP domain and analysis of weight changes
+// (see net/igp_matrix.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <net/error.h>
+#include <net/iface.h>
+#include <net/igp_graph.h>
+#include <net/igp_matrix.h>
+#include <net/link_attr.h>
+#include <net/link-list.h>
+#include <net/network.h>
+#include <net/subnet.h>
+#include <util/thread.h>
+
+// -----[ _matrix_edge_t ]-------------------------------------------
+/**
+ * Edge of the router-level graph. A transit subnet is replaced by
+ * an edge from each attached router to each other one, with the
+ * weight of the interface that leads to the subnet.
+ */
+typedef struct {
+  unsigned int   source;
+  unsigned int   target;
+  igp_weight_t   weight;
+  net_iface_t  * iface;
+} _matrix_edge_t;
+
+// -----[ igp_matrix_t ]---------------------------------------------
+struct igp_matrix_t {
+  unsigned long    epoch;
+  unsigned int     num_routers;
+  /** Routers, sorted by identifier. */
+  net_node_t    ** routers;
+  /** Outgoing edges of router r: edges[first[r]] to edges[first[r+1]-1]. */
+  unsigned int   * first;
+  _matrix_edge_t * edges;
+  unsigned int     num_edges;
+  /** Incoming edges of router r: edges[redges[rfirst[r]]] to ... */
+  unsigned int   * rfirst;
+  unsigned int   * redges;
+  /** Distances (one row per source router). */
+  igp_weight_t   * dist;
+};
+
+#define _DIST(M,S,D) ((M)->dist[(S) * (M)->num_routers + (D)])
+
+// -----[ _matrix_ws_t ]---------------------------------------------
+/** Per-thread workspace, sized for the matrix. */
+typedef struct {
+  igp_weight_t   * dist;
+  uint8_t        * state;
+  unsigned int   * indeg;
+  unsigned int   * queue;
+  igp_heap_t       heap;
+} _matrix_ws_t;
+
+// -----[ _matrix_eval_ctx_t ]---------------------------------------
+typedef struct {
+  igp_matrix_t              * matrix;
+  const igp_weight_change_t * changes;
+  unsigned int                num_changes;
+  igp_change_report_t       * reports;
+  /** Index of the next change to evaluate (shared by the threads). */
+  unsigned int                next_change;
+} _matrix_eval_ctx_t;
+
+/** State of a source while a column is computed again. */
+#define _STATE_NONE     0
+#define _STATE_AFFECTED 1
+#define _STATE_DONE     2
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// DISTANCE MATRIX
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _matrix_index ]--------------------------------------------
+static inline unsigned int _matrix_index(igp_matrix_t * matrix,
+					 net_node_t * node)
+{
+  return igp_graph_index(matrix->routers, matrix->num_routers, node);
+}
+
+// -----[ _matrix_add_edge ]-----------------------------------------
+static inline void _matrix_add_edge(igp_matrix_t * matrix,
+				    unsigned int source, net_node_t * node,
+				    net_iface_t * iface)
+{
+  unsigned int target= _matrix_index(matrix, node);
+  _matrix_edge_t * edge;
+
+  if ((target == matrix->num_routers) || (target == source))
+    return;
+  edge= &matrix->edges[matrix->num_edges++];
+  edge->source= source;
+  edge->target= target;
+  edge->weight= net_iface_get_metric(iface, 0);
+  edge->iface= iface;
+}
+
+// -----[ _matrix_build_graph ]--------------------------------------
+static void _matrix_build_graph(igp_matrix_t * matrix)
+{
+  net_node_t * node;
+  net_iface_t * iface, * iface2;
+  net_subnet_t * subnet;
+  unsigned int index, index2, index3, max_edges= 0;
+
+  for (index= 0; index < matrix->num_routers; index++) {
+    node= matrix->routers[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (iface->type == NET_IFACE_PTMP)
+	max_edges+= net_ifaces_size(iface->dest.subnet->ifaces);
+      else
+	max_edges++;
+    }
+  }
+  matrix->edges= (_matrix_edge_t *)
+    MALLOC(sizeof(_matrix_edge_t) * (max_edges + 1));
+  matrix->first= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (matrix->num_routers + 1));
+
+  // Outgoing edges
+  for (index= 0; index < matrix->num_routers; index++) {
+    matrix->first[index]= matrix->num_edges;
+    node= matrix->routers[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (!igp_iface_is_usable(iface))
+	continue;
+      switch (iface->type) {
+      case NET_IFACE_RTR:
+      case NET_IFACE_PTP:
+	_matrix_add_edge(matrix, index, iface->dest.iface->owner, iface);
+	break;
+      case NET_IFACE_PTMP:
+	subnet= iface->dest.subnet;
+	if (!subnet_is_transit(subnet))
+	  break;
+	for (index3= 0; index3 < net_ifaces_size(subnet->ifaces); index3++) {
+	  iface2= net_ifaces_at(subnet->ifaces, index3);
+	  if (igp_iface_is_usable(iface2))
+	    _matrix_add_edge(matrix, index, iface2->owner, iface);
+	}
+	break;
+      default:
+	break;
+      }
+    }
+  }
+  matrix->first[matrix->num_routers]= matrix->num_edges;
+
+  // Incoming edges
+  igp_graph_reverse(&matrix->edges[0].target, sizeof(_matrix_edge_t),
+		    matrix->num_edges, matrix->num_routers,
+		    &matrix->rfirst, &matrix->redges);
+}
+
+// -----[ _matrix_compute_row ]--------------------------------------
+/** Distances from one source (Dijkstra). */
+static void _matrix_compute_row(igp_matrix_t * matrix, unsigned int source,
+				igp_heap_t * heap)
+{
+  igp_weight_t * dist= &_DIST(matrix, source, 0);
+  igp_heap_item_t item;
+  _matrix_edge_t * edge;
+  igp_weight_t weight;
+  unsigned int index;
+
+  for (index= 0; index < matrix->num_routers; index++)
+    dist[index]= IGP_MAX_WEIGHT;
+  dist[source]= 0;
+  heap->size= 0;
+  igp_heap_push(heap, 0, source);
+  while (heap->size > 0) {
+    item= igp_heap_pop(heap);
+    if (item.key != dist[item.vertex])
+      continue;
+    for (index= matrix->first[item.vertex];
+	 index < matrix->first[item.vertex + 1]; index++) {
+      edge= &matrix->edges[index];
+      weight= net_igp_add_weights(item.key, edge->weight);
+      if (weight < dist[edge->target]) {
+	dist[edge->target]= weight;
+	igp_heap_push(heap, weight, edge->target);
+      }
+    }
+  }
+}
+
+// -----[ igp_matrix_create ]----------------------------------------
+igp_matrix_t * igp_matrix_create(igp_domain_t * domain)
+{
+  igp_matrix_t * matrix= (igp_matrix_t *) MALLOC(sizeof(igp_matrix_t));
+  igp_heap_t heap;
+  unsigned int index;
+
+  memset(matrix, 0, sizeof(igp_matrix_t));
+  matrix->epoch= network_get_topo_epoch();
+  matrix->routers= igp_graph_routers(domain, &matrix->num_routers);
+
+  _matrix_build_graph(matrix);
+
+  matrix->dist= (igp_weight_t *)
+    MALLOC(sizeof(igp_weight_t) *
+	   (matrix->num_routers * matrix->num_routers + 1));
+  heap.items= (igp_heap_item_t *)
+    MALLOC(sizeof(igp_heap_item_t) * (matrix->num_edges + 1));
+  for (index= 0; index < matrix->num_routers; index++)
+    _matrix_compute_row(matrix, index, &heap);
+  FREE(heap.items);
+  return matrix;
+}
+
+// -----[ igp_matrix_destroy ]---------------------------------------
+void igp_matrix_destroy(igp_matrix_t ** matrix_ref)
+{
+  igp_matrix_t * matrix= *matrix_ref;
+
+  if (matrix == NULL)
+    return;
+  FREE(matrix->dist);
+  FREE(matrix->redges);
+  FREE(matrix->rfirst);
+  FREE(matrix->first);
+  FREE(matrix->edges);
+  FREE(matrix->routers);
+  FREE(matrix);
+  *matrix_ref= NULL;
+}
+
+// -----[ igp_matrix_get ]-------------------------------------------
+igp_matrix_t * igp_matrix_get(igp_domain_t * domain)
+{
+  if ((domain->matrix != NULL) &&
+      (domain->matrix->epoch != network_get_topo_epoch()))
+    igp_matrix_destroy(&domain->matrix);
+  if (domain->matrix == NULL)
+    domain->matrix= igp_matrix_create(domain);
+  return domain->matrix;
+}
+
+// -----[ igp_matrix_dist ]------------------------------------------
+igp_weight_t igp_matrix_dist(igp_matrix_t * matrix, net_node_t * src,
+			     net_node_t * dst)
+{
+  unsigned int source= _matrix_index(matrix, src);
+  unsigned int target= _matrix_index(matrix, dst);
+
+  if ((source == matrix->num_routers) || (target == matrix->num_routers))
+    return IGP_MAX_WEIGHT;
+  return _DIST(matrix, source, target);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// WEIGHT CHANGES
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _change_weight ]-------------------------------------------
+/** Weight of an edge once the change is applied. */
+static inline igp_weight_t _change_weight(const igp_weight_change_t * change,
+					  _matrix_edge_t * edge)
+{
+  return (edge->iface == change->iface)?change->weight:edge->weight;
+}
+
+// -----[ _column_decrease ]-----------------------------------------
+/**
+ * New distances towards a destination when the weight decreases:
+ * a source either keeps its path or goes through the interface.
+ *
+ * \retval 1 if a distance or a next-hop may change, 0 otherwise.
+ */
+static int _column_decrease(igp_matrix_t * matrix,
+			    const igp_weight_change_t * change,
+			    unsigned int owner, unsigned int dst,
+			    igp_weight_t * dist)
+{
+  igp_weight_t via= IGP_MAX_WEIGHT, weight;
+  unsigned int index;
+  int touched= 0;
+
+  for (index= matrix->first[owner]; index < matrix->first[owner+1]; index++)
+    if (matrix->edges[index].iface == change->iface) {
+      weight= net_igp_add_weights(change->weight,
+				  _DIST(matrix, matrix->edges[index].target,
+					dst));
+      if (weight < via)
+	via= weight;
+    }
+  if (via == IGP_MAX_WEIGHT)
+    return 0;
+
+  for (index= 0; index < matrix->num_routers; index++) {
+    dist[index]= _DIST(matrix, index, dst);
+    weight= net_igp_add_weights(_DIST(matrix, index, owner), via);
+    if ((weight != IGP_MAX_WEIGHT) && (weight <= dist[index])) {
+      dist[index]= weight;
+      touched= 1;
+    }
+  }
+  return touched;
+}
+
+// -----[ _column_increase ]-----------------------------------------
+/**
+ * New distances towards a destination when the weight increases.
+ * Only the sources that have a shortest path through the interface
+ * are affected. Their distances are computed again from the
+ * unaffected sources, in increasing order (Dijkstra on the incoming
+ * edges).
+ *
+ * \retval 1 if a distance or a next-hop may change, 0 otherwise.
+ */
+static int _column_increase(igp_matrix_t * matrix,
+			    const igp_weight_change_t * change,
+			    unsigned int owner, igp_weight_t old_weight,
+			    unsigned int dst, _matrix_ws_t * ws)
+{
+  igp_weight_t via= IGP_MAX_WEIGHT, weight, best;
+  igp_heap_item_t item;
+  _matrix_edge_t * edge;
+  unsigned int index, index2, num_affected= 0;
+
+  for (index= matrix->first[owner]; index < matrix->first[owner+1]; index++)
+    if (matrix->edges[index].iface == change->iface) {
+      weight= net_igp_add_weights(old_weight,
+				  _DIST(matrix, matrix->edges[index].target,
+					dst));
+      if (weight < via)
+	via= weight;
+    }
+  if (via == IGP_MAX_WEIGHT)
+    return 0;
+
+  for (index= 0; index < matrix->num_routers; index++) {
+    ws->dist[index]= _DIST(matrix, index, dst);
+    ws->state[index]= _STATE_NONE;
+    weight= net_igp_add_weights(_DIST(matrix, index, owner), via);
+    if ((weight != IGP_MAX_WEIGHT) && (weight == ws->dist[index])) {
+      ws->state[index]= _STATE_AFFECTED;
+      ws->dist[index]= IGP_MAX_WEIGHT;
+      num_affected++;
+    }
+  }
+  if (num_affected == 0)
+    return 0;
+
+  // Best path of each affected source through an unaffected one
+  ws->heap.size= 0;
+  for (index= 0; index < matrix->num_routers; index++) {
+    if (ws->state[index] != _STATE_AFFECTED)
+      continue;
+    best= IGP_MAX_WEIGHT;
+    for (index2= matrix->first[index]; index2 < matrix->first[index+1];
+	 index2++) {
+      edge= &matrix->edges[index2];
+      if (ws->state[edge->target] != _STATE_NONE)
+	continue;
+      weight= net_igp_add_weights(_change_weight(change, edge),
+				  ws->dist[edge->target]);
+      if (weight < best)
+	best= weight;
+    }
+    if (best != IGP_MAX_WEIGHT) {
+      ws->dist[index]= best;
+      igp_heap_push(&ws->heap, best, index);
+    }
+  }
+
+  while (ws->heap.size > 0) {
+    item= igp_heap_pop(&ws->heap);
+    if ((ws->state[item.vertex] != _STATE_AFFECTED) ||
+	(item.key != ws->dist[item.vertex]))
+      continue;
+    ws->state[item.vertex]= _STATE_DONE;
+    for (index= matrix->rfirst[item.vertex];
+	 index < matrix->rfirst[item.vertex + 1]; index++) {
+      edge= &matrix->edges[matrix->redges[index]];
+      if (ws->state[edge->source] != _STATE_AFFECTED)
+	continue;
+      weight= net_igp_add_weights(_change_weight(change, edge), item.key);
+      if (weight < ws->dist[edge->source]) {
+	ws->dist[edge->source]= weight;
+	igp_heap_push(&ws->heap, weight, edge->source);
+      }
+    }
+  }
+  return 1;
+}
+
+// -----[ _edge_next_hop ]-------------------------------------------
+/**
+ * Tell if an edge is a next-hop towards a destination, before (bit
+ * 0) and after (bit 1) the change.
+ */
+static inline int _edge_next_hop(igp_matrix_t * matrix,
+				 const igp_weight_change_t * change,
+				 _matrix_edge_t * edge, unsigned int dst,
+				 igp_weight_t * dist)
+{
+  igp_weight_t old_dist= _DIST(matrix, edge->source, dst);
+  igp_weight_t weight;
+  int result= 0;
+
+  if ((old_dist != IGP_MAX_WEIGHT) &&
+      (_DIST(matrix, edge->target, dst) != IGP_MAX_WEIGHT)) {
+    weight= net_igp_add_weights(edge->weight, _DIST(matrix, edge->target, dst));
+    if (weight == old_dist)
+      result|= 1;
+  }
+  if ((dist[edge->source] != IGP_MAX_WEIGHT) &&
+      (dist[edge->target] != IGP_MAX_WEIGHT)) {
+    weight= net_igp_add_weights(_change_weight(change, edge),
+				dist[edge->target]);
+    if ((weight != IGP_MAX_WEIGHT) && (weight == dist[edge->source]))
+      result|= 2;
+  }
+  return result;
+}
+
+// -----[ _column_compare ]------------------------------------------
+/**
+ * Compare the old and new distances and next-hops towards a
+ * destination, then look for a cycle in the union of the old and
+ * new next-hops (Kahn's topological sort).
+ */
+static void _column_compare(igp_matrix_t * matrix,
+			    const igp_weight_change_t * change,
+			    unsigned int dst, _matrix_ws_t * ws,
+			    igp_change_report_t * report)
+{
+  igp_weight_t old_dist;
+  unsigned int index, index2, head= 0, tail= 0;
+  int next_hop, deflected;
+
+  memset(ws->indeg, 0, sizeof(unsigned int) * matrix->num_routers);
+  for (index= 0; index < matrix->num_routers; index++) {
+    old_dist= _DIST(matrix, index, dst);
+    if (old_dist != ws->dist[index]) {
+      report->num_changed++;
+      if (ws->dist[index] == IGP_MAX_WEIGHT)
+	report->num_unreachable++;
+    }
+    if (index == dst)
+      continue;
+    deflected= 0;
+    for (index2= matrix->first[index]; index2 < matrix->first[index+1];
+	 index2++) {
+      next_hop= _edge_next_hop(matrix, change, &matrix->edges[index2], dst,
+			       ws->dist);
+      if (next_hop == 1 || next_hop == 2)
+	deflected= 1;
+      if (next_hop != 0)
+	ws->indeg[matrix->edges[index2].target]++;
+    }
+    if (deflected)
+      report->num_deflected++;
+  }
+
+  for (index= 0; index < matrix->num_routers; index++)
+    if (ws->indeg[index] == 0)
+      ws->queue[tail++]= index;
+  while (head < tail) {
+    index= ws->queue[head++];
+    if (index == dst)
+      continue;
+    for (index2= matrix->first[index]; index2 < matrix->first[index+1];
+	 index2++)
+      if (_edge_next_hop(matrix, change, &matrix->edges[index2], dst,
+			 ws->dist) != 0)
+	if (--ws->indeg[matrix->edges[index2].target] == 0)
+	  ws->queue[tail++]= matrix->edges[index2].target;
+  }
+  if (tail < matrix->num_routers)
+    report->num_loops++;
+}
+
+// -----[ _matrix_eval_change ]--------------------------------------
+static void _matrix_eval_change(igp_matrix_t * matrix,
+				const igp_weight_change_t * change,
+				_matrix_ws_t * ws,
+				igp_change_report_t * report)
+{
+  unsigned int owner= _matrix_index(matrix, change->iface->owner);
+  igp_weight_t old_weight= IGP_MAX_WEIGHT;
+  unsigned int index;
+  int touched;
+
+  memset(report, 0, sizeof(igp_change_report_t));
+  for (index= matrix->first[owner]; index < matrix->first[owner+1]; index++)
+    if (matrix->edges[index].iface == change->iface)
+      old_weight= matrix->edges[index].weight;
+  if (old_weight == change->weight)
+    return;
+
+  for (index= 0; index < matrix->num_routers; index++) {
+    if (change->weight < old_weight)
+      touched= _column_decrease(matrix, change, owner, index, ws->dist);
+    else
+      touched= _column_increase(matrix, change, owner, old_weight, index, ws);
+    if (touched)
+      _column_compare(matrix, change, index, ws, report);
+  }
+}
+
+// -----[ _matrix_ws_create ]----------------------------------------
+static _matrix_ws_t * _matrix_ws_create(igp_matrix_t * matrix)
+{
+  _matrix_ws_t * ws= (_matrix_ws_t *) MALLOC(sizeof(_matrix_ws_t));
+  unsigned int size= matrix->num_routers + 1;
+
+  ws->dist= (igp_weight_t *) MALLOC(sizeof(igp_weight_t) * size);
+  ws->state= (uint8_t *) MALLOC(sizeof(uint8_t) * size);
+  ws->indeg= (unsigned int *) MALLOC(sizeof(unsigned int) * size);
+  ws->queue= (unsigned int *) MALLOC(sizeof(unsigned int) * size);
+  ws->heap.items= (igp_heap_item_t *)
+    MALLOC(sizeof(igp_heap_item_t) * (matrix->num_edges + size));
+  ws->heap.size= 0;
+  return ws;
+}
+
+// -----[ _matrix_ws_destroy ]---------------------------------------
+static void _matrix_ws_destroy(_matrix_ws_t ** ws_ref)
+{
+  _matrix_ws_t * ws= *ws_ref;
+  FREE(ws->heap.items);
+  FREE(ws->queue);
+  FREE(ws->indeg);
+  FREE(ws->state);
+  FREE(ws->dist);
+  FREE(ws);
+  *ws_ref= NULL;
+}
+
+// -----[ _matrix_run ]----------------------------------------------
+/** Evaluate changes until none is left. */
+static void _matrix_run(void * arg)
+{
+  _matrix_eval_ctx_t * ctx= (_matrix_eval_ctx_t *) arg;
+  _matrix_ws_t * ws= _matrix_ws_create(ctx->matrix);
+  unsigned int index;
+
+  while ((index= THREAD_ADD(ctx->next_change, 1) - 1) < ctx->num_changes)
+    _matrix_eval_change(ctx->matrix, &ctx->changes[index], ws,
+			&ctx->reports[index]);
+  _matrix_ws_destroy(&ws);
+}
+
+// -----[ igp_matrix_eval ]------------------------------------------
+int igp_matrix_eval(igp_matrix_t * matrix,
+		    const igp_weight_change_t * changes,
+		    unsigned int num_changes,
+		    igp_change_report_t * reports,
+		    unsigned int num_threads)
+{
+  _matrix_eval_ctx_t ctx= {
+    .matrix= matrix,
+    .changes= changes,
+    .num_changes= num_changes,
+    .reports= reports,
+    .next_change= 0,
+  };
+  unsigned int index, index2, owner;
+
+  // The interfaces must be used by the domain
+  for (index= 0; index < num_changes; index++) {
+    if (changes[index].weight == 0)
+      return EUNEXPECTED;
+    owner= _matrix_index(matrix, changes[index].iface->owner);
+    if (owner == matrix->num_routers)
+      return EUNEXPECTED;
+    for (index2= matrix->first[owner]; index2 < matrix->first[owner+1];
+	 index2++)
+      if (matrix->edges[index2].iface == changes[index].iface)
+	break;
+    if (index2 == matrix->first[owner+1])
+      return EUNEXPECTED;
+  }
+
+  if (num_threads > num_changes)
+    num_threads= num_changes;
+  igp_graph_run_workers(_matrix_run, &ctx, num_threads);
+  return ESUCCESS;
+}
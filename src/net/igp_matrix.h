@@ -0,0 +1,106 @@
+// ==================================================================
+// @(#)igp_matrix.h
+//
+// Distance matrix of an IGP domain and analysis of weight changes.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide the all-pairs distance matrix of an IGP domain and the
+ * evaluation of IGP weight changes against it.
+ *
+ * The matrix is a dense array (one row per source router) computed
+ * on the router-level graph of the domain. It is cached in the
+ * domain until the topology epoch changes (see
+ * network_get_topo_epoch). Route changes do not invalidate it.
+ *
+ * A weight change is evaluated by delta computation. For each
+ * destination, only the sources whose shortest paths use the
+ * changed interface are recomputed when the weight increases, and a
+ * closed form is used when it decreases. The following is reported
+ * for each change:
+ * - the (source, destination) pairs whose distance changes ;
+ * - the pairs whose traffic is deflected, i.e. whose set of
+ *   next-hops changes ;
+ * - the pairs that become unreachable ;
+ * - the destinations for which a transient forwarding loop may
+ *   occur while the routers converge. Such a loop exists if the
+ *   union of the old and new next-hops towards the destination
+ *   contains a cycle.
+ */
+
+#ifndef __NET_IGP_MATRIX_H__
+#define __NET_IGP_MATRIX_H__
+
+#include <net/net_types.h>
+
+typedef struct igp_matrix_t igp_matrix_t;
+
+// -----[ igp_weight_change_t ]--------------------------------------
+/** Candidate change of the weight of an interface (one direction). */
+typedef struct {
+  net_iface_t  * iface;
+  /** New weight (IGP_MAX_WEIGHT removes the interface). */
+  igp_weight_t   weight;
+} igp_weight_change_t;
+
+// -----[ igp_change_report_t ]--------------------------------------
+typedef struct {
+  unsigned int num_changed;
+  unsigned int num_deflected;
+  unsigned int num_unreachable;
+  unsigned int num_loops;
+} igp_change_report_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ igp_matrix_create ]--------------------------------------
+  /** Compute the distance matrix of a domain. */
+  igp_matrix_t * igp_matrix_create(igp_domain_t * domain);
+  // -----[ igp_matrix_destroy ]-------------------------------------
+  void igp_matrix_destroy(igp_matrix_t ** matrix_ref);
+  // -----[ igp_matrix_get ]-----------------------------------------
+  /**
+   * Get the distance matrix cached in a domain. The matrix is
+   * computed again if the topology has changed.
+   */
+  igp_matrix_t * igp_matrix_get(igp_domain_t * domain);
+  // -----[ igp_matrix_dist ]----------------------------------------
+  /**
+   * Distance between two routers (IGP_MAX_WEIGHT if one of them is
+   * not in the domain or if there is no path).
+   */
+  igp_weight_t igp_matrix_dist(igp_matrix_t * matrix, net_node_t * src,
+			       net_node_t * dst);
+  // -----[ igp_matrix_eval ]----------------------------------------
+  /**
+   * Evaluate candidate weight changes. Each change is evaluated
+   * alone against the current weights. The changes are shared
+   * among the threads.
+   *
+   * \param matrix      is the distance matrix.
+   * \param changes     is the array of candidate changes.
+   * \param num_changes is the number of candidate changes.
+   * \param reports     receives one report per change.
+   * \param num_threads is the number of threads (at least 1).
+   * \retval ESUCCESS, or EUNEXPECTED if an interface is not used
+   *         by the domain or if a weight is null (no report is
+   *         computed in this case).
+   */
+  int igp_matrix_eval(igp_matrix_t * matrix,
+		      const igp_weight_change_t * changes,
+		      unsigned int num_changes,
+		      igp_change_report_t * reports,
+		      unsigned int num_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_IGP_MATRIX_H__ */
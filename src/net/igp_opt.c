@@ -0,0 +1,767 @@
+// ==================================================================
+// @(#)igp_opt.c
+//
+// Local search of IGP weights (see net/igp_opt.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <net/error.h>
+#include <net/iface.h>
+#include <net/igp_graph.h>
+#include <net/igp_opt.h>
+#include <net/link_attr.h>
+#include <net/link-list.h>
+#include <net/node.h>
+#include <net/subnet.h>
+#include <util/rng.h>
+#include <util/thread.h>
+
+/** Tolerance used to compare objective values. */
+#define _OPT_EPSILON 1e-9
+
+// -----[ _opt_edge_t ]----------------------------------------------
+typedef struct {
+  unsigned int source;
+  unsigned int target;
+  /** Interface of the edge (index in igp_opt_t::slots). */
+  unsigned int slot;
+} _opt_edge_t;
+
+// -----[ _opt_slot_t ]----------------------------------------------
+/** Interface whose weight can be changed. */
+typedef struct {
+  net_iface_t     * iface;
+  igp_weight_t      weight;
+  net_link_load_t   capacity;
+  /** The edges of an interface are contiguous. */
+  unsigned int      first_edge;
+  unsigned int      num_edges;
+} _opt_slot_t;
+
+// -----[ _opt_demand_t ]--------------------------------------------
+typedef struct {
+  unsigned int dst;
+  unsigned int src;
+  double       volume;
+} _opt_demand_t;
+
+// -----[ igp_opt_t ]------------------------------------------------
+struct igp_opt_t {
+  unsigned int    num_routers;
+  /** Routers, sorted by identifier. */
+  net_node_t   ** routers;
+  /** Outgoing edges of router r: edges[first[r]] to edges[first[r+1]-1]. */
+  unsigned int  * first;
+  _opt_edge_t   * edges;
+  unsigned int    num_edges;
+  /** Incoming edges of router r: edges[redges[rfirst[r]]] to ... */
+  unsigned int  * rfirst;
+  unsigned int  * redges;
+  _opt_slot_t   * slots;
+  unsigned int    num_slots;
+  /** Traffic, sorted by destination when the state is valid. */
+  _opt_demand_t * demands;
+  unsigned int    num_demands;
+  unsigned int    size_demands;
+
+  // Routing state, one column per destination that receives traffic
+  int             valid;
+  unsigned int    num_columns;
+  unsigned int  * columns;
+  /** Demands of a column: demands[column_first[c]] to ... */
+  unsigned int  * column_first;
+  /** Distances (dist[column * num_routers + src]). */
+  igp_weight_t  * dist;
+  /** Load of each edge (contrib[column * num_edges + edge]). */
+  double        * contrib;
+  /** Load of each interface. */
+  double        * load;
+};
+
+// -----[ _opt_ws_t ]------------------------------------------------
+/** Per-thread workspace. */
+typedef struct {
+  igp_weight_t * dist;
+  double       * contrib;
+  double       * load;
+  double       * flow;
+  unsigned int * order;
+  igp_heap_t     heap;
+} _opt_ws_t;
+
+// -----[ _opt_candidate_t ]-----------------------------------------
+typedef struct {
+  unsigned int slot;
+  igp_weight_t weight;
+  double       max_util;
+  double       total;
+} _opt_candidate_t;
+
+// -----[ _opt_search_ctx_t ]----------------------------------------
+typedef struct {
+  igp_opt_t        * opt;
+  _opt_candidate_t * candidates;
+  unsigned int       num_candidates;
+  /** Index of the next candidate to evaluate (shared by the threads). */
+  unsigned int       next_candidate;
+} _opt_search_ctx_t;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SNAPSHOT
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _opt_index ]-----------------------------------------------
+static inline unsigned int _opt_index(igp_opt_t * opt, net_node_t * node)
+{
+  return igp_graph_index(opt->routers, opt->num_routers, node);
+}
+
+// -----[ _opt_add_edge ]--------------------------------------------
+static inline void _opt_add_edge(igp_opt_t * opt, unsigned int source,
+				 net_node_t * node)
+{
+  unsigned int target= _opt_index(opt, node);
+  _opt_edge_t * edge;
+
+  if ((target == opt->num_routers) || (target == source))
+    return;
+  edge= &opt->edges[opt->num_edges++];
+  edge->source= source;
+  edge->target= target;
+  edge->slot= opt->num_slots;
+}
+
+// -----[ _opt_build_graph ]-----------------------------------------
+static void _opt_build_graph(igp_opt_t * opt)
+{
+  net_node_t * node;
+  net_iface_t * iface, * iface2;
+  net_subnet_t * subnet;
+  _opt_slot_t * slot;
+  unsigned int index, index2, index3, max_edges= 0, max_slots= 0;
+
+  for (index= 0; index < opt->num_routers; index++) {
+    node= opt->routers[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (iface->type == NET_IFACE_PTMP)
+	max_edges+= net_ifaces_size(iface->dest.subnet->ifaces);
+      else
+	max_edges++;
+      max_slots++;
+    }
+  }
+  opt->edges= (_opt_edge_t *) MALLOC(sizeof(_opt_edge_t) * (max_edges + 1));
+  opt->slots= (_opt_slot_t *) MALLOC(sizeof(_opt_slot_t) * (max_slots + 1));
+  opt->first= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (opt->num_routers + 1));
+
+  // Outgoing edges, grouped by interface
+  for (index= 0; index < opt->num_routers; index++) {
+    opt->first[index]= opt->num_edges;
+    node= opt->routers[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (!igp_iface_is_usable(iface))
+	continue;
+      slot= &opt->slots[opt->num_slots];
+      slot->first_edge= opt->num_edges;
+      switch (iface->type) {
+      case NET_IFACE_RTR:
+      case NET_IFACE_PTP:
+	_opt_add_edge(opt, index, iface->dest.iface->owner);
+	break;
+      case NET_IFACE_PTMP:
+	subnet= iface->dest.subnet;
+	if (!subnet_is_transit(subnet))
+	  break;
+	for (index3= 0; index3 < net_ifaces_size(subnet->ifaces); index3++) {
+	  iface2= net_ifaces_at(subnet->ifaces, index3);
+	  if (igp_iface_is_usable(iface2))
+	    _opt_add_edge(opt, index, iface2->owner);
+	}
+	break;
+      default:
+	break;
+      }
+      slot->num_edges= opt->num_edges - slot->first_edge;
+      if (slot->num_edges == 0)
+	continue;
+      slot->iface= iface;
+      slot->weight= net_iface_get_metric(iface, 0);
+      slot->capacity= net_iface_get_capacity(iface);
+      opt->num_slots++;
+    }
+  }
+  opt->first[opt->num_routers]= opt->num_edges;
+
+  // Incoming edges
+  igp_graph_reverse(&opt->edges[0].target, sizeof(_opt_edge_t),
+		    opt->num_edges, opt->num_routers,
+		    &opt->rfirst, &opt->redges);
+}
+
+// -----[ igp_opt_create ]-------------------------------------------
+igp_opt_t * igp_opt_create(igp_domain_t * domain)
+{
+  igp_opt_t * opt= (igp_opt_t *) MALLOC(sizeof(igp_opt_t));
+
+  memset(opt, 0, sizeof(igp_opt_t));
+  opt->routers= igp_graph_routers(domain, &opt->num_routers);
+
+  _opt_build_graph(opt);
+
+  opt->load= (double *) MALLOC(sizeof(double) * (opt->num_slots + 1));
+  return opt;
+}
+
+// -----[ _opt_clear_state ]-----------------------------------------
+static void _opt_clear_state(igp_opt_t * opt)
+{
+  if (opt->columns != NULL)
+    FREE(opt->columns);
+  if (opt->column_first != NULL)
+    FREE(opt->column_first);
+  if (opt->dist != NULL)
+    FREE(opt->dist);
+  if (opt->contrib != NULL)
+    FREE(opt->contrib);
+  opt->columns= NULL;
+  opt->column_first= NULL;
+  opt->dist= NULL;
+  opt->contrib= NULL;
+  opt->num_columns= 0;
+  opt->valid= 0;
+}
+
+// -----[ igp_opt_destroy ]------------------------------------------
+void igp_opt_destroy(igp_opt_t ** opt_ref)
+{
+  igp_opt_t * opt= *opt_ref;
+
+  if (opt == NULL)
+    return;
+  _opt_clear_state(opt);
+  FREE(opt->load);
+  if (opt->demands != NULL)
+    FREE(opt->demands);
+  FREE(opt->redges);
+  FREE(opt->rfirst);
+  FREE(opt->first);
+  FREE(opt->slots);
+  FREE(opt->edges);
+  FREE(opt->routers);
+  FREE(opt);
+  *opt_ref= NULL;
+}
+
+// -----[ igp_opt_add_demand ]---------------------------------------
+int igp_opt_add_demand(igp_opt_t * opt, net_node_t * src,
+		       net_node_t * dst, net_link_vload_t load)
+{
+  unsigned int source= _opt_index(opt, src);
+  unsigned int target= _opt_index(opt, dst);
+  _opt_demand_t * demand;
+
+  if ((source == opt->num_routers) || (target == opt->num_routers))
+    return EUNEXPECTED;
+  if ((source == target) || (load == 0))
+    return ESUCCESS;
+  if (opt->num_demands == opt->size_demands) {
+    opt->size_demands= (opt->size_demands == 0)?16:2*opt->size_demands;
+    opt->demands= (_opt_demand_t *)
+      REALLOC(opt->demands, sizeof(_opt_demand_t) * opt->size_demands);
+  }
+  demand= &opt->demands[opt->num_demands++];
+  demand->dst= target;
+  demand->src= source;
+  demand->volume= (double) load;
+  _opt_clear_state(opt);
+  return ESUCCESS;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ROUTING AND LOAD
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _opt_weight ]----------------------------------------------
+/** Weight of an edge, with the weight of one interface overridden. */
+static inline igp_weight_t _opt_weight(igp_opt_t * opt, _opt_edge_t * edge,
+				       unsigned int slot, igp_weight_t weight)
+{
+  return (edge->slot == slot)?weight:opt->slots[edge->slot].weight;
+}
+
+// -----[ _opt_column ]----------------------------------------------
+/**
+ * Compute the distances towards a destination (Dijkstra on the
+ * incoming edges) and route its traffic on the shortest path DAG,
+ * from the farthest sources to the destination.
+ */
+static void _opt_column(igp_opt_t * opt, unsigned int column,
+			unsigned int slot, igp_weight_t weight,
+			_opt_ws_t * ws, igp_weight_t * dist, double * contrib)
+{
+  unsigned int dst= opt->columns[column];
+  unsigned int index, index2, num_order= 0, num_next_hops, source;
+  igp_heap_item_t item;
+  _opt_edge_t * edge;
+  igp_weight_t cost;
+  double share;
+
+  for (index= 0; index < opt->num_routers; index++)
+    dist[index]= IGP_MAX_WEIGHT;
+  dist[dst]= 0;
+  ws->heap.size= 0;
+  igp_heap_push(&ws->heap, 0, dst);
+  while (ws->heap.size > 0) {
+    item= igp_heap_pop(&ws->heap);
+    if (item.key != dist[item.vertex])
+      continue;
+    ws->order[num_order++]= item.vertex;
+    for (index= opt->rfirst[item.vertex];
+	 index < opt->rfirst[item.vertex + 1]; index++) {
+      edge= &opt->edges[opt->redges[index]];
+      cost= net_igp_add_weights(_opt_weight(opt, edge, slot, weight),
+				item.key);
+      if (cost < dist[edge->source]) {
+	dist[edge->source]= cost;
+	igp_heap_push(&ws->heap, cost, edge->source);
+      }
+    }
+  }
+
+  memset(contrib, 0, sizeof(double) * opt->num_edges);
+  memset(ws->flow, 0, sizeof(double) * opt->num_routers);
+  for (index= opt->column_first[column];
+       index < opt->column_first[column + 1]; index++)
+    ws->flow[opt->demands[index].src]+= opt->demands[index].volume;
+  for (index= num_order; index > 1; index--) {
+    source= ws->order[index - 1];
+    if (ws->flow[source] == 0)
+      continue;
+    num_next_hops= 0;
+    for (index2= opt->first[source]; index2 < opt->first[source + 1];
+	 index2++) {
+      edge= &opt->edges[index2];
+      if (net_igp_add_weights(_opt_weight(opt, edge, slot, weight),
+			      dist[edge->target]) == dist[source])
+	num_next_hops++;
+    }
+    share= ws->flow[source] / num_next_hops;
+    for (index2= opt->first[source]; index2 < opt->first[source + 1];
+	 index2++) {
+      edge= &opt->edges[index2];
+      if (net_igp_add_weights(_opt_weight(opt, edge, slot, weight),
+			      dist[edge->target]) == dist[source]) {
+	contrib[index2]= share;
+	ws->flow[edge->target]+= share;
+      }
+    }
+  }
+}
+
+// -----[ _opt_ws_create ]-------------------------------------------
+static _opt_ws_t * _opt_ws_create(igp_opt_t * opt)
+{
+  _opt_ws_t * ws= (_opt_ws_t *) MALLOC(sizeof(_opt_ws_t));
+
+  ws->dist= (igp_weight_t *)
+    MALLOC(sizeof(igp_weight_t) * (opt->num_routers + 1));
+  ws->contrib= (double *) MALLOC(sizeof(double) * (opt->num_edges + 1));
+  ws->load= (double *) MALLOC(sizeof(double) * (opt->num_slots + 1));
+  ws->flow= (double *) MALLOC(sizeof(double) * (opt->num_routers + 1));
+  ws->order= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (opt->num_routers + 1));
+  ws->heap.items= (igp_heap_item_t *)
+    MALLOC(sizeof(igp_heap_item_t) * (opt->num_edges + opt->num_routers + 1));
+  ws->heap.size= 0;
+  return ws;
+}
+
+// -----[ _opt_ws_destroy ]------------------------------------------
+static void _opt_ws_destroy(_opt_ws_t ** ws_ref)
+{
+  _opt_ws_t * ws= *ws_ref;
+  FREE(ws->heap.items);
+  FREE(ws->order);
+  FREE(ws->flow);
+  FREE(ws->load);
+  FREE(ws->contrib);
+  FREE(ws->dist);
+  FREE(ws);
+  *ws_ref= NULL;
+}
+
+// -----[ _opt_demand_cmp ]------------------------------------------
+static int _opt_demand_cmp(const void * item1, const void * item2)
+{
+  const _opt_demand_t * demand1= (const _opt_demand_t *) item1;
+  const _opt_demand_t * demand2= (const _opt_demand_t *) item2;
+
+  if (demand1->dst != demand2->dst)
+    return (demand1->dst < demand2->dst)?-1:1;
+  if (demand1->src != demand2->src)
+    return (demand1->src < demand2->src)?-1:1;
+  return 0;
+}
+
+// -----[ _opt_prepare_demands ]-------------------------------------
+/**
+ * Sort the demands by destination, merge the demands of a same
+ * (source, destination) pair and build one column per destination.
+ */
+static void _opt_prepare_demands(igp_opt_t * opt)
+{
+  unsigned int index, num_demands= 0;
+
+  qsort(opt->demands, opt->num_demands, sizeof(_opt_demand_t),
+	_opt_demand_cmp);
+  for (index= 0; index < opt->num_demands; index++) {
+    if ((num_demands > 0) &&
+	(_opt_demand_cmp(&opt->demands[num_demands - 1],
+			 &opt->demands[index]) == 0)) {
+      opt->demands[num_demands - 1].volume+= opt->demands[index].volume;
+      continue;
+    }
+    opt->demands[num_demands++]= opt->demands[index];
+  }
+  opt->num_demands= num_demands;
+
+  opt->columns= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (opt->num_demands + 1));
+  opt->column_first= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (opt->num_demands + 1));
+  for (index= 0; index < opt->num_demands; index++) {
+    if ((opt->num_columns > 0) &&
+	(opt->columns[opt->num_columns - 1] == opt->demands[index].dst))
+      continue;
+    opt->columns[opt->num_columns]= opt->demands[index].dst;
+    opt->column_first[opt->num_columns++]= index;
+  }
+  opt->column_first[opt->num_columns]= opt->num_demands;
+}
+
+// -----[ _opt_prepare ]---------------------------------------------
+/** Compute the routing state of the destinations that receive traffic. */
+static void _opt_prepare(igp_opt_t * opt)
+{
+  unsigned int index, column;
+  _opt_ws_t * ws;
+
+  if (opt->valid)
+    return;
+  _opt_prepare_demands(opt);
+  opt->dist= (igp_weight_t *)
+    MALLOC(sizeof(igp_weight_t) * (opt->num_columns * opt->num_routers + 1));
+  opt->contrib= (double *)
+    MALLOC(sizeof(double) * (opt->num_columns * opt->num_edges + 1));
+  memset(opt->load, 0, sizeof(double) * opt->num_slots);
+
+  ws= _opt_ws_create(opt);
+  for (column= 0; column < opt->num_columns; column++) {
+    _opt_column(opt, column, opt->num_slots, 0, ws,
+		&opt->dist[column * opt->num_routers],
+		&opt->contrib[column * opt->num_edges]);
+    for (index= 0; index < opt->num_edges; index++)
+      opt->load[opt->edges[index].slot]+=
+	opt->contrib[column * opt->num_edges + index];
+  }
+  _opt_ws_destroy(&ws);
+  opt->valid= 1;
+}
+
+// -----[ _opt_is_affected ]-----------------------------------------
+/**
+ * Tell if the shortest path DAG towards a destination may change
+ * when the weight of an interface changes: the interface carries a
+ * shortest path (increase) or leads to a path that is not longer
+ * (decrease).
+ */
+static inline int _opt_is_affected(igp_opt_t * opt, unsigned int column,
+				   unsigned int slot, igp_weight_t weight)
+{
+  igp_weight_t * dist= &opt->dist[column * opt->num_routers];
+  igp_weight_t old_weight= opt->slots[slot].weight;
+  unsigned int index;
+  _opt_edge_t * edge;
+
+  for (index= opt->slots[slot].first_edge;
+       index < opt->slots[slot].first_edge + opt->slots[slot].num_edges;
+       index++) {
+    edge= &opt->edges[index];
+    if (dist[edge->target] == IGP_MAX_WEIGHT)
+      continue;
+    if (weight > old_weight) {
+      if (net_igp_add_weights(old_weight, dist[edge->target]) ==
+	  dist[edge->source])
+	return 1;
+    } else if (net_igp_add_weights(weight, dist[edge->target]) <=
+	       dist[edge->source])
+      return 1;
+  }
+  return 0;
+}
+
+// -----[ _opt_eval_load ]-------------------------------------------
+static inline void _opt_eval_load(igp_opt_t * opt, double * load,
+				  double * max_util, double * total)
+{
+  unsigned int index;
+  double util;
+
+  *max_util= 0;
+  *total= 0;
+  for (index= 0; index < opt->num_slots; index++) {
+    *total+= load[index];
+    if (opt->slots[index].capacity == 0)
+      continue;
+    util= load[index] / opt->slots[index].capacity;
+    if (util > *max_util)
+      *max_util= util;
+  }
+}
+
+// -----[ _opt_eval_candidate ]--------------------------------------
+/** Evaluate a candidate change against the routing state. */
+static void _opt_eval_candidate(igp_opt_t * opt, _opt_candidate_t * cand,
+				_opt_ws_t * ws)
+{
+  unsigned int column, index;
+  double * contrib;
+
+  if (cand->weight == opt->slots[cand->slot].weight) {
+    cand->max_util= DBL_MAX;
+    cand->total= DBL_MAX;
+    return;
+  }
+  memcpy(ws->load, opt->load, sizeof(double) * opt->num_slots);
+  for (column= 0; column < opt->num_columns; column++) {
+    if (!_opt_is_affected(opt, column, cand->slot, cand->weight))
+      continue;
+    _opt_column(opt, column, cand->slot, cand->weight, ws,
+		ws->dist, ws->contrib);
+    contrib= &opt->contrib[column * opt->num_edges];
+    for (index= 0; index < opt->num_edges; index++)
+      ws->load[opt->edges[index].slot]+= ws->contrib[index] - contrib[index];
+  }
+  _opt_eval_load(opt, ws->load, &cand->max_util, &cand->total);
+}
+
+// -----[ _opt_apply_candidate ]-------------------------------------
+/** Apply a change to the routing state (affected destinations only). */
+static void _opt_apply_candidate(igp_opt_t * opt, _opt_candidate_t * cand,
+				 _opt_ws_t * ws)
+{
+  unsigned int * affected= (unsigned int *)
+    MALLOC(sizeof(unsigned int) * (opt->num_columns + 1));
+  unsigned int column, index, index2, num_affected= 0;
+  double * contrib;
+
+  for (column= 0; column < opt->num_columns; column++)
+    if (_opt_is_affected(opt, column, cand->slot, cand->weight))
+      affected[num_affected++]= column;
+  opt->slots[cand->slot].weight= cand->weight;
+  for (index= 0; index < num_affected; index++) {
+    column= affected[index];
+    contrib= &opt->contrib[column * opt->num_edges];
+    _opt_column(opt, column, opt->num_slots, 0, ws,
+		&opt->dist[column * opt->num_routers], ws->contrib);
+    for (index2= 0; index2 < opt->num_edges; index2++) {
+      opt->load[opt->edges[index2].slot]+=
+	ws->contrib[index2] - contrib[index2];
+      contrib[index2]= ws->contrib[index2];
+    }
+  }
+  FREE(affected);
+}
+
+// -----[ igp_opt_objective ]----------------------------------------
+double igp_opt_objective(igp_opt_t * opt, igp_opt_objective_t objective)
+{
+  double max_util, total;
+
+  _opt_prepare(opt);
+  _opt_eval_load(opt, opt->load, &max_util, &total);
+  return max_util;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LOCAL SEARCH
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _opt_run ]-------------------------------------------------
+/** Evaluate candidates until none is left. */
+static void _opt_run(void * arg)
+{
+  _opt_search_ctx_t * ctx= (_opt_search_ctx_t *) arg;
+  _opt_ws_t * ws= _opt_ws_create(ctx->opt);
+  unsigned int index;
+
+  while ((index= THREAD_ADD(ctx->next_candidate, 1) - 1) <
+	 ctx->num_candidates)
+    _opt_eval_candidate(ctx->opt, &ctx->candidates[index], ws);
+  _opt_ws_destroy(&ws);
+}
+
+// -----[ _opt_is_better ]-------------------------------------------
+/** Compare on the objective, then on the total load. */
+static inline int _opt_is_better(double max_util, double total,
+				 double best_util, double best_total)
+{
+  if (max_util < best_util - _OPT_EPSILON)
+    return 1;
+  return ((max_util <= best_util + _OPT_EPSILON) &&
+	  (total < best_total - _OPT_EPSILON));
+}
+
+// -----[ _opt_trace ]-----------------------------------------------
+static void _opt_trace(gds_stream_t * stream, unsigned int iteration,
+		       net_iface_t * iface, igp_weight_t old_weight,
+		       igp_weight_t new_weight, double max_util)
+{
+  if (stream == NULL)
+    return;
+  stream_printf(stream, "%u\t", iteration);
+  if (iface != NULL) {
+    node_dump_id(stream, iface->owner);
+    stream_printf(stream, "\t");
+    net_iface_dump_id(stream, iface);
+    stream_printf(stream, "\t%u\t%u", old_weight, new_weight);
+  } else
+    stream_printf(stream, "-\t-\t-\t-");
+  stream_printf(stream, "\tmax-util:%.6f\n", max_util);
+}
+
+// -----[ igp_opt_search ]-------------------------------------------
+int igp_opt_search(igp_opt_t * opt, const igp_opt_params_t * params,
+		   gds_stream_t * trace)
+{
+  _opt_search_ctx_t ctx= { .opt= opt };
+  _opt_candidate_t * best;
+  igp_weight_t old_weight;
+  unsigned int iteration, index, num_candidates;
+  double max_util, total;
+  _opt_ws_t * ws;
+  rng_t rng;
+
+  if ((params->objective >= IGP_OPT_OBJECTIVE_MAX) ||
+      (params->max_weight < 1) || (params->max_weight == IGP_MAX_WEIGHT) ||
+      (params->num_threads < 1))
+    return EUNEXPECTED;
+
+  // Bound the candidates (the product can overflow)
+  num_candidates= params->num_candidates;
+  if ((num_candidates == 0) &&
+      (opt->num_slots <= IGP_OPT_MAX_CANDIDATES / params->max_weight))
+    num_candidates= opt->num_slots * params->max_weight;
+  if ((opt->num_slots > 0) &&
+      ((num_candidates == 0) || (num_candidates > IGP_OPT_MAX_CANDIDATES)))
+    return EUNSUPPORTED;
+
+  _opt_prepare(opt);
+  _opt_eval_load(opt, opt->load, &max_util, &total);
+  _opt_trace(trace, 0, NULL, 0, 0, max_util);
+  if (opt->num_slots == 0)
+    return ESUCCESS;
+  ctx.candidates= (_opt_candidate_t *)
+    MALLOC(sizeof(_opt_candidate_t) * num_candidates);
+  ws= _opt_ws_create(opt);
+  rng_init(&rng, params->seed, "igp-opt");
+
+  for (iteration= 1; iteration <= params->max_iterations; iteration++) {
+    // Candidates: all the (interface, weight) pairs or a sample
+    for (index= 0; index < num_candidates; index++) {
+      if (params->num_candidates == 0) {
+	ctx.candidates[index].slot= index / params->max_weight;
+	ctx.candidates[index].weight= 1 + (index % params->max_weight);
+      } else {
+	ctx.candidates[index].slot= rng_range(&rng, opt->num_slots);
+	ctx.candidates[index].weight= 1 + rng_range(&rng, params->max_weight);
+      }
+    }
+    ctx.num_candidates= num_candidates;
+    ctx.next_candidate= 0;
+    igp_graph_run_workers(_opt_run, &ctx,
+			  (params->num_threads < num_candidates)?
+			  params->num_threads:num_candidates);
+
+    // The best candidate is chosen in a deterministic order
+    best= NULL;
+    for (index= 0; index < num_candidates; index++)
+      if (_opt_is_better(ctx.candidates[index].max_util,
+			 ctx.candidates[index].total,
+			 (best == NULL)?max_util:best->max_util,
+			 (best == NULL)?total:best->total))
+	best= &ctx.candidates[index];
+    if (best == NULL)
+      break;
+
+    old_weight= opt->slots[best->slot].weight;
+    _opt_apply_candidate(opt, best, ws);
+    _opt_eval_load(opt, opt->load, &max_util, &total);
+    _opt_trace(trace, iteration, opt->slots[best->slot].iface, old_weight,
+	       best->weight, max_util);
+  }
+
+  _opt_ws_destroy(&ws);
+  FREE(ctx.candidates);
+  return ESUCCESS;
+}
+
+// -----[ igp_opt_dump_weights ]-------------------------------------
+void igp_opt_dump_weights(gds_stream_t * stream, igp_opt_t * opt)
+{
+  unsigned int index;
+  _opt_slot_t * slot;
+
+  for (index= 0; index < opt->num_slots; index++) {
+    slot= &opt->slots[index];
+    if (slot->weight == net_iface_get_metric(slot->iface, 0))
+      continue;
+    node_dump_id(stream, slot->iface->owner);
+    stream_printf(stream, "\t");
+    net_iface_dump_id(stream, slot->iface);
+    stream_printf(stream, "\t%u\n", slot->weight);
+  }
+}
+
+// -----[ igp_opt_apply ]--------------------------------------------
+int igp_opt_apply(igp_opt_t * opt)
+{
+  unsigned int index;
+  _opt_slot_t * slot;
+  int result;
+
+  for (index= 0; index < opt->num_slots; index++) {
+    slot= &opt->slots[index];
+    if (slot->weight == net_iface_get_metric(slot->iface, 0))
+      continue;
+    result= net_iface_set_metric(slot->iface, 0, slot->weight, UNIDIR);
+    if (result != ESUCCESS)
+      return result;
+  }
+  return ESUCCESS;
+}
@@ -0,0 +1,116 @@
+// ==================================================================
+// @(#)igp_opt.h
+//
+// Local search of IGP weights (traffic engineering).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a local search of the IGP weights of a domain that
+ * minimizes the maximum link utilization for a traffic matrix.
+ *
+ * The search works on a snapshot of the router-level graph of the
+ * domain. The traffic of each destination is routed on its shortest
+ * path DAG and split evenly among equal-cost next-hops. The
+ * distances and the link loads are kept per destination, so that a
+ * candidate weight change only recomputes the destinations whose
+ * DAG may change, and only the flows towards these destinations.
+ *
+ * At each iteration, the candidate changes (one interface, one new
+ * weight) are evaluated in parallel and the best one is applied if
+ * it improves the objective. The search stops when no candidate
+ * improves the objective or when the number of iterations is
+ * reached. The weights of the domain are only modified by
+ * igp_opt_apply.
+ */
+
+#ifndef __NET_IGP_OPT_H__
+#define __NET_IGP_OPT_H__
+
+#include <libgds/stream.h>
+
+#include <net/net_types.h>
+
+typedef struct igp_opt_t igp_opt_t;
+
+/** Maximum number of candidates evaluated at each iteration. */
+#define IGP_OPT_MAX_CANDIDATES (1 << 20)
+
+// -----[ igp_opt_objective_t ]--------------------------------------
+typedef enum {
+  /** Maximum utilization of the interfaces that have a capacity. */
+  IGP_OPT_MAX_UTIL,
+  IGP_OPT_OBJECTIVE_MAX
+} igp_opt_objective_t;
+
+// -----[ igp_opt_params_t ]-----------------------------------------
+typedef struct {
+  igp_opt_objective_t objective;
+  /** Maximum number of iterations. */
+  unsigned int        max_iterations;
+  /** Candidate weights are in [1, max_weight]. */
+  igp_weight_t        max_weight;
+  /**
+   * Number of candidates sampled at each iteration (0 means that
+   * all the candidates are evaluated). There can not be more than
+   * IGP_OPT_MAX_CANDIDATES candidates.
+   */
+  unsigned int        num_candidates;
+  /** Seed of the candidate sampling. */
+  uint64_t            seed;
+  unsigned int        num_threads;
+} igp_opt_params_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ igp_opt_create ]-----------------------------------------
+  /** Take a snapshot of a domain and of its current weights. */
+  igp_opt_t * igp_opt_create(igp_domain_t * domain);
+  // -----[ igp_opt_destroy ]----------------------------------------
+  void igp_opt_destroy(igp_opt_t ** opt_ref);
+  // -----[ igp_opt_add_demand ]-------------------------------------
+  /**
+   * Add traffic from a router to another one. Both routers must be
+   * in the domain.
+   *
+   * \retval ESUCCESS, or EUNEXPECTED if a router is not in the
+   *         domain.
+   */
+  int igp_opt_add_demand(igp_opt_t * opt, net_node_t * src,
+			 net_node_t * dst, net_link_vload_t load);
+  // -----[ igp_opt_objective ]--------------------------------------
+  /** Value of the objective for the current weights. */
+  double igp_opt_objective(igp_opt_t * opt, igp_opt_objective_t objective);
+  // -----[ igp_opt_search ]-----------------------------------------
+  /**
+   * Run the local search. Each applied change is written in the
+   * trace (if not NULL), with the objective after the change.
+   *
+   * \retval ESUCCESS, EUNEXPECTED if the parameters are invalid, or
+   *         EUNSUPPORTED if there are more than IGP_OPT_MAX_CANDIDATES
+   *         candidates (all the candidates of a large domain can not
+   *         be evaluated, they must be sampled).
+   */
+  int igp_opt_search(igp_opt_t * opt, const igp_opt_params_t * params,
+		     gds_stream_t * trace);
+  // -----[ igp_opt_dump_weights ]-----------------------------------
+  /**
+   * Write the weights that differ from those of the domain, one
+   * "node iface weight" line per interface.
+   */
+  void igp_opt_dump_weights(gds_stream_t * stream, igp_opt_t * opt);
+  // -----[ igp_opt_apply ]------------------------------------------
+  /** Set the weights found by the search on the interfaces. */
+  int igp_opt_apply(igp_opt_t * opt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_IGP_OPT_H__ */
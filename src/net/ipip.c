@@ -274,5 +274,6 @@ const net_protocol_def_t PROTOCOL_IPIP= {
     .dump_msg    = _ipip_proto_dump_msg,
     .destroy_msg = NULL,
     .copy_payload= _ipip_proto_copy_payload,
+    .shard_key   = NULL,
   }
 };
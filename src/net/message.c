@@ -16,6 +16,9 @@
 #include <net/icmp_options.h>
 #include <net/message.h>
 #include <net/protocol.h>
+#include <util/slab.h>
+
+SLAB_CACHE(_msg_cache, "net-msg", net_msg_t, MEM_ACCT_MSGS);
 
 //#define NET_MSG_DEBUG
 
@@ -32,7 +35,7 @@ net_msg_t * message_create(net_addr_t src_addr, net_addr_t dst_addr,
 			   net_protocol_id_t proto, uint8_t ttl,
 			   void * payload, FPayLoadDestroy destroy)
 {
-  net_msg_t * msg= (net_msg_t *) MALLOC(sizeof(net_msg_t));
+  net_msg_t * msg= (net_msg_t *) slab_alloc(&_msg_cache);
   msg->src_addr= src_addr;
   msg->dst_addr= dst_addr;
   msg->protocol= proto;
@@ -57,7 +60,7 @@ void message_destroy(net_msg_t ** msg_ref)
       msg->ops.destroy(&msg->payload);
     if (msg->opts != NULL)
       ip_options_destroy(&msg->opts);
-    FREE(msg);
+    slab_free(&_msg_cache, msg);
     *msg_ref= NULL;
   }
   __debug("message_destroy::END");
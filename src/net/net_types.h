@@ -41,10 +41,14 @@ typedef uint32_t net_link_delay_t;
 typedef uint32_t net_link_load_t;
 #define NET_LINK_MAX_CAPACITY UINT32_MAX
 #define NET_LINK_MAX_LOAD UINT32_MAX
+/** Counter of a load vector (one per traffic scenario or class). */
+typedef uint64_t net_link_vload_t;
+#define NET_LINK_MAX_VLOAD UINT64_MAX
 
 
 // -----[ Forward declarations ]-------------------------------------
 struct spt_t;
+struct igp_matrix_t;
 
 // -----[ coord_t ]--------------------------------------------------
 /** Definition of geographical coordinates. */
@@ -118,6 +122,7 @@ typedef struct {
   void   (*dump_msg)    (gds_stream_t * stream, net_msg_t * msg);
   void   (*destroy_msg) (net_msg_t * msg);
   void * (*copy_payload)(net_msg_t * msg);
+  int    (*shard_key)   (net_msg_t * msg, uint32_t * key);
 } net_protocol_ops_t;
 
 
@@ -191,6 +196,8 @@ typedef struct {
   gds_trie_t        * routers;
   /** IGP domain type. */
   igp_domain_type_t   type;
+  /** Cached distance matrix (see net/igp_matrix.h). */
+  struct igp_matrix_t * matrix;
 } igp_domain_t;
 
 
@@ -400,9 +407,11 @@ typedef struct {
 /** Definition of the physical characteristics of a network
  * interface. */
 typedef struct {
-  net_link_delay_t delay;    /** Propagation delay */
-  net_link_load_t  capacity; /** Link capacity */
-  net_link_load_t  load;     /** Link load */
+  net_link_delay_t   delay;     /** Propagation delay */
+  net_link_load_t    capacity;  /** Link capacity */
+  net_link_load_t    load;      /** Link load */
+  net_link_vload_t * loads;     /** Load vector (one counter per scenario) */
+  unsigned int       num_loads; /** Size of the load vector */
 } net_iface_phys_t;
 
 // -----[ net_iface_t ]----------------------------------------------
@@ -459,11 +468,8 @@ typedef struct net_iface_t {
   void             * user_data;
   /** "Virtual" methods. */
   net_iface_ops_t    ops;        
-
-#ifdef OSPF_SUPPORT
-  /** Attached OSPF area. */
+  /** Attached OSPF area (0 is the backbone, see net/igp_area.h). */
   ospf_area_t        area;
-#endif
 } net_iface_t;
 
 
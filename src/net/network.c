@@ -32,13 +32,29 @@
 #include <net/node.h>
 #include <net/ospf.h>
 #include <net/ospf_rt.h>
+#include <net/protocol.h>
 #include <net/subnet.h>
 #include <bgp/message.h>
+#include <sim/tracer.h>
 #include <ui/output.h>
+#include <util/slab.h>
 #include <util/str_format.h>
+#include <util/thread.h>
 
 static network_t  * _default_network= NULL;
-static simulator_t * _thread_sim= NULL;
+static THREAD_LOCAL simulator_t * _thread_sim= NULL;
+static THREAD_LOCAL simulator_t * _thread_shard_sim= NULL;
+unsigned long _network_epoch= 1;
+unsigned long _network_topo_epoch= 1;
+
+// ---| Number of messages delivered per protocol |---
+static unsigned long _network_num_msgs[NET_PROTOCOL_MAX];
+
+// ---| Locks serializing message delivery in parallel mode |---
+#define NETWORK_NODE_LOCKS 256
+static thread_mutex_t _node_locks[NETWORK_NODE_LOCKS];
+
+SLAB_CACHE(_send_ctx_cache, "net-send-ctx", net_send_ctx_t, MEM_ACCT_MSGS);
 
 //#define NETWORK_DEBUG
 
@@ -107,8 +123,7 @@ static inline void ___network_debug(const char * msg, ...)
 
 // -----[ _thread_set_simulator ]------------------------------------
 /**
- * Set the current thread's simulator context. This function
- * currently supports a single thread.
+ * Set the current thread's simulator context.
  */
 static inline void _thread_set_simulator(simulator_t * sim)
 {
@@ -121,10 +136,20 @@ void thread_set_simulator(simulator_t * sim)
   _thread_set_simulator(sim);
 }
 
+// -----[ thread_set_shard_simulator ]-------------------------------
+/**
+ * Set the simulator of the shard processed by the current thread
+ * (see sim/shard.h). While it is set, it replaces the simulator of
+ * the network. Use NULL to reset.
+ */
+void thread_set_shard_simulator(simulator_t * sim)
+{
+  _thread_shard_sim= sim;
+}
+
 // -----[ _thread_get_simulator ]------------------------------------
 /**
- * Return the current thread's simulator context. This function
- * currently supports a single thread.
+ * Return the current thread's simulator context.
  */
 static inline simulator_t * _thread_get_simulator()
 {
@@ -132,29 +157,51 @@ static inline simulator_t * _thread_get_simulator()
   return _thread_sim;
 }
 
+// -----[ _network_node_lock ]---------------------------------------
+/**
+ * Return the lock that protects the state of a node in parallel
+ * mode. Nodes are spread over a fixed set of locks.
+ */
+static inline thread_mutex_t * _network_node_lock(net_node_t * node)
+{
+  net_addr_t addr= node->rid;
+  return &_node_locks[(addr ^ (addr >> 16)) % NETWORK_NODE_LOCKS];
+}
+
 // -----[ _network_send_callback ]-------------------------------------
 /**
  * This function is used to receive messages "from the wire". The
  * function handles an event from the simulator. When such an event is
  * received, the event's message is delivered to the event's network
  * interface.
+ *
+ * In parallel mode, the delivery is serialized with other deliveries
+ * to the same node. Handling a message only changes the state of the
+ * destination node and posts new events, so a single lock is held at
+ * a time.
  */
 static int _network_send_callback(simulator_t * sim,
 				  void * ctx)
 {
   net_send_ctx_t * send_ctx= (net_send_ctx_t *) ctx;
+  thread_mutex_t * lock;
   net_error_t error;
 
   // Deliver message to the destination interface
   _thread_set_simulator(sim);
   assert(send_ctx->dst_iface != NULL);
+  if (send_ctx->msg->protocol < NET_PROTOCOL_MAX)
+    THREAD_ADD(_network_num_msgs[send_ctx->msg->protocol], 1);
+  lock= _network_node_lock(send_ctx->dst_iface->owner);
+  thread_mutex_lock(lock);
   error= net_iface_recv(send_ctx->dst_iface, send_ctx->msg);
+  thread_mutex_unlock(lock);
   _thread_set_simulator(NULL);
 
   // Free the message context. The message MUST be freed by
   // node_recv_msg() if the message has been delivered or in case
   // the message cannot be forwarded.
-  FREE(ctx);
+  slab_free(&_send_ctx_cache, ctx);
 
   return error/*(error == ESUCCESS)?0:-1*/;
 }
@@ -185,7 +232,7 @@ static inline net_send_ctx_t *
 _network_send_ctx_create(net_iface_t * dst_iface, net_msg_t * msg)
 {
   net_send_ctx_t * send_ctx=
-    (net_send_ctx_t *) MALLOC(sizeof(net_send_ctx_t));
+    (net_send_ctx_t *) slab_alloc(&_send_ctx_cache);
   
   send_ctx->dst_iface= dst_iface;
   send_ctx->msg= msg;
@@ -201,13 +248,46 @@ static void _network_send_ctx_destroy(void * ctx)
 {
   net_send_ctx_t * send_ctx= (net_send_ctx_t *) ctx;
   message_destroy(&send_ctx->msg);
-  FREE(send_ctx);
+  slab_free(&_send_ctx_cache, send_ctx);
+}
+
+// -----[ _network_send_ctx_shard ]----------------------------------
+/**
+ * Return the shard key of a message event. This is delegated to the
+ * message's protocol.
+ */
+static int _network_send_ctx_shard(void * ctx, uint32_t * key)
+{
+  net_send_ctx_t * send_ctx= (net_send_ctx_t *) ctx;
+  const net_protocol_def_t * proto_def=
+    PROTOCOL_DEFS[send_ctx->msg->protocol];
+
+  if (proto_def->ops.shard_key == NULL)
+    return -1;
+  return proto_def->ops.shard_key(send_ctx->msg, key);
+}
+
+// -----[ _network_send_ctx_trace ]----------------------------------
+/**
+ * Tell the tracer which node receives the message and with which
+ * protocol (see sim/tracer.h).
+ */
+static void _network_send_ctx_trace(void * ctx, uint32_t * node,
+				    uint8_t * protocol)
+{
+  net_send_ctx_t * send_ctx= (net_send_ctx_t *) ctx;
+
+  *node= send_ctx->dst_iface->owner->rid;
+  *protocol= send_ctx->msg->protocol;
 }
 
 static sim_event_ops_t _network_send_ops= {
   .callback= _network_send_callback,
   .destroy = _network_send_ctx_destroy,
   .dump    = _network_send_ctx_dump,
+  .shard   = _network_send_ctx_shard,
+  .name    = "net-msg",
+  .trace   = _network_send_ctx_trace,
 };
 
 // -----[ network_drop ]----------------------------------------------
@@ -255,9 +335,52 @@ void network_send(net_iface_t * dst_iface, net_msg_t * msg)
 			 dst_iface->phys.delay, SIM_TIME_REL));
 }
 
+// -----[ network_get_num_msgs ]-------------------------------------
+/**
+ * Return the number of messages delivered "from the wire" for the
+ * given protocol (one per hop).
+ */
+unsigned long network_get_num_msgs(net_protocol_id_t protocol)
+{
+  if (protocol >= NET_PROTOCOL_MAX)
+    return 0;
+  return _network_num_msgs[protocol];
+}
+
+// -----[ network_reset_stats ]--------------------------------------
+void network_reset_stats()
+{
+  memset(_network_num_msgs, 0, sizeof(_network_num_msgs));
+}
+
+// -----[ network_show_stats ]---------------------------------------
+/**
+ * Show the counters of the simulator of the network (see
+ * sim_show_stats), followed by the number of messages delivered per
+ * protocol:
+ *   msgs/protocol:
+ *     <protocol>: <number of messages>
+ */
+void network_show_stats(gds_stream_t * stream, network_t * network)
+{
+  net_protocol_id_t protocol;
+
+  sim_show_stats(stream, network_get_simulator(network));
+  stream_printf(stream, "msgs/protocol:\n");
+  for (protocol= 0; protocol < NET_PROTOCOL_MAX; protocol++)
+    stream_printf(stream, "  %s: %lu\n", net_protocol2str(protocol),
+		  network_get_num_msgs(protocol));
+}
+
 // -----[ network_get_simulator ]------------------------------------
+/**
+ * Return the simulator of the network, or the simulator of the shard
+ * processed by the current thread.
+ */
 simulator_t * network_get_simulator(network_t * network)
 {
+  if (_thread_shard_sim != NULL)
+    return _thread_shard_sim;
   if (network->sim == NULL)
     network->sim= sim_create(sim_get_default_scheduler());
   return network->sim;
@@ -323,6 +446,7 @@ int node_del_tunnel(net_node_t * node, net_addr_t addr)
  */
 int node_ipip_enable(net_node_t * node)
 {
+  network_epoch_bump();
   return node_register_protocol(node, NET_PROTOCOL_IPIP, node);
 }
 
@@ -562,58 +686,16 @@ _node_ip_output(net_node_t * node, net_iface_t * iif,
   return ESUCCESS;
 }
 
-// -----[ node_recv_msg ]--------------------------------------------
+// -----[ _node_ip_forward ]-----------------------------------------
 /**
- * This function handles a message received at this node. If the node
- * is the destination, the message is delivered locally. Otherwize,
- * the function looks up if it has a route towards the destination
- * and, if so, the function forwards the message to the next-hop.
- *
- * Important: this function (or any of its delegates) is responsible
- * for freeing the message in case it is delivered or in case it can
- * not be forwarded.
- *
- * Note: the function also decreases the TTL of the message. If the
- * message is not delivered locally and if the TTL is 0, the message
- * is discarded.
+ * Forward a message that is not destined to this node (IP
+ * forwarding part of node_recv_msg).
  */
-net_error_t node_recv_msg(net_node_t * node,
-			  net_iface_t * iif,
-			  net_msg_t * msg)
+static inline net_error_t _node_ip_forward(net_node_t * node,
+					   net_iface_t * iif,
+					   const rt_entries_t * rtentries,
+					   net_msg_t * msg)
 {
-  const rt_entries_t * rtentries= NULL;
-  net_iface_t * lif;
-  net_error_t error;
-
-  ___network_debug("node_recv_msg node:%n msg:%m iif:%i\n", node, msg, iif);
-
-  // Incoming interface must be fixed
-  assert(iif != NULL);
-
-  // A node should never receive an IP datagram with a TTL of 0
-  assert(msg->ttl > 0);
-
-  // Process ICMP options
-  error= ip_opt_hook_msg_in(node, iif, msg, &rtentries);
-  if (error != ESUCCESS)
-    return error;
-
-  /********************
-   * Local delivery ? *
-   ********************/
-
-  // Check list of interface addresses to see if the packet
-  // is for this node.
-  if (rtentries == NULL) {
-    lif= node_has_address(node, msg->dst_addr);
-    if (lif != NULL)
-      return _node_ip_input(node, iif, lif, msg);
-  }
-
-  /**********************
-   * IP Forwarding part *
-   **********************/
-
   // Decrement TTL (if TTL is less than or equal to 1,
   // discard and raise ICMP time exceeded message)
   if (msg->ttl <= 1) {
@@ -666,6 +748,64 @@ net_error_t node_recv_msg(net_node_t * node,
   return _node_ip_output(node, iif, rtentries, msg);
 }
 
+// -----[ node_recv_msg ]--------------------------------------------
+/**
+ * This function handles a message received at this node. If the node
+ * is the destination, the message is delivered locally. Otherwize,
+ * the function looks up if it has a route towards the destination
+ * and, if so, the function forwards the message to the next-hop.
+ *
+ * Important: this function (or any of its delegates) is responsible
+ * for freeing the message in case it is delivered or in case it can
+ * not be forwarded.
+ *
+ * Note: the function also decreases the TTL of the message. If the
+ * message is not delivered locally and if the TTL is 0, the message
+ * is discarded.
+ */
+net_error_t node_recv_msg(net_node_t * node,
+			  net_iface_t * iif,
+			  net_msg_t * msg)
+{
+  const rt_entries_t * rtentries= NULL;
+  net_iface_t * lif;
+  net_error_t error;
+  uint64_t start;
+
+  ___network_debug("node_recv_msg node:%n msg:%m iif:%i\n", node, msg, iif);
+
+  // Incoming interface must be fixed
+  assert(iif != NULL);
+
+  // A node should never receive an IP datagram with a TTL of 0
+  assert(msg->ttl > 0);
+
+  // Process ICMP options
+  error= ip_opt_hook_msg_in(node, iif, msg, &rtentries);
+  if (error != ESUCCESS)
+    return error;
+
+  /********************
+   * Local delivery ? *
+   ********************/
+
+  // Check list of interface addresses to see if the packet
+  // is for this node.
+  if (rtentries == NULL) {
+    lif= node_has_address(node, msg->dst_addr);
+    if (lif != NULL)
+      return _node_ip_input(node, iif, lif, msg);
+  }
+
+  /**********************
+   * IP Forwarding part *
+   **********************/
+  start= sim_trace_scope_begin();
+  error= _node_ip_forward(node, iif, rtentries, msg);
+  sim_trace_scope_end(SIM_TRACE_FWD, start, node->rid);
+  return error;
+}
+
 // -----[ node_send ]------------------------------------------------
 net_error_t node_send(net_node_t * node, net_msg_t * msg,
 		      const rt_entries_t * rtentries,
@@ -841,6 +981,7 @@ net_error_t network_add_node(network_t * network, net_node_t * node)
   node->network= network;
   if (trie_insert(network->nodes, node->rid, 32, node, 0) != 0)
     return EUNEXPECTED;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -856,6 +997,7 @@ net_error_t network_add_subnet(network_t * network, net_subnet_t * subnet)
 
   if (subnets_add(network->subnets, subnet) < 0)
     return EUNEXPECTED;
+  network_topo_epoch_bump();
   return ESUCCESS;
 }
 
@@ -955,6 +1097,40 @@ int network_links_save(gds_stream_t * stream, network_t * network)
   return 0;
 }
 
+// -----[ network_links_save_vectors ]-------------------------------
+/**
+ * Save the load vectors of all links in the topology, as a matrix
+ * with one line per link and one column per scenario.
+ */
+int network_links_save_vectors(gds_stream_t * stream, network_t * network)
+{
+  gds_enum_t * nodes= trie_get_enum(network->nodes);
+  gds_enum_t * ifaces;
+  unsigned int num_loads= 0, num_iface_loads;
+  net_node_t * node;
+
+  // Number of scenarios (the longest load vector)
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    ifaces= net_links_get_enum(node->ifaces);
+    while (enum_has_next(ifaces)) {
+      net_iface_get_load_vector(*((net_iface_t **) enum_get_next(ifaces)),
+				&num_iface_loads);
+      if (num_iface_loads > num_loads)
+	num_loads= num_iface_loads;
+    }
+    enum_destroy(&ifaces);
+  }
+  enum_destroy(&nodes);
+
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    node_links_save_vectors(stream, node, num_loads);
+  }
+  enum_destroy(&nodes);
+  return 0;
+}
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -965,7 +1141,11 @@ int network_links_save(gds_stream_t * stream, network_t * network)
 // -----[ _network_init ]--------------------------------------------
 void _network_init()
 {
+  unsigned int index;
+
   _default_network= network_create();
+  for (index= 0; index < NETWORK_NODE_LOCKS; index++)
+    thread_mutex_init(&_node_locks[index]);
 }
 
 // -----[ _network_done ]--------------------------------------------
@@ -31,6 +31,51 @@
 #include <net/link.h>
 #include <net/routing.h>
 #include <sim/simulator.h>
+#include <util/thread.h>
+
+// -----[ _network_epoch ]------------------------------------------
+/**
+ * Network epoch. This counter is incremented each time the topology
+ * or a forwarding table changes (node/interface addition, interface
+ * state or metric change, route addition/removal). It allows
+ * results that only depend on the topology and on the forwarding
+ * tables (e.g. reachability checks) to be cached.
+ */
+extern unsigned long _network_epoch;
+// -----[ _network_topo_epoch ]--------------------------------------
+/**
+ * Topology epoch. This counter is only incremented when the topology
+ * changes (node, subnet or interface addition, interface connection,
+ * state or metric change). It allows results that do not depend on
+ * the forwarding tables (e.g. IGP distance matrices) to be cached.
+ */
+extern unsigned long _network_topo_epoch;
+
+// -----[ network_epoch_bump ]---------------------------------------
+static inline void network_epoch_bump()
+{
+  THREAD_ADD(_network_epoch, 1);
+}
+
+// -----[ network_topo_epoch_bump ]----------------------------------
+/** A topology change also changes the network epoch. */
+static inline void network_topo_epoch_bump()
+{
+  THREAD_ADD(_network_topo_epoch, 1);
+  network_epoch_bump();
+}
+
+// -----[ network_get_epoch ]----------------------------------------
+static inline unsigned long network_get_epoch()
+{
+  return _network_epoch;
+}
+
+// -----[ network_get_topo_epoch ]-----------------------------------
+static inline unsigned long network_get_topo_epoch()
+{
+  return _network_topo_epoch;
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +83,8 @@ extern "C" {
 
   // -----[ thread_set_simulator ]-----------------------------------
   void thread_set_simulator(simulator_t * sim);
+  // -----[ thread_set_shard_simulator ]-----------------------------
+  void thread_set_shard_simulator(simulator_t * sim);
 
   // -----[ network_drop ]-------------------------------------------
   void network_drop(net_msg_t * msg, net_error_t error,
@@ -45,6 +92,12 @@ extern "C" {
   // -----[ network_send ]-------------------------------------------
   void network_send(net_iface_t * dst_iface, net_msg_t * msg);
 
+  // -----[ network_get_num_msgs ]-----------------------------------
+  unsigned long network_get_num_msgs(net_protocol_id_t protocol);
+  // -----[ network_reset_stats ]------------------------------------
+  void network_reset_stats();
+  // -----[ network_show_stats ]-------------------------------------
+  void network_show_stats(gds_stream_t * stream, network_t * network);
   // -----[ network_get_simulator ]----------------------------------
   simulator_t * network_get_simulator(network_t * network);
   // ----- node_post_event ------------------------------------------
@@ -242,6 +295,9 @@ extern "C" {
   void network_ifaces_load_clear(network_t * network);
   // ----- network_links_save ---------------------------------------
   int network_links_save(gds_stream_t * stream, network_t * network);
+  // -----[ network_links_save_vectors ]-----------------------------
+  int network_links_save_vectors(gds_stream_t * stream,
+				 network_t * network);
 
     
 #ifdef __cplusplus
@@ -219,6 +219,8 @@ int node_add_iface2(net_node_t * node, net_iface_t * pIface)
   net_error_t error= net_links_add(node->ifaces, pIface);
   if (error != ESUCCESS)
     net_iface_destroy(&pIface);
+  else
+    network_topo_epoch_bump();
   return error;
 }
 
@@ -317,6 +319,7 @@ void node_ifaces_load_clear(net_node_t * node)
   while (enum_has_next(links)) {
     iface= *((net_iface_t **) enum_get_next(links));
     net_iface_set_load(iface, 0);
+    net_iface_clear_load_vector(iface);
   }
   enum_destroy(&links);
 }
@@ -418,6 +421,40 @@ void node_links_save(gds_stream_t * stream, net_node_t * node)
   enum_destroy(&ifaces);
 }
 
+// -----[ node_links_save_vectors ]----------------------------------
+/**
+ * Save the load vectors of the links of a node, one line per link
+ * and one column per scenario. The vectors are padded with zeros up
+ * to the given number of scenarios.
+ */
+void node_links_save_vectors(gds_stream_t * stream, net_node_t * node,
+			     unsigned int num_loads)
+{
+  gds_enum_t * ifaces= net_links_get_enum(node->ifaces);
+  const net_link_vload_t * loads;
+  unsigned int index, num_iface_loads;
+  net_iface_t * iface;
+
+  while (enum_has_next(ifaces)) {
+    iface= *((net_iface_t **) enum_get_next(ifaces));
+
+    // Skip tunnels
+    if ((iface->type == NET_IFACE_VIRTUAL) ||
+	(iface->type == NET_IFACE_LOOPBACK))
+      continue;
+
+    ip_address_dump(stream, node->rid);
+    stream_printf(stream, "\t");
+    net_iface_dump_id(stream, iface);
+    loads= net_iface_get_load_vector(iface, &num_iface_loads);
+    for (index= 0; index < num_loads; index++)
+      stream_printf(stream, "\t%llu", (index < num_iface_loads)?
+		    (unsigned long long) loads[index]:0ULL);
+    stream_printf(stream, "\n");
+  }
+  enum_destroy(&ifaces);
+}
+
 // -----[ node_has_address ]-----------------------------------------
 /**
  * This function checks if the node has the given address. The
@@ -787,6 +824,18 @@ int node_load_flow(net_node_t * node, net_addr_t src_addr,
   return 0;
 }
 
+// -----[ node_load_flow_vector ]------------------------------------
+int node_load_flow_vector(net_node_t * node, net_addr_t src_addr,
+			  net_addr_t dst_addr,
+			  const net_link_vload_t * loads,
+			  unsigned int num_loads,
+			  flow_stats_t * stats)
+{
+  ip_opt_t * opts= ip_options_create();
+  ip_options_load_vector(opts, loads, num_loads);
+  return node_load_flow(node, src_addr, dst_addr, 0, stats, NULL, opts);
+}
+
 typedef struct {
   net_node_t   * target_node;
   uint8_t        options;
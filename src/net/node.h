@@ -114,6 +114,9 @@ extern "C" {
   void node_links_dump(gds_stream_t * stream, net_node_t * node);
   // ----- node_links_save ------------------------------------------
   void node_links_save(gds_stream_t * stream, net_node_t * node);
+  // -----[ node_links_save_vectors ]--------------------------------
+  void node_links_save_vectors(gds_stream_t * stream, net_node_t * node,
+			       unsigned int num_loads);
 
   // -----[ node_has_address ]---------------------------------------
   net_iface_t * node_has_address(net_node_t * node, net_addr_t addr);
@@ -208,6 +211,19 @@ extern "C" {
 		     flow_stats_t * stats, ip_trace_t ** trace_ref,
 		     ip_opt_t * opts);
 
+  // -----[ node_load_flow_vector ]----------------------------------
+  /**
+   * Load a vector of flows (one volume per traffic scenario) from a
+   * node. The forwarding path is computed once and the whole vector
+   * is added to the load vector of each traversed interface (see
+   * net_iface_add_load_vector).
+   */
+  int node_load_flow_vector(net_node_t * node, net_addr_t src_addr,
+			    net_addr_t dst_addr,
+			    const net_link_vload_t * loads,
+			    unsigned int num_loads,
+			    flow_stats_t * stats);
+
   // -----[ node_load_netflow ]--------------------------------------
   int node_load_netflow(net_node_t * node, const char * file_name,
 			uint8_t options, flow_stats_t * stats);
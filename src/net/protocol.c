@@ -32,6 +32,7 @@ const net_protocol_def_t PROTOCOL_RAW= {
     .dump_msg    = NULL,
     .destroy_msg = NULL,
     .copy_payload= NULL,
+    .shard_key   = NULL,
   }
 };
 
@@ -58,6 +59,7 @@ const net_protocol_def_t PROTOCOL_DEBUG= {
     .dump_msg    = NULL,
     .destroy_msg = _debug_proto_destroy_msg,
     .copy_payload= NULL,
+    .shard_key   = NULL,
   }
 };
 
@@ -19,6 +19,7 @@
 #include <net/node.h>
 #include <net/routing.h>
 #include <ui/output.h>
+#include <util/mem_acct.h>
 #include <util/str_format.h>
 
 //#define ROUTING_DEBUG
@@ -83,6 +84,7 @@ rt_entry_t * rt_entry_create(net_iface_t * oif, net_addr_t gateway)
   entry->oif= oif;
   entry->gateway= gateway;
   entry->ref_cnt= 1;
+  mem_acct_charge(MEM_ACCT_FIB, sizeof(rt_entry_t));
   ___routing_debug("rt_entry_create %e\n", entry);
   return entry;
 }
@@ -97,6 +99,7 @@ void rt_entry_destroy(rt_entry_t ** entry_ref)
     if ((*entry_ref)->ref_cnt > 0)
       return;
     ___routing_debug("rt_entry_destroy %e\n", *entry_ref);
+    mem_acct_release(MEM_ACCT_FIB, sizeof(rt_entry_t));
     FREE(*entry_ref);
     *entry_ref= NULL;
   }
@@ -277,6 +280,7 @@ rt_info_t * rt_info_create(ip_pfx_t prefix,
   rtinfo->entries= rt_entries_create();
   rtinfo->metric= metric;
   rtinfo->type= type;
+  mem_acct_charge(MEM_ACCT_FIB, sizeof(rt_info_t));
   return rtinfo;
 }
 
@@ -288,6 +292,8 @@ int rt_info_add_entry(rt_info_t * rtinfo,
   int result= rt_entries_add(rtinfo->entries, entry);
   if (result < 0)
     rt_entry_destroy(&entry);
+  else
+    network_epoch_bump();
   return result;
 }
 
@@ -296,6 +302,7 @@ int rt_info_set_entries(rt_info_t * rtinfo, rt_entries_t * entries)
 {
   rt_entries_destroy(&rtinfo->entries);
   rtinfo->entries= entries;
+  network_epoch_bump();
   return ESUCCESS;
 }
 
@@ -304,6 +311,7 @@ void rt_info_destroy(rt_info_t ** rtinfo_ref)
 {
   if (*rtinfo_ref != NULL) {
     rt_entries_destroy(&(*rtinfo_ref)->entries);
+    mem_acct_release(MEM_ACCT_FIB, sizeof(rt_info_t));
     FREE(*rtinfo_ref);
     *rtinfo_ref= NULL;
   }
@@ -666,6 +674,7 @@ int rt_add_route(net_rt_t * rt, ip_pfx_t prefix,
 {
   rt_infos_t * list;
 
+  network_epoch_bump();
   list= (rt_infos_t *) trie_find_exact(rt,
 					   prefix.network,
 					   prefix.mask);
@@ -744,6 +753,8 @@ net_error_t rt_del_routes(net_rt_t * rt, rt_filter_t * filter)
   // Post-processing, remove empty rtinfo lists
   _net_info_removal(filter, rt);
 
+  network_epoch_bump();
+
   return error;
 }
 
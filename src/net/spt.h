@@ -18,6 +18,7 @@
 
 #include <net/net_types.h>
 #include <net/routing.h>
+#include <util/mem_acct.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +58,7 @@ static inline spt_vertex_t * spt_vertex_create(net_elem_t elem,
   vertex->id= net_elem_prefix(&elem);
   ip_prefix_mask(&vertex->id);
   vertex->rtentries= NULL;
+  mem_acct_charge(MEM_ACCT_SPT, sizeof(spt_vertex_t));
   return vertex;
 }
 
@@ -66,6 +68,7 @@ static inline void _spt_vertex_destroy(void ** item)
   spt_vertex_t * vertex= *((spt_vertex_t **) item);
   spt_vertices_destroy(&vertex->preds);
   spt_vertices_destroy(&vertex->succs);
+  mem_acct_release(MEM_ACCT_SPT, sizeof(spt_vertex_t));
   FREE(vertex);
 }
 
@@ -13,6 +13,9 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
+#include <stdlib.h>
+
 #include <libgds/str_util.h>
 
 #include <net/link.h>
@@ -77,6 +80,27 @@ int str2capacity(const char * str, net_link_load_t * capacity)
   return 0;
 }
 
+// -----[ str2vload ]-----------------------------------------------
+/**
+ * Convert a string to a volume. The volumes are stored on 64 bits
+ * whatever the size of a long.
+ */
+int str2vload(const char * str, net_link_vload_t * vload)
+{
+  unsigned long long tmp;
+  char * end;
+
+  if ((*str < '0') || (*str > '9'))
+    return -1;
+  errno= 0;
+  tmp= strtoull(str, &end, 10);
+  if ((*end != '\0') || (errno != 0) ||
+      (tmp > (net_link_vload_t) -1))
+    return -1;
+  *vload= (net_link_vload_t) tmp;
+  return 0;
+}
+
 // -----[ str2delay ]------------------------------------------------
 int str2delay(const char * str, net_link_delay_t * delay)
 {
@@ -30,6 +30,8 @@ extern"C" {
   int str2depth(const char * str, uint8_t * depth);
   // -----[ str2capacity ]-------------------------------------------
   int str2capacity(const char * str, net_link_load_t * capacity);
+  // -----[ str2vload ]---------------------------------------------
+  int str2vload(const char * str, net_link_vload_t * vload);
   // -----[ str2delay ]----------------------------------------------
   int str2delay(const char * str, net_link_delay_t * delay);
   // -----[ str2weight ]---------------------------------------------
@@ -23,41 +23,65 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <libgds/stream.h>
 #include <libgds/hash_utils.h>
+#include <libgds/radix-tree.h>
 #include <libgds/str_util.h>
+#include <libgds/trie.h>
 #include <libgds/utest.h>
 
 #include <api.h>
 #include <selfcheck.h>
 #include <bgp/as.h>
 #include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/graph.h>
+#include <bgp/aslevel/loader.h>
+#include <bgp/aslevel/solver.h>
 #include <bgp/attr/comm.h>
 #include <bgp/attr/comm_hash.h>
 #include <bgp/attr/ecomm.h>
 #include <bgp/attr/path.h>
 #include <bgp/attr/path_hash.h>
 #include <bgp/attr/path_segment.h>
+#include <bgp/domain.h>
 #include <bgp/filter/filter.h>
 #include <bgp/filter/parser.h>
 #include <bgp/filter/predicate_parser.h>
+#include <bgp/generator.h>
 #include <bgp/mrtd.h>
 #include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <bgp/reachability.h>
+#include <bgp/rib.h>
+#include <bgp/rib_cursor.h>
 #include <bgp/route.h>
+#include <bgp/route_stream.h>
 #include <bgp/route-input.h>
+#include <bgp/urib.h>
+#include <cli/plan.h>
 #include <net/error.h>
 #include <net/export.h>
+#include <net/export_bin.h>
 #include <net/ez_topo.h>
+#include <net/generator.h>
 #include <net/icmp.h>
 #include <net/igp_domain.h>
+#include <net/igp_matrix.h>
+#include <net/igp_opt.h>
 #include <net/iface.h>
 #include <net/igp.h>
 #include <net/link-list.h>
 #include <net/ipip.h>
 #include <net/node.h>
 #include <net/prefix.h>
+#include <net/protocol.h>
 #include <net/subnet.h>
+#include <sim/shard.h>
+#include <sim/tracer.h>
+#include <util/mem_acct.h>
+#include <util/slab.h>
 
 static inline net_node_t * __node_create(net_addr_t addr) {
   net_node_t * node;
@@ -178,6 +202,140 @@ static inline ez_topo_t * _ez_topo_glasses()
 }
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// SLAB ALLOCATOR
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  uint32_t a;
+  uint16_t b;
+} _slab_test_t;
+
+SLAB_CACHE(_slab_test_cache, "selfcheck", _slab_test_t, MEM_ACCT_EVENTS);
+
+// -----[ test_slab ]------------------------------------------------
+static int test_slab()
+{
+  _slab_test_t * objs[1000];
+  unsigned int index;
+  unsigned long live= _slab_test_cache.live;
+
+  for (index= 0; index < 1000; index++) {
+    objs[index]= slab_alloc(&_slab_test_cache);
+    UTEST_ASSERT(objs[index] != NULL, "allocation should succeed");
+    objs[index]->a= index;
+    objs[index]->b= index & 0xffff;
+  }
+  UTEST_ASSERT(_slab_test_cache.live == live+1000,
+	       "should have 1000 more live objects");
+  for (index= 0; index < 1000; index++) {
+    UTEST_ASSERT((objs[index]->a == index) &&
+		 (objs[index]->b == (index & 0xffff)),
+		 "objects should not overlap");
+    if (index & 1)
+      slab_free(&_slab_test_cache, objs[index]);
+  }
+  UTEST_ASSERT(_slab_test_cache.live == live+500,
+	       "should have 500 more live objects");
+  UTEST_ASSERT(_slab_test_cache.peak >= live+1000,
+	       "peak should be at least 1000");
+  for (index= 0; index < 1000; index+= 2)
+    slab_free(&_slab_test_cache, objs[index]);
+  UTEST_ASSERT(_slab_test_cache.live == live,
+	       "should be back to the initial number of live objects");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_slab_thread_exit ]------------------------------------
+static int test_slab_thread_exit()
+{
+#ifdef __SLAB_ALLOC__
+  _slab_test_t * obj= slab_alloc(&_slab_test_cache);
+  unsigned long blocks= _slab_test_cache.blocks;
+
+  slab_free(&_slab_test_cache, obj);
+  slab_thread_exit();
+  UTEST_ASSERT(_slab_test_cache.shared != NULL,
+	       "free objects should be moved to the shared list");
+  obj= slab_alloc(&_slab_test_cache);
+  UTEST_ASSERT((_slab_test_cache.blocks == blocks) &&
+	       (_slab_test_cache.shared == NULL),
+	       "shared objects should be allocated again");
+  slab_free(&_slab_test_cache, obj);
+  return UTEST_SUCCESS;
+#else
+  return UTEST_SKIPPED;
+#endif /* __SLAB_ALLOC__ */
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// MEMORY ACCOUNTING
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ test_mem_acct_slab ]---------------------------------------
+static int test_mem_acct_slab()
+{
+  size_t bytes= mem_acct_get(MEM_ACCT_EVENTS);
+  size_t total= mem_acct_get_total();
+  _slab_test_t * obj= slab_alloc(&_slab_test_cache);
+
+  UTEST_ASSERT(mem_acct_get(MEM_ACCT_EVENTS) == bytes+sizeof(_slab_test_t),
+	       "object should be charged to its subsystem");
+  UTEST_ASSERT(mem_acct_get_total() == total+sizeof(_slab_test_t),
+	       "object should be charged to the total");
+  slab_free(&_slab_test_cache, obj);
+  UTEST_ASSERT(mem_acct_get(MEM_ACCT_EVENTS) == bytes,
+	       "object should be released from its subsystem");
+  UTEST_ASSERT(mem_acct_get_total() == total,
+	       "object should be released from the total");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_mem_acct_paths ]--------------------------------------
+static int test_mem_acct_paths()
+{
+  size_t bytes= mem_acct_get(MEM_ACCT_BGP_PATHS);
+  bgp_path_t * path= path_create();
+  bgp_path_t * path2;
+  unsigned int index;
+
+  for (index= 0; index < 10; index++)
+    path_append(&path, 64512+index);
+  UTEST_ASSERT(mem_acct_get(MEM_ACCT_BGP_PATHS) == bytes+path_size(path),
+	       "path should be charged");
+  path2= path_copy(path);
+  path_remove_private(path2);
+  UTEST_ASSERT(mem_acct_get(MEM_ACCT_BGP_PATHS) ==
+	       bytes+path_size(path)+path_size(path2),
+	       "copy should be charged");
+  path_destroy(&path);
+  path_destroy(&path2);
+  UTEST_ASSERT(mem_acct_get(MEM_ACCT_BGP_PATHS) == bytes,
+	       "paths should be released");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_mem_acct_str ]----------------------------------------
+static int test_mem_acct_str()
+{
+  mem_acct_t acct;
+
+  UTEST_ASSERT(!mem_acct_from_str("bgp-routes", &acct) &&
+	       (acct == MEM_ACCT_BGP_ROUTES),
+	       "\"bgp-routes\" should be a valid subsystem");
+  UTEST_ASSERT(!mem_acct_from_str("spt", &acct) && (acct == MEM_ACCT_SPT),
+	       "\"spt\" should be a valid subsystem");
+  UTEST_ASSERT(mem_acct_from_str("total", &acct) < 0,
+	       "\"total\" should not be a subsystem");
+  UTEST_ASSERT(!strcmp(mem_acct_to_str(MEM_ACCT_FIB), "fib"),
+	       "should return \"fib\"");
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // SIMULATOR
@@ -275,6 +433,186 @@ static int test_sim_dynamic_clear()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_sim_sharded ]-----------------------------------------
+/**
+ * An event without key (key -1) posts two events for each key. The
+ * events of each key must be processed in the order they were
+ * posted. Each key is only logged by the thread of its shard.
+ */
+#define SIM_SHARDED_KEYS 8
+typedef struct {
+  int key;
+  int seq;
+} _sim_sharded_ev_t;
+static int _sim_sharded_log[SIM_SHARDED_KEYS][2];
+static unsigned int _sim_sharded_num[SIM_SHARDED_KEYS];
+static int _sim_sharded_callback(simulator_t * sim, void * ctx);
+static int _sim_sharded_key(void * ctx, uint32_t * key)
+{
+  _sim_sharded_ev_t * event= (_sim_sharded_ev_t *) ctx;
+  if (event->key < 0)
+    return -1;
+  *key= event->key;
+  return 0;
+}
+static sim_event_ops_t _sim_sharded_ops= {
+  .callback= _sim_sharded_callback,
+  .destroy = NULL,
+  .dump    = NULL,
+  .shard   = _sim_sharded_key,
+};
+static _sim_sharded_ev_t _sim_sharded_events[2*SIM_SHARDED_KEYS];
+static int _sim_sharded_callback(simulator_t * sim, void * ctx)
+{
+  _sim_sharded_ev_t * event= (_sim_sharded_ev_t *) ctx;
+  unsigned int index;
+  if (event->key < 0) {
+    for (index= 0; index < 2*SIM_SHARDED_KEYS; index++) {
+      _sim_sharded_events[index].key= index % SIM_SHARDED_KEYS;
+      _sim_sharded_events[index].seq= index / SIM_SHARDED_KEYS;
+      sim_post_event(sim, &_sim_sharded_ops, &_sim_sharded_events[index],
+		     0, SIM_TIME_REL);
+    }
+    return 0;
+  }
+  if (_sim_sharded_num[event->key] >= 2)
+    return -1;
+  _sim_sharded_log[event->key][_sim_sharded_num[event->key]++]= event->seq;
+  return 0;
+}
+static int test_sim_sharded()
+{
+  _sim_sharded_ev_t start= { .key= -1, .seq= 0 };
+  simulator_t * sim= sim_create(SCHEDULER_STATIC);
+  unsigned int index;
+  memset(_sim_sharded_num, 0, sizeof(_sim_sharded_num));
+  sim_post_event(sim, &_sim_sharded_ops, &start, 0, SIM_TIME_REL);
+  UTEST_ASSERT(sim_run_sharded(sim, 3) == ESUCCESS,
+	       "sim_run_sharded() should succeed");
+  UTEST_ASSERT(sim_get_num_events(sim) == 0, "should return 0 events");
+  for (index= 0; index < SIM_SHARDED_KEYS; index++)
+    UTEST_ASSERT((_sim_sharded_num[index] == 2) &&
+		 (_sim_sharded_log[index][0] == 0) &&
+		 (_sim_sharded_log[index][1] == 1),
+		 "incorrect events processing for key %u", index);
+  sim_destroy(&sim);
+  sim= sim_create(SCHEDULER_DYNAMIC);
+  UTEST_ASSERT(sim_run_sharded(sim, 3) == EUNSUPPORTED,
+	       "sim_run_sharded() should fail with dynamic scheduler");
+  sim_destroy(&sim);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_sim_sharded_seq ]-------------------------------------
+/**
+ * The sequence numbers of a stream may skip values within a shard,
+ * but must increase. The streams are independent.
+ */
+static int test_sim_sharded_seq()
+{
+  simulator_t * sim= sim_create(SCHEDULER_STATIC);
+  int streams[100];
+  unsigned int index, expected;
+
+  for (index= 0; index < 100; index++)
+    UTEST_ASSERT(sim_shard_seq_check(sim, &streams[index], index,
+				     &expected) == 0,
+		 "first event of stream %u should be in order", index);
+  UTEST_ASSERT((sim_shard_seq_check(sim, &streams[1], 3, &expected) == 0) &&
+	       (expected == 2),
+	       "event 3 should be in order after event 1");
+  UTEST_ASSERT((sim_shard_seq_check(sim, &streams[1], 2, &expected) < 0) &&
+	       (expected == 4),
+	       "event 2 should be out of order after event 3");
+  UTEST_ASSERT((sim_shard_seq_check(sim, &streams[99], 100,
+				    &expected) == 0) &&
+	       (expected == 100),
+	       "event 100 should be in order after event 99");
+  sim_destroy(&sim);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_sim_trace ]-------------------------------------------
+/**
+ * Trace two events with a sampling of 1 out of 2. Only the first
+ * event must be recorded, but both must be timed.
+ */
+static int test_sim_trace()
+{
+  sim_event_ops_t ops= { .callback= _sim_callback,
+			 .name= "test" };
+  simulator_t * sim= sim_create(SCHEDULER_STATIC);
+  sim_trace_enable(4, 2);
+  sim_post_event(sim, &ops, (void *) 1234, 0, SIM_TIME_REL);
+  sim_post_event(sim, &ops, (void *) 2345, 0, SIM_TIME_REL);
+  _sim_array_index= 0;
+  UTEST_ASSERT(sim_run(sim) == 0, "sim_run() should succeed");
+  UTEST_ASSERT(_sim_tracer->num_events == 2, "2 events should be traced");
+  UTEST_ASSERT(_sim_tracer->scope_count[SIM_TRACE_EVENT] == 2,
+	       "2 events should be timed");
+  UTEST_ASSERT(_sim_tracer->num_records == 1, "1 event should be recorded");
+  UTEST_ASSERT(!strcmp(_sim_tracer->records[0].type, "test") &&
+	       (_sim_tracer->records[0].depth == 1),
+	       "incorrect event record");
+  sim_trace_disable();
+  UTEST_ASSERT(_sim_tracer == NULL, "tracer should be disabled");
+  sim_destroy(&sim);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_sim_stats ]-------------------------------------------
+/**
+ * Check the output of the counters of the default network (as shown
+ * by "sim stats") after two events were processed, and that the
+ * counters can be reset.
+ */
+static int test_sim_stats()
+{
+  sim_event_ops_t ops= { .callback= _sim_callback };
+  simulator_t * sim= network_get_simulator(network_get_default());
+  char filename[]= "/tmp/cbgp-stats-XXXXXX";
+  char expected[1024], output[1024];
+  net_protocol_id_t protocol;
+  gds_stream_t * stream;
+  size_t len;
+  FILE * file;
+  int fd= mkstemp(filename);
+  UTEST_ASSERT(fd >= 0, "could not create temporary file");
+  close(fd);
+
+  sim_clear(sim);
+  sim_reset_stats(sim);
+  network_reset_stats();
+  sim_post_event(sim, &ops, (void *) 1234, 0, SIM_TIME_REL);
+  sim_post_event(sim, &ops, (void *) 2345, 0, SIM_TIME_REL);
+  _sim_array_index= 0;
+  UTEST_ASSERT(sim_run(sim) == 0, "sim_run() should succeed");
+
+  stream= stream_create_file(filename);
+  UTEST_ASSERT(stream != NULL, "could not create stream");
+  network_show_stats(stream, network_get_default());
+  stream_destroy(&stream);
+  file= fopen(filename, "r");
+  len= fread(output, 1, sizeof(output)-1, file);
+  output[len]= '\0';
+  fclose(file);
+  remove(filename);
+
+  len= snprintf(expected, sizeof(expected),
+		"events: 2\npeak-depth: 2\nmsgs/protocol:\n");
+  for (protocol= 0; protocol < NET_PROTOCOL_MAX; protocol++)
+    len+= snprintf(expected+len, sizeof(expected)-len, "  %s: 0\n",
+		   net_protocol2str(protocol));
+  UTEST_ASSERT(!strcmp(output, expected), "incorrect output \"%s\"",
+	       output);
+
+  sim_reset_stats(sim);
+  UTEST_ASSERT((sim->stats.num_events == 0) &&
+	       (sim->stats.peak_depth == 0),
+	       "counters should be reset");
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // NET ATTRIBUTES
@@ -1634,6 +1972,281 @@ static int test_net_network_add_subnet_dup()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_net_network_epoch ]-----------------------------------
+static int test_net_network_epoch()
+{
+  network_t * network= network_create();
+  net_node_t * node= __node_create(IPV4(1,0,0,0));
+  unsigned long epoch= network_get_epoch(), topo_epoch;
+  UTEST_ASSERT(network_add_node(network, node) == ESUCCESS,
+		"node addition should succeed");
+  UTEST_ASSERT(network_get_epoch() > epoch,
+		"node addition should change the topology epoch");
+  epoch= network_get_epoch();
+  UTEST_ASSERT(network_find_node(network, IPV4(1,0,0,0)) == node,
+		"node should be found");
+  UTEST_ASSERT(network_get_epoch() == epoch,
+		"lookup should not change the topology epoch");
+  UTEST_ASSERT(node_add_iface(node, IPV4PFX(192,168,0,1,30),
+			      NET_IFACE_PTP) == ESUCCESS,
+		"interface addition should succeed");
+  UTEST_ASSERT(network_get_epoch() > epoch,
+		"interface addition should change the topology epoch");
+  epoch= network_get_epoch();
+  topo_epoch= network_get_topo_epoch();
+  UTEST_ASSERT(node_rt_add_route(node, IPV4PFX(10,0,0,0,8),
+				 IPV4PFX(192,168,0,1,30), NET_ADDR_ANY,
+				 1, NET_ROUTE_STATIC) == ESUCCESS,
+		"route addition should succeed");
+  UTEST_ASSERT(network_get_epoch() > epoch,
+		"route addition should change the topology epoch");
+  epoch= network_get_epoch();
+  rt_info_set_entries(rt_find_exact(node->rt, IPV4PFX(10,0,0,0,8),
+				    NET_ROUTE_STATIC),
+		      rt_entries_create());
+  UTEST_ASSERT(network_get_epoch() > epoch,
+		"route update should change the topology epoch");
+  UTEST_ASSERT(network_get_topo_epoch() == topo_epoch,
+		"route changes should not change the topology-only epoch");
+  net_iface_set_enabled(node_find_iface(node, IPV4PFX(192,168,0,1,30)), 0);
+  UTEST_ASSERT(network_get_topo_epoch() > topo_epoch,
+		"interface state change should change the topology-only epoch");
+  network_destroy(&network);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_network_generate ]--------------------------------
+static int test_net_network_generate()
+{
+  network_t * network= network_create();
+  net_gen_params_t params;
+  net_gen_topo_t * topo;
+  unsigned int num_links;
+  net_gen_params_init(&params);
+  params.model= NET_GEN_FAT_TREE;
+  params.k= 4;
+  UTEST_ASSERT(net_gen_build(network, &params, &topo) == ESUCCESS,
+		"fat-tree generation should succeed");
+  UTEST_ASSERT((topo->num_nodes == 20) && (topo->num_links == 32),
+		"4-ary fat-tree should have 20 nodes and 32 links");
+  UTEST_ASSERT((topo->levels[0] == 0) && (topo->max_level == 2),
+		"fat-tree should have 3 levels");
+  UTEST_ASSERT(network_find_node(network, IPV4(10,0,0,20)) == topo->nodes[19],
+		"node 19 should have address base+20");
+  net_gen_topo_destroy(&topo);
+  UTEST_ASSERT(net_gen_build(network, &params, &topo) == ENET_NODE_DUPLICATE,
+		"generation should fail with existing addresses");
+  network_destroy(&network);
+
+  // Same seed => same topology
+  network= network_create();
+  params.model= NET_GEN_WAXMAN;
+  params.num_nodes= 200;
+  UTEST_ASSERT(net_gen_build(network, &params, &topo) == ESUCCESS,
+		"waxman generation should succeed");
+  UTEST_ASSERT(topo->num_links >= 199, "topology should be connected");
+  num_links= topo->num_links;
+  net_gen_topo_destroy(&topo);
+  network_destroy(&network);
+  network= network_create();
+  UTEST_ASSERT(net_gen_build(network, &params, &topo) == ESUCCESS,
+		"waxman generation should succeed");
+  UTEST_ASSERT(topo->num_links == num_links,
+		"generation should be reproducible");
+  net_gen_topo_destroy(&topo);
+  network_destroy(&network);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_network_export_bin ]------------------------------
+static int test_net_network_export_bin()
+{
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=SUBNET, .id.pfx=IPV4PFX(192,168,0,0,24) },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=5, .delay=7, .capacity=100 },
+    { .src=1, .dst=2, .weight=3 },
+    { .src=0, .dst=3, .weight=1, .src_addr=IPV4(192,168,0,1) },
+    { .src=2, .dst=3, .weight=1, .src_addr=IPV4(192,168,0,3) },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(4, nodes, 4, edges);
+  net_node_t * node;
+  ip_pfx_t pfx= IPV4PFX(10,0,0,0,8);
+  network_t * network;
+  FILE * file;
+  net_iface_t * iface;
+  rt_info_t * rtinfo;
+  igp_domain_t * domain;
+
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  node= ez_topo_get_node(eztopo, 0);
+  network= network_create();
+  file= tmpfile();
+  node_set_name(node, "R1");
+  node->coord.latitude= 50.5;
+  node->coord.longitude= 4.25;
+  net_iface_set_enabled(ez_topo_get_link(eztopo, 1), 0);
+  node_rt_add_route_link(node, pfx, ez_topo_get_link(eztopo, 0),
+			 NET_ADDR_ANY, 10, NET_ROUTE_STATIC);
+  UTEST_ASSERT(net_export_bin(file, eztopo->network) == ESUCCESS,
+		"binary export should succeed");
+  rewind(file);
+  UTEST_ASSERT(net_import_bin(file, network) == ESUCCESS,
+		"binary import should succeed");
+
+  node= network_find_node(network, IPV4(0,0,0,1));
+  UTEST_ASSERT(node != NULL, "node 0.0.0.1 should exist");
+  UTEST_ASSERT((node_get_name(node) != NULL) &&
+		!strcmp(node_get_name(node), "R1"),
+		"node name should be \"R1\"");
+  UTEST_ASSERT((node->coord.latitude == 50.5) &&
+		(node->coord.longitude == 4.25),
+		"node coordinates should be (50.5, 4.25)");
+  iface= node_find_iface(node, net_iface_id_addr(IPV4(0,0,0,2)));
+  UTEST_ASSERT((iface != NULL) && net_iface_is_connected(iface) &&
+		(iface->dest.iface->owner ==
+		 network_find_node(network, IPV4(0,0,0,2))),
+		"link 0.0.0.1 -> 0.0.0.2 should exist");
+  UTEST_ASSERT((net_iface_get_metric(iface, 0) == 5) &&
+		(iface->phys.delay == 7) && (iface->phys.capacity == 100),
+		"link 0.0.0.1 -> 0.0.0.2 attributes should be kept");
+  iface= node_find_iface(network_find_node(network, IPV4(0,0,0,2)),
+			 net_iface_id_addr(IPV4(0,0,0,3)));
+  UTEST_ASSERT((iface != NULL) && !net_iface_is_enabled(iface),
+		"link 0.0.0.2 -> 0.0.0.3 should be down");
+  iface= node_find_iface(node, IPV4PFX(192,168,0,1,24));
+  UTEST_ASSERT((iface != NULL) && (iface->type == NET_IFACE_PTMP) &&
+		(iface->dest.subnet ==
+		 network_find_subnet(network, IPV4PFX(192,168,0,0,24))),
+		"interface 192.168.0.1/24 should be attached to the subnet");
+  domain= network_find_igp_domain(network, 1);
+  UTEST_ASSERT((domain != NULL) &&
+		igp_domain_contains_router_by_addr(domain, IPV4(0,0,0,3)),
+		"domain 1 should contain 0.0.0.3");
+  rtinfo= rt_find_exact(node->rt, pfx, NET_ROUTE_STATIC);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 10),
+		"static route towards 10.0.0.0/8 should exist");
+
+  rewind(file);
+  UTEST_ASSERT(net_import_bin(file, network) == ENET_NODE_DUPLICATE,
+		"binary import should fail (duplicate nodes)");
+  fclose(file);
+  network_destroy(&network);
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _import_bin_data ]-----------------------------------------
+static int _import_bin_data(network_t * network, const uint8_t * data,
+			    size_t size)
+{
+  FILE * file= tmpfile();
+  int result;
+
+  fwrite(data, 1, size, file);
+  rewind(file);
+  result= net_import_bin(file, network);
+  fclose(file);
+  return result;
+}
+
+// -----[ test_net_network_import_bin_invalid ]----------------------
+static int test_net_network_import_bin_invalid()
+{
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(2, nodes, 1, edges);
+  net_node_t * node;
+  network_t * network;
+  FILE * file;
+  net_iface_t * iface;
+  uint8_t data[1024], dest[4];
+  size_t size, offset, oif;
+
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  node= ez_topo_get_node(eztopo, 0);
+  network= network_create();
+  file= tmpfile();
+  // Unconnected point-to-multipoint interface
+  UTEST_ASSERT((net_iface_factory(node, IPV4PFX(192,168,0,1,24),
+				  NET_IFACE_PTMP, &iface) == ESUCCESS) &&
+		(node_add_iface2(node, iface) == ESUCCESS),
+		"interface 192.168.0.1/24 should be added");
+  UTEST_ASSERT(node_rt_add_route_link(node, IPV4PFX(10,0,0,0,8),
+				      ez_topo_get_link(eztopo, 0),
+				      IPV4(0,0,0,2), 1,
+				      NET_ROUTE_STATIC) == ESUCCESS,
+		"route 10.0.0.0/8 should be added");
+  UTEST_ASSERT(net_export_bin(file, eztopo->network) == ESUCCESS,
+		"binary export should succeed");
+  rewind(file);
+  size= fread(data, 1, sizeof(data), file);
+  fclose(file);
+  UTEST_ASSERT((size > 0) && (size < sizeof(data)),
+		"binary export should be read back");
+
+  UTEST_ASSERT(_import_bin_data(network, data, size - 1) == EUNEXPECTED,
+		"binary import should fail (truncated file)");
+  data[0]^= 0xFF;
+  UTEST_ASSERT(_import_bin_data(network, data, size) == EUNEXPECTED,
+		"binary import should fail (bad magic)");
+  data[0]^= 0xFF;
+  data[11]++;
+  UTEST_ASSERT(_import_bin_data(network, data, size) == EUNEXPECTED,
+		"binary import should fail (wrong version)");
+  data[11]--;
+  // Owner of the first interface (after the header and 2 nodes)
+  data[8 + 9 * 4 + 2 * 4 * 4]^= 0x80;
+  UTEST_ASSERT(_import_bin_data(network, data, size) == EUNEXPECTED,
+		"binary import should fail (out-of-range reference)");
+  data[8 + 9 * 4 + 2 * 4 * 4]^= 0x80;
+  // Gateway through an interface without peer (route 10.0.0.0/8)
+  for (offset= 8 + 9 * 4; offset + 5 * 4 <= size; offset+= 4)
+    if (memcmp(&data[offset], "\x0a\x00\x00\x00\x00\x00\x00\x08"
+	       "\x00\x00\x00\x02", 12) == 0)
+      break;
+  UTEST_ASSERT(offset + 5 * 4 <= size, "route 10.0.0.0/8 should be exported");
+  oif= (data[offset + 12] << 24) | (data[offset + 13] << 16) |
+    (data[offset + 14] << 8) | data[offset + 15];
+  offset= 8 + 9 * 4 + 2 * 4 * 4 + oif * 10 * 4 + 4 * 4;
+  memcpy(dest, &data[offset], 4);
+  memset(&data[offset], 0xFF, 4);
+  UTEST_ASSERT(_import_bin_data(network, data, size) == EUNEXPECTED,
+		"binary import should fail (gateway without peer)");
+  memcpy(&data[offset], dest, 4);
+  UTEST_ASSERT(network_find_node(network, IPV4(0,0,0,1)) == NULL,
+		"network should not be modified by an invalid file");
+
+  network_add_igp_domain(network, igp_domain_create(1, IGP_DOMAIN_IGP));
+  UTEST_ASSERT(_import_bin_data(network, data, size)
+		== ENET_IGP_DOMAIN_DUPLICATE,
+		"binary import should fail (duplicate domain)");
+  UTEST_ASSERT(network_find_node(network, IPV4(0,0,0,1)) == NULL,
+		"network should not be modified by a duplicate domain");
+  network_destroy(&network);
+
+  network= network_create();
+  UTEST_ASSERT(_import_bin_data(network, data, size) == ESUCCESS,
+		"binary import should succeed");
+  iface= node_find_iface(network_find_node(network, IPV4(0,0,0,1)),
+			 IPV4PFX(192,168,0,1,24));
+  UTEST_ASSERT((iface != NULL) && (iface->type == NET_IFACE_PTMP) &&
+		!net_iface_is_connected(iface),
+		"interface 192.168.0.1/24 should not be connected");
+  network_destroy(&network);
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_net_network_node_send ]-------------------------------
 static int test_net_network_node_send()
 {
@@ -2202,54 +2815,409 @@ static int test_net_igp_ecmp3()
 }
 
 
-/////////////////////////////////////////////////////////////////////
-//
-// NET TRACES
-//
-/////////////////////////////////////////////////////////////////////
+// -----[ _igp_area_same_routes ]------------------------------------
+/**
+ * Check that an OSPF domain with a single area has the same routes
+ * as with the IGP model.
+ */
+static int _igp_area_same_routes(ez_topo_t * eztopo, ip_pfx_t extra)
+{
+  igp_domain_t * domain= network_find_igp_domain(eztopo->network, 1);
+  ip_pfx_t prefixes[8];
+  net_node_t * nodes[8];
+  uint32_t metrics[8][8];
+  rt_entries_t * entries[8][8];
+  unsigned int num_nodes= 0, num_prefixes, index, index2, index3;
+  rt_info_t * rtinfo;
+  int result= UTEST_SUCCESS;
+
+  for (index= 0; index < eztopo->num_nodes; index++)
+    if (eztopo->nodes[index].type == NODE) {
+      nodes[num_nodes]= eztopo->nodes[index].node;
+      prefixes[num_nodes]= net_prefix(nodes[num_nodes]->rid, 32);
+      num_nodes++;
+    }
+  num_prefixes= num_nodes;
+  if (extra.mask > 0)
+    prefixes[num_prefixes++]= extra;
 
-// -----[ test_net_traces_ping ]-------------------------------------
-static int test_net_traces_ping()
+  igp_domain_compute(domain, 0);
+  for (index= 0; index < num_nodes; index++)
+    for (index2= 0; index2 < num_prefixes; index2++) {
+      rtinfo= rt_find_exact(nodes[index]->rt, prefixes[index2],
+			    NET_ROUTE_IGP);
+      metrics[index][index2]= (rtinfo == NULL)?0:rtinfo->metric;
+      entries[index][index2]=
+	(rtinfo == NULL)?NULL:rt_entries_copy(rtinfo->entries);
+    }
+
+  domain->type= IGP_DOMAIN_OSPF;
+  UTEST_ASSERT(igp_domain_compute_parallel(domain, 0, 2) == 0,
+		"OSPF routes computation should succeed");
+  for (index= 0; index < num_nodes; index++)
+    for (index2= 0; index2 < num_prefixes; index2++) {
+      rtinfo= rt_find_exact(nodes[index]->rt, prefixes[index2],
+			    NET_ROUTE_IGP);
+      if ((rtinfo == NULL) != (entries[index][index2] == NULL))
+	result= -1;
+      else if (rtinfo != NULL) {
+	if ((rtinfo->metric != metrics[index][index2]) ||
+	    (rt_entries_size(rtinfo->entries) !=
+	     rt_entries_size(entries[index][index2])))
+	  result= -1;
+	for (index3= 0; index3 < rt_entries_size(entries[index][index2]);
+	     index3++)
+	  if (!rt_entries_contains(rtinfo->entries,
+				   rt_entries_get_at(entries[index][index2],
+						     index3)))
+	    result= -1;
+	rt_entries_destroy(&entries[index][index2]);
+      }
+    }
+  return result;
+}
+
+// -----[ test_net_igp_area_single ]---------------------------------
+static int test_net_igp_area_single()
 {
-  ez_topo_t * eztopo= _ez_topo_triangle_rtr();
-  net_node_t * node= ez_topo_get_node(eztopo, 0);
-  ez_topo_igp_compute(eztopo, 1);
-  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
-				    IPV4(0,0,0,2), 255) == ESUCCESS,
-		"ping from 0.0.0.1 to 0.0.0.2 should succeed");
-  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
-				    IPV4(0,0,0,3), 255) == ESUCCESS,
-		"ping from 0.0.0.1 to 0.0.0.3 should succeed");
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=SUBNET, .id.pfx=IPV4PFX(192,168,0,0,24) },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=3, .weight=1, .src_addr=IPV4(192,168,0,1) },
+    { .src=1, .dst=3, .weight=1, .src_addr=IPV4(192,168,0,2) },
+    { .src=2, .dst=3, .weight=1, .src_addr=IPV4(192,168,0,3) },
+    { .src=1, .dst=4, .weight=1 },
+    { .src=2, .dst=4, .weight=1 },
+  };
+  ez_topo_t * eztopo= _ez_topo_glasses();
+  ip_pfx_t none= IPV4PFX(0,0,0,0,0);
+  UTEST_ASSERT(_igp_area_same_routes(eztopo, none) == UTEST_SUCCESS,
+		"routes should be the same as with the IGP model (ecmp)");
+  ez_topo_destroy(&eztopo);
+  eztopo= ez_topo_builder(5, nodes, 5, edges);
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  UTEST_ASSERT(_igp_area_same_routes(eztopo, IPV4PFX(192,168,0,0,24))
+		== UTEST_SUCCESS,
+		"routes should be the same as with the IGP model (subnet)");
   ez_topo_destroy(&eztopo);
   return UTEST_SUCCESS;
 }
 
-// -----[ test_net_traces_ping_self_loopback ]-----------------------
-static int test_net_traces_ping_self_loopback()
+// -----[ test_net_igp_area_inter ]----------------------------------
+static int test_net_igp_area_inter()
 {
-  network_t * network= network_create();
-  net_node_t * node;
-  node_create(IPV4(1,0,0,0), &node, NODE_OPTIONS_LOOPBACK);
-  network_add_node(network, node);
-  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
-				    node->rid, 255) == ESUCCESS,
-		"ping from 1.0.0.0 to 1.0.0.0 should succeed");
-  network_destroy(&network);
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+    { .src=1, .dst=2, .weight=2 },
+    { .src=2, .dst=3, .weight=3 },
+    { .src=3, .dst=4, .weight=4 },
+    { .src=0, .dst=4, .weight=100 },
+  };
+  ospf_area_t areas[]= { 1, 0, 0, 2, 1 };
+  ez_topo_t * eztopo= ez_topo_builder(5, nodes, 5, edges);
+  igp_domain_t * domain;
+  net_iface_t * iface;
+  rt_info_t * rtinfo;
+  unsigned int index;
+
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  domain= network_find_igp_domain(eztopo->network, 1);
+  domain->type= IGP_DOMAIN_OSPF;
+  for (index= 0; index < 5; index++) {
+    iface= ez_topo_get_link(eztopo, index);
+    iface->area= areas[index];
+    iface->dest.iface->area= areas[index];
+  }
+  iface= ez_topo_get_link(eztopo, 4);
+  net_iface_set_enabled(iface, 0);
+  net_iface_set_enabled(iface->dest.iface, 0);
+  UTEST_ASSERT(igp_domain_compute_parallel(domain, 0, 2) == 0,
+		"OSPF routes computation should succeed");
+
+  // Inter-area routes, through the backbone
+  rtinfo= rt_find_exact(ez_topo_get_node(eztopo, 0)->rt,
+			IPV4PFX(0,0,0,5,32), NET_ROUTE_IGP);
+  UTEST_ASSERT(rtinfo != NULL, "route towards 0.0.0.5/32 should exist");
+  UTEST_ASSERT(rtinfo->metric == 10, "route metric should be 10");
+  UTEST_ASSERT((rt_entries_size(rtinfo->entries) == 1) &&
+		(rt_entries_get_at(rtinfo->entries, 0)->oif ==
+		 ez_topo_get_link(eztopo, 0)),
+		"route should go through 0.0.0.2");
+  rtinfo= rt_find_exact(ez_topo_get_node(eztopo, 4)->rt,
+			IPV4PFX(0,0,0,1,32), NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 10),
+		"route towards 0.0.0.1/32 should have metric 10");
+  rtinfo= rt_find_exact(ez_topo_get_node(eztopo, 2)->rt,
+			IPV4PFX(0,0,0,1,32), NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 3),
+		"route towards 0.0.0.1/32 should have metric 3");
+
+  // Intra-area routes are preferred
+  net_iface_set_enabled(iface, 1);
+  net_iface_set_enabled(iface->dest.iface, 1);
+  UTEST_ASSERT(igp_domain_compute(domain, 0) == 0,
+		"OSPF routes computation should succeed");
+  rtinfo= rt_find_exact(ez_topo_get_node(eztopo, 0)->rt,
+			IPV4PFX(0,0,0,5,32), NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 100),
+		"intra-area route towards 0.0.0.5/32 should be preferred");
+  rtinfo= rt_find_exact(ez_topo_get_node(eztopo, 2)->rt,
+			IPV4PFX(0,0,0,5,32), NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 7),
+		"route towards 0.0.0.5/32 should have metric 7");
+  ez_topo_destroy(&eztopo);
   return UTEST_SUCCESS;
 }
 
-// -----[ test_net_traces_ping_self_iface ]--------------------------
-static int test_net_traces_ping_self_iface()
+
+// -----[ test_net_igp_matrix_eval ]---------------------------------
+static int test_net_igp_matrix_eval()
 {
-  ez_topo_t * eztopo= _ez_topo_line_ptp();
-  UTEST_ASSERT(icmp_ping_send_recv(ez_topo_get_node(eztopo, 0), NET_ADDR_ANY,
-				    IPV4(192,168,0,1), 255) == ESUCCESS,
-		"ping from 0.0.0.1 to 192.168.0.1 should succeed");
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+    { .src=0, .dst=2, .weight=3 },
+    { .src=1, .dst=2, .weight=1 },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(3, nodes, 3, edges);
+  igp_domain_t * domain;
+  igp_matrix_t * matrix;
+  igp_weight_change_t changes[3];
+  igp_change_report_t reports[3];
+
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  domain= network_find_igp_domain(eztopo->network, 1);
+  matrix= igp_matrix_get(domain);
+  changes[0]= (igp_weight_change_t) { .iface= ez_topo_get_link(eztopo, 2),
+				      .weight= 10 };
+  changes[1]= (igp_weight_change_t) { .iface= ez_topo_get_link(eztopo, 2),
+				      .weight= IGP_MAX_WEIGHT };
+  changes[2]= (igp_weight_change_t) { .iface= ez_topo_get_link(eztopo, 1),
+				      .weight= 1 };
+
+  UTEST_ASSERT(igp_matrix_dist(matrix, ez_topo_get_node(eztopo, 0),
+			       ez_topo_get_node(eztopo, 2)) == 2,
+		"distance from 0.0.0.1 to 0.0.0.3 should be 2");
+  UTEST_ASSERT(igp_matrix_get(domain) == matrix,
+		"distance matrix should be cached");
+  UTEST_ASSERT(node_rt_add_route(ez_topo_get_node(eztopo, 0),
+				 IPV4PFX(10,0,0,0,8),
+				 net_iface_id_addr(IPV4(0,0,0,2)),
+				 NET_ADDR_ANY, 1, NET_ROUTE_STATIC) == ESUCCESS,
+		"route addition should succeed");
+  UTEST_ASSERT(igp_matrix_get(domain) == matrix,
+		"route addition should not invalidate the distance matrix");
+  UTEST_ASSERT(igp_matrix_eval(matrix, changes, 3, reports, 2) == ESUCCESS,
+		"evaluation of weight changes should succeed");
+  UTEST_ASSERT((reports[0].num_changed == 2) &&
+		(reports[0].num_deflected == 2) &&
+		(reports[0].num_unreachable == 0) &&
+		(reports[0].num_loops == 1),
+		"weight increase should deflect 2 pairs and cause 1 loop");
+  UTEST_ASSERT((reports[1].num_changed == 2) &&
+		(reports[1].num_deflected == 2) &&
+		(reports[1].num_unreachable == 0) &&
+		(reports[1].num_loops == 1),
+		"link removal should deflect 2 pairs and cause 1 loop");
+  UTEST_ASSERT((reports[2].num_changed == 1) &&
+		(reports[2].num_deflected == 1) &&
+		(reports[2].num_unreachable == 0) &&
+		(reports[2].num_loops == 0),
+		"weight decrease should deflect 1 pair without loop");
+  changes[0].weight= 0;
+  UTEST_ASSERT(igp_matrix_eval(matrix, changes, 1, reports, 1)
+		== EUNEXPECTED, "null weight should be rejected");
+  net_iface_set_metric(ez_topo_get_link(eztopo, 0), 0, 5, UNIDIR);
+  UTEST_ASSERT(igp_matrix_dist(igp_matrix_get(domain),
+			       ez_topo_get_node(eztopo, 0),
+			       ez_topo_get_node(eztopo, 1)) == 4,
+		"distance matrix should be computed again");
+  ez_topo_destroy(&eztopo);
+
+  // Partition
+  eztopo= _ez_topo_line_rtr();
+  domain= network_find_igp_domain(eztopo->network, 1);
+  changes[0].iface= ez_topo_get_link(eztopo, 0);
+  changes[0].weight= IGP_MAX_WEIGHT;
+  UTEST_ASSERT(igp_matrix_eval(igp_matrix_get(domain), changes, 1,
+			       reports, 1) == ESUCCESS,
+		"evaluation of weight changes should succeed");
+  UTEST_ASSERT((reports[0].num_changed == 1) &&
+		(reports[0].num_deflected == 1) &&
+		(reports[0].num_unreachable == 1) &&
+		(reports[0].num_loops == 0),
+		"link removal should make 1 pair unreachable");
   ez_topo_destroy(&eztopo);
   return UTEST_SUCCESS;
 }
 
-// -----[ test_net_traces_ping_unreach ]-----------------------------
+// -----[ test_net_igp_matrix_delta ]--------------------------------
+/**
+ * Check the delta computation against a full computation of the
+ * distance matrix, for each link and several weights.
+ */
+static int test_net_igp_matrix_delta()
+{
+  ez_topo_t * eztopo= _ez_topo_glasses();
+  igp_domain_t * domain= network_find_igp_domain(eztopo->network, 1);
+  igp_weight_t weights[]= { 1, 4, 10, IGP_MAX_WEIGHT };
+  igp_matrix_t * matrix, * matrix2;
+  igp_weight_change_t change;
+  igp_change_report_t report;
+  igp_weight_t weight;
+  unsigned int index, index2, src, dst, num_changed;
+  net_node_t * nodes[7];
+
+  for (index= 0; index < 7; index++)
+    nodes[index]= ez_topo_get_node(eztopo, index);
+  for (index= 0; index < 8; index++) {
+    change.iface= ez_topo_get_link(eztopo, index);
+    weight= net_iface_get_metric(change.iface, 0);
+    for (index2= 0; index2 < 4; index2++) {
+      change.weight= weights[index2];
+      matrix= igp_matrix_create(domain);
+      UTEST_ASSERT(igp_matrix_eval(matrix, &change, 1, &report, 1)
+		    == ESUCCESS,
+		    "evaluation of weight changes should succeed");
+      net_iface_set_metric(change.iface, 0, change.weight, UNIDIR);
+      matrix2= igp_matrix_create(domain);
+      num_changed= 0;
+      for (src= 0; src < 7; src++)
+	for (dst= 0; dst < 7; dst++)
+	  if (igp_matrix_dist(matrix, nodes[src], nodes[dst]) !=
+	      igp_matrix_dist(matrix2, nodes[src], nodes[dst]))
+	    num_changed++;
+      net_iface_set_metric(change.iface, 0, weight, UNIDIR);
+      igp_matrix_destroy(&matrix);
+      igp_matrix_destroy(&matrix2);
+      UTEST_ASSERT(report.num_changed == num_changed,
+		    "delta computation should match full computation");
+    }
+  }
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_igp_opt_search ]----------------------------------
+static int test_net_igp_opt_search()
+{
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1, .capacity=100 },
+    { .src=1, .dst=2, .weight=1, .capacity=100 },
+    { .src=0, .dst=2, .weight=3, .capacity=100 },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(3, nodes, 3, edges);
+  igp_domain_t * domain;
+  igp_opt_params_t params= {
+    .objective= IGP_OPT_MAX_UTIL,
+    .max_iterations= 10,
+    .max_weight= 4,
+    .num_candidates= 0,
+    .seed= 0,
+    .num_threads= 2,
+  };
+  igp_opt_t * opt;
+
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  domain= network_find_igp_domain(eztopo->network, 1);
+  opt= igp_opt_create(domain);
+  UTEST_ASSERT(igp_opt_add_demand(opt, ez_topo_get_node(eztopo, 0),
+				  ez_topo_get_node(eztopo, 2), 100)
+		== ESUCCESS, "demand should be added");
+  UTEST_ASSERT(igp_opt_objective(opt, IGP_OPT_MAX_UTIL) == 1.0,
+		"max utilization should be 1.0 before the search");
+  params.max_weight= IGP_OPT_MAX_CANDIDATES;
+  UTEST_ASSERT(igp_opt_search(opt, &params, NULL) == EUNSUPPORTED,
+		"search with too many candidates should fail");
+  params.max_weight= 4;
+  UTEST_ASSERT(igp_opt_search(opt, &params, NULL) == ESUCCESS,
+		"search should succeed");
+  UTEST_ASSERT(igp_opt_objective(opt, IGP_OPT_MAX_UTIL) == 0.5,
+		"max utilization should be 0.5 after the search");
+  UTEST_ASSERT(igp_opt_apply(opt) == ESUCCESS,
+		"weights should be applied");
+  igp_opt_destroy(&opt);
+
+  // Full computation with the new weights
+  opt= igp_opt_create(domain);
+  igp_opt_add_demand(opt, ez_topo_get_node(eztopo, 0),
+		     ez_topo_get_node(eztopo, 2), 100);
+  UTEST_ASSERT(igp_opt_objective(opt, IGP_OPT_MAX_UTIL) == 0.5,
+		"max utilization should be 0.5 with the new weights");
+  igp_opt_destroy(&opt);
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// NET TRACES
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ test_net_traces_ping ]-------------------------------------
+static int test_net_traces_ping()
+{
+  ez_topo_t * eztopo= _ez_topo_triangle_rtr();
+  net_node_t * node= ez_topo_get_node(eztopo, 0);
+  ez_topo_igp_compute(eztopo, 1);
+  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
+				    IPV4(0,0,0,2), 255) == ESUCCESS,
+		"ping from 0.0.0.1 to 0.0.0.2 should succeed");
+  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
+				    IPV4(0,0,0,3), 255) == ESUCCESS,
+		"ping from 0.0.0.1 to 0.0.0.3 should succeed");
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_traces_ping_self_loopback ]-----------------------
+static int test_net_traces_ping_self_loopback()
+{
+  network_t * network= network_create();
+  net_node_t * node;
+  node_create(IPV4(1,0,0,0), &node, NODE_OPTIONS_LOOPBACK);
+  network_add_node(network, node);
+  UTEST_ASSERT(icmp_ping_send_recv(node, NET_ADDR_ANY,
+				    node->rid, 255) == ESUCCESS,
+		"ping from 1.0.0.0 to 1.0.0.0 should succeed");
+  network_destroy(&network);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_traces_ping_self_iface ]--------------------------
+static int test_net_traces_ping_self_iface()
+{
+  ez_topo_t * eztopo= _ez_topo_line_ptp();
+  UTEST_ASSERT(icmp_ping_send_recv(ez_topo_get_node(eztopo, 0), NET_ADDR_ANY,
+				    IPV4(192,168,0,1), 255) == ESUCCESS,
+		"ping from 0.0.0.1 to 192.168.0.1 should succeed");
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_traces_ping_unreach ]-----------------------------
 static int test_net_traces_ping_unreach()
 {
   network_t * network= network_create();
@@ -2894,6 +3862,39 @@ static int test_bgp_attr_aspath_prepend_too_much()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_attr_aspath_prepend_copy ]------------------------
+static int test_bgp_attr_aspath_prepend_copy()
+{
+  char acBuffer[16];
+  bgp_path_t * path= path_from_string("2 3");
+  bgp_path_t * new_path= path_prepend(path, 1, 2);
+  bgp_path_t * ref_path= path_from_string("1 1 2 3");
+  UTEST_ASSERT(new_path != NULL,
+	       "path_prepend() should return new path");
+  UTEST_ASSERT(path_length(path) == 2,
+	       "original path must not be modified");
+  UTEST_ASSERT(path_length(new_path) == 4,
+	       "prepended path must have length of 4");
+  UTEST_ASSERT((path_to_string(new_path, 1, acBuffer,
+			       sizeof(acBuffer)) >= 0) &&
+	       (strcmp(acBuffer, "1 1 2 3") == 0),
+	       "prepended path should be \"1 1 2 3\"");
+  UTEST_ASSERT(path_equals(new_path, ref_path),
+	       "prepended path should be equal to reference path");
+  UTEST_ASSERT(path_hash_zebra(new_path, 0) == path_hash_zebra(ref_path, 0),
+	       "cached hash should be equal to that of reference path");
+  UTEST_ASSERT(path_num_segments(new_path) == 1,
+	       "prepended path should have a single segment");
+  path_destroy(&new_path);
+  new_path= path_prepend(NULL, 1, 1);
+  UTEST_ASSERT((new_path != NULL) && (path_length(new_path) == 1),
+	       "prepending to null path should create path of length 1");
+  path_destroy(&new_path);
+  path_destroy(&ref_path);
+  path_destroy(&path);
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_bgp_attr_aspath_prepend_asn32 ]-----------------------
 #ifdef ASN_SIZE_32
 static int test_bgp_attr_aspath_prepend_asn32()
@@ -2999,7 +4000,7 @@ static int test_bgp_attr_aspath_set_str2()
   UTEST_ASSERT(path != NULL, "\"{1 2 3}\" is a valid AS-Path");
   UTEST_ASSERT(path_num_segments(path) == 1,
 		"Path should have a single segment");
-  seg= (bgp_path_seg_t *) path->data[0];
+  seg= path_segment_at(path, 0);
   UTEST_ASSERT(seg->type == AS_PATH_SEGMENT_SET,
 		"Segment type should be AS_SET");
   UTEST_ASSERT(seg->length == 3,
@@ -3010,6 +4011,33 @@ static int test_bgp_attr_aspath_set_str2()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_attr_aspath_segment_next ]------------------------
+static int test_bgp_attr_aspath_segment_next()
+{
+  bgp_path_t * path= path_from_string("63 {2 3} 1");
+  bgp_path_seg_t * seg= NULL;
+  char buf[32];
+  int index= 0;
+
+  UTEST_ASSERT(path != NULL, "\"63 {2 3} 1\" is a valid AS-Path");
+  while ((seg= path_segment_next(path, seg)) != NULL) {
+    UTEST_ASSERT(seg == path_segment_at(path, index),
+		  "iterator should return segment %d", index);
+    index++;
+  }
+  UTEST_ASSERT(index == path_num_segments(path),
+		"iterator should return all the segments");
+  UTEST_ASSERT(path_contains(path, 63) && !path_contains(path, 31),
+		"path should contain 63 and not 31");
+  UTEST_ASSERT((path_to_string(path, 1, buf, sizeof(buf)) > 0) &&
+		!strcmp(buf, "63 {2 3} 1"),
+		"path should be converted to \"63 {2 3} 1\"");
+  path_destroy(&path);
+  UTEST_ASSERT(path_segment_next(NULL, NULL) == NULL,
+		"null path should have no segment");
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_bgp_attr_aspath_cmp ]---------------------------------
 static int test_bgp_attr_aspath_cmp()
 {
@@ -3461,6 +4489,132 @@ static int test_bgp_route_aspath()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_route_to_string ]---------------------------------
+static int test_bgp_route_to_string()
+{
+  ip_pfx_t pfx= IPV4PFX(130,104,0,0,16);
+  bgp_route_t * route= route_create(pfx, NULL, IPV4(1,0,0,0),
+				    BGP_ORIGIN_IGP);
+  const char * expected= "*> 130.104.0.0/16\t1.0.0.0\t100\t5\t666 666\ti";
+  char str[64];
+  route_set_path(route, path_create());
+  route_path_prepend(route, 666, 2);
+  route_localpref_set(route, 100);
+  route_med_set(route, 5);
+  route_flag_set(route, ROUTE_FLAG_FEASIBLE, 1);
+  route_flag_set(route, ROUTE_FLAG_BEST, 1);
+  UTEST_ASSERT(route_to_string(route, str, sizeof(str)) == strlen(expected),
+	       "route_to_string() should succeed");
+  UTEST_ASSERT(!strcmp(str, expected), "incorrect route string \"%s\"", str);
+  UTEST_ASSERT(route_to_string(route, str, strlen(expected)) < 0,
+	       "route_to_string() should fail with a short string");
+  route_destroy(&route);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_route_rib_cursor ]--------------------------------
+/**
+ * Walk through a RIB of 5 routes by pages of 2 routes, then with a
+ * predicate that only matches 2 routes.
+ */
+#define RIB_CURSOR_NUM_ROUTES 5
+static ip_pfx_t _rib_cursor_pfxs[RIB_CURSOR_NUM_ROUTES];
+static unsigned int _rib_cursor_num;
+static int _rib_cursor_for_each(uint32_t key, uint8_t key_len,
+				void * item, void * ctx)
+{
+  if (_rib_cursor_num >= RIB_CURSOR_NUM_ROUTES)
+    return -1;
+  _rib_cursor_pfxs[_rib_cursor_num++]= ((bgp_route_t *) item)->prefix;
+  return 0;
+}
+static int test_bgp_route_rib_cursor()
+{
+  ip_pfx_t pfxs[RIB_CURSOR_NUM_ROUTES]= {
+    IPV4PFX(10,0,0,0,8),
+    IPV4PFX(10,0,0,0,16),
+    IPV4PFX(10,1,0,0,16),
+    IPV4PFX(130,104,0,0,16),
+    IPV4PFX(192,168,0,0,24),
+  };
+  unsigned int order[RIB_CURSOR_NUM_ROUTES]= { 3, 0, 4, 2, 1 };
+  bgp_rib_t * rib= rib_create(0);
+  bgp_rib_cursor_t cursor;
+  bgp_ft_matcher_t * matcher;
+  unsigned int index;
+  for (index= 0; index < RIB_CURSOR_NUM_ROUTES; index++)
+    rib_add_route(rib, route_create(pfxs[order[index]], NULL,
+				    IPV4(1,0,0,order[index] % 2),
+				    BGP_ORIGIN_IGP));
+  rib_cursor_init(&cursor, NULL, 2, NULL);
+  for (index= 0; index < 3; index++) {
+    _rib_cursor_num= 0;
+    UTEST_ASSERT(rib_cursor_for_each(rib, &cursor, _rib_cursor_for_each,
+				     NULL) == 0,
+		 "rib_cursor_for_each() should succeed");
+    UTEST_ASSERT(_rib_cursor_num == ((index < 2)?2:1),
+		 "incorrect number of routes in page %u", index);
+    UTEST_ASSERT(!ip_prefix_cmp(&_rib_cursor_pfxs[0], &pfxs[2*index]),
+		 "incorrect first route in page %u", index);
+    UTEST_ASSERT(cursor.more == (index < 2),
+		 "incorrect end of RIB in page %u", index);
+  }
+  UTEST_ASSERT(predicate_parser("next-hop is 1.0.0.1", &matcher) ==
+	       PREDICATE_PARSER_SUCCESS, "predicate should be valid");
+  rib_cursor_init(&cursor, NULL, 0, matcher);
+  _rib_cursor_num= 0;
+  rib_cursor_for_each(rib, &cursor, _rib_cursor_for_each, NULL);
+  UTEST_ASSERT(_rib_cursor_num == 2, "2 routes should match predicate");
+  filter_matcher_destroy(&matcher);
+  rib_destroy(&rib);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_route_stream ]------------------------------------
+static int test_bgp_route_stream()
+{
+  ip_pfx_t pfx= IPV4PFX(130,104,0,0,16);
+  bgp_route_t * route= route_create(pfx, NULL, IPV4(1,0,0,0),
+				    BGP_ORIGIN_EGP);
+  bgp_route_t * route2;
+  uint8_t buf[256];
+  net_addr_t peer_addr;
+  asn_t peer_asn;
+  int len;
+  route_set_path(route, path_from_string("1 2 {3 4}"));
+  route_comm_append(route, 65535);
+  route_localpref_set(route, 80);
+  route_med_set(route, 10);
+  len= route_stream_encode(route, IPV4(2,0,0,0), 2611, buf, sizeof(buf));
+  UTEST_ASSERT(len == 54, "incorrect record length (%d)", len);
+  UTEST_ASSERT(route_stream_encode(route, IPV4(2,0,0,0), 2611, buf, 53) < 0,
+	       "encoding should fail when buffer is too small");
+  UTEST_ASSERT(route_stream_decode(buf+2, len-2, &peer_addr, &peer_asn,
+				   &route2) == 0, "decoding should succeed");
+  UTEST_ASSERT((peer_addr == IPV4(2,0,0,0)) && (peer_asn == 2611),
+	       "incorrect peer");
+  UTEST_ASSERT(!ip_prefix_cmp(&route2->prefix, &pfx), "incorrect prefix");
+  UTEST_ASSERT(route_get_origin(route2) == BGP_ORIGIN_EGP,
+	       "incorrect origin");
+  UTEST_ASSERT((route_localpref_get(route2) == 80) &&
+	       (route_med_get(route2) == 10), "incorrect attributes");
+  UTEST_ASSERT(path_equals(route_get_path(route2), route_get_path(route)),
+	       "incorrect AS-Path");
+  UTEST_ASSERT(route_comm_contains(route2, 65535), "incorrect communities");
+  // Type of the first AS-Path segment
+  buf[2+27]= 0;
+  UTEST_ASSERT(route_stream_decode(buf+2, len-2, &peer_addr, &peer_asn,
+				   &route2) < 0,
+	       "decoding of unknown segment type should fail");
+  buf[2+27]= AS_PATH_SEGMENT_SEQUENCE;
+  UTEST_ASSERT(route_stream_decode(buf+2, len-3, &peer_addr, &peer_asn,
+				   &route2) < 0,
+	       "decoding of truncated record should fail");
+  route_destroy(&route2);
+  route_destroy(&route);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4005,6 +5159,56 @@ int test_bgp_filter_predicate_expr_str2()
 }
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// BGP UNIFIED RIB
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ test_bgp_urib ]--------------------------------------------
+static int test_bgp_urib()
+{
+  bgp_urib_t * urib= urib_create();
+  ip_pfx_t pfx1= IPV4PFX(192,168,0,0,16);
+  ip_pfx_t pfx2= IPV4PFX(192,168,1,0,24);
+  bgp_route_t * route1= route_create(pfx1, NULL, IPV4(1,0,0,0),
+				     BGP_ORIGIN_IGP);
+  bgp_route_t * route2= route_create(pfx2, NULL, IPV4(2,0,0,0),
+				     BGP_ORIGIN_IGP);
+  bgp_route_t * route3= route_create(pfx2, NULL, IPV4(3,0,0,0),
+				     BGP_ORIGIN_IGP);
+  bgp_urib_node_t * node;
+  UTEST_ASSERT(urib != NULL, "unified RIB creation should succeed");
+  urib_replace_route(urib, 3, route1);
+  urib_replace_route(urib, 2, route2);
+  urib_replace_route(urib, 0, route3);
+  node= urib_find_node(urib, pfx2);
+  UTEST_ASSERT((node != NULL) && (node->size == 2),
+	       "node should contain 2 candidate routes");
+  UTEST_ASSERT((node->entries[0].peer_index == 0) &&
+	       (node->entries[1].peer_index == 2),
+	       "candidate routes should be sorted on peer index");
+  UTEST_ASSERT(urib_find_route(urib, pfx2, 2) == route2,
+	       "incorrect route for peer 2");
+  UTEST_ASSERT(urib_find_route(urib, pfx2, 3) == NULL,
+	       "peer 3 has no route towards this prefix");
+  UTEST_ASSERT(urib_find_best_route(urib, pfx2, 3) == route1,
+	       "best match for peer 3 should be the less specific route");
+  UTEST_ASSERT(urib_remove_route(urib, pfx2, 2) == 0,
+	       "route removal should succeed");
+  UTEST_ASSERT(urib_remove_route(urib, pfx2, 2) < 0,
+	       "removal of unknown route should fail");
+  urib_clear_peer(urib, 0);
+  UTEST_ASSERT(urib_find_node(urib, pfx2) == NULL,
+	       "empty node should be released");
+  UTEST_ASSERT(urib_find_route(urib, pfx1, 3) == route1,
+	       "route of other peer should be kept");
+  urib_destroy(&urib);
+  UTEST_ASSERT(urib == NULL, "destroyed unified RIB should be NULL");
+  return UTEST_SUCCESS;
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // BGP ROUTER
@@ -4116,6 +5320,56 @@ static int test_bgp_router_add_network_dup()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_router_unified_rib ]------------------------------
+static int test_bgp_router_unified_rib()
+{
+  net_node_t * node= __node_create(IPV4(1,0,0,0));
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  bgp_options_flag_set(BGP_OPT_UNIFIED_RIB);
+  UTEST_ASSERT(bgp_router_create(2611, node, &router) == ESUCCESS,
+	       "router creation should succeed");
+  bgp_options_flag_reset(BGP_OPT_UNIFIED_RIB);
+  UTEST_ASSERT(router->urib != NULL,
+	       "unified RIB not properly initialized");
+  UTEST_ASSERT(bgp_router_add_peer(router, 1, IPV4(2,0,0,0), &peer)
+	       == ESUCCESS, "peer addition should succeed");
+  UTEST_ASSERT(peer->adj_rib[RIB_IN] == NULL,
+	       "Adj-RIB-In should not exist with unified RIB");
+  UTEST_ASSERT(bgp_router_add_network(router, pfx) == ESUCCESS,
+	       "addition of network should succeed");
+  UTEST_ASSERT(urib_get_best(router->urib, pfx) != NULL,
+	       "unified RIB best route should be set");
+  UTEST_ASSERT(bgp_router_del_network(router, pfx) == ESUCCESS,
+	       "removal of network should succeed");
+  UTEST_ASSERT(urib_get_best(router->urib, pfx) == NULL,
+	       "unified RIB best route should be cleared");
+  bgp_router_destroy(&router);
+  node_destroy(&node);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_router_reachability ]-----------------------------
+/**
+ * Resolve the states of 7 routers: 0 <- 1 <- 2 reach the next-hop,
+ * 3 -> 4 -> dead end, 5 <-> 6 form a loop.
+ */
+static int test_bgp_router_reachability()
+{
+  int next[7]= { BGP_REACH_NEXT_SELF, 0, 1, 4, BGP_REACH_NEXT_NONE, 6, 5 };
+  uint8_t states[7];
+  uint8_t expected[7]= { BGP_REACH_OK, BGP_REACH_OK, BGP_REACH_OK,
+			 BGP_REACH_UNREACH, BGP_REACH_UNREACH,
+			 BGP_REACH_LOOP, BGP_REACH_LOOP };
+  unsigned int index;
+  bgp_reach_resolve(next, 7, states);
+  for (index= 0; index < 7; index++)
+    UTEST_ASSERT(states[index] == expected[index],
+		 "incorrect state for router %u (%u)", index, states[index]);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4249,6 +5503,46 @@ static int test_bgp_peer_close()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_peer_rib_out_elide ]------------------------------
+static int test_bgp_peer_rib_out_elide()
+{
+  net_node_t * node= __node_create(IPV4(1,0,0,0));
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  bgp_route_t * route;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  UTEST_ASSERT(bgp_router_create(2611, node, &router) == ESUCCESS,
+	       "router creation should succeed");
+  UTEST_ASSERT(bgp_router_add_peer(router, 1, IPV4(2,0,0,0), &peer)
+	       == ESUCCESS, "peer addition should succeed");
+  UTEST_ASSERT(bgp_router_add_network(router, pfx) == ESUCCESS,
+	       "addition of network should succeed");
+  route= bgp_router_find_best(router, pfx);
+  UTEST_ASSERT(route != NULL, "best route should exist");
+  UTEST_ASSERT(bgp_peer_set_rib_out_elide(peer, 1) == ESUCCESS,
+	       "Adj-RIB-Out elision should succeed");
+  UTEST_ASSERT(peer->flags & PEER_FLAG_RIB_OUT_ELIDE,
+	       "rib-out-elide flag should be set");
+  UTEST_ASSERT(bgp_peer_rib_find_exact(peer, RIB_OUT, pfx) == NULL,
+	       "elided Adj-RIB-Out should be empty");
+  bgp_peer_rib_out_mark(peer, route);
+  UTEST_ASSERT(bgp_peer_rib_find_exact(peer, RIB_OUT, pfx) == route,
+	       "elided Adj-RIB-Out should derive best route");
+  UTEST_ASSERT(bgp_peer_set_rib_out_elide(peer, 0) == ESUCCESS,
+	       "Adj-RIB-Out restoration should succeed");
+  UTEST_ASSERT(bgp_peer_rib_find_exact(peer, RIB_OUT, pfx) != NULL,
+	       "restored Adj-RIB-Out should contain route");
+  UTEST_ASSERT(bgp_peer_set_rib_out_elide(peer, 1) == ESUCCESS,
+	       "Adj-RIB-Out elision should succeed");
+  UTEST_ASSERT(bgp_peer_rib_out_unmark(peer, pfx) == 1,
+	       "unmark of advertised prefix should return 1");
+  UTEST_ASSERT(bgp_peer_rib_out_unmark(peer, pfx) == 0,
+	       "unmark of withdrawn prefix should return 0");
+  bgp_router_destroy(&router);
+  node_destroy(&node);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4274,8 +5568,247 @@ static int test_bgp_peer_filter_remove()
 /////////////////////////////////////////////////////////////////////
 
 // -----[ test_bgp_domain_full_mesh ]--------------------------------
+/**
+ * Build a full-mesh in bulk. The sessions must be established
+ * without OPEN exchange and the Loc-RIBs must be disseminated.
+ */
 static int test_bgp_domain_full_mesh()
 {
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+    { .src=1, .dst=2, .weight=1 },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(3, nodes, 2, edges);
+  bgp_router_t * routers[3];
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  unsigned int index, index2;
+  ez_topo_igp_compute(eztopo, 1);
+  for (index= 0; index < 3; index++)
+    bgp_add_router(2612, ez_topo_get_node(eztopo, index), &routers[index]);
+  bgp_router_add_network(routers[0], pfx);
+  UTEST_ASSERT(bgp_domain_full_mesh(get_bgp_domain(2612), 0) == ESUCCESS,
+	       "full-mesh should succeed");
+  for (index= 0; index < 3; index++) {
+    UTEST_ASSERT(bgp_peers_size(routers[index]->peers) == 2,
+		 "router should have 2 peers");
+    for (index2= 0; index2 < 2; index2++)
+      UTEST_ASSERT(bgp_peers_at(routers[index]->peers, index2)->session_state
+		   == SESSION_STATE_ESTABLISHED,
+		   "session state should be ESTABLISHED");
+  }
+  ez_topo_sim_run(eztopo);
+  UTEST_ASSERT(bgp_router_find_best(routers[2], pfx) != NULL,
+	       "route should be disseminated");
+  UTEST_ASSERT(routers[2]->stats.dp_runs > 0,
+	       "decision process runs should be counted");
+  UTEST_ASSERT(bgp_peers_at(routers[2]->peers, 0)->stats.updates_rcvd == 1,
+	       "update received from R0 should be counted");
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_domain_full_mesh_urib ]---------------------------
+/**
+ * Build a full-mesh in bulk between routers that use a unified RIB.
+ * Each peer must have its own index in the unified RIB: the routes
+ * received from R0 and R1 must be found in the Adj-RIB-In of the
+ * corresponding peer.
+ */
+static int test_bgp_domain_full_mesh_urib()
+{
+  ez_node_t nodes[]= {
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+    { .type=NODE, .domain=1 },
+  };
+  ez_edge_t edges[]= {
+    { .src=0, .dst=1, .weight=1 },
+    { .src=1, .dst=2, .weight=1 },
+  };
+  ez_topo_t * eztopo= ez_topo_builder(3, nodes, 2, edges);
+  bgp_router_t * routers[3];
+  bgp_peer_t * peer;
+  bgp_route_t * route;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  unsigned int index, index2;
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  ez_topo_igp_compute(eztopo, 1);
+  bgp_options_flag_set(BGP_OPT_UNIFIED_RIB);
+  for (index= 0; index < 3; index++)
+    bgp_add_router(2614, ez_topo_get_node(eztopo, index), &routers[index]);
+  bgp_options_flag_reset(BGP_OPT_UNIFIED_RIB);
+  bgp_router_add_network(routers[0], pfx);
+  bgp_router_add_network(routers[1], pfx);
+  UTEST_ASSERT(bgp_domain_full_mesh(get_bgp_domain(2614), 0) == ESUCCESS,
+	       "full-mesh should succeed");
+  for (index= 0; index < 3; index++) {
+    UTEST_ASSERT(routers[index]->urib != NULL,
+		 "router should use a unified RIB");
+    for (index2= 0; index2 < 2; index2++)
+      UTEST_ASSERT(bgp_peers_at(routers[index]->peers, index2)->rib_index
+		   == index2, "peer should have RIB index %u", index2);
+  }
+  ez_topo_sim_run(eztopo);
+  for (index= 0; index < 3; index++) {
+    for (index2= 0; index2 < 2; index2++) {
+      peer= bgp_peers_at(routers[index]->peers, index2);
+      route= bgp_peer_rib_find_exact(peer, RIB_IN, pfx);
+      if (peer->addr == routers[2]->node->rid) {
+	UTEST_ASSERT(route == NULL,
+		     "R2 should not have advertised a route");
+      } else {
+	UTEST_ASSERT((route != NULL) && (route->peer == peer) &&
+		     (route->attr->next_hop == peer->addr),
+		     "Adj-RIB-In of peer should contain its own route");
+      }
+    }
+  }
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_bgp_domain_generate_route ]--------------------------
+typedef struct {
+  bgp_router_t ** routers;
+  unsigned int    num_routers;
+  unsigned int    num_routes;
+  unsigned int    num_missing;
+} _test_bgp_gen_ctx_t;
+
+static int _test_bgp_domain_generate_route(uint32_t key, uint8_t key_len,
+					   void * item, void * ctx)
+{
+  _test_bgp_gen_ctx_t * gen_ctx= (_test_bgp_gen_ctx_t *) ctx;
+  ip_pfx_t pfx= { .network= key, .mask= key_len };
+  unsigned int index;
+
+  gen_ctx->num_routes++;
+  for (index= 0; index < gen_ctx->num_routers; index++)
+    if (bgp_router_find_best(gen_ctx->routers[index], pfx) == NULL)
+      gen_ctx->num_missing++;
+  return 0;
+}
+
+// -----[ test_bgp_domain_generate ]---------------------------------
+/**
+ * Generate the BGP configuration of a 4-ary fat-tree (20 routers)
+ * with a full-mesh and 3 eBGP neighbors. All the sessions must be
+ * established, each router must have a best route for every prefix
+ * received from the eBGP neighbors and the iBGP routes must carry
+ * the address of the border router as next-hop.
+ */
+static int test_bgp_domain_generate()
+{
+  network_t * network= network_create();
+  net_gen_params_t params;
+  bgp_gen_params_t bgp_params;
+  net_gen_topo_t * topo;
+  bgp_router_t * routers[20];
+  _test_bgp_gen_ctx_t gen_ctx= { .routers= routers, .num_routers= 20 };
+  bgp_peer_t * peer;
+  unsigned int index, index2, num_ibgp, num_ebgp= 0;
+  net_gen_params_init(&params);
+  params.model= NET_GEN_FAT_TREE;
+  params.k= 4;
+  params.domain= 1;
+  UTEST_ASSERT(net_gen_build(network, &params, &topo) == ESUCCESS,
+	       "fat-tree generation should succeed");
+  igp_domain_compute(network_find_igp_domain(network, 1), 0);
+  bgp_gen_params_init(&bgp_params);
+  bgp_params.asn= 2616;
+  bgp_params.num_ebgp= 3;
+  bgp_params.num_prefixes= 50;
+  UTEST_ASSERT(bgp_gen_build(network, topo, &bgp_params) == ESUCCESS,
+	       "BGP generation should succeed");
+  UTEST_ASSERT(sim_run(network_get_simulator(network)) == 0,
+	       "sim_run() should succeed");
+
+  for (index= 0; index < 20; index++) {
+    routers[index]= (bgp_router_t *)
+      protocols_get(topo->nodes[index]->protocols,
+		    NET_PROTOCOL_BGP)->handler;
+    num_ibgp= 0;
+    for (index2= 0; index2 < bgp_peers_size(routers[index]->peers);
+	 index2++) {
+      peer= bgp_peers_at(routers[index]->peers, index2);
+      UTEST_ASSERT(peer->session_state == SESSION_STATE_ESTABLISHED,
+		   "session state should be ESTABLISHED");
+      if (peer->asn == 2616)
+	num_ibgp++;
+      else
+	num_ebgp++;
+    }
+    UTEST_ASSERT(num_ibgp == 19, "router should have 19 iBGP peers");
+  }
+  UTEST_ASSERT(num_ebgp == 3, "routers should have 3 eBGP peers");
+
+  for (index= 0; index < 20; index++)
+    for (index2= 0; index2 < bgp_peers_size(routers[index]->peers);
+	 index2++) {
+      peer= bgp_peers_at(routers[index]->peers, index2);
+      if (peer->asn != 2616) {
+	UTEST_ASSERT(topo->levels[index] == topo->max_level,
+		     "eBGP peer should be attached to a border router");
+	bgp_peer_rib_for_each(peer, RIB_IN, _test_bgp_domain_generate_route,
+			      &gen_ctx);
+      }
+    }
+  UTEST_ASSERT(gen_ctx.num_routes >= 50,
+	       "eBGP peers should have announced 50 prefixes or more");
+  UTEST_ASSERT(gen_ctx.num_missing == 0,
+	       "all routers should have a best route for every prefix");
+  net_gen_topo_destroy(&topo);
+  network_destroy(&network);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_domain_rr_hierarchy ]-----------------------------
+/**
+ * Build a hierarchy with clusters of 1 route-reflector and 2
+ * clients in a line of 5 routers (R0 and R1 are the reflectors, R2
+ * and R3 are clients of R0, R4 is a client of R1).
+ */
+static int test_bgp_domain_rr_hierarchy()
+{
+  ez_node_t nodes[5];
+  ez_edge_t edges[4];
+  ez_topo_t * eztopo;
+  bgp_router_t * routers[5];
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  unsigned int index;
+  for (index= 0; index < 5; index++) {
+    nodes[index]= (ez_node_t) { .type=NODE, .domain=1 };
+    if (index > 0)
+      edges[index-1]= (ez_edge_t) { .src=index-1, .dst=index, .weight=1 };
+  }
+  eztopo= ez_topo_builder(5, nodes, 4, edges);
+  UTEST_ASSERT(eztopo != NULL, "topology should be built");
+  ez_topo_igp_compute(eztopo, 1);
+  for (index= 0; index < 5; index++)
+    bgp_add_router(2613, ez_topo_get_node(eztopo, index), &routers[index]);
+  bgp_router_add_network(routers[4], pfx);
+  UTEST_ASSERT(bgp_domain_build_rr_hierarchy(get_bgp_domain(2613), 2, 1, 0)
+	       == ESUCCESS, "RR hierarchy should be built");
+  UTEST_ASSERT((bgp_peers_size(routers[0]->peers) == 3) &&
+	       (bgp_peers_size(routers[1]->peers) == 2) &&
+	       (bgp_peers_size(routers[3]->peers) == 1),
+	       "incorrect number of peers");
+  UTEST_ASSERT(routers[0]->reflector && routers[1]->reflector &&
+	       !routers[2]->reflector,
+	       "R0 and R1 should be route-reflectors");
+  UTEST_ASSERT(bgp_peer_flag_get(bgp_peers_find(routers[1]->peers,
+						routers[4]->node->rid),
+				 PEER_FLAG_RR_CLIENT),
+	       "R4 should be a client of R1");
+  ez_topo_sim_run(eztopo);
+  UTEST_ASSERT(bgp_router_find_best(routers[3], pfx) != NULL,
+	       "route should be reflected to R3");
+  ez_topo_destroy(&eztopo);
   return UTEST_SUCCESS;
 }
 
@@ -4426,6 +5959,90 @@ static int test_mrtd_parse_inv_nexthop()
 }
 
 
+// -----[ test_mrtd_v2_encode_peer_table ]---------------------------
+/**
+ * Check the layout of a PEER_INDEX_TABLE record (RFC 6396, 4.3.1):
+ * MRT header, collector BGP ID, view name length, peer count and
+ * one entry per peer (type, BGP ID, IPv4 address, 4-byte ASN).
+ */
+static int test_mrtd_v2_encode_peer_table()
+{
+  mrtd_peer_t peers[2]= {
+    { .addr= IPV4(198,32,12,9), .asn= 11537 },
+    { .addr= IPV4(10,0,0,1), .asn= 64512 },
+  };
+  const uint8_t expected[]= {
+    0x01, 0x02, 0x03, 0x04, 0x00, 0x0d, 0x00, 0x01, // Header
+    0x00, 0x00, 0x00, 0x22,
+    0x0a, 0x00, 0x00, 0xfe,                         // Collector
+    0x00, 0x00,                                     // View name
+    0x00, 0x02,                                     // Peer count
+    0x02, 0xc6, 0x20, 0x0c, 0x09, 0xc6, 0x20, 0x0c, // Peer 0
+    0x09, 0x00, 0x00, 0x2d, 0x11,
+    0x02, 0x0a, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x00, // Peer 1
+    0x01, 0x00, 0x00, 0xfc, 0x00,
+  };
+  uint8_t buf[64];
+  int len= mrtd_v2_encode_peer_table(0x01020304, IPV4(10,0,0,254),
+				     peers, 2, buf, sizeof(buf));
+  UTEST_ASSERT(len == sizeof(expected),
+	       "record should have %d bytes (%d)", (int) sizeof(expected), len);
+  UTEST_ASSERT(!memcmp(buf, expected, sizeof(expected)),
+	       "incorrect record");
+  UTEST_ASSERT(mrtd_v2_encode_peer_table(0x01020304, IPV4(10,0,0,254),
+					 peers, 2, buf,
+					 sizeof(expected)-1) < 0,
+	       "encoding should fail with a short buffer");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_mrtd_v2_encode_rib ]----------------------------------
+/**
+ * Check the layout of a RIB_IPV4_UNICAST record (RFC 6396, 4.3.2)
+ * with a single entry: MRT header, sequence number, prefix, entry
+ * count, then peer index, originated time and path attributes (with
+ * a 4-byte AS-Path).
+ */
+static int test_mrtd_v2_encode_rib()
+{
+  const uint8_t expected[]= {
+    0x01, 0x02, 0x03, 0x04, 0x00, 0x0d, 0x00, 0x02, // Header
+    0x00, 0x00, 0x00, 0x3f,
+    0x00, 0x00, 0x00, 0x07,                         // Sequence number
+    0x13, 0x80, 0x3d, 0x20,                         // Prefix
+    0x00, 0x01,                                     // Entry count
+    0x00, 0x05,                                     // Peer index
+    0x01, 0x02, 0x03, 0x04,                         // Originated time
+    0x00, 0x2d,                                     // Attribute length
+    0x40, 0x01, 0x01, 0x00,                         // ORIGIN
+    0x40, 0x02, 0x0a, 0x02, 0x02, 0x00, 0x00, 0x28, // AS_PATH
+    0xfa, 0x00, 0x00, 0x0a, 0x4d,
+    0x40, 0x03, 0x04, 0xc7, 0x4d, 0xc1, 0x09,       // NEXT_HOP
+    0x80, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00,       // MED
+    0x40, 0x05, 0x04, 0x00, 0x00, 0x00, 0xc8,       // LOCAL_PREF
+    0xc0, 0x08, 0x04, 0x2d, 0x11, 0x03, 0xb6,       // COMMUNITIES
+  };
+  uint8_t buf[128];
+  bgp_route_t * route;
+  int len;
+  UTEST_ASSERT(mrtd_route_from_line("TABLE_DUMP|1122859488|B|198.32.12.9|"
+				    "11537|128.61.32.0/19|10490 2637|IGP|"
+				    "199.77.193.9|200|0|11537:950|NAG||",
+				    NULL, NULL, &route) >= 0,
+	       "parse should succeed");
+  len= mrtd_v2_encode_rib(0x01020304, 7, route, 5, buf, sizeof(buf));
+  UTEST_ASSERT(len == sizeof(expected),
+	       "record should have %d bytes (%d)", (int) sizeof(expected), len);
+  UTEST_ASSERT(!memcmp(buf, expected, sizeof(expected)),
+	       "incorrect record");
+  UTEST_ASSERT(mrtd_v2_encode_rib(0x01020304, 7, route, 5, buf,
+				  sizeof(expected)-1) < 0,
+	       "encoding should fail with a short buffer");
+  route_destroy(&route);
+  return UTEST_SUCCESS;
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // CLI
@@ -4456,6 +6073,164 @@ static int test_cli_error()
   return UTEST_SUCCESS;
 }
 
+// -----[ _cli_plan_remove_nodes ]-----------------------------------
+/**
+ * Remove the nodes created by a plan from the default network (and
+ * their BGP router from its domain).
+ */
+static void _cli_plan_remove_nodes(const net_addr_t * addrs,
+				   unsigned int num, asn_t asn)
+{
+  network_t * network= network_get_default();
+  unsigned int index;
+  for (index= 0; index < num; index++) {
+    if (asn != 0)
+      radix_tree_remove(get_bgp_domain(asn)->routers, addrs[index], 32, 1);
+    trie_remove(network->nodes, addrs[index], 32);
+  }
+}
+
+// -----[ _cli_plan_compile ]----------------------------------------
+static cli_plan_t * _cli_plan_compile(const char * script)
+{
+  FILE * stream= tmpfile();
+  cli_plan_t * plan;
+  if (stream == NULL)
+    return NULL;
+  fputs(script, stream);
+  rewind(stream);
+  plan= cli_plan_compile(stream);
+  fclose(stream);
+  return plan;
+}
+
+// -----[ test_cli_plan ]--------------------------------------------
+static int test_cli_plan()
+{
+  const char * script=
+    "# Compiled script\n"
+    "net add node 172.31.255.1\n"
+    "net add node --no-loopback 172.31.255.2\n"
+    "net add link 172.31.255.1 172.31.255.2 --bw=1000\n"
+    "net add link 172.31.255.1 172.31.255.0/24\n"
+    "\n"
+    "print \"$undefined\"\n";
+  net_addr_t addrs[]= { IPV4(172,31,255,1), IPV4(172,31,255,2) };
+  cli_plan_t * plan= _cli_plan_compile(script);
+  UTEST_ASSERT(plan != NULL, "compilation should succeed");
+  UTEST_ASSERT(cli_plan_num_ops(plan) == 5, "plan should have 5 operations");
+  UTEST_ASSERT(cli_plan_num_compiled(plan) == 3,
+		"plan should have 3 compiled operations");
+  UTEST_ASSERT(cli_plan_exec(cli_get(), plan) != CLI_SUCCESS,
+		"execution should stop on the invalid link");
+  UTEST_ASSERT(network_find_node(network_get_default(),
+				 IPV4(172,31,255,2)) != NULL,
+		"compiled node should exist");
+  cli_plan_destroy(&plan);
+  UTEST_ASSERT(plan == NULL, "destroyed plan should be NULL");
+  _cli_plan_remove_nodes(addrs, 2, 0);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_cli_plan_bgp ]----------------------------------------
+/**
+ * Execute the compiled BGP operations. The peers of R1 are added in
+ * bulk and must have distinct indices in the router.
+ */
+static int test_cli_plan_bgp()
+{
+  const char * script=
+    "net add node 172.31.255.11\n"
+    "net add node 172.31.255.12\n"
+    "bgp add router 2615 172.31.255.11\n"
+    "bgp add router 2615 172.31.255.12\n"
+    "bgp router 172.31.255.11 add peer 2615 172.31.255.13\n"
+    "bgp router 172.31.255.11 add peer 2615 172.31.255.12\n"
+    "bgp router 172.31.255.12 add peer 2615 172.31.255.11\n"
+    "bgp router 172.31.255.11 peer 172.31.255.12 up\n";
+  net_addr_t addrs[]= { IPV4(172,31,255,11), IPV4(172,31,255,12) };
+  cli_plan_t * plan= _cli_plan_compile(script);
+  net_protocol_t * protocol;
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  UTEST_ASSERT(plan != NULL, "compilation should succeed");
+  UTEST_ASSERT(cli_plan_num_compiled(plan) == 8,
+	       "all the operations should be compiled");
+  UTEST_ASSERT(cli_plan_exec(cli_get(), plan) == CLI_SUCCESS,
+	       "execution should succeed");
+  cli_plan_destroy(&plan);
+  protocol= protocols_get(network_find_node(network_get_default(),
+					    addrs[0])->protocols,
+			  NET_PROTOCOL_BGP);
+  UTEST_ASSERT(protocol != NULL, "BGP router should exist");
+  router= (bgp_router_t *) protocol->handler;
+  UTEST_ASSERT(bgp_peers_size(router->peers) == 2,
+	       "router should have 2 peers");
+  UTEST_ASSERT((bgp_peers_at(router->peers, 0)->rib_index == 0) &&
+	       (bgp_peers_at(router->peers, 1)->rib_index == 1),
+	       "peers added in bulk should have distinct indices");
+  peer= bgp_router_find_peer(router, addrs[1]);
+  UTEST_ASSERT((peer != NULL) &&
+	       (peer->session_state == SESSION_STATE_ACTIVE),
+	       "session should be opened (ACTIVE without route)");
+  _cli_plan_remove_nodes(addrs, 2, 2615);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_cli_plan_cache ]--------------------------------------
+/**
+ * Save and load a plan, and check that the cache is refreshed when
+ * the script changes, even if its size does not.
+ */
+static int test_cli_plan_cache()
+{
+  char filename[]= "/tmp/cbgp-plan-XXXXXX";
+  char cache[sizeof(filename)+5];
+  cli_plan_t * plan, * plan2;
+  uint64_t size, hash;
+  FILE * file;
+  int fd= mkstemp(filename);
+  UTEST_ASSERT(fd >= 0, "could not create temporary file");
+  file= fdopen(fd, "w+");
+  fputs("net add node 172.31.255.21\nprint \"A\"\n", file);
+  rewind(file);
+  UTEST_ASSERT((cli_plan_digest(file, &size, &hash) == 0) && (size == 37),
+	       "digest should succeed");
+  rewind(file);
+  plan= cli_plan_compile(file);
+  fclose(file);
+  strcpy(cache, filename);
+  strcat(cache, ".plan");
+
+  UTEST_ASSERT(cli_plan_save(plan, cache, size, hash) == 0,
+	       "save should succeed");
+  UTEST_ASSERT(cli_plan_load(cache, size, hash, &plan2) == 0,
+	       "load should succeed");
+  UTEST_ASSERT((cli_plan_num_ops(plan2) == 2) &&
+	       (cli_plan_num_compiled(plan2) == 1),
+	       "loaded plan should have the same operations");
+  cli_plan_destroy(&plan2);
+  UTEST_ASSERT(cli_plan_load(cache, size, hash+1, &plan2) != 0,
+	       "load should fail for another content");
+  cli_plan_destroy(&plan);
+
+  // Same size, different content: the cache must not be used
+  file= fopen(filename, "w");
+  fputs("net add node 172.31.255.21\nprint \"B\"\n", file);
+  fclose(file);
+  UTEST_ASSERT(cli_plan_get(filename, &plan) == 0,
+	       "get should succeed");
+  UTEST_ASSERT(cli_plan_load(cache, size, hash, &plan2) != 0,
+	       "cache should have been refreshed");
+  cli_plan_destroy(&plan);
+  UTEST_ASSERT(cli_plan_get(filename, &plan) == 0,
+	       "get should succeed (from cache)");
+  cli_plan_destroy(&plan);
+  remove(cache);
+  remove(filename);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4502,6 +6277,66 @@ static int test_traffic_replay_unreach()
 }
 
 
+// -----[ test_traffic_load_vector ]---------------------------------
+static int test_traffic_load_vector()
+{
+  ez_topo_t * topo= _ez_topo_triangle_rtr();
+  net_link_vload_t loads[]= { 1000, 5, NET_LINK_MAX_VLOAD-1 };
+  net_link_vload_t ecmp_loads[]= { 1000, 3 };
+  const net_link_vload_t * vector;
+  unsigned int num_loads;
+  array_t * traces;
+  ip_opt_t * opts;
+  ez_topo_igp_compute(topo, 1);
+
+  UTEST_ASSERT(node_load_flow_vector(ez_topo_get_node(topo, 0), IP_ADDR_ANY,
+				     ez_topo_get_node(topo, 1)->rid,
+				     loads, 3, NULL) == ESUCCESS,
+	       "node_load_flow_vector() should succeed");
+  UTEST_ASSERT(node_load_flow_vector(ez_topo_get_node(topo, 0), IP_ADDR_ANY,
+				     ez_topo_get_node(topo, 1)->rid,
+				     loads, 3, NULL) == ESUCCESS,
+	       "node_load_flow_vector() should succeed");
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 1), &num_loads);
+  UTEST_ASSERT((num_loads == 3) && (vector[0] == 2000) && (vector[1] == 10),
+	       "incorrect load vector for link [1] 0->2");
+  UTEST_ASSERT(vector[2] == NET_LINK_MAX_VLOAD,
+	       "load vector should saturate");
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 2)->dest.iface,
+				    &num_loads);
+  UTEST_ASSERT((num_loads == 3) && (vector[0] == 2000),
+	       "incorrect load vector for link [2'] 2->1");
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 0), &num_loads);
+  UTEST_ASSERT((num_loads == 0) && (vector == NULL),
+	       "link [0] 0->1 should have no load vector");
+  node_ifaces_load_clear(ez_topo_get_node(topo, 0));
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 1), &num_loads);
+  UTEST_ASSERT((num_loads == 3) && (vector[0] == 0) && (vector[2] == 0),
+	       "load vector should be cleared");
+  ez_topo_destroy(&topo);
+
+  // The vector is split among equal-cost paths
+  topo= _ez_topo_square();
+  ez_topo_igp_compute(topo, 1);
+  opts= ip_options_create();
+  ip_options_set(opts, IP_OPT_ECMP);
+  ip_options_load_vector(opts, ecmp_loads, 2);
+  traces= icmp_trace_send(ez_topo_get_node(topo, 0),
+			   ez_topo_get_node(topo, 3)->rid, 255, opts);
+  UTEST_ASSERT((traces != NULL) && (_array_length(traces) == 2),
+	       "there should be 2 traces");
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 0), &num_loads);
+  UTEST_ASSERT((num_loads == 2) && (vector[0] == 500) && (vector[1] == 1),
+	       "incorrect load vector for link [0] 0->1");
+  vector= net_iface_get_load_vector(ez_topo_get_link(topo, 3), &num_loads);
+  UTEST_ASSERT((num_loads == 2) && (vector[0] == 500) && (vector[1] == 1),
+	       "incorrect load vector for link [3] 2->3");
+  ip_options_destroy(&opts);
+  _array_destroy(&traces);
+  ez_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // AS-LEVEL PART
@@ -4562,6 +6397,276 @@ static int test_aslevel_smoke()
   return UTEST_SUCCESS;
 }
 
+// -----[ _aslevel_topo_solver ]-------------------------------------
+/**
+ *      ASb+1 --- ASb+2
+ *       /  \        \
+ *    ASb+3 ASb+4   ASb+5
+ */
+static as_level_topo_t * _aslevel_topo_solver(asn_t base)
+{
+  as_level_topo_t * topo= aslevel_topo_create(ASLEVEL_ADDR_SCH_DEFAULT);
+  as_level_domain_t * as1= aslevel_topo_add_as(topo, base+1);
+  as_level_domain_t * as2= aslevel_topo_add_as(topo, base+2);
+  as_level_domain_t * as3= aslevel_topo_add_as(topo, base+3);
+  as_level_domain_t * as4= aslevel_topo_add_as(topo, base+4);
+  as_level_domain_t * as5= aslevel_topo_add_as(topo, base+5);
+  aslevel_as_add_link(as1, as2, ASLEVEL_PEER_TYPE_PEER, NULL);
+  aslevel_as_add_link(as2, as1, ASLEVEL_PEER_TYPE_PEER, NULL);
+  aslevel_as_add_link(as1, as3, ASLEVEL_PEER_TYPE_CUSTOMER, NULL);
+  aslevel_as_add_link(as3, as1, ASLEVEL_PEER_TYPE_PROVIDER, NULL);
+  aslevel_as_add_link(as1, as4, ASLEVEL_PEER_TYPE_CUSTOMER, NULL);
+  aslevel_as_add_link(as4, as1, ASLEVEL_PEER_TYPE_PROVIDER, NULL);
+  aslevel_as_add_link(as2, as5, ASLEVEL_PEER_TYPE_CUSTOMER, NULL);
+  aslevel_as_add_link(as5, as2, ASLEVEL_PEER_TYPE_PROVIDER, NULL);
+  return topo;
+}
+
+// -----[ test_aslevel_solve ]---------------------------------------
+static int test_aslevel_solve()
+{
+  as_level_topo_t * topo= _aslevel_topo_solver(0);
+  aslevel_solution_t * solution;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  asn_t origin= 3;
+  UTEST_ASSERT(aslevel_solve(topo, pfx, &origin, 1, &solution)
+	       == ASLEVEL_SUCCESS, "solver should succeed");
+  /* Domains are sorted by ASN: index = ASN-1 */
+  UTEST_ASSERT(solution->classes[2] == ASLEVEL_ROUTE_ORIGIN,
+	       "AS3 should be the origin");
+  UTEST_ASSERT((solution->classes[0] == ASLEVEL_ROUTE_CUSTOMER) &&
+	       (solution->lengths[0] == 1) &&
+	       (solution->next_hops[0] == 2),
+	       "AS1 should have a customer route via AS3");
+  UTEST_ASSERT((solution->classes[1] == ASLEVEL_ROUTE_PEER) &&
+	       (solution->lengths[1] == 2) &&
+	       (solution->next_hops[1] == 0),
+	       "AS2 should have a peer route via AS1");
+  UTEST_ASSERT((solution->classes[3] == ASLEVEL_ROUTE_PROVIDER) &&
+	       (solution->lengths[3] == 2) &&
+	       (solution->next_hops[3] == 0),
+	       "AS4 should have a provider route via AS1");
+  UTEST_ASSERT((solution->classes[4] == ASLEVEL_ROUTE_PROVIDER) &&
+	       (solution->lengths[4] == 3) &&
+	       (solution->next_hops[4] == 1),
+	       "AS5 should have a provider route via AS2");
+  aslevel_solution_destroy(&solution);
+  UTEST_ASSERT(solution == NULL, "destroyed solution should be NULL");
+  origin= 5;
+  UTEST_ASSERT(aslevel_solve(topo, pfx, &origin, 1, &solution)
+	       == ASLEVEL_SUCCESS, "solver should succeed");
+  UTEST_ASSERT((solution->classes[0] == ASLEVEL_ROUTE_PEER) &&
+	       (solution->classes[2] == ASLEVEL_ROUTE_PROVIDER) &&
+	       (solution->lengths[2] == 3),
+	       "routes learned from a peer should reach customers only");
+  aslevel_solution_destroy(&solution);
+  origin= 6;
+  UTEST_ASSERT(aslevel_solve(topo, pfx, &origin, 1, &solution)
+	       == ASLEVEL_ERROR_INVALID_ASNUM,
+	       "solver should fail with unknown origin");
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_aslevel_solve_verify ]--------------------------------
+static int test_aslevel_solve_verify()
+{
+  as_level_topo_t * topo= _aslevel_topo_solver(20);
+  aslevel_solution_t * solution;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  asn_t origin= 23;
+  unsigned int index, num_mismatches;
+  UTEST_ASSERT(aslevel_topo_build_network(topo) == ASLEVEL_SUCCESS,
+	       "could not build network");
+  UTEST_ASSERT(aslevel_topo_setup_policies(topo) == ASLEVEL_SUCCESS,
+	       "could not setup policies");
+  for (index= 0; index < aslevel_topo_num_nodes(topo); index++)
+    UTEST_ASSERT(bgp_router_start(((as_level_domain_t *)
+				   topo->domains->data[index])->router) == 0,
+		 "could not start router");
+  UTEST_ASSERT(bgp_router_add_network(aslevel_topo_get_as(topo, 23)->router,
+				      pfx) == 0,
+	       "could not add network to router");
+  sim_run(network_get_simulator(network_get_default()));
+  UTEST_ASSERT(aslevel_solve(topo, pfx, &origin, 1, &solution)
+	       == ASLEVEL_SUCCESS, "solver should succeed");
+  UTEST_ASSERT(aslevel_solution_verify(gdsdebug, solution, &num_mismatches)
+	       == ASLEVEL_SUCCESS, "verification should succeed");
+  UTEST_ASSERT(num_mismatches == 0,
+	       "solution should match simulation (%u mismatch(es))",
+	       num_mismatches);
+  aslevel_solution_destroy(&solution);
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_aslevel_solve_sharded ]-------------------------------
+/**
+ * Run the simulation of several prefixes in 2 shards and check the
+ * outcome for each prefix.
+ */
+static int test_aslevel_solve_sharded()
+{
+  as_level_topo_t * topo= _aslevel_topo_solver(40);
+  aslevel_solution_t * solution;
+  ip_pfx_t pfxs[3]= { IPV4PFX(192,168,0,0,24),
+		      IPV4PFX(192,168,1,0,24),
+		      IPV4PFX(10,0,0,0,8) };
+  asn_t origins[3]= { 43, 45, 41 };
+  unsigned int index, num_mismatches;
+  UTEST_ASSERT(aslevel_topo_build_network(topo) == ASLEVEL_SUCCESS,
+	       "could not build network");
+  UTEST_ASSERT(aslevel_topo_setup_policies(topo) == ASLEVEL_SUCCESS,
+	       "could not setup policies");
+  for (index= 0; index < aslevel_topo_num_nodes(topo); index++)
+    UTEST_ASSERT(bgp_router_start(((as_level_domain_t *)
+				   topo->domains->data[index])->router) == 0,
+		 "could not start router");
+  for (index= 0; index < 3; index++)
+    UTEST_ASSERT(bgp_router_add_network(aslevel_topo_get_as(topo,
+							    origins[index])->router,
+					pfxs[index]) == 0,
+		 "could not add network to router");
+  UTEST_ASSERT(sim_run_sharded(network_get_simulator(network_get_default()),
+			       2) == ESUCCESS,
+	       "sim_run_sharded() should succeed");
+  for (index= 0; index < 3; index++) {
+    UTEST_ASSERT(aslevel_solve(topo, pfxs[index], &origins[index], 1,
+			       &solution) == ASLEVEL_SUCCESS,
+		 "solver should succeed");
+    UTEST_ASSERT(aslevel_solution_verify(gdsdebug, solution,
+					 &num_mismatches)
+		 == ASLEVEL_SUCCESS, "verification should succeed");
+    UTEST_ASSERT(num_mismatches == 0,
+		 "sharded run should match solution (%u mismatch(es))",
+		 num_mismatches);
+    aslevel_solution_destroy(&solution);
+  }
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_aslevel_solve_install ]-------------------------------
+static int test_aslevel_solve_install()
+{
+  as_level_topo_t * topo= _aslevel_topo_solver(30);
+  aslevel_solution_t * solution;
+  ip_pfx_t pfx= IPV4PFX(192,168,0,0,24);
+  asn_t origin= 33;
+  bgp_route_t * route;
+  UTEST_ASSERT(aslevel_topo_build_network(topo) == ASLEVEL_SUCCESS,
+	       "could not build network");
+  UTEST_ASSERT(aslevel_solve(topo, pfx, &origin, 1, &solution)
+	       == ASLEVEL_SUCCESS, "solver should succeed");
+  UTEST_ASSERT(aslevel_solution_install(solution) == ASLEVEL_SUCCESS,
+	       "installation should succeed");
+  route= bgp_router_find_best(aslevel_topo_get_as(topo, 35)->router, pfx);
+  UTEST_ASSERT((route != NULL) && (route_path_length(route) == 3) &&
+	       (route_localpref_get(route) == ASLEVEL_PREF_PROV),
+	       "AS35 should have a provider route of length 3");
+  UTEST_ASSERT(bgp_router_find_best(aslevel_topo_get_as(topo, 33)->router,
+				    pfx) == NULL,
+	       "origin should not have an installed route");
+  aslevel_solution_destroy(&solution);
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_aslevel_graph ]---------------------------------------
+/**
+ * Check the queries on the compact snapshot of the topology, and
+ * that the snapshot follows changes to the topology.
+ */
+static int test_aslevel_graph()
+{
+  as_level_topo_t * topo= _aslevel_topo_solver(60);
+  as_level_graph_t * graph= aslevel_topo_get_graph(topo);
+  as_level_domain_t * as66;
+  unsigned int sizes[6];
+  uint8_t reached[6];
+  unsigned int index;
+  UTEST_ASSERT(graph != NULL, "snapshot should be built");
+  UTEST_ASSERT((graph->num_domains == 5) && (graph->num_links == 8),
+	       "snapshot should have 5 domains and 8 links");
+  UTEST_ASSERT(aslevel_graph_check_connectedness(graph) == ASLEVEL_SUCCESS,
+	       "topology should be connected");
+  UTEST_ASSERT(aslevel_graph_check_cycle(graph, NULL) == ASLEVEL_SUCCESS,
+	       "topology should have no cycle");
+  aslevel_graph_customer_cones(graph, sizes);
+  UTEST_ASSERT((sizes[0] == 3) && (sizes[1] == 2) && (sizes[2] == 1) &&
+	       (sizes[3] == 1) && (sizes[4] == 1),
+	       "incorrect customer cone sizes");
+  UTEST_ASSERT(aslevel_graph_valley_free(graph, 2, reached) == 5,
+	       "AS63 should reach all domains");
+  UTEST_ASSERT(aslevel_graph_valley_free(graph, 0, reached) == 5,
+	       "AS61 should reach all domains");
+  for (index= 0; index < 5; index++)
+    UTEST_ASSERT(reached[index] == 1, "AS%u should be reached",
+		 graph->asns[index]);
+
+  // Cycle AS61 -> AS63 -> AS66 -> AS61
+  as66= aslevel_topo_add_as(topo, 66);
+  aslevel_as_add_link(aslevel_topo_get_as(topo, 63), as66,
+		      ASLEVEL_PEER_TYPE_CUSTOMER, NULL);
+  aslevel_as_add_link(as66, aslevel_topo_get_as(topo, 63),
+		      ASLEVEL_PEER_TYPE_PROVIDER, NULL);
+  aslevel_as_add_link(as66, aslevel_topo_get_as(topo, 61),
+		      ASLEVEL_PEER_TYPE_CUSTOMER, NULL);
+  aslevel_as_add_link(aslevel_topo_get_as(topo, 61), as66,
+		      ASLEVEL_PEER_TYPE_PROVIDER, NULL);
+  graph= aslevel_topo_get_graph(topo);
+  UTEST_ASSERT((graph->num_domains == 6) && (graph->num_links == 12),
+	       "snapshot should be rebuilt");
+  UTEST_ASSERT(aslevel_topo_check_cycle(topo, 0)
+	       == ASLEVEL_ERROR_CYCLE_DETECTED,
+	       "cycle should be detected");
+  aslevel_graph_customer_cones(graph, sizes);
+  UTEST_ASSERT(sizes[0] == 4, "incorrect customer cone size of AS61");
+  UTEST_ASSERT(aslevel_graph_valley_free(graph, 4, reached) == 6,
+	       "AS65 should reach all domains");
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_aslevel_load_edges ]----------------------------------
+/**
+ * Check that the domains and links are created in bulk from a buffer
+ * of edges, and that duplicate links are reported with their line.
+ */
+static int test_aslevel_load_edges()
+{
+  as_level_topo_t * topo= aslevel_topo_create(ASLEVEL_ADDR_SCH_DEFAULT);
+  aslevel_edges_t * edges= aslevel_edges_create();
+  int line_number;
+  UTEST_ASSERT(aslevel_edges_add(edges, 71, 71, ASLEVEL_PEER_TYPE_PEER, 1)
+	       == ASLEVEL_ERROR_LOOP_LINK, "loop link should be rejected");
+  aslevel_edges_add(edges, 73, 71, ASLEVEL_PEER_TYPE_PROVIDER, 1);
+  aslevel_edges_add(edges, 71, 73, ASLEVEL_PEER_TYPE_CUSTOMER, 2);
+  aslevel_edges_add(edges, 72, 71, ASLEVEL_PEER_TYPE_PEER, 3);
+  aslevel_edges_add(edges, 71, 72, ASLEVEL_PEER_TYPE_PEER, 4);
+  UTEST_ASSERT(aslevel_topo_add_edges(topo, edges, &line_number)
+	       == ASLEVEL_SUCCESS, "edges should be added");
+  UTEST_ASSERT(aslevel_topo_num_nodes(topo) == 3,
+	       "topology should have 3 domains");
+  UTEST_ASSERT(aslevel_as_num_providers(aslevel_topo_get_as(topo, 73)) == 1,
+	       "AS73 should have 1 provider");
+  UTEST_ASSERT(aslevel_graph_num_links(aslevel_topo_get_graph(topo), 0,
+				       ASLEVEL_PEER_TYPE_CUSTOMER) == 1,
+	       "AS71 should have 1 customer");
+  aslevel_topo_destroy(&topo);
+
+  topo= aslevel_topo_create(ASLEVEL_ADDR_SCH_DEFAULT);
+  aslevel_edges_add(edges, 72, 71, ASLEVEL_PEER_TYPE_PROVIDER, 5);
+  UTEST_ASSERT(aslevel_topo_add_edges(topo, edges, &line_number)
+	       == ASLEVEL_ERROR_DUPLICATE_LINK,
+	       "duplicate link should be detected");
+  UTEST_ASSERT(line_number == 5, "duplicate should be reported at line 5"
+	       " (got %d)", line_number);
+  aslevel_edges_destroy(&edges);
+  aslevel_topo_destroy(&topo);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4571,11 +6676,28 @@ static int test_aslevel_smoke()
 
 #define ARRAY_SIZE(A) sizeof(A)/sizeof(A[0])
 
+unit_test_t TEST_SLAB[]= {
+  {test_slab, "alloc/free"},
+  {test_slab_thread_exit, "thread exit"},
+};
+#define TEST_SLAB_SIZE ARRAY_SIZE(TEST_SLAB)
+
+unit_test_t TEST_MEM_ACCT[]= {
+  {test_mem_acct_slab, "slab"},
+  {test_mem_acct_paths, "AS-Paths"},
+  {test_mem_acct_str, "subsystem names"},
+};
+#define TEST_MEM_ACCT_SIZE ARRAY_SIZE(TEST_MEM_ACCT)
+
 unit_test_t TEST_SIM[]= {
   {test_sim_static, "Static scheduling"},
   {test_sim_static_clear, "Static scheduling (clear)"},
   {test_sim_dynamic, "Dynamic scheduling"},
   {test_sim_dynamic_clear, "Dynamic scheduling (clear)"},
+  {test_sim_sharded, "Sharded run"},
+  {test_sim_sharded_seq, "Sharded run (sequence numbers)"},
+  {test_sim_trace, "Trace"},
+  {test_sim_stats, "Stats"},
 };
 #define TEST_SIM_SIZE ARRAY_SIZE(TEST_SIM)
 
@@ -4661,6 +6783,10 @@ unit_test_t TEST_NET_NETWORK[]= {
   {test_net_network_add_node_dup, "network add node (duplicate)"},
   {test_net_network_add_subnet, "network add subnet"},
   {test_net_network_add_subnet_dup, "network add subnet (duplicate)"},
+  {test_net_network_epoch, "network topology epoch"},
+  {test_net_network_generate, "network generate"},
+  {test_net_network_export_bin, "network binary export/import"},
+  {test_net_network_import_bin_invalid, "network binary import (invalid)"},
   {test_net_network_node_send, "node send"},
   {test_net_network_node_send_src, "node send (src-addr)"},
   {test_net_network_node_send_src_invalid, "node send (src-addr,invalid)"},
@@ -4694,6 +6820,11 @@ unit_test_t TEST_NET_RT_IGP[]= {
   {test_net_igp_compute_ecmp_square, "igp compute ecmp (square)"},
   {test_net_igp_compute_ecmp_complex, "igp compute ecmp (complex)"},
   {test_net_igp_ecmp3, "igp ecmp (3)"},
+  {test_net_igp_area_single, "igp areas (single area)"},
+  {test_net_igp_area_inter, "igp areas (inter-area)"},
+  {test_net_igp_matrix_eval, "igp matrix (weight changes)"},
+  {test_net_igp_matrix_delta, "igp matrix (delta computation)"},
+  {test_net_igp_opt_search, "igp weight optimization"},
 };
 #define TEST_NET_RT_IGP_SIZE ARRAY_SIZE(TEST_NET_RT_IGP)
 
@@ -4730,6 +6861,7 @@ unit_test_t TEST_BGP_ATTR[]= {
   {test_bgp_attr_aspath, "as-path"},
   {test_bgp_attr_aspath_prepend, "as-path prepend"},
   {test_bgp_attr_aspath_prepend_too_much, "as-path prepend (too much)"},
+  {test_bgp_attr_aspath_prepend_copy, "as-path prepend (copy)"},
 #ifdef ASN_SIZE_32
   {test_bgp_attr_aspath_prepend_asn32, "as-path prepend (32-bits ASN)"},
 #endif /* ASN_SIZE_32 */
@@ -4740,6 +6872,7 @@ unit_test_t TEST_BGP_ATTR[]= {
   {test_bgp_attr_aspath_str2_asn32, "as-path (<- string, 32-bits ASN)"},
 #endif /* ASN_SIZE_32 */
   {test_bgp_attr_aspath_set_str2, "as-path set (<- string)"},
+  {test_bgp_attr_aspath_segment_next, "as-path segment iterator"},
   {test_bgp_attr_aspath_cmp, "as-path (compare)"},
   {test_bgp_attr_aspath_contains, "as-path (contains)"},
   {test_bgp_attr_aspath_rem_private, "as-path remove private"},
@@ -4762,6 +6895,9 @@ unit_test_t TEST_BGP_ROUTE[]= {
   {test_bgp_route_basic, "basic"},
   {test_bgp_route_communities, "attr-communities"},
   {test_bgp_route_aspath, "attr-aspath"},
+  {test_bgp_route_to_string, "to string"},
+  {test_bgp_route_rib_cursor, "rib-cursor"},
+  {test_bgp_route_stream, "binary stream"},
 };
 #define TEST_BGP_ROUTE_SIZE ARRAY_SIZE(TEST_BGP_ROUTE)
 
@@ -4829,6 +6965,7 @@ unit_test_t TEST_BGP_PEER[]= {
   {test_bgp_peer_open_error_unreach, "open (error, unreach)"},
   {test_bgp_peer_open_error_proto, "open (error, proto)"},
   {test_bgp_peer_close, "close"},
+  {test_bgp_peer_rib_out_elide, "Adj-RIB-Out elision"},
 };
 #define TEST_BGP_PEER_SIZE ARRAY_SIZE(TEST_BGP_PEER)
 
@@ -4843,12 +6980,22 @@ unit_test_t TEST_BGP_ROUTER[]= {
   {test_bgp_router_no_iface, "create (error, no interface)"},
   {test_bgp_router_add_network, "add network"},
   {test_bgp_router_add_network_dup, "add network (duplicate)"},
+  {test_bgp_router_unified_rib, "unified RIB"},
+  {test_bgp_router_reachability, "reachability"},
 };
 #define TEST_BGP_ROUTER_SIZE ARRAY_SIZE(TEST_BGP_ROUTER)
 
+unit_test_t TEST_BGP_URIB[]= {
+  {test_bgp_urib, "basic"},
+};
+#define TEST_BGP_URIB_SIZE ARRAY_SIZE(TEST_BGP_URIB)
+
 unit_test_t TEST_BGP_DOMAIN[]= {
   {test_bgp_domain_full_mesh, "full-mesh"},
+  {test_bgp_domain_full_mesh_urib, "full-mesh (unified RIB)"},
   {test_bgp_domain_full_mesh_ptp, "full-mesh (ptp)"},
+  {test_bgp_domain_rr_hierarchy, "rr-hierarchy"},
+  {test_bgp_domain_generate, "generate"},
 };
 #define TEST_BGP_DOMAIN_SIZE ARRAY_SIZE(TEST_BGP_DOMAIN)
 
@@ -4861,6 +7008,8 @@ unit_test_t TEST_MRTD[]= {
   {test_mrtd_parse_inv_prefix, "parse (error:invalid prefix)"},
   {test_mrtd_parse_inv_nexthop, "parse (error:invalid nexthop)"},
   {test_mrtd_parse_inv_origin, "parse (error:invalid origin)"},
+  {test_mrtd_v2_encode_peer_table, "encode (peer index table)"},
+  {test_mrtd_v2_encode_rib, "encode (rib ipv4 unicast)"},
 };
 #define TEST_MRTD_SIZE ARRAY_SIZE(TEST_MRTD)
 
@@ -4868,21 +7017,33 @@ unit_test_t TEST_CLI[]= {
   {test_cli_empty, "empty line"},
   {test_cli_comment, "comment"},
   {test_cli_error, "error"},
+  {test_cli_plan, "compiled plan"},
+  {test_cli_plan_bgp, "compiled plan (bgp)"},
+  {test_cli_plan_cache, "compiled plan (cache)"},
 };
 #define TEST_CLI_SIZE ARRAY_SIZE(TEST_CLI)
 
 unit_test_t TEST_TRAFFIC[]= {
   {test_traffic_replay, "replay"},
   {test_traffic_replay_unreach, "replay (unreach)"},
+  {test_traffic_load_vector, "load vector"},
 };
 #define TEST_TRAFFIC_SIZE ARRAY_SIZE(TEST_TRAFFIC)
 
 unit_test_t TEST_AS_LEVEL[]= {
   {test_aslevel_smoke, "smoke"},
+  {test_aslevel_solve, "solve"},
+  {test_aslevel_solve_verify, "solve (verify)"},
+  {test_aslevel_solve_install, "solve (install)"},
+  {test_aslevel_solve_sharded, "solve (sharded run)"},
+  {test_aslevel_graph, "graph queries"},
+  {test_aslevel_load_edges, "load (edges)"},
 };
 #define TEST_AS_LEVEL_SIZE ARRAY_SIZE(TEST_AS_LEVEL)
 
 unit_test_suite_t TEST_SUITES[]= {
+  {"Slab Allocator", TEST_SLAB_SIZE, TEST_SLAB},
+  {"Memory Accounting", TEST_MEM_ACCT_SIZE, TEST_MEM_ACCT},
   {"Simulator", TEST_SIM_SIZE, TEST_SIM},
   {"Net Attributes", TEST_NET_ATTR_SIZE, TEST_NET_ATTR},
   {"Net Nodes", TEST_NET_NODE_SIZE, TEST_NET_NODE},
@@ -4901,6 +7062,7 @@ unit_test_suite_t TEST_SUITES[]= {
   {"BGP Filter Predicates", TEST_BGP_FILTER_PRED_SIZE, TEST_BGP_FILTER_PRED},
   {"BGP Filters", TEST_BGP_FILTER_SIZE, TEST_BGP_FILTER},
   {"BGP Route Maps", TEST_BGP_ROUTE_MAPS_SIZE, TEST_BGP_ROUTE_MAPS},
+  {"BGP Unified RIB", TEST_BGP_URIB_SIZE, TEST_BGP_URIB},
   {"BGP Router", TEST_BGP_ROUTER_SIZE, TEST_BGP_ROUTER},
   {"BGP Peer", TEST_BGP_PEER_SIZE, TEST_BGP_PEER},
   {"BGP Peer Filter", TEST_BGP_PEER_FILTER_SIZE, TEST_BGP_PEER_FILTER},
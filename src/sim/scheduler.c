@@ -19,6 +19,8 @@
 #include <libgds/stream.h>
 
 #include <sim/scheduler.h>
+#include <sim/tracer.h>
+#include <util/slab.h>
 
 //#define DEBUG
 #include <libgds/debug.h>
@@ -31,6 +33,9 @@ typedef struct {
   void                  * ctx;
 } _event_t;
 
+SLAB_CACHE(_event_cache, "sim-event (dynamic)", _event_t,
+	   MEM_ACCT_EVENTS);
+
 typedef struct {
   double       time;
   gds_fifo_t * events;
@@ -44,13 +49,14 @@ typedef struct {
   float          cur_time;
   gds_stream_t * pProgressLogStream;
   volatile int   cancelled;
+  unsigned int   num_events;
 } sched_dynamic_t;
 
 // -----[ _event_create ]--------------------------------------------
 static inline _event_t * _event_create(const sim_event_ops_t * ops,
 				       void * ctx)
 {
-  _event_t * ev= (_event_t *) MALLOC(sizeof(_event_t));
+  _event_t * ev= (_event_t *) slab_alloc(&_event_cache);
   ev->ops= ops;
   ev->ctx= ctx;
   return ev;
@@ -62,7 +68,7 @@ static inline void _event_destroy(_event_t ** event_ref)
   _event_t * event= *event_ref;
   if (event == NULL)
     return;
-  FREE(event);
+  slab_free(&_event_cache, event);
   *event_ref= NULL;
 }
 
@@ -150,6 +156,7 @@ static void _clear(sched_t * self)
   sched->buckets= list_create(_bucket_list_item_cmp,
 			      _bucket_list_item_destroy,
 			      NUM_BUCKETS);
+  sched->num_events= 0;
 }
 
 // -----[ _run ]-----------------------------------------------------
@@ -184,8 +191,11 @@ static net_error_t _run(sched_t * self, unsigned int num_steps)
       else
       __debug("???");*/
       __debug("\"\n");
-      event->ops->callback(sched->sim, event->ctx);
+      sim_trace_callback(sched->sim, event->ops, event->ctx,
+			 sched->num_events-1);
       _event_destroy(&event);
+      sched->num_events--;
+      sched->sim->stats.num_events++;
 
       // Limit on number of steps
       if (num_steps > 0) {
@@ -231,6 +241,8 @@ static int _post(sched_t * self, const sim_event_ops_t * ops,
     bucket_ptr= (_bucket_t *) list_get_at(sched->buckets, index);
   }
   _bucket_push(bucket_ptr, _event_create(ops, ctx));
+  sched->num_events++;
+  sim_stats_update_depth(sched->sim, sched->num_events);
   return 0;
 }
 
@@ -304,6 +316,7 @@ sched_t * sched_dynamic_create(simulator_t * sim)
   sched->ops.dump_events    = _dump_events;
   sched->ops.set_log_process= _set_log_progress;
   sched->ops.cur_time       = _cur_time;
+  sched->ops.pop            = NULL;
 
   // Initialize private part
   sched->buckets= list_create(_bucket_list_item_cmp,
@@ -312,6 +325,7 @@ sched_t * sched_dynamic_create(simulator_t * sim)
   sched->cur_time= 0;
   sched->pProgressLogStream= NULL;
   sched->cancelled= 0;
+  sched->num_events= 0;
 
   return (sched_t *) sched;
 }
@@ -0,0 +1,359 @@
+// ==================================================================
+// @(#)shard.c
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <net/error.h>
+#include <net/network.h>
+#include <sim/shard.h>
+#include <sim/tracer.h>
+#include <util/slab.h>
+#include <util/thread.h>
+
+#define SHARD_QUEUE_SIZE 256
+#define SHARD_SEQS_SIZE  64
+
+// -----[ _shard_event_t ]-------------------------------------------
+typedef struct {
+  const sim_event_ops_t * ops;
+  void                  * ctx;
+  uint32_t                key;
+  int                     keyed;
+} _shard_event_t;
+
+// -----[ _shard_t ]-------------------------------------------------
+/** Queue of events. Also used for the prologue. */
+typedef struct {
+  _shard_event_t * events;
+  unsigned int     head;
+  unsigned int     tail;
+  unsigned int     size;
+  int              error;
+  sim_stats_t      stats;
+#ifdef HAVE_PTHREAD
+  pthread_t        thread;
+  int              threaded;
+#endif /* HAVE_PTHREAD */
+} _shard_t;
+
+// -----[ _shard_seq_t ]---------------------------------------------
+typedef struct {
+  const void   * stream;
+  unsigned int   expected;
+} _shard_seq_t;
+
+// -----[ sim_shard_seqs_t ]-----------------------------------------
+/** Hash table of the streams of a shard (open addressing). */
+struct sim_shard_seqs_t {
+  _shard_seq_t * items;
+  unsigned int   size;
+  unsigned int   num_items;
+};
+
+// -----[ _shard_init ]----------------------------------------------
+static inline void _shard_init(_shard_t * shard)
+{
+  shard->events= NULL;
+  shard->head= 0;
+  shard->tail= 0;
+  shard->size= 0;
+  shard->error= ESUCCESS;
+}
+
+// -----[ _shard_push ]----------------------------------------------
+static inline void _shard_push(_shard_t * shard, _shard_event_t * event)
+{
+  if (shard->tail >= shard->size) {
+    shard->size= (shard->size == 0)?SHARD_QUEUE_SIZE:2*shard->size;
+    shard->events= (_shard_event_t *)
+      REALLOC(shard->events, shard->size * sizeof(_shard_event_t));
+  }
+  shard->events[shard->tail++]= *event;
+}
+
+// -----[ _shard_free ]----------------------------------------------
+/**
+ * Free the queue. The events that are still queued are destroyed.
+ */
+static inline void _shard_free(_shard_t * shard)
+{
+  _shard_event_t * event;
+
+  for (; shard->head < shard->tail; shard->head++) {
+    event= &shard->events[shard->head];
+    if (event->ops->destroy != NULL)
+      event->ops->destroy(event->ctx);
+  }
+  if (shard->events != NULL)
+    FREE(shard->events);
+  shard->events= NULL;
+}
+
+// -----[ _shard_index ]---------------------------------------------
+/**
+ * Map a key to a shard. The key is mixed first as keys derived from
+ * addresses often have their low-order bits set to zero.
+ */
+static inline unsigned int _shard_index(uint32_t key,
+					unsigned int num_shards)
+{
+  key^= key >> 16;
+  key*= 0x45d9f3b;
+  key^= key >> 16;
+  return key % num_shards;
+}
+
+// -----[ _shard_seq_find ]------------------------------------------
+/**
+ * Return the slot of a stream, or the free slot where it must be
+ * added. The size of the table is a power of 2.
+ */
+static inline _shard_seq_t * _shard_seq_find(_shard_seq_t * items,
+					     unsigned int size,
+					     const void * stream)
+{
+  unsigned int index= _shard_index((uint32_t) ((uintptr_t) stream >> 3),
+				   size);
+
+  while ((items[index].stream != NULL) && (items[index].stream != stream))
+    index= (index + 1) & (size - 1);
+  return &items[index];
+}
+
+// -----[ _shard_seqs_grow ]-----------------------------------------
+static inline void _shard_seqs_grow(struct sim_shard_seqs_t * seqs)
+{
+  _shard_seq_t * items= seqs->items;
+  unsigned int size= seqs->size, index;
+
+  seqs->size= (size == 0)?SHARD_SEQS_SIZE:2*size;
+  seqs->items= (_shard_seq_t *) MALLOC(seqs->size * sizeof(_shard_seq_t));
+  memset(seqs->items, 0, seqs->size * sizeof(_shard_seq_t));
+  for (index= 0; index < size; index++)
+    if (items[index].stream != NULL)
+      *_shard_seq_find(seqs->items, seqs->size, items[index].stream)=
+	items[index];
+  if (items != NULL)
+    FREE(items);
+}
+
+// -----[ sim_shard_seqs_destroy ]-----------------------------------
+void sim_shard_seqs_destroy(simulator_t * sim)
+{
+  if (sim->shard_seqs == NULL)
+    return;
+  if (sim->shard_seqs->items != NULL)
+    FREE(sim->shard_seqs->items);
+  FREE(sim->shard_seqs);
+  sim->shard_seqs= NULL;
+}
+
+// -----[ sim_shard_seq_check ]--------------------------------------
+int sim_shard_seq_check(simulator_t * sim, const void * stream,
+			unsigned int seq_num, unsigned int * expected)
+{
+  struct sim_shard_seqs_t * seqs= sim->shard_seqs;
+  _shard_seq_t * seq;
+
+  if (seqs == NULL) {
+    seqs= (struct sim_shard_seqs_t *)
+      MALLOC(sizeof(struct sim_shard_seqs_t));
+    seqs->items= NULL;
+    seqs->size= 0;
+    seqs->num_items= 0;
+    sim->shard_seqs= seqs;
+  }
+  if (2 * (seqs->num_items + 1) > seqs->size)
+    _shard_seqs_grow(seqs);
+
+  seq= _shard_seq_find(seqs->items, seqs->size, stream);
+  if (seq->stream == NULL) {
+    seq->stream= stream;
+    seq->expected= 0;
+    seqs->num_items++;
+  }
+  *expected= seq->expected;
+  if (seq_num < seq->expected)
+    return -1;
+  seq->expected= seq_num + 1;
+  return 0;
+}
+
+// -----[ _shard_drain ]---------------------------------------------
+/**
+ * Move the events queued in the simulator to the given queue.
+ * Return the number of events that have no key.
+ */
+static inline unsigned int _shard_drain(simulator_t * sim,
+					_shard_t * queue)
+{
+  _shard_event_t event;
+  unsigned int num_unkeyed= 0;
+
+  while (sim->sched->ops.pop(sim->sched, &event.ops, &event.ctx) == 0) {
+    event.keyed= ((event.ops->shard != NULL) &&
+		  (event.ops->shard(event.ctx, &event.key) == 0));
+    if (!event.keyed)
+      num_unkeyed++;
+    _shard_push(queue, &event);
+  }
+  return num_unkeyed;
+}
+
+// -----[ _shard_prologue ]------------------------------------------
+/**
+ * Process the queued events in order until all the remaining events
+ * have a key. The new events posted by the callbacks are moved to
+ * the queue after each event.
+ */
+static inline int _shard_prologue(simulator_t * sim, _shard_t * queue)
+{
+  unsigned int num_unkeyed= 0;
+  _shard_event_t * event;
+  int error;
+
+  while (1) {
+    num_unkeyed+= _shard_drain(sim, queue);
+    if (num_unkeyed == 0)
+      break;
+    event= &queue->events[queue->head++];
+    if (!event->keyed)
+      num_unkeyed--;
+    error= sim_trace_callback(sim, event->ops, event->ctx,
+			      queue->tail - queue->head);
+    sim->stats.num_events++;
+    if (error != ESUCCESS)
+      return error;
+  }
+  return ESUCCESS;
+}
+
+// -----[ _shard_run ]-----------------------------------------------
+/**
+ * Process a shard with its own simulator. The simulator replaces the
+ * network's simulator in the current thread, so that the messages
+ * sent while processing the shard stay in the shard.
+ */
+static void _shard_run(_shard_t * shard)
+{
+  simulator_t * sim= sim_create(SCHEDULER_STATIC);
+  _shard_event_t * event;
+
+  sim->sharded= 1;
+  thread_set_shard_simulator(sim);
+  for (; shard->head < shard->tail; shard->head++) {
+    event= &shard->events[shard->head];
+    sim_post_event(sim, (sim_event_ops_t *) event->ops, event->ctx,
+		   0, SIM_TIME_REL);
+  }
+  shard->error= sim_run(sim);
+  shard->stats= sim->stats;
+  thread_set_shard_simulator(NULL);
+  sim_destroy(&sim);
+}
+
+#ifdef HAVE_PTHREAD
+// -----[ _shard_thread ]--------------------------------------------
+static void * _shard_thread(void * arg)
+{
+  _shard_run((_shard_t *) arg);
+  slab_thread_exit();
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+// -----[ _shard_run_all ]-------------------------------------------
+/**
+ * Process the shards. The first shard is processed by the calling
+ * thread. If a thread cannot be created, its shard is processed by
+ * the calling thread as well.
+ */
+static inline void _shard_run_all(_shard_t * shards,
+				  unsigned int num_shards)
+{
+  unsigned int index;
+
+#ifdef HAVE_PTHREAD
+  if (num_shards > 1)
+    thread_set_parallel(1);
+  for (index= 1; index < num_shards; index++)
+    shards[index].threaded=
+      (pthread_create(&shards[index].thread, NULL,
+		      _shard_thread, &shards[index]) == 0);
+  _shard_run(&shards[0]);
+  for (index= 1; index < num_shards; index++) {
+    if (shards[index].threaded)
+      pthread_join(shards[index].thread, NULL);
+    else
+      _shard_run(&shards[index]);
+  }
+  thread_set_parallel(0);
+#else
+  for (index= 0; index < num_shards; index++)
+    _shard_run(&shards[index]);
+#endif /* HAVE_PTHREAD */
+}
+
+// -----[ sim_run_sharded ]------------------------------------------
+int sim_run_sharded(simulator_t * sim, unsigned int num_threads)
+{
+  _shard_t queue;
+  _shard_t * shards;
+  _shard_event_t * event;
+  unsigned int index;
+  int error;
+
+  if ((sim->sched->ops.pop == NULL) || (sim->max_time > 0))
+    return EUNSUPPORTED;
+  if (num_threads < 1)
+    num_threads= 1;
+
+  sim->running= 1;
+  _shard_init(&queue);
+  error= _shard_prologue(sim, &queue);
+  if (error != ESUCCESS) {
+    _shard_free(&queue);
+    sim->running= 0;
+    return error;
+  }
+
+  // Split the remaining events. The order of the events is kept
+  // within each shard.
+  shards= (_shard_t *) MALLOC(num_threads * sizeof(_shard_t));
+  for (index= 0; index < num_threads; index++)
+    _shard_init(&shards[index]);
+  for (; queue.head < queue.tail; queue.head++) {
+    event= &queue.events[queue.head];
+    assert(event->keyed);
+    _shard_push(&shards[_shard_index(event->key, num_threads)], event);
+  }
+  _shard_free(&queue);
+
+  _shard_run_all(shards, num_threads);
+
+  // Report the error of the first failed shard. The counters of the
+  // shards are added to the simulator's counters.
+  for (index= 0; index < num_threads; index++) {
+    if ((error == ESUCCESS) && (shards[index].error != ESUCCESS))
+      error= shards[index].error;
+    sim->stats.num_events+= shards[index].stats.num_events;
+    sim_stats_update_depth(sim, shards[index].stats.peak_depth);
+    _shard_free(&shards[index]);
+  }
+  FREE(shards);
+  sim->running= 0;
+  return error;
+}
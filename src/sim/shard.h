@@ -0,0 +1,75 @@
+// ==================================================================
+// @(#)shard.h
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a sharded simulation run. The queued events are split
+ * into shards according to their key (for BGP messages, the
+ * destination prefix, see sim_event_ops_t). Each shard is then
+ * processed by its own static scheduler, possibly in its own thread.
+ *
+ * This is only valid if the outcome for a key does not depend on the
+ * events of other keys, e.g. in an AS-level topology where the
+ * policies do not depend on other prefixes. Under this assumption,
+ * the relative order of the events of a key is the same as in a
+ * sequential run and the resulting RIBs are identical.
+ *
+ * The events that have no key (e.g. BGP OPEN messages) are processed
+ * first, in the simulator's order, until only keyed events remain.
+ *
+ * The events of a stream (e.g. the messages of a BGP session) are
+ * spread over the shards. Their sequence numbers are therefore not
+ * contiguous within a shard, but they must still increase (see
+ * sim_shard_seq_check).
+ */
+
+#ifndef __SIM_SHARD_H__
+#define __SIM_SHARD_H__
+
+#include <sim/simulator.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ sim_run_sharded ]----------------------------------------
+  /**
+   * Run the simulator until its events queue is empty, splitting the
+   * events into shards.
+   *
+   * \param sim         is the simulator (static scheduler only).
+   * \param num_threads is the number of shards, each processed in
+   *   its own thread. Without thread support, the shards are
+   *   processed one after the other.
+   * \retval an error code.
+   */
+  int sim_run_sharded(simulator_t * sim, unsigned int num_threads);
+
+  // -----[ sim_shard_seq_check ]------------------------------------
+  /**
+   * Check the sequence number of an event of a stream against the
+   * value expected by the shard, i.e. one more than the last sequence
+   * number of the stream seen in the shard (0 at first).
+   *
+   * \param sim      is the shard's simulator.
+   * \param stream   identifies the stream (e.g. the receiving peer).
+   * \param seq_num  is the sequence number of the event.
+   * \param expected is set to the expected sequence number.
+   * \retval 0 if the event is in order, -1 otherwise.
+   */
+  int sim_shard_seq_check(simulator_t * sim, const void * stream,
+			  unsigned int seq_num, unsigned int * expected);
+  // -----[ sim_shard_seqs_destroy ]---------------------------------
+  /** Free the sequence numbers of a shard (see sim_destroy). */
+  void sim_shard_seqs_destroy(simulator_t * sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_SHARD_H__ */
@@ -18,6 +18,7 @@
 #include <net/error.h>
 #include <sim/simulator.h>
 #include <sim/scheduler.h>
+#include <sim/shard.h>
 #include <sim/static_scheduler.h>
 
 //#define DEBUG
@@ -48,6 +49,9 @@ simulator_t * sim_create(sched_type_t type)
   sim->max_time= 0;
   sim->sched= SCHEDULERS[type].factory(sim);
   sim->running= 0;
+  sim->sharded= 0;
+  sim->shard_seqs= NULL;
+  sim_reset_stats(sim);
   return sim;
 }
 
@@ -55,6 +59,7 @@ simulator_t * sim_create(sched_type_t type)
 void sim_destroy(simulator_t ** sim_ref)
 {
   if (*sim_ref != NULL) {
+    sim_shard_seqs_destroy(*sim_ref);
     (*sim_ref)->sched->ops.destroy(&(*sim_ref)->sched);
     FREE(*sim_ref);
     *sim_ref= NULL;
@@ -141,6 +146,25 @@ void sim_show_infos(gds_stream_t * stream, simulator_t * sim)
   stream_printf(stream, "maximum time: %f\n", sim->max_time);
 }
 
+// -----[ sim_show_stats ]-------------------------------------------
+/**
+ * Show the counters of the simulator:
+ * - events: number of events processed.
+ * - peak-depth: peak number of queued events.
+ */
+void sim_show_stats(gds_stream_t * stream, simulator_t * sim)
+{
+  stream_printf(stream, "events: %lu\n", sim->stats.num_events);
+  stream_printf(stream, "peak-depth: %u\n", sim->stats.peak_depth);
+}
+
+// -----[ sim_reset_stats ]------------------------------------------
+void sim_reset_stats(simulator_t * sim)
+{
+  sim->stats.num_events= 0;
+  sim->stats.peak_depth= 0;
+}
+
 // -----[ sim_set_log_progress ]-------------------------------------
 void sim_set_log_progress(simulator_t * sim, const char * filename)
 {
@@ -44,11 +44,23 @@ typedef enum {
 
 
 // -----[ sim_event_ops_t ]------------------------------------------
-/** Virtual methods of simulation events. */
+/**
+ * Virtual methods of simulation events. The shard method is
+ * optional: it returns 0 and a key if the event (and the events it
+ * triggers) only depend on state related to that key (see
+ * sim/shard.h).
+ *
+ * The name and the trace method are also optional. They are used by
+ * the tracer to identify the event type and the node / protocol the
+ * event relates to (see sim/tracer.h).
+ */
 typedef struct {
   int  (*callback) (struct simulator_t * sim, void * ctx);
   void (*destroy) (void * ctx);
   void (*dump)(gds_stream_t * stream, void * ctx);
+  int  (*shard) (void * ctx, uint32_t * key);
+  const char * name;
+  void (*trace) (void * ctx, uint32_t * node, uint8_t * protocol);
 } sim_event_ops_t;
 
 
@@ -67,6 +79,8 @@ typedef struct sched_ops_t {
   void         (*set_log_process) (struct sched_t * self,
 				   const char * file_name);
   double       (*cur_time) (struct sched_t * self);
+  int          (*pop) (struct sched_t * self, const sim_event_ops_t ** ops,
+		       void ** ctx);
 } sched_ops_t;
 
 
@@ -79,12 +93,28 @@ typedef struct sched_t {
 } sched_t;
 
 
+// -----[ sim_stats_t ]----------------------------------------------
+/** Counters of a simulator (see sim_show_stats). */
+typedef struct {
+  /** Number of events processed. */
+  unsigned long num_events;
+  /** Peak number of queued events. */
+  unsigned int  peak_depth;
+} sim_stats_t;
+
+
 // -----[ simulator_t ]----------------------------------------------
 /** Definition of a simulator. */
 typedef struct simulator_t {
-  sched_t * sched;
-  double    max_time;
-  int       running;
+  sched_t     * sched;
+  double        max_time;
+  int           running;
+  /** Set if the simulator only handles a shard of the events. */
+  int           sharded;
+  /** Expected sequence numbers of a shard (see sim_shard_seq_check). */
+  struct sim_shard_seqs_t * shard_seqs;
+  /** Counters (updated by the schedulers). */
+  sim_stats_t   stats;
 } simulator_t;
 
 
@@ -210,6 +240,20 @@ extern "C" {
 
   // -----[ sim_show_infos ]-----------------------------------------
   void sim_show_infos(gds_stream_t * stream, simulator_t * sim);
+  // -----[ sim_show_stats ]-----------------------------------------
+  void sim_show_stats(gds_stream_t * stream, simulator_t * sim);
+  // -----[ sim_reset_stats ]----------------------------------------
+  void sim_reset_stats(simulator_t * sim);
+  // -----[ sim_stats_update_depth ]---------------------------------
+  /**
+   * Record the current number of queued events (used by the
+   * schedulers to track the peak depth).
+   */
+  static inline void sim_stats_update_depth(simulator_t * sim,
+					    unsigned int depth) {
+    if (depth > sim->stats.peak_depth)
+      sim->stats.peak_depth= depth;
+  }
 
   // -----[ sim_set_log_progress ]-----------------------------------
   void sim_set_log_progress(simulator_t * sim, const char * file_name);
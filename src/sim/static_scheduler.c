@@ -18,7 +18,9 @@
 #include <libgds/stream.h>
 #include <libgds/memory.h>
 #include <sim/static_scheduler.h>
+#include <sim/tracer.h>
 #include <net/network.h>
+#include <util/slab.h>
 
 #define EVENT_QUEUE_DEPTH 256
 
@@ -27,6 +29,9 @@ typedef struct {
   void                  * ctx;
 } _event_t;
 
+SLAB_CACHE(_event_cache, "sim-event (static)", _event_t,
+	   MEM_ACCT_EVENTS);
+
 typedef struct {
   sched_type_t   type;
   sched_ops_t    ops;
@@ -41,7 +46,7 @@ typedef struct {
 static inline _event_t * _event_create(const sim_event_ops_t * ops,
 				       void * ctx)
 {
-  _event_t * event= (_event_t *) MALLOC(sizeof(_event_t));
+  _event_t * event= (_event_t *) slab_alloc(&_event_cache);
   event->ops= ops;
   event->ctx= ctx;
   return event;
@@ -51,7 +56,7 @@ static inline _event_t * _event_create(const sim_event_ops_t * ops,
 static void _event_destroy(_event_t ** event_ref)
 {
   if (*event_ref != NULL) {
-    FREE(*event_ref);
+    slab_free(&_event_cache, *event_ref);
     *event_ref= NULL;
   }
 }
@@ -144,8 +149,10 @@ static net_error_t _run(sched_t * self, unsigned int num_steps)
 
     STREAM_DEBUG(STREAM_LEVEL_DEBUG, "=====<<< EVENT %2.2f >>>=====\n",
 	      (double) sched->cur_time);
-    error= event->ops->callback(sched->sim, event->ctx);
+    error= sim_trace_callback(sched->sim, event->ops, event->ctx,
+			      fifo_depth(sched->events));
     _event_destroy(&event);
+    sched->sim->stats.num_events++;
     if (error != ESUCCESS)
       return error;
     STREAM_DEBUG(STREAM_LEVEL_DEBUG, "\n");
@@ -198,13 +205,34 @@ void * _event_at(sched_t * self, unsigned int index)
 
 }
 
+// -----[ _pop ]-----------------------------------------------------
+/**
+ * Remove the first event from the queue without processing it. The
+ * caller becomes responsible for the event's context.
+ */
+static int _pop(sched_t * self, const sim_event_ops_t ** ops,
+		void ** ctx)
+{
+  sched_static_t * sched= (sched_static_t *) self;
+  _event_t * event= (_event_t *) fifo_pop(sched->events);
+
+  if (event == NULL)
+    return -1;
+  *ops= event->ops;
+  *ctx= event->ctx;
+  _event_destroy(&event);
+  return 0;
+}
+
 // -----[ _post ]----------------------------------------------------
 static int _post(sched_t * self, const sim_event_ops_t * ops,
 		 void * ctx, double time, sim_time_t time_type)
 {
   sched_static_t * sched= (sched_static_t *) self;
   _event_t * event= _event_create(ops, ctx);
-  return fifo_push(sched->events, event);
+  int result= fifo_push(sched->events, event);
+  sim_stats_update_depth(sched->sim, fifo_depth(sched->events));
+  return result;
 }
 
 // -----[ _dump_events ]---------------------------------------------
@@ -285,6 +313,7 @@ sched_t * sched_static_create(simulator_t * sim)
   sched->ops.dump_events    = _dump_events;
   sched->ops.set_log_process= _set_log_progress;
   sched->ops.cur_time       = _cur_time;
+  sched->ops.pop            = _pop;
 
   // Initialize private part
   sched->events= fifo_create(EVENT_QUEUE_DEPTH, _fifo_event_destroy);
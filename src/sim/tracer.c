@@ -0,0 +1,237 @@
+// ==================================================================
+// @(#)tracer.c
+//
+// Event-level tracer (see sim/tracer.h).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <net/prefix.h>
+#include <net/protocol.h>
+#include <sim/tracer.h>
+#include <util/thread.h>
+
+sim_tracer_t * _sim_tracer= NULL;
+
+static const char * SCOPE_NAMES[SIM_TRACE_SCOPE_MAX]= {
+  "event",
+  "bgp-dp",
+  "igp",
+  "fwd",
+};
+
+static const char * FORMAT_NAMES[SIM_TRACE_FORMAT_MAX]= {
+  "chrome",
+  "csv",
+};
+
+/** State of the event being processed by the current thread. */
+static THREAD_LOCAL int    _sim_trace_sampled= 0;
+static THREAD_LOCAL double _sim_trace_time= 0;
+static THREAD_LOCAL unsigned int _sim_trace_depth= 0;
+
+// -----[ sim_trace_enable ]-----------------------------------------
+void sim_trace_enable(unsigned int size, unsigned int sampling)
+{
+  sim_trace_disable();
+  _sim_tracer= (sim_tracer_t *) MALLOC(sizeof(sim_tracer_t));
+  memset(_sim_tracer, 0, sizeof(sim_tracer_t));
+  _sim_tracer->size= (size > 0)?size:1;
+  _sim_tracer->sampling= (sampling > 0)?sampling:1;
+  _sim_tracer->records= (sim_trace_rec_t *)
+    MALLOC(_sim_tracer->size * sizeof(sim_trace_rec_t));
+  _sim_tracer->start= sim_trace_now();
+}
+
+// -----[ sim_trace_disable ]----------------------------------------
+void sim_trace_disable()
+{
+  if (_sim_tracer == NULL)
+    return;
+  FREE(_sim_tracer->records);
+  FREE(_sim_tracer);
+  _sim_tracer= NULL;
+}
+
+// -----[ _sim_trace_record ]----------------------------------------
+/**
+ * Store a record in the ring buffer. Concurrent writers get distinct
+ * slots unless the ring wraps during the write.
+ */
+static inline void _sim_trace_record(const sim_trace_rec_t * rec)
+{
+  unsigned long index= THREAD_ADD(_sim_tracer->num_records, 1) - 1;
+  _sim_tracer->records[index % _sim_tracer->size]= *rec;
+}
+
+// -----[ _sim_trace_scope_add ]-------------------------------------
+static inline void _sim_trace_scope_add(sim_trace_scope_t scope,
+					uint64_t duration)
+{
+  THREAD_ADD(_sim_tracer->scope_time[scope], duration);
+  THREAD_ADD(_sim_tracer->scope_count[scope], 1);
+}
+
+// -----[ _sim_trace_callback ]--------------------------------------
+/**
+ * Run and time the callback of an event. The node and protocol are
+ * collected before the callback, as the callback usually frees the
+ * event's context.
+ */
+int _sim_trace_callback(simulator_t * sim, const sim_event_ops_t * ops,
+			void * ctx, unsigned int depth)
+{
+  sim_trace_rec_t rec;
+  uint64_t start;
+  int result;
+
+  if ((THREAD_ADD(_sim_tracer->num_events, 1) - 1) %
+      _sim_tracer->sampling != 0) {
+    start= sim_trace_now();
+    result= ops->callback(sim, ctx);
+    _sim_trace_scope_add(SIM_TRACE_EVENT, sim_trace_now() - start);
+    return result;
+  }
+
+  rec.type= (ops->name != NULL)?ops->name:SCOPE_NAMES[SIM_TRACE_EVENT];
+  rec.node= 0;
+  rec.protocol= NET_PROTOCOL_MAX;
+  if (ops->trace != NULL)
+    ops->trace(ctx, &rec.node, &rec.protocol);
+  rec.sim_time= sim_get_time(sim);
+  rec.depth= depth;
+  rec.scope= SIM_TRACE_EVENT;
+
+  _sim_trace_sampled= 1;
+  _sim_trace_time= rec.sim_time;
+  _sim_trace_depth= depth;
+  rec.wall= sim_trace_now();
+  result= ops->callback(sim, ctx);
+  rec.duration= sim_trace_now() - rec.wall;
+  _sim_trace_sampled= 0;
+
+  _sim_trace_scope_add(SIM_TRACE_EVENT, rec.duration);
+  _sim_trace_record(&rec);
+  return result;
+}
+
+// -----[ _sim_trace_scope_end ]-------------------------------------
+void _sim_trace_scope_end(sim_trace_scope_t scope, uint64_t start,
+			  uint32_t node)
+{
+  sim_trace_rec_t rec;
+  uint64_t now= sim_trace_now();
+
+  _sim_trace_scope_add(scope, now - start);
+  if (!_sim_trace_sampled)
+    return;
+
+  rec.wall= start;
+  rec.duration= now - start;
+  rec.sim_time= _sim_trace_time;
+  rec.type= SCOPE_NAMES[scope];
+  rec.node= node;
+  rec.depth= _sim_trace_depth;
+  rec.protocol= NET_PROTOCOL_MAX;
+  rec.scope= scope;
+  _sim_trace_record(&rec);
+}
+
+// -----[ _sim_trace_export_rec ]------------------------------------
+static void _sim_trace_export_rec(gds_stream_t * stream,
+				  sim_trace_format_t format,
+				  const sim_trace_rec_t * rec,
+				  int first)
+{
+  uint64_t wall= rec->wall - _sim_tracer->start;
+  const char * protocol= ((rec->protocol < NET_PROTOCOL_MAX)?
+			  net_protocol2str(rec->protocol):"-");
+
+  switch (format) {
+  case SIM_TRACE_FORMAT_CHROME:
+    // Complete events ("X"), timestamps in microseconds
+    stream_printf(stream, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+		  "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0,"
+		  "\"args\":{\"sim-time\":%f,\"node\":\"",
+		  (first?"":","), rec->type, SCOPE_NAMES[rec->scope],
+		  wall / 1000.0, rec->duration / 1000.0, rec->sim_time);
+    ip_address_dump(stream, rec->node);
+    stream_printf(stream, "\",\"protocol\":\"%s\",\"depth\":%u}}",
+		  protocol, rec->depth);
+    break;
+  case SIM_TRACE_FORMAT_CSV:
+    stream_printf(stream, "%llu,%llu,%f,%s,%s,",
+		  (unsigned long long) wall,
+		  (unsigned long long) rec->duration,
+		  rec->sim_time, rec->type, SCOPE_NAMES[rec->scope]);
+    ip_address_dump(stream, rec->node);
+    stream_printf(stream, ",%s,%u\n", protocol, rec->depth);
+    break;
+  default:
+    abort();
+  }
+}
+
+// -----[ sim_trace_export ]-----------------------------------------
+int sim_trace_export(gds_stream_t * stream, sim_trace_format_t format)
+{
+  unsigned long index, first;
+
+  if (_sim_tracer == NULL)
+    return -1;
+
+  first= 0;
+  if (_sim_tracer->num_records > _sim_tracer->size)
+    first= _sim_tracer->num_records - _sim_tracer->size;
+
+  if (format == SIM_TRACE_FORMAT_CHROME)
+    stream_printf(stream, "{\"traceEvents\":[");
+  else
+    stream_printf(stream, "wall_ns,duration_ns,sim_time,type,scope,"
+		  "node,protocol,depth\n");
+  for (index= first; index < _sim_tracer->num_records; index++)
+    _sim_trace_export_rec(stream, format,
+			  &_sim_tracer->records[index % _sim_tracer->size],
+			  (index == first));
+  if (format == SIM_TRACE_FORMAT_CHROME)
+    stream_printf(stream, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  return 0;
+}
+
+// -----[ sim_trace_show_scopes ]------------------------------------
+void sim_trace_show_scopes(gds_stream_t * stream)
+{
+  sim_trace_scope_t scope;
+
+  if (_sim_tracer == NULL)
+    return;
+  stream_printf(stream, "events: %lu (%lu records)\n",
+		_sim_tracer->num_events, _sim_tracer->num_records);
+  for (scope= 0; scope < SIM_TRACE_SCOPE_MAX; scope++)
+    stream_printf(stream, "%s: %lu %.3f\n", SCOPE_NAMES[scope],
+		  _sim_tracer->scope_count[scope],
+		  _sim_tracer->scope_time[scope] / 1000.0);
+}
+
+// -----[ sim_trace_str2format ]-------------------------------------
+int sim_trace_str2format(const char * str, sim_trace_format_t * format)
+{
+  sim_trace_format_t index;
+  for (index= 0; index < SIM_TRACE_FORMAT_MAX; index++)
+    if (!strcmp(str, FORMAT_NAMES[index])) {
+      *format= index;
+      return 0;
+    }
+  return -1;
+}
@@ -0,0 +1,167 @@
+// ==================================================================
+// @(#)tracer.h
+//
+// Event-level tracer. When enabled, a sample of the simulation
+// events is recorded in a ring buffer of fixed size (wall time,
+// simulation time, event type, node, protocol and queue depth). The
+// records can be exported afterwards in the Chrome trace format
+// (chrome://tracing) or as CSV.
+//
+// Hot paths can also be wrapped in timing scopes. The time spent in
+// each scope is accumulated for all events, whereas a record is only
+// added to the ring buffer when the enclosing event is sampled.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __SIM_TRACER_H__
+#define __SIM_TRACER_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <libgds/stream.h>
+
+#include <sim/simulator.h>
+
+// -----[ sim_trace_scope_t ]----------------------------------------
+/** Timing scopes. */
+typedef enum {
+  SIM_TRACE_EVENT,
+  SIM_TRACE_BGP_DP,
+  SIM_TRACE_IGP,
+  SIM_TRACE_FWD,
+  SIM_TRACE_SCOPE_MAX
+} sim_trace_scope_t;
+
+// -----[ sim_trace_format_t ]---------------------------------------
+/** Export formats. */
+typedef enum {
+  SIM_TRACE_FORMAT_CHROME,
+  SIM_TRACE_FORMAT_CSV,
+  SIM_TRACE_FORMAT_MAX
+} sim_trace_format_t;
+
+// -----[ sim_trace_rec_t ]------------------------------------------
+/** Record of the ring buffer. Times are in nanoseconds. */
+typedef struct {
+  uint64_t     wall;
+  uint64_t     duration;
+  double       sim_time;
+  /** Event type (see sim_event_ops_t) or scope name. */
+  const char * type;
+  uint32_t     node;
+  uint32_t     depth;
+  uint8_t      protocol;
+  uint8_t      scope;
+} sim_trace_rec_t;
+
+// -----[ sim_tracer_t ]---------------------------------------------
+typedef struct {
+  sim_trace_rec_t * records;
+  unsigned int      size;
+  /** Total number of records written (the ring keeps the last
+      'size' records). */
+  unsigned long     num_records;
+  /** One event out of 'sampling' is recorded. */
+  unsigned int      sampling;
+  unsigned long     num_events;
+  uint64_t          start;
+  uint64_t          scope_time[SIM_TRACE_SCOPE_MAX];
+  unsigned long     scope_count[SIM_TRACE_SCOPE_MAX];
+} sim_tracer_t;
+
+extern sim_tracer_t * _sim_tracer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ sim_trace_enable ]---------------------------------------
+  /**
+   * Enable the tracer (previous records are discarded).
+   *
+   * \param size is the number of records of the ring buffer.
+   * \param sampling tells that one event out of 'sampling' is
+   *   recorded.
+   */
+  void sim_trace_enable(unsigned int size, unsigned int sampling);
+  // -----[ sim_trace_disable ]--------------------------------------
+  void sim_trace_disable();
+  // -----[ sim_trace_export ]---------------------------------------
+  /**
+   * Export the records of the ring buffer, oldest first.
+   *
+   * \retval 0 on success, or -1 if the tracer is not enabled.
+   */
+  int sim_trace_export(gds_stream_t * stream, sim_trace_format_t format);
+  // -----[ sim_trace_show_scopes ]----------------------------------
+  /**
+   * Show the number of runs and the total time (in microseconds)
+   * spent in each scope.
+   */
+  void sim_trace_show_scopes(gds_stream_t * stream);
+  // -----[ sim_trace_str2format ]-----------------------------------
+  int sim_trace_str2format(const char * str, sim_trace_format_t * format);
+
+  // -----[ _sim_trace_callback ]------------------------------------
+  int _sim_trace_callback(simulator_t * sim, const sim_event_ops_t * ops,
+			  void * ctx, unsigned int depth);
+  // -----[ _sim_trace_scope_end ]-----------------------------------
+  void _sim_trace_scope_end(sim_trace_scope_t scope, uint64_t start,
+			    uint32_t node);
+
+#ifdef __cplusplus
+}
+#endif
+
+// -----[ sim_trace_now ]--------------------------------------------
+static inline uint64_t sim_trace_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// -----[ sim_trace_callback ]---------------------------------------
+/**
+ * Run the callback of an event. This is used by the schedulers in
+ * place of a direct call, so that the event can be traced.
+ *
+ * \param depth is the number of events still queued.
+ */
+static inline int sim_trace_callback(simulator_t * sim,
+				     const sim_event_ops_t * ops,
+				     void * ctx, unsigned int depth)
+{
+  if (_sim_tracer == NULL)
+    return ops->callback(sim, ctx);
+  return _sim_trace_callback(sim, ops, ctx, depth);
+}
+
+// -----[ sim_trace_scope_begin ]------------------------------------
+static inline uint64_t sim_trace_scope_begin()
+{
+  if (_sim_tracer == NULL)
+    return 0;
+  return sim_trace_now();
+}
+
+// -----[ sim_trace_scope_end ]--------------------------------------
+/**
+ * Close a timing scope opened with sim_trace_scope_begin.
+ *
+ * \param node is the address of the node the scope relates to (or
+ *   0).
+ */
+static inline void sim_trace_scope_end(sim_trace_scope_t scope,
+				       uint64_t start, uint32_t node)
+{
+  if ((_sim_tracer == NULL) || (start == 0))
+    return;
+  _sim_trace_scope_end(scope, start, node);
+}
+
+#endif /* __SIM_TRACER_H__ */
@@ -0,0 +1,76 @@
+// ==================================================================
+// @(#)cycles.h
+//
+// Cheap timestamps used to profile hot paths. On x86, the time-stamp
+// counter is read (CPU cycles). Otherwise, a monotonic clock is used
+// (nanoseconds). The measures are reported in nanoseconds on every
+// architecture (see cycles_to_ns).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __UTIL_CYCLES_H__
+#define __UTIL_CYCLES_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define CYCLES_TSC
+#endif
+
+// -----[ _cycles_clock_ns ]-----------------------------------------
+static inline uint64_t _cycles_clock_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// -----[ cycles_now ]-----------------------------------------------
+/**
+ * Return a timestamp. Its unit depends on the architecture: only
+ * differences between timestamps should be used, once converted
+ * with cycles_to_ns.
+ */
+static inline uint64_t cycles_now()
+{
+#ifdef CYCLES_TSC
+  uint32_t low, high;
+  __asm__ __volatile__ ("rdtsc" : "=a" (low), "=d" (high));
+  return (((uint64_t) high) << 32) | low;
+#else
+  return _cycles_clock_ns();
+#endif
+}
+
+// -----[ cycles_to_ns ]---------------------------------------------
+/**
+ * Convert a difference of timestamps to nanoseconds. On x86, the
+ * rate of the time-stamp counter (assumed constant) is measured
+ * against the monotonic clock the first time a conversion is
+ * needed, which takes 10 ms.
+ */
+static inline uint64_t cycles_to_ns(uint64_t cycles)
+{
+#ifdef CYCLES_TSC
+  static double ns_per_cycle= 0;
+  struct timespec delay= { 0, 10000000 };
+  uint64_t start_ns, start_cycles;
+
+  if (ns_per_cycle == 0) {
+    start_ns= _cycles_clock_ns();
+    start_cycles= cycles_now();
+    nanosleep(&delay, NULL);
+    ns_per_cycle= ((double) (_cycles_clock_ns() - start_ns)) /
+      (cycles_now() - start_cycles);
+  }
+  return (uint64_t) (cycles * ns_per_cycle);
+#else
+  return cycles;
+#endif
+}
+
+#endif /* __UTIL_CYCLES_H__ */
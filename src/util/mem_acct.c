@@ -0,0 +1,138 @@
+// ==================================================================
+// @(#)mem_acct.c
+//
+// Memory accounting per subsystem.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/stream.h>
+
+#include <util/mem_acct.h>
+
+mem_acct_stat_t _mem_acct_stats[MEM_ACCT_MAX];
+mem_acct_stat_t _mem_acct_total= { .bytes= 0, .peak= 0, .limit= 0 };
+int _mem_acct_limited= 0;
+
+static const char * MEM_ACCT_NAMES[MEM_ACCT_MAX]= {
+  "bgp-routes",
+  "bgp-attrs",
+  "as-paths",
+  "communities",
+  "messages",
+  "events",
+  "fib",
+  "spt",
+};
+
+// -----[ mem_acct_to_str ]------------------------------------------
+const char * mem_acct_to_str(mem_acct_t acct)
+{
+  if (acct >= MEM_ACCT_MAX)
+    return "?";
+  return MEM_ACCT_NAMES[acct];
+}
+
+// -----[ mem_acct_from_str ]----------------------------------------
+/**
+ * Return 0 if the given name corresponds to a subsystem, -1
+ * otherwise.
+ */
+int mem_acct_from_str(const char * str, mem_acct_t * acct)
+{
+  mem_acct_t index;
+
+  for (index= 0; index < MEM_ACCT_MAX; index++)
+    if (!strcmp(str, MEM_ACCT_NAMES[index])) {
+      *acct= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ _mem_acct_update_limited ]---------------------------------
+static inline void _mem_acct_update_limited()
+{
+  mem_acct_t index;
+
+  _mem_acct_limited= (_mem_acct_total.limit > 0);
+  for (index= 0; index < MEM_ACCT_MAX; index++)
+    if (_mem_acct_stats[index].limit > 0)
+      _mem_acct_limited= 1;
+}
+
+// -----[ mem_acct_set_limit ]---------------------------------------
+/**
+ * Set the soft limit of a subsystem (in bytes). A limit of 0 means
+ * unlimited.
+ */
+void mem_acct_set_limit(mem_acct_t acct, size_t limit)
+{
+  assert(acct < MEM_ACCT_MAX);
+  _mem_acct_stats[acct].limit= limit;
+  _mem_acct_update_limited();
+}
+
+// -----[ mem_acct_set_total_limit ]---------------------------------
+/**
+ * Set the soft limit on the sum of all subsystems (in bytes). A
+ * limit of 0 means unlimited.
+ */
+void mem_acct_set_total_limit(size_t limit)
+{
+  _mem_acct_total.limit= limit;
+  _mem_acct_update_limited();
+}
+
+// -----[ _mem_acct_dump_stat ]--------------------------------------
+static inline void _mem_acct_dump_stat(gds_stream_t * stream,
+				       const char * name,
+				       mem_acct_stat_t * stat)
+{
+  stream_printf(stream, "%-13s %14lu %14lu ", name,
+		(unsigned long) stat->bytes, (unsigned long) stat->peak);
+  if (stat->limit > 0)
+    stream_printf(stream, "%14lu\n", (unsigned long) stat->limit);
+  else
+    stream_printf(stream, "%14s\n", "unlimited");
+}
+
+// -----[ mem_acct_dump ]--------------------------------------------
+/**
+ * Dump the memory charged to each subsystem (current, peak and
+ * soft limit, in bytes).
+ */
+void mem_acct_dump(gds_stream_t * stream)
+{
+  mem_acct_t index;
+
+  stream_printf(stream, "# %-11s %14s %14s %14s\n",
+		"subsystem", "bytes", "peak", "limit");
+  for (index= 0; index < MEM_ACCT_MAX; index++)
+    _mem_acct_dump_stat(stream, MEM_ACCT_NAMES[index],
+			&_mem_acct_stats[index]);
+  _mem_acct_dump_stat(stream, "total", &_mem_acct_total);
+}
+
+// -----[ _mem_acct_limit_exceeded ]---------------------------------
+/**
+ * Called when a soft limit is exceeded. The breakdown per subsystem
+ * is dumped and the simulation is aborted. This is cleaner than
+ * being killed by the operating system when memory runs out.
+ */
+void _mem_acct_limit_exceeded(mem_acct_t acct)
+{
+  stream_printf(gdserr, "Error: soft memory limit exceeded (%s)\n",
+		mem_acct_to_str(acct));
+  mem_acct_dump(gdserr);
+  stream_flush(gdserr);
+  exit(EXIT_FAILURE);
+}
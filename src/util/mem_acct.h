@@ -0,0 +1,115 @@
+// ==================================================================
+// @(#)mem_acct.h
+//
+// Memory accounting per subsystem. The simulator's data structures
+// (routes, attributes, AS-Paths, FIBs, SPTs, events, ...) charge the
+// memory they allocate to a subsystem counter. Charging is a couple
+// of additions on the hot path. Optional soft limits can be set per
+// subsystem or globally. When a soft limit is exceeded, the
+// simulation is aborted with a breakdown of the memory usage.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __UTIL_MEM_ACCT_H__
+#define __UTIL_MEM_ACCT_H__
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <libgds/stream.h>
+
+#include <util/thread.h>
+
+// -----[ mem_acct_t ]-----------------------------------------------
+typedef enum {
+  MEM_ACCT_BGP_ROUTES,   /* Loc-RIB, Adj-RIB-In, Adj-RIB-Out */
+  MEM_ACCT_BGP_ATTRS,    /* BGP route attributes */
+  MEM_ACCT_BGP_PATHS,    /* AS-Paths (path hash) */
+  MEM_ACCT_BGP_COMMS,    /* Communities (comm hash) */
+  MEM_ACCT_MSGS,         /* Messages in flight */
+  MEM_ACCT_EVENTS,       /* Scheduler queue */
+  MEM_ACCT_FIB,          /* Forwarding tables */
+  MEM_ACCT_SPT,          /* Shortest-path trees */
+  MEM_ACCT_MAX
+} mem_acct_t;
+
+// -----[ mem_acct_stat_t ]------------------------------------------
+typedef struct {
+  /** Number of bytes currently charged. */
+  size_t bytes;
+  /** Peak number of bytes charged. */
+  size_t peak;
+  /** Soft limit (0 means unlimited). */
+  size_t limit;
+} mem_acct_stat_t;
+
+extern mem_acct_stat_t _mem_acct_stats[MEM_ACCT_MAX];
+extern mem_acct_stat_t _mem_acct_total;
+extern int _mem_acct_limited;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ mem_acct_to_str ]----------------------------------------
+  const char * mem_acct_to_str(mem_acct_t acct);
+  // -----[ mem_acct_from_str ]--------------------------------------
+  int mem_acct_from_str(const char * str, mem_acct_t * acct);
+  // -----[ mem_acct_set_limit ]-------------------------------------
+  void mem_acct_set_limit(mem_acct_t acct, size_t limit);
+  // -----[ mem_acct_set_total_limit ]-------------------------------
+  void mem_acct_set_total_limit(size_t limit);
+  // -----[ mem_acct_dump ]------------------------------------------
+  void mem_acct_dump(gds_stream_t * stream);
+
+  // -----[ _mem_acct_limit_exceeded ]-------------------------------
+  void _mem_acct_limit_exceeded(mem_acct_t acct);
+
+#ifdef __cplusplus
+}
+#endif
+
+// -----[ mem_acct_charge ]------------------------------------------
+/**
+ * Charge the given number of bytes to a subsystem.
+ */
+static inline void mem_acct_charge(mem_acct_t acct, size_t size)
+{
+  mem_acct_stat_t * stat= &_mem_acct_stats[acct];
+
+  THREAD_MAX(stat->peak, THREAD_ADD(stat->bytes, size));
+  THREAD_MAX(_mem_acct_total.peak, THREAD_ADD(_mem_acct_total.bytes, size));
+  if (_mem_acct_limited)
+    if (((stat->limit > 0) && (stat->bytes > stat->limit)) ||
+	((_mem_acct_total.limit > 0) &&
+	 (_mem_acct_total.bytes > _mem_acct_total.limit)))
+      _mem_acct_limit_exceeded(acct);
+}
+
+// -----[ mem_acct_release ]-----------------------------------------
+/**
+ * Give back the given number of bytes to a subsystem.
+ */
+static inline void mem_acct_release(mem_acct_t acct, size_t size)
+{
+  assert(_mem_acct_stats[acct].bytes >= size);
+  THREAD_SUB(_mem_acct_stats[acct].bytes, size);
+  THREAD_SUB(_mem_acct_total.bytes, size);
+}
+
+// -----[ mem_acct_get ]---------------------------------------------
+static inline size_t mem_acct_get(mem_acct_t acct)
+{
+  return _mem_acct_stats[acct].bytes;
+}
+
+// -----[ mem_acct_get_total ]---------------------------------------
+static inline size_t mem_acct_get_total()
+{
+  return _mem_acct_total.bytes;
+}
+
+#endif /* __UTIL_MEM_ACCT_H__ */
@@ -0,0 +1,66 @@
+// ==================================================================
+// @(#)rng.h
+//
+// Small seeded pseudo-random number generator (xorshift64*). It is
+// used to generate reproducible workloads: the same seed always
+// yields the same sequence, whatever the platform's rand().
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __UTIL_RNG_H__
+#define __UTIL_RNG_H__
+
+#include <stdint.h>
+
+// -----[ rng_t ]----------------------------------------------------
+typedef struct {
+  uint64_t state;
+} rng_t;
+
+// -----[ rng_init ]-------------------------------------------------
+/**
+ * Seed a generator. The name (optional) is hashed into the seed, so
+ * that independent generators can be derived from the same seed.
+ */
+static inline void rng_init(rng_t * rng, uint64_t seed, const char * name)
+{
+  uint64_t hash= 14695981039346656037ULL;
+
+  // FNV-1a hash of the name
+  if (name != NULL)
+    for (; *name != '\0'; name++) {
+      hash^= (uint8_t) *name;
+      hash*= 1099511628211ULL;
+    }
+  rng->state= (seed ^ hash) | 1;
+}
+
+// -----[ rng_next ]-------------------------------------------------
+static inline uint32_t rng_next(rng_t * rng)
+{
+  uint64_t x= rng->state;
+  x^= x >> 12;
+  x^= x << 25;
+  x^= x >> 27;
+  rng->state= x;
+  return (x * 2685821657736338717ULL) >> 32;
+}
+
+// -----[ rng_range ]------------------------------------------------
+/** Return a number in [0, n[. */
+static inline uint32_t rng_range(rng_t * rng, uint32_t n)
+{
+  return rng_next(rng) % n;
+}
+
+// -----[ rng_uniform ]----------------------------------------------
+/** Return a number in [0, 1[. */
+static inline double rng_uniform(rng_t * rng)
+{
+  return rng_next(rng) / 4294967296.0;
+}
+
+#endif /* __UTIL_RNG_H__ */
@@ -0,0 +1,286 @@
+// ==================================================================
+// @(#)slab.c
+//
+// Per-type allocators for small fixed-size objects.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <libgds/memory.h>
+
+#include <util/slab.h>
+#include <util/thread.h>
+
+/** Maximum number of caches (object types). */
+#define SLAB_MAX_CACHES 64
+/** Size of the blocks obtained from the system (in bytes). */
+#define SLAB_BLOCK_SIZE 16384
+
+// -----[ _slab_block_t ]--------------------------------------------
+/**
+ * Header of a block of objects. The union guarantees that the
+ * objects that follow the header are properly aligned.
+ */
+typedef union _slab_block_t {
+  union _slab_block_t * next;
+  double                align;
+} _slab_block_t;
+
+// ---| Registry of caches |---
+static slab_cache_t * _caches= NULL;
+static int _num_caches= 0;
+static thread_mutex_t _slab_lock= THREAD_MUTEX_INITIALIZER;
+
+#ifdef __SLAB_ALLOC__
+// ---| Thread-local free lists |---
+static THREAD_LOCAL void * _free_lists[SLAB_MAX_CACHES];
+// ---| Blocks of all the threads (protected by _slab_lock) |---
+static _slab_block_t * _blocks= NULL;
+#endif /* __SLAB_ALLOC__ */
+
+// -----[ _slab_obj_size ]-------------------------------------------
+/**
+ * Size of an object slot: large enough to hold the free list link
+ * and rounded up to keep the next slot aligned.
+ */
+static inline size_t _slab_obj_size(const slab_cache_t * cache)
+{
+  size_t size= cache->size;
+
+  if (size < sizeof(void *))
+    size= sizeof(void *);
+  return ((size + sizeof(_slab_block_t) - 1) /
+	  sizeof(_slab_block_t)) * sizeof(_slab_block_t);
+}
+
+// -----[ _slab_register ]-------------------------------------------
+static inline void _slab_register(slab_cache_t * cache)
+{
+  slab_cache_t ** cache_ref= &_caches;
+
+  assert(_num_caches < SLAB_MAX_CACHES);
+  cache->index= _num_caches++;
+
+  // Keep registry sorted by name
+  while ((*cache_ref != NULL) &&
+	 (strcmp((*cache_ref)->name, cache->name) < 0))
+    cache_ref= &(*cache_ref)->next;
+  cache->next= *cache_ref;
+  *cache_ref= cache;
+}
+
+#ifdef __SLAB_ALLOC__
+// -----[ _slab_objs_per_block ]-------------------------------------
+static inline unsigned int _slab_objs_per_block(const slab_cache_t * cache)
+{
+  unsigned int num_objs= (SLAB_BLOCK_SIZE - sizeof(_slab_block_t)) /
+    _slab_obj_size(cache);
+
+  return (num_objs < 1)?1:num_objs;
+}
+
+// -----[ _slab_refill ]---------------------------------------------
+/**
+ * Refill the calling thread's free list. The objects left by the
+ * terminated threads are taken first. Otherwise, a new block is
+ * obtained from the system and carved into objects.
+ */
+static inline void _slab_refill(slab_cache_t * cache)
+{
+  size_t obj_size= _slab_obj_size(cache);
+  unsigned int num_objs= _slab_objs_per_block(cache);
+  _slab_block_t * block;
+  uint8_t * obj;
+
+  if (cache->shared != NULL) {
+    thread_mutex_lock(&_slab_lock);
+    _free_lists[cache->index]= cache->shared;
+    cache->shared= NULL;
+    thread_mutex_unlock(&_slab_lock);
+    if (_free_lists[cache->index] != NULL)
+      return;
+  }
+
+  block= (_slab_block_t *) MALLOC(sizeof(_slab_block_t) +
+				  num_objs * obj_size);
+  thread_mutex_lock(&_slab_lock);
+  block->next= _blocks;
+  _blocks= block;
+  cache->blocks++;
+  thread_mutex_unlock(&_slab_lock);
+
+  obj= (uint8_t *) (block+1);
+  while (num_objs-- > 0) {
+    *(void **) obj= _free_lists[cache->index];
+    _free_lists[cache->index]= obj;
+    obj+= obj_size;
+  }
+}
+#endif /* __SLAB_ALLOC__ */
+
+// -----[ slab_alloc ]-----------------------------------------------
+/**
+ * Allocate an object from the given cache. The content of the
+ * object is undefined.
+ */
+void * slab_alloc(slab_cache_t * cache)
+{
+#ifdef __SLAB_ALLOC__
+  void * obj;
+#endif
+
+  if (cache->index < 0) {
+    thread_mutex_lock(&_slab_lock);
+    if (cache->index < 0)
+      _slab_register(cache);
+    thread_mutex_unlock(&_slab_lock);
+  }
+  THREAD_ADD(cache->allocs, 1);
+  THREAD_MAX(cache->peak, THREAD_ADD(cache->live, 1));
+  mem_acct_charge(cache->acct, cache->size);
+
+#ifdef __SLAB_ALLOC__
+  if (_free_lists[cache->index] == NULL)
+    _slab_refill(cache);
+  obj= _free_lists[cache->index];
+  _free_lists[cache->index]= *(void **) obj;
+  return obj;
+#else
+  return MALLOC(cache->size);
+#endif /* __SLAB_ALLOC__ */
+}
+
+// -----[ slab_free ]------------------------------------------------
+/**
+ * Give an object back to its cache. With slab allocation enabled,
+ * the object is pushed on the calling thread's free list and the
+ * memory is only released by _slab_destroy.
+ */
+void slab_free(slab_cache_t * cache, void * obj)
+{
+  if (obj == NULL)
+    return;
+  assert(cache->live > 0);
+  THREAD_SUB(cache->live, 1);
+  mem_acct_release(cache->acct, cache->size);
+
+#ifdef __SLAB_ALLOC__
+  *(void **) obj= _free_lists[cache->index];
+  _free_lists[cache->index]= obj;
+#else
+  FREE(obj);
+#endif /* __SLAB_ALLOC__ */
+}
+
+// -----[ slab_dump ]------------------------------------------------
+/**
+ * Dump the per-type allocation statistics.
+ */
+void slab_dump(gds_stream_t * stream)
+{
+  slab_cache_t * cache= _caches;
+  unsigned long live_bytes= 0, peak_bytes= 0;
+#ifdef __SLAB_ALLOC__
+  unsigned long reserved_bytes= 0;
+#endif
+
+#ifdef __SLAB_ALLOC__
+  stream_printf(stream, "# allocator: slab (block size: %u bytes)\n",
+		SLAB_BLOCK_SIZE);
+#else
+  stream_printf(stream, "# allocator: malloc\n");
+#endif
+  stream_printf(stream, "# %-22s %6s %10s %10s %12s %12s %12s\n",
+		"type", "size", "live", "peak", "allocs",
+		"live-bytes", "peak-bytes");
+  while (cache != NULL) {
+    stream_printf(stream, "%-24s %6lu %10lu %10lu %12lu %12lu %12lu\n",
+		  cache->name, (unsigned long) cache->size,
+		  cache->live, cache->peak, cache->allocs,
+		  cache->live * cache->size, cache->peak * cache->size);
+    live_bytes+= cache->live * cache->size;
+    peak_bytes+= cache->peak * cache->size;
+#ifdef __SLAB_ALLOC__
+    reserved_bytes+= cache->blocks *
+      (sizeof(_slab_block_t) +
+       _slab_objs_per_block(cache) * _slab_obj_size(cache));
+#endif
+    cache= cache->next;
+  }
+  stream_printf(stream, "# total live: %lu bytes, peak: %lu bytes\n",
+		live_bytes, peak_bytes);
+#ifdef __SLAB_ALLOC__
+  stream_printf(stream, "# total reserved: %lu bytes\n", reserved_bytes);
+#endif
+}
+
+// -----[ slab_thread_exit ]-----------------------------------------
+/**
+ * Called by a worker thread before it terminates. The blocks are
+ * shared by all the threads and only released by _slab_destroy, as
+ * the objects that the thread allocated may still be in use (e.g.
+ * in the RIBs). The objects on the free lists of the thread are
+ * moved to the shared list of their cache, where slab_alloc takes
+ * them back.
+ */
+void slab_thread_exit()
+{
+#ifdef __SLAB_ALLOC__
+  slab_cache_t * cache;
+  void * head, ** tail;
+
+  for (cache= _caches; cache != NULL; cache= cache->next) {
+    head= _free_lists[cache->index];
+    if (head == NULL)
+      continue;
+    tail= (void **) head;
+    while (*tail != NULL)
+      tail= (void **) *tail;
+    thread_mutex_lock(&_slab_lock);
+    *tail= cache->shared;
+    cache->shared= head;
+    thread_mutex_unlock(&_slab_lock);
+    _free_lists[cache->index]= NULL;
+  }
+#endif /* __SLAB_ALLOC__ */
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// INITIALIZATION AND FINALIZATION SECTION
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _slab_destroy ]--------------------------------------------
+/**
+ * Release the blocks of all the threads. This is called by the main
+ * thread when the library is finalized: objects that are still
+ * allocated become invalid.
+ */
+void _slab_destroy()
+{
+#ifdef __SLAB_ALLOC__
+  _slab_block_t * block;
+  slab_cache_t * cache;
+
+  while (_blocks != NULL) {
+    block= _blocks;
+    _blocks= block->next;
+    FREE(block);
+  }
+  for (cache= _caches; cache != NULL; cache= cache->next) {
+    _free_lists[cache->index]= NULL;
+    cache->shared= NULL;
+    cache->blocks= 0;
+  }
+#endif /* __SLAB_ALLOC__ */
+}
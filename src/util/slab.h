@@ -0,0 +1,85 @@
+// ==================================================================
+// @(#)slab.h
+//
+// Per-type allocators for small fixed-size objects. Each object type
+// has its own cache which keeps track of the number of live objects
+// (current and peak). When C-BGP is configured with --enable-slab,
+// the objects are carved out of larger blocks and recycled through
+// thread-local free lists. Otherwise, the caches only do accounting
+// and rely on MALLOC/FREE.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __UTIL_SLAB_H__
+#define __UTIL_SLAB_H__
+
+#include <stdlib.h>
+
+#include <libgds/stream.h>
+
+#include <util/mem_acct.h>
+
+// -----[ slab_cache_t ]---------------------------------------------
+typedef struct slab_cache_t {
+  /** Name of the object type. */
+  const char          * name;
+  /** Size of an object (in bytes). */
+  size_t                size;
+  /** Subsystem the objects are charged to. */
+  mem_acct_t            acct;
+  /** Index of the cache in the registry (-1 if not registered). */
+  int                   index;
+  /** Number of live objects. */
+  unsigned long         live;
+  /** Peak number of live objects. */
+  unsigned long         peak;
+  /** Total number of allocations. */
+  unsigned long         allocs;
+  /** Number of blocks obtained from the system. */
+  unsigned long         blocks;
+  /**
+   * Objects left on the free lists of terminated threads (protected
+   * by the slab lock).
+   */
+  void                * shared;
+  struct slab_cache_t * next;
+} slab_cache_t;
+
+// -----[ SLAB_CACHE ]-----------------------------------------------
+/**
+ * Define a static cache for objects of the given type. The cache is
+ * registered (and shows up in 'show mem') when the first object is
+ * allocated. The objects are charged to the given subsystem (see
+ * util/mem_acct.h).
+ */
+#define SLAB_CACHE(VAR, NAME, TYPE, ACCT)			\
+  static slab_cache_t VAR= { .name= NAME, .size= sizeof(TYPE),	\
+			     .acct= ACCT,				\
+			     .index= -1, .live= 0, .peak= 0,	\
+			     .allocs= 0, .blocks= 0, .shared= NULL,	\
+			     .next= NULL }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ slab_alloc ]---------------------------------------------
+  void * slab_alloc(slab_cache_t * cache);
+  // -----[ slab_free ]----------------------------------------------
+  void slab_free(slab_cache_t * cache, void * obj);
+  // -----[ slab_dump ]----------------------------------------------
+  void slab_dump(gds_stream_t * stream);
+  // -----[ slab_thread_exit ]---------------------------------------
+  void slab_thread_exit();
+
+  // -----[ _slab_destroy ]------------------------------------------
+  void _slab_destroy();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UTIL_SLAB_H__ */
@@ -0,0 +1,31 @@
+// ==================================================================
+// @(#)thread.c
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <util/thread.h>
+
+int _thread_parallel= 0;
+
+// -----[ thread_set_parallel ]--------------------------------------
+/**
+ * Enter or leave parallel mode. This must only be called by the main
+ * thread while no worker thread is running.
+ */
+void thread_set_parallel(int parallel)
+{
+  _thread_parallel= parallel;
+}
+
+// -----[ thread_is_parallel ]---------------------------------------
+int thread_is_parallel()
+{
+  return _thread_parallel;
+}
@@ -0,0 +1,119 @@
+// ==================================================================
+// @(#)thread.h
+//
+// Minimal support for running parts of the simulation in several
+// threads (see sim/shard.h). When C-BGP is built without POSIX
+// threads, the locks and atomic updates compile to plain code.
+//
+// The locks and atomic updates are only used while the program is
+// in parallel mode. The mode is switched by the main thread when no
+// worker thread is running.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __UTIL_THREAD_H__
+#define __UTIL_THREAD_H__
+
+#ifdef HAVE_PTHREAD
+# include <pthread.h>
+#endif
+
+#ifdef HAVE_TLS
+# define THREAD_LOCAL __thread
+#else
+# ifdef HAVE_PTHREAD
+#  error "POSIX threads require thread-local storage (see configure.ac)"
+# endif
+# define THREAD_LOCAL
+#endif
+
+extern int _thread_parallel;
+
+#ifdef HAVE_PTHREAD
+
+typedef pthread_mutex_t thread_mutex_t;
+# define THREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+// -----[ THREAD_ADD / THREAD_SUB ]----------------------------------
+/**
+ * Update a counter shared by the threads and return its new value.
+ */
+# define THREAD_ADD(VAR, VALUE)					\
+  (_thread_parallel?__sync_add_and_fetch(&(VAR), (VALUE)):	\
+   ((VAR)+= (VALUE)))
+# define THREAD_SUB(VAR, VALUE)					\
+  (_thread_parallel?__sync_sub_and_fetch(&(VAR), (VALUE)):	\
+   ((VAR)-= (VALUE)))
+
+// -----[ THREAD_MAX ]-----------------------------------------------
+/**
+ * Raise a maximum shared by the threads to the given value (used to
+ * keep track of peaks).
+ */
+# define THREAD_MAX(VAR, VALUE)						\
+  do {									\
+    __typeof__(VAR) _thread_new= (VALUE), _thread_old;			\
+    if (_thread_parallel) {						\
+      while ((_thread_new > (_thread_old= (VAR))) &&			\
+	     !__sync_bool_compare_and_swap(&(VAR), _thread_old,	\
+					   _thread_new));		\
+    } else if (_thread_new > (VAR))					\
+      (VAR)= _thread_new;						\
+  } while (0)
+
+// -----[ thread_mutex_init ]----------------------------------------
+static inline void thread_mutex_init(thread_mutex_t * mutex)
+{
+  pthread_mutex_init(mutex, NULL);
+}
+
+// -----[ thread_mutex_lock ]----------------------------------------
+static inline void thread_mutex_lock(thread_mutex_t * mutex)
+{
+  if (_thread_parallel)
+    pthread_mutex_lock(mutex);
+}
+
+// -----[ thread_mutex_unlock ]--------------------------------------
+static inline void thread_mutex_unlock(thread_mutex_t * mutex)
+{
+  if (_thread_parallel)
+    pthread_mutex_unlock(mutex);
+}
+
+#else /* HAVE_PTHREAD */
+
+typedef int thread_mutex_t;
+# define THREAD_MUTEX_INITIALIZER 0
+# define THREAD_ADD(VAR, VALUE) ((VAR)+= (VALUE))
+# define THREAD_SUB(VAR, VALUE) ((VAR)-= (VALUE))
+# define THREAD_MAX(VAR, VALUE)			\
+  do {						\
+    __typeof__(VAR) _thread_new= (VALUE);	\
+    if (_thread_new > (VAR))			\
+      (VAR)= _thread_new;			\
+  } while (0)
+
+static inline void thread_mutex_init(thread_mutex_t * mutex) { }
+static inline void thread_mutex_lock(thread_mutex_t * mutex) { }
+static inline void thread_mutex_unlock(thread_mutex_t * mutex) { }
+
+#endif /* HAVE_PTHREAD */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ thread_set_parallel ]------------------------------------
+  void thread_set_parallel(int parallel);
+  // -----[ thread_is_parallel ]-------------------------------------
+  int thread_is_parallel();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UTIL_THREAD_H__ */